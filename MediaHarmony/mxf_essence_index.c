@@ -0,0 +1,544 @@
+/*
+ * $Id$
+ *
+ * Index of the essence data in the MXF files of a share.
+ *
+ * Copyright (C) 2012  British Broadcasting Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+
+#include <mxf_essence_index.h>
+
+
+#define INITIAL_NUM_BUCKETS     256
+
+#define DIR_WATCH_MASK  (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | \
+                         IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+
+
+typedef struct _IndexEntry
+{
+    struct _IndexEntry* next;
+    char* path;
+    unsigned int hash;
+
+    /* used to validate the entry if the directory is not watched */
+    int isWatched;
+    off_t fileSize;
+    time_t fileModTime;
+
+    int haveType;
+    mxfe_EssenceType type;
+    int haveElementInfo;
+    uint64_t offset;
+    uint64_t len;
+} IndexEntry;
+
+typedef struct _DirWatch
+{
+    struct _DirWatch* next;
+    int wd;
+    char* path;
+} DirWatch;
+
+struct _mxfe_EssenceIndex
+{
+    IndexEntry** buckets;
+    unsigned int numBuckets;
+    unsigned int numEntries;
+
+    int inotifyFD;
+    DirWatch* dirWatches;
+};
+
+
+static unsigned int hash_path(const char* path, size_t len)
+{
+    unsigned int hash = 5381;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        hash = hash * 33 + (unsigned char)path[i];
+    }
+
+    return hash;
+}
+
+static void free_entry(IndexEntry** entry)
+{
+    free((*entry)->path);
+    free(*entry);
+    *entry = NULL;
+}
+
+static IndexEntry* find_entry(mxfe_EssenceIndex* index, const char* path, size_t len, unsigned int hash)
+{
+    IndexEntry* entry = index->buckets[hash & (index->numBuckets - 1)];
+
+    while (entry != NULL)
+    {
+        if (entry->hash == hash && strncmp(entry->path, path, len) == 0 && entry->path[len] == '\0')
+        {
+            break;
+        }
+        entry = entry->next;
+    }
+
+    return entry;
+}
+
+static void remove_entry(mxfe_EssenceIndex* index, const char* path, size_t len)
+{
+    unsigned int hash = hash_path(path, len);
+    IndexEntry** link = &index->buckets[hash & (index->numBuckets - 1)];
+    IndexEntry* entry;
+
+    while (*link != NULL)
+    {
+        if ((*link)->hash == hash && strncmp((*link)->path, path, len) == 0 && (*link)->path[len] == '\0')
+        {
+            entry = *link;
+            *link = entry->next;
+            free_entry(&entry);
+            index->numEntries--;
+            break;
+        }
+        link = &(*link)->next;
+    }
+}
+
+/* an empty dirPath is the current directory */
+static int is_in_dir(const char* path, const char* dirPath, size_t dirPathLen)
+{
+    if (dirPathLen == 0)
+    {
+        return strchr(path, '/') == NULL;
+    }
+
+    return strncmp(path, dirPath, dirPathLen) == 0 &&
+        path[dirPathLen] == '/' &&
+        strchr(&path[dirPathLen + 1], '/') == NULL;
+}
+
+/* removes the entries for the files in a directory, or all entries if dirPath is NULL */
+static void remove_dir_entries(mxfe_EssenceIndex* index, const char* dirPath)
+{
+    size_t dirPathLen = (dirPath != NULL) ? strlen(dirPath) : 0;
+    IndexEntry** link;
+    IndexEntry* entry;
+    unsigned int i;
+
+    for (i = 0; i < index->numBuckets; i++)
+    {
+        link = &index->buckets[i];
+        while (*link != NULL)
+        {
+            if (dirPath == NULL || is_in_dir((*link)->path, dirPath, dirPathLen))
+            {
+                entry = *link;
+                *link = entry->next;
+                free_entry(&entry);
+                index->numEntries--;
+            }
+            else
+            {
+                link = &(*link)->next;
+            }
+        }
+    }
+}
+
+static int grow_buckets(mxfe_EssenceIndex* index)
+{
+    IndexEntry** newBuckets;
+    IndexEntry* entry;
+    IndexEntry* next;
+    unsigned int newNumBuckets = index->numBuckets * 2;
+    unsigned int i;
+
+    if ((newBuckets = (IndexEntry**)calloc(newNumBuckets, sizeof(IndexEntry*))) == NULL)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < index->numBuckets; i++)
+    {
+        entry = index->buckets[i];
+        while (entry != NULL)
+        {
+            next = entry->next;
+            entry->next = newBuckets[entry->hash & (newNumBuckets - 1)];
+            newBuckets[entry->hash & (newNumBuckets - 1)] = entry;
+            entry = next;
+        }
+    }
+
+    free(index->buckets);
+    index->buckets = newBuckets;
+    index->numBuckets = newNumBuckets;
+    return 1;
+}
+
+
+static void remove_dir_watch(mxfe_EssenceIndex* index, int wd)
+{
+    DirWatch** link = &index->dirWatches;
+    DirWatch* dirWatch;
+
+    while (*link != NULL)
+    {
+        if ((*link)->wd == wd)
+        {
+            dirWatch = *link;
+            *link = dirWatch->next;
+            remove_dir_entries(index, dirWatch->path);
+            free(dirWatch->path);
+            free(dirWatch);
+            break;
+        }
+        link = &(*link)->next;
+    }
+}
+
+/* start watching the directory of path if it isn't watched already and
+   return 1 if the directory is watched */
+static int add_dir_watch(mxfe_EssenceIndex* index, const char* path)
+{
+    const char* sep = strrchr(path, '/');
+    size_t dirPathLen;
+    DirWatch* dirWatch;
+    int wd;
+
+    if (index->inotifyFD < 0 || sep == path /* root directory */)
+    {
+        return 0;
+    }
+
+    dirPathLen = (sep != NULL) ? (size_t)(sep - path) : 0;
+    for (dirWatch = index->dirWatches; dirWatch != NULL; dirWatch = dirWatch->next)
+    {
+        if (strncmp(dirWatch->path, path, dirPathLen) == 0 && dirWatch->path[dirPathLen] == '\0')
+        {
+            return 1;
+        }
+    }
+
+    if ((dirWatch = (DirWatch*)malloc(sizeof(DirWatch))) == NULL)
+    {
+        return 0;
+    }
+    if ((dirWatch->path = (char*)malloc(dirPathLen + 1)) == NULL)
+    {
+        free(dirWatch);
+        return 0;
+    }
+    memcpy(dirWatch->path, path, dirPathLen);
+    dirWatch->path[dirPathLen] = '\0';
+
+    if ((wd = inotify_add_watch(index->inotifyFD, (dirPathLen > 0) ? dirWatch->path : ".", DIR_WATCH_MASK)) < 0)
+    {
+        fprintf(stderr, "Failed to watch directory '%s': %s\n", path, strerror(errno));
+        free(dirWatch->path);
+        free(dirWatch);
+        return 0;
+    }
+
+    /* the same wd is returned if the directory is watched through another path */
+    remove_dir_watch(index, wd);
+
+    dirWatch->wd = wd;
+    dirWatch->next = index->dirWatches;
+    index->dirWatches = dirWatch;
+    return 1;
+}
+
+/* drop the entries for files that have changed since the last call */
+static void process_dir_events(mxfe_EssenceIndex* index)
+{
+    char buffer[8192] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event* event;
+    DirWatch* dirWatch;
+    char* path;
+    size_t dirPathLen;
+    ssize_t numRead;
+    char* ptr;
+
+    if (index->inotifyFD < 0)
+    {
+        return;
+    }
+
+    while ((numRead = read(index->inotifyFD, buffer, sizeof(buffer))) > 0)
+    {
+        for (ptr = buffer; ptr < buffer + numRead; ptr += sizeof(struct inotify_event) + event->len)
+        {
+            event = (const struct inotify_event*)ptr;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                /* events were lost */
+                remove_dir_entries(index, NULL);
+                continue;
+            }
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+            {
+                if (!(event->mask & IN_IGNORED))
+                {
+                    inotify_rm_watch(index->inotifyFD, event->wd);
+                }
+                remove_dir_watch(index, event->wd);
+                continue;
+            }
+            if (event->len == 0)
+            {
+                continue;
+            }
+
+            for (dirWatch = index->dirWatches; dirWatch != NULL; dirWatch = dirWatch->next)
+            {
+                if (dirWatch->wd == event->wd)
+                {
+                    break;
+                }
+            }
+            if (dirWatch == NULL)
+            {
+                continue;
+            }
+
+            dirPathLen = strlen(dirWatch->path);
+            if ((path = (char*)malloc(dirPathLen + 1 + strlen(event->name) + 1)) == NULL)
+            {
+                remove_dir_entries(index, dirWatch->path);
+                continue;
+            }
+            if (dirPathLen > 0)
+            {
+                strcpy(path, dirWatch->path);
+                path[dirPathLen] = '/';
+                strcpy(&path[dirPathLen + 1], event->name);
+            }
+            else
+            {
+                strcpy(path, event->name);
+            }
+            remove_entry(index, path, strlen(path));
+            free(path);
+        }
+    }
+}
+
+/* returns the path without any "./" prefix or repeated '/' separators, so that
+   the path matches the paths constructed from the directory watches */
+static void get_entry_path(const char* path, const char** entryPath, size_t* len)
+{
+    while (path[0] == '.' && path[1] == '/')
+    {
+        path += 2;
+        while (path[0] == '/' && path[1] != '\0')
+        {
+            path++;
+        }
+    }
+
+    *entryPath = path;
+    *len = strlen(path);
+}
+
+static IndexEntry* get_entry(mxfe_EssenceIndex* index, const char* path)
+{
+    struct stat statBuf;
+    const char* entryPath;
+    size_t len;
+    unsigned int hash;
+    IndexEntry* entry;
+    FILE* file;
+    uint64_t offset;
+    uint64_t elementLen;
+
+    process_dir_events(index);
+
+    get_entry_path(path, &entryPath, &len);
+    hash = hash_path(entryPath, len);
+    entry = find_entry(index, entryPath, len, hash);
+
+    /* an entry in a directory that isn't watched is only reused if the file appears to be unchanged */
+    if (entry != NULL && !entry->isWatched)
+    {
+        if (stat(entryPath, &statBuf) != 0 ||
+            statBuf.st_size != entry->fileSize || statBuf.st_mtime != entry->fileModTime)
+        {
+            remove_entry(index, entryPath, len);
+            entry = NULL;
+        }
+    }
+    if (entry != NULL)
+    {
+        return entry;
+    }
+
+
+    if ((entry = (IndexEntry*)calloc(1, sizeof(IndexEntry))) == NULL ||
+        (entry->path = strdup(entryPath)) == NULL)
+    {
+        free(entry);
+        return NULL;
+    }
+    entry->hash = hash;
+
+    /* watch the directory before parsing the file so that changes during parsing are not missed */
+    entry->isWatched = add_dir_watch(index, entryPath);
+
+    if ((file = fopen(entryPath, "rb")) == NULL)
+    {
+        free_entry(&entry);
+        return NULL;
+    }
+
+    if (fstat(fileno(file), &statBuf) == 0)
+    {
+        entry->fileSize = statBuf.st_size;
+        entry->fileModTime = statBuf.st_mtime;
+    }
+
+    entry->haveType = mxfe_get_essence_type(file, &entry->type);
+    if (mxfe_get_essence_element_info(file, &offset, &elementLen))
+    {
+        entry->haveElementInfo = 1;
+        entry->offset = offset;
+        entry->len = elementLen;
+    }
+    fclose(file);
+
+
+    if (index->numEntries >= index->numBuckets * 2)
+    {
+        /* continue with a longer chain if this fails */
+        grow_buckets(index);
+    }
+    entry->next = index->buckets[hash & (index->numBuckets - 1)];
+    index->buckets[hash & (index->numBuckets - 1)] = entry;
+    index->numEntries++;
+
+    return entry;
+}
+
+
+
+int mxfe_create_essence_index(mxfe_EssenceIndex** index)
+{
+    mxfe_EssenceIndex* newIndex;
+    int flags;
+
+    if ((newIndex = (mxfe_EssenceIndex*)calloc(1, sizeof(mxfe_EssenceIndex))) == NULL)
+    {
+        return 0;
+    }
+    newIndex->numBuckets = INITIAL_NUM_BUCKETS;
+    if ((newIndex->buckets = (IndexEntry**)calloc(newIndex->numBuckets, sizeof(IndexEntry*))) == NULL)
+    {
+        free(newIndex);
+        return 0;
+    }
+
+    if ((newIndex->inotifyFD = inotify_init()) < 0)
+    {
+        fprintf(stderr, "inotify not available (%s) - MXF files will be checked for changes using stat\n",
+            strerror(errno));
+    }
+    else
+    {
+        flags = fcntl(newIndex->inotifyFD, F_GETFL);
+        if (flags < 0 || fcntl(newIndex->inotifyFD, F_SETFL, flags | O_NONBLOCK) < 0 ||
+            fcntl(newIndex->inotifyFD, F_SETFD, FD_CLOEXEC) < 0)
+        {
+            close(newIndex->inotifyFD);
+            newIndex->inotifyFD = -1;
+        }
+    }
+
+    *index = newIndex;
+    return 1;
+}
+
+void mxfe_free_essence_index(mxfe_EssenceIndex** index)
+{
+    DirWatch* dirWatch;
+
+    if (*index == NULL)
+    {
+        return;
+    }
+
+    remove_dir_entries(*index, NULL);
+    free((*index)->buckets);
+
+    while ((*index)->dirWatches != NULL)
+    {
+        dirWatch = (*index)->dirWatches;
+        (*index)->dirWatches = dirWatch->next;
+        free(dirWatch->path);
+        free(dirWatch);
+    }
+    if ((*index)->inotifyFD >= 0)
+    {
+        close((*index)->inotifyFD);
+    }
+
+    free(*index);
+    *index = NULL;
+}
+
+int mxfe_get_indexed_essence_type(mxfe_EssenceIndex* index, const char* path, mxfe_EssenceType* type)
+{
+    IndexEntry* entry = get_entry(index, path);
+
+    if (entry == NULL || !entry->haveType)
+    {
+        return 0;
+    }
+
+    *type = entry->type;
+    return 1;
+}
+
+int mxfe_get_indexed_essence_element_info(mxfe_EssenceIndex* index, const char* path, uint64_t* offset, uint64_t* len)
+{
+    IndexEntry* entry = get_entry(index, path);
+
+    if (entry == NULL || !entry->haveElementInfo)
+    {
+        return 0;
+    }
+
+    *offset = entry->offset;
+    *len = entry->len;
+    return 1;
+}
+
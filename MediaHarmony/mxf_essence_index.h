@@ -0,0 +1,51 @@
+/*
+ * $Id$
+ *
+ * Index of the essence data in the MXF files of a share.
+ *
+ * Copyright (C) 2012  British Broadcasting Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#ifndef __MXF_ESSENCE_INDEX_H__
+#define __MXF_ESSENCE_INDEX_H__
+
+#include <inttypes.h>
+
+#include <mxf_essence.h>
+
+
+/* The index holds the essence type, offset and length of each MXF file that
+   has been looked up, so that a file is only parsed again after it has changed.
+   The directories of the indexed files are watched using inotify and entries
+   are dropped when a file is modified, replaced or removed. If inotify is not
+   available then each lookup checks the file's size and modification time. */
+typedef struct _mxfe_EssenceIndex mxfe_EssenceIndex;
+
+
+int mxfe_create_essence_index(mxfe_EssenceIndex** index);
+void mxfe_free_essence_index(mxfe_EssenceIndex** index);
+
+/* returns the essence 'type' supported by this library */
+int mxfe_get_indexed_essence_type(mxfe_EssenceIndex* index, const char* path, mxfe_EssenceType* type);
+
+/* returns the file 'offset' and 'len'gth of the essence data */
+int mxfe_get_indexed_essence_element_info(mxfe_EssenceIndex* index, const char* path, uint64_t* offset, uint64_t* len);
+
+
+#endif
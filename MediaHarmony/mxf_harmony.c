@@ -27,6 +27,7 @@
 
 #include "includes.h"
 #include <mxf_essence.h>
+#include <mxf_essence_index.h>
 
 static int vfs_mxfh_debug_level = DBGC_VFS;
 
@@ -40,6 +41,9 @@ static const size_t MXF_SUFFIX_LEN = 4;
 static const char* VIRTUAL_MXF_SUFFIX = "._v_.";
 static const size_t VIRTUAL_MXF_SUFFIX_LEN = 5;
 
+/* amount of essence data the kernel is asked to read ahead of sequential reads */
+#define MXFH_READAHEAD_SIZE     (8 * 1024 * 1024)
+
 
 typedef struct _mxfh_virtual_mxf_file
 {
@@ -48,11 +52,14 @@ typedef struct _mxfh_virtual_mxf_file
     int fd;
     SMB_OFF_T offset;
     SMB_OFF_T length;
+    SMB_OFF_T nextReadPos; /* essence position following the last read */
+    SMB_OFF_T readaheadEnd; /* essence position up to which readahead was requested */
 } mxfh_virtual_mxf_file;
 
 typedef struct _mxfh_private_data 
 {
     mxfh_virtual_mxf_file* virtualFiles;
+    mxfe_EssenceIndex* essenceIndex;
 } mxfh_private_data;
 
 typedef struct _mxfh_dirinfo
@@ -172,9 +179,10 @@ static void mxfh_free_dirinfo(mxfh_dirinfo** dirinfo)
     *dirinfo = NULL;
 }
 
-static void mxfh_init_private_data(mxfh_private_data* privateData)
+static int mxfh_init_private_data(mxfh_private_data* privateData)
 {
     privateData->virtualFiles = NULL;
+    return mxfe_create_essence_index(&privateData->essenceIndex);
 }
 
 static void mxfh_free_private_data(void **p_data)
@@ -189,6 +197,8 @@ static void mxfh_free_private_data(void **p_data)
         mxfh_free_virtual_file(&tmp);
     }
     
+    mxfe_free_essence_index(&pd->essenceIndex);
+    
     SAFE_FREE(pd);
     *p_data = NULL;
 }
@@ -220,6 +230,72 @@ static BOOL is_virtual_mxf_file(const char* path, pstring* realPath)
     return False;    
 }
 
+static mxfe_EssenceIndex* mxfh_get_essence_index(vfs_handle_struct* handle)
+{
+    if (!SMB_VFS_HANDLE_TEST_DATA(handle))
+    {
+        return NULL;
+    }
+    
+    mxfh_private_data* pd = NULL;
+    SMB_VFS_HANDLE_GET_DATA(handle, pd, mxfh_private_data, );
+    
+    return pd->essenceIndex;
+}
+
+static int mxfh_get_essence_type(vfs_handle_struct* handle, const char* path, mxfe_EssenceType* type)
+{
+    mxfe_EssenceIndex* index = mxfh_get_essence_index(handle);
+    if (index == NULL)
+    {
+        return 0;
+    }
+    
+    return mxfe_get_indexed_essence_type(index, path, type);
+}
+
+static int mxfh_get_essence_element_info(vfs_handle_struct* handle, const char* path, uint64_t* offset, uint64_t* len)
+{
+    mxfe_EssenceIndex* index = mxfh_get_essence_index(handle);
+    if (index == NULL)
+    {
+        return 0;
+    }
+    
+    return mxfe_get_indexed_essence_element_info(index, path, offset, len);
+}
+
+/* ask the kernel to read ahead of sequential reads of the essence data so that
+   clients streaming the virtual file are not waiting on the disk */
+static void mxfh_readahead(mxfh_virtual_mxf_file* vf, int fd, SMB_OFF_T pos, size_t n)
+{
+    if (pos != vf->nextReadPos)
+    {
+        /* random access - wait for the reads to become sequential again */
+        vf->nextReadPos = pos + n;
+        vf->readaheadEnd = vf->nextReadPos;
+        return;
+    }
+    vf->nextReadPos = pos + n;
+    
+    /* only issue a hint when the reads get near to the end of the previous readahead */
+    if (vf->readaheadEnd < vf->length &&
+        vf->nextReadPos + MXFH_READAHEAD_SIZE / 2 > vf->readaheadEnd)
+    {
+        SMB_OFF_T start = (vf->nextReadPos > vf->readaheadEnd) ? vf->nextReadPos : vf->readaheadEnd;
+        SMB_OFF_T len = MXFH_READAHEAD_SIZE;
+        if (start + len > vf->length)
+        {
+            len = vf->length - start;
+        }
+        if (len > 0)
+        {
+            posix_fadvise(fd, vf->offset + start, len, POSIX_FADV_WILLNEED);
+        }
+        vf->readaheadEnd = start + len;
+    }
+}
+
 
 static int mxfh_connect(vfs_handle_struct *handle, connection_struct *conn,
              const char *svc, const char *user)
@@ -238,7 +314,12 @@ static int mxfh_connect(vfs_handle_struct *handle, connection_struct *conn,
          return -1;
     }
     ZERO_STRUCTP(pd);
-    mxfh_init_private_data(pd);
+    if (!mxfh_init_private_data(pd))
+    {
+        DEBUG(0, ("mxfh_connect: Failed to create the essence index.\n"));
+        SAFE_FREE(pd);
+        return -1;
+    }
 
     SMB_VFS_HANDLE_SET_DATA(handle, pd, mxfh_free_private_data,
                          mxfh_private_data, return -1);
@@ -310,25 +391,16 @@ static SMB_STRUCT_DIRENT *mxfh_readdir(vfs_handle_struct *handle, connection_str
                 pstrcpy(fpath, dirInfo->dirpath);
                 pstrcat(fpath, "/");
                 pstrcat(fpath, d->d_name);
-                FILE* f;
-                if ((f = fopen(fpath, "rb")) != NULL)
-                {
-                    mxfe_EssenceType type;
-                    const char* suffix = NULL;
-                    if (mxfe_get_essence_type(f, &type) &&
-                        mxfe_get_essence_suffix(type, &suffix))
-                    {
-                        /* save this virtual dir entry for the next readdir */
-                        dirInfo->prevDirent = d;
-                        fstrcpy(dirInfo->prevDirentName, d->d_name);
-                        fstrcat(d->d_name, VIRTUAL_MXF_SUFFIX);
-                        fstrcat(d->d_name, suffix);
-                    }
-                    fclose(f);
-                }
-                else
+                mxfe_EssenceType type;
+                const char* suffix = NULL;
+                if (mxfh_get_essence_type(handle, fpath, &type) &&
+                    mxfe_get_essence_suffix(type, &suffix))
                 {
-                    DEBUG(0, ("mxfh_readdir: Failed to open file %s.\n", fpath));
+                    /* save this virtual dir entry for the next readdir */
+                    dirInfo->prevDirent = d;
+                    fstrcpy(dirInfo->prevDirentName, d->d_name);
+                    fstrcat(d->d_name, VIRTUAL_MXF_SUFFIX);
+                    fstrcat(d->d_name, suffix);
                 }
             }
         }
@@ -377,34 +449,25 @@ static int mxfh_open(vfs_handle_struct *handle, connection_struct *conn, const c
         }
         
         /* get the offset and length of the essence data */
-        FILE* f;
-        if ((f = fopen(realPath, "rb")) != NULL)
+        uint64_t offset;
+        uint64_t length;
+        if (!mxfh_get_essence_element_info(handle, realPath, &offset, &length))
         {
-            uint64_t offset;
-            uint64_t length;
-            if (!mxfe_get_essence_element_info(f, &offset, &length))
-            {
-                DEBUG(0, ("mxfh_open: Failed to get essence data info from %s\n", realPath));
-                mxfh_free_virtual_file(&vf);
-                fclose(f);
-                return -1;
-            }
-            vf->offset = offset;
-            vf->length = length;
-            fclose(f);
-        }
-        else
-        {
-            DEBUG(0, ("mxfh_open: Failed to open file %s.\n", realPath));
+            DEBUG(0, ("mxfh_open: Failed to get essence data info from %s\n", realPath));
             mxfh_free_virtual_file(&vf);
             return -1;
         }
+        vf->offset = offset;
+        vf->length = length;
+        vf->nextReadPos = 0;
+        vf->readaheadEnd = 0;
 
         /* add virtual file entry if all succeeds */        
         int fd = SMB_VFS_NEXT_OPEN(handle, conn, realPath, flags, mode);
         if (fd >= 0)
         {
             vf->fd = fd;
+            posix_fadvise(fd, vf->offset, vf->length, POSIX_FADV_SEQUENTIAL);
             if (!mxfh_add_virtual_file(handle, vf))
             {
                 mxfh_free_virtual_file(&vf);
@@ -455,6 +518,7 @@ static ssize_t mxfh_read(vfs_handle_struct *handle, files_struct *fsp, int fd, v
         }
 
         SMB_OFF_T origPos = fsp->fh->pos;
+        mxfh_readahead(vf, fd, origPos - vf->offset, n);
         ssize_t numRead = SMB_VFS_NEXT_READ(handle, fsp, fd, data, n);
         
         /* if we have read past the essence data then adjust the returned numRead
@@ -489,6 +553,7 @@ static ssize_t mxfh_pread(vfs_handle_struct *handle, files_struct *fsp, int fd,
             return 0;
         }
         
+        mxfh_readahead(vf, fd, offset, n);
         ssize_t numRead = SMB_VFS_NEXT_PREAD(handle, fsp, fd, data, n, offset + vf->offset);
         
         /* if we have read past the essence data then adjust the returned numRead
@@ -609,25 +674,15 @@ static int mxfh_stat(vfs_handle_struct *handle, connection_struct *conn, const c
         }
         
         /* set file size equal to length of essence data and set to read only */
-        FILE* f;
-        if ((f = fopen(realPath, "rb")) != NULL)
+        uint64_t offset;
+        uint64_t len;
+        if (mxfh_get_essence_element_info(handle, realPath, &offset, &len))
         {
-            uint64_t offset;
-            uint64_t len;
-            if (!mxfe_get_essence_element_info(f, &offset, &len))
-            {
-                fclose(f);
-                return statResult;
-            }
             sbuf->st_size = len;
             sbuf->st_blocks = len / 512;
             sbuf->st_mode &= 0777444; /* read only */
-            fclose(f);
-        }
-        else
-        {
-            return statResult;
         }
+        return statResult;
     }
     else
     {
@@ -670,25 +725,15 @@ static int mxfh_lstat(vfs_handle_struct *handle, connection_struct *conn, const
         }
         
         /* set file size equal to length of essence data and set to read only */
-        FILE* f;
-        if ((f = fopen(realPath, "rb")) != NULL)
+        uint64_t offset;
+        uint64_t len;
+        if (mxfh_get_essence_element_info(handle, realPath, &offset, &len))
         {
-            uint64_t offset;
-            uint64_t len;
-            if (!mxfe_get_essence_element_info(f, &offset, &len))
-            {
-                fclose(f);
-                return statResult;
-            }
             sbuf->st_size = len;
             sbuf->st_blocks = len / 512;
             sbuf->st_mode &= 0777444; /* read only */
-            fclose(f);
-        }
-        else
-        {
-            return statResult;
         }
+        return statResult;
     }
     else
     {
@@ -0,0 +1,548 @@
+/*
+ * Copyright (C) 2012 British Broadcasting Corporation, All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdlib.h> // for malloc
+#include <string.h> // for memset
+#include <stdint.h> // for int16_t
+#include <math.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "YUV_frame.h"
+#include "YUV_downconvert.h"
+
+// Coefficients are 1.14 fixed point and each set sums to exactly 1 << 14.
+// The vertical pass leaves 6 fractional bits in its 16 bit output, which
+// the horizontal pass removes along with the coefficient scaling.
+#define COEF_BITS   14
+#define V_SHIFT     8
+#define H_SHIFT     (COEF_BITS + COEF_BITS - V_SHIFT)
+
+struct downconvert_filter
+{
+    int         in_w, in_h;
+    int         out_w, out_h;
+    int         v_taps;     // even number of taps per output line
+    int*        v_line;     // [out_h][v_taps] input line numbers
+    int16_t*    v_coef;     // [out_h][v_taps]
+    int         h_taps[2];  // luma, chroma: multiple of 4 taps per sample
+    int*        h_start[2]; // [out_w] first input sample of each window
+    int16_t*    h_coef[2];  // [out_w][h_taps]
+};
+
+static inline int max(int a, int b)
+{
+    return (a > b) ? a : b;
+}
+
+static inline int min(int a, int b)
+{
+    return (a < b) ? a : b;
+}
+
+static double lanczos2(double x)
+{
+    x = fabs(x);
+    if (x < 1e-9)
+        return 1.0;
+    if (x >= 2.0)
+        return 0.0;
+    return 2.0 * sin(M_PI * x) * sin(M_PI * x / 2.0) / (M_PI * M_PI * x * x);
+}
+
+// Number of input samples with non-zero weight for a given resize ratio
+static int kernel_taps(double ratio)
+{
+    return (int)ceil(4.0 * (ratio > 1.0 ? ratio : 1.0));
+}
+
+// Compute ntaps coefficients for the output sample centred on input
+// position centre. Input samples outside lo to hi are replaced by the
+// nearest edge sample, i.e. their weights are folded into the edge taps.
+// Returns the position of the first tap.
+static int make_taps(double centre, double ratio, int lo, int hi,
+                     int ntaps, int16_t* coef)
+{
+    double  scale = ratio > 1.0 ? ratio : 1.0;
+    double  weight[ntaps];
+    double  sum;
+    int     first, last, k, i, big;
+    int     total;
+
+    // samples strictly inside the kernel support
+    k = (int)floor(centre - 2.0 * scale) + 1;
+    last = (int)ceil(centre + 2.0 * scale) - 1;
+    first = min(max(k, lo), hi);
+    for (i = 0; i < ntaps; i++)
+        weight[i] = 0.0;
+    sum = 0.0;
+    for (; k <= last; k++)
+    {
+        double w = lanczos2((k - centre) / scale);
+        weight[min(max(k, lo), hi) - first] += w;
+        sum += w;
+    }
+    // quantise, then make the sum exact by adjusting the biggest tap
+    total = 0;
+    big = 0;
+    for (i = 0; i < ntaps; i++)
+    {
+        coef[i] = (int16_t)lrint(weight[i] * (1 << COEF_BITS) / sum);
+        total += coef[i];
+        if (abs(coef[i]) > abs(coef[big]))
+            big = i;
+    }
+    coef[big] += (1 << COEF_BITS) - total;
+    return first;
+}
+
+downconvert_filter* downconvert_create(int in_w, int in_h,
+                                       int out_w, int out_h, int intlc)
+{
+    downconvert_filter* filter;
+    double  ratio;
+    int     c, j;
+
+    if (in_w < 2 || in_h < 2 || out_w < 2 || out_h < 2 ||
+        in_w % 2 != 0 || out_w % 2 != 0 ||
+        (intlc && (in_h % 2 != 0 || out_h % 2 != 0)))
+        return NULL;
+    filter = calloc(1, sizeof(downconvert_filter));
+    if (filter == NULL)
+        return NULL;
+    filter->in_w = in_w;
+    filter->in_h = in_h;
+    filter->out_w = out_w;
+    filter->out_h = out_h;
+
+    // vertical filter, with each field's lines at their own position
+    ratio = (double)in_h / out_h;
+    filter->v_taps = (kernel_taps(ratio) + 1) & ~1;
+    filter->v_line = malloc(out_h * filter->v_taps * sizeof(int));
+    filter->v_coef = malloc(out_h * filter->v_taps * sizeof(int16_t));
+    if (filter->v_line == NULL || filter->v_coef == NULL)
+    {
+        downconvert_free(filter);
+        return NULL;
+    }
+    for (j = 0; j < out_h; j++)
+    {
+        int*    line = &filter->v_line[j * filter->v_taps];
+        int     first, t;
+        if (intlc)
+        {
+            // work in field lines of field f
+            int     f = j % 2;
+            double  centre = ((j + 0.5) * ratio - 0.5 - f) / 2.0;
+            first = make_taps(centre, ratio, 0, (in_h - f + 1) / 2 - 1,
+                              filter->v_taps,
+                              &filter->v_coef[j * filter->v_taps]);
+            for (t = 0; t < filter->v_taps; t++)
+                line[t] = min((first + t) * 2 + f, in_h - 2 + f);
+        }
+        else
+        {
+            double  centre = (j + 0.5) * ratio - 0.5;
+            first = make_taps(centre, ratio, 0, in_h - 1,
+                              filter->v_taps,
+                              &filter->v_coef[j * filter->v_taps]);
+            for (t = 0; t < filter->v_taps; t++)
+                line[t] = min(first + t, in_h - 1);
+        }
+    }
+
+    // horizontal filters, luma then co-sited chroma
+    ratio = (double)in_w / out_w;
+    for (c = 0; c < 2; c++)
+    {
+        int     w = out_w >> c;
+        int     taps = (kernel_taps(ratio) + 3) & ~3;
+        filter->h_taps[c] = taps;
+        filter->h_start[c] = malloc(w * sizeof(int));
+        filter->h_coef[c] = malloc(w * taps * sizeof(int16_t));
+        if (filter->h_start[c] == NULL || filter->h_coef[c] == NULL)
+        {
+            downconvert_free(filter);
+            return NULL;
+        }
+        for (j = 0; j < w; j++)
+        {
+            double centre;
+            if (c == 0)
+                centre = (j + 0.5) * ratio - 0.5;
+            else
+                centre = j * ratio + 0.25 * ratio - 0.25;
+            filter->h_start[c][j] = make_taps(centre, ratio,
+                                              0, (in_w >> c) - 1, taps,
+                                              &filter->h_coef[c][j * taps]);
+        }
+    }
+    return filter;
+}
+
+void downconvert_free(downconvert_filter* filter)
+{
+    int     c;
+
+    if (filter == NULL)
+        return;
+    free(filter->v_line);
+    free(filter->v_coef);
+    for (c = 0; c < 2; c++)
+    {
+        free(filter->h_start[c]);
+        free(filter->h_coef[c]);
+    }
+    free(filter);
+}
+
+// Workspace is the vertical filter's row pointers, one packed 16 bit line
+// and three planar 16 bit lines, each padded so a horizontal window
+// starting at the last sample can be read in full.
+static size_t packed_size(const downconvert_filter* filter)
+{
+    return ((filter->in_w * 2) + 15) & ~15;
+}
+
+static size_t plane_size(const downconvert_filter* filter, int c)
+{
+    return (((filter->in_w >> c) + filter->h_taps[c]) + 15) & ~15;
+}
+
+size_t downconvert_work_size(const downconvert_filter* filter)
+{
+    return 16 + filter->v_taps * sizeof(BYTE*) +
+           (packed_size(filter) + plane_size(filter, 0) +
+            2 * plane_size(filter, 1)) * sizeof(int16_t) + 16;
+}
+
+// Vertical filter of n bytes from each of ntaps rows to 16 bit output
+static void v_filter(const BYTE** rows, const int16_t* coef, int ntaps,
+                     int n, int16_t* out)
+{
+    int     x = 0;
+    int     t;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (V_SHIFT - 1));
+    for (; x + 16 <= n; x += 16)
+    {
+        __m128i acc0 = round;
+        __m128i acc1 = round;
+        __m128i acc2 = round;
+        __m128i acc3 = round;
+        for (t = 0; t < ntaps; t += 2)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(rows[t] + x));
+            __m128i b = _mm_loadu_si128((const __m128i*)(rows[t + 1] + x));
+            __m128i c = _mm_set1_epi32((coef[t + 1] << 16) |
+                                       (coef[t] & 0xffff));
+            __m128i a_lo = _mm_unpacklo_epi8(a, zero);
+            __m128i a_hi = _mm_unpackhi_epi8(a, zero);
+            __m128i b_lo = _mm_unpacklo_epi8(b, zero);
+            __m128i b_hi = _mm_unpackhi_epi8(b, zero);
+            acc0 = _mm_add_epi32(acc0,
+                        _mm_madd_epi16(_mm_unpacklo_epi16(a_lo, b_lo), c));
+            acc1 = _mm_add_epi32(acc1,
+                        _mm_madd_epi16(_mm_unpackhi_epi16(a_lo, b_lo), c));
+            acc2 = _mm_add_epi32(acc2,
+                        _mm_madd_epi16(_mm_unpacklo_epi16(a_hi, b_hi), c));
+            acc3 = _mm_add_epi32(acc3,
+                        _mm_madd_epi16(_mm_unpackhi_epi16(a_hi, b_hi), c));
+        }
+        acc0 = _mm_srai_epi32(acc0, V_SHIFT);
+        acc1 = _mm_srai_epi32(acc1, V_SHIFT);
+        acc2 = _mm_srai_epi32(acc2, V_SHIFT);
+        acc3 = _mm_srai_epi32(acc3, V_SHIFT);
+        _mm_storeu_si128((__m128i*)(out + x), _mm_packs_epi32(acc0, acc1));
+        _mm_storeu_si128((__m128i*)(out + x + 8), _mm_packs_epi32(acc2, acc3));
+    }
+#endif
+    for (; x < n; x++)
+    {
+        int acc = 1 << (V_SHIFT - 1);
+        for (t = 0; t < ntaps; t++)
+            acc += coef[t] * rows[t][x];
+        out[x] = (int16_t)(acc >> V_SHIFT);
+    }
+}
+
+// Split a packed 4:2:2 line into planar Y, U & V
+static void deinterleave(const int16_t* in, int w, int y_off, int u_off,
+                         int v_off, int16_t* Y, int16_t* U, int16_t* V)
+{
+    int     i = 0;
+
+#if defined(__SSE2__)
+    for (; i + 16 <= w; i += 16)
+    {
+        const __m128i* src = (const __m128i*)(in + i * 2);
+        __m128i a = _mm_loadu_si128(src);
+        __m128i b = _mm_loadu_si128(src + 1);
+        __m128i c = _mm_loadu_si128(src + 2);
+        __m128i d = _mm_loadu_si128(src + 3);
+        __m128i odd_ab = _mm_packs_epi32(_mm_srai_epi32(a, 16),
+                                         _mm_srai_epi32(b, 16));
+        __m128i odd_cd = _mm_packs_epi32(_mm_srai_epi32(c, 16),
+                                         _mm_srai_epi32(d, 16));
+        __m128i even_ab = _mm_packs_epi32(
+                        _mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                        _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+        __m128i even_cd = _mm_packs_epi32(
+                        _mm_srai_epi32(_mm_slli_epi32(c, 16), 16),
+                        _mm_srai_epi32(_mm_slli_epi32(d, 16), 16));
+        __m128i chroma_ab, chroma_cd, c_odd, c_even;
+        if (y_off & 1)
+        {
+            _mm_storeu_si128((__m128i*)(Y + i), odd_ab);
+            _mm_storeu_si128((__m128i*)(Y + i + 8), odd_cd);
+            chroma_ab = even_ab;
+            chroma_cd = even_cd;
+        }
+        else
+        {
+            _mm_storeu_si128((__m128i*)(Y + i), even_ab);
+            _mm_storeu_si128((__m128i*)(Y + i + 8), even_cd);
+            chroma_ab = odd_ab;
+            chroma_cd = odd_cd;
+        }
+        c_odd = _mm_packs_epi32(_mm_srai_epi32(chroma_ab, 16),
+                                _mm_srai_epi32(chroma_cd, 16));
+        c_even = _mm_packs_epi32(
+                        _mm_srai_epi32(_mm_slli_epi32(chroma_ab, 16), 16),
+                        _mm_srai_epi32(_mm_slli_epi32(chroma_cd, 16), 16));
+        if (u_off < v_off)
+        {
+            _mm_storeu_si128((__m128i*)(U + i / 2), c_even);
+            _mm_storeu_si128((__m128i*)(V + i / 2), c_odd);
+        }
+        else
+        {
+            _mm_storeu_si128((__m128i*)(U + i / 2), c_odd);
+            _mm_storeu_si128((__m128i*)(V + i / 2), c_even);
+        }
+    }
+#endif
+    for (; i < w; i += 2)
+    {
+        Y[i] = in[i * 2 + y_off];
+        Y[i + 1] = in[i * 2 + 2 + y_off];
+        U[i / 2] = in[i * 2 + u_off];
+        V[i / 2] = in[i * 2 + v_off];
+    }
+}
+
+#if defined(__SSE2__)
+// Sum ntaps products of input and coefficients, leaving 4 partial sums
+static inline __m128i h_madd(const int16_t* src, const int16_t* c, int ntaps)
+{
+    __m128i acc = _mm_setzero_si128();
+    int     t;
+
+    for (t = 0; t + 8 <= ntaps; t += 8)
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(
+                    _mm_loadu_si128((const __m128i*)(src + t)),
+                    _mm_loadu_si128((const __m128i*)(c + t))));
+    if (t < ntaps)
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(
+                    _mm_loadl_epi64((const __m128i*)(src + t)),
+                    _mm_loadl_epi64((const __m128i*)(c + t))));
+    return acc;
+}
+
+// Filter 8 output samples starting at j
+static inline __m128i h_filter_8(const int16_t* in, const int* start,
+                                 const int16_t* coef, int ntaps, int j)
+{
+    const __m128i round = _mm_set1_epi32(1 << (H_SHIFT - 1));
+    __m128i sum[2];
+    int     k;
+
+    for (k = 0; k < 2; k++)
+    {
+        int     jj = j + k * 4;
+        __m128i a = h_madd(in + start[jj], coef + jj * ntaps, ntaps);
+        __m128i b = h_madd(in + start[jj + 1], coef + (jj + 1) * ntaps, ntaps);
+        __m128i c = h_madd(in + start[jj + 2], coef + (jj + 2) * ntaps, ntaps);
+        __m128i d = h_madd(in + start[jj + 3], coef + (jj + 3) * ntaps, ntaps);
+        // transpose and add to get the four sums in one register
+        __m128i s0 = _mm_add_epi32(_mm_unpacklo_epi32(a, b),
+                                   _mm_unpackhi_epi32(a, b));
+        __m128i s1 = _mm_add_epi32(_mm_unpacklo_epi32(c, d),
+                                   _mm_unpackhi_epi32(c, d));
+        sum[k] = _mm_add_epi32(_mm_unpacklo_epi64(s0, s1),
+                               _mm_unpackhi_epi64(s0, s1));
+        sum[k] = _mm_srai_epi32(_mm_add_epi32(sum[k], round), H_SHIFT);
+    }
+    return _mm_packs_epi32(sum[0], sum[1]);
+}
+#endif
+
+// Horizontal filter of 16 bit input to w output bytes
+static void h_filter(const int16_t* in, const int* start, const int16_t* coef,
+                     int ntaps, int w, BYTE* out, int outStride)
+{
+    int     j = 0;
+    int     t;
+
+#if defined(__SSE2__)
+    for (; j + 8 <= w; j += 8)
+    {
+        __m128i result;
+        BYTE    pix[16];
+        // constant tap counts let the compiler unroll the common cases
+        if (ntaps == 12)
+            result = h_filter_8(in, start, coef, 12, j);
+        else if (ntaps == 8)
+            result = h_filter_8(in, start, coef, 8, j);
+        else
+            result = h_filter_8(in, start, coef, ntaps, j);
+        result = _mm_packus_epi16(result, result);
+        if (outStride == 1)
+        {
+            _mm_storel_epi64((__m128i*)out, result);
+            out += 8;
+        }
+        else
+        {
+            _mm_storel_epi64((__m128i*)pix, result);
+            for (t = 0; t < 8; t++)
+            {
+                *out = pix[t];
+                out += outStride;
+            }
+        }
+    }
+#endif
+    for (; j < w; j++)
+    {
+        const int16_t* src = in + start[j];
+        const int16_t* c = coef + j * ntaps;
+        int acc = 1 << (H_SHIFT - 1);
+        for (t = 0; t < ntaps; t++)
+            acc += src[t] * c[t];
+        acc >>= H_SHIFT;
+        *out = (BYTE)(acc < 0 ? 0 : (acc > 255 ? 255 : acc));
+        out += outStride;
+    }
+}
+
+int downconvert(const downconvert_filter* filter,
+                const YUV_frame* in_frame, YUV_frame* out_frame,
+                int first_line, int num_lines,
+                void* workSpace, size_t workSize)
+{
+    const BYTE**    rows;
+    const BYTE*     base = NULL;
+    int16_t*        packed;
+    int16_t*        plane[3];
+    const component* in_comp[3];
+    component*      out_comp[3];
+    int             packed_in;
+    int             c, j, t;
+
+    if (first_line < 0 || num_lines < 0 ||
+        first_line + num_lines > filter->out_h)
+        return YUV_size_error;
+    if (in_frame->Y.w != filter->in_w || in_frame->Y.h != filter->in_h ||
+        in_frame->U.w != filter->in_w / 2 || in_frame->U.h != filter->in_h ||
+        out_frame->Y.w != filter->out_w || out_frame->Y.h != filter->out_h ||
+        out_frame->U.w != filter->out_w / 2 ||
+        out_frame->U.h != filter->out_h)
+        return YUV_size_error;
+    if (workSize < downconvert_work_size(filter))
+        return YUV_workspace;
+
+    in_comp[0] = &in_frame->Y;
+    in_comp[1] = &in_frame->U;
+    in_comp[2] = &in_frame->V;
+    out_comp[0] = &out_frame->Y;
+    out_comp[1] = &out_frame->U;
+    out_comp[2] = &out_frame->V;
+    packed_in = in_frame->Y.pixelStride == 2 &&
+                in_frame->U.pixelStride == 4 &&
+                in_frame->V.pixelStride == 4 &&
+                in_frame->U.lineStride == in_frame->Y.lineStride &&
+                in_frame->V.lineStride == in_frame->Y.lineStride;
+    if (packed_in)
+    {
+        base = in_frame->Y.buff;
+        for (c = 1; c < 3; c++)
+            if (in_comp[c]->buff < base)
+                base = in_comp[c]->buff;
+        for (c = 0; c < 3; c++)
+            if (in_comp[c]->buff - base > 3)
+                return YUV_format_error;
+    }
+    else
+    {
+        for (c = 0; c < 3; c++)
+            if (in_comp[c]->pixelStride != 1)
+                return YUV_format_error;
+    }
+
+    // carve up workspace, 16 byte aligned
+    rows = (const BYTE**)(((uintptr_t)workSpace + 15) & ~(uintptr_t)15);
+    packed = (int16_t*)(((uintptr_t)(rows + filter->v_taps) + 15) &
+                        ~(uintptr_t)15);
+    plane[0] = packed + packed_size(filter);
+    plane[1] = plane[0] + plane_size(filter, 0);
+    plane[2] = plane[1] + plane_size(filter, 1);
+    // clear the padding read by the last horizontal windows
+    for (c = 0; c < 3; c++)
+        memset(plane[c] + (filter->in_w >> (c ? 1 : 0)), 0,
+               filter->h_taps[c ? 1 : 0] * sizeof(int16_t));
+
+    for (j = first_line; j < first_line + num_lines; j++)
+    {
+        const int*      line = &filter->v_line[j * filter->v_taps];
+        const int16_t*  v_coef = &filter->v_coef[j * filter->v_taps];
+        if (packed_in)
+        {
+            for (t = 0; t < filter->v_taps; t++)
+                rows[t] = base + line[t] * in_frame->Y.lineStride;
+            v_filter(rows, v_coef, filter->v_taps, filter->in_w * 2, packed);
+            deinterleave(packed, filter->in_w,
+                         in_frame->Y.buff - base, in_frame->U.buff - base,
+                         in_frame->V.buff - base,
+                         plane[0], plane[1], plane[2]);
+        }
+        else
+        {
+            for (c = 0; c < 3; c++)
+            {
+                for (t = 0; t < filter->v_taps; t++)
+                    rows[t] = in_comp[c]->buff +
+                              line[t] * in_comp[c]->lineStride;
+                v_filter(rows, v_coef, filter->v_taps, in_comp[c]->w,
+                         plane[c]);
+            }
+        }
+        for (c = 0; c < 3; c++)
+        {
+            int h = c ? 1 : 0;
+            h_filter(plane[c], filter->h_start[h], filter->h_coef[h],
+                     filter->h_taps[h], out_comp[c]->w,
+                     out_comp[c]->buff + j * out_comp[c]->lineStride,
+                     out_comp[c]->pixelStride);
+        }
+    }
+    return YUV_OK;
+}
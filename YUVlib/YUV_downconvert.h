@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2012 British Broadcasting Corporation, All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __YUVLIB_DOWNCONVERT__
+#define __YUVLIB_DOWNCONVERT__
+
+#include <stddef.h> // for size_t
+
+#include "YUV_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Polyphase 4:2:2 picture resizer, intended for HD to SD downconversion.
+// The filter is a Lanczos (a=2) kernel stretched by the resize ratio, with
+// coefficients computed once for each output sample and line.
+typedef struct downconvert_filter downconvert_filter;
+
+/* Create a filter to resize in_w x in_h pictures to out_w x out_h.
+ * If the video is interlaced, setting intlc to 1 has each field filtered
+ * separately with the vertical phase of each field's lines taken into
+ * account, so that the output fields are not shifted relative to each other.
+ * Chroma is treated as co-sited with the even luma samples.
+ * Returns NULL on failure.
+ */
+downconvert_filter* downconvert_create(int in_w, int in_h,
+                                       int out_w, int out_h, int intlc);
+
+void downconvert_free(downconvert_filter* filter);
+
+/* Size in bytes of the workSpace needed by each call of downconvert().
+ */
+size_t downconvert_work_size(const downconvert_filter* filter);
+
+/* Resize output lines first_line to first_line + num_lines - 1 of in_frame
+ * into out_frame. Different line ranges can be processed concurrently,
+ * each with its own workSpace.
+ * in_frame must be 4:2:2, either packed (UYVY, YUY2, YVYU, HDYC) or planar
+ * (Y42B, YV16). out_frame can be any 4:2:2 YUV_frame.
+ * workSpace is allocated by the caller and must be at least
+ * downconvert_work_size() bytes.
+ * Return value is 0 for success, <0 for failure.
+ */
+int downconvert(const downconvert_filter* filter,
+                const YUV_frame* in_frame, YUV_frame* out_frame,
+                int first_line, int num_lines,
+                void* workSpace, size_t workSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __YUVLIB_DOWNCONVERT__
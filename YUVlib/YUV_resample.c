@@ -113,34 +113,34 @@ static void h_up_2_121(BYTE* srcLine, BYTE* dstLine,
     *dstLine = in_0;
 }
 
-int to_444(YUV_frame* in_frame, YUV_frame* out_frame,
-           void* workSpace)
+// Parameters of a to_444_bands() call
+typedef struct
 {
-    int     ssx, ssy;
-    int     w, h;
+    const YUV_frame*    in_frame;
+    YUV_frame*          out_frame;
+    int                 w, h;
+    int                 num_bands;
+} resample_job;
+
+// Resample the lines of band number 'band'
+static void to_444_band(void* arg, int band)
+{
+    const resample_job* job = arg;
+    const YUV_frame*    in_frame = job->in_frame;
+    YUV_frame*          out_frame = job->out_frame;
+    int     w = job->w;
+    int     j_first, j_last, j;
     BYTE*   inBuff0;
     BYTE*   inBuff1;
     BYTE*   outBuff0;
     BYTE*   outBuff1;
-    int     j;
 
-    // check out_frame is a 4:4:4 format
-    ssx = out_frame->Y.w / out_frame->U.w;
-    ssy = out_frame->Y.h / out_frame->U.h;
-    if ((ssx != 1) || (ssy != 1))
-        return YUV_Fail;
-    // check in_frame format
-    ssx = in_frame->Y.w / in_frame->U.w;
-    ssy = in_frame->Y.h / in_frame->U.h;
-    if ((ssx != 2) || (ssy != 1))
-        return YUV_Fail;    // can only convert from 4:2:2 so far
-    // get dimensions of area to be written
-    w = min(in_frame->Y.w, out_frame->Y.w);
-    h = min(in_frame->Y.h, out_frame->Y.h);
+    j_first = job->h * band / job->num_bands;
+    j_last = job->h * (band + 1) / job->num_bands;
     // copy Y
-    inBuff0 = in_frame->Y.buff;
-    outBuff0 = out_frame->Y.buff;
-    for (j = h; j != 0; j--)
+    inBuff0 = in_frame->Y.buff + (j_first * in_frame->Y.lineStride);
+    outBuff0 = out_frame->Y.buff + (j_first * out_frame->Y.lineStride);
+    for (j = j_first; j < j_last; j++)
     {
         h_copy(inBuff0, outBuff0,
                in_frame->Y.pixelStride, out_frame->Y.pixelStride, w);
@@ -148,11 +148,11 @@ int to_444(YUV_frame* in_frame, YUV_frame* out_frame,
         outBuff0 += out_frame->Y.lineStride;
     }
     // upsample U & V
-    inBuff0 = in_frame->U.buff;
-    inBuff1 = in_frame->V.buff;
-    outBuff0 = out_frame->U.buff;
-    outBuff1 = out_frame->V.buff;
-    for (j = h; j != 0; j--)
+    inBuff0 = in_frame->U.buff + (j_first * in_frame->U.lineStride);
+    inBuff1 = in_frame->V.buff + (j_first * in_frame->V.lineStride);
+    outBuff0 = out_frame->U.buff + (j_first * out_frame->U.lineStride);
+    outBuff1 = out_frame->V.buff + (j_first * out_frame->V.lineStride);
+    for (j = j_first; j < j_last; j++)
     {
         h_up_2_121(inBuff0, outBuff0,
                    in_frame->U.pixelStride, out_frame->U.pixelStride, w);
@@ -163,5 +163,37 @@ int to_444(YUV_frame* in_frame, YUV_frame* out_frame,
         outBuff0 += out_frame->U.lineStride;
         outBuff1 += out_frame->V.lineStride;
     }
-    return YUV_OK;
+}
+
+int to_444_bands(YUV_frame* in_frame, YUV_frame* out_frame,
+                 YUV_thread_pool* pool, int num_bands)
+{
+    int     ssx, ssy;
+    resample_job    job;
+
+    // check out_frame is a 4:4:4 format
+    ssx = out_frame->Y.w / out_frame->U.w;
+    ssy = out_frame->Y.h / out_frame->U.h;
+    if ((ssx != 1) || (ssy != 1))
+        return YUV_Fail;
+    // check in_frame format
+    ssx = in_frame->Y.w / in_frame->U.w;
+    ssy = in_frame->Y.h / in_frame->U.h;
+    if ((ssx != 2) || (ssy != 1))
+        return YUV_Fail;    // can only convert from 4:2:2 so far
+    if (num_bands < 1)
+        return YUV_Fail;
+    // get dimensions of area to be written
+    job.in_frame = in_frame;
+    job.out_frame = out_frame;
+    job.w = min(in_frame->Y.w, out_frame->Y.w);
+    job.h = min(in_frame->Y.h, out_frame->Y.h);
+    job.num_bands = num_bands;
+    return YUV_run_bands(pool, to_444_band, &job, num_bands);
+}
+
+int to_444(YUV_frame* in_frame, YUV_frame* out_frame,
+           void* workSpace)
+{
+    return to_444_bands(in_frame, out_frame, NULL, 1);
 }
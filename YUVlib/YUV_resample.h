@@ -25,6 +25,7 @@
 #define __YUVLIB_RESAMPLE__
 
 #include "YUV_frame.h"
+#include "YUV_threads.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,6 +36,12 @@ extern "C" {
 int to_444(YUV_frame* in_frame, YUV_frame* out_frame,
            void* workSpace);
 
+/* As to_444(), but with the lines split into num_bands bands that are run
+ * on the threads of pool (which can be NULL).
+ */
+int to_444_bands(YUV_frame* in_frame, YUV_frame* out_frame,
+                 YUV_thread_pool* pool, int num_bands);
+
 #ifdef __cplusplus
 }
 #endif
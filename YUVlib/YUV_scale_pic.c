@@ -20,11 +20,12 @@
 #include <string.h> // for memset
 #include <stdint.h> // for uint32_t
 #include <stdio.h>
-#ifdef _OPENMP
-  #include <omp.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
 #endif
 
 #include "YUV_frame.h"
+#include "YUV_threads.h"
 #include "YUV_scale_pic.h"
 
 static inline int max(int a, int b)
@@ -125,6 +126,63 @@ static void h_sub_scale_alias(const BYTE* srcLine, uint32_t* dstLine,
     }
 }
 
+// Double the size of a line with interpolation. Output samples alternate
+// between copies of input samples and averages of adjacent pairs.
+static void h_up_2_scale_interp(const BYTE* srcLine, uint32_t* dstLine,
+                                const int inStride, const int w)
+{
+    int     i = 0;
+
+#if defined(__SSE2__)
+    if (inStride == 1 || inStride == 2)
+    {
+        const __m128i   zero = _mm_setzero_si128();
+        const __m128i   mask = _mm_set1_epi16(0xff);
+        __m128i         inpA, inpB, even, odd, lo, hi;
+        // 8 input samples to 16 output samples at a time, including the
+        // sample after the last one used
+        for (; i + 18 <= w; i += 16)
+        {
+            const BYTE* src = srcLine + (i / 2) * inStride;
+            if (inStride == 1)
+            {
+                inpA = _mm_unpacklo_epi8(
+                        _mm_loadl_epi64((const __m128i*)src), zero);
+                inpB = _mm_unpacklo_epi8(
+                        _mm_loadl_epi64((const __m128i*)(src + 1)), zero);
+            }
+            else
+            {
+                inpA = _mm_and_si128(
+                        _mm_loadu_si128((const __m128i*)src), mask);
+                inpB = _mm_and_si128(
+                        _mm_loadu_si128((const __m128i*)(src + 2)), mask);
+            }
+            even = _mm_slli_epi16(inpA, 8);
+            odd = _mm_slli_epi16(_mm_add_epi16(inpA, inpB), 7);
+            lo = _mm_unpacklo_epi16(even, odd);
+            hi = _mm_unpackhi_epi16(even, odd);
+            _mm_storeu_si128((__m128i*)(dstLine + i),
+                             _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128((__m128i*)(dstLine + i + 4),
+                             _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128((__m128i*)(dstLine + i + 8),
+                             _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128((__m128i*)(dstLine + i + 12),
+                             _mm_unpackhi_epi16(hi, zero));
+        }
+    }
+#endif
+    for (; i < w; i++)
+    {
+        const BYTE* src = srcLine + (i / 2) * inStride;
+        if (i % 2 == 0)
+            dstLine[i] = src[0] * 256;
+        else
+            dstLine[i] = (src[0] + src[inStride]) * 128;
+    }
+}
+
 // Scale a line with interpolation
 static void h_sub_scale_interp(const BYTE* srcLine, uint32_t* dstLine,
                                const int inStride,
@@ -136,6 +194,11 @@ static void h_sub_scale_interp(const BYTE* srcLine, uint32_t* dstLine,
     uint32_t    beta;
     uint32_t    inpA, inpB;
 
+    if (xup == (xdown * 2))
+    {
+        h_up_2_scale_interp(srcLine, dstLine, inStride, w);
+        return;
+    }
     // first input and output samples are cosited
     err = xup;
     // get first input
@@ -160,6 +223,58 @@ static void h_sub_scale_interp(const BYTE* srcLine, uint32_t* dstLine,
     }
 }
 
+#if defined(__SSE2__)
+// Halve the size of output samples first to last - 1 of a line with a
+// 1/4, 1/2, 1/4 filter. Returns the number of samples done.
+static int h_down_2_ave_sse2(const BYTE* srcLine, uint32_t* dstLine,
+                             const int inStride, int first, int last)
+{
+    const __m128i   zero = _mm_setzero_si128();
+    int             i = first;
+
+    if (inStride == 1)
+    {
+        const __m128i   mask = _mm_set1_epi16(0xff);
+        // 8 outputs at a time, reading 17 input samples
+        for (; i + 8 <= last; i += 8)
+        {
+            const BYTE* src = srcLine + (i * 2) - 1;
+            __m128i a = _mm_loadu_si128((const __m128i*)src);
+            __m128i b = _mm_loadu_si128((const __m128i*)(src + 2));
+            __m128i left = _mm_and_si128(a, mask);
+            __m128i centre = _mm_srli_epi16(a, 8);
+            __m128i right = _mm_and_si128(b, mask);
+            __m128i sum = _mm_slli_epi16(
+                    _mm_add_epi16(_mm_add_epi16(left, right),
+                                  _mm_add_epi16(centre, centre)), 6);
+            _mm_storeu_si128((__m128i*)(dstLine + i),
+                             _mm_unpacklo_epi16(sum, zero));
+            _mm_storeu_si128((__m128i*)(dstLine + i + 4),
+                             _mm_unpackhi_epi16(sum, zero));
+        }
+    }
+    else if (inStride == 2)
+    {
+        const __m128i   mask = _mm_set1_epi32(0xff);
+        // 4 outputs at a time, reading 9 input samples
+        for (; i + 4 <= last; i += 4)
+        {
+            const BYTE* src = srcLine + ((i * 2) - 1) * 2;
+            __m128i a = _mm_loadu_si128((const __m128i*)src);
+            __m128i b = _mm_loadu_si128((const __m128i*)(src + 4));
+            __m128i left = _mm_and_si128(a, mask);
+            __m128i centre = _mm_and_si128(_mm_srli_epi32(a, 16), mask);
+            __m128i right = _mm_and_si128(b, mask);
+            __m128i sum = _mm_slli_epi32(
+                    _mm_add_epi32(_mm_add_epi32(left, right),
+                                  _mm_add_epi32(centre, centre)), 6);
+            _mm_storeu_si128((__m128i*)(dstLine + i), sum);
+        }
+    }
+    return i - first;
+}
+#endif
+
 // Scale a line with averaging
 static void h_sub_scale_ave(const BYTE* srcLine, uint32_t* dstLine,
                             const int inStride,
@@ -180,8 +295,20 @@ static void h_sub_scale_ave(const BYTE* srcLine, uint32_t* dstLine,
         part = 64 * *srcLine;
         srcLine += inStride;
         *dstLine++ = acc + part;
+        i = 1;
+#if defined(__SSE2__)
+        {
+            // vector loads read one sample beyond the last one used
+            int done = h_down_2_ave_sse2(srcLine - (inStride * 2),
+                                         dstLine - 1, inStride, 1, w - 1);
+            i += done;
+            dstLine += done;
+            srcLine += inStride * 2 * done;
+            part = 64 * *(srcLine - inStride);
+        }
+#endif
         // rest of samples are easier
-        for (i = 1; i < w; i++)
+        for (; i < w; i++)
         {
             acc = part + (128 * *srcLine);
             srcLine += inStride;
@@ -348,7 +475,8 @@ typedef void sub_line_proc2(const BYTE*, BYTE*, const int, const int,
 
 static void v_sub_alias(const component* inFrame, component* outFrame,
                         const int hfil, int xup, int xdown,
-                        int yup, int ydown, int yoff, uint32_t** work)
+                        int yup, int ydown, int yoff,
+                        int y_first, int y_last, uint32_t* work)
 {
     BYTE*   inBuff = inFrame->buff;
     BYTE*   outBuff = outFrame->buff;
@@ -356,6 +484,7 @@ static void v_sub_alias(const component* inFrame, component* outFrame,
     int     dy_int;
     int     dy_frac;
     int     err;
+    int     skip;
     sub_line_proc2* h_sub;
 
     // select horizontal subsampling routine
@@ -372,7 +501,13 @@ static void v_sub_alias(const component* inFrame, component* outFrame,
     err = yup / 2;
     // adjust for offset (percentage of output sample)
     err += ((ydown - yup) * yoff) / 100;
-    for (j = 0; j < outFrame->h; j++)
+    // move on to first line, as if lines before it had been done
+    err += dy_frac * y_first;
+    skip = err > yup ? (err - 1) / yup : 0;
+    err -= skip * yup;
+    inBuff += inFrame->lineStride * ((dy_int * y_first) + skip);
+    outBuff += outFrame->lineStride * y_first;
+    for (j = y_first; j < y_last; j++)
     {
         while (err > yup)
         {
@@ -381,7 +516,7 @@ static void v_sub_alias(const component* inFrame, component* outFrame,
         }
         h_sub(inBuff, outBuff,
               inFrame->pixelStride, outFrame->pixelStride,
-              xup, xdown, outFrame->w, work[0]);
+              xup, xdown, outFrame->w, work);
         outBuff += outFrame->lineStride;
         inBuff += inFrame->lineStride * dy_int;
         err += dy_frac;
@@ -436,7 +571,7 @@ typedef void sub_line_proc1(const BYTE*, uint32_t*, const int, int, int, const i
 static void v_sub_interp(const component* inFrame, component* outFrame,
                          const int hfil, int xup, int xdown,
                          int yup, int ydown, int yoff,
-                         void* work, size_t workSize)
+                         int y_first, int y_last, uint32_t* work)
 {
     const BYTE*     inBuff = inFrame->buff;
     BYTE*           outBuff = outFrame->buff;
@@ -444,9 +579,8 @@ static void v_sub_interp(const component* inFrame, component* outFrame,
     int             y_off;
     int             y_out;
     int             err;
-    uint32_t*       line0;
-    uint32_t*       line1;
-    int             tid;
+    uint32_t*       line0 = work;
+    uint32_t*       line1 = work + outFrame->w;
     sub_line_proc1* h_sub;
 
     // select horizontal subsampling routine
@@ -458,26 +592,9 @@ static void v_sub_interp(const component* inFrame, component* outFrame,
         h_sub = &h_sub_scale_ave;
     // adjust for offset (percentage of output sample)
     y_off = ((ydown - yup) * 256 * yoff) / (yup * 100);
-    // how many threads to create
-    #ifdef _OPENMP
-      int num_threads;
-      num_threads = workSize / (sizeof(uint32_t) * 2 * outFrame->w);
-      num_threads = min(num_threads, omp_get_max_threads());
-    #endif
-    #pragma omp parallel for \
-        default (shared) \
-        private(y_out,y_in,y_in_sup,err,line0,line1,tid) \
-        num_threads (num_threads)
-    for (y_out = 0; y_out < outFrame->h; y_out++)
+    for (y_out = y_first; y_out < y_last; y_out++)
     {
-        #ifdef _OPENMP
-          tid = omp_get_thread_num();
-        #else
-          tid = 0;
-        #endif
-        line0 = work + (sizeof(uint32_t) * tid * 2 * outFrame->w);
-        line1 = line0 + outFrame->w;
-        y_in_sup = (y_out * ydown * 256 / yup) + y_off;
+        y_in_sup = max((y_out * ydown * 256 / yup) + y_off, 0);
         y_in = y_in_sup / 256;
         err = y_in_sup - (y_in * 256);
         h_sub(&inBuff[max(y_in, 0) * inFrame->lineStride], line0,
@@ -496,7 +613,7 @@ static void v_sub_interp(const component* inFrame, component* outFrame,
 static void v_sub_ave(const component* inFrame, component* outFrame,
                       const int hfil, int xup, int xdown,
                       int yup, int ydown, int yoff,
-                      void* work, size_t workSize)
+                      int y_first, int y_last, uint32_t* work)
 {
     const BYTE*     inBuff = inFrame->buff;
     BYTE*           outBuff = outFrame->buff;
@@ -506,9 +623,8 @@ static void v_sub_ave(const component* inFrame, component* outFrame,
     int             y_in, y_in0, y_in1;
     int             err;
     uint32_t        scale, residue;
-    uint32_t*       acc;
-    uint32_t*       line;
-    int             tid;
+    uint32_t*       acc = work;
+    uint32_t*       line = work + outFrame->w;
     sub_line_proc1* h_sub;
 
     // select horizontal subsampling routine
@@ -522,25 +638,8 @@ static void v_sub_ave(const component* inFrame, component* outFrame,
     y_off = (yup - ydown) / 2;
     // adjust for offset (percentage of output sample)
     y_off += ((ydown - yup) * yoff) / 100;
-    // how many threads to create
-    #ifdef _OPENMP
-      int num_threads;
-      num_threads = workSize / (sizeof(uint32_t) * 2 * outFrame->w);
-      num_threads = min(num_threads, omp_get_max_threads());
-    #endif
-    #pragma omp parallel for \
-        default (shared) \
-        private(y_out,y_in,y_in0,y_in1,err,y_idx,scale,residue,acc,line,tid) \
-        num_threads (num_threads)
-    for (y_out = 0; y_out < outFrame->h; y_out++)
+    for (y_out = y_first; y_out < y_last; y_out++)
     {
-        #ifdef _OPENMP
-          tid = omp_get_thread_num();
-        #else
-          tid = 0;
-        #endif
-        acc = work + (sizeof(uint32_t) * tid * 2 * outFrame->w);
-        line = acc + outFrame->w;
         y_in0 = (y_out * ydown) + y_off;
         y_in1 = y_in0 + ydown;
         if (y_in0 < 0)
@@ -584,17 +683,80 @@ static void v_sub_ave(const component* inFrame, component* outFrame,
 static void scale_comp(const component* inFrame, component* outFrame,
                        const int hfil, const int vfil,
                        int xup, int xdown, int yup, int ydown,
-                       int yoff, uint32_t** work, size_t workSize)
+                       int yoff, int y_first, int y_last, uint32_t* work)
 {
     if (vfil <= 0 || yup == ydown)
         v_sub_alias(inFrame, outFrame, hfil, xup, xdown,
-                    yup, ydown, yoff, work);
+                    yup, ydown, yoff, y_first, y_last, work);
     else if (yup > ydown)
         v_sub_interp(inFrame, outFrame, hfil, xup, xdown,
-                     yup, ydown, yoff, work[0], workSize);
+                     yup, ydown, yoff, y_first, y_last, work);
     else
         v_sub_ave(inFrame, outFrame, hfil, xup, xdown,
-                  yup, ydown, yoff, work[0], workSize);
+                  yup, ydown, yoff, y_first, y_last, work);
+}
+
+// A component, or one field of a component, to be scaled
+typedef struct
+{
+    component   in;
+    component   out;
+    int         xup, xdown, yup, ydown;
+    int         yoff;
+} scale_part;
+
+typedef struct
+{
+    scale_part  part[6];
+    int         num_parts;
+    int         hfil, vfil;
+    int         num_bands;
+    void**      workSpaces;
+} scale_job;
+
+static void add_part(scale_job* job, const component* in, component* out,
+                     int xup, int xdown, int yup, int ydown, int intlc)
+{
+    scale_part* part;
+    int     f;
+
+    for (f = 0; f < (intlc ? 2 : 1); f++)
+    {
+        part = &job->part[job->num_parts++];
+        if (intlc)
+        {
+            extract_field(in, &part->in, f);
+            extract_field(out, &part->out, f);
+        }
+        else
+        {
+            part->in = *in;
+            part->out = *out;
+        }
+        part->xup = xup;
+        part->xdown = xdown;
+        part->yup = yup;
+        part->ydown = ydown;
+        part->yoff = f * 50;
+    }
+}
+
+// Scale the lines of each part that are in band number 'band'
+static void scale_band(void* arg, int band)
+{
+    scale_job*  job = arg;
+    scale_part* part;
+    int     p;
+
+    for (p = 0; p < job->num_parts; p++)
+    {
+        part = &job->part[p];
+        scale_comp(&part->in, &part->out, job->hfil, job->vfil,
+                   part->xup, part->xdown, part->yup, part->ydown, part->yoff,
+                   part->out.h * band / job->num_bands,
+                   part->out.h * (band + 1) / job->num_bands,
+                   job->workSpaces[band]);
+    }
 }
 
 int resize_component(const component* in_frame, component* out_frame,
@@ -603,7 +765,7 @@ int resize_component(const component* in_frame, component* out_frame,
                      void* workSpace, size_t workSize)
 {
     component   sub_frame;
-    uint32_t*   work[2];
+    scale_job   job;
 
     // adjust position, if required
     if (intlc)
@@ -617,39 +779,29 @@ int resize_component(const component* in_frame, component* out_frame,
     // check work space size
     if (workSize < sizeof(uint32_t) * 2 * sub_frame.w)
         return YUV_workspace;
-    work[0] = workSpace;
-    work[1] = work[0] + sub_frame.w;
-    if (intlc)
-    {
-        component   in_field;
-        component   out_field;
-        int     f;
-        for (f = 0; f < 2; f++)
-        {
-            extract_field(in_frame, &in_field, f);
-            extract_field(&sub_frame, &out_field, f);
-            scale_comp(&in_field, &out_field, hfil, vfil,
-                       xup, xdown, yup, ydown, f * 50, work, workSize);
-        }
-    }
-    else // not interlaced
-    {
-        scale_comp(in_frame, &sub_frame, hfil, vfil,
-                   xup, xdown, yup, ydown, 0, work, workSize);
-    }
+    job.num_parts = 0;
+    job.hfil = hfil;
+    job.vfil = vfil;
+    job.num_bands = 1;
+    job.workSpaces = &workSpace;
+    add_part(&job, in_frame, &sub_frame, xup, xdown, yup, ydown, intlc);
+    scale_band(&job, 0);
     return YUV_OK;
 }
 
-int resize_pic(const YUV_frame* in_frame, YUV_frame* out_frame,
-               int x, int y, int xup, int xdown, int yup, int ydown,
-               int intlc, int hfil, int vfil,
-               void* workSpace, size_t workSize)
+int resize_pic_bands(const YUV_frame* in_frame, YUV_frame* out_frame,
+                     int x, int y, int xup, int xdown, int yup, int ydown,
+                     int intlc, int hfil, int vfil,
+                     YUV_thread_pool* pool, int num_bands,
+                     void** workSpaces, size_t workSize)
 {
     int     ssx_in, ssx_out;
     int     ssy_in, ssy_out;
     YUV_frame   sub_frame;
-    uint32_t*   work[2];
+    scale_job   job;
 
+    if (num_bands < 1)
+        return YUV_Fail;
     // make up and down numbers even, for later convenience
     xup = xup * 2;
     xdown = xdown * 2;
@@ -688,43 +840,31 @@ int resize_pic(const YUV_frame* in_frame, YUV_frame* out_frame,
     // check work space size
     if (workSize < sizeof(uint32_t) * 2 * sub_frame.Y.w)
         return YUV_workspace;
-    work[0] = workSpace;
-    work[1] = work[0] + sub_frame.Y.w;
-    if (intlc)
-    {
-        component   in_field;
-        component   out_field;
-        int     f;
-        for (f = 0; f < 2; f++)
-        {
-            extract_field(&in_frame->Y, &in_field, f);
-            extract_field(&sub_frame.Y, &out_field, f);
-            scale_comp(&in_field, &out_field, hfil, vfil,
-                       xup, xdown, yup, ydown, f * 50, work, workSize);
-            extract_field(&in_frame->U, &in_field, f);
-            extract_field(&sub_frame.U, &out_field, f);
-            scale_comp(&in_field, &out_field, hfil, vfil,
-                       ssx_in * xup, xdown * ssx_out,
-                       ssy_in * yup, ydown * ssy_out, f * 50, work, workSize);
-            extract_field(&in_frame->V, &in_field, f);
-            extract_field(&sub_frame.V, &out_field, f);
-            scale_comp(&in_field, &out_field, hfil, vfil,
-                       ssx_in * xup, xdown * ssx_out,
-                       ssy_in * yup, ydown * ssy_out, f * 50, work, workSize);
-        }
-    }
-    else // not interlaced
-    {
-        scale_comp(&in_frame->Y, &sub_frame.Y, hfil, vfil,
-                   xup, xdown, yup, ydown, 0, work, workSize);
-        scale_comp(&in_frame->U, &sub_frame.U, hfil, vfil,
-                   ssx_in * xup, xdown * ssx_out,
-                   ssy_in * yup, ydown * ssy_out, 0, work, workSize);
-        scale_comp(&in_frame->V, &sub_frame.V, hfil, vfil,
-                   ssx_in * xup, xdown * ssx_out,
-                   ssy_in * yup, ydown * ssy_out, 0, work, workSize);
-    }
-    return YUV_OK;
+    job.num_parts = 0;
+    job.hfil = hfil;
+    job.vfil = vfil;
+    job.num_bands = num_bands;
+    job.workSpaces = workSpaces;
+    add_part(&job, &in_frame->Y, &sub_frame.Y,
+             xup, xdown, yup, ydown, intlc);
+    add_part(&job, &in_frame->U, &sub_frame.U,
+             ssx_in * xup, xdown * ssx_out,
+             ssy_in * yup, ydown * ssy_out, intlc);
+    add_part(&job, &in_frame->V, &sub_frame.V,
+             ssx_in * xup, xdown * ssx_out,
+             ssy_in * yup, ydown * ssy_out, intlc);
+    return YUV_run_bands(pool, scale_band, &job, num_bands);
+}
+
+int resize_pic(const YUV_frame* in_frame, YUV_frame* out_frame,
+               int x, int y, int xup, int xdown, int yup, int ydown,
+               int intlc, int hfil, int vfil,
+               void* workSpace, size_t workSize)
+{
+    return resize_pic_bands(in_frame, out_frame, x, y,
+                            xup, xdown, yup, ydown,
+                            intlc, hfil, vfil,
+                            NULL, 1, &workSpace, workSize);
 }
 
 int scale_component(const component* in_frame, component* out_frame,
@@ -746,3 +886,15 @@ int scale_pic(const YUV_frame* in_frame, YUV_frame* out_frame,
                       w, in_frame->Y.w, h, in_frame->Y.h,
                       intlc, hfil, vfil, workSpace, workSize);
 }
+
+int scale_pic_bands(const YUV_frame* in_frame, YUV_frame* out_frame,
+                    int x, int y, int w, int h,
+                    int intlc, int hfil, int vfil,
+                    YUV_thread_pool* pool, int num_bands,
+                    void** workSpaces, size_t workSize)
+{
+    return resize_pic_bands(in_frame, out_frame, x, y,
+                            w, in_frame->Y.w, h, in_frame->Y.h,
+                            intlc, hfil, vfil,
+                            pool, num_bands, workSpaces, workSize);
+}
@@ -25,6 +25,7 @@
 #define __YUVLIB_SCALE_PIC__
 
 #include "YUV_frame.h"
+#include "YUV_threads.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,8 +39,6 @@ extern "C" {
  * processed separately.
  * workSpace is allocated by the caller and must be large enough to store
  * 2 lines of output as uint32_t, i.e. (2*(in_frame->w*xup/xdown)*4) bytes.
- * If compiled with openMP enabled the workSpace size should be multiplied
- * by the number of threads to be used, e.g. the number of processor cores.
  * Return value is 0 for success, <0 for failure.
  */
 int resize_component(const component* in_frame, component* out_frame,
@@ -51,6 +50,18 @@ int resize_pic(const YUV_frame* in_frame, YUV_frame* out_frame,
                int intlc, int hfil, int vfil,
                void* workSpace, size_t workSize);
 
+/* As resize_pic(), but with the output lines split into num_bands bands
+ * that are run on the threads of pool (which can be NULL).
+ * workSpaces is an array of num_bands workSpace pointers, each of at least
+ * workSize bytes, with workSize the same as for resize_pic().
+ * The output is the same as resize_pic() for any number of bands.
+ */
+int resize_pic_bands(const YUV_frame* in_frame, YUV_frame* out_frame,
+                     int x, int y, int xup, int xdown, int yup, int ydown,
+                     int intlc, int hfil, int vfil,
+                     YUV_thread_pool* pool, int num_bands,
+                     void** workSpaces, size_t workSize);
+
 /* Make a different size copy of in_frame in out_frame at position x,y and
  * size w x h.
  * The trade off between quality and speed is set by hfil & vfil. Fastest
@@ -60,8 +71,6 @@ int resize_pic(const YUV_frame* in_frame, YUV_frame* out_frame,
  * processed separately.
  * workSpace is allocated by the caller and must be large enough to store
  * 2 lines of output as uint32_t, i.e. (2 * w * 4) bytes.
- * If compiled with openMP enabled the workSpace size should be multiplied
- * by the number of threads to be used, e.g. the number of processor cores.
  * Return value is 0 for success, <0 for failure.
  */
 int scale_component(const component* in_frame, component* out_frame,
@@ -73,6 +82,14 @@ int scale_pic(const YUV_frame* in_frame, YUV_frame* out_frame,
               int intlc, int hfil, int vfil,
               void* workSpace, size_t workSize);
 
+/* As scale_pic(), but split into bands in the same way as resize_pic_bands().
+ */
+int scale_pic_bands(const YUV_frame* in_frame, YUV_frame* out_frame,
+                    int x, int y, int w, int h,
+                    int intlc, int hfil, int vfil,
+                    YUV_thread_pool* pool, int num_bands,
+                    void** workSpaces, size_t workSize);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2012 British Broadcasting Corporation, All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdlib.h> // for malloc
+#include <unistd.h> // for sysconf
+#include <pthread.h>
+
+#include "YUV_frame.h"
+#include "YUV_threads.h"
+
+// One call of YUV_run_bands(). It is on the pool's list while it has bands
+// that haven't been started.
+typedef struct band_job
+{
+    YUV_band_proc*      proc;
+    void*               arg;
+    int                 num_bands;
+    int                 next_band;
+    int                 bands_done;
+    struct band_job*    next;
+} band_job;
+
+struct YUV_thread_pool
+{
+    pthread_t*          threads;
+    int                 num_threads;
+    pthread_mutex_t     lock;
+    pthread_cond_t      work_ready;
+    pthread_cond_t      band_done;
+    band_job*           jobs;
+    int                 stop;
+};
+
+// Take the next band of job, with pool locked
+static int take_band(YUV_thread_pool* pool, band_job* job)
+{
+    int         band;
+    band_job**  link;
+
+    band = job->next_band++;
+    if (job->next_band == job->num_bands)
+    {
+        for (link = &pool->jobs; *link != job; link = &(*link)->next)
+            ;
+        *link = job->next;
+    }
+    return band;
+}
+
+static void* pool_thread(void* arg)
+{
+    YUV_thread_pool*    pool = arg;
+    band_job*           job;
+    int                 band;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1)
+    {
+        while (!pool->stop && pool->jobs == NULL)
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        if (pool->stop)
+            break;
+        job = pool->jobs;
+        band = take_band(pool, job);
+        pthread_mutex_unlock(&pool->lock);
+        job->proc(job->arg, band);
+        pthread_mutex_lock(&pool->lock);
+        job->bands_done++;
+        if (job->bands_done == job->num_bands)
+            pthread_cond_broadcast(&pool->band_done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+YUV_thread_pool* YUV_thread_pool_create(int num_threads)
+{
+    YUV_thread_pool*    pool;
+    int                 i;
+
+    if (num_threads < 0)
+    {
+        num_threads = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+        if (num_threads < 0)
+            num_threads = 0;
+    }
+    pool = calloc(1, sizeof(YUV_thread_pool));
+    if (pool == NULL)
+        return NULL;
+    if (num_threads > 0)
+    {
+        pool->threads = malloc(num_threads * sizeof(pthread_t));
+        if (pool->threads == NULL)
+        {
+            free(pool);
+            return NULL;
+        }
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->band_done, NULL);
+    for (i = 0; i < num_threads; i++)
+    {
+        if (pthread_create(&pool->threads[i], NULL, pool_thread, pool) != 0)
+        {
+            YUV_thread_pool_free(pool);
+            return NULL;
+        }
+        pool->num_threads++;
+    }
+    return pool;
+}
+
+void YUV_thread_pool_free(YUV_thread_pool* pool)
+{
+    int     i;
+
+    if (pool == NULL)
+        return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+    for (i = 0; i < pool->num_threads; i++)
+        pthread_join(pool->threads[i], NULL);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_cond_destroy(&pool->band_done);
+    free(pool->threads);
+    free(pool);
+}
+
+int YUV_thread_pool_size(const YUV_thread_pool* pool)
+{
+    if (pool == NULL)
+        return 0;
+    return pool->num_threads;
+}
+
+int YUV_run_bands(YUV_thread_pool* pool, YUV_band_proc* proc, void* arg,
+                  int num_bands)
+{
+    band_job    job;
+    band_job**  link;
+    int         band;
+
+    if (num_bands < 0)
+        return YUV_Fail;
+    if (pool == NULL || pool->num_threads == 0 || num_bands == 1)
+    {
+        for (band = 0; band < num_bands; band++)
+            proc(arg, band);
+        return YUV_OK;
+    }
+    if (num_bands == 0)
+        return YUV_OK;
+    job.proc = proc;
+    job.arg = arg;
+    job.num_bands = num_bands;
+    job.next_band = 0;
+    job.bands_done = 0;
+    job.next = NULL;
+    pthread_mutex_lock(&pool->lock);
+    for (link = &pool->jobs; *link != NULL; link = &(*link)->next)
+        ;
+    *link = &job;
+    pthread_cond_broadcast(&pool->work_ready);
+    // do bands in this thread until they have all been started
+    while (job.next_band < num_bands)
+    {
+        band = take_band(pool, &job);
+        pthread_mutex_unlock(&pool->lock);
+        proc(arg, band);
+        pthread_mutex_lock(&pool->lock);
+        job.bands_done++;
+    }
+    while (job.bands_done < num_bands)
+        pthread_cond_wait(&pool->band_done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+    return YUV_OK;
+}
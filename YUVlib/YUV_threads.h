@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2012 British Broadcasting Corporation, All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __YUVLIB_THREADS__
+#define __YUVLIB_THREADS__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A pool of threads for processing pictures in horizontal bands.
+// The pool is owned by the caller, so the caller decides how many threads
+// each picture operation can use and can share them between operations.
+typedef struct YUV_thread_pool YUV_thread_pool;
+
+// Function to process band number 'band' of an operation.
+typedef void YUV_band_proc(void* arg, int band);
+
+/* Create a pool of num_threads threads. The thread that runs the bands
+ * also processes some of them itself, so a pool of n-1 threads gives n
+ * bands being processed at once.
+ * num_threads < 0 selects one thread fewer than the number of online CPUs.
+ * Returns NULL on failure.
+ */
+YUV_thread_pool* YUV_thread_pool_create(int num_threads);
+
+/* Stop the threads and free the pool. No bands may be running.
+ */
+void YUV_thread_pool_free(YUV_thread_pool* pool);
+
+/* Number of threads in pool, not counting the caller. pool can be NULL.
+ */
+int YUV_thread_pool_size(const YUV_thread_pool* pool);
+
+/* Call proc(arg, band) for band 0 to num_bands - 1 and wait for all calls
+ * to complete. The calls are spread over the threads of pool and the
+ * calling thread. pool can be NULL to process all bands in the calling
+ * thread. Several threads can run bands in the same pool at once.
+ * Return value is 0 for success, <0 for failure.
+ */
+int YUV_run_bands(YUV_thread_pool* pool, YUV_band_proc* proc, void* arg,
+                  int num_bands);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __YUVLIB_THREADS__
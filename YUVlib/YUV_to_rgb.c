@@ -128,12 +128,27 @@ static void h_up_2_HQ(BYTE* srcLine, BYTE* dstLine,
 
 typedef void up_2_proc(BYTE*, BYTE*, const int, const int, const int);
 
-int to_RGBex(const YUV_frame* in_frame,
-             BYTE* out_R, BYTE* out_G, BYTE* out_B,
-             const int RGBpixelStride, const int RGBlineStride,
-             const matrices matrix, const int fil)
+// Parameters of a to_RGBex_bands() call
+typedef struct
 {
-    int         ssx, ssy;
+    const YUV_frame*    in_frame;
+    BYTE*               out_R;
+    BYTE*               out_G;
+    BYTE*               out_B;
+    int                 RGBpixelStride;
+    int                 RGBlineStride;
+    int                 VtoR, VtoG, UtoG, UtoB;
+    up_2_proc*          up_conv;
+    int                 num_bands;
+} rgb_job;
+
+// Convert the lines of band number 'band'
+static void to_RGB_band(void* arg, int band)
+{
+    const rgb_job*      job = arg;
+    const YUV_frame*    in_frame = job->in_frame;
+    const int           RGBpixelStride = job->RGBpixelStride;
+    int         ssx;
     BYTE*       Y_line;
     BYTE*       U_line;
     BYTE*       V_line;
@@ -142,17 +157,11 @@ int to_RGBex(const YUV_frame* in_frame,
     BYTE*       R_line;
     BYTE*       G_line;
     BYTE*       B_line;
-    int         i, j;
+    int         i, j, j_last;
     int         U_inc, V_inc;
     int         Y, U, V, R, G, B;
-    int         VtoR, VtoG, UtoG, UtoB;
-    up_2_proc*  up_conv;
 
-    // check in_frame format
     ssx = in_frame->Y.w / in_frame->U.w;
-    ssy = in_frame->Y.h / in_frame->U.h;
-    if ((ssx > 2) || (ssy != 1))
-        return YUV_Fail;    // can only convert from 4:4:4 or 4:2:2 so far
     // set up intermediate arrays
     if (ssx == 2)
     {
@@ -164,50 +173,25 @@ int to_RGBex(const YUV_frame* in_frame,
         U_inc = in_frame->U.pixelStride;
         V_inc = in_frame->V.pixelStride;
     }
-    // set matrix coefficients
-    if (matrix == Rec601)
-    {
-        VtoR = 89831;
-        VtoG = 45757;
-        UtoG = 22050;
-        UtoB = 113538;
-    }
-    else
-    {
-        VtoR = 100902;
-        VtoG = 29994;
-        UtoG = 12002;
-        UtoB = 118894;
-    }
-    // select filter
-    if (fil > 0)
-    {
-        up_conv = &h_up_2_HQ;
-    }
-    else
-    {
-        up_conv = &h_up_2_121;
-    }
-    // do it
-    #pragma omp parallel for \
-        default (shared) \
-	private (i,j,Y_line,U_line,V_line,R_line,G_line,B_line, \
-	    U_p,V_p,Y,U,V,R,G,B)
-    for (j = 0; j < in_frame->Y.h; j++)
+    j = in_frame->Y.h * band / job->num_bands;
+    j_last = in_frame->Y.h * (band + 1) / job->num_bands;
+    for (; j < j_last; j++)
     {
         Y_line = in_frame->Y.buff + (j * in_frame->Y.lineStride);
         U_line = in_frame->U.buff + (j * in_frame->U.lineStride);
         V_line = in_frame->V.buff + (j * in_frame->V.lineStride);
-        R_line = out_R + (j * RGBlineStride);
-        G_line = out_G + (j * RGBlineStride);
-        B_line = out_B + (j * RGBlineStride);
+        R_line = job->out_R + (j * job->RGBlineStride);
+        G_line = job->out_G + (j * job->RGBlineStride);
+        B_line = job->out_B + (j * job->RGBlineStride);
         if (ssx == 2)
         {
             U_p = R_line;
             V_p = B_line;
             // up convert chrominance
-            up_conv(U_line, U_p, in_frame->U.pixelStride, U_inc, in_frame->Y.w);
-            up_conv(V_line, V_p, in_frame->V.pixelStride, V_inc, in_frame->Y.w);
+            job->up_conv(U_line, U_p, in_frame->U.pixelStride, U_inc,
+                         in_frame->Y.w);
+            job->up_conv(V_line, V_p, in_frame->V.pixelStride, V_inc,
+                         in_frame->Y.w);
         }
         else
         {
@@ -224,9 +208,9 @@ int to_RGBex(const YUV_frame* in_frame,
             V_p += V_inc;
             U = U - 128;
             V = V - 128;
-            R = Y + (V * VtoR / 65536);
-            G = Y - (((V * VtoG) + (U * UtoG)) / 65536);
-            B = Y + (U * UtoB / 65536);
+            R = Y + (V * job->VtoR / 65536);
+            G = Y - (((V * job->VtoG) + (U * job->UtoG)) / 65536);
+            B = Y + (U * job->UtoB / 65536);
             *R_line = min(max(R, 0), 255);
             *G_line = min(max(G, 0), 255);
             *B_line = min(max(B, 0), 255);
@@ -235,7 +219,67 @@ int to_RGBex(const YUV_frame* in_frame,
             B_line += RGBpixelStride;
         }
     }
-    return YUV_OK;
+}
+
+int to_RGBex_bands(const YUV_frame* in_frame,
+                   BYTE* out_R, BYTE* out_G, BYTE* out_B,
+                   const int RGBpixelStride, const int RGBlineStride,
+                   const matrices matrix, const int fil,
+                   YUV_thread_pool* pool, int num_bands)
+{
+    int         ssx, ssy;
+    rgb_job     job;
+
+    // check in_frame format
+    ssx = in_frame->Y.w / in_frame->U.w;
+    ssy = in_frame->Y.h / in_frame->U.h;
+    if ((ssx > 2) || (ssy != 1))
+        return YUV_Fail;    // can only convert from 4:4:4 or 4:2:2 so far
+    if (num_bands < 1)
+        return YUV_Fail;
+    job.in_frame = in_frame;
+    job.out_R = out_R;
+    job.out_G = out_G;
+    job.out_B = out_B;
+    job.RGBpixelStride = RGBpixelStride;
+    job.RGBlineStride = RGBlineStride;
+    job.num_bands = num_bands;
+    // set matrix coefficients
+    if (matrix == Rec601)
+    {
+        job.VtoR = 89831;
+        job.VtoG = 45757;
+        job.UtoG = 22050;
+        job.UtoB = 113538;
+    }
+    else
+    {
+        job.VtoR = 100902;
+        job.VtoG = 29994;
+        job.UtoG = 12002;
+        job.UtoB = 118894;
+    }
+    // select filter
+    if (fil > 0)
+    {
+        job.up_conv = &h_up_2_HQ;
+    }
+    else
+    {
+        job.up_conv = &h_up_2_121;
+    }
+    // do it
+    return YUV_run_bands(pool, to_RGB_band, &job, num_bands);
+}
+
+int to_RGBex(const YUV_frame* in_frame,
+             BYTE* out_R, BYTE* out_G, BYTE* out_B,
+             const int RGBpixelStride, const int RGBlineStride,
+             const matrices matrix, const int fil)
+{
+    return to_RGBex_bands(in_frame, out_R, out_G, out_B,
+                          RGBpixelStride, RGBlineStride, matrix, fil,
+                          NULL, 1);
 }
 
 int to_RGB(const YUV_frame* in_frame,
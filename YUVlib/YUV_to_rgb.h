@@ -24,6 +24,7 @@
 #define __YUVLIB_TO_RGB__
 
 #include "YUV_frame.h"
+#include "YUV_threads.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -63,6 +64,15 @@ int to_RGBex(const YUV_frame* in_frame,
              const int RGBpixelStride, const int RGBlineStride,
              const matrices matrix, const int fil);
 
+/* As to_RGBex(), but with the lines split into num_bands bands that are
+ * run on the threads of pool (which can be NULL).
+ */
+int to_RGBex_bands(const YUV_frame* in_frame,
+                   BYTE* out_R, BYTE* out_G, BYTE* out_B,
+                   const int RGBpixelStride, const int RGBlineStride,
+                   const matrices matrix, const int fil,
+                   YUV_thread_pool* pool, int num_bands);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,21 +24,28 @@
  * 02110-1301, USA.
  */
 
+#define __STDC_FORMAT_MACROS 1
+
 #include <cassert>
+#include <cstring>
+#include <cerrno>
+#include <inttypes.h>
 
 #include "DigiBetaDropoutDetector.h"
 
 #include "YUV_frame.h"
 #include "digibeta_dropout.h"
+#include "logF.h"
 
 using namespace std;
 
 
 
 DigiBetaDropoutDetector::DigiBetaDropoutDetector(int width, int height,
-    int lowerThreshold, int upperThreshold, int storeThreshold)
+    int lowerThreshold, int upperThreshold, int storeThreshold, int queueSize)
 {
     assert(upperThreshold - lowerThreshold > 0);
+    assert(queueSize > 0);
     
     _width = width;
     _height = height;
@@ -49,19 +56,183 @@ DigiBetaDropoutDetector::DigiBetaDropoutDetector(int width, int height,
     _position = 0;
     
     _workspace = new int[width * height];
+    
+    int i;
+    for (i = 0; i < queueSize; i++)
+    {
+        _queue.push_back(new unsigned char[width * height * 2]);
+    }
+    _queuePositions.resize(queueSize);
+    _queueStart = 0;
+    _queueCount = 0;
+    _detecting = false;
+    _stop = false;
+    _numSkipped = 0;
+    
+    pthread_mutex_init(&_queueMutex, NULL);
+    pthread_cond_init(&_queueChange, NULL);
+    
+    int res;
+    _threadStarted = true;
+    if ((res = pthread_create(&_thread, NULL, detectThreadWrapper, this)) != 0)
+    {
+        logTF("Failed to create digibeta dropout detector thread - detecting in the caller's thread: %s\n",
+              strerror(res));
+        _threadStarted = false;
+    }
 }
 
 DigiBetaDropoutDetector::~DigiBetaDropoutDetector()
 {
+    if (_threadStarted)
+    {
+        pthread_mutex_lock(&_queueMutex);
+        _stop = true;
+        pthread_cond_broadcast(&_queueChange);
+        pthread_mutex_unlock(&_queueMutex);
+        
+        pthread_join(_thread, NULL);
+    }
+    
+    if (_numSkipped > 0)
+    {
+        logTF("Digibeta dropout detector skipped %" PRId64 " pictures\n", _numSkipped);
+    }
+    
+    size_t i;
+    for (i = 0; i < _queue.size(); i++)
+    {
+        delete [] _queue[i];
+    }
     delete [] _workspace;
+    
+    pthread_cond_destroy(&_queueChange);
+    pthread_mutex_destroy(&_queueMutex);
 }
 
 void DigiBetaDropoutDetector::processPicture(unsigned char *data, unsigned int dataSize)
 {
-    YUV_frame frame;
-    
     assert(dataSize == _width * _height * 2);
     
+    if (!_threadStarted)
+    {
+        detectPicture(data, _position);
+        _position++;
+        return;
+    }
+    
+    pthread_mutex_lock(&_queueMutex);
+    
+    if (_queueCount == (int)_queue.size())
+    {
+        // skip rather than wait for the detector thread
+        if (_numSkipped == 0)
+        {
+            logTF("Digibeta dropout detector queue is full - skipping pictures\n");
+        }
+        _numSkipped++;
+        _position++;
+        pthread_mutex_unlock(&_queueMutex);
+        return;
+    }
+    
+    int index = (_queueStart + _queueCount) % _queue.size();
+    _queuePositions[index] = _position;
+    _position++;
+    
+    pthread_mutex_unlock(&_queueMutex);
+    
+    // there is a single caller and the detector thread doesn't access the slot until it has been queued
+    memcpy(_queue[index], data, dataSize);
+    
+    pthread_mutex_lock(&_queueMutex);
+    _queueCount++;
+    pthread_cond_broadcast(&_queueChange);
+    pthread_mutex_unlock(&_queueMutex);
+}
+
+void DigiBetaDropoutDetector::completeProcessing()
+{
+    pthread_mutex_lock(&_queueMutex);
+    while (_queueCount > 0 || _detecting)
+    {
+        pthread_cond_wait(&_queueChange, &_queueMutex);
+    }
+    pthread_mutex_unlock(&_queueMutex);
+}
+
+vector<DigiBetaDropout>& DigiBetaDropoutDetector::getDropouts()
+{
+    completeProcessing();
+    
+    return _dropouts;
+}
+
+size_t DigiBetaDropoutDetector::getNumDropouts()
+{
+    size_t numDropouts;
+    
+    pthread_mutex_lock(&_queueMutex);
+    numDropouts = _dropouts.size();
+    pthread_mutex_unlock(&_queueMutex);
+    
+    return numDropouts;
+}
+
+int64_t DigiBetaDropoutDetector::getNumSkipped()
+{
+    int64_t numSkipped;
+    
+    pthread_mutex_lock(&_queueMutex);
+    numSkipped = _numSkipped;
+    pthread_mutex_unlock(&_queueMutex);
+    
+    return numSkipped;
+}
+
+void* DigiBetaDropoutDetector::detectThreadWrapper(void *arg)
+{
+    static_cast<DigiBetaDropoutDetector*>(arg)->detectThread();
+    return NULL;
+}
+
+void DigiBetaDropoutDetector::detectThread()
+{
+    unsigned char *data;
+    int64_t position;
+    
+    pthread_mutex_lock(&_queueMutex);
+    while (true)
+    {
+        while (_queueCount == 0 && !_stop)
+        {
+            pthread_cond_wait(&_queueChange, &_queueMutex);
+        }
+        if (_queueCount == 0)
+        {
+            break;
+        }
+        
+        data = _queue[_queueStart];
+        position = _queuePositions[_queueStart];
+        _detecting = true;
+        pthread_mutex_unlock(&_queueMutex);
+        
+        detectPicture(data, position);
+        
+        pthread_mutex_lock(&_queueMutex);
+        _queueStart = (_queueStart + 1) % _queue.size();
+        _queueCount--;
+        _detecting = false;
+        pthread_cond_broadcast(&_queueChange);
+    }
+    pthread_mutex_unlock(&_queueMutex);
+}
+
+void DigiBetaDropoutDetector::detectPicture(unsigned char *data, int64_t position)
+{
+    YUV_frame frame;
+    
     YUV_frame_from_buffer(&frame, data, _width, _height, UYVY);
     
     dropout_result result[2];
@@ -83,12 +254,12 @@ void DigiBetaDropoutDetector::processPicture(unsigned char *data, unsigned int d
     if (maxNormalizedStrength >= _normalizedStoreThreshold)
     {
         DigiBetaDropout dropout;
-        dropout.position = _position;
+        dropout.position = position;
         dropout.strength = maxNormalizedStrength;
         
+        pthread_mutex_lock(&_queueMutex);
         _dropouts.push_back(dropout);
+        pthread_mutex_unlock(&_queueMutex);
     }
-    
-    _position++;
 }
 
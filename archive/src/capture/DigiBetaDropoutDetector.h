@@ -28,24 +28,38 @@
 #define __RECORDER_DIGIBETA_DROPOUT_DETECTOR_H__
 
 
+#include <pthread.h>
+
 #include <vector>
 
 #include <archive_types.h>
 
 
+// The detection runs in a separate thread so that it doesn't hold up the
+// thread passing in the pictures. processPicture() copies the picture into a
+// queue and pictures are skipped if the queue is full.
+
 class DigiBetaDropoutDetector
 {
 public:
     DigiBetaDropoutDetector(int width, int height,
-        int lowerThreshold, int upperThreshold, int storeThreshold);
+        int lowerThreshold, int upperThreshold, int storeThreshold, int queueSize = 25);
     ~DigiBetaDropoutDetector();
     
     void processPicture(unsigned char *data, unsigned int dataSize);
 
+    // wait until the queued pictures have been processed
+    void completeProcessing();
 
-    std::vector<DigiBetaDropout>& getDropouts() { return _dropouts; }
-    size_t getNumDropouts() { return _dropouts.size(); }
+    std::vector<DigiBetaDropout>& getDropouts();
+    size_t getNumDropouts();
+    int64_t getNumSkipped();
 
+private:
+    static void* detectThreadWrapper(void *arg);
+    void detectThread();
+    void detectPicture(unsigned char *data, int64_t position);
+    
 private:
     unsigned int _width;
     unsigned int _height;
@@ -55,6 +69,18 @@ private:
     int *_workspace;
     int64_t _position;
     std::vector<DigiBetaDropout> _dropouts;
+    
+    pthread_t _thread;
+    bool _threadStarted;
+    pthread_mutex_t _queueMutex;
+    pthread_cond_t _queueChange;
+    std::vector<unsigned char*> _queue;
+    std::vector<int64_t> _queuePositions;
+    int _queueStart;
+    int _queueCount;
+    bool _detecting;
+    bool _stop;
+    int64_t _numSkipped;
 };
 
 
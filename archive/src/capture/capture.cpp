@@ -29,7 +29,8 @@
     
     A store_video_thread reads the next frame from a ring buffer, which includes
     video, audio and timecode information, and writes it to the MXF file. At the
-    same time the video data is analysed for PSE failures.
+    same time the video data is analysed for PSE failures. The video is also
+    passed to the DigiBeta dropout detector which runs in its own thread.
     
     A browse copy generation thread, store_browse_thread, is started when 
     start_record is called. This generate a MPEG-2 browse copy file and also
@@ -1356,6 +1357,8 @@ bool Capture::stop_record(int duration, InfaxData* infaxData, VTRError *vtrError
     // get digibeta dropouts
     long numDigiBetaDropouts = 0;
     DigiBetaDropout *digiBetaDropouts = 0;
+    if (dropout_detector)
+        dropout_detector->completeProcessing();
     if (dropout_detector && dropout_detector->getNumDropouts() > 0) {
         digiBetaDropouts = &dropout_detector->getDropouts()[0];
         numDigiBetaDropouts = (long)dropout_detector->getNumDropouts();
@@ -1617,6 +1620,8 @@ bool Capture::stop_multi_item_record(int duration, VTRError *vtrErrors, long num
     // get digibeta dropouts
     long numDigiBetaDropouts = 0;
     DigiBetaDropout *digiBetaDropouts = 0;
+    if (dropout_detector)
+        dropout_detector->completeProcessing();
     if (dropout_detector && dropout_detector->getNumDropouts() > 0) {
         digiBetaDropouts = &dropout_detector->getDropouts()[0];
         numDigiBetaDropouts = (long)dropout_detector->getNumDropouts();
@@ -1739,7 +1744,7 @@ bool Capture::abort_record(void)
     }
 
     // close digibeta dropout detection
-    // Note that we assume the dropout detector is running in the store_video_thread thread which has
+    // Note that we assume the store_video_thread, which passes pictures to the dropout detector, has
     // finished writing
     if (dropout_detector) {
         pthread_mutex_lock(&m_dropout_detector);
@@ -32,6 +32,10 @@
     
     Server side includes handlers, HTTPSSIHandler, can be registered in the
     HTTPServer and are called when data is required for a SSI HTML page
+    
+    A handler can leave the response pending, HTTPPendingResponse, which is 
+    then polled by the child thread until it sends the response or times out.
+    This is used for long-poll requests which wait for a status change.
 */
  
 #include <cstring>
@@ -49,18 +53,42 @@ using namespace rec;
 // large enough to contain the our http request and responses in one buffer  
 #define HTTP_IO_BUFFER_SIZE_STR          "16384"
 
+// a child thread that only has pending responses to poll waits this long between polls
+#define PENDING_RESPONSE_POLL_WAIT_MSEC  10
+
 
 static const char* g_servicesURL = "/services.html";
 static const char* g_servicesURLDescription = "Lists the dynamic services exported by the Ingex Recorder";
 
 
+
+class HTTPPollActivity
+{
+public:
+    HTTPPollActivity() : numPendingPolled(0) {}
+    
+    int numPendingPolled;
+};
+
+// the service registered in a child thread's shttpd context
+class HTTPChildService
+{
+public:
+    HTTPChildService(HTTPService* service_, HTTPPollActivity* activity_) : service(service_), activity(activity_) {}
+    
+    HTTPService* service;
+    HTTPPollActivity* activity;
+};
+
+
 namespace rec
 {
     
 // this function is called by the shttpd library
 void http_service(struct shttpd_arg* arg)
 {
-    HTTPService* service = (HTTPService*)arg->user_data;
+    HTTPChildService* childService = (HTTPChildService*)arg->user_data;
+    HTTPService* service = childService->service;
     HTTPConnection* connection = HTTPConnection::getConnection(arg);
     
     // handle broken connections
@@ -103,6 +131,14 @@ void http_service(struct shttpd_arg* arg)
         service->handler->processRequest(service->description, connection);
         connection->setHaveProcessed();
     }
+    else if (connection->havePendingResponse())
+    {
+        connection->pollPendingResponse();
+        if (connection->havePendingResponse())
+        {
+            childService->activity->numPendingPolled++;
+        }
+    }
     
     // copy response data to the remote client
     connection->copyResponseData();
@@ -165,6 +201,12 @@ public:
     virtual ~HTTPServerChildThreadWorker()
     {
         shttpd_fini(_ctx);
+        
+        size_t i;
+        for (i = 0; i < _childServices.size(); i++)
+        {
+            delete _childServices[i];
+        }
     }
     
     virtual void start()
@@ -180,7 +222,16 @@ public:
             // Choosing a larger timeout will result in more (serial) request processing in
             // the same thread, thus losing the benefit of having multiple threads
             // This is why the poll timeout is set to 100 msec
+            _pollActivity.numPendingPolled = 0;
             shttpd_poll(_ctx, 100);
+            
+            // shttpd_poll doesn't wait whilst a connection is waiting for the handler to provide the
+            // response and so sleep if all the active connections are pending responses (eg. long-polls)
+            if (_pollActivity.numPendingPolled > 0 &&
+                _pollActivity.numPendingPolled >= shttpd_active(_ctx))
+            {
+                sleep_msec(PENDING_RESPONSE_POLL_WAIT_MSEC);
+            }
         }
     }
     
@@ -200,10 +251,18 @@ public:
         return _ctx;
     }
     
+    void registerURI(const char* uri, shttpd_callback_t callback, HTTPService* service)
+    {
+        _childServices.push_back(new HTTPChildService(service, &_pollActivity));
+        shttpd_register_uri(_ctx, uri, callback, _childServices.back());
+    }
+    
 private:
     struct shttpd_ctx* _ctx;
     bool _hasStopped;
     bool _stop;
+    HTTPPollActivity _pollActivity;
+    std::vector<HTTPChildService*> _childServices;
 };
 
 
@@ -296,7 +355,7 @@ public:
     }
     
     
-    void registerURI(const char* uri, shttpd_callback_t callback, void* userData)
+    void registerURI(const char* uri, shttpd_callback_t callback, HTTPService* service)
     {
         HTTPServerChildThreadWorker* child;
         size_t i;
@@ -304,7 +363,7 @@ public:
         {
             child = dynamic_cast<HTTPServerChildThreadWorker*>(_childThreads[i]->getWorker());
             
-            shttpd_register_uri(child->getContext(), uri, callback, userData);
+            child->registerURI(uri, callback, service);
         }
     }
     
@@ -447,9 +506,9 @@ HTTPConnection* HTTPConnection::getConnection(struct shttpd_arg* arg)
     vector<HTTPConnection*>::iterator iter = _closedConnections.begin();
     while (iter != _closedConnections.end())
     {
-        if (!(*iter)->haveProcessed() || (*iter)->responseIsComplete())
+        if (!(*iter)->haveProcessed() || (*iter)->responseIsComplete() || (*iter)->_pendingResponse)
         {
-            // connection is not in use - delete it
+            // connection is not in use (pending responses are only used by the connection's thread) - delete it
             delete *iter;
             iter = _closedConnections.erase(iter);
         }
@@ -480,7 +539,8 @@ void HTTPConnection::addClosedConnection(HTTPConnection* connection)
 
 
 HTTPConnection::HTTPConnection(struct shttpd_arg* arg)
-: _arg(arg), _responseDataIsReady(false), _sizeCopied(0), _haveProcessed(false), _responseIsComplete(false)
+: _arg(arg), _responseDataIsReady(false), _sizeCopied(0), _haveProcessed(false), _responseIsComplete(false),
+  _pendingResponse(0)
 {
     _arg->state = this;
     
@@ -496,6 +556,7 @@ HTTPConnection::HTTPConnection(struct shttpd_arg* arg)
 
 HTTPConnection::~HTTPConnection()
 {
+    delete _pendingResponse;
 }
 
 string HTTPConnection::getRequestURI()
@@ -608,6 +669,14 @@ void HTTPConnection::sendServerError(string description)
     _buffer << "Content-Type: text/plain\r\n\r\n";
     setResponseDataIsReady();
 }
+
+void HTTPConnection::setPendingResponse(HTTPPendingResponse* pendingResponse, int64_t timeoutUSec)
+{
+    REC_ASSERT(!_pendingResponse);
+    
+    _pendingResponse = pendingResponse;
+    _pendingTimer.start(timeoutUSec);
+}
     
 bool HTTPConnection::requestIsReady()
 {
@@ -643,6 +712,23 @@ bool HTTPConnection::responseIsComplete()
     return _responseIsComplete;
 }
 
+bool HTTPConnection::havePendingResponse()
+{
+    return _pendingResponse && !_responseDataIsReady;
+}
+
+void HTTPConnection::pollPendingResponse()
+{
+    bool timedOut = (_pendingTimer.timeLeft() <= 0);
+    
+    _pendingResponse->poll(this, timedOut);
+    
+    if (timedOut && !_responseDataIsReady)
+    {
+        sendServerError("Pending response timed out");
+    }
+}
+
 void HTTPConnection::copyResponseData()
 {
     if (!_responseDataIsReady || // only copy data when it is ready 
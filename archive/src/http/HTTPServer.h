@@ -27,6 +27,7 @@
 #include <shttpd.h>
 
 #include "Threads.h"
+#include "Timing.h"
 #include "JSONObject.h"
 
 #include <string>
@@ -76,6 +77,17 @@ private:
 
 
 class HTTPServer;
+class HTTPConnection;
+
+class HTTPPendingResponse
+{
+public:
+    virtual ~HTTPPendingResponse() {}
+    
+    // called each time the connection is polled until the response is sent. timedOut is true on the last call
+    // and a response must then be sent
+    virtual void poll(HTTPConnection* connection, bool timedOut) = 0;
+};
 
 class HTTPConnection
 {
@@ -117,6 +129,10 @@ public:
     void sendServerBusy(std::string description);
     void sendServerError(std::string description);
     
+    // the response is completed later by polling the pending response (which is then owned by the
+    // connection), eg. a long-poll request waiting for a status change
+    void setPendingResponse(HTTPPendingResponse* pendingResponse, int64_t timeoutUSec);
+    
 private:
     HTTPConnection(struct shttpd_arg* arg);
 
@@ -126,6 +142,8 @@ private:
     bool haveProcessed();
     bool responseIsComplete();
     void copyResponseData();
+    bool havePendingResponse();
+    void pollPendingResponse();
     
     
     
@@ -141,6 +159,8 @@ private:
     size_t _sizeCopied;
     bool _haveProcessed;
     bool _responseIsComplete;
+    HTTPPendingResponse* _pendingResponse;
+    Timer _pendingTimer;
 };
 
 
@@ -139,6 +139,20 @@ string JSONObject::toString()
     return out.str();
 }
 
+JSONValue* JSONObject::clone()
+{
+    JSONObject* copy = new JSONObject();
+    
+    vector<pair<JSONString*, JSONValue*> >::const_iterator iter;
+    for (iter = _value.begin(); iter != _value.end(); iter++)
+    {
+        copy->_value.push_back(pair<JSONString*, JSONValue*>(
+            dynamic_cast<JSONString*>((*iter).first->clone()), (*iter).second->clone()));
+    }
+    
+    return copy;
+}
+
 void JSONObject::set(string name, JSONValue* value)
 {
     _value.push_back(pair<JSONString*, JSONValue*>(new JSONString(name), value));
@@ -203,6 +217,80 @@ JSONObject* JSONObject::setObject(std::string name)
     return dynamic_cast<JSONObject*>(_value.back().second);
 }
 
+JSONObject* JSONObject::createDelta(JSONObject* previous)
+{
+    JSONObject* delta = new JSONObject();
+    
+    vector<pair<JSONString*, JSONValue*> >::const_iterator iter;
+    for (iter = _value.begin(); iter != _value.end(); iter++)
+    {
+        JSONValue* prevValue = previous->getValue((*iter).first);
+        if (!prevValue)
+        {
+            delta->_value.push_back(pair<JSONString*, JSONValue*>(
+                dynamic_cast<JSONString*>((*iter).first->clone()), (*iter).second->clone()));
+            continue;
+        }
+        
+        JSONObject* object = dynamic_cast<JSONObject*>((*iter).second);
+        JSONObject* prevObject = dynamic_cast<JSONObject*>(prevValue);
+        if (object && prevObject)
+        {
+            JSONObject* objectDelta = object->createDelta(prevObject);
+            if (objectDelta->isEmpty())
+            {
+                delete objectDelta;
+            }
+            else
+            {
+                delta->_value.push_back(pair<JSONString*, JSONValue*>(
+                    dynamic_cast<JSONString*>((*iter).first->clone()), objectDelta));
+            }
+        }
+        else if ((*iter).second->toString() != prevValue->toString())
+        {
+            delta->_value.push_back(pair<JSONString*, JSONValue*>(
+                dynamic_cast<JSONString*>((*iter).first->clone()), (*iter).second->clone()));
+        }
+    }
+    
+    JSONArray* deletedMembers = 0;
+    for (iter = previous->_value.begin(); iter != previous->_value.end(); iter++)
+    {
+        if (!getValue((*iter).first))
+        {
+            if (!deletedMembers)
+            {
+                deletedMembers = delta->setArray("deletedMembers");
+            }
+            deletedMembers->append((*iter).first->clone());
+        }
+    }
+    
+    return delta;
+}
+
+bool JSONObject::isEmpty()
+{
+    return _value.empty();
+}
+
+JSONValue* JSONObject::getValue(JSONString* name)
+{
+    string nameString = name->toString();
+    
+    vector<pair<JSONString*, JSONValue*> >::const_iterator iter;
+    for (iter = _value.begin(); iter != _value.end(); iter++)
+    {
+        if ((*iter).first->toString() == nameString)
+        {
+            return (*iter).second;
+        }
+    }
+    
+    return 0;
+}
+
 
 JSONString::JSONString(string value)
 : _value(value)
@@ -219,6 +307,11 @@ string JSONString::toString()
     return out.str();
 }
 
+JSONValue* JSONString::clone()
+{
+    return new JSONString(_value);
+}
+
 
 JSONNumber::JSONNumber(int64_t value)
 : _value(value)
@@ -234,6 +327,11 @@ string JSONNumber::toString()
     return int64_to_string(_value);
 }
 
+JSONValue* JSONNumber::clone()
+{
+    return new JSONNumber(_value);
+}
+
 
 JSONArray::JSONArray()
 {}
@@ -272,6 +370,19 @@ string JSONArray::toString()
     return out.str();
 }
 
+JSONValue* JSONArray::clone()
+{
+    JSONArray* copy = new JSONArray();
+    
+    vector<JSONValue*>::const_iterator iter;
+    for (iter = _value.begin(); iter != _value.end(); iter++)
+    {
+        copy->append((*iter)->clone());
+    }
+    
+    return copy;
+}
+
 void JSONArray::append(JSONValue* value)
 {
     _value.push_back(value);
@@ -302,6 +413,11 @@ string JSONBool::toString()
     return _value ? "true" : "false";
 }
 
+JSONValue* JSONBool::clone()
+{
+    return new JSONBool(_value);
+}
+
 
 JSONNull::JSONNull()
 {}
@@ -314,3 +430,8 @@ string JSONNull::toString()
     return "null";
 }
 
+JSONValue* JSONNull::clone()
+{
+    return new JSONNull();
+}
+
@@ -39,6 +39,7 @@ public:
     virtual ~JSONValue() {}
     
     virtual std::string toString() = 0;
+    virtual JSONValue* clone() = 0;
 };
 
 
@@ -49,6 +50,7 @@ public:
     virtual ~JSONString();
     
     virtual std::string toString();
+    virtual JSONValue* clone();
 
 private:
     std::string _value;
@@ -63,6 +65,7 @@ public:
     virtual ~JSONObject();
     
     virtual std::string toString();
+    virtual JSONValue* clone();
 
     void set(std::string name, JSONValue* value);
     void setString(std::string name, std::string value);
@@ -73,7 +76,15 @@ public:
     JSONArray* setArray(std::string name);
     JSONObject* setObject(std::string name);
     
+    // returns the members that were added or changed compared to the previous object, with member objects
+    // compared recursively. The names of removed members are listed in a "deletedMembers" array
+    JSONObject* createDelta(JSONObject* previous);
+    bool isEmpty();
+    
 private:
+    JSONValue* getValue(JSONString* name);
+    
+
     std::vector<std::pair<JSONString*, JSONValue*> > _value;
 };
 
@@ -84,6 +95,7 @@ public:
     virtual ~JSONNumber();
     
     virtual std::string toString();
+    virtual JSONValue* clone();
 
 private:
     int64_t _value;
@@ -96,6 +108,7 @@ public:
     virtual ~JSONArray();
     
     virtual std::string toString();
+    virtual JSONValue* clone();
 
     void append(JSONValue* value);
     JSONArray* appendArray();
@@ -112,6 +125,7 @@ public:
     virtual ~JSONBool();
     
     virtual std::string toString();
+    virtual JSONValue* clone();
 
 private:
     bool _value;
@@ -124,6 +138,7 @@ public:
     virtual ~JSONNull();
     
     virtual std::string toString();
+    virtual JSONValue* clone();
 };
 
 
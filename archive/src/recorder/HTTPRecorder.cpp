@@ -30,8 +30,18 @@
     
     PSE reports are displayed in a HTML frame to allow users to easily print 
     and go back to the previous page using a touchscreen monitor. 
+    
+    The status and cache contents update URLs are long-polls: the response is 
+    pending until the status changes compared to the version the client has 
+    and then only the changes are returned. The status is shared by all clients 
+    with the same query and a few previous versions are kept to create the 
+    deltas. It is only created again when the recorder, barcode or cache change 
+    counts move, every STATUS_UPDATE_INTERVAL_MSEC while a session or replay is 
+    active and every STATUS_IDLE_REFRESH_MSEC otherwise.
 */
  
+#include <ctime>
+
 #include "HTTPRecorder.h"
 #include "JSONObject.h"
 #include "InfaxAccess.h"
@@ -49,8 +59,22 @@ using namespace rec;
 // a barcode expires (ie. will not be sent to a client) after ... seconds
 #define BARCODE_EXPIRES_TIME_SEC        30
 
+// the status for update requests is refreshed every ... msec while a session or replay is active, ie. within a frame period
+#define STATUS_UPDATE_INTERVAL_MSEC     20
+
+// otherwise the status is refreshed every ... msec to pick up the database connection and disk space, which have no change count
+#define STATUS_IDLE_REFRESH_MSEC        1000
+
+// the default and maximum time an update request waits for a change
+#define DEFAULT_UPDATE_TIMEOUT_SEC      25
+#define MAX_UPDATE_TIMEOUT_SEC          60
+
+// number of status versions kept to create deltas
+#define UPDATE_HISTORY_SIZE             8
+
 // all the HTTP service URLs handled by the HTTPRecorder
 static const char* g_recorderStatusURL = "/recorder/status.json";
+static const char* g_recorderStatusUpdateURL = "/recorder/statusupdate.json";
 static const char* g_getProfileListURL = "/recorder/profilelist.json";
 static const char* g_getProfileURL = "/recorder/profile.json";
 static const char* g_updateProfileURL = "/recorder/updateprofile.json";
@@ -66,6 +90,7 @@ static const char* g_abortSessionURL = "/recorder/session/abort";
 static const char* g_setSessionCommentsURL = "/recorder/session/setsessioncomments";
 static const char* g_getSessionCommentsURL = "/recorder/session/getsessioncomments.json";
 static const char* g_cacheContentsURL = "/recorder/cache/contents.json";
+static const char* g_cacheContentsUpdateURL = "/recorder/cache/contentsupdate.json";
 static const char* g_confReplayURL = "/confreplay/*";
 static const char* g_replayFileURL = "/recorder/replay";
 static const char* g_playItemURL = "/recorder/session/playitem";
@@ -97,6 +122,29 @@ static bool parse_int(string intStr, int* value)
     return sscanf(intStr.c_str(), "%d", value) == 1; 
 }
 
+static bool parse_int64(string intStr, int64_t* value)
+{
+    long long llValue;
+    if (sscanf(intStr.c_str(), "%lld", &llValue) != 1)
+    {
+        return false;
+    }
+    
+    *value = llValue;
+    return true;
+}
+
+static int get_update_timeout(HTTPConnection* connection)
+{
+    int timeoutSec;
+    if (!parse_int(connection->getQueryValue("timeout"), &timeoutSec) || timeoutSec < 0)
+    {
+        return DEFAULT_UPDATE_TIMEOUT_SEC;
+    }
+    
+    return timeoutSec < MAX_UPDATE_TIMEOUT_SEC ? timeoutSec : MAX_UPDATE_TIMEOUT_SEC;
+}
+
 static bool parse_aspect_ratio_codes(string aspectRatioCodesString, vector<string>* aspectRatioCodes)
 {
     string aspectRatioCode;
@@ -348,6 +396,143 @@ static string get_vtr_state_string(VTRState state)
     }
 }
 
+static RecorderStatusQuery get_status_query(HTTPConnection* connection)
+{
+    RecorderStatusQuery query;
+    
+    query.includeBarcode = (connection->getQueryValue("barcode") == "true");
+    if (connection->getQueryValue("sessionrecord") == "true")
+    {
+        query.includeSessionRecord = true;
+    }
+    else if (connection->getQueryValue("sessionreview") == "true")
+    {
+        query.includeSessionReview = true;
+        query.includeReplay = true;
+    }
+    query.includeDeveloper = (connection->getQueryValue("developer") == "true");
+    if (connection->getQueryValue("replay") == "true")
+    {
+        query.includeReplay = true;
+    }
+    query.includeCache = (connection->getQueryValue("cache") == "true");
+    query.includeSystem = (connection->getQueryValue("system") == "true");
+    
+    return query;
+}
+
+static void set_cache_content_item(JSONObject* tv, CacheContentItem* item)
+{
+    tv->setNumber("identifier", item->identifier);
+    tv->setString("srcFormat", item->sourceFormat);
+    tv->setString("srcSpoolNo", item->sourceSpoolNo);
+    tv->setNumber("srcItemNo", item->sourceItemNo);
+    tv->setString("srcMPProgNo", get_complete_prog_no(item->sourceMagPrefix, item->sourceProgNo, item->sourceProdCode));
+    tv->setString("sessionCreation", get_timestamp_string(item->sessionCreation));
+    tv->setNumber("sessionStatus", item->sessionStatus);
+    tv->setString("sessionStatusString", get_session_status_string(item->sessionStatus));
+    tv->setString("name", item->name);
+    tv->setNumber("size", item->size);
+    tv->setNumber("duration", item->duration);
+    string pseURL = g_pseReportFramedURL;
+    pseURL += "?name=" + item->pseName;
+    tv->setString("pseURL", pseURL);
+    tv->setNumber("pseResult", item->pseResult);
+}
+
+
+
+class StatusUpdateRequest : public HTTPPendingResponse
+{
+public:
+    StatusUpdateRequest(HTTPRecorder* httpRecorder, RecorderStatusQuery query, int64_t updateVersion)
+    : _httpRecorder(httpRecorder), _query(query), _updateVersion(updateVersion)
+    {}
+    virtual ~StatusUpdateRequest()
+    {}
+    
+    virtual void poll(HTTPConnection* connection, bool timedOut)
+    {
+        _httpRecorder->pollRecorderStatusUpdate(connection, _query, _updateVersion, timedOut);
+    }
+    
+private:
+    HTTPRecorder* _httpRecorder;
+    RecorderStatusQuery _query;
+    int64_t _updateVersion;
+};
+
+class CacheContentsUpdateRequest : public HTTPPendingResponse
+{
+public:
+    CacheContentsUpdateRequest(HTTPRecorder* httpRecorder, int statusChangeCount)
+    : _httpRecorder(httpRecorder), _statusChangeCount(statusChangeCount)
+    {}
+    virtual ~CacheContentsUpdateRequest()
+    {}
+    
+    virtual void poll(HTTPConnection* connection, bool timedOut)
+    {
+        _httpRecorder->pollCacheContentsUpdate(connection, _statusChangeCount, timedOut);
+    }
+    
+private:
+    HTTPRecorder* _httpRecorder;
+    int _statusChangeCount;
+};
+
+
+
+RecorderStatusQuery::RecorderStatusQuery()
+: includeBarcode(false), includeSessionRecord(false), includeSessionReview(false), includeCache(false),
+  includeSystem(false), includeDeveloper(false), includeReplay(false)
+{
+}
+
+string RecorderStatusQuery::getKey() const
+{
+    string key;
+    key += includeBarcode ? "1" : "0";
+    key += includeSessionRecord ? "1" : "0";
+    key += includeSessionReview ? "1" : "0";
+    key += includeCache ? "1" : "0";
+    key += includeSystem ? "1" : "0";
+    key += includeDeveloper ? "1" : "0";
+    key += includeReplay ? "1" : "0";
+    
+    return key;
+}
+
+
+StatusUpdateState::StatusUpdateState()
+: recorderStatusChangeCount(-1), barcodeCount(-1), haveBarcode(false), cacheStatusChangeCount(-1)
+{
+}
+
+StatusUpdateState::~StatusUpdateState()
+{
+    size_t i;
+    for (i = 0; i < history.size(); i++)
+    {
+        delete history[i].second;
+    }
+}
+
+
+CacheContentsUpdateState::CacheContentsUpdateState()
+: statusChangeCount(0)
+{
+}
+
+CacheContentsUpdateState::~CacheContentsUpdateState()
+{
+    size_t i;
+    for (i = 0; i < items.size(); i++)
+    {
+        delete items[i].second;
+    }
+}
+
 
 
 
@@ -358,6 +543,9 @@ HTTPRecorder::HTTPRecorder(HTTPServer* server, Recorder* recorder, BarcodeScanne
 {
     HTTPServiceDescription* service;
     
+    // status update versions are unique across restarts so that a client's version is not mistaken for the current
+    _nextUpdateVersion = (int64_t)time(0) * 1000;
+    
     service = server->registerService(new HTTPServiceDescription(g_recorderStatusURL), this);
     service->setDescription("Returns the recorder status");
     service->addArgument("barcode", "boolean", false, "Include barcode scanned in using the barcode scanner");
@@ -365,6 +553,11 @@ HTTPRecorder::HTTPRecorder(HTTPServer* server, Recorder* recorder, BarcodeScanne
     service->addArgument("cache", "boolean", false, "Include cache status information");
     service->addArgument("system", "boolean", false, "Include system information");
     
+    service = server->registerService(new HTTPServiceDescription(g_recorderStatusUpdateURL), this);
+    service->setDescription("Returns the recorder status when it has changed compared to the given version. Only the changed members are returned if the given version is recent, with 'delta' set to true. Takes the same arguments as /recorder/status.json as well");
+    service->addArgument("updateversion", "integer", false, "The 'updateVersion' returned by the previous request. The full status is returned if not set");
+    service->addArgument("timeout", "integer", false, "Maximum seconds to wait for a change (default 25, maximum 60)");
+    
     service = server->registerService(new HTTPServiceDescription(g_getProfileListURL), this);
     service->setDescription("Returns the list of profile identifiers and names");
     
@@ -417,6 +610,11 @@ HTTPRecorder::HTTPRecorder(HTTPServer* server, Recorder* recorder, BarcodeScanne
     service = server->registerService(new HTTPServiceDescription(g_cacheContentsURL), this);
     service->setDescription("Returns the contents of the cache");
     
+    service = server->registerService(new HTTPServiceDescription(g_cacheContentsUpdateURL), this);
+    service->setDescription("Returns the contents of the cache when the cache status has changed. Only the changed items and the identifiers of the deleted items are returned if the given count is recent, with 'delta' set to true");
+    service->addArgument("statuschangecount", "integer", false, "The 'statusChangeCount' returned by the previous request. All items are returned if not set");
+    service->addArgument("timeout", "integer", false, "Maximum seconds to wait for a change (default 25, maximum 60)");
+    
     service = server->registerService(new HTTPServiceDescription(g_confReplayURL), this);
     service->setDescription("Forwards control commands to the confidence replay player");
     
@@ -490,6 +688,17 @@ HTTPRecorder::HTTPRecorder(HTTPServer* server, Recorder* recorder, BarcodeScanne
 
 HTTPRecorder::~HTTPRecorder()
 {
+    map<string, StatusUpdateState*>::const_iterator iter;
+    for (iter = _statusUpdates.begin(); iter != _statusUpdates.end(); iter++)
+    {
+        delete iter->second;
+    }
+    
+    size_t i;
+    for (i = 0; i < _cacheContentsUpdates.size(); i++)
+    {
+        delete _cacheContentsUpdates[i];
+    }
 }
 
 void HTTPRecorder::newBarcode(string barcode)
@@ -519,6 +728,10 @@ void HTTPRecorder::processRequest(HTTPServiceDescription* serviceDescription, HT
     {
         getRecorderStatus(connection);
     }
+    else if (serviceDescription->getURL() == g_recorderStatusUpdateURL)
+    {
+        getRecorderStatusUpdate(connection);
+    }
     else if (serviceDescription->getURL() == g_getProfileListURL)
     {
         getProfileList(connection);
@@ -579,6 +792,10 @@ void HTTPRecorder::processRequest(HTTPServiceDescription* serviceDescription, HT
     {
         getCacheContents(connection);
     }
+    else if (serviceDescription->getURL() == g_cacheContentsUpdateURL)
+    {
+        getCacheContentsUpdate(connection);
+    }
     else if (serviceDescription->getURL() == g_confReplayURL)
     {
         confReplayControl(connection);
@@ -659,13 +876,119 @@ void HTTPRecorder::processSSIRequest(string name, HTTPConnection* connection)
 
 void HTTPRecorder::getRecorderStatus(HTTPConnection* connection)
 {
-    bool includeBarcode = false;
-    bool includeSessionRecord = false;
-    bool includeSessionReview = false;
-    bool includeCache = false;
-    bool includeSystem = false;
-    bool includeDeveloper = false;
-    bool includeReplay = false;
+    JSONObject json;
+    createRecorderStatus(get_status_query(connection), &json);
+    
+    connection->sendJSON(&json);
+}
+
+void HTTPRecorder::getRecorderStatusUpdate(HTTPConnection* connection)
+{
+    RecorderStatusQuery query = get_status_query(connection);
+    
+    int64_t updateVersion = -1;
+    if (connection->haveQueryValue("updateversion"))
+    {
+        parse_int64(connection->getQueryValue("updateversion"), &updateVersion);
+    }
+    
+    if (!pollRecorderStatusUpdate(connection, query, updateVersion, false))
+    {
+        connection->setPendingResponse(new StatusUpdateRequest(this, query, updateVersion),
+            get_update_timeout(connection) * SEC_IN_USEC);
+    }
+}
+
+bool HTTPRecorder::pollRecorderStatusUpdate(HTTPConnection* connection, const RecorderStatusQuery& query,
+    int64_t updateVersion, bool timedOut)
+{
+    LOCK_SECTION(_updateMutex);
+    
+    StatusUpdateState* state;
+    map<string, StatusUpdateState*>::iterator result = _statusUpdates.find(query.getKey());
+    if (result == _statusUpdates.end())
+    {
+        state = new StatusUpdateState();
+        _statusUpdates[query.getKey()] = state;
+    }
+    else
+    {
+        state = result->second;
+    }
+    
+    // refresh the status shared by all clients with this query
+    if (checkStatusChanges(query, state) || state->history.empty() || state->refreshTimer.timeLeft() <= 0)
+    {
+        bool active = _recorder->haveSession() || _recorder->confidenceReplayActive();
+        
+        auto_ptr<JSONObject> status(new JSONObject());
+        createRecorderStatus(query, status.get());
+        
+        if (state->history.empty() || status->toString() != state->history.back().second->toString())
+        {
+            state->history.push_back(pair<int64_t, JSONObject*>(_nextUpdateVersion, status.release()));
+            _nextUpdateVersion++;
+            
+            if (state->history.size() > UPDATE_HISTORY_SIZE)
+            {
+                delete state->history.front().second;
+                state->history.pop_front();
+            }
+        }
+        
+        state->refreshTimer.start((active ? STATUS_UPDATE_INTERVAL_MSEC : STATUS_IDLE_REFRESH_MSEC) * MSEC_IN_USEC);
+    }
+    
+    int64_t currentVersion = state->history.back().first;
+    JSONObject* currentStatus = state->history.back().second;
+    if (updateVersion == currentVersion && !timedOut)
+    {
+        return false;
+    }
+    
+    
+    // generate the response, which is empty if there was no change before the timeout
+    
+    auto_ptr<JSONObject> json;
+    bool isDelta = true;
+    if (updateVersion == currentVersion)
+    {
+        json.reset(new JSONObject());
+    }
+    else
+    {
+        size_t i;
+        for (i = 0; i < state->history.size() - 1; i++)
+        {
+            if (state->history[i].first == updateVersion)
+            {
+                json.reset(currentStatus->createDelta(state->history[i].second));
+                break;
+            }
+        }
+        if (!json.get())
+        {
+            json.reset(dynamic_cast<JSONObject*>(currentStatus->clone()));
+            isDelta = false;
+        }
+    }
+    json->setNumber("updateVersion", currentVersion);
+    json->setBool("delta", isDelta);
+    
+    connection->sendJSON(json.get());
+    
+    return true;
+}
+
+void HTTPRecorder::createRecorderStatus(const RecorderStatusQuery& query, JSONObject* json)
+{
+    bool includeBarcode = query.includeBarcode;
+    bool includeSessionRecord = query.includeSessionRecord;
+    bool includeSessionReview = query.includeSessionReview;
+    bool includeCache = query.includeCache;
+    bool includeSystem = query.includeSystem;
+    bool includeDeveloper = query.includeDeveloper;
+    bool includeReplay = query.includeReplay;
     string barcode;
     int barcodeCount = 0;
     SessionStatus sessionStatus;
@@ -678,12 +1001,8 @@ void HTTPRecorder::getRecorderStatus(HTTPConnection* connection)
     int apiVersion;
     ConfidenceReplayStatus replayStatus;
 
-    // process the URL query string
-    string barcodeArg = connection->getQueryValue("barcode");
-    if (barcodeArg == "true")
+    if (includeBarcode)
     {
-        includeBarcode = true;
-        
         checkBarcodeStatus();
         
         {
@@ -692,29 +1011,8 @@ void HTTPRecorder::getRecorderStatus(HTTPConnection* connection)
             barcodeCount = _barcodeCount;
         }
     }
-    string sessionArg = connection->getQueryValue("sessionrecord");
-    if (sessionArg == "true")
-    {
-        includeSessionRecord = true;
-    }
-    else
-    {
-        sessionArg = connection->getQueryValue("sessionreview");
-        if (sessionArg == "true")
-        {
-            includeSessionReview = true;
-            includeReplay = true;
-        }
-    }
-    string developerArg = connection->getQueryValue("developer");
-    if (developerArg == "true")
-    {
-        includeDeveloper = true;
-    }
-    string replayArg = connection->getQueryValue("replay");
-    if (includeReplay || replayArg == "true")
+    if (includeReplay)
     {
-        includeReplay = true;
         replayStatus = _recorder->getConfidenceReplayStatus();
     }
     if (includeSessionRecord || includeSessionReview || includeDeveloper)
@@ -725,16 +1023,12 @@ void HTTPRecorder::getRecorderStatus(HTTPConnection* connection)
         }
         _recorder->getLastSessionResult(&lastSessionResult, &lastSessionSourceSpoolNo, &lastSessionFailureReason);
     }
-    string cacheArg = connection->getQueryValue("cache");
-    if (cacheArg == "true")
+    if (includeCache)
     {
-        includeCache = true;
         cacheStatus = _recorder->getCache()->getStatus();
     }
-    string systemArg = connection->getQueryValue("system");
-    if (systemArg == "true")
+    if (includeSystem)
     {
-        includeSystem = true;
         systemStatus = _recorder->getSystemStatus();
     }
 
@@ -762,26 +1056,25 @@ void HTTPRecorder::getRecorderStatus(HTTPConnection* connection)
     
     // generate JSON response
     
-    JSONObject json;
-    json.setString("recorderName", status.recorderName);
-    json.setNumber("apiVersion", apiVersion);
-    json.setBool("database", status.databaseOk);
-    json.setBool("sdiCard", status.sdiCardOk);
-    json.setBool("video", status.videoOk);
-    json.setBool("audio", status.audioOk);
-    json.setBool("vtr", status.vtrOk);
-    json.setString("sourceVTRState", get_vtr_state_string(status.sourceVTRState));
-    json.setString("digibetaVTRState", get_vtr_state_string(status.digibetaVTRState));
-    json.setBool("readyToRecord", status.readyToRecord);
+    json->setString("recorderName", status.recorderName);
+    json->setNumber("apiVersion", apiVersion);
+    json->setBool("database", status.databaseOk);
+    json->setBool("sdiCard", status.sdiCardOk);
+    json->setBool("video", status.videoOk);
+    json->setBool("audio", status.audioOk);
+    json->setBool("vtr", status.vtrOk);
+    json->setString("sourceVTRState", get_vtr_state_string(status.sourceVTRState));
+    json->setString("digibetaVTRState", get_vtr_state_string(status.digibetaVTRState));
+    json->setBool("readyToRecord", status.readyToRecord);
     if (includeBarcode && barcode.size() > 0)
     {
-        json.setString("barcode", barcode);
-        json.setNumber("barcodeCount", barcodeCount);
+        json->setString("barcode", barcode);
+        json->setNumber("barcodeCount", barcodeCount);
     }
-    json.setNumber("sessionState", sessionState);
+    json->setNumber("sessionState", sessionState);
     if (includeSessionRecord)
     {
-        JSONObject* jsonSessionStatus = json.setObject("sessionStatus");
+        JSONObject* jsonSessionStatus = json->setObject("sessionStatus");
         jsonSessionStatus->setNumber("state", sessionStatus.state);
         jsonSessionStatus->setNumber("itemCount", sessionStatus.itemCount);
         jsonSessionStatus->setNumber("sessionCommentsCount", sessionStatus.sessionCommentsCount);
@@ -823,7 +1116,7 @@ void HTTPRecorder::getRecorderStatus(HTTPConnection* connection)
     }
     else if (includeSessionReview)
     {
-        JSONObject* jsonSessionStatus = json.setObject("sessionStatus");
+        JSONObject* jsonSessionStatus = json->setObject("sessionStatus");
         jsonSessionStatus->setNumber("state", sessionStatus.state);
         jsonSessionStatus->setNumber("itemCount", sessionStatus.itemCount);
         jsonSessionStatus->setBool("readyToChunk", sessionStatus.readyToChunk);
@@ -854,29 +1147,27 @@ void HTTPRecorder::getRecorderStatus(HTTPConnection* connection)
     }
     if (includeCache)
     {
-        json.setNumber("numCacheItems", cacheStatus.numItems);
-        json.setNumber("statusChangeCount", cacheStatus.statusChangeCount);
-        json.setBool("replayActive", status.replayActive);
-        json.setString("replayFilename", status.replayFilename);
+        json->setNumber("numCacheItems", cacheStatus.numItems);
+        json->setNumber("statusChangeCount", cacheStatus.statusChangeCount);
+        json->setBool("replayActive", status.replayActive);
+        json->setString("replayFilename", status.replayFilename);
     }
     if (includeSystem)
     {
-        json.setString("version", get_version());
-        json.setString("buildDate", get_build_date());
-        json.setNumber("diskSpace", systemStatus.remDiskSpace);
-        json.setNumber("recordingTime", systemStatus.remDuration);
-        json.setString("recordingTimeIngestFormat", ingest_format_to_string(systemStatus.remDurationIngestFormat, false));
+        json->setString("version", get_version());
+        json->setString("buildDate", get_build_date());
+        json->setNumber("diskSpace", systemStatus.remDiskSpace);
+        json->setNumber("recordingTime", systemStatus.remDuration);
+        json->setString("recordingTimeIngestFormat", ingest_format_to_string(systemStatus.remDurationIngestFormat, false));
     }
     if (includeReplay)
     {
-        JSONObject* jsonReplayStatus = json.setObject("replayStatus");
+        JSONObject* jsonReplayStatus = json->setObject("replayStatus");
         jsonReplayStatus->setNumber("position", replayStatus.position);
         jsonReplayStatus->setNumber("duration", replayStatus.duration);
         jsonReplayStatus->setNumber("vtrErrorLevel", replayStatus.vtrErrorLevel);
         jsonReplayStatus->setNumber("markFilter", replayStatus.markFilter);
     }
-
-    connection->sendJSON(&json);
 }
 
 void HTTPRecorder::getProfileList(HTTPConnection* connection)
@@ -1709,25 +2000,123 @@ void HTTPRecorder::getCacheContents(HTTPConnection* connection)
     vector<CacheContentItem*>::const_iterator iter;
     for (iter = contents->items.begin(); iter != contents->items.end(); iter++)
     {
-        JSONObject* tv = jitems->appendObject();
-        tv->setNumber("identifier", (*iter)->identifier);
-        tv->setString("srcFormat", (*iter)->sourceFormat);
-        tv->setString("srcSpoolNo", (*iter)->sourceSpoolNo);
-        tv->setNumber("srcItemNo", (*iter)->sourceItemNo);
-        tv->setString("srcMPProgNo", get_complete_prog_no((*iter)->sourceMagPrefix, (*iter)->sourceProgNo, (*iter)->sourceProdCode));
-        tv->setString("sessionCreation", get_timestamp_string((*iter)->sessionCreation));
-        tv->setNumber("sessionStatus", (*iter)->sessionStatus);
-        tv->setString("sessionStatusString", get_session_status_string((*iter)->sessionStatus));
-        tv->setString("name", (*iter)->name);
-        tv->setNumber("size", (*iter)->size);
-        tv->setNumber("duration", (*iter)->duration);
-        string pseURL = g_pseReportFramedURL;
-        pseURL += "?name=" + (*iter)->pseName;
-        tv->setString("pseURL", pseURL);
-        tv->setNumber("pseResult", (*iter)->pseResult);
+        set_cache_content_item(jitems->appendObject(), *iter);
+    }
+    
+    connection->sendJSON(&json);
+}
+
+void HTTPRecorder::getCacheContentsUpdate(HTTPConnection* connection)
+{
+    int statusChangeCount = -1;
+    if (connection->haveQueryValue("statuschangecount"))
+    {
+        parse_int(connection->getQueryValue("statuschangecount"), &statusChangeCount);
+    }
+    
+    if (!pollCacheContentsUpdate(connection, statusChangeCount, false))
+    {
+        connection->setPendingResponse(new CacheContentsUpdateRequest(this, statusChangeCount),
+            get_update_timeout(connection) * SEC_IN_USEC);
+    }
+}
+
+bool HTTPRecorder::pollCacheContentsUpdate(HTTPConnection* connection, int statusChangeCount, bool timedOut)
+{
+    LOCK_SECTION(_updateMutex);
+    
+    CacheStatus status = _recorder->getCache()->getStatus();
+    if (status.statusChangeCount == statusChangeCount && !timedOut)
+    {
+        return false;
+    }
+    
+    // load the cache contents once for all clients when the status has changed
+    if (_cacheContentsUpdates.empty() || _cacheContentsUpdates.back()->statusChangeCount != status.statusChangeCount)
+    {
+        auto_ptr<CacheContents> contents(_recorder->getCache()->getContents());
+        if (!contents.get())
+        {
+            Logging::warning("Failed to load cache contents\n");
+            connection->sendServerError("Failed to load cache contents");
+            return true;
+        }
+        
+        auto_ptr<CacheContentsUpdateState> state(new CacheContentsUpdateState());
+        state->statusChangeCount = status.statusChangeCount;
+        state->path = contents->path;
+        vector<CacheContentItem*>::const_iterator iter;
+        for (iter = contents->items.begin(); iter != contents->items.end(); iter++)
+        {
+            state->items.push_back(pair<long, JSONObject*>((*iter)->identifier, new JSONObject()));
+            set_cache_content_item(state->items.back().second, *iter);
+            state->itemsById[(*iter)->identifier] = state->items.back().second;
+        }
+        
+        _cacheContentsUpdates.push_back(state.release());
+        if (_cacheContentsUpdates.size() > UPDATE_HISTORY_SIZE)
+        {
+            delete _cacheContentsUpdates.front();
+            _cacheContentsUpdates.pop_front();
+        }
+    }
+    
+    CacheContentsUpdateState* current = _cacheContentsUpdates.back();
+    CacheContentsUpdateState* previous = 0;
+    size_t i;
+    for (i = 0; i < _cacheContentsUpdates.size(); i++)
+    {
+        if (_cacheContentsUpdates[i]->statusChangeCount == statusChangeCount)
+        {
+            previous = _cacheContentsUpdates[i];
+            break;
+        }
+    }
+    
+    
+    // generate the response, with only the changed items if the client has a previous version
+    
+    JSONObject json;
+    
+    json.setString("path", current->path);
+    json.setNumber("statusChangeCount", current->statusChangeCount);
+    json.setBool("delta", previous != 0);
+    
+    JSONArray* jitems = json.setArray("items");
+    if (previous)
+    {
+        JSONArray* jdeletedItems = json.setArray("deletedItems");
+        
+        map<long, JSONObject*>::const_iterator result;
+        for (i = 0; i < current->items.size(); i++)
+        {
+            result = previous->itemsById.find(current->items[i].first);
+            if (result == previous->itemsById.end() ||
+                result->second->toString() != current->items[i].second->toString())
+            {
+                jitems->append(current->items[i].second->clone());
+            }
+        }
+        
+        for (i = 0; i < previous->items.size(); i++)
+        {
+            if (current->itemsById.find(previous->items[i].first) == current->itemsById.end())
+            {
+                jdeletedItems->append(new JSONNumber(previous->items[i].first));
+            }
+        }
+    }
+    else
+    {
+        for (i = 0; i < current->items.size(); i++)
+        {
+            jitems->append(current->items[i].second->clone());
+        }
     }
     
     connection->sendJSON(&json);
+    
+    return true;
 }
 
 void HTTPRecorder::confReplayControl(HTTPConnection* connection)
@@ -2165,3 +2554,40 @@ void HTTPRecorder::checkBarcodeStatus()
     }
 }
 
+bool HTTPRecorder::checkStatusChanges(const RecorderStatusQuery& query, StatusUpdateState* state)
+{
+    bool changed = false;
+    
+    int64_t recorderStatusChangeCount = _recorder->getStatusChangeCount();
+    if (recorderStatusChangeCount != state->recorderStatusChangeCount)
+    {
+        state->recorderStatusChangeCount = recorderStatusChangeCount;
+        changed = true;
+    }
+    
+    if (query.includeBarcode)
+    {
+        checkBarcodeStatus();
+        
+        LOCK_SECTION(_barcodeMutex);
+        if (_barcodeCount != state->barcodeCount || (_barcode.size() > 0) != state->haveBarcode)
+        {
+            state->barcodeCount = _barcodeCount;
+            state->haveBarcode = _barcode.size() > 0;
+            changed = true;
+        }
+    }
+    
+    if (query.includeCache)
+    {
+        int cacheStatusChangeCount = _recorder->getCache()->getStatus().statusChangeCount;
+        if (cacheStatusChangeCount != state->cacheStatusChangeCount)
+        {
+            state->cacheStatusChangeCount = cacheStatusChangeCount;
+            changed = true;
+        }
+    }
+    
+    return changed;
+}
+
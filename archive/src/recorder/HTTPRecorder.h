@@ -30,11 +30,58 @@
 #include "Threads.h"
 #include "Timing.h"
 
+#include <deque>
+
 
 namespace rec
 {
 
 
+class RecorderStatusQuery
+{
+public:
+    RecorderStatusQuery();
+    
+    std::string getKey() const;
+    
+    bool includeBarcode;
+    bool includeSessionRecord;
+    bool includeSessionReview;
+    bool includeCache;
+    bool includeSystem;
+    bool includeDeveloper;
+    bool includeReplay;
+};
+
+class StatusUpdateState
+{
+public:
+    StatusUpdateState();
+    ~StatusUpdateState();
+    
+    // the change counts when the status was last created
+    int64_t recorderStatusChangeCount;
+    int barcodeCount;
+    bool haveBarcode;
+    int cacheStatusChangeCount;
+    
+    Timer refreshTimer;
+    std::deque<std::pair<int64_t, JSONObject*> > history; // the current status version is at the back
+};
+
+class CacheContentsUpdateState
+{
+public:
+    CacheContentsUpdateState();
+    ~CacheContentsUpdateState();
+    
+    int statusChangeCount;
+    std::string path;
+    std::vector<std::pair<long, JSONObject*> > items;
+    std::map<long, JSONObject*> itemsById;
+};
+
+
 
 class HTTPRecorder : public BarcodeScannerListener, public HTTPConnectionHandler, public HTTPSSIHandler
 {
@@ -53,6 +100,9 @@ public:
     
     
     void getRecorderStatus(HTTPConnection* connection);
+    void getRecorderStatusUpdate(HTTPConnection* connection);
+    bool pollRecorderStatusUpdate(HTTPConnection* connection, const RecorderStatusQuery& query, int64_t updateVersion,
+        bool timedOut);
 
     void getProfileList(HTTPConnection* connection);
     void getProfile(HTTPConnection* connection);
@@ -75,6 +125,8 @@ public:
     void getSessionComments(HTTPConnection* connection);
     
     void getCacheContents(HTTPConnection* connection);
+    void getCacheContentsUpdate(HTTPConnection* connection);
+    bool pollCacheContentsUpdate(HTTPConnection* connection, int statusChangeCount, bool timedOut);
     
     void confReplayControl(HTTPConnection* connection);
 
@@ -102,6 +154,9 @@ public:
     
 private:
     void checkBarcodeStatus();
+    bool checkStatusChanges(const RecorderStatusQuery& query, StatusUpdateState* state);
+    
+    void createRecorderStatus(const RecorderStatusQuery& query, JSONObject* json);
 
     Recorder* _recorder;
     
@@ -109,6 +164,11 @@ private:
     int _barcodeCount;
     Timer _barcodeExpirationTimer;
     Mutex _barcodeMutex;
+    
+    Mutex _updateMutex;
+    int64_t _nextUpdateVersion;
+    std::map<std::string, StatusUpdateState*> _statusUpdates;
+    std::deque<CacheContentsUpdateState*> _cacheContentsUpdates;
 };
 
 
@@ -253,7 +253,7 @@ Recorder::Recorder(string name, std::string cacheDirectory, std::string browseDi
 _capture(0), _vtrControl1(0), _vtrControl2(0),
 _sessionDone(false), _session(0), _sessionThread(0),
 _lastSessionRecordingItems(0), _lastSessionResult(UNKNOWN_SESSION_RESULT),
-_cache(0), _recorderTable(0), _replay(0), _jogShuttleControl(0)
+_statusChangeCount(0), _cache(0), _recorderTable(0), _replay(0), _jogShuttleControl(0)
 {
     // create and load profiles
     
@@ -469,6 +469,8 @@ void Recorder::sdiStatusChanged(bool videoOK, bool audioOK, bool dltcOk, bool vi
     (void)dltcOk;
     (void)vitcOK;
     
+    statusChanged();
+    
     SESSION_ACCESS_SECTION();
     
     if (_session)
@@ -535,6 +537,13 @@ void Recorder::vtrDeviceType(VTRControl* vtrControl, int deviceTypeCode, DeviceT
     {
         vtrControl->pollExtState(true);
     }
+    
+    statusChanged();
+}
+
+void Recorder::vtrState(VTRControl* vtrControl, VTRState state, const unsigned char* stateBytes)
+{
+    statusChanged();
 }
 
 int Recorder::startNewSession(int profileId, Source* source, string digibetaBarcode, RecordingSession** session)
@@ -1163,6 +1172,13 @@ void Recorder::getLastSessionResult(SessionResult* result, string* sourceSpoolNo
     *failureReason = _lastSessionFailureReason;    
 }
 
+int64_t Recorder::getStatusChangeCount()
+{
+    LOCK_SECTION(_statusChangeMutex);
+    
+    return _statusChangeCount;
+}
+
 int64_t Recorder::getRemainingDiskSpace()
 {
     int64_t remDiskSpace = _cache->getDiskSpace() - DISK_SPACE_MARGIN;
@@ -1528,3 +1544,9 @@ bool Recorder::isBackupVTR(int deviceTypeCode)
     return false;
 }
 
+void Recorder::statusChanged()
+{
+    LOCK_SECTION(_statusChangeMutex);
+    
+    _statusChangeCount++;
+}
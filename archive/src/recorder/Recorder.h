@@ -132,6 +132,7 @@ public:
     
     // from VTRControlListener
     virtual void vtrDeviceType(VTRControl* vtrControl, int deviceTypeCode, DeviceType deviceType);
+    virtual void vtrState(VTRControl* vtrControl, VTRState state, const unsigned char* stateBytes);
     
     // returns 0 when successful; else see failure codes above
     int startNewSession(int profileId, Source* source, std::string digibetaBarcode, RecordingSession** session);
@@ -172,6 +173,9 @@ public:
     
     RecorderStatus getStatus();
     RecorderSystemStatus getSystemStatus();
+    
+    // incremented when the SDI or VTR status changes
+    int64_t getStatusChangeCount();
     void getLastSessionResult(SessionResult* result, std::string* sourceSpoolNo, std::string* failureReason);
     
     int64_t getRemainingDiskSpace();
@@ -210,6 +214,8 @@ private:
     bool isSourceVTR(int deviceTypeCode);
     bool isBackupVTR(int deviceTypeCode);
     
+    void statusChanged();
+    
 private:
     Mutex _profileManagerMutex;
     ProfileManager *_profileManager;
@@ -226,6 +232,9 @@ private:
     uint32_t _remDurationFactor;
     IngestFormat _remDurationIngestFormat;
     
+    Mutex _statusChangeMutex;
+    int64_t _statusChangeCount;
+    
     ::Capture* _capture;
     
     VTRControl* _vtrControl1;
@@ -24,8 +24,13 @@
  * 02110-1301, USA.
  */
 
-#include <stdlib.h>     // for qsort
+#include <stdlib.h>     // for abs
 #include <string.h>     // for memset
+#include <limits.h>     // for INT_MIN
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "yuvlib/YUV_frame.h"
 #include "digibeta_dropout.h"
@@ -36,6 +41,10 @@
 #define BL_W    (WIDTH / 8)
 #define BL_H    (HEIGHT / 8)
 #define BL_H2   ((HEIGHT + 32) / 8)
+
+// block arrays are surrounded by a border of zeros for spatial_hpf
+#define PAD_W   (BL_W + 2)
+#define PAD_H   (BL_H + 2)
 //
 // Added Jonathan Dec 09
 //
@@ -43,179 +52,162 @@
 #define MINIMUM(a,b) ((a) < (b) ? (a) : (b))
 
 
-static int median_3(int A, int B, int C)
+// horizontally high pass filter a line
+// The output is abs(B - median_3(A, B, C)), i.e. the amount B lies outside
+// the range of its neighbours, which fits in a byte
+static void hpf_line(const BYTE* inBuff, BYTE* outBuff,
+                     const int inStride, const int w)
 {
-    if (A > B)
+    int         i;
+    const BYTE* inPtr;
+    int         A, B, C;
+    int         lo, hi;
+
+    i = 1;
+#if defined(__SSE2__)
+    if (inStride == 2)
     {
-        if (B >= C)
-            return B;
-        // B is the smallest
-        if (A <= C)
-            return A;
-        return C;
+        // 16 samples at a time from every other byte, e.g. UYVY luma
+        const __m128i lumaMask = _mm_set1_epi16(0x00ff);
+        __m128i a, b, c, lo, hi;
+
+        for (; i + 18 <= w; i += 16)
+        {
+            inPtr = inBuff + (i - 1) * 2;
+            a = _mm_packus_epi16(
+                    _mm_and_si128(_mm_loadu_si128((const __m128i*)inPtr), lumaMask),
+                    _mm_and_si128(_mm_loadu_si128((const __m128i*)(inPtr + 16)), lumaMask));
+            b = _mm_packus_epi16(
+                    _mm_and_si128(_mm_loadu_si128((const __m128i*)(inPtr + 2)), lumaMask),
+                    _mm_and_si128(_mm_loadu_si128((const __m128i*)(inPtr + 18)), lumaMask));
+            c = _mm_packus_epi16(
+                    _mm_and_si128(_mm_loadu_si128((const __m128i*)(inPtr + 4)), lumaMask),
+                    _mm_and_si128(_mm_loadu_si128((const __m128i*)(inPtr + 20)), lumaMask));
+            lo = _mm_min_epu8(a, c);
+            hi = _mm_max_epu8(a, c);
+            // at most one of the saturated differences is non-zero
+            _mm_storeu_si128((__m128i*)(outBuff + i),
+                             _mm_or_si128(_mm_subs_epu8(b, hi), _mm_subs_epu8(lo, b)));
+        }
     }
-    else // A <= B
+#endif
+    for (; i < w - 1; i++)
     {
-        if (B <= C)
-            return B;
-        // B is the largest
-        if (A >= C)
-            return A;
-        return C;
+        inPtr = inBuff + i * inStride;
+        A = inPtr[-inStride];
+        B = inPtr[0];
+        C = inPtr[inStride];
+        lo = MINIMUM(A, C);
+        hi = MAXIMUM(A, C);
+        if (B > hi)
+            outBuff[i] = (BYTE)(B - hi);
+        else if (B < lo)
+            outBuff[i] = (BYTE)(lo - B);
+        else
+            outBuff[i] = 0;
     }
 }
 
-// horizontally high pass filter a line
-static void hpf_line(BYTE* inBuff, int* outBuff,
-                     const int inStride, const int w)
+// add the sums of each group of 8 samples in a line to the block accumulators
+static void block_sum_line(const BYTE* line, int* acc)
 {
     int     i;
-    BYTE*   inPtr;
-    int*    outPtr;
-    int     A, B, C;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sums;
 
-    inPtr = inBuff;
-    outPtr = outBuff + 1;
-    B = *inPtr;
-    inPtr += inStride;
-    C = *inPtr;
-    inPtr += inStride;
-    for (i = 1; i < w - 1; i++)
+    for (i = 0; i < BL_W; i += 2)
     {
-        A = B;
-        B = C;
-        C = *inPtr;
-        inPtr += inStride;
-        *outPtr++ = abs(B - median_3(A, B, C));
+        sums = _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(line + i * 8)), zero);
+        acc[i]     += _mm_cvtsi128_si32(sums);
+        acc[i + 1] += _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
     }
+#else
+    int     x;
+
+    for (i = 0; i < BL_W; i++)
+    {
+        for (x = 0; x < 8; x++)
+            acc[i] += *line++;
+    }
+#endif
 }
 
-static int block_average(int* inFrame, int* outFrame)
+// high pass filter the field lines and sum them in blocks of 8x4 samples
+// firstLine and numLines give the lines that were filtered, the other lines
+// are zero
+static void block_average(const BYTE* inLine, int inLineStride, int inPixelStride,
+                          int outOffset, int w, int firstLine, int numLines,
+                          int* outFrame)
 {
-    int     acc[BL_W];
-    int     i, j, y;
-    int*    inLine;
-    int*    inPtr;
+    BYTE    line[WIDTH + 16];
+    int     j, y;
+    int     fieldLine;
     int*    outLine;
-    int*    outPtr;
 
-    inLine = inFrame;
+    memset(line, 0, sizeof(line));
     outLine = outFrame;
+    fieldLine = 0;
     for (j = 0; j < BL_H; j++)
     {
-        for (i = 0; i < BL_W; i++)
-            acc[i] = 0;
+        memset(outLine, 0, BL_W * sizeof(int));
         for (y = 0; y < 4; y++)
         {
-            inPtr = inLine;
-            for (i = 0; i < BL_W; i++)
+            if (fieldLine >= firstLine && fieldLine < firstLine + numLines)
             {
-                acc[i] += *inPtr++;
-                acc[i] += *inPtr++;
-                acc[i] += *inPtr++;
-                acc[i] += *inPtr++;
-                acc[i] += *inPtr++;
-                acc[i] += *inPtr++;
-                acc[i] += *inPtr++;
-                acc[i] += *inPtr++;
+                hpf_line(inLine, &line[outOffset], inPixelStride, w);
+                block_sum_line(line, outLine);
+                inLine += inLineStride;
             }
-            inLine += WIDTH;
+            fieldLine++;
         }
-        outPtr = outLine;
-        for (i = 0; i < BL_W; i++)
-            *outPtr++ = acc[i];
-        outLine += BL_W;
+        outLine += PAD_W;
     }
-    return 0;
 }
 
 // Subtract MAX of neighbouring pixels to remove areas and leave spikes
-static int spatial_hpf(int* inFrame, int* outFrame)
+// inFrame has a border of zeros which has no effect on the maximum because
+// the block averages are not negative
+static int spatial_hpf(const int* inFrame, int* outFrame)
 {
-    int     i, j;
-    int     x, y;
-    int*    inLine;
-    int*    inPtr;
-    int*    outLine;
-    int*    outPtr;
+    int         x, y;
+    const int*  above;
+    const int*  inLine;
+    const int*  below;
+    int*        outLine;
+    int         neighbours;
 
     outLine = outFrame;
     for (y = 0; y < BL_H; y++)
     {
-        outPtr = outLine;
+        inLine = inFrame + (y + 1) * PAD_W + 1;
+        above = inLine - PAD_W;
+        below = inLine + PAD_W;
         for (x = 0; x < BL_W; x++)
-            *outPtr++ = 0;
-        outLine += BL_W;
-    }
-    for (j = -1; j <= 1; j++)
-    {
-        for (i = -1; i <= 1; i++)
         {
-            if (i != 0 || j != 0)
-            {
-                inLine = inFrame;
-                outLine = outFrame;
-                if (i < 0)
-                    outLine -= i;
-                else
-                    inLine += i;
-                if (j < 0)
-                    outLine -= j * BL_W;
-                else
-                    inLine += j * BL_W;
-                for (y = 0; y < BL_H - abs(j); y++)
-                {
-                    inPtr = inLine;
-                    outPtr = outLine;
-                    for (x = 0; x < BL_W - abs(i); x++)
-                    {
-                        *outPtr = MAXIMUM(*outPtr, *inPtr);
-                        // max is a macro, so don't increment pointers within it!
-                        inPtr++;
-                        outPtr++;
-                    }
-                    inLine += BL_W;
-                    outLine += BL_W;
-                }
-            }
+            neighbours = MAXIMUM(above[x - 1], above[x]);
+            neighbours = MAXIMUM(neighbours, above[x + 1]);
+            neighbours = MAXIMUM(neighbours, inLine[x - 1]);
+            neighbours = MAXIMUM(neighbours, inLine[x + 1]);
+            neighbours = MAXIMUM(neighbours, below[x - 1]);
+            neighbours = MAXIMUM(neighbours, below[x]);
+            neighbours = MAXIMUM(neighbours, below[x + 1]);
+            // now subtract 4 * max(neighbours) from main value
+            outLine[x] = inLine[x] - (4 * neighbours);
         }
-    }
-    // now subtract 4 * max(neighbours) from main value
-    inLine = inFrame;
-    outLine = outFrame;
-    for (y = 0; y < BL_H; y++)
-    {
-        inPtr = inLine;
-        outPtr = outLine;
-        for (x = 0; x < BL_W; x++)
-        {
-            *outPtr = *inPtr++ - (4 * *outPtr);
-            outPtr++;
-        }
-        inLine += BL_W;
         outLine += BL_W;
     }
     return 0;
 }
 
-static int compare(const void* A, const void* B)
-{
-    if (*(int*)A > *(int*)B)
-        return -1;
-    if (*(int*)A < *(int*)B)
-        return 1;
-    return 0;
-}
-
 static dropout_result detect_dropout(int* inFrame)
 {
     int             block, seq, sixth;  // loop counters
-    int             idx;                // buffer index
     int             x0, y0;             // coords of input sample
     int             acc;
-    int             buff[20];
+    int             value;
+    int             largest[3];
     dropout_result  result;
-    int*            inPtr;
 
     result.strength = -1000;
     result.sixth = -1;
@@ -228,7 +220,9 @@ static dropout_result detect_dropout(int* inFrame)
         y0 = 62 + (sixth % 2);
         for (seq = 0; seq < 57; seq++)
         {
-            idx = 0;
+            largest[0] = INT_MIN;
+            largest[1] = INT_MIN;
+            largest[2] = INT_MIN;
             for (block = 0; block < 20; block++)
             {
                 // bring pointers within range
@@ -241,21 +235,38 @@ static dropout_result detect_dropout(int* inFrame)
                 {
                     y0 -= BL_H2;
                 }
-                // copy data
+                // keep the largest three values in descending order
                 if (y0 < BL_H)
                 {
-                    inPtr = inFrame + (y0 * BL_W) + x0;
-                    buff[idx] = *inPtr;
-                    idx += 1;
+                    value = inFrame[(y0 * BL_W) + x0];
+                    if (value > largest[2])
+                    {
+                        if (value > largest[1])
+                        {
+                            largest[2] = largest[1];
+                            if (value > largest[0])
+                            {
+                                largest[1] = largest[0];
+                                largest[0] = value;
+                            }
+                            else
+                            {
+                                largest[1] = value;
+                            }
+                        }
+                        else
+                        {
+                            largest[2] = value;
+                        }
+                    }
                 }
                 // increment pointers
                 x0 -= 21;
                 y0 += 4;
             }
             y0 += 40;
-            // sort data and average largest two
-            qsort(buff, idx, sizeof(buff[0]), compare);
-            acc = ((buff[0] * 15) + (buff[1] * 100) + (buff[2] * 65)) / (15 + 100 + 65);
+            // weighted average of the largest three
+            acc = ((largest[0] * 15) + (largest[1] * 100) + (largest[2] * 65)) / (15 + 100 + 65);
             // result is largest of these
             if (result.strength < acc)
             {
@@ -271,17 +282,17 @@ static dropout_result detect_dropout(int* inFrame)
 dropout_result digibeta_dropout(YUV_frame* in_frame, int xOffset, int yOffset,
                                 int* workSpace)
 {
-    int     h, w, y;
+    int     h, w;
+    int     outOffset;
+    int     firstLine;
     BYTE*   inLine;
-    int*    outLine;
     int*    work[2];
 
     work[0] = workSpace;
-    work[1] = work[0] + (WIDTH * HEIGHT / 2);
-    // high pass filter input to workspace
-    memset(work[0], 0, sizeof(int) * WIDTH * HEIGHT / 2);
+    work[1] = work[0] + (PAD_W * PAD_H);
     inLine = in_frame->Y.buff;
-    outLine = work[0];
+    outOffset = 0;
+    firstLine = 0;
     if (xOffset >= 0)
     {
         inLine += xOffset * in_frame->Y.pixelStride;
@@ -289,7 +300,7 @@ dropout_result digibeta_dropout(YUV_frame* in_frame, int xOffset, int yOffset,
     }
     else
     {
-        outLine -= xOffset;
+        outOffset = -xOffset;
         w = MINIMUM(in_frame->Y.w, WIDTH + xOffset);
     }
     if (yOffset >= 0)
@@ -306,20 +317,20 @@ dropout_result digibeta_dropout(YUV_frame* in_frame, int xOffset, int yOffset,
             yOffset -= 1;
             h -= 1;
         }
-        outLine -= (yOffset / 2) * WIDTH;
+        firstLine = -(yOffset / 2);
         h = MINIMUM(h, HEIGHT + yOffset);
     }
-    for (y = 0; y < (h + 1) / 2; y++)
+    // high pass filter input and block average it into the workspace,
+    // leaving a border of zeros
+    memset(work[0], 0, sizeof(int) * PAD_W * PAD_H);
+    if (w > 2)
     {
-        hpf_line(inLine, outLine, in_frame->Y.pixelStride, w);
-        inLine += 2 * in_frame->Y.lineStride;
-        outLine += WIDTH;
+        block_average(inLine, 2 * in_frame->Y.lineStride, in_frame->Y.pixelStride,
+                      outOffset, w, firstLine, (h + 1) / 2, work[0] + PAD_W + 1);
     }
-    // block average high pass filtered input
-    block_average(work[0], work[1]);
     // high pass filter it to isolate dropout spikes
-    spatial_hpf(work[1], work[0]);
+    spatial_hpf(work[0], work[1]);
     // process data in workspace to find dropouts
-    return detect_dropout(work[0]);
+    return detect_dropout(work[1]);
 }
 
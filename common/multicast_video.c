@@ -277,24 +277,65 @@ extern int open_socket_for_streaming(const char *remote, int port)
 //  packet_num=1,2                    audio
 //  packet_num=3..packets_per_frame   video
 //
+// Compressed video streams set UDP_FLAG_COMPRESSED in every packet. The header
+// and audio packets are as above but each video packet-data starts with an
+// IngexSliceHeader followed by a chunk of compressed slice data. The number of
+// packets varies from frame to frame and is given by the header.
+//
 
 // flags set in second byte of packet (after 'I')
 #define UDP_FLAG_HEADER 0x80
 #define UDP_FLAG_AUDIO  0x40
 #define UDP_FLAG_VIDEO  0x20
+#define UDP_FLAG_COMPRESSED 0x10
 
 #define PTHREAD_MUTEX_LOCK(x) if (pthread_mutex_lock( x ) != 0 ) fprintf(stderr, "pthread_mutex_lock failed\n");
 #define PTHREAD_MUTEX_UNLOCK(x) if (pthread_mutex_unlock( x ) != 0 ) fprintf(stderr, "pthread_mutex_unlock failed\n");
 
+extern int udp_get_slice_chunk_size(const IngexSliceHeader *slice_header, int video_size)
+{
+    int chunk_size = PACKET_SIZE - (4 + sizeof(IngexSliceHeader));
+
+    if (slice_header->num_slices > UDP_MAX_SLICES || slice_header->slice >= slice_header->num_slices ||
+        slice_header->slice_lines == 0 || video_size <= 0)
+    {
+        return -1;
+    }
+
+    // the fields are untrusted and so each is checked on its own, which ensures no sum can wrap
+    if (slice_header->slice_start > (uint32_t)video_size ||
+        slice_header->slice_size > (uint32_t)video_size - slice_header->slice_start ||
+        slice_header->chunk_offset >= slice_header->slice_size)
+    {
+        return -1;
+    }
+
+    if ((uint32_t)chunk_size > slice_header->slice_size - slice_header->chunk_offset)
+        chunk_size = slice_header->slice_size - slice_header->chunk_offset;
+
+    return chunk_size;
+}
+
 static void *udp_reader_thread(void *arg);
 
 extern int udp_init_reader(int width, int height, udp_reader_thread_t *p_udp_reader)
+{
+    return udp_init_compressed_reader(width, height, NULL, NULL, p_udp_reader);
+}
+
+extern int udp_init_compressed_reader(int width, int height, udp_decode_slice_func decode_slice, void *decode_slice_data,
+                                      udp_reader_thread_t *p_udp_reader)
 {
 #if TESTING_FLAG
     printf("Inside multicast_video: udp_init_reader\n");
 #endif
     int res;
 
+    p_udp_reader->width = width;
+    p_udp_reader->height = height;
+    p_udp_reader->decode_slice = decode_slice;
+    p_udp_reader->decode_slice_data = decode_slice_data;
+
     // setup element size and offsets
     int video_size = width*height*3/2;
     int audio_size = 1920*2 * 2;
@@ -314,6 +355,13 @@ extern int udp_init_reader(int width, int height, udp_reader_thread_t *p_udp_rea
         memset(p_udp_reader->ring[i], 0, element_size);
         memset(&p_udp_reader->stats[i], 0, sizeof(FrameStats));
 
+        // compressed slices are never larger than the uncompressed frame
+        p_udp_reader->slice_buf[i] = NULL;
+        if (decode_slice)
+        {
+            p_udp_reader->slice_buf[i] = (uint8_t *)malloc(video_size);
+        }
+
         // Initialise mutexes
         if ((res = pthread_mutex_init(&p_udp_reader->m_frame_copy[i], NULL)) != 0)
         {
@@ -361,6 +409,7 @@ extern int udp_shutdown_reader(udp_reader_thread_t *p_udp_reader)
     for (i = 0; i < UDP_FRAME_BUFFER_MAX; i++)
     {
         free(p_udp_reader->ring[i]);
+        free(p_udp_reader->slice_buf[i]);
     }
 
     return 1;
@@ -443,6 +492,7 @@ static void *udp_reader_thread(void *arg)
 
             // update frame stats
             p_stats->header_frame_number = p_header->frame_number;
+            p_stats->packets_per_frame = p_header->packets_per_frame;
         }
         else if ((flags & UDP_FLAG_AUDIO))
         {
@@ -461,6 +511,42 @@ static void *udp_reader_thread(void *arg)
             else
                 printf("Bad memcpy calc: packet_num=%d audio_pos=%d audio_chunk_size=%d audio_size=%d\n", packet_num, audio_pos, audio_chunk_size, audio_size);
         }
+        else if ((flags & UDP_FLAG_VIDEO) && (flags & UDP_FLAG_COMPRESSED))
+        {
+            // compressed slice packet
+            IngexSliceHeader slice_header;
+            memcpy(&slice_header, &buf[4], sizeof(slice_header));
+            int chunk_size = udp_get_slice_chunk_size(&slice_header, p_udp_reader->video_size);
+
+            if (p_udp_reader->decode_slice && chunk_size > 0)
+            {
+                uint8_t *slice = p_udp_reader->slice_buf[frame_number] + slice_header.slice_start;
+                memcpy(slice + slice_header.chunk_offset, &buf[4 + sizeof(IngexSliceHeader)], chunk_size);
+
+                // Decode as soon as the slice is complete rather than waiting for the whole frame
+                p_stats->slice_bytes[slice_header.slice] += chunk_size;
+                if (p_stats->slice_bytes[slice_header.slice] == (int)slice_header.slice_size)
+                {
+                    int first_line = slice_header.slice * slice_header.slice_lines;
+                    int num_lines = slice_header.slice_lines;
+                    if (first_line + num_lines > p_udp_reader->height)
+                        num_lines = p_udp_reader->height - first_line;
+
+                    if (num_lines > 0 &&
+                        !p_udp_reader->decode_slice(p_udp_reader->decode_slice_data,
+                                                    p_udp_reader->width, p_udp_reader->height, first_line, num_lines,
+                                                    slice, slice_header.slice_size, video))
+                    {
+                        printf("Failed to decode slice %d of frame %d\n", slice_header.slice, p_stats->header_frame_number);
+                    }
+                }
+            }
+            else
+            {
+                printf("Bad slice: packet_num=%d slice=%d num_slices=%d slice_start=%u slice_size=%u chunk_offset=%u\n", packet_num,
+                       slice_header.slice, slice_header.num_slices, slice_header.slice_start, slice_header.slice_size, slice_header.chunk_offset);
+            }
+        }
         else if (flags & UDP_FLAG_VIDEO)
         {
             // video packet
@@ -481,8 +567,11 @@ static void *udp_reader_thread(void *arg)
 
         PTHREAD_MUTEX_UNLOCK( &p_udp_reader->m_frame_copy[frame_number] )
 
+        // The packet count of compressed frames varies and is only known once the header arrives
         p_stats->packets++;
-        if (p_stats->packets == packets_per_frame)
+        if ((flags & UDP_FLAG_COMPRESSED) ?
+                p_stats->packets == p_stats->packets_per_frame :
+                p_stats->packets == packets_per_frame)
         {
             p_stats->last_time = gettimeofday64();
             p_stats->frame_complete = 1;
@@ -575,7 +664,7 @@ extern int udp_read_next_frame(udp_reader_thread_t *p_udp_reader, double timeout
     p_udp_reader->last_header_frame_read = p_header->frame_number;
 
     // clear frame we just read
-    memset(p_udp_reader->ring[frame_number], 0, sizeof(FrameStats) + sizeof(IngexNetworkHeader));
+    memset(p_udp_reader->ring[frame_number], 0, sizeof(IngexNetworkHeader));
     memset(p_stats, 0, sizeof(FrameStats));
 
     return 0;
@@ -746,6 +835,12 @@ extern int udp_read_frame_audio_video(int fd, double timeout, IngexNetworkHeader
 }
 
 extern int udp_read_frame_header(int fd, IngexNetworkHeader *p_header)
+{
+    int compressed;
+    return udp_read_stream_header(fd, p_header, &compressed);
+}
+
+extern int udp_read_stream_header(int fd, IngexNetworkHeader *p_header, int *p_compressed)
 {
 #if TESTING_FLAG
     printf("Inside multicast_video: udp_read_frame_header\n");
@@ -799,11 +894,13 @@ extern int udp_read_frame_header(int fd, IngexNetworkHeader *p_header)
 
         // fill out header
         memcpy(p_header, &buf[4], sizeof(IngexNetworkHeader));
+        *p_compressed = (buf[1] & UDP_FLAG_COMPRESSED) ? 1 : 0;
 
         break;
     }
-    printf(" width=%d height=%d framerate=%d/%d audio_size=%d packets_per_frame=%d frame_number=%d source_name=\"%s\"\n",
-            p_header->width, p_header->height, p_header->framerate_numer, p_header->framerate_denom, p_header->audio_size, p_header->packets_per_frame, p_header->frame_number, p_header->source_name);
+    printf(" width=%d height=%d framerate=%d/%d audio_size=%d packets_per_frame=%d frame_number=%d source_name=\"%s\"%s\n",
+            p_header->width, p_header->height, p_header->framerate_numer, p_header->framerate_denom, p_header->audio_size, p_header->packets_per_frame, p_header->frame_number, p_header->source_name,
+            *p_compressed ? " compressed" : "");
     return 0;
 }
 
@@ -933,6 +1030,134 @@ extern int send_audio_video(int fd, int width, int height, int audio_channels,
     return total_bytes_written;
 }
 
+// Write a full frame of audio and slice compressed video to the network. Slices are
+// packetized separately so the receiver can decode each one as soon as it arrives
+// and a lost packet only affects its own slice.
+extern int send_audio_compressed_video(int fd, int width, int height, int audio_channels,
+                        const uint8_t *video, const int *slice_sizes, int num_slices, int slice_lines,
+                        const uint8_t *audio, int frame_number, int vitc, int ltc, const char *source_name)
+{
+    uint8_t buf[PACKET_SIZE];
+    int total_bytes_written = 0;
+
+    if (num_slices < 1 || num_slices > UDP_MAX_SLICES)
+    {
+        fprintf(stderr, "Invalid number of slices %d\n", num_slices);
+        return 0;
+    }
+
+    int audio_size = audio_channels * (1920 * 2);       // each audio channel is 48kHz, 16bit
+    int audio_chunk_size = PACKET_SIZE - 4;
+    int audio_header_chunk_size = PACKET_SIZE - (4 + sizeof(IngexNetworkHeader));
+    int slice_chunk_size = PACKET_SIZE - (4 + sizeof(IngexSliceHeader));
+
+    // Header packet, remaining audio packets then the packets for each slice
+    int packets_per_frame = 1 + (audio_size - audio_header_chunk_size + audio_chunk_size - 1) / audio_chunk_size;
+    int i;
+    for (i = 0; i < num_slices; i++)
+    {
+        packets_per_frame += (slice_sizes[i] + slice_chunk_size - 1) / slice_chunk_size;
+    }
+
+    IngexNetworkHeader header;
+    memset(&header, 0, sizeof(header));
+    header.packets_per_frame = packets_per_frame;
+    header.signal_ok = 1;
+    header.framerate_numer = 25;
+    header.framerate_denom = 1;
+    header.width = width;
+    header.height = height;
+    header.audio_size = audio_size;
+    header.frame_number = frame_number;
+    header.vitc = vitc;
+    header.ltc = ltc;
+    if (source_name)
+    {
+        strncpy(header.source_name, source_name, sizeof(header.source_name)-1);
+        header.source_name[sizeof(header.source_name)-1] = '\0';
+    }
+
+    uint8_t flags = UDP_FLAG_COMPRESSED | ((frame_number % UDP_FRAME_BUFFER_MAX) & UDP_FRAME_BUFFER_FLAGS_MASK);
+    int remaining_audio = audio_size;
+    int slice = 0;
+    int slice_start = 0;
+    int chunk_offset = 0;
+
+    uint16_t packet_num;
+    for (packet_num = 0; packet_num < packets_per_frame; packet_num++)
+    {
+        // Unused space at the end of a packet is zero filled since packets are fixed size
+        memset(buf, 0, sizeof(buf));
+        buf[0] = 'I';       // sync byte 'I' for ingex
+        buf[1] = flags;
+        memcpy(&buf[2], &packet_num, sizeof(packet_num));
+
+        if (packet_num == 0)
+        {
+            // write header followed by as much audio as will fit
+            buf[1] |= UDP_FLAG_HEADER | UDP_FLAG_AUDIO;
+            memcpy(&buf[4], &header, sizeof(IngexNetworkHeader));
+            memcpy(&buf[4 + sizeof(IngexNetworkHeader)], audio, audio_header_chunk_size);
+            audio += audio_header_chunk_size;
+            remaining_audio -= audio_header_chunk_size;
+        }
+        else if (remaining_audio > 0)
+        {
+            // write remaining audio data
+            buf[1] |= UDP_FLAG_AUDIO;
+            int chunk_size = remaining_audio < audio_chunk_size ? remaining_audio : audio_chunk_size;
+            memcpy(&buf[4], audio, chunk_size);
+            audio += chunk_size;
+            remaining_audio -= chunk_size;
+        }
+        else
+        {
+            // write the next chunk of the current slice
+            buf[1] |= UDP_FLAG_VIDEO;
+            while (chunk_offset >= slice_sizes[slice])
+            {
+                // slice complete (or empty), move to the next
+                slice_start += slice_sizes[slice];
+                slice++;
+                chunk_offset = 0;
+            }
+
+            IngexSliceHeader slice_header;
+            memset(&slice_header, 0, sizeof(slice_header));
+            slice_header.slice = slice;
+            slice_header.num_slices = num_slices;
+            slice_header.slice_lines = slice_lines;
+            slice_header.slice_start = slice_start;
+            slice_header.slice_size = slice_sizes[slice];
+            slice_header.chunk_offset = chunk_offset;
+            memcpy(&buf[4], &slice_header, sizeof(slice_header));
+
+            int chunk_size = slice_sizes[slice] - chunk_offset;
+            if (chunk_size > slice_chunk_size)
+            {
+                chunk_size = slice_chunk_size;
+            }
+            memcpy(&buf[4 + sizeof(IngexSliceHeader)], video + slice_start + chunk_offset, chunk_size);
+            chunk_offset += chunk_size;
+        }
+
+#ifdef DEBUG_UDP_SEND_RECV
+        ssize_t bytes_written = write(fd, buf, PACKET_SIZE);
+        write(fd, "\n", 1);
+#else
+        ssize_t bytes_written = send(fd, buf, PACKET_SIZE, 0);
+#endif
+        if (bytes_written == -1)
+        {
+            perror("send");
+            return 0;
+        }
+        total_bytes_written += bytes_written;
+    }
+
+    return total_bytes_written;
+}
+
 extern void scale_video420_for_multicast(int in_width, int in_height, int out_width, int out_height, const uint8_t *video_frame, uint8_t *scaled_frame)
 {
 #if TESTING_FLAG
@@ -37,14 +37,45 @@ typedef struct {
 	char		source_name[MULTICAST_SOURCE_NAME_SIZE];	// includes terminating NUL
 } IngexNetworkHeader;
 
+// Compressed streams carry video as independently coded horizontal slices so
+// a receiver can decode each slice as soon as its packets arrive.
+// Each video packet starts with this header, followed by a chunk of slice data.
+#define UDP_MAX_SLICES 128
+
+typedef struct {
+	uint16_t	slice;			// slice index, top slice is 0
+	uint16_t	num_slices;
+	uint16_t	slice_lines;	// picture lines per slice, last slice may be shorter
+	uint16_t	reserved;
+	uint32_t	slice_start;	// offset of slice in the frame's compressed data
+	uint32_t	slice_size;
+	uint32_t	chunk_offset;	// offset of this packet's data in the slice
+} IngexSliceHeader;
+
+// Decode one slice of compressed video into rows first_line .. first_line+num_lines-1
+// of the planar 4:2:0 frame in video. Returns 0 on failure.
+typedef int (*udp_decode_slice_func)(void *data, int width, int height, int first_line, int num_lines,
+									 const uint8_t *slice, int slice_size, uint8_t *video);
+
 extern int connect_to_multicast_address(const char *address, int port);
 extern int open_socket_for_streaming(const char *remote, int port);
 
 extern int udp_read_frame_audio_video(int fd, double timeout, IngexNetworkHeader *p_header, uint8_t *video, uint8_t *audio, int *p_total);
 extern int udp_read_frame_header(int fd, IngexNetworkHeader *p_header);
+extern int udp_read_stream_header(int fd, IngexNetworkHeader *p_header, int *p_compressed);
 
 extern int send_audio_video(int fd, int width, int height, int audio_channels, const uint8_t *video, const uint8_t *audio, int frame_number, int vitc, int ltc, const char *source_name);
 
+// Send a frame of audio and slice compressed video. The slices are stored one after the
+// other in video, with slice_sizes[i] bytes for slice i.
+extern int send_audio_compressed_video(int fd, int width, int height, int audio_channels,
+						const uint8_t *video, const int *slice_sizes, int num_slices, int slice_lines,
+						const uint8_t *audio, int frame_number, int vitc, int ltc, const char *source_name);
+
+// Returns the number of bytes of slice data carried by a compressed video packet with this slice header,
+// or -1 if the header is malformed and the packet must be dropped
+extern int udp_get_slice_chunk_size(const IngexSliceHeader *slice_header, int video_size);
+
 // Number of frames in ring buffer - encoded into flags byte
 #define UDP_FRAME_BUFFER_MAX            4
 #define UDP_FRAME_BUFFER_FLAGS_MASK     0x03
@@ -55,6 +86,8 @@ typedef struct {
 	int packets;
 	int header_frame_number;
 	int frame_complete;
+	int packets_per_frame;					// from the header, compressed streams only
+	int slice_bytes[UDP_MAX_SLICES];		// bytes received per slice, compressed streams only
 } FrameStats;
 
 typedef struct {
@@ -69,9 +102,16 @@ typedef struct {
 	int ring_video_offset;
 	int next_frame;
 	int last_header_frame_read;
+	int width;
+	int height;
+	udp_decode_slice_func decode_slice;		// set for compressed streams
+	void *decode_slice_data;
+	uint8_t *slice_buf[UDP_FRAME_BUFFER_MAX];	// compressed slice reassembly
 } udp_reader_thread_t;
 
 extern int udp_init_reader(int width, int height, udp_reader_thread_t *p_udp_reader);
+extern int udp_init_compressed_reader(int width, int height, udp_decode_slice_func decode_slice, void *decode_slice_data,
+									  udp_reader_thread_t *p_udp_reader);
 extern int udp_shutdown_reader(udp_reader_thread_t *p_udp_reader);
 extern int udp_read_next_frame(udp_reader_thread_t *p_udp_reader, double timeout, IngexNetworkHeader *p_header_out, uint8_t *video_out, uint8_t *audio_out, int *p_total);
 
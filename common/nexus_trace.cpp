@@ -0,0 +1,186 @@
+/*
+ * $Id$
+ *
+ * Module for creating and updating the nexus pipeline trace shared memory
+ *
+ * Copyright (C) 2012 British Broadcasting Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include "nexus_trace.h"
+
+
+static void clear_entries(NexusTrace *trace)
+{
+    memset(trace, 0, sizeof(*trace));
+    for (int i = 0; i < MAX_CHANNELS; i++)
+    {
+        for (int j = 0; j < NEXUS_TRACE_RINGLEN; j++)
+        {
+            trace->entry[i][j].frame = -1;
+        }
+    }
+    trace->ringlen = NEXUS_TRACE_RINGLEN;
+}
+
+extern NexusTrace *nexus_trace_create(void)
+{
+    int id = shmget(trace_shm_key, sizeof(NexusTrace), IPC_CREAT | 0666);
+    if (id == -1)
+    {
+        perror("shmget trace key");
+        return NULL;
+    }
+
+    void *ptr = shmat(id, NULL, 0);
+    if (ptr == (void *)-1)
+    {
+        perror("shmat trace");
+        return NULL;
+    }
+
+    NexusTrace *trace = static_cast<NexusTrace *>(ptr);
+    clear_entries(trace);
+
+    return trace;
+}
+
+extern NexusTrace *nexus_trace_attach(int read_only)
+{
+    int id = shmget(trace_shm_key, sizeof(NexusTrace), 0444);
+    if (id == -1)
+    {
+        return NULL;
+    }
+
+    void *ptr = shmat(id, NULL, read_only ? SHM_RDONLY : 0);
+    if (ptr == (void *)-1)
+    {
+        return NULL;
+    }
+
+    NexusTrace *trace = static_cast<NexusTrace *>(ptr);
+    if (trace->ringlen != NEXUS_TRACE_RINGLEN)
+    {
+        // built with a different layout
+        shmdt(ptr);
+        return NULL;
+    }
+
+    return trace;
+}
+
+extern void nexus_trace_detach(NexusTrace *trace)
+{
+    if (trace)
+    {
+        shmdt(trace);
+    }
+}
+
+extern void nexus_trace_remove(void)
+{
+    struct shmid_ds shm_desc;
+
+    int id = shmget(trace_shm_key, sizeof(NexusTrace), 0444);
+    if (id != -1 && shmctl(id, IPC_RMID, &shm_desc) == -1)
+    {
+        perror("shmctl(id, IPC_RMID):");
+    }
+}
+
+extern int64_t nexus_trace_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+extern void nexus_trace_capture(NexusTrace *trace, int channel, int frame, NexusTraceCaptureStage stage)
+{
+    if (!trace || frame < 0)
+    {
+        return;
+    }
+
+    int64_t now = nexus_trace_time();
+    NexusTraceEntry *entry = &trace->entry[channel][frame % NEXUS_TRACE_RINGLEN];
+
+    if (entry->frame != frame)
+    {
+        // Invalidate the slot before clearing so a reader never pairs the
+        // new frame number with the previous frame's timestamps
+        entry->frame = -1;
+        __sync_synchronize();
+        memset(entry->capture, 0, sizeof(entry->capture));
+        memset(entry->encode, 0, sizeof(entry->encode));
+        __sync_synchronize();
+        entry->frame = frame;
+    }
+    entry->capture[stage] = now;
+}
+
+extern void nexus_trace_encode(NexusTrace *trace, int recorder, int channel, int encode, int frame,
+                               NexusTraceEncodeStage stage)
+{
+    if (!trace || frame < 0 || recorder < 0 || recorder >= MAX_RECORDERS ||
+        encode < 0 || encode >= MAX_ENCODES_PER_CHANNEL)
+    {
+        return;
+    }
+
+    int64_t now = nexus_trace_time();
+    NexusTraceEntry *entry = &trace->entry[channel][frame % NEXUS_TRACE_RINGLEN];
+
+    // Recorder is more than NEXUS_TRACE_RINGLEN frames behind capture
+    if (entry->frame != frame)
+    {
+        return;
+    }
+    entry->encode[recorder][encode][stage] = now;
+}
+
+extern const char *nexus_trace_capture_stage_name(NexusTraceCaptureStage stage)
+{
+    const char *names[] = {
+    "dma",
+    "publish"
+    };
+
+    return names[stage];
+}
+
+extern const char *nexus_trace_encode_stage_name(NexusTraceEncodeStage stage)
+{
+    const char *names[] = {
+    "pickup",
+    "convert",
+    "encode",
+    "write_submit",
+    "write_complete"
+    };
+
+    return names[stage];
+}
@@ -0,0 +1,91 @@
+/*
+ * $Id$
+ *
+ * Shared memory ring of per-frame timestamps through the capture, encode
+ * and write pipeline.
+ *
+ * Copyright (C) 2012 British Broadcasting Corporation
+ * All rights reserved
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef NEXUS_TRACE_H
+#define NEXUS_TRACE_H
+
+#include "nexus_control.h"
+
+// Shared memory key for the trace segment, created by the capture daemon
+// alongside the control and channel segments
+#ifdef WIN32
+const key_t trace_shm_key = "trace";
+#else
+const key_t trace_shm_key = 18;
+#endif
+
+#define NEXUS_TRACE_RINGLEN 256     // frames of trace history kept per channel
+
+// Stages timestamped by the capture daemon
+typedef enum {
+    NexusTraceDMAComplete,          // frame transferred from the capture card
+    NexusTracePublish,              // frame made available to readers via lastframe
+    NexusTraceNumCaptureStages
+} NexusTraceCaptureStage;
+
+// Stages timestamped by each Recorder encode
+typedef enum {
+    NexusTracePickup,               // frame taken from the ring buffer
+    NexusTraceConvert,              // input video converted, ready to encode
+    NexusTraceEncode,               // encoder returned (queued for the multi-threaded encoder)
+    NexusTraceWriteSubmit,          // first track write started
+    NexusTraceWriteComplete,        // last track write returned
+    NexusTraceNumEncodeStages
+} NexusTraceEncodeStage;
+
+// Timestamps are CLOCK_MONOTONIC nanoseconds, 0 when a stage was not reached
+typedef struct {
+    int     frame;                  // ring frame number (as in lastframe), -1 if unused
+    int64_t capture[NexusTraceNumCaptureStages];
+    int64_t encode[MAX_RECORDERS][MAX_ENCODES_PER_CHANNEL][NexusTraceNumEncodeStages];
+} NexusTraceEntry;
+
+typedef struct {
+    int             ringlen;        // NEXUS_TRACE_RINGLEN of the writer, checked by readers
+    NexusTraceEntry entry[MAX_CHANNELS][NEXUS_TRACE_RINGLEN];
+} NexusTrace;
+
+
+// Create (or re-use and clear) the trace segment - called by the capture daemon
+extern NexusTrace *nexus_trace_create(void);
+// Attach to an existing trace segment, returns NULL if not available
+extern NexusTrace *nexus_trace_attach(int read_only);
+extern void nexus_trace_detach(NexusTrace *trace);
+extern void nexus_trace_remove(void);
+
+// Current CLOCK_MONOTONIC time in nanoseconds
+extern int64_t nexus_trace_time(void);
+
+// Record the current time for a stage. Capture stages start a new entry for frame
+// when the slot still holds an older frame; encode stages for frames no longer in
+// the trace ring are ignored. All are no-ops if trace is NULL.
+extern void nexus_trace_capture(NexusTrace *trace, int channel, int frame, NexusTraceCaptureStage stage);
+extern void nexus_trace_encode(NexusTrace *trace, int recorder, int channel, int encode, int frame,
+                               NexusTraceEncodeStage stage);
+
+extern const char *nexus_trace_capture_stage_name(NexusTraceCaptureStage stage);
+extern const char *nexus_trace_encode_stage_name(NexusTraceEncodeStage stage);
+
+#endif // NEXUS_TRACE_H
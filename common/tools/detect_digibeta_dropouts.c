@@ -31,6 +31,7 @@
 
 #include <digibeta_dropout.h>
 #include <video_conversion_10bits.h>
+#include <time_utils.h>
 #include <yuvlib/YUV_frame.h>
 
 
@@ -70,6 +71,7 @@ static void usage(const char *cmd)
     fprintf(stderr, "  --thresh <val>   Dropout strength threshold (default %d)\n", DEFAULT_THRESHOLD);
     fprintf(stderr, "  --offset <val>   Frame offset (default %ld)\n", DEFAULT_FRAME_OFFSET);
     fprintf(stderr, "  --dur <val>      Analysis duration (default all frames)\n");
+    fprintf(stderr, "  --time           Print the average analysis time per frame\n");
 }
 
 int main(int argc, const char **argv)
@@ -83,6 +85,9 @@ int main(int argc, const char **argv)
     int threshold = DEFAULT_THRESHOLD;
     long offset = DEFAULT_FRAME_OFFSET;
     long duration = -1;
+    int print_time = 0;
+    int64_t analysis_time = 0;
+    int64_t start_time;
     const char *input_filename = NULL;
     FILE *input;
     unsigned char *input_buffer;
@@ -177,6 +182,10 @@ int main(int argc, const char **argv)
                 fprintf(stderr, "Failed to parse duration '%s'\n", argv[cmdln_index]);
             }
         }
+        else if (strcmp(argv[cmdln_index], "--time") == 0)
+        {
+            print_time = 1;
+        }
         else
         {
             break;
@@ -242,8 +251,10 @@ int main(int argc, const char **argv)
             DitherFrameV210(input_buffer_8bit, input_buffer, width * 2, (width + 5) / 6 * 16, width, height);
 
         dropout_result result[2];
+        start_time = gettimeofday64();
         result[0] = digibeta_dropout(&frame, x_offset[0], 0 + (y_offset[0] * 2), workspace);
         result[1] = digibeta_dropout(&frame, x_offset[0], 1 + (y_offset[1] * 2), workspace);
+        analysis_time += gettimeofday64() - start_time;
         
         if (result[0].strength >= threshold && result[0].strength > result[1].strength) {
             printf("pos=%s (%ld), strength=%d, field=1, sixth=%d, seq=%d\n",
@@ -257,6 +268,11 @@ int main(int argc, const char **argv)
         position++;
     }
     
+    if (print_time && position > offset) {
+        fprintf(stderr, "Analysed %ld frames in %.3f seconds: %.1f microseconds per frame\n",
+                position - offset, analysis_time / 1000000.0, analysis_time / (double)(position - offset));
+    }
+    
     free(input_buffer);
     if (input_buffer_8bit != input_buffer)
         free(input_buffer_8bit);
@@ -0,0 +1,970 @@
+// $Id$
+
+// Storage benchmark replaying the Ingex recorder access patterns: channels x encodes of OP-Atom video and
+// audio files appended at frame cadence, takes finalised with a footer write and header rewrite, transfer
+// readers copying completed takes and confidence replay readers following the files being written.
+// Reports per-operation latency percentiles and missed frame deadlines.
+// See disk_rw_benchmark for a simple single stream throughput test.
+
+// gcc -Wall -W -g -O3 -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -D_LARGEFILE64_SOURCE disk_workload_benchmark.c -o disk_workload_benchmark -lpthread -lrt
+
+#if ! defined(_LARGEFILE_SOURCE) && ! defined(_FILE_OFFSET_BITS)
+#define _LARGEFILE_SOURCE
+#define _FILE_OFFSET_BITS 64
+#endif
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <signal.h>
+
+
+#define MAX_ENCODES			8
+#define MAX_AUDIO_TRACKS	16
+#define MAX_PATH_SIZE		512
+
+#define HEADER_SIZE			(64 * 1024)		// header partition with metadata, rewritten when a take is complete
+#define FOOTER_SIZE			(16 * 1024)		// footer partition excluding the index table
+#define INDEX_ENTRY_SIZE	11				// VBE index table entry size
+#define TRANSFER_BLOCK_SIZE	(1024 * 1024)
+
+#define HIST_SUB_BITS		4
+#define HIST_SUB_COUNT		(1 << HIST_SUB_BITS)
+#define HIST_BUCKETS		(64 * HIST_SUB_COUNT)
+
+
+// the rates are those returned by MaterialResolution::CheckVideoFormat in studio/common/MaterialResolution.cpp
+// for the SD raster, or the HD raster for the HD only resolutions
+typedef struct {
+	int id;
+	const char *name;
+	uint32_t kbyte_per_minute;
+} Resolution;
+
+static const Resolution RESOLUTIONS[] = {
+	{ 12,	"Uncompressed UYVY MXF OP_ATOM",	1244160},
+	{ 22,	"DV25 MXF OP-ATOM",					187500},
+	{ 32,	"DV50 MXF OP-ATOM",					375000},
+	{ 42,	"DVCPRO-HD MXF OP-ATOM",			750000},
+	{ 50,	"Avid MJPEG 2:1 MXF OP-ATOM",		500000},
+	{ 52,	"Avid MJPEG 3:1 MXF OP-ATOM",		340000},
+	{ 54,	"Avid MJPEG 10:1 MXF OP-ATOM",		140000},
+	{ 56,	"Avid MJPEG 10:1m MXF OP-ATOM",		90000},
+	{ 58,	"Avid MJPEG 15:1s MXF OP-ATOM",		90000},
+	{ 60,	"Avid MJPEG 20:1 MXF OP-ATOM",		90000},
+	{ 70,	"IMX30 MXF OP-ATOM",				375000},
+	{ 72,	"IMX40 MXF OP-ATOM",				375000},
+	{ 74,	"IMX50 MXF OP-ATOM",				375000},
+	{ 100,	"VC3-36/45p MXF OP-ATOM",			270000},
+	{ 102,	"VC3-120/145i MXF OP-ATOM",			1387500},
+	{ 104,	"VC3-185/220i MXF OP-ATOM",			1387500},
+	{ 106,	"VC3-120/145p MXF OP-ATOM",			1387500},
+	{ 108,	"VC3-185/220p MXF OP-ATOM",			1387500},
+};
+
+typedef struct {
+	uint64_t count;
+	uint64_t sum_us;
+	uint64_t max_us;
+	uint64_t buckets[HIST_BUCKETS];
+} LatencyHist;
+
+typedef struct {
+	int index;
+	int channel;
+	int encode;
+	const Resolution *res;
+	uint32_t video_frame_size;
+
+	pthread_t thread;
+
+	// published to the replay readers
+	pthread_mutex_t mutex;
+	int take;
+	int64_t take_frames;
+
+	LatencyHist video_write;
+	LatencyHist audio_write;
+	LatencyHist fsync_hist;
+	LatencyHist finalise;
+	uint64_t frames;
+	uint64_t missed;
+	uint64_t max_late_us;
+	int failed;
+} Writer;
+
+typedef struct {
+	int index;
+	Writer *writer;		// the writer whose video file is followed
+	pthread_t thread;
+	LatencyHist read;
+	uint64_t frames;
+	uint64_t missed;
+	uint64_t underruns;
+	int failed;
+} ReplayReader;
+
+typedef struct {
+	int index;
+	pthread_t thread;
+	LatencyHist read;
+	uint64_t files;
+	int failed;
+} TransferReader;
+
+typedef struct TransferFile {
+	char path[MAX_PATH_SIZE];
+	struct TransferFile *next;
+} TransferFile;
+
+
+// configuration
+static const char		*dir = ".";
+static int				num_channels = 4;
+static const Resolution	*encodes[MAX_ENCODES];
+static int				num_encodes = 0;
+static int				num_audio = 4;
+static int				audio_bits = 16;
+static int				fps_num = 25, fps_den = 1;
+static double			duration_sec = 60.0;
+static double			take_sec = 30.0;
+static int				fsync_frames = 0;
+static int				num_transfer = 1;
+static double			transfer_rate_limit = 0.0;
+static int				num_replay = 1;
+static int				replay_delay_frames = 25;
+static int				drop_cache = 1;
+static int				keep_files = 0;
+
+// state
+static volatile int		stop = 0;
+static struct timespec	start_time;
+static int64_t			period_ns;
+static uint32_t			audio_frame_size;
+static uint8_t			*data_block;		// random data written to the files
+static uint64_t			total_written = 0, total_read = 0, total_missed = 0;
+
+static pthread_mutex_t	transfer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	transfer_cond = PTHREAD_COND_INITIALIZER;
+static TransferFile		*transfer_head = NULL, *transfer_tail = NULL;
+
+
+static int64_t ts_diff_ns(const struct timespec *a, const struct timespec *b)
+{
+	return (int64_t)(b->tv_sec - a->tv_sec) * 1000000000 + b->tv_nsec - a->tv_nsec;
+}
+
+static void ts_add_ns(struct timespec *ts, int64_t ns)
+{
+	ns += ts->tv_nsec;
+	ts->tv_sec += ns / 1000000000;
+	ts->tv_nsec = ns % 1000000000;
+}
+
+static uint64_t now_elapsed_us(const struct timespec *since)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ts_diff_ns(since, &now) / 1000;
+}
+
+// log-linear buckets: exact below 16us, then 16 sub-buckets for each power of 2
+static int hist_bucket(uint64_t us)
+{
+	int msb, shift;
+
+	if (us < HIST_SUB_COUNT)
+		return (int)us;
+
+	msb = 63 - __builtin_clzll(us);
+	shift = msb - HIST_SUB_BITS;
+	return (shift + 1) * HIST_SUB_COUNT + (int)((us >> shift) & (HIST_SUB_COUNT - 1));
+}
+
+// the upper bound of the bucket
+static uint64_t hist_bucket_value(int bucket)
+{
+	int shift;
+
+	if (bucket < HIST_SUB_COUNT)
+		return bucket;
+
+	shift = bucket / HIST_SUB_COUNT - 1;
+	return ((uint64_t)(HIST_SUB_COUNT + bucket % HIST_SUB_COUNT + 1) << shift) - 1;
+}
+
+static void hist_add(LatencyHist *hist, uint64_t us)
+{
+	hist->count++;
+	hist->sum_us += us;
+	if (us > hist->max_us)
+		hist->max_us = us;
+	hist->buckets[hist_bucket(us)]++;
+}
+
+static void hist_merge(LatencyHist *to, const LatencyHist *from)
+{
+	int i;
+
+	to->count += from->count;
+	to->sum_us += from->sum_us;
+	if (from->max_us > to->max_us)
+		to->max_us = from->max_us;
+	for (i = 0; i < HIST_BUCKETS; i++)
+		to->buckets[i] += from->buckets[i];
+}
+
+static uint64_t hist_percentile(const LatencyHist *hist, double percentile)
+{
+	uint64_t target = (uint64_t)(hist->count * percentile / 100.0 + 0.5);
+	uint64_t cumulative = 0;
+	int i;
+
+	if (target < 1)
+		target = 1;
+	for (i = 0; i < HIST_BUCKETS; i++) {
+		cumulative += hist->buckets[i];
+		if (cumulative >= target)
+			return hist_bucket_value(i) < hist->max_us ? hist_bucket_value(i) : hist->max_us;
+	}
+	return hist->max_us;
+}
+
+static void print_hist(const char *name, const LatencyHist *hist)
+{
+	if (hist->count == 0) {
+		printf("  %-16s %10d\n", name, 0);
+		return;
+	}
+
+	printf("  %-16s %10"PRIu64" %10.1f %10"PRIu64" %10"PRIu64" %10"PRIu64" %10"PRIu64" %10"PRIu64"\n",
+		name, hist->count, hist->sum_us / (double)hist->count,
+		hist_percentile(hist, 50.0), hist_percentile(hist, 90.0), hist_percentile(hist, 99.0),
+		hist_percentile(hist, 99.9), hist->max_us);
+}
+
+
+static int timed_write(int fd, const uint8_t *data, size_t size, LatencyHist *hist)
+{
+	struct timespec start;
+	ssize_t result;
+	size_t done = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while (done < size) {
+		result = write(fd, data + done, size - done);
+		if (result < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("write");
+			return 0;
+		}
+		done += result;
+	}
+	hist_add(hist, now_elapsed_us(&start));
+
+	__sync_fetch_and_add(&total_written, size);
+	return 1;
+}
+
+static int timed_fsync(int fd, LatencyHist *hist)
+{
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (fsync(fd) != 0) {
+		perror("fsync");
+		return 0;
+	}
+	hist_add(hist, now_elapsed_us(&start));
+	return 1;
+}
+
+// write size bytes of data, which is a block of TRANSFER_BLOCK_SIZE random bytes
+static int write_data(int fd, size_t size)
+{
+	size_t count;
+	ssize_t result;
+
+	while (size > 0) {
+		count = size > TRANSFER_BLOCK_SIZE ? TRANSFER_BLOCK_SIZE : size;
+		result = write(fd, data_block, count);
+		if (result < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("write");
+			return 0;
+		}
+		size -= result;
+	}
+	return 1;
+}
+
+static void get_file_path(const Writer *writer, int take, int track, char *path)
+{
+	if (track == 0)
+		snprintf(path, MAX_PATH_SIZE, "%s/bench_c%d_e%d_t%d_v1.mxf", dir, writer->channel, writer->encode, take);
+	else
+		snprintf(path, MAX_PATH_SIZE, "%s/bench_c%d_e%d_t%d_a%d.mxf", dir, writer->channel, writer->encode, take, track);
+}
+
+static void queue_transfer_file(const char *path)
+{
+	TransferFile *file;
+
+	if (num_transfer == 0) {
+		if (!keep_files)
+			unlink(path);
+		return;
+	}
+
+	file = calloc(1, sizeof(TransferFile));
+	strncpy(file->path, path, sizeof(file->path) - 1);
+
+	pthread_mutex_lock(&transfer_mutex);
+	if (transfer_tail != NULL)
+		transfer_tail->next = file;
+	else
+		transfer_head = file;
+	transfer_tail = file;
+	pthread_cond_signal(&transfer_cond);
+	pthread_mutex_unlock(&transfer_mutex);
+}
+
+// write the footer partition and index table, and rewrite the header partition as the recorder does
+// when a take is complete
+static int finalise_file(Writer *writer, int fd, int64_t frames, int is_video, const char *path)
+{
+	struct timespec start;
+	size_t footer_size = FOOTER_SIZE;
+
+	if (is_video)
+		footer_size += frames * INDEX_ENTRY_SIZE;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	if (!write_data(fd, footer_size))
+		return 0;
+	if (pwrite(fd, data_block, HEADER_SIZE, 0) != HEADER_SIZE) {
+		perror("pwrite");
+		return 0;
+	}
+	if (fsync(fd) != 0) {
+		perror("fsync");
+		return 0;
+	}
+	if (drop_cache)
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	close(fd);
+
+	hist_add(&writer->finalise, now_elapsed_us(&start));
+	__sync_fetch_and_add(&total_written, footer_size + HEADER_SIZE);
+
+	queue_transfer_file(path);
+	return 1;
+}
+
+
+static int finalise_take(Writer *writer, int *fds, char (*paths)[MAX_PATH_SIZE], int64_t frames)
+{
+	int i;
+
+	for (i = 0; i <= num_audio; i++) {
+		if (!finalise_file(writer, fds[i], frames, i == 0, paths[i]))
+			return 0;
+		fds[i] = -1;
+	}
+	return 1;
+}
+
+static void *writer_thread(void *arg)
+{
+	Writer *writer = (Writer*)arg;
+	int64_t take_length = (int64_t)(take_sec * fps_num / fps_den + 0.5);
+	int fds[1 + MAX_AUDIO_TRACKS];
+	char paths[1 + MAX_AUDIO_TRACKS][MAX_PATH_SIZE];
+	struct timespec deadline = start_time;
+	struct timespec now;
+	int64_t frames_in_take = 0;
+	int64_t late_us;
+	int take = 0;
+	int i;
+
+	for (i = 0; i <= num_audio; i++)
+		fds[i] = -1;
+
+	while (!stop) {
+		// start a new take, with the video file first followed by the audio files
+		if (fds[0] < 0) {
+			for (i = 0; i <= num_audio; i++) {
+				get_file_path(writer, take, i, paths[i]);
+				if ((fds[i] = open(paths[i], O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) {
+					perror("open");
+					goto fail;
+				}
+				if (!write_data(fds[i], HEADER_SIZE))
+					goto fail;
+			}
+			frames_in_take = 0;
+		}
+
+		// wait until the frame has been captured
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+
+		if (!timed_write(fds[0], data_block, writer->video_frame_size, &writer->video_write))
+			goto fail;
+		for (i = 1; i <= num_audio; i++) {
+			if (!timed_write(fds[i], data_block, audio_frame_size, &writer->audio_write))
+				goto fail;
+		}
+		frames_in_take++;
+		writer->frames++;
+
+		if (fsync_frames > 0 && frames_in_take % fsync_frames == 0) {
+			for (i = 0; i <= num_audio; i++) {
+				if (!timed_fsync(fds[i], &writer->fsync_hist))
+					goto fail;
+			}
+		}
+
+		pthread_mutex_lock(&writer->mutex);
+		writer->take = take;
+		writer->take_frames = frames_in_take;
+		pthread_mutex_unlock(&writer->mutex);
+
+		// the deadline is missed if the frame was not written before the next frame was captured
+		ts_add_ns(&deadline, period_ns);
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		late_us = ts_diff_ns(&deadline, &now) / 1000;
+		if (late_us > 0) {
+			writer->missed++;
+			__sync_fetch_and_add(&total_missed, 1);
+			if ((uint64_t)late_us > writer->max_late_us)
+				writer->max_late_us = late_us;
+		}
+
+		if (frames_in_take >= take_length) {
+			if (!finalise_take(writer, fds, paths, frames_in_take))
+				goto fail;
+			take++;
+		}
+	}
+
+	if (fds[0] >= 0 && !finalise_take(writer, fds, paths, frames_in_take))
+		goto fail;
+
+	return NULL;
+
+fail:
+	for (i = 0; i <= num_audio; i++) {
+		if (fds[i] >= 0)
+			close(fds[i]);
+	}
+	writer->failed = 1;
+	return NULL;
+}
+
+// reads the video frames from the file being written at frame cadence, trailing the writer by
+// replay_delay_frames
+static void *replay_thread(void *arg)
+{
+	ReplayReader *reader = (ReplayReader*)arg;
+	Writer *writer = reader->writer;
+	uint8_t *buffer = malloc(writer->video_frame_size);
+	char path[MAX_PATH_SIZE];
+	struct timespec deadline = start_time;
+	struct timespec read_start, now;
+	int64_t take_frames;
+	int64_t frame = 0;
+	int64_t take_read = 0;
+	int take;
+	int current_take = -1;
+	int fd = -1;
+	ssize_t result;
+
+	while (!stop) {
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
+		ts_add_ns(&deadline, period_ns);
+
+		pthread_mutex_lock(&writer->mutex);
+		take = writer->take;
+		take_frames = writer->take_frames;
+		pthread_mutex_unlock(&writer->mutex);
+
+		if (take != current_take) {
+			if (fd >= 0)
+				close(fd);
+			get_file_path(writer, take, 0, path);
+			if ((fd = open(path, O_RDONLY)) < 0) {
+				// the take has been finalised and removed
+				continue;
+			}
+			current_take = take;
+			take_read = 0;
+			frame = take_frames - replay_delay_frames;
+			if (frame < 0)
+				frame = 0;
+		}
+
+		if (frame >= take_frames - replay_delay_frames) {
+			// the writer is behind, or the replay is waiting for the start of the take
+			if (take_read > 0)
+				reader->underruns++;
+			continue;
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &read_start);
+		result = pread(fd, buffer, writer->video_frame_size, HEADER_SIZE + frame * (int64_t)writer->video_frame_size);
+		if (result < 0) {
+			perror("pread");
+			reader->failed = 1;
+			break;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		hist_add(&reader->read, ts_diff_ns(&read_start, &now) / 1000);
+		__sync_fetch_and_add(&total_read, result);
+
+		reader->frames++;
+		take_read++;
+		frame++;
+		if (ts_diff_ns(&deadline, &now) > 0)
+			reader->missed++;
+	}
+
+	if (fd >= 0)
+		close(fd);
+	free(buffer);
+	return NULL;
+}
+
+// reads completed files in large blocks as when they are copied to the server
+static void *transfer_thread(void *arg)
+{
+	TransferReader *reader = (TransferReader*)arg;
+	uint8_t *buffer = malloc(TRANSFER_BLOCK_SIZE);
+	TransferFile *file;
+	struct timespec wait_until;
+	struct timespec read_start, now;
+	uint64_t file_read;
+	int64_t sleep_ns;
+	ssize_t result;
+	int fd;
+
+	while (1) {
+		pthread_mutex_lock(&transfer_mutex);
+		while (!stop && transfer_head == NULL) {
+			clock_gettime(CLOCK_REALTIME, &wait_until);
+			ts_add_ns(&wait_until, 100000000);
+			pthread_cond_timedwait(&transfer_cond, &transfer_mutex, &wait_until);
+		}
+		file = transfer_head;
+		if (file != NULL && !stop) {
+			transfer_head = file->next;
+			if (transfer_head == NULL)
+				transfer_tail = NULL;
+		} else {
+			file = NULL;
+		}
+		pthread_mutex_unlock(&transfer_mutex);
+		if (file == NULL)
+			break;
+
+		if ((fd = open(file->path, O_RDONLY)) < 0) {
+			perror("open");
+			reader->failed = 1;
+			free(file);
+			break;
+		}
+
+		file_read = 0;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		while (!stop) {
+			clock_gettime(CLOCK_MONOTONIC, &read_start);
+			if ((result = read(fd, buffer, TRANSFER_BLOCK_SIZE)) <= 0) {
+				if (result < 0) {
+					perror("read");
+					reader->failed = 1;
+				}
+				break;
+			}
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			hist_add(&reader->read, ts_diff_ns(&read_start, &now) / 1000);
+			__sync_fetch_and_add(&total_read, result);
+			file_read += result;
+
+			if (transfer_rate_limit > 0) {		// throttle read rate
+				sleep_ns = (int64_t)(result / transfer_rate_limit * 1000.0) - ts_diff_ns(&read_start, &now);
+				if (sleep_ns > 0) {
+					ts_add_ns(&now, sleep_ns);
+					clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &now, NULL);
+				}
+			}
+		}
+		close(fd);
+		reader->files++;
+
+		if (!keep_files)
+			unlink(file->path);
+		free(file);
+
+		if (reader->failed)
+			break;
+	}
+
+	free(buffer);
+	return NULL;
+}
+
+
+static void handle_terminate_signals(int sig)
+{
+	stop = 1;
+}
+
+static const Resolution *find_resolution(int id)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(RESOLUTIONS) / sizeof(RESOLUTIONS[0]); i++) {
+		if (RESOLUTIONS[i].id == id)
+			return &RESOLUTIONS[i];
+	}
+	return NULL;
+}
+
+static void usage_exit(void)
+{
+	size_t i;
+
+	fprintf(stderr, "disk_workload_benchmark [options] <directory>\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "    -c <num>               number of channels (default %d)\n", num_channels);
+	fprintf(stderr, "    -r <res>[,<res>]*      MaterialResolution for each encode of a channel (default 102)\n");
+	fprintf(stderr, "    -a <num>               audio tracks per encode (default %d)\n", num_audio);
+	fprintf(stderr, "    -b <bits>              audio bits per sample (default %d)\n", audio_bits);
+	fprintf(stderr, "    -f <num>[/<den>]       frame rate (default %d/%d)\n", fps_num, fps_den);
+	fprintf(stderr, "    -t <sec>               test duration (default %.0f)\n", duration_sec);
+	fprintf(stderr, "    -k <sec>               take duration; the files are finalised at the end of each take (default %.0f, 0 for a single take)\n", take_sec);
+	fprintf(stderr, "    -s <frames>            fsync every <frames> frames (default 0, only when finalising)\n");
+	fprintf(stderr, "    -x <num>               transfer readers copying the completed files (default %d)\n", num_transfer);
+	fprintf(stderr, "    -l <MByte/s_rate>      limit the rate of each transfer reader\n");
+	fprintf(stderr, "    -p <num>               confidence replay readers following the video files (default %d)\n", num_replay);
+	fprintf(stderr, "    -d <frames>            replay delay behind the writer (default %d)\n", replay_delay_frames);
+	fprintf(stderr, "    --keep-cache           don't drop the finalised files from the page cache\n");
+	fprintf(stderr, "    --keep                 don't delete the files\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "The exit code is 2 if any frame write deadlines were missed\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "Resolutions:\n");
+	for (i = 0; i < sizeof(RESOLUTIONS) / sizeof(RESOLUTIONS[0]); i++)
+		fprintf(stderr, "    %4d  %-32s %8.1f Mbit/s\n", RESOLUTIONS[i].id, RESOLUTIONS[i].name,
+			RESOLUTIONS[i].kbyte_per_minute * 8.0 / 60.0 / 1000.0);
+	exit(1);
+}
+
+static int parse_int_arg(int argc, char *argv[], int *i, int min_value)
+{
+	char *end;
+	long value;
+
+	if (*i >= argc - 1)
+		usage_exit();
+	(*i)++;
+	value = strtol(argv[*i], &end, 10);
+	if (*end != '\0' || value < min_value)
+		usage_exit();
+	return (int)value;
+}
+
+static double parse_double_arg(int argc, char *argv[], int *i)
+{
+	char *end;
+	double value;
+
+	if (*i >= argc - 1)
+		usage_exit();
+	(*i)++;
+	value = strtod(argv[*i], &end);
+	if (*end != '\0' || value < 0.0)
+		usage_exit();
+	return value;
+}
+
+int main(int argc, char *argv[])
+{
+	Writer			*writers;
+	ReplayReader	*replay_readers;
+	TransferReader	*transfer_readers;
+	int				num_writers;
+	LatencyHist		*video_write, *audio_write, *fsync_hist, *finalise, *replay_read, *transfer_read;
+	uint64_t		frames = 0, missed = 0, max_late_us = 0;
+	uint64_t		replay_frames = 0, replay_missed = 0, replay_underruns = 0;
+	uint64_t		transfer_files = 0;
+	uint64_t		last_written = 0, last_read = 0;
+	struct timespec	end_time, report_time, stop_time;
+	double			elapsed_sec;
+	int				failed = 0;
+	char			*res_arg, *token;
+	const Resolution *res;
+	TransferFile	*file;
+	size_t			n;
+	int				i, c, e;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-h") == 0) {
+			usage_exit();
+		}
+		else if (strcmp(argv[i], "-c") == 0) {
+			num_channels = parse_int_arg(argc, argv, &i, 1);
+		}
+		else if (strcmp(argv[i], "-r") == 0) {
+			if (i >= argc - 1)
+				usage_exit();
+			i++;
+			res_arg = argv[i];
+			while ((token = strtok(res_arg, ",")) != NULL) {
+				res_arg = NULL;
+				if (num_encodes >= MAX_ENCODES || (res = find_resolution(atoi(token))) == NULL)
+					usage_exit();
+				encodes[num_encodes++] = res;
+			}
+		}
+		else if (strcmp(argv[i], "-a") == 0) {
+			num_audio = parse_int_arg(argc, argv, &i, 0);
+			if (num_audio > MAX_AUDIO_TRACKS)
+				usage_exit();
+		}
+		else if (strcmp(argv[i], "-b") == 0) {
+			audio_bits = parse_int_arg(argc, argv, &i, 8);
+		}
+		else if (strcmp(argv[i], "-f") == 0) {
+			if (i >= argc - 1)
+				usage_exit();
+			i++;
+			fps_den = 1;
+			if (sscanf(argv[i], "%d/%d", &fps_num, &fps_den) < 1 || fps_num < 1 || fps_den < 1)
+				usage_exit();
+		}
+		else if (strcmp(argv[i], "-t") == 0) {
+			duration_sec = parse_double_arg(argc, argv, &i);
+		}
+		else if (strcmp(argv[i], "-k") == 0) {
+			take_sec = parse_double_arg(argc, argv, &i);
+		}
+		else if (strcmp(argv[i], "-s") == 0) {
+			fsync_frames = parse_int_arg(argc, argv, &i, 0);
+		}
+		else if (strcmp(argv[i], "-x") == 0) {
+			num_transfer = parse_int_arg(argc, argv, &i, 0);
+		}
+		else if (strcmp(argv[i], "-l") == 0) {
+			transfer_rate_limit = parse_double_arg(argc, argv, &i);
+		}
+		else if (strcmp(argv[i], "-p") == 0) {
+			num_replay = parse_int_arg(argc, argv, &i, 0);
+		}
+		else if (strcmp(argv[i], "-d") == 0) {
+			replay_delay_frames = parse_int_arg(argc, argv, &i, 0);
+		}
+		else if (strcmp(argv[i], "--keep-cache") == 0) {
+			drop_cache = 0;
+		}
+		else if (strcmp(argv[i], "--keep") == 0) {
+			keep_files = 1;
+		}
+		else if (i == argc - 1) {
+			dir = argv[i];
+		}
+		else {
+			usage_exit();
+		}
+	}
+	if (num_encodes == 0)
+		encodes[num_encodes++] = find_resolution(102);
+	if (take_sec <= 0.0)
+		take_sec = duration_sec;
+
+	period_ns = (int64_t)1000000000 * fps_den / fps_num;
+	audio_frame_size = (uint32_t)((48000LL * fps_den / fps_num) * ((audio_bits + 7) / 8));
+
+	// install signal handlers
+	if (signal(SIGINT, handle_terminate_signals) == SIG_ERR ||
+		signal(SIGTERM, handle_terminate_signals) == SIG_ERR) {
+		perror("installing signals with signal(SIGINT) or signal(SIGTERM)");
+		return 1;
+	}
+
+	// setup random block of data using values from 0 to 255
+	data_block = malloc(TRANSFER_BLOCK_SIZE > HEADER_SIZE ? TRANSFER_BLOCK_SIZE : HEADER_SIZE);
+	srandom(0);
+	for (n = 0; n < TRANSFER_BLOCK_SIZE; n++) {
+		data_block[n] = (int) (256.0 * (random() / (RAND_MAX + 1.0)));
+	}
+
+	num_writers = num_channels * num_encodes;
+	writers = calloc(num_writers, sizeof(Writer));
+	replay_readers = calloc(num_replay > 0 ? num_replay : 1, sizeof(ReplayReader));
+	transfer_readers = calloc(num_transfer > 0 ? num_transfer : 1, sizeof(TransferReader));
+	video_write = calloc(1, sizeof(LatencyHist));
+	audio_write = calloc(1, sizeof(LatencyHist));
+	fsync_hist = calloc(1, sizeof(LatencyHist));
+	finalise = calloc(1, sizeof(LatencyHist));
+	replay_read = calloc(1, sizeof(LatencyHist));
+	transfer_read = calloc(1, sizeof(LatencyHist));
+
+	printf("%d channels x %d encodes, %d audio tracks, %d/%d fps, take %.1f sec, test %.1f sec\n",
+		num_channels, num_encodes, num_audio, fps_num, fps_den, take_sec, duration_sec);
+	for (e = 0; e < num_encodes; e++) {
+		printf("encode %d: %s, %u bytes per frame\n", e, encodes[e]->name,
+			(uint32_t)(encodes[e]->kbyte_per_minute * 1000LL * fps_den / (60LL * fps_num)));
+	}
+	printf("\n");
+
+	// start the threads a short while from now so that they all start at the same frame time
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	ts_add_ns(&start_time, 100000000);
+
+	for (c = 0; c < num_channels; c++) {
+		for (e = 0; e < num_encodes; e++) {
+			Writer *writer = &writers[c * num_encodes + e];
+			writer->index = c * num_encodes + e;
+			writer->channel = c;
+			writer->encode = e;
+			writer->res = encodes[e];
+			writer->video_frame_size = (uint32_t)(encodes[e]->kbyte_per_minute * 1000LL * fps_den / (60LL * fps_num));
+			writer->take = -1;
+			pthread_mutex_init(&writer->mutex, NULL);
+			if (pthread_create(&writer->thread, NULL, writer_thread, writer) != 0) {
+				perror("pthread_create");
+				return 1;
+			}
+		}
+	}
+	for (i = 0; i < num_replay; i++) {
+		replay_readers[i].index = i;
+		replay_readers[i].writer = &writers[i % num_writers];
+		if (pthread_create(&replay_readers[i].thread, NULL, replay_thread, &replay_readers[i]) != 0) {
+			perror("pthread_create");
+			return 1;
+		}
+	}
+	for (i = 0; i < num_transfer; i++) {
+		transfer_readers[i].index = i;
+		if (pthread_create(&transfer_readers[i].thread, NULL, transfer_thread, &transfer_readers[i]) != 0) {
+			perror("pthread_create");
+			return 1;
+		}
+	}
+
+	// report progress every second, with the last report when the test duration has elapsed
+	report_time = start_time;
+	stop_time = start_time;
+	ts_add_ns(&stop_time, (int64_t)(duration_sec * 1000000000.0));
+	while (!stop) {
+		uint64_t written, read;
+
+		ts_add_ns(&report_time, 1000000000);
+		if (ts_diff_ns(&stop_time, &report_time) > 0)
+			report_time = stop_time;
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &report_time, NULL);
+
+		clock_gettime(CLOCK_MONOTONIC, &end_time);
+		elapsed_sec = ts_diff_ns(&start_time, &end_time) / 1000000000.0;
+
+		written = __sync_fetch_and_add(&total_written, 0);
+		read = __sync_fetch_and_add(&total_read, 0);
+		printf("%7.1f sec: write %10.3f, read %10.3f MByte/s, missed deadlines %"PRIu64"\n", elapsed_sec,
+			(written - last_written) / 1000000.0, (read - last_read) / 1000000.0,
+			__sync_fetch_and_add(&total_missed, 0));
+		last_written = written;
+		last_read = read;
+
+		if (ts_diff_ns(&stop_time, &end_time) >= 0)
+			stop = 1;
+	}
+
+	for (i = 0; i < num_writers; i++)
+		pthread_join(writers[i].thread, NULL);
+	for (i = 0; i < num_replay; i++)
+		pthread_join(replay_readers[i].thread, NULL);
+	pthread_mutex_lock(&transfer_mutex);
+	pthread_cond_broadcast(&transfer_cond);
+	pthread_mutex_unlock(&transfer_mutex);
+	for (i = 0; i < num_transfer; i++)
+		pthread_join(transfer_readers[i].thread, NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &end_time);
+	elapsed_sec = ts_diff_ns(&start_time, &end_time) / 1000000000.0;
+
+	// files that were not transferred
+	while (transfer_head != NULL) {
+		file = transfer_head;
+		transfer_head = file->next;
+		if (!keep_files)
+			unlink(file->path);
+		free(file);
+	}
+
+
+	for (i = 0; i < num_writers; i++) {
+		hist_merge(video_write, &writers[i].video_write);
+		hist_merge(audio_write, &writers[i].audio_write);
+		hist_merge(fsync_hist, &writers[i].fsync_hist);
+		hist_merge(finalise, &writers[i].finalise);
+		frames += writers[i].frames;
+		missed += writers[i].missed;
+		if (writers[i].max_late_us > max_late_us)
+			max_late_us = writers[i].max_late_us;
+		failed |= writers[i].failed;
+	}
+	for (i = 0; i < num_replay; i++) {
+		hist_merge(replay_read, &replay_readers[i].read);
+		replay_frames += replay_readers[i].frames;
+		replay_missed += replay_readers[i].missed;
+		replay_underruns += replay_readers[i].underruns;
+		failed |= replay_readers[i].failed;
+	}
+	for (i = 0; i < num_transfer; i++) {
+		hist_merge(transfer_read, &transfer_readers[i].read);
+		transfer_files += transfer_readers[i].files;
+		failed |= transfer_readers[i].failed;
+	}
+
+	printf("\n");
+	printf("total time = %f sec, written = %"PRIu64" bytes (%.3f MByte/s), read = %"PRIu64" bytes (%.3f MByte/s)\n",
+		elapsed_sec, total_written, total_written / elapsed_sec / 1000000.0,
+		total_read, total_read / elapsed_sec / 1000000.0);
+	printf("\n");
+	printf("latency (usec)\n");
+	printf("  %-16s %10s %10s %10s %10s %10s %10s %10s\n", "", "count", "mean", "50%", "90%", "99%", "99.9%", "max");
+	print_hist("video write", video_write);
+	print_hist("audio write", audio_write);
+	print_hist("fsync", fsync_hist);
+	print_hist("finalise", finalise);
+	print_hist("replay read", replay_read);
+	print_hist("transfer read", transfer_read);
+	printf("\n");
+	printf("writer frames = %"PRIu64", missed deadlines = %"PRIu64", max late = %"PRIu64" usec\n",
+		frames, missed, max_late_us);
+	printf("replay frames = %"PRIu64", missed deadlines = %"PRIu64", underruns = %"PRIu64"\n",
+		replay_frames, replay_missed, replay_underruns);
+	printf("transferred files = %"PRIu64"\n", transfer_files);
+
+	if (failed) {
+		fprintf(stderr, "Benchmark failed\n");
+		return 1;
+	}
+	return missed > 0 ? 2 : 0;
+}
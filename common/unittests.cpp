@@ -1,12 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "video_test_signals.h"
 #include "video_conversion_10bits.h"
 #include "video_conversion.h"
 #include "video_burn_in_timecode.h"
 #include "psnr.h"
+#include "digibeta_dropout.h"
+#include "multicast_video.h"
 
 static void usage_exit(void)
 {
@@ -51,6 +54,249 @@ static void write_sample(const char *output_name, size_t frame_size, const uint8
 	fclose(fp_output);
 }
 
+// Overwrite the luma of 8x8 blocks with a checkerboard to simulate DigiBeta dropouts
+static void add_dropout_blocks(int width, int height, int num_blocks, unsigned int seed, uint8_t *frame)
+{
+	int i, x, y;
+	for (i = 0; i < num_blocks; i++) {
+		seed = seed * 1103515245 + 12345;
+		int bx = (seed >> 8) % (width / 8);
+		seed = seed * 1103515245 + 12345;
+		int by = (seed >> 8) % (height / 8);
+		for (y = 0; y < 8; y++)
+			for (x = 0; x < 8; x++)
+				frame[(by * 8 + y) * width * 2 + (bx * 8 + x) * 2 + 1] = ((x + y) % 2) ? 16 : 235;
+	}
+}
+
+// Regression corpus for the dropout detector. The expected results were
+// produced by the original scalar implementation.
+static int test_digibeta_dropout(int width, int height, const uint8_t *sport_frame)
+{
+	static const struct {
+		int input;		// 0: sport, 1: colour bars, 2..4: colour bars with dropouts
+		int x_offset, y_offset;
+		dropout_result expected;
+	} corpus[] = {
+		{0,  0,  0, { -54, 0, 51}},
+		{0,  0,  1, { -69, 1, 36}},
+		{0, -3, -3, { -27, 0, 25}},
+		{0,  5,  2, { -24, 5, 31}},
+		{1,  0,  0, {   0, 0,  0}},
+		{1,  0,  1, {   0, 0,  0}},
+		{1, -3, -3, {   0, 0,  0}},
+		{1,  5,  2, {   0, 0,  0}},
+		{2,  0,  0, { 511, 0, 16}},
+		{2,  0,  1, { 511, 0, 16}},
+		{2, -3, -3, {   0, 0,  0}},
+		{2,  5,  2, {   0, 0,  0}},
+		{3,  0,  0, { 511, 1, 28}},
+		{3,  0,  1, { 519, 0, 52}},
+		{3, -3, -3, {   0, 0,  0}},
+		{3,  5,  2, {   0, 0,  0}},
+		{4,  0,  0, { 511, 0, 15}},
+		{4,  0,  1, { 519, 5, 54}},
+		{4, -3, -3, {   0, 0,  0}},
+		{4,  5,  2, {   0, 0,  0}},
+	};
+	int result = 0;
+	size_t i;
+
+	uint8_t *frame = (uint8_t*)malloc(width * height * 2);
+	int *workspace = (int*)malloc(sizeof(int) * width * height);
+
+	for (i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++) {
+		if (corpus[i].input == 0) {
+			memcpy(frame, sport_frame, width * height * 2);
+		} else {
+			uyvy_color_bars(width, height, 1, frame);
+			if (corpus[i].input > 1)
+				add_dropout_blocks(width, height, (corpus[i].input - 1) * 3, corpus[i].input, frame);
+		}
+
+		YUV_frame yuv_frame;
+		yuv_frame.Y.w = width;
+		yuv_frame.Y.h = height;
+		yuv_frame.Y.lineStride = width * 2;
+		yuv_frame.Y.pixelStride = 2;
+		yuv_frame.Y.buff = frame + 1;
+
+		dropout_result dropout = digibeta_dropout(&yuv_frame, corpus[i].x_offset, corpus[i].y_offset, workspace);
+		if (dropout.strength != corpus[i].expected.strength ||
+			dropout.sixth != corpus[i].expected.sixth ||
+			dropout.seq != corpus[i].expected.seq)
+		{
+			printf("digibeta dropout %d (%d,%d) mismatch: strength=%d sixth=%d seq=%d, expected %d %d %d\n",
+				corpus[i].input, corpus[i].x_offset, corpus[i].y_offset,
+				dropout.strength, dropout.sixth, dropout.seq,
+				corpus[i].expected.strength, corpus[i].expected.sixth, corpus[i].expected.seq);
+			result = 1;
+		}
+	}
+
+	free(frame);
+	free(workspace);
+
+	return result;
+}
+
+static int test_burn_in(int width, int height)
+{
+	// the UYVY and planar 4:2:2 burn-ins use the same strips and so must give the same result,
+	// including when the timecode is clipped at the bottom right of the picture. The picture is grey
+	// so that the black digits change it wherever they are
+	const int guard_size = 64;
+	size_t frame_size = width * height * 2;
+	uint8_t *frame = (uint8_t*)malloc(frame_size + guard_size);
+	uint8_t *frame422 = (uint8_t*)malloc(frame_size + guard_size);
+	uint8_t *burnt422 = (uint8_t*)malloc(frame_size);
+	int result = 0;
+	int i;
+
+	Ingex::Timecode timecode(10, 59, 59, 24, 0, 25, 1, false);
+	int offsets[2][2] = {{90, 90}, {width - 150, height - 20}};
+
+	for (i = 0; i < 2; i++) {
+		memset(frame, 0x80, frame_size);
+		uyvy_to_yuv422_nommx(width, height, 0, frame, frame422);
+		memset(frame + frame_size, 0xaa, guard_size);
+		memset(frame422 + frame_size, 0xaa, guard_size);
+
+		burn_mask_uyvy(timecode, offsets[i][0], offsets[i][1], width, height, frame);
+		burn_mask_yuv422(timecode, offsets[i][0], offsets[i][1], width, height, frame422);
+
+		uyvy_to_yuv422_nommx(width, height, 0, frame, burnt422);
+		if (memcmp(burnt422, frame422, frame_size) != 0) {
+			printf("burn-in %dx%d at (%d,%d): uyvy and yuv422 mismatch\n",
+				width, height, offsets[i][0], offsets[i][1]);
+			result = 1;
+		}
+		memset(burnt422, 0x80, frame_size);
+		if (memcmp(burnt422, frame, frame_size) == 0) {
+			printf("burn-in %dx%d at (%d,%d): frame unchanged\n", width, height, offsets[i][0], offsets[i][1]);
+			result = 1;
+		}
+		if (frame[frame_size] != 0xaa || frame[frame_size + guard_size - 1] != 0xaa ||
+			frame422[frame_size] != 0xaa || frame422[frame_size + guard_size - 1] != 0xaa)
+		{
+			printf("burn-in %dx%d at (%d,%d): wrote beyond frame\n", width, height, offsets[i][0], offsets[i][1]);
+			result = 1;
+		}
+	}
+
+	free(frame);
+	free(frame422);
+	free(burnt422);
+
+	return result;
+}
+
+#define BURN_IN_THREAD_FRAMES	50
+
+typedef struct
+{
+	int frames_offset;
+	const uint8_t *expected;
+	int result;
+} BurnInThreadArg;
+
+static void burn_in_thread_frame(int frame_num, uint8_t *frame)
+{
+	Ingex::Timecode timecode(frame_num, 25, 1, false);
+
+	memset(frame, 0x80, 720 * 576 * 2);
+	burn_mask_uyvy(timecode, 90, 90, 720, 576, frame);
+}
+
+static void *burn_in_thread(void *data)
+{
+	BurnInThreadArg *arg = (BurnInThreadArg*)data;
+	size_t frame_size = 720 * 576 * 2;
+	uint8_t *frame = (uint8_t*)malloc(frame_size);
+	int i;
+
+	arg->result = 0;
+	for (i = 0; i < BURN_IN_THREAD_FRAMES; i++) {
+		burn_in_thread_frame(arg->frames_offset + i, frame);
+		if (memcmp(frame, &arg->expected[(arg->frames_offset + i) * frame_size], frame_size) != 0)
+			arg->result = 1;
+	}
+
+	free(frame);
+	return 0;
+}
+
+static int test_burn_in_threads(void)
+{
+	// threads burning different timecodes at the same time must give the same result as one thread
+	const int num_threads = 4;
+	size_t frame_size = 720 * 576 * 2;
+	uint8_t *expected = (uint8_t*)malloc(frame_size * BURN_IN_THREAD_FRAMES * num_threads);
+	pthread_t threads[num_threads];
+	BurnInThreadArg args[num_threads];
+	int result = 0;
+	int i;
+
+	for (i = 0; i < BURN_IN_THREAD_FRAMES * num_threads; i++)
+		burn_in_thread_frame(i, &expected[i * frame_size]);
+
+	for (i = 0; i < num_threads; i++) {
+		args[i].frames_offset = i * BURN_IN_THREAD_FRAMES;
+		args[i].expected = expected;
+		pthread_create(&threads[i], NULL, burn_in_thread, &args[i]);
+	}
+	for (i = 0; i < num_threads; i++) {
+		pthread_join(threads[i], NULL);
+		if (args[i].result != 0) {
+			printf("burn-in thread %d: mismatch\n", i);
+			result = 1;
+		}
+	}
+
+	free(expected);
+
+	return result;
+}
+
+static int test_udp_slice_header(void)
+{
+	// compressed video packets with malformed slice headers must be dropped, including those whose
+	// fields would wrap if added together
+	const int video_size = 720 * 576 * 3 / 2;
+	const int max_chunk_size = PACKET_SIZE - (4 + sizeof(IngexSliceHeader));
+	struct {
+		IngexSliceHeader header;
+		int expected;
+	} corpus[] = {
+		{{0, 4, 144, 0, 0, 20000, 0}, max_chunk_size},
+		{{3, 4, 144, 0, 60000, 2000, 1500}, 500},
+		{{0, 1, 576, 0, 0, video_size, video_size - 1}, 1},
+		{{0, 4, 144, 0, 0, 2000, 0xFFFFFF00}, -1},
+		{{0, 4, 144, 0, 0xFFFFFF00, 2000, 0}, -1},
+		{{0, 4, 144, 0, 1000, 0xFFFFFF00, 0}, -1},
+		{{0, 4, 144, 0, video_size - 100, 200, 0}, -1},
+		{{0, 4, 144, 0, 0, 2000, 2000}, -1},
+		{{0, 4, 144, 0, 0, 0, 0}, -1},
+		{{4, 4, 144, 0, 0, 2000, 0}, -1},
+		{{0, UDP_MAX_SLICES + 1, 144, 0, 0, 2000, 0}, -1},
+		{{0, 4, 0, 0, 0, 2000, 0}, -1},
+	};
+	int result = 0;
+	size_t i;
+
+	for (i = 0; i < sizeof(corpus) / sizeof(corpus[0]); i++) {
+		int chunk_size = udp_get_slice_chunk_size(&corpus[i].header, video_size);
+		if (chunk_size != corpus[i].expected) {
+			printf("udp slice header %d: slice_start=%u slice_size=%u chunk_offset=%u gave chunk size %d, expected %d\n",
+				(int)i, corpus[i].header.slice_start, corpus[i].header.slice_size, corpus[i].header.chunk_offset,
+				chunk_size, corpus[i].expected);
+			result = 1;
+		}
+	}
+
+	return result;
+}
+
 int main(int argc, char *argv[])
 {
 	int width = 720;
@@ -110,6 +356,18 @@ int main(int argc, char *argv[])
 
 	write_sample(output_name, frame_size, frame);
 
+	// Test digibeta dropout detection
+	if (test_digibeta_dropout(width, height, frame) != 0)
+		result = 1;
+
+	// Test timecode burn-in in SD and HD
+	if (test_burn_in(width, height) != 0 || test_burn_in(1920, 1080) != 0 || test_burn_in_threads() != 0)
+		result = 1;
+
+	// Test that malformed compressed multicast packets are dropped
+	if (test_udp_slice_header() != 0)
+		result = 1;
+
 	ConvertFrame8toV210(frame10bit2, frame, width*2*4/3, width*2, width, height);
 	ConvertFrameV210to8(frame2, frame10bit2, width*2, width*2*4/3, width, height);
 
@@ -0,0 +1,881 @@
+/*
+ * $Id$
+ *
+ * Glyph atlas based timecode burn-in for UYVY and planar YUV frames
+ *
+ * Copyright (C) 2012 British Broadcasting Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "video_burn_in_atlas.h"
+
+static const unsigned char tc_colon[] = {
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x05,0xA6,0xFC,0xFC,0xA3,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x05,0xA6,0xFC,0xFC,0xA3,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+};
+
+static const unsigned char tc_semicolon[] = {
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x05,0xA6,0xFC,0xFC,0xA3,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x05,0xA6,0xFC,0xFC,0xA3,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x00,0x06,0xA8,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x00,0x06,0xA8,0xFF,0xA5,0x00,0x00,
+0x00,0x00,0x05,0xA6,0xFC,0xFC,0x80,0x00,0x00,
+};
+
+static const unsigned char tc_digit[10][18*24] = {
+{
+0x00,0x00,0x00,0x00,0x00,0x2E,0x99,0xDB,0xF9,0xF9,0xDA,0x99,0x2E,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x81,0xFD,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFC,0x7F,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x80,0xFF,0xFF,0xFF,0xBB,0x7E,0x7F,0xBD,0xFF,0xFF,0xFF,0x7C,0x00,0x00,0x00,
+0x00,0x00,0x35,0xFD,0xFF,0xFA,0x50,0x00,0x00,0x00,0x00,0x53,0xFB,0xFF,0xFD,0x31,0x00,0x00,
+0x00,0x00,0xB6,0xFF,0xFF,0x79,0x00,0x00,0x00,0x00,0x00,0x00,0x7E,0xFF,0xFF,0xB2,0x00,0x00,
+0x00,0x1B,0xFD,0xFF,0xEF,0x0A,0x00,0x00,0x00,0x00,0x00,0x00,0x0C,0xF1,0xFF,0xFD,0x19,0x00,
+0x00,0x64,0xFF,0xFF,0xA3,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xA6,0xFF,0xFF,0x62,0x00,
+0x00,0x9E,0xFF,0xFF,0x67,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x69,0xFF,0xFF,0x9B,0x00,
+0x00,0xC7,0xFF,0xFF,0x3D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3F,0xFF,0xFF,0xC5,0x00,
+0x00,0xE4,0xFF,0xFF,0x21,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x23,0xFF,0xFF,0xE2,0x00,
+0x00,0xF5,0xFF,0xFF,0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x12,0xFF,0xFF,0xF4,0x00,
+0x00,0xFD,0xFF,0xFF,0x09,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0B,0xFF,0xFF,0xFC,0x00,
+0x00,0xFD,0xFF,0xFF,0x09,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0A,0xFF,0xFF,0xFC,0x00,
+0x00,0xF5,0xFF,0xFF,0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x11,0xFF,0xFF,0xF4,0x00,
+0x00,0xE4,0xFF,0xFF,0x21,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x22,0xFF,0xFF,0xE2,0x00,
+0x00,0xC8,0xFF,0xFF,0x3D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3E,0xFF,0xFF,0xC5,0x00,
+0x00,0x9E,0xFF,0xFF,0x66,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x68,0xFF,0xFF,0x9C,0x00,
+0x00,0x65,0xFF,0xFF,0xA2,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xA5,0xFF,0xFF,0x63,0x00,
+0x00,0x1C,0xFE,0xFF,0xEE,0x09,0x00,0x00,0x00,0x00,0x00,0x00,0x0B,0xF1,0xFF,0xFD,0x19,0x00,
+0x00,0x00,0xB7,0xFF,0xFF,0x77,0x00,0x00,0x00,0x00,0x00,0x00,0x7C,0xFF,0xFF,0xB3,0x00,0x00,
+0x00,0x00,0x35,0xFE,0xFF,0xF9,0x4E,0x00,0x00,0x00,0x00,0x51,0xFA,0xFF,0xFD,0x32,0x00,0x00,
+0x00,0x00,0x00,0x81,0xFF,0xFF,0xFF,0xB9,0x7D,0x7E,0xBB,0xFF,0xFF,0xFF,0x7C,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x83,0xFD,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFD,0x80,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x2F,0x9C,0xDC,0xF9,0xF9,0xDC,0x9B,0x2F,0x00,0x00,0x00,0x00,0x00,
+},
+{
+0x00,0x00,0x00,0x0E,0x43,0x7B,0xB2,0xE9,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x88,0xFE,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x9C,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x9C,0xEF,0xBB,0x86,0x50,0x1B,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x11,0x01,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x03,0x74,0x74,0x74,0x74,0x74,0xFF,0xFF,0xFF,0x78,0x74,0x74,0x74,0x74,0x2F,0x00,
+0x00,0x00,0x08,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x68,0x00,
+0x00,0x00,0x08,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x68,0x00,
+},
+{
+0x00,0x00,0x01,0x37,0x7D,0xB5,0xE1,0xF7,0xF7,0xE4,0xB5,0x6F,0x0F,0x00,0x00,0x00,0x00,0x00,
+0x00,0x64,0xE2,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xF0,0x5C,0x00,0x00,0x00,0x00,
+0x00,0xA8,0xFF,0xFF,0xFF,0xD5,0x9D,0x7D,0x7B,0x9D,0xE9,0xFF,0xFF,0xFF,0x75,0x00,0x00,0x00,
+0x00,0xA8,0xF0,0x89,0x25,0x00,0x00,0x00,0x00,0x00,0x08,0x96,0xFF,0xFF,0xFC,0x30,0x00,0x00,
+0x00,0x48,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xB0,0xFF,0xFF,0xA0,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x39,0xFF,0xFF,0xE1,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0F,0xFF,0xFF,0xFB,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1C,0xFF,0xFF,0xF4,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x63,0xFF,0xFF,0xCB,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x06,0xD9,0xFF,0xFF,0x79,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x8B,0xFF,0xFF,0xEE,0x11,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x57,0xFF,0xFF,0xFF,0x60,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3F,0xF7,0xFF,0xFF,0xA5,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x37,0xF2,0xFF,0xFF,0xBC,0x07,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x32,0xEF,0xFF,0xFF,0xC7,0x0B,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x30,0xED,0xFF,0xFF,0xD0,0x10,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x2E,0xEC,0xFF,0xFF,0xD7,0x15,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x2C,0xEB,0xFF,0xFF,0xDD,0x1A,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x2B,0xEA,0xFF,0xFF,0xE2,0x20,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x28,0xE8,0xFF,0xFF,0xE7,0x25,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x25,0xE6,0xFF,0xFF,0xEB,0x2A,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0xC6,0xFF,0xFF,0xFF,0xA3,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x00,0x00,
+0x00,0xD0,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+0x00,0xD0,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
+},
+{
+0x00,0x00,0x24,0x63,0x96,0xC2,0xE3,0xF6,0xFB,0xED,0xCC,0x92,0x34,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0xF8,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xA8,0x10,0x00,0x00,0x00,
+0x00,0x00,0xF8,0xFF,0xEE,0xB9,0x91,0x7D,0x7A,0x93,0xD3,0xFF,0xFF,0xFF,0xCC,0x08,0x00,0x00,
+0x00,0x00,0x7A,0x30,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x54,0xF6,0xFF,0xFF,0x7A,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x6E,0xFF,0xFF,0xD6,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x17,0xFF,0xFF,0xFD,0x02,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0xFF,0xFF,0xFC,0x01,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x31,0xFF,0xFF,0xD1,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x04,0xB6,0xFF,0xFF,0x6B,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x03,0x19,0x54,0xC9,0xFF,0xFF,0xAE,0x02,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0xA4,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xDE,0x6C,0x02,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0xA4,0xFF,0xFF,0xFF,0xFF,0xFF,0xFE,0xC0,0x67,0x07,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x4A,0x74,0x74,0x78,0x8B,0xBD,0xFC,0xFF,0xFF,0xD6,0x24,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1D,0xB7,0xFF,0xFF,0xE1,0x11,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x04,0xC3,0xFF,0xFF,0x85,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x44,0xFF,0xFF,0xD7,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x13,0xFF,0xFF,0xF8,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x16,0xFF,0xFF,0xF6,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x4E,0xFF,0xFF,0xD2,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x08,0xCC,0xFF,0xFF,0x87,0x00,
+0x00,0x93,0x76,0x1A,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x2B,0xC3,0xFF,0xFF,0xEF,0x18,0x00,
+0x00,0xAC,0xFF,0xFE,0xD0,0xA1,0x84,0x77,0x7E,0x97,0xCD,0xFF,0xFF,0xFF,0xF7,0x48,0x00,0x00,
+0x00,0xA8,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xCC,0x32,0x00,0x00,0x00,
+0x00,0x04,0x3E,0x80,0xB5,0xDA,0xF2,0xFD,0xFA,0xE8,0xC6,0x8F,0x3F,0x00,0x00,0x00,0x00,0x00,
+},
+{
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3A,0xFE,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x05,0xD4,0xFF,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x7C,0xFF,0xFE,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x25,0xF7,0xFF,0x9E,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xBE,0xFF,0xED,0x14,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x61,0xFF,0xFF,0x65,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x15,0xED,0xFF,0xC7,0x01,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0xA4,0xFF,0xFC,0x30,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x46,0xFF,0xFF,0x90,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x09,0xDD,0xFF,0xE5,0x0D,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x89,0xFF,0xFF,0x57,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x2E,0xFB,0xFF,0xBA,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x02,0xC9,0xFF,0xF8,0x25,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x6E,0xFF,0xFF,0x82,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x1C,0xF2,0xFF,0xDD,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x83,0xFF,0xFF,0x5D,0x14,0x14,0x14,0x14,0x14,0x14,0x14,0xFF,0xFF,0xFF,0x1B,0x14,0x14,0x07,
+0x88,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x5C,
+0x88,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x5C,
+0x33,0x60,0x60,0x60,0x60,0x60,0x60,0x60,0x60,0x60,0x60,0xFF,0xFF,0xFF,0x65,0x60,0x60,0x22,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
+},
+{
+0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x88,0x00,0x00,0x00,
+0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x88,0x00,0x00,0x00,
+0x00,0x00,0xFF,0xFF,0xFF,0x78,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x3D,0x00,0x00,0x00,
+0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0xFF,0xFF,0xFF,0x1E,0x4A,0x60,0x5B,0x40,0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFC,0xBB,0x3F,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x8C,0x01,0x00,0x00,0x00,
+0x00,0x00,0xF4,0xA6,0x60,0x31,0x19,0x17,0x30,0x6E,0xD9,0xFF,0xFF,0xFF,0x84,0x00,0x00,0x00,
+0x00,0x00,0x0D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x06,0x9C,0xFF,0xFF,0xFC,0x2C,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x02,0xC3,0xFF,0xFF,0x97,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x4C,0xFF,0xFF,0xDA,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x13,0xFF,0xFF,0xFC,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x06,0xFF,0xFF,0xFF,0x04,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x22,0xFF,0xFF,0xF3,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x71,0xFF,0xFF,0xC5,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1E,0xEA,0xFF,0xFF,0x73,0x00,0x00,
+0x00,0xB7,0x4A,0x05,0x00,0x00,0x00,0x00,0x00,0x00,0x3F,0xDF,0xFF,0xFF,0xE4,0x0D,0x00,0x00,
+0x00,0xFC,0xFF,0xF0,0xB9,0x8F,0x7C,0x7A,0x92,0xD0,0xFF,0xFF,0xFF,0xF3,0x39,0x00,0x00,0x00,
+0x00,0xFC,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xCD,0x2D,0x00,0x00,0x00,0x00,
+0x00,0x30,0x71,0xA5,0xCE,0xEB,0xFA,0xFD,0xEF,0xCF,0x99,0x46,0x01,0x00,0x00,0x00,0x00,0x00,
+},
+{
+0x00,0x00,0x00,0x00,0x00,0x00,0x1C,0x7E,0xC4,0xEC,0xFC,0xF4,0xD7,0xA8,0x67,0x16,0x00,0x00,
+0x00,0x00,0x00,0x00,0x02,0x7C,0xF7,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x8C,0x00,0x00,
+0x00,0x00,0x00,0x03,0xA9,0xFF,0xFF,0xFF,0xC8,0x8C,0x77,0x82,0xA9,0xE6,0xFF,0x8C,0x00,0x00,
+0x00,0x00,0x00,0x8D,0xFF,0xFF,0xDA,0x37,0x00,0x00,0x00,0x00,0x00,0x01,0x3F,0x51,0x00,0x00,
+0x00,0x00,0x3A,0xFE,0xFF,0xE2,0x17,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0xBE,0xFF,0xFF,0x4C,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x25,0xFF,0xFF,0xD4,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x74,0xFF,0xFF,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0xAF,0xFF,0xFF,0x42,0x00,0x01,0x33,0x63,0x70,0x61,0x37,0x03,0x00,0x00,0x00,0x00,0x00,
+0x00,0xD7,0xFF,0xFF,0x17,0x46,0xD5,0xFF,0xFF,0xFF,0xFF,0xFF,0xE8,0x74,0x03,0x00,0x00,0x00,
+0x00,0xF1,0xFF,0xFA,0x69,0xFE,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xBD,0x0A,0x00,0x00,
+0x00,0xFC,0xFF,0xFB,0xFC,0xFF,0xCA,0x4D,0x11,0x07,0x2A,0x87,0xFA,0xFF,0xFF,0xA5,0x00,0x00,
+0x00,0xFD,0xFF,0xFF,0xFF,0xB8,0x06,0x00,0x00,0x00,0x00,0x00,0x4C,0xFE,0xFF,0xFF,0x3A,0x00,
+0x00,0xF5,0xFF,0xFF,0xF9,0x1A,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x9F,0xFF,0xFF,0x9C,0x00,
+0x00,0xE2,0xFF,0xFF,0xB8,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x42,0xFF,0xFF,0xD8,0x00,
+0x00,0xC5,0xFF,0xFF,0x8D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x16,0xFF,0xFF,0xF6,0x00,
+0x00,0x9A,0xFF,0xFF,0x84,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0D,0xFF,0xFF,0xFC,0x00,
+0x00,0x5F,0xFF,0xFF,0x9B,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x25,0xFF,0xFF,0xEB,0x00,
+0x00,0x16,0xFB,0xFF,0xD9,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x64,0xFF,0xFF,0xBD,0x00,
+0x00,0x00,0xAA,0xFF,0xFF,0x52,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0xD6,0xFF,0xFF,0x6D,0x00,
+0x00,0x00,0x28,0xF9,0xFF,0xEF,0x42,0x00,0x00,0x00,0x00,0x0E,0xAF,0xFF,0xFF,0xE5,0x0C,0x00,
+0x00,0x00,0x00,0x6A,0xFF,0xFF,0xFF,0xBF,0x84,0x7A,0x9C,0xEC,0xFF,0xFF,0xF9,0x40,0x00,0x00,
+0x00,0x00,0x00,0x00,0x69,0xF8,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xE6,0x41,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x20,0x8C,0xD2,0xF5,0xFD,0xEC,0xBF,0x6F,0x0C,0x00,0x00,0x00,0x00,
+},
+{
+0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,
+0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xEE,0x00,
+0x00,0x00,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0xF1,0xFF,0xFF,0x95,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x2F,0xFF,0xFF,0xFF,0x35,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x8E,0xFF,0xFF,0xD4,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x04,0xE8,0xFF,0xFF,0x75,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x4B,0xFF,0xFF,0xFC,0x19,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xAA,0xFF,0xFF,0xB6,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x10,0xF8,0xFF,0xFF,0x56,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x67,0xFF,0xFF,0xEE,0x07,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC6,0xFF,0xFF,0x96,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x25,0xFF,0xFF,0xFF,0x36,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x83,0xFF,0xFF,0xD5,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0xE0,0xFF,0xFF,0x76,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x41,0xFF,0xFF,0xFC,0x19,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x9F,0xFF,0xFF,0xB7,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0B,0xF3,0xFF,0xFF,0x57,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x5D,0xFF,0xFF,0xEF,0x07,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xBB,0xFF,0xFF,0x97,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x1C,0xFD,0xFF,0xFF,0x37,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x79,0xFF,0xFF,0xD6,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0xD7,0xFF,0xFF,0x77,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x36,0xFF,0xFF,0xFC,0x1A,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x95,0xFF,0xFF,0xB7,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+},
+{
+0x00,0x00,0x00,0x00,0x05,0x5A,0xB0,0xE2,0xF7,0xF7,0xE2,0xB0,0x5B,0x05,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x24,0xD0,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xD0,0x23,0x00,0x00,0x00,
+0x00,0x00,0x10,0xE0,0xFF,0xFF,0xFB,0xAF,0x7E,0x7E,0xB1,0xFC,0xFF,0xFF,0xE0,0x10,0x00,0x00,
+0x00,0x00,0x86,0xFF,0xFF,0xEF,0x33,0x00,0x00,0x00,0x00,0x36,0xF0,0xFF,0xFF,0x85,0x00,0x00,
+0x00,0x00,0xD9,0xFF,0xFF,0x69,0x00,0x00,0x00,0x00,0x00,0x00,0x6B,0xFF,0xFF,0xD8,0x00,0x00,
+0x00,0x01,0xFB,0xFF,0xFF,0x19,0x00,0x00,0x00,0x00,0x00,0x00,0x1B,0xFF,0xFF,0xFB,0x01,0x00,
+0x00,0x01,0xFD,0xFF,0xFF,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x05,0xFF,0xFF,0xFC,0x01,0x00,
+0x00,0x00,0xD6,0xFF,0xFF,0x19,0x00,0x00,0x00,0x00,0x00,0x00,0x1A,0xFF,0xFF,0xD4,0x00,0x00,
+0x00,0x00,0x78,0xFF,0xFF,0x67,0x00,0x00,0x00,0x00,0x00,0x00,0x69,0xFF,0xFF,0x74,0x00,0x00,
+0x00,0x00,0x07,0xC6,0xFF,0xED,0x30,0x00,0x00,0x00,0x00,0x33,0xEF,0xFF,0xC4,0x05,0x00,0x00,
+0x00,0x00,0x00,0x0B,0x95,0xFA,0xFB,0xAE,0x7D,0x7D,0xAF,0xFC,0xFA,0x94,0x0A,0x00,0x00,0x00,
+0x00,0x00,0x00,0x00,0x39,0xA8,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xA8,0x39,0x00,0x00,0x00,0x00,
+0x00,0x00,0x0D,0xAC,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xAD,0x0D,0x00,0x00,
+0x00,0x04,0xC2,0xFF,0xFF,0xEF,0x78,0x29,0x08,0x09,0x2A,0x78,0xEF,0xFF,0xFF,0xC2,0x04,0x00,
+0x00,0x6C,0xFF,0xFF,0xE7,0x22,0x00,0x00,0x00,0x00,0x00,0x00,0x22,0xE8,0xFF,0xFF,0x6B,0x00,
+0x00,0xCA,0xFF,0xFF,0x64,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x65,0xFF,0xFF,0xC9,0x00,
+0x00,0xF6,0xFF,0xFF,0x1C,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1D,0xFF,0xFF,0xF4,0x00,
+0x00,0xFB,0xFF,0xFF,0x0E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0F,0xFF,0xFF,0xFA,0x00,
+0x00,0xE1,0xFF,0xFF,0x32,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x35,0xFF,0xFF,0xE0,0x00,
+0x00,0xA7,0xFF,0xFF,0x9D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xA2,0xFF,0xFF,0xA5,0x00,
+0x00,0x3F,0xFF,0xFF,0xFF,0x81,0x04,0x00,0x00,0x00,0x00,0x06,0x88,0xFF,0xFF,0xFF,0x3D,0x00,
+0x00,0x00,0x98,0xFF,0xFF,0xFF,0xE5,0x9C,0x7B,0x7C,0x9D,0xE7,0xFF,0xFF,0xFF,0x94,0x00,0x00,
+0x00,0x00,0x02,0x80,0xFB,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFB,0x7E,0x02,0x00,0x00,
+0x00,0x00,0x00,0x00,0x1F,0x80,0xBF,0xE8,0xF8,0xF8,0xE8,0xBF,0x7F,0x1E,0x00,0x00,0x00,0x00,
+},
+{
+0x00,0x00,0x00,0x00,0x08,0x67,0xBA,0xEA,0xFC,0xF4,0xD0,0x8A,0x20,0x00,0x00,0x00,0x00,0x00,
+0x00,0x00,0x00,0x34,0xDD,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xF7,0x68,0x00,0x00,0x00,0x00,
+0x00,0x00,0x30,0xF2,0xFF,0xFF,0xF0,0xA0,0x7C,0x86,0xC3,0xFF,0xFF,0xFF,0x69,0x00,0x00,0x00,
+0x00,0x05,0xD7,0xFF,0xFF,0xBE,0x14,0x00,0x00,0x00,0x00,0x4D,0xF5,0xFF,0xF9,0x27,0x00,0x00,
+0x00,0x5C,0xFF,0xFF,0xE3,0x0E,0x00,0x00,0x00,0x00,0x00,0x00,0x62,0xFF,0xFF,0xA9,0x00,0x00,
+0x00,0xB0,0xFF,0xFF,0x73,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x02,0xE1,0xFF,0xFA,0x14,0x00,
+0x00,0xE3,0xFF,0xFF,0x2E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x9F,0xFF,0xFF,0x5E,0x00,
+0x00,0xFB,0xFF,0xFF,0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x81,0xFF,0xFF,0x98,0x00,
+0x00,0xFB,0xFF,0xFF,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x80,0xFF,0xFF,0xC3,0x00,
+0x00,0xE7,0xFF,0xFF,0x2B,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x9C,0xFF,0xFF,0xE1,0x00,
+0x00,0xBA,0xFF,0xFF,0x6D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0xDD,0xFF,0xFF,0xF3,0x00,
+0x00,0x6C,0xFF,0xFF,0xDC,0x0A,0x00,0x00,0x00,0x00,0x00,0x00,0x58,0xFF,0xFF,0xFF,0xFC,0x00,
+0x00,0x0D,0xE9,0xFF,0xFF,0xB2,0x0D,0x00,0x00,0x00,0x00,0x40,0xF0,0xFF,0xFF,0xFF,0xFB,0x00,
+0x00,0x00,0x4A,0xFC,0xFF,0xFF,0xE9,0x93,0x6F,0x78,0xB6,0xFE,0xFF,0xDB,0xF5,0xFF,0xEF,0x00,
+0x00,0x00,0x00,0x50,0xF0,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xD6,0x27,0xFE,0xFF,0xD6,0x00,
+0x00,0x00,0x00,0x00,0x16,0x80,0xCF,0xF8,0xFF,0xFA,0xCC,0x70,0x07,0x2B,0xFF,0xFF,0xAD,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x09,0x02,0x00,0x00,0x00,0x64,0xFF,0xFF,0x73,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xB7,0xFF,0xFF,0x25,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x2E,0xFE,0xFF,0xBD,0x00,0x00,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0B,0xCE,0xFF,0xFE,0x39,0x00,0x00,
+0x00,0x00,0x40,0x25,0x00,0x00,0x00,0x00,0x00,0x00,0x2A,0xCA,0xFF,0xFF,0x8D,0x00,0x00,0x00,
+0x00,0x00,0x90,0xFF,0xD7,0xA0,0x80,0x76,0x89,0xC0,0xFD,0xFF,0xFF,0xAA,0x03,0x00,0x00,0x00,
+0x00,0x00,0x90,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xF8,0x7E,0x02,0x00,0x00,0x00,0x00,
+0x00,0x00,0x1E,0x70,0xAE,0xDB,0xF5,0xFD,0xEE,0xC6,0x80,0x1C,0x00,0x00,0x00,0x00,0x00,0x00,
+}
+};
+
+
+// glyph sizes at scale 1
+#define GLYPH_HEIGHT            24
+#define DIGIT_WIDTH             18
+#define COLON_WIDTH             9
+
+// The timecode HH:MM:SS:FF is a row of character cells. The cell widths and the border are even at
+// every scale so that each cell starts on a chroma sample and can be copied into the strips as a whole
+#define DIGIT_CELL_WIDTH        20
+#define COLON_CELL_WIDTH        14
+#define COLON_CELL_OFFSET       2
+#define BORDER_SIZE             2
+
+#define NUM_CHARS               11
+#define NUM_GLYPHS              12
+#define COLON_GLYPH             10
+#define SEMICOLON_GLYPH         11
+
+#define SD_HEIGHT               576
+
+#define MAX_WEIGHT              255
+
+static const uint8_t blackY = 0x10, whiteY = 0xEB, neutralUV = 0x80;
+
+
+// Blend weights and target sample values in the frame's sample layout. The chroma plane is shared by U and V
+typedef struct
+{
+    uint8_t *weight;
+    uint8_t *target;
+    int width;      // bytes per row
+    int height;     // rows
+} BurnInPlane;
+
+// The pre-rendered cells, which are read-only after creation and shared by the burn-ins created with
+// burn_in_create_shared
+typedef struct
+{
+    int ref_count;
+    BurnInPlane cells[NUM_GLYPHS][2];
+} BurnInGlyphs;
+
+struct BurnInTimecode
+{
+    BurnInFormat format;
+    BurnInStyle style;
+    int frame_width;
+    int frame_height;
+
+    int scale;
+    int border;
+    int width;
+    int height;
+
+    int char_x[NUM_CHARS];
+    int chars[NUM_CHARS];
+
+    int num_planes;
+    BurnInGlyphs *glyphs;
+    BurnInPlane planes[2];
+};
+
+
+
+static int is_colon_char(int index)
+{
+    return index == 2 || index == 5 || index == 8;
+}
+
+static int get_cell_width(const BurnInTimecode *bitc, int glyph)
+{
+    return (glyph >= COLON_GLYPH ? COLON_CELL_WIDTH : DIGIT_CELL_WIDTH) * bitc->scale;
+}
+
+// render the glyph into its cell of luma alpha values, scaled by pixel replication
+static void render_cell_alpha(const BurnInTimecode *bitc, int glyph, uint8_t *alpha)
+{
+    const unsigned char *glyph_data;
+    int glyph_width, glyph_offset;
+    int cell_width = get_cell_width(bitc, glyph);
+    int cell_height = GLYPH_HEIGHT * bitc->scale;
+    int gx, x, y;
+
+    if (glyph == COLON_GLYPH)
+    {
+        glyph_data = tc_colon;
+        glyph_width = COLON_WIDTH;
+        glyph_offset = COLON_CELL_OFFSET;
+    }
+    else if (glyph == SEMICOLON_GLYPH)
+    {
+        glyph_data = tc_semicolon;
+        glyph_width = COLON_WIDTH;
+        glyph_offset = COLON_CELL_OFFSET;
+    }
+    else
+    {
+        glyph_data = tc_digit[glyph];
+        glyph_width = DIGIT_WIDTH;
+        glyph_offset = 0;
+    }
+
+    for (y = 0; y < cell_height; y++)
+    {
+        for (x = 0; x < cell_width; x++)
+        {
+            gx = x / bitc->scale - glyph_offset;
+            if (gx >= 0 && gx < glyph_width)
+                alpha[y * cell_width + x] = glyph_data[(y / bitc->scale) * glyph_width + gx];
+            else
+                alpha[y * cell_width + x] = 0;
+        }
+    }
+}
+
+static void get_luma_blend(const BurnInTimecode *bitc, uint8_t alpha, int is_border, uint8_t *weight, uint8_t *target)
+{
+    if (bitc->style == BURN_IN_BLACK_TEXT)
+    {
+        *weight = alpha;
+        *target = blackY;
+    }
+    else if (is_border)
+    {
+        *weight = MAX_WEIGHT;
+        *target = blackY;
+    }
+    else if (alpha <= 0x20)
+    {
+        // darken the background to 1/8
+        *weight = MAX_WEIGHT * 7 / 8;
+        *target = 0;
+    }
+    else
+    {
+        *weight = alpha;
+        *target = whiteY;
+    }
+}
+
+static uint8_t get_chroma_weight(const BurnInTimecode *bitc, uint8_t alpha, int is_border)
+{
+    // the box background and border have neutral chroma
+    if (bitc->style == BURN_IN_WHITE_ON_BLACK && (is_border || alpha <= 0x20))
+        return MAX_WEIGHT;
+
+    return alpha;
+}
+
+static int alloc_plane(BurnInPlane *plane, int width, int height)
+{
+    plane->width = width;
+    plane->height = height;
+    plane->weight = (uint8_t*)calloc(width * height, 1);
+    plane->target = (uint8_t*)calloc(width * height, 1);
+
+    return plane->weight && plane->target;
+}
+
+static void free_plane(BurnInPlane *plane)
+{
+    free(plane->weight);
+    free(plane->target);
+    plane->weight = 0;
+    plane->target = 0;
+}
+
+// Convert width x height luma alpha values to the format's planes. Samples within border of the edge
+// are part of the box border. The chroma sample is taken from the even luma sample as in the 4:2:2 to
+// 4:2:0 conversion of the original burn-in
+static int convert_alpha(const BurnInTimecode *bitc, const uint8_t *alpha, int width, int height, int border,
+                         BurnInPlane *planes)
+{
+    int x, y, i;
+    int is_border;
+    uint8_t a;
+
+    if (bitc->format == BURN_IN_UYVY)
+    {
+        if (!alloc_plane(&planes[0], (width + 1) / 2 * 4, height))
+            return 0;
+
+        for (y = 0; y < height; y++)
+        {
+            uint8_t *weight = &planes[0].weight[y * planes[0].width];
+            uint8_t *target = &planes[0].target[y * planes[0].width];
+            for (x = 0; x < width; x++)
+            {
+                a = alpha[y * width + x];
+                is_border = (y < border || y >= height - border || x < border || x >= width - border);
+
+                get_luma_blend(bitc, a, is_border, &weight[x * 2 + 1], &target[x * 2 + 1]);
+                if (x % 2 == 0)
+                {
+                    weight[x * 2] = weight[x * 2 + 2] = get_chroma_weight(bitc, a, is_border);
+                    target[x * 2] = target[x * 2 + 2] = neutralUV;
+                }
+            }
+        }
+    }
+    else
+    {
+        int chroma_height = (bitc->format == BURN_IN_YUV420 ? (height + 1) / 2 : height);
+        int chroma_vert_factor = (bitc->format == BURN_IN_YUV420 ? 2 : 1);
+
+        if (!alloc_plane(&planes[0], width, height) ||
+            !alloc_plane(&planes[1], (width + 1) / 2, chroma_height))
+        {
+            return 0;
+        }
+
+        for (i = 0; i < width * height; i++)
+        {
+            x = i % width;
+            y = i / width;
+            is_border = (y < border || y >= height - border || x < border || x >= width - border);
+            get_luma_blend(bitc, alpha[i], is_border, &planes[0].weight[i], &planes[0].target[i]);
+        }
+
+        for (y = 0; y < chroma_height; y++)
+        {
+            for (x = 0; x < planes[1].width; x++)
+            {
+                a = alpha[y * chroma_vert_factor * width + x * 2];
+                is_border = (y * chroma_vert_factor < border || y * chroma_vert_factor >= height - border ||
+                             x * 2 < border || x * 2 >= width - border);
+                planes[1].weight[y * planes[1].width + x] = get_chroma_weight(bitc, a, is_border);
+                planes[1].target[y * planes[1].width + x] = neutralUV;
+            }
+        }
+    }
+
+    return 1;
+}
+
+// copy a pre-rendered cell into the strips. The cell's chroma rows start at row border / 2 in 4:2:0,
+// which is exact because the border is even
+static void copy_cell(BurnInTimecode *bitc, int index, int glyph)
+{
+    int p, y;
+    int x_bytes, y_offset;
+
+    for (p = 0; p < bitc->num_planes; p++)
+    {
+        const BurnInPlane *cell = &bitc->glyphs->cells[glyph][p];
+        BurnInPlane *plane = &bitc->planes[p];
+
+        if (bitc->format == BURN_IN_UYVY)
+            x_bytes = bitc->char_x[index] * 2;
+        else if (p == 0)
+            x_bytes = bitc->char_x[index];
+        else
+            x_bytes = bitc->char_x[index] / 2;
+
+        if (p == 1 && bitc->format == BURN_IN_YUV420)
+            y_offset = bitc->border / 2;
+        else
+            y_offset = bitc->border;
+
+        for (y = 0; y < cell->height; y++)
+        {
+            memcpy(&plane->weight[(y_offset + y) * plane->width + x_bytes], &cell->weight[y * cell->width], cell->width);
+            memcpy(&plane->target[(y_offset + y) * plane->width + x_bytes], &cell->target[y * cell->width], cell->width);
+        }
+    }
+}
+
+
+// dst = (dst * (255 - weight) + target * weight) / 255, rounded
+static void blend_row(uint8_t *dst, const uint8_t *weight, const uint8_t *target, int num_bytes)
+{
+    int i = 0;
+    int value;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max_weight = _mm_set1_epi16(MAX_WEIGHT);
+    const __m128i round = _mm_set1_epi16(128);
+    __m128i d, w, t, lo, hi;
+
+    for (; i + 16 <= num_bytes; i += 16)
+    {
+        w = _mm_loadu_si128((const __m128i*)(weight + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(w, zero)) == 0xffff)
+            continue;   // transparent
+        d = _mm_loadu_si128((const __m128i*)(dst + i));
+        t = _mm_loadu_si128((const __m128i*)(target + i));
+
+        // the 16-bit sums are at most 255 * 255 + 128 and so don't overflow
+        lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero),
+                                           _mm_sub_epi16(max_weight, _mm_unpacklo_epi8(w, zero))),
+                           _mm_mullo_epi16(_mm_unpacklo_epi8(t, zero), _mm_unpacklo_epi8(w, zero)));
+        hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero),
+                                           _mm_sub_epi16(max_weight, _mm_unpackhi_epi8(w, zero))),
+                           _mm_mullo_epi16(_mm_unpackhi_epi8(t, zero), _mm_unpackhi_epi8(w, zero)));
+        lo = _mm_add_epi16(lo, round);
+        hi = _mm_add_epi16(hi, round);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+
+    for (; i < num_bytes; i++)
+    {
+        value = dst[i] * (MAX_WEIGHT - weight[i]) + target[i] * weight[i] + 128;
+        dst[i] = (uint8_t)((value + (value >> 8)) >> 8);
+    }
+}
+
+static void blend_plane(const BurnInPlane *plane, int num_rows, int num_bytes, uint8_t *dst, int dst_stride)
+{
+    int y;
+
+    if (num_bytes > plane->width)
+        num_bytes = plane->width;
+    if (num_rows > plane->height)
+        num_rows = plane->height;
+
+    for (y = 0; y < num_rows; y++)
+        blend_row(dst + y * dst_stride, &plane->weight[y * plane->width], &plane->target[y * plane->width], num_bytes);
+}
+
+
+
+static void free_glyphs(BurnInGlyphs *glyphs)
+{
+    int i, p;
+
+    if (!glyphs)
+        return;
+
+    for (p = 0; p < 2; p++)
+    {
+        for (i = 0; i < NUM_GLYPHS; i++)
+            free_plane(&glyphs->cells[i][p]);
+    }
+    free(glyphs);
+}
+
+// create the empty box strips
+static int create_strips(BurnInTimecode *bitc)
+{
+    uint8_t *alpha;
+    int i, result;
+
+    for (i = 0; i < NUM_CHARS; i++)
+        bitc->chars[i] = -1;
+
+    alpha = (uint8_t*)calloc(bitc->width * bitc->height, 1);
+    if (!alpha)
+        return 0;
+
+    result = convert_alpha(bitc, alpha, bitc->width, bitc->height, bitc->border, bitc->planes);
+
+    free(alpha);
+    return result;
+}
+
+
+BurnInTimecode *burn_in_create(int frame_width, int frame_height, BurnInFormat format, BurnInStyle style)
+{
+    BurnInTimecode *bitc;
+    uint8_t *alpha = 0;
+    int x, i;
+
+    bitc = (BurnInTimecode*)calloc(1, sizeof(BurnInTimecode));
+    if (!bitc)
+        return 0;
+
+    bitc->format = format;
+    bitc->style = style;
+    bitc->frame_width = frame_width;
+    bitc->frame_height = frame_height;
+    bitc->num_planes = (format == BURN_IN_UYVY ? 1 : 2);
+
+    bitc->scale = (frame_height + SD_HEIGHT / 2) / SD_HEIGHT;
+    if (bitc->scale < 1)
+        bitc->scale = 1;
+    bitc->border = (style == BURN_IN_WHITE_ON_BLACK ? BORDER_SIZE * bitc->scale : 0);
+
+    x = bitc->border;
+    for (i = 0; i < NUM_CHARS; i++)
+    {
+        bitc->char_x[i] = x;
+        x += (is_colon_char(i) ? COLON_CELL_WIDTH : DIGIT_CELL_WIDTH) * bitc->scale;
+    }
+    bitc->width = x + bitc->border;
+    bitc->height = GLYPH_HEIGHT * bitc->scale + 2 * bitc->border;
+
+    bitc->glyphs = (BurnInGlyphs*)calloc(1, sizeof(BurnInGlyphs));
+    alpha = (uint8_t*)calloc(bitc->width * bitc->height, 1);
+    if (!bitc->glyphs || !alpha)
+        goto fail;
+    bitc->glyphs->ref_count = 1;
+
+    for (i = 0; i < NUM_GLYPHS; i++)
+    {
+        render_cell_alpha(bitc, i, alpha);
+        if (!convert_alpha(bitc, alpha, get_cell_width(bitc, i), GLYPH_HEIGHT * bitc->scale, 0,
+                           bitc->glyphs->cells[i]))
+        {
+            goto fail;
+        }
+    }
+
+    if (!create_strips(bitc))
+        goto fail;
+
+    free(alpha);
+    return bitc;
+
+fail:
+    free(alpha);
+    burn_in_free(bitc);
+    return 0;
+}
+
+BurnInTimecode *burn_in_create_shared(const BurnInTimecode *source)
+{
+    BurnInTimecode *bitc;
+
+    bitc = (BurnInTimecode*)malloc(sizeof(BurnInTimecode));
+    if (!bitc)
+        return 0;
+
+    *bitc = *source;
+    memset(bitc->planes, 0, sizeof(bitc->planes));
+    __sync_fetch_and_add(&bitc->glyphs->ref_count, 1);
+
+    if (!create_strips(bitc))
+    {
+        burn_in_free(bitc);
+        return 0;
+    }
+
+    return bitc;
+}
+
+void burn_in_free(BurnInTimecode *bitc)
+{
+    int p;
+
+    if (!bitc)
+        return;
+
+    if (bitc->glyphs && __sync_sub_and_fetch(&bitc->glyphs->ref_count, 1) == 0)
+        free_glyphs(bitc->glyphs);
+    for (p = 0; p < 2; p++)
+        free_plane(&bitc->planes[p]);
+    free(bitc);
+}
+
+int burn_in_width(const BurnInTimecode *bitc)
+{
+    return bitc->width;
+}
+
+int burn_in_height(const BurnInTimecode *bitc)
+{
+    return bitc->height;
+}
+
+void burn_in_set_timecode(BurnInTimecode *bitc, int hours, int minutes, int seconds, int frames, int drop_frame)
+{
+    int chars[NUM_CHARS];
+    int i;
+
+    chars[0] = (hours / 10) % 10;
+    chars[1] = hours % 10;
+    chars[2] = COLON_GLYPH;
+    chars[3] = (minutes / 10) % 10;
+    chars[4] = minutes % 10;
+    chars[5] = COLON_GLYPH;
+    chars[6] = (seconds / 10) % 10;
+    chars[7] = seconds % 10;
+    chars[8] = (drop_frame ? SEMICOLON_GLYPH : COLON_GLYPH);
+    chars[9] = (frames / 10) % 10;
+    chars[10] = frames % 10;
+
+    for (i = 0; i < NUM_CHARS; i++)
+    {
+        if (chars[i] != bitc->chars[i])
+        {
+            copy_cell(bitc, i, chars[i]);
+            bitc->chars[i] = chars[i];
+        }
+    }
+}
+
+void burn_in_apply(const BurnInTimecode *bitc, int x_offset, int y_offset,
+                   uint8_t *y_comp, uint8_t *u_comp, uint8_t *v_comp)
+{
+    int chroma_width = bitc->frame_width / 2;
+    int num_rows;
+
+    if (x_offset < 0)
+        x_offset = 0;
+    if (y_offset < 0)
+        y_offset = 0;
+    x_offset &= ~1;
+    if (x_offset >= bitc->frame_width || y_offset >= bitc->frame_height)
+        return;
+    num_rows = bitc->frame_height - y_offset;
+
+    switch (bitc->format)
+    {
+        case BURN_IN_UYVY:
+            blend_plane(&bitc->planes[0], num_rows, (bitc->frame_width - x_offset) * 2,
+                        y_comp + (y_offset * bitc->frame_width + x_offset) * 2, bitc->frame_width * 2);
+            break;
+        case BURN_IN_YUV422:
+            blend_plane(&bitc->planes[0], num_rows, bitc->frame_width - x_offset,
+                        y_comp + y_offset * bitc->frame_width + x_offset, bitc->frame_width);
+            blend_plane(&bitc->planes[1], num_rows, chroma_width - x_offset / 2,
+                        u_comp + y_offset * chroma_width + x_offset / 2, chroma_width);
+            blend_plane(&bitc->planes[1], num_rows, chroma_width - x_offset / 2,
+                        v_comp + y_offset * chroma_width + x_offset / 2, chroma_width);
+            break;
+        case BURN_IN_YUV420:
+            blend_plane(&bitc->planes[0], num_rows, bitc->frame_width - x_offset,
+                        y_comp + y_offset * bitc->frame_width + x_offset, bitc->frame_width);
+            num_rows = bitc->frame_height / 2 - y_offset / 2;
+            blend_plane(&bitc->planes[1], num_rows, chroma_width - x_offset / 2,
+                        u_comp + (y_offset / 2) * chroma_width + x_offset / 2, chroma_width);
+            blend_plane(&bitc->planes[1], num_rows, chroma_width - x_offset / 2,
+                        v_comp + (y_offset / 2) * chroma_width + x_offset / 2, chroma_width);
+            break;
+    }
+}
+
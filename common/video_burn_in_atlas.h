@@ -0,0 +1,79 @@
+/*
+ * $Id$
+ *
+ * Glyph atlas based timecode burn-in for UYVY and planar YUV frames
+ *
+ * Copyright (C) 2012 British Broadcasting Corporation
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __VIDEO_BURN_IN_ATLAS_H__
+#define __VIDEO_BURN_IN_ATLAS_H__
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum
+{
+    BURN_IN_UYVY,
+    BURN_IN_YUV422,             // planar
+    BURN_IN_YUV420              // planar
+} BurnInFormat;
+
+typedef enum
+{
+    BURN_IN_BLACK_TEXT,         // black digits blended into the picture
+    BURN_IN_WHITE_ON_BLACK      // white digits on a darkened box with a black border
+} BurnInStyle;
+
+typedef struct BurnInTimecode BurnInTimecode;
+
+
+// The digit, colon and semicolon cells are pre-rendered into the format's sample layout when the
+// burn-in is created. The glyphs are scaled by an integer factor so that the timecode has about the same
+// size relative to the picture height as it has in SD, e.g. double size for 1080 line rasters.
+BurnInTimecode *burn_in_create(int frame_width, int frame_height, BurnInFormat format, BurnInStyle style);
+void burn_in_free(BurnInTimecode *bitc);
+
+// Create a burn-in with its own strips that shares the read-only pre-rendered cells of source. The cells
+// are freed with the last burn-in that uses them. Burn-ins that share cells can be used by different
+// threads at the same time
+BurnInTimecode *burn_in_create_shared(const BurnInTimecode *source);
+
+// size of the burn-in area in luma samples, including the border
+int burn_in_width(const BurnInTimecode *bitc);
+int burn_in_height(const BurnInTimecode *bitc);
+
+// Copy the cells for the timecode HH:MM:SS:FF into the burn-in strips. Only the characters that
+// changed since the last call are copied
+void burn_in_set_timecode(BurnInTimecode *bitc, int hours, int minutes, int seconds, int frames, int drop_frame);
+
+// Blend the burn-in into the frame with its top left corner at luma sample (x_offset, y_offset), clipped
+// to the picture. x_offset is rounded down to an even sample so that it is aligned with the chroma.
+// u_comp and v_comp are ignored for UYVY
+void burn_in_apply(const BurnInTimecode *bitc, int x_offset, int y_offset,
+                   uint8_t *y_comp, uint8_t *u_comp, uint8_t *v_comp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -26,6 +26,7 @@
 
 #include "Timecode.h"
 
+// Blend black timecode digits into the frame, see video_burn_in_atlas.h for the scaling and clipping
 void burn_mask_yuv420(const Ingex::Timecode & timecode, int x_offset, int y_offset, int frame_width, int frame_height, unsigned char *frame);
 void burn_mask_yuv422(const Ingex::Timecode & timecode, int x_offset, int y_offset, int frame_width, int frame_height, unsigned char *frame);
 void burn_mask_uyvy(const Ingex::Timecode & timecode, int x_offset, int y_offset, int frame_width, int frame_height, unsigned char *frame);
@@ -24,6 +24,8 @@
  * 02110-1301, USA
  */
 
+#include <cstdio>
+#include <cstring>
 #include <memory>
 
 #include <libMXF++/MXF.h>
@@ -37,6 +39,40 @@ using namespace std;
 using namespace mxfpp;
 
 
+// saved index file: magic, essence length, number of offsets and the offsets, all big endian
+static const char INDEX_FILE_MAGIC[8] = {'I', 'N', 'G', 'X', 'F', 'O', 'I', '1'};
+
+#define MAX_LOAD_OFFSETS        (64 * 1024 * 1024)
+
+
+
+static bool write_int64(FILE *file, int64_t value)
+{
+    unsigned char buffer[8];
+    int i;
+    for (i = 0; i < 8; i++)
+        buffer[i] = (unsigned char)(((uint64_t)value >> ((7 - i) * 8)) & 0xff);
+    
+    return fwrite(buffer, sizeof(buffer), 1, file) == 1;
+}
+
+static bool read_int64(FILE *file, int64_t *value)
+{
+    unsigned char buffer[8];
+    uint64_t result = 0;
+    int i;
+    
+    if (fread(buffer, sizeof(buffer), 1, file) != 1)
+        return false;
+    
+    for (i = 0; i < 8; i++)
+        result = (result << 8) | buffer[i];
+    *value = (int64_t)result;
+    
+    return true;
+}
+
+
 int add_frame_offset_index_entry(void *data, uint32_t num_entries, MXFIndexTableSegment *segment,
                                  int8_t temporal_offset, int8_t key_frame_offset, uint8_t flags,
                                  uint64_t stream_offset, uint32_t *slice_offset, mxfRational *pos_table)
@@ -70,6 +106,48 @@ FrameOffsetIndexTableSegment* FrameOffsetIndexTableSegment::read(File* file, uin
 }
 
 
+FrameOffsetIndexTableSegment* FrameOffsetIndexTableSegment::load(string filename, int64_t essence_length)
+{
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (!file)
+        return 0;
+    
+    auto_ptr<FrameOffsetIndexTableSegment> index_table(new FrameOffsetIndexTableSegment());
+    char magic[sizeof(INDEX_FILE_MAGIC)];
+    int64_t saved_essence_length;
+    int64_t num_offsets;
+    int64_t offset;
+    int64_t prev_offset = 0;
+    int64_t i;
+    
+    if (fread(magic, sizeof(magic), 1, file) != 1 ||
+        memcmp(magic, INDEX_FILE_MAGIC, sizeof(magic)) != 0 ||
+        !read_int64(file, &saved_essence_length) ||
+        saved_essence_length != essence_length ||
+        !read_int64(file, &num_offsets) ||
+        num_offsets < 1 || num_offsets > MAX_LOAD_OFFSETS)
+    {
+        fclose(file);
+        return 0;
+    }
+    
+    index_table->mFrameOffsets.reserve((size_t)num_offsets);
+    for (i = 0; i < num_offsets; i++) {
+        if (!read_int64(file, &offset) || offset < prev_offset || offset > essence_length) {
+            mxf_log_warn("Invalid saved frame offset index file '%s'\n", filename.c_str());
+            fclose(file);
+            return 0;
+        }
+        index_table->mFrameOffsets.push_back(offset);
+        prev_offset = offset;
+    }
+    
+    fclose(file);
+    
+    return index_table.release();
+}
+
+
 
 FrameOffsetIndexTableSegment::FrameOffsetIndexTableSegment()
 : IndexTableSegment()
@@ -121,3 +199,26 @@ void FrameOffsetIndexTableSegment::appendFrameOffset(int64_t offset)
     return mFrameOffsets.push_back(offset);
 }
 
+bool FrameOffsetIndexTableSegment::save(string filename, int64_t essence_length)
+{
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (!file)
+        return false;
+    
+    bool result = fwrite(INDEX_FILE_MAGIC, sizeof(INDEX_FILE_MAGIC), 1, file) == 1 &&
+                  write_int64(file, essence_length) &&
+                  write_int64(file, (int64_t)mFrameOffsets.size());
+    
+    size_t i;
+    for (i = 0; result && i < mFrameOffsets.size(); i++)
+        result = write_int64(file, mFrameOffsets[i]);
+    
+    if (fclose(file) != 0)
+        result = false;
+    
+    if (!result)
+        remove(filename.c_str());
+    
+    return result;
+}
+
@@ -28,6 +28,7 @@
 #define __MXFPP_FRAME_OFFSET_INDEX_TABLE_H__
 
 #include <vector>
+#include <string>
 
 #include "libMXF++/IndexTable.h"
 
@@ -36,6 +37,7 @@ class FrameOffsetIndexTableSegment : public mxfpp::IndexTableSegment
 {
 public:
     static FrameOffsetIndexTableSegment* read(mxfpp::File *file, uint64_t segment_len);
+    static FrameOffsetIndexTableSegment* load(std::string filename, int64_t essence_length);
 
 public:
     FrameOffsetIndexTableSegment();
@@ -50,6 +52,8 @@ public:
     
     void appendFrameOffset(int64_t offset);
     
+    bool save(std::string filename, int64_t essence_length);
+    
 private:
     std::vector<int64_t> mFrameOffsets;
 };
@@ -32,6 +32,7 @@
 #include <mxf/mxf_avid.h>
 
 #include "OPAtomTrackReader.h"
+#include "VariableSizeEssenceParser.h"
 
 using namespace std;
 using namespace mxfpp;
@@ -54,6 +55,12 @@ const char * const ERROR_STRINGS[] =
 
 
 OPAtomOpenResult OPAtomTrackReader::Open(std::string filename, OPAtomTrackReader **track_reader)
+{
+    return Open(filename, "", track_reader);
+}
+
+OPAtomOpenResult OPAtomTrackReader::Open(std::string filename, std::string index_filename,
+                                         OPAtomTrackReader **track_reader)
 {
     File *file = 0;
     Partition *header_partition = 0;
@@ -79,7 +86,7 @@ OPAtomOpenResult OPAtomTrackReader::Open(std::string filename, OPAtomTrackReader
             throw OP_ATOM_NOT_OP_ATOM;
 
         
-        *track_reader = new OPAtomTrackReader(filename, file, header_partition);
+        *track_reader = new OPAtomTrackReader(filename, index_filename, file, header_partition);
 
         delete header_partition;
         header_partition = 0;
@@ -111,7 +118,8 @@ string OPAtomTrackReader::ErrorToString(OPAtomOpenResult result)
 
 
 
-OPAtomTrackReader::OPAtomTrackReader(string filename, File *file, Partition *header_partition)
+OPAtomTrackReader::OPAtomTrackReader(string filename, string index_filename, File *file,
+                                     Partition *header_partition)
 {
     mFilename = filename;
     
@@ -261,6 +269,10 @@ OPAtomTrackReader::OPAtomTrackReader(string filename, File *file, Partition *hea
         
         essence_length = len;
         
+        // use a previously saved index table if the file doesn't contain one
+        if (!index_table && !index_filename.empty())
+            index_table = FrameOffsetIndexTableSegment::load(index_filename, essence_length);
+        
         
         mEssenceParser = RawEssenceParser::Create(file, essence_length, essence_label, file_descriptor, edit_rate,
                                                   frame_size, index_table);
@@ -348,4 +360,13 @@ bool OPAtomTrackReader::IsEOF()
     return mEssenceParser->IsEOF();
 }
 
+bool OPAtomTrackReader::SaveIndexTable(string index_filename)
+{
+    VariableSizeEssenceParser *parser = dynamic_cast<VariableSizeEssenceParser*>(mEssenceParser);
+    if (!parser)
+        return false;
+    
+    return parser->SaveIndexTable(index_filename);
+}
+
 
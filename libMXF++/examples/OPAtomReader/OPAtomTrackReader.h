@@ -57,6 +57,8 @@ class OPAtomTrackReader
 {
 public:
     static OPAtomOpenResult Open(std::string filename, OPAtomTrackReader **track_reader);
+    static OPAtomOpenResult Open(std::string filename, std::string index_filename,
+                                 OPAtomTrackReader **track_reader);
     static std::string ErrorToString(OPAtomOpenResult result);
     
 public:
@@ -77,9 +79,12 @@ public:
     bool Seek(int64_t position);
     
     bool IsEOF();
+    
+    bool SaveIndexTable(std::string index_filename);
 
 private:
-    OPAtomTrackReader(std::string filename, mxfpp::File *mxf_file, mxfpp::Partition *header_partition);
+    OPAtomTrackReader(std::string filename, std::string index_filename, mxfpp::File *mxf_file,
+                      mxfpp::Partition *header_partition);
     
 private:
     std::string mFilename;
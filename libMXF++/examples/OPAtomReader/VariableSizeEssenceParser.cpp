@@ -24,6 +24,8 @@
  * 02110-1301, USA
  */
 
+#include <cstring>
+
 #include <libMXF++/MXF.h>
 
 #include <mxf/mxf_labels_and_keys.h>
@@ -35,6 +37,10 @@ using namespace std;
 using namespace mxfpp;
 
 
+// read buffer size used when parsing the MJPEG essence to build the index table
+#define MJPEG_PARSE_BUFFER_SIZE     (256 * 1024)
+
+
 
 MJPEGParseState::MJPEGParseState()
 {
@@ -197,7 +203,7 @@ bool VariableSizeEssenceParser::Seek(int64_t position)
     
     int64_t frame_offset;
     if (!mIndexTable->haveFrameOffset(position)) {
-        if (mIndexTableIsComplete || !UpdateIndexTable(&mSeekData, position))
+        if (mIndexTableIsComplete || !UpdateIndexTable(0, position))
             return false;
 
         frame_offset = mIndexTable->getFrameOffset(position);
@@ -231,7 +237,7 @@ int64_t VariableSizeEssenceParser::DetermineDuration()
 
     while (!mIndexTableIsComplete) {
         indexed_position++;
-        UpdateIndexTable(&mSeekData, indexed_position);
+        UpdateIndexTable(0, indexed_position);
     }
     
     Seek(current_position);
@@ -239,6 +245,15 @@ int64_t VariableSizeEssenceParser::DetermineDuration()
     return mDuration;
 }
 
+bool VariableSizeEssenceParser::SaveIndexTable(string filename)
+{
+    // the index table must be complete before it can be re-used
+    if (DetermineDuration() < 0)
+        return false;
+    
+    return mIndexTable->save(filename, mEssenceLength);
+}
+
 uint32_t VariableSizeEssenceParser::DetermineUncFrameSize(const FileDescriptor *file_descriptor)
 {
     const CDCIEssenceDescriptor *cdci_descriptor =
@@ -296,28 +311,42 @@ uint32_t VariableSizeEssenceParser::DetermineUncFrameSize(const FileDescriptor *
     return (uint32_t)(field_factor * stored_width * stored_height * (1 + 2.0 / (h_subsamp * v_subsamp)) + 0.5);
 }
 
-bool VariableSizeEssenceParser::ParseMJPEGImage(DynamicByteArray *image_data)
+bool VariableSizeEssenceParser::ParseMJPEGImage(DynamicByteArray *image_data, uint32_t *image_size)
 {
     bool have_image = false;
     bool process_result;
+    uint32_t read_size;
     uint32_t num_read;
     
-    mMJPEGParseState.buffer.minAllocate(4096);
+    mMJPEGParseState.buffer.minAllocate(MJPEG_PARSE_BUFFER_SIZE);
     
-    image_data->setSize(0);
-    if (mFrameSizeEstimate > 0)
-        image_data->minAllocate(mFrameSizeEstimate);
+    *image_size = 0;
+    if (image_data) {
+        image_data->setSize(0);
+        if (mFrameSizeEstimate > 0)
+            image_data->minAllocate(mFrameSizeEstimate);
+    }
     
     while (true) {
-        process_result = ProcessMJPEGImageData(image_data, &have_image);
+        process_result = ProcessMJPEGImageData(image_data, image_size, &have_image);
         if (!process_result)
             return false;
         
         if (have_image)
             return true;
         
+        // don't read beyond the end of the essence data into the following KLVs
         mMJPEGParseState.buffer.setSize(0);
-        num_read = mFile->read(mMJPEGParseState.buffer.getBytes(), mMJPEGParseState.buffer.getSizeAvailable());
+        read_size = mMJPEGParseState.buffer.getSizeAvailable();
+        if (mEssenceLength > 0) {
+            int64_t remaining = mEssenceStartOffset + mEssenceLength - mFile->tell();
+            if (remaining <= 0)
+                return false; // EOF
+            if (remaining < (int64_t)read_size)
+                read_size = (uint32_t)remaining;
+        }
+        
+        num_read = mFile->read(mMJPEGParseState.buffer.getBytes(), read_size);
         if (num_read == 0)
             return false; // EOF if nothing was read
         
@@ -329,11 +358,17 @@ bool VariableSizeEssenceParser::ParseMJPEGImage(DynamicByteArray *image_data)
     return false; // for the compiler
 }
 
-bool VariableSizeEssenceParser::ProcessMJPEGImageData(DynamicByteArray *image_data, bool *have_image)
+bool VariableSizeEssenceParser::ProcessMJPEGImageData(DynamicByteArray *image_data, uint32_t *image_size,
+                                                      bool *have_image)
 {
+    const unsigned char *bytes = mMJPEGParseState.buffer.getBytes();
+    uint32_t size = mMJPEGParseState.buffer.getSize();
+    const unsigned char *marker;
+    uint32_t skip;
+    
     *have_image = false;
     
-    if (mMJPEGParseState.buffer.getSize() == 0)
+    if (size == 0)
         return true;
     
     // locate start and end of image
@@ -353,8 +388,11 @@ bool VariableSizeEssenceParser::ProcessMJPEGImageData(DynamicByteArray *image_da
     // 3 -> 0 (data == 0xd9)
     // 3 -> 2 (data >= 0xd0 && data <= 0xd7 || data == 0x01 || data == 0x00)
     // 3 -> 4 (else and data != 0xff)
+    //
+    // the search in state 2 (entropy coded data) and the skip in state 4 (marker segment data) account for
+    // almost all the bytes and are done in bulk using memchr and the segment length respectively
     
-    while (!(*have_image) && mMJPEGParseState.position < mMJPEGParseState.buffer.getSize())
+    while (!(*have_image) && mMJPEGParseState.position < size)
     {
         switch (mMJPEGParseState.marker_state)
         {
@@ -373,9 +411,15 @@ bool VariableSizeEssenceParser::ProcessMJPEGImageData(DynamicByteArray *image_da
                     mMJPEGParseState.marker_state = 0;
                 break;
             case 2:
-                if (mMJPEGParseState.buffer[mMJPEGParseState.position] == 0xff)
-                    mMJPEGParseState.marker_state = 3;
-                // else wait here
+                marker = (const unsigned char*)memchr(&bytes[mMJPEGParseState.position], 0xff,
+                                                      size - mMJPEGParseState.position);
+                if (!marker) {
+                    // wait here for the next buffer
+                    mMJPEGParseState.position = size;
+                    continue;
+                }
+                mMJPEGParseState.position = (uint32_t)(marker - bytes);
+                mMJPEGParseState.marker_state = 3;
                 break;
             case 3:
                 if (mMJPEGParseState.buffer[mMJPEGParseState.position] == 0xD9) { // end of field
@@ -400,6 +444,17 @@ bool VariableSizeEssenceParser::ProcessMJPEGImageData(DynamicByteArray *image_da
                 }
                 break;
             case 4:
+                if (mMJPEGParseState.have_len_byte2 && mMJPEGParseState.skip_count > 0) {
+                    skip = size - mMJPEGParseState.position;
+                    if ((uint32_t)mMJPEGParseState.skip_count < skip)
+                        skip = mMJPEGParseState.skip_count;
+                    mMJPEGParseState.skip_count -= skip;
+                    mMJPEGParseState.position += skip;
+                    if (mMJPEGParseState.skip_count == 0)
+                        mMJPEGParseState.marker_state = 2;
+                    continue;
+                }
+                
                 if (!mMJPEGParseState.have_len_byte1) {
                     mMJPEGParseState.have_len_byte1 = true;
                     mMJPEGParseState.skip_count = mMJPEGParseState.buffer[mMJPEGParseState.position] << 8;
@@ -434,8 +489,11 @@ bool VariableSizeEssenceParser::ProcessMJPEGImageData(DynamicByteArray *image_da
         }
     }
     
-    image_data->append(&mMJPEGParseState.buffer[mMJPEGParseState.prev_position],
-                       mMJPEGParseState.position - mMJPEGParseState.prev_position); 
+    if (image_data) {
+        image_data->append(&mMJPEGParseState.buffer[mMJPEGParseState.prev_position],
+                           mMJPEGParseState.position - mMJPEGParseState.prev_position);
+    }
+    *image_size += mMJPEGParseState.position - mMJPEGParseState.prev_position;
     
     mMJPEGParseState.prev_position = mMJPEGParseState.position;
     
@@ -456,11 +514,12 @@ bool VariableSizeEssenceParser::UpdateIndexTable(DynamicByteArray *image_data, i
     if (indexed_position != mPosition)
         MXFPP_CHECK(Seek(indexed_position));
     
+    uint32_t image_size;
     while (indexed_position < position) {
-        if (!ParseMJPEGImage(image_data))
+        if (!ParseMJPEGImage(image_data, &image_size))
             break;
         
-        offset += image_data->getSize();
+        offset += image_size;
         mIndexTable->appendFrameOffset(offset);
         
         indexed_position++;
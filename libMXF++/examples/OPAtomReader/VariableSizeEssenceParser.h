@@ -27,6 +27,8 @@
 #ifndef __VARIABLE_SIZE_ESSENCE_PARSER_H__
 #define __VARIABLE_SIZE_ESSENCE_PARSER_H__
 
+#include <string>
+
 #include "RawEssenceParser.h"
 
 
@@ -68,10 +70,13 @@ public:
     virtual bool Seek(int64_t position);
     virtual int64_t DetermineDuration();
 
+public:
+    bool SaveIndexTable(std::string filename);
+
 private:
     uint32_t DetermineUncFrameSize(const mxfpp::FileDescriptor *file_descriptor);
-    bool ParseMJPEGImage(DynamicByteArray *image_data);
-    bool ProcessMJPEGImageData(DynamicByteArray *image_data, bool *have_image);
+    bool ParseMJPEGImage(DynamicByteArray *image_data, uint32_t *image_size);
+    bool ProcessMJPEGImageData(DynamicByteArray *image_data, uint32_t *image_size, bool *have_image);
     bool UpdateIndexTable(DynamicByteArray *image_data, int64_t position);
 
 private:
@@ -82,8 +87,6 @@ private:
     uint32_t mFrameSizeEstimate;
     
     MJPEGParseState mMJPEGParseState;
-    
-    DynamicByteArray mSeekData;
 };
 
 
@@ -0,0 +1,45 @@
+/*
+ * $Id$
+ *
+ * CRC-32 used for the Archive MXF content package elements
+ *
+ * Copyright (C) 2012  British Broadcasting Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __ARCHIVE_CRC32_H__
+#define __ARCHIVE_CRC32_H__
+
+#ifdef __cplusplus
+extern "C" 
+{
+#endif
+
+
+#include <mxf/mxf_types.h>
+
+
+/* returns the CRC-32 (ISO 3309, as used in PNG and zlib) of data continuing from crc32, which is 0
+   for the first call. The data is processed 8 bytes at a time using the slice-by-8 tables */
+uint32_t archive_crc32(uint32_t crc32, const uint8_t* data, size_t size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif
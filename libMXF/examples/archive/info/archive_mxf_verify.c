@@ -0,0 +1,673 @@
+/*
+ * $Id$
+ *
+ * Verify the CRC-32s in the content packages of an Archive MXF file
+ *
+ * Copyright (C) 2012  British Broadcasting Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <archive_mxf_verify.h>
+#include <archive_crc32.h>
+#include <mxf/mxf.h>
+
+
+/* the file is read into one of the buffers while the content packages in the others are being checked */
+#define BUFFER_SIZE             (16 * 1024 * 1024)
+
+/* elements are checked in batches to limit the thread synchronisation */
+#define MAX_BATCH_ELEMENTS      64
+#define MAX_BATCH_SIZE          (2 * 1024 * 1024)
+
+/* 1 video and up to 8 audio elements */
+#define MAX_CRC32               9
+
+
+typedef struct
+{
+    const uint8_t* data;
+    uint32_t size;
+    uint32_t crc32;
+    int64_t frame;
+} ElementCheck;
+
+typedef struct
+{
+    uint8_t* data;
+    uint32_t size;
+    int numPendingBatches;
+} Buffer;
+
+typedef struct Batch
+{
+    struct Batch* next;
+    Buffer* buffer;
+    ElementCheck elements[MAX_BATCH_ELEMENTS];
+    int numElements;
+    uint32_t size;
+} Batch;
+
+struct ArchiveMXFVerify
+{
+    pthread_t* threads;
+    int numThreads;
+    int stopping;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t batchReadyCond;
+    pthread_cond_t batchDoneCond;
+    Batch* firstBatch;
+    Batch* lastBatch;
+    Batch* freeBatches;
+
+    Buffer* buffers;
+    int numBuffers;
+    int bufferIndex;
+    uint32_t parsePos;
+    uint64_t skipSize;
+
+    Batch* batch;
+
+    int64_t frame;
+    uint32_t crc32[MAX_CRC32];
+    int numCRC32;
+
+    ArchiveMXFVerifyResult result;
+};
+
+
+static const mxfKey g_SysItemElementKey = MXF_SS1_ELEMENT_KEY(0x01, 0x00);
+
+/* generic container picture and sound element key, excluding the registry version */
+static const uint8_t g_GCElementKeyPrefix[12] =
+    {0x06, 0x0e, 0x2b, 0x34, 0x01, 0x02, 0x01, 0x00, 0x0d, 0x01, 0x03, 0x01};
+
+
+
+static void check_batch(ArchiveMXFVerify* verify, Batch* batch)
+{
+    int64_t numErrors = 0;
+    int64_t firstErrorFrame = -1;
+    uint32_t crc32;
+    int i;
+
+    for (i = 0; i < batch->numElements; i++)
+    {
+        crc32 = archive_crc32(0, batch->elements[i].data, batch->elements[i].size);
+        if (crc32 != batch->elements[i].crc32)
+        {
+            mxf_log_error("CRC-32 mismatch in frame %"PFi64": calculated 0x%08x, expected 0x%08x\n",
+                batch->elements[i].frame, crc32, batch->elements[i].crc32);
+            if (numErrors == 0)
+            {
+                firstErrorFrame = batch->elements[i].frame;
+            }
+            numErrors++;
+        }
+    }
+
+    pthread_mutex_lock(&verify->mutex);
+
+    if (numErrors > 0)
+    {
+        verify->result.numCRC32Errors += numErrors;
+        if (verify->result.firstErrorFrame < 0 || firstErrorFrame < verify->result.firstErrorFrame)
+        {
+            verify->result.firstErrorFrame = firstErrorFrame;
+        }
+    }
+
+    batch->buffer->numPendingBatches--;
+    batch->next = verify->freeBatches;
+    verify->freeBatches = batch;
+    pthread_cond_broadcast(&verify->batchDoneCond);
+
+    pthread_mutex_unlock(&verify->mutex);
+}
+
+static void* check_thread(void* arg)
+{
+    ArchiveMXFVerify* verify = (ArchiveMXFVerify*)arg;
+    Batch* batch;
+
+    pthread_mutex_lock(&verify->mutex);
+    while (1)
+    {
+        while (!verify->stopping && verify->firstBatch == NULL)
+        {
+            pthread_cond_wait(&verify->batchReadyCond, &verify->mutex);
+        }
+        if (verify->stopping)
+        {
+            break;
+        }
+
+        batch = verify->firstBatch;
+        verify->firstBatch = batch->next;
+        if (verify->firstBatch == NULL)
+        {
+            verify->lastBatch = NULL;
+        }
+
+        pthread_mutex_unlock(&verify->mutex);
+        check_batch(verify, batch);
+        pthread_mutex_lock(&verify->mutex);
+    }
+    pthread_mutex_unlock(&verify->mutex);
+
+    return NULL;
+}
+
+static void dispatch_batch(ArchiveMXFVerify* verify)
+{
+    Batch* batch = verify->batch;
+
+    if (batch == NULL)
+    {
+        return;
+    }
+    verify->batch = NULL;
+
+    pthread_mutex_lock(&verify->mutex);
+    batch->buffer->numPendingBatches++;
+    if (verify->numThreads > 0)
+    {
+        batch->next = NULL;
+        if (verify->lastBatch == NULL)
+        {
+            verify->firstBatch = batch;
+        }
+        else
+        {
+            verify->lastBatch->next = batch;
+        }
+        verify->lastBatch = batch;
+        pthread_cond_signal(&verify->batchReadyCond);
+    }
+    pthread_mutex_unlock(&verify->mutex);
+
+    if (verify->numThreads == 0)
+    {
+        check_batch(verify, batch);
+    }
+}
+
+static int add_element_check(ArchiveMXFVerify* verify, const uint8_t* data, uint32_t size, uint32_t crc32)
+{
+    Batch* batch;
+
+    if (verify->batch == NULL)
+    {
+        pthread_mutex_lock(&verify->mutex);
+        batch = verify->freeBatches;
+        if (batch != NULL)
+        {
+            verify->freeBatches = batch->next;
+        }
+        pthread_mutex_unlock(&verify->mutex);
+
+        if (batch == NULL)
+        {
+            CHK_MALLOC_ORET(batch, Batch);
+        }
+        batch->buffer = &verify->buffers[verify->bufferIndex];
+        batch->numElements = 0;
+        batch->size = 0;
+        verify->batch = batch;
+    }
+
+    batch = verify->batch;
+    batch->elements[batch->numElements].data = data;
+    batch->elements[batch->numElements].size = size;
+    batch->elements[batch->numElements].crc32 = crc32;
+    batch->elements[batch->numElements].frame = verify->frame;
+    batch->numElements++;
+    batch->size += size;
+
+    if (batch->numElements == MAX_BATCH_ELEMENTS || batch->size >= MAX_BATCH_SIZE)
+    {
+        dispatch_batch(verify);
+    }
+
+    return 1;
+}
+
+static void wait_for_buffer(ArchiveMXFVerify* verify, Buffer* buffer)
+{
+    pthread_mutex_lock(&verify->mutex);
+    while (buffer->numPendingBatches > 0)
+    {
+        pthread_cond_wait(&verify->batchDoneCond, &verify->mutex);
+    }
+    pthread_mutex_unlock(&verify->mutex);
+}
+
+/* moves the unparsed data at the end of the full buffer to the start of the next buffer */
+static int next_buffer(ArchiveMXFVerify* verify)
+{
+    Buffer* buffer = &verify->buffers[verify->bufferIndex];
+    Buffer* nextBuffer = &verify->buffers[(verify->bufferIndex + 1) % verify->numBuffers];
+    uint32_t remainder = buffer->size - verify->parsePos;
+
+    if (remainder == BUFFER_SIZE)
+    {
+        mxf_log_error("Archive MXF KLV is larger than the %d byte verify buffer" LOG_LOC_FORMAT,
+            BUFFER_SIZE, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    dispatch_batch(verify);
+    wait_for_buffer(verify, nextBuffer);
+
+    memcpy(nextBuffer->data, &buffer->data[verify->parsePos], remainder);
+    nextBuffer->size = remainder;
+    verify->parsePos = 0;
+    verify->bufferIndex = (verify->bufferIndex + 1) % verify->numBuffers;
+
+    return 1;
+}
+
+static int parse_system_item(ArchiveMXFVerify* verify, const uint8_t* value, uint64_t len)
+{
+    uint16_t localTag;
+    uint16_t localItemLen;
+    uint32_t arrayLen;
+    uint32_t arrayItemLen;
+    uint32_t i;
+
+    verify->frame++;
+    verify->result.numFrames++;
+    verify->numCRC32 = 0;
+
+    while (len >= 4)
+    {
+        mxf_get_uint16(value, &localTag);
+        mxf_get_uint16(value + 2, &localItemLen);
+        value += 4;
+        len -= 4;
+        CHK_ORET(localItemLen <= len);
+
+        if (localTag == 0xffff)
+        {
+            /* Archive MXF CRC-32 array */
+            CHK_ORET(localItemLen >= 8);
+            mxf_get_array_header(value, &arrayLen, &arrayItemLen);
+            CHK_ORET(arrayItemLen == 4 && arrayLen <= MAX_CRC32 && 8 + arrayLen * 4 <= localItemLen);
+            for (i = 0; i < arrayLen; i++)
+            {
+                mxf_get_uint32(value + 8 + i * 4, &verify->crc32[i]);
+            }
+            verify->numCRC32 = arrayLen;
+        }
+
+        value += localItemLen;
+        len -= localItemLen;
+    }
+
+    if (verify->numCRC32 == 0)
+    {
+        verify->result.numFramesWithoutCRC32++;
+    }
+
+    return 1;
+}
+
+/* parses the complete KLVs in the buffer and adds the video and audio elements to the check batches */
+static int parse_buffer(ArchiveMXFVerify* verify)
+{
+    Buffer* buffer = &verify->buffers[verify->bufferIndex];
+    const uint8_t* klv;
+    uint32_t available;
+    uint8_t llen;
+    uint64_t len;
+    uint32_t klSize;
+    int crc32Index;
+    int i;
+
+    while (1)
+    {
+        available = buffer->size - verify->parsePos;
+
+        if (verify->skipSize > 0)
+        {
+            if (verify->skipSize > available)
+            {
+                verify->parsePos += available;
+                verify->skipSize -= available;
+                return 1;
+            }
+            verify->parsePos += (uint32_t)verify->skipSize;
+            verify->skipSize = 0;
+            continue;
+        }
+
+        if (available < 17)
+        {
+            return 1;
+        }
+        klv = &buffer->data[verify->parsePos];
+
+        if (klv[0] != 0x06 || klv[1] != 0x0e || klv[2] != 0x2b || klv[3] != 0x34)
+        {
+            mxf_log_error("Invalid KLV key in Archive MXF data" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+            return 0;
+        }
+
+        if (klv[16] < 0x80)
+        {
+            llen = 1;
+            len = klv[16];
+        }
+        else
+        {
+            llen = 1 + (klv[16] & 0x7f);
+            if (llen > 9)
+            {
+                mxf_log_error("Invalid KLV length in Archive MXF data" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+                return 0;
+            }
+            if (available < 16 + (uint32_t)llen)
+            {
+                return 1;
+            }
+            len = 0;
+            for (i = 1; i < llen; i++)
+            {
+                len = (len << 8) | klv[16 + i];
+            }
+        }
+        klSize = 16 + llen;
+
+
+        crc32Index = -1;
+        if (memcmp(klv, g_GCElementKeyPrefix, 7) == 0 &&
+            memcmp(&klv[8], &g_GCElementKeyPrefix[8], 4) == 0)
+        {
+            if (klv[12] == 0x15)
+            {
+                /* video element CRC-32 is the first in the array */
+                crc32Index = 0;
+            }
+            else if (klv[12] == 0x16)
+            {
+                /* followed by the audio elements, numbered from 1 */
+                crc32Index = klv[15];
+            }
+        }
+
+        if (mxf_equals_key_mod_regver((const mxfKey*)klv, &g_SysItemElementKey))
+        {
+            if (len > available - klSize)
+            {
+                return 1;
+            }
+            CHK_ORET(parse_system_item(verify, klv + klSize, len));
+        }
+        else if (crc32Index >= 0 && crc32Index < verify->numCRC32)
+        {
+            if (len > available - klSize)
+            {
+                return 1;
+            }
+            CHK_ORET(add_element_check(verify, klv + klSize, (uint32_t)len, verify->crc32[crc32Index]));
+        }
+        else
+        {
+            verify->parsePos += klSize;
+            verify->skipSize = len;
+            continue;
+        }
+
+        verify->parsePos += klSize + (uint32_t)len;
+    }
+}
+
+static void reset_verify(ArchiveMXFVerify* verify)
+{
+    int i;
+
+    for (i = 0; i < verify->numBuffers; i++)
+    {
+        verify->buffers[i].size = 0;
+    }
+    verify->bufferIndex = 0;
+    verify->parsePos = 0;
+    verify->skipSize = 0;
+
+    verify->frame = -1;
+    verify->numCRC32 = 0;
+
+    memset(&verify->result, 0, sizeof(verify->result));
+    verify->result.firstErrorFrame = -1;
+}
+
+
+int archive_mxf_create_verify(int numThreads, ArchiveMXFVerify** verify)
+{
+    ArchiveMXFVerify* newVerify;
+    int i;
+
+    CHK_MALLOC_ORET(newVerify, ArchiveMXFVerify);
+    memset(newVerify, 0, sizeof(ArchiveMXFVerify));
+    pthread_mutex_init(&newVerify->mutex, NULL);
+    pthread_cond_init(&newVerify->batchReadyCond, NULL);
+    pthread_cond_init(&newVerify->batchDoneCond, NULL);
+
+    /* one buffer being filled and one being checked in each thread */
+    newVerify->numBuffers = numThreads + 1;
+    if (newVerify->numBuffers < 2)
+    {
+        newVerify->numBuffers = 2;
+    }
+    CHK_MALLOC_ARRAY_OFAIL(newVerify->buffers, Buffer, newVerify->numBuffers);
+    memset(newVerify->buffers, 0, sizeof(Buffer) * newVerify->numBuffers);
+    for (i = 0; i < newVerify->numBuffers; i++)
+    {
+        CHK_MALLOC_ARRAY_OFAIL(newVerify->buffers[i].data, uint8_t, BUFFER_SIZE);
+    }
+
+    if (numThreads > 0)
+    {
+        CHK_MALLOC_ARRAY_OFAIL(newVerify->threads, pthread_t, numThreads);
+        for (i = 0; i < numThreads; i++)
+        {
+            CHK_OFAIL(pthread_create(&newVerify->threads[i], NULL, check_thread, newVerify) == 0);
+            newVerify->numThreads++;
+        }
+    }
+
+    reset_verify(newVerify);
+
+    *verify = newVerify;
+    return 1;
+
+fail:
+    archive_mxf_free_verify(&newVerify);
+    return 0;
+}
+
+void archive_mxf_free_verify(ArchiveMXFVerify** verify)
+{
+    Batch* batch;
+    int i;
+
+    if (*verify == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&(*verify)->mutex);
+    (*verify)->stopping = 1;
+    pthread_cond_broadcast(&(*verify)->batchReadyCond);
+    pthread_mutex_unlock(&(*verify)->mutex);
+    for (i = 0; i < (*verify)->numThreads; i++)
+    {
+        pthread_join((*verify)->threads[i], NULL);
+    }
+    SAFE_FREE(&(*verify)->threads);
+
+    SAFE_FREE(&(*verify)->batch);
+    while ((*verify)->firstBatch != NULL)
+    {
+        batch = (*verify)->firstBatch;
+        (*verify)->firstBatch = batch->next;
+        free(batch);
+    }
+    while ((*verify)->freeBatches != NULL)
+    {
+        batch = (*verify)->freeBatches;
+        (*verify)->freeBatches = batch->next;
+        free(batch);
+    }
+
+    if ((*verify)->buffers != NULL)
+    {
+        for (i = 0; i < (*verify)->numBuffers; i++)
+        {
+            SAFE_FREE(&(*verify)->buffers[i].data);
+        }
+        SAFE_FREE(&(*verify)->buffers);
+    }
+
+    pthread_mutex_destroy(&(*verify)->mutex);
+    pthread_cond_destroy(&(*verify)->batchReadyCond);
+    pthread_cond_destroy(&(*verify)->batchDoneCond);
+
+    SAFE_FREE(verify);
+}
+
+int archive_mxf_verify_data(ArchiveMXFVerify* verify, const uint8_t* data, uint32_t size)
+{
+    Buffer* buffer;
+    uint32_t copySize;
+
+    while (size > 0)
+    {
+        buffer = &verify->buffers[verify->bufferIndex];
+        if (buffer->size == BUFFER_SIZE)
+        {
+            CHK_ORET(next_buffer(verify));
+            buffer = &verify->buffers[verify->bufferIndex];
+        }
+
+        copySize = BUFFER_SIZE - buffer->size;
+        if (copySize > size)
+        {
+            copySize = size;
+        }
+        memcpy(&buffer->data[buffer->size], data, copySize);
+        buffer->size += copySize;
+        data += copySize;
+        size -= copySize;
+
+        CHK_ORET(parse_buffer(verify));
+    }
+
+    return 1;
+}
+
+int archive_mxf_verify_complete(ArchiveMXFVerify* verify, ArchiveMXFVerifyResult* result)
+{
+    Buffer* buffer = &verify->buffers[verify->bufferIndex];
+    int complete;
+    int i;
+
+    complete = (verify->parsePos == buffer->size && verify->skipSize == 0);
+    if (!complete)
+    {
+        mxf_log_error("Archive MXF data ends in the middle of a KLV\n");
+    }
+
+    dispatch_batch(verify);
+    for (i = 0; i < verify->numBuffers; i++)
+    {
+        wait_for_buffer(verify, &verify->buffers[i]);
+    }
+
+    *result = verify->result;
+
+    reset_verify(verify);
+
+    return complete;
+}
+
+int archive_mxf_verify_file(const char* filename, int numThreads, ArchiveMXFVerifyResult* result)
+{
+    ArchiveMXFVerify* verify = NULL;
+    Buffer* buffer;
+    ssize_t numRead;
+    int fd = -1;
+
+    if ((fd = open(filename, O_RDONLY)) == -1)
+    {
+        mxf_log_error("Failed to open '%s': %s\n", filename, strerror(errno));
+        return 0;
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    CHK_OFAIL(archive_mxf_create_verify(numThreads, &verify));
+
+    /* read directly into the verify buffers */
+    while (1)
+    {
+        buffer = &verify->buffers[verify->bufferIndex];
+        if (buffer->size == BUFFER_SIZE)
+        {
+            CHK_OFAIL(next_buffer(verify));
+            buffer = &verify->buffers[verify->bufferIndex];
+        }
+
+        numRead = read(fd, &buffer->data[buffer->size], BUFFER_SIZE - buffer->size);
+        if (numRead < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            mxf_log_error("Failed to read from '%s': %s\n", filename, strerror(errno));
+            goto fail;
+        }
+        else if (numRead == 0)
+        {
+            break;
+        }
+        buffer->size += (uint32_t)numRead;
+
+        CHK_OFAIL(parse_buffer(verify));
+    }
+
+    CHK_OFAIL(archive_mxf_verify_complete(verify, result));
+
+    archive_mxf_free_verify(&verify);
+    close(fd);
+    return 1;
+
+fail:
+    archive_mxf_free_verify(&verify);
+    close(fd);
+    return 0;
+}
+
@@ -0,0 +1,71 @@
+/*
+ * $Id$
+ *
+ * Verify the CRC-32s in the content packages of an Archive MXF file
+ *
+ * Copyright (C) 2012  British Broadcasting Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __ARCHIVE_MXF_VERIFY_H__
+#define __ARCHIVE_MXF_VERIFY_H__
+
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+#include <mxf/mxf_types.h>
+
+
+typedef struct
+{
+    int64_t numFrames;
+    int64_t numFramesWithoutCRC32;
+    int64_t numCRC32Errors;     /* number of video and audio elements with a CRC-32 mismatch */
+    int64_t firstErrorFrame;    /* -1 if there are no errors */
+} ArchiveMXFVerifyResult;
+
+typedef struct ArchiveMXFVerify ArchiveMXFVerify;
+
+
+/* The file data is passed in sequentially, either read from a file in large blocks or inline as the
+   file is being transferred, and the video and audio element CRC-32s are checked in numThreads threads.
+   numThreads 0 checks the CRC-32s in the calling thread */
+int archive_mxf_create_verify(int numThreads, ArchiveMXFVerify** verify);
+void archive_mxf_free_verify(ArchiveMXFVerify** verify);
+
+/* the next size bytes of the file, starting with the header partition pack */
+int archive_mxf_verify_data(ArchiveMXFVerify* verify, const uint8_t* data, uint32_t size);
+
+/* waits for the checks to complete and returns the result. Returns 0 if the file was not complete.
+   The verify can then be used for another file */
+int archive_mxf_verify_complete(ArchiveMXFVerify* verify, ArchiveMXFVerifyResult* result);
+
+
+int archive_mxf_verify_file(const char* filename, int numThreads, ArchiveMXFVerifyResult* result);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+
+#endif
+
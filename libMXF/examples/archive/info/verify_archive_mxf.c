@@ -0,0 +1,114 @@
+/*
+ * $Id$
+ *
+ * Verify the CRC-32s in the content packages of Archive MXF files
+ *
+ * Copyright (C) 2012  British Broadcasting Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <archive_mxf_verify.h>
+#include <mxf/mxf.h>
+
+
+static void usage(const char* cmd)
+{
+    fprintf(stderr, "Usage: %s <<options>> <mxf filename>+\n", cmd);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -h, --help               display this usage message\n");
+    fprintf(stderr, "  -t, --threads <num>      number of CRC-32 check threads (default 2)\n");
+}
+
+int main(int argc, const char* argv[])
+{
+    ArchiveMXFVerifyResult result;
+    int numThreads = 2;
+    int cmdlnIndex = 1;
+    int numFailed = 0;
+
+    while (cmdlnIndex < argc)
+    {
+        if (strcmp(argv[cmdlnIndex], "-h") == 0 ||
+            strcmp(argv[cmdlnIndex], "--help") == 0)
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        else if (strcmp(argv[cmdlnIndex], "-t") == 0 ||
+            strcmp(argv[cmdlnIndex], "--threads") == 0)
+        {
+            if (cmdlnIndex + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for %s\n", argv[cmdlnIndex]);
+                return 1;
+            }
+            if (sscanf(argv[cmdlnIndex + 1], "%d", &numThreads) != 1 || numThreads < 0)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid argument for %s\n", argv[cmdlnIndex]);
+                return 1;
+            }
+            cmdlnIndex += 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (cmdlnIndex >= argc)
+    {
+        usage(argv[0]);
+        fprintf(stderr, "Missing mxf filename\n");
+        return 1;
+    }
+
+
+    for (; cmdlnIndex < argc; cmdlnIndex++)
+    {
+        if (!archive_mxf_verify_file(argv[cmdlnIndex], numThreads, &result))
+        {
+            fprintf(stderr, "%s: failed to verify\n", argv[cmdlnIndex]);
+            numFailed++;
+            continue;
+        }
+
+        if (result.numCRC32Errors > 0)
+        {
+            printf("%s: FAILED: %"PFi64" CRC-32 errors in %"PFi64" frames, first in frame %"PFi64"\n",
+                argv[cmdlnIndex], result.numCRC32Errors, result.numFrames, result.firstErrorFrame);
+            numFailed++;
+        }
+        else if (result.numFramesWithoutCRC32 == result.numFrames)
+        {
+            printf("%s: no CRC-32s in %"PFi64" frames\n", argv[cmdlnIndex], result.numFrames);
+        }
+        else
+        {
+            printf("%s: OK: %"PFi64" frames (%"PFi64" without CRC-32s)\n",
+                argv[cmdlnIndex], result.numFrames, result.numFramesWithoutCRC32);
+        }
+    }
+
+    return numFailed > 0 ? 1 : 0;
+}
+
@@ -60,6 +60,12 @@ struct _FileIndex
     mxfKey nextKey;
     uint8_t nextLLen;
     uint64_t nextLen;
+    
+    /* state for tracking content packages appended to a file that is still being written */
+    int64_t growingFileSize; /* file size at the last update, -1 if not yet updated */
+    int64_t growingScanPos; /* file position of the next KL not yet scanned */
+    long growingPartition; /* index entry for the partition containing growingScanPos */
+    mxfLength growingDuration; /* number of complete content packages found */
 };
 
 
@@ -116,6 +122,7 @@ static int create_partition_index_entry(MXFFile* mxfFile, MXFPartition** partiti
     memset(newEntry, 0, sizeof(PartitionIndexEntry));
     newEntry->partitionDataStartPos = -1;
     newEntry->essenceStartPos = -1;
+    newEntry->numContentPackages = -1;
     newEntry->startPosition = -1;
     newEntry->partitionStartPos = mxf_get_runin_len(mxfFile) + (*partition)->thisPartition;
     CHK_OFAIL((newEntry->partitionDataStartPos = mxf_file_tell(mxfFile)) >= 0);
@@ -142,6 +149,7 @@ static int add_partition_index_entry(MXFFile* mxfFile, FileIndex* index, const m
     PartitionIndexEntry* newEntry = NULL;
     PartitionIndexEntry* prevEntry = NULL;
     PartitionIndexEntry* prevEssenceEntry = NULL;
+    PartitionIndexEntry* addedEntry;
     long numPartitions;
     long i;
 
@@ -171,8 +179,21 @@ static int add_partition_index_entry(MXFFile* mxfFile, FileIndex* index, const m
         if (prevEssenceEntry != NULL)
         {
             /* calculate the number of content packages of previous entry */
-            prevEssenceEntry->numContentPackages = (newEntry->partitionStartPos - prevEssenceEntry->essenceStartPos) / 
-                index->contentPackageLen;
+            /* Note: the count is only unknown for the last partition with essence and is 0 if no
+               content package was found in that partition */
+            if (prevEssenceEntry->numContentPackages < 0)
+            {
+                if (prevEssenceEntry->essenceStartPos >= 0)
+                {
+                    prevEssenceEntry->numContentPackages = (newEntry->partitionStartPos - 
+                        prevEssenceEntry->essenceStartPos) / index->contentPackageLen;
+                }
+                else
+                {
+                    prevEssenceEntry->numContentPackages = 0;
+                }
+                index->indexedDuration += prevEssenceEntry->numContentPackages;
+            }
             
             /* calculate the first frame number of the new entry if it contains essence */
             if (partition_has_essence(index, newEntry))
@@ -190,6 +211,7 @@ static int add_partition_index_entry(MXFFile* mxfFile, FileIndex* index, const m
         }
 
         CHK_OFAIL(mxf_append_list_element(&index->partitionIndex, newEntry));
+        addedEntry = newEntry;
         newEntry = NULL; /* list now owns it */
     }
     
@@ -198,6 +220,7 @@ static int add_partition_index_entry(MXFFile* mxfFile, FileIndex* index, const m
     else
     {
         CHK_OFAIL(mxf_prepend_list_element(&index->partitionIndex, newEntry));
+        addedEntry = newEntry;
         newEntry = NULL; /* list now owns it */
     }
     
@@ -208,7 +231,7 @@ static int add_partition_index_entry(MXFFile* mxfFile, FileIndex* index, const m
     }
     
     
-    *entry = newEntry;
+    *entry = addedEntry;
     return 1;
 
 fail:
@@ -440,7 +463,143 @@ static int complete_partition_index(MXFFile* mxfFile, FileIndex* index)
     }
     
     return 1;
-}    
+}
+
+static long find_partition_index_entry(FileIndex* index, int64_t partitionStartPos)
+{
+    PartitionIndexEntry* entry;
+    long i;
+    
+    for (i = mxf_get_list_length(&index->partitionIndex) - 1; i >= 0; i--)
+    {
+        entry = (PartitionIndexEntry*)mxf_get_list_element(&index->partitionIndex, i);
+        if (entry->partitionStartPos == partitionStartPos)
+        {
+            return i;
+        }
+        else if (entry->partitionStartPos < partitionStartPos)
+        {
+            break;
+        }
+    }
+    
+    return -1;
+}
+
+/* Scan the data written since the last update of a file that is still being written, counting the complete
+   content packages and adding new partitions to the index. Only the key at the start of each new content
+   package is read, and so the cost is constant per new frame */
+static int update_growing_index(MXFFile* mxfFile, FileIndex* index, int64_t fileSize)
+{
+    PartitionIndexEntry* entry = NULL;
+    int64_t numContentPackages;
+    int64_t i;
+    long entryIndex;
+    mxfKey key;
+    uint8_t llen;
+    uint64_t len;
+    
+    if (index->growingScanPos < 0)
+    {
+        /* start at the first content package in the last indexed partition with essence */
+        for (entryIndex = mxf_get_list_length(&index->partitionIndex) - 1; entryIndex >= 0; entryIndex--)
+        {
+            entry = (PartitionIndexEntry*)mxf_get_list_element(&index->partitionIndex, entryIndex);
+            if (partition_has_essence(index, entry))
+            {
+                break;
+            }
+        }
+        CHK_ORET(entryIndex >= 0 && entry->essenceStartPos >= 0 && entry->startPosition >= 0);
+        CHK_ORET(index->contentPackageLen > 0);
+        
+        index->growingPartition = entryIndex;
+        index->growingScanPos = entry->essenceStartPos;
+        index->growingDuration = entry->startPosition;
+    }
+    
+    while (!index->isComplete)
+    {
+        entry = (PartitionIndexEntry*)mxf_get_list_element(&index->partitionIndex, index->growingPartition);
+        
+        if (index->growingScanPos + mxfKey_extlen + 1 > fileSize)
+        {
+            /* KL not yet written */
+            break;
+        }
+        CHK_ORET(mxf_file_seek(mxfFile, index->growingScanPos, SEEK_SET));
+        if (!mxf_read_kl(mxfFile, &key, &llen, &len))
+        {
+            /* KL not yet written */
+            break;
+        }
+        
+        if (partition_has_essence(index, entry) && mxf_equals_key(&key, &index->startContentPackageKey))
+        {
+            if (entry->essenceStartPos < 0)
+            {
+                entry->essenceStartPos = index->growingScanPos;
+            }
+            
+            numContentPackages = (fileSize - index->growingScanPos) / (int64_t)index->contentPackageLen;
+            if (numContentPackages == 0)
+            {
+                /* content package not yet complete */
+                break;
+            }
+            
+            /* count the content packages up to the first one that doesn't start with the expected key, e.g. a 
+               partition pack. The key at every content package start is checked because a partition pack
+               and its index table segments could have a length that is a multiple of the content package length */
+            for (i = 1; i < numContentPackages; i++)
+            {
+                CHK_ORET(mxf_file_seek(mxfFile, index->growingScanPos + i * index->contentPackageLen, SEEK_SET));
+                if (!mxf_read_k(mxfFile, &key) || !mxf_equals_key(&key, &index->startContentPackageKey))
+                {
+                    numContentPackages = i;
+                    break;
+                }
+            }
+            
+            index->growingScanPos += numContentPackages * index->contentPackageLen;
+            index->growingDuration += numContentPackages;
+        }
+        else if (mxf_is_partition_pack(&key))
+        {
+            if (index->growingScanPos + mxfKey_extlen + llen + (int64_t)len > fileSize)
+            {
+                /* partition pack not yet complete */
+                break;
+            }
+            
+            /* the partition could already have been indexed by set_position */
+            entryIndex = find_partition_index_entry(index, index->growingScanPos);
+            if (entryIndex < 0)
+            {
+                CHK_ORET(add_partition_index_entry(mxfFile, index, &key, 1, &entry));
+                entryIndex = mxf_get_list_length(&index->partitionIndex) - 1;
+            }
+            else
+            {
+                entry = (PartitionIndexEntry*)mxf_get_list_element(&index->partitionIndex, entryIndex);
+            }
+            
+            index->growingPartition = entryIndex;
+            index->growingScanPos = entry->partitionDataStartPos;
+        }
+        else
+        {
+            /* skip filler, header metadata and index table segments */
+            if (index->growingScanPos + mxfKey_extlen + llen + (int64_t)len > fileSize)
+            {
+                break;
+            }
+            index->growingScanPos += mxfKey_extlen + llen + len;
+        }
+    }
+    
+    return 1;
+}
 
 
 
@@ -464,6 +623,8 @@ int create_index(MXFFile* mxfFile, MXFList* partitions, uint32_t indexSID, uint3
     newIndex->bodySID = bodySID;
     newIndex->currentPartition = -1;
     newIndex->currentPosition = -1;
+    newIndex->growingFileSize = -1;
+    newIndex->growingScanPos = -1;
     mxf_initialise_list(&newIndex->partitionIndex, free_partition_index_entry);
 
 
@@ -691,12 +852,12 @@ fail:
     return 0;
 }
 
-/* TODO/NOTE: this only works for a single partition !! */
 int64_t ix_get_last_written_frame_number(MXFFile* mxfFile, FileIndex* index, int64_t duration)
 {
-    PartitionIndexEntry* entry = NULL;
     int64_t fileSize;
+    int64_t filePos;
     int64_t targetPosition;
+    int result;
     
     if (duration == 0)
     {
@@ -710,26 +871,35 @@ int64_t ix_get_last_written_frame_number(MXFFile* mxfFile, FileIndex* index, int
         return index->indexedDuration - 1;
     }
     
-    if (mxf_get_list_length(&index->partitionIndex) != 1)
+    /* only scan the file if it has grown since the last call */
+    if ((fileSize = mxf_file_size(mxfFile)) < 0)
     {
-        /* only single partition with essence supported */
         return -1;
     }
-    
-    entry = (PartitionIndexEntry*)mxf_get_list_element(&index->partitionIndex, index->currentPartition);
-    if (!partition_has_essence(index, entry))
+    if (fileSize != index->growingFileSize)
     {
-        /* end of essence reached */
-        return -1;
+        if ((filePos = mxf_file_tell(mxfFile)) < 0)
+        {
+            return -1;
+        }
+        
+        result = update_growing_index(mxfFile, index, fileSize);
+        
+        /* the read position and next KL state are unchanged by the update */ 
+        if (!mxf_file_seek(mxfFile, filePos, SEEK_SET) || !result)
+        {
+            return -1;
+        }
+        index->growingFileSize = fileSize;
+        
+        if (index->isComplete)
+        {
+            /* footer partition was written */
+            return index->indexedDuration - 1;
+        }
     }
     
-    
-    /* get file size and calculate the furthest position */    
-    if ((fileSize = mxf_file_size(mxfFile)) < 0)
-    {
-        return -1;
-    }
-    targetPosition = entry->startPosition + ((fileSize - entry->essenceStartPos) / index->contentPackageLen) - 1;
+    targetPosition = index->growingDuration - 1;
     if (duration >= 0 && targetPosition >= duration)
     {
         targetPosition = duration - 1;
@@ -0,0 +1,273 @@
+/*
+ * $Id$
+ *
+ * Test the index of an OP-1A file that is still being written
+ *
+ * Copyright (C) 2012  British Broadcasting Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mxf/mxf.h>
+
+#include "mxf_index_helper.h"
+
+
+#define BODY_SID                1
+#define INDEX_SID               2
+
+/* a content package is a single element KLV */
+#define ELEMENT_LLEN            4
+#define ELEMENT_LEN             1000
+#define CONTENT_PACKAGE_LEN     (mxfKey_extlen + ELEMENT_LLEN + ELEMENT_LEN)
+
+
+static const mxfKey g_elementKey = MXF_GENERIC_CONTAINER_ELEMENT_KEY(0x01, 0x15, 0x01, 0x05, 0x01);
+
+
+/* the writer's data is flushed by the seek so that the reader sees it */
+static int flush_writer(MXFFile* writeFile)
+{
+    return mxf_file_seek(writeFile, 0, SEEK_END);
+}
+
+static int write_content_packages(MXFFile* writeFile, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        CHK_ORET(mxf_write_fixed_kl(writeFile, &g_elementKey, ELEMENT_LLEN, ELEMENT_LEN));
+        CHK_ORET(mxf_write_zeros(writeFile, ELEMENT_LEN));
+    }
+
+    return flush_writer(writeFile);
+}
+
+static int write_partial_content_package(MXFFile* writeFile)
+{
+    CHK_ORET(mxf_write_fixed_kl(writeFile, &g_elementKey, ELEMENT_LLEN, ELEMENT_LEN));
+    CHK_ORET(mxf_write_zeros(writeFile, ELEMENT_LEN / 2));
+
+    return flush_writer(writeFile);
+}
+
+static int complete_partial_content_package(MXFFile* writeFile)
+{
+    CHK_ORET(mxf_write_zeros(writeFile, ELEMENT_LEN - ELEMENT_LEN / 2));
+
+    return flush_writer(writeFile);
+}
+
+/* write a body partition pack and index table segment, filled so that their length is a multiple of the
+   content package length if alignCP is true */
+static int write_body_partition(MXFFile* writeFile, MXFFilePartitions* partitions, mxfPosition startPosition,
+    int alignCP)
+{
+    MXFPartition* partition;
+    MXFIndexTableSegment* segment = NULL;
+    int64_t partitionPos;
+    int64_t endPos;
+
+    CHK_ORET((partitionPos = mxf_file_tell(writeFile)) >= 0);
+
+    CHK_ORET(mxf_append_new_from_partition(partitions, (MXFPartition*)mxf_get_first_list_element(partitions),
+        &partition));
+    partition->key = MXF_PP_K(OpenIncomplete, Body);
+    partition->indexSID = INDEX_SID;
+    partition->bodySID = BODY_SID;
+    CHK_ORET(mxf_write_partition(writeFile, partition));
+
+    CHK_ORET(mxf_mark_index_start(writeFile, partition));
+    CHK_ORET(mxf_create_index_table_segment(&segment));
+    mxf_generate_uuid(&segment->instanceUID);
+    segment->indexEditRate.numerator = 25;
+    segment->indexEditRate.denominator = 1;
+    segment->indexStartPosition = startPosition;
+    segment->indexDuration = 0;
+    segment->editUnitByteCount = CONTENT_PACKAGE_LEN;
+    segment->indexSID = INDEX_SID;
+    segment->bodySID = BODY_SID;
+    CHK_OFAIL(mxf_write_index_table_segment(writeFile, segment));
+    mxf_free_index_table_segment(&segment);
+
+    CHK_ORET((endPos = mxf_file_tell(writeFile)) >= 0);
+    if (alignCP)
+    {
+        /* leave space for the filler KL */
+        endPos += 32;
+        endPos += CONTENT_PACKAGE_LEN - (endPos - partitionPos) % CONTENT_PACKAGE_LEN;
+    }
+    else
+    {
+        endPos += 32 + CONTENT_PACKAGE_LEN / 2;
+    }
+    CHK_ORET(mxf_fill_to_position(writeFile, endPos));
+    CHK_ORET(mxf_mark_index_end(writeFile, partition));
+
+    /* re-write the partition pack with the index byte count */
+    CHK_ORET(mxf_file_seek(writeFile, partitionPos, SEEK_SET));
+    CHK_ORET(mxf_write_partition(writeFile, partition));
+
+    return flush_writer(writeFile);
+
+fail:
+    mxf_free_index_table_segment(&segment);
+    return 0;
+}
+
+static int write_footer_partition(MXFFile* writeFile, MXFFilePartitions* partitions)
+{
+    MXFPartition* partition;
+
+    CHK_ORET(mxf_append_new_from_partition(partitions, (MXFPartition*)mxf_get_first_list_element(partitions),
+        &partition));
+    partition->key = MXF_PP_K(ClosedComplete, Footer);
+    CHK_ORET(mxf_write_partition(writeFile, partition));
+
+    return flush_writer(writeFile);
+}
+
+static int check_last_frame(MXFFile* readFile, FileIndex* index, int64_t expected, const char* stage)
+{
+    int64_t lastFrame = ix_get_last_written_frame_number(readFile, index, -1);
+    if (lastFrame != expected)
+    {
+        mxf_log_error("Last written frame is %"PRId64" after %s; expected %"PRId64 LOG_LOC_FORMAT,
+                      lastFrame, stage, expected, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    return 1;
+}
+
+static int test_growing_index(const char* filename)
+{
+    MXFFile* writeFile = NULL;
+    MXFFile* readFile = NULL;
+    MXFFilePartitions writePartitions;
+    MXFFilePartitions readPartitions;
+    MXFPartition* partition;
+    FileIndex* index = NULL;
+    mxfKey key;
+    uint8_t llen;
+    uint64_t len;
+
+    mxf_initialise_file_partitions(&writePartitions);
+    mxf_initialise_file_partitions(&readPartitions);
+
+    if (!mxf_disk_file_open_new(filename, &writeFile))
+    {
+        mxf_log_error("Failed to create '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    /* header partition followed by essence */
+    CHK_OFAIL(mxf_append_new_partition(&writePartitions, &partition));
+    partition->key = MXF_PP_K(OpenIncomplete, Header);
+    partition->bodySID = BODY_SID;
+    CHK_OFAIL(mxf_append_partition_esscont_label(partition, &MXF_EC_L(MultipleWrappings)));
+    CHK_OFAIL(mxf_write_partition(writeFile, partition));
+    CHK_OFAIL(write_content_packages(writeFile, 2));
+
+    /* the reader indexes the header partition */
+    CHK_OFAIL(mxf_disk_file_open_read(filename, &readFile));
+    CHK_OFAIL(mxf_read_header_pp_kl_with_runin(readFile, &key, &llen, &len));
+    CHK_OFAIL(mxf_read_partition(readFile, &key, &partition));
+    CHK_OFAIL(mxf_append_partition(&readPartitions, partition));
+    CHK_OFAIL(create_index(readFile, &readPartitions, INDEX_SID, BODY_SID, &index));
+    CHK_OFAIL(get_cp_len(index) == CONTENT_PACKAGE_LEN);
+    CHK_OFAIL(check_last_frame(readFile, index, 1, "the first content packages"));
+
+    /* unchanged file */
+    CHK_OFAIL(check_last_frame(readFile, index, 1, "no change"));
+
+    /* appended content packages, the last one incomplete */
+    CHK_OFAIL(write_content_packages(writeFile, 3));
+    CHK_OFAIL(write_partial_content_package(writeFile));
+    CHK_OFAIL(check_last_frame(readFile, index, 4, "an incomplete content package"));
+    CHK_OFAIL(complete_partial_content_package(writeFile));
+    CHK_OFAIL(check_last_frame(readFile, index, 5, "completing the content package"));
+
+    /* body partitions whose partition pack and index table segment are and aren't a multiple of the content
+       package length, each polled after content packages are written */
+    CHK_OFAIL(write_body_partition(writeFile, &writePartitions, 6, 1));
+    CHK_OFAIL(write_content_packages(writeFile, 4));
+    CHK_OFAIL(check_last_frame(readFile, index, 9, "an aligned body partition"));
+    CHK_OFAIL(write_body_partition(writeFile, &writePartitions, 10, 0));
+    CHK_OFAIL(write_content_packages(writeFile, 3));
+    CHK_OFAIL(check_last_frame(readFile, index, 12, "an unaligned body partition"));
+
+    /* body partitions with content packages before and after them appended between polls. The aligned body
+       partition must not be counted as content packages */
+    CHK_OFAIL(write_content_packages(writeFile, 2));
+    CHK_OFAIL(write_body_partition(writeFile, &writePartitions, 15, 1));
+    CHK_OFAIL(write_content_packages(writeFile, 2));
+    CHK_OFAIL(check_last_frame(readFile, index, 16, "content packages around an aligned body partition"));
+    CHK_OFAIL(write_body_partition(writeFile, &writePartitions, 17, 0));
+    CHK_OFAIL(write_content_packages(writeFile, 1));
+    CHK_OFAIL(check_last_frame(readFile, index, 17, "an unaligned body partition and content package"));
+
+    /* the footer completes the index */
+    CHK_OFAIL(write_footer_partition(writeFile, &writePartitions));
+    CHK_OFAIL(check_last_frame(readFile, index, 17, "the footer partition"));
+
+    /* the reader's position is usable after the polls */
+    CHK_OFAIL(set_position(readFile, index, 16));
+    get_next_kl(index, &key, &llen, &len);
+    CHK_OFAIL(mxf_equals_key(&key, &g_elementKey));
+
+
+    free_index(&index);
+    mxf_file_close(&readFile);
+    mxf_file_close(&writeFile);
+    mxf_clear_file_partitions(&readPartitions);
+    mxf_clear_file_partitions(&writePartitions);
+    return 1;
+
+fail:
+    free_index(&index);
+    mxf_file_close(&readFile);
+    mxf_file_close(&writeFile);
+    mxf_clear_file_partitions(&readPartitions);
+    mxf_clear_file_partitions(&writePartitions);
+    return 0;
+}
+
+
+void usage(const char* cmd)
+{
+    fprintf(stderr, "Usage: %s filename\n", cmd);
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc != 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (!test_growing_index(argv[1]))
+    {
+        return 1;
+    }
+
+    return 0;
+}
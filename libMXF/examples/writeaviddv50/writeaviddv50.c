@@ -489,5 +489,7 @@ int main(int argv, const char* argc[])
     fclose(dv50File);
     mxf_file_close(&mxfFile);
     
+    mxf_avid_free_default_metadictionary_template();
+    
     return result;
 }
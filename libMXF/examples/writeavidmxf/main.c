@@ -2737,6 +2737,9 @@ int main(int argc, const char* argv[])
             }
         }
     }    
+    
+    mxf_avid_free_default_metadictionary_template();
+    mxf_avid_free_default_dictionary_template();
 
 
     return 0;
@@ -127,6 +127,20 @@ int mxf_avid_is_essence_element(const mxfKey* key);
 void mxf_avid_set_auid(const mxfUL* ul, mxfAUID* auid);
 
 
+/* A set template holds the sets created by a function such as the default (meta-)dictionary creation,
+   with the instance UIDs, references and primer local tags replaced when the sets are re-created in
+   another header metadata. The output is identical to calling the create function. The template is
+   created on the first call and is published to *setTemplate; it is safe to call from multiple threads */
+
+typedef struct _MXFAvidSetTemplate MXFAvidSetTemplate;
+
+typedef int (*mxf_avid_create_sets_func)(MXFHeaderMetadata* headerMetadata, MXFMetadataSet** firstSet);
+
+int mxf_avid_create_sets_from_template(MXFAvidSetTemplate** setTemplate, mxf_avid_create_sets_func createFunc,
+    MXFHeaderMetadata* headerMetadata, MXFMetadataSet** firstSet);
+void mxf_avid_free_set_template(MXFAvidSetTemplate** setTemplate);
+
+
 
 #ifdef __cplusplus
 }
@@ -52,6 +52,11 @@ void mxf_clear_dict_read_filter(MXFReadFilter* filter);
 
 
 int mxf_avid_create_default_dictionary(MXFHeaderMetadata* headerMetadata, MXFMetadataSet** dictSet);
+int mxf_avid_create_default_dictionary_without_template(MXFHeaderMetadata* headerMetadata, MXFMetadataSet** dictSet);
+
+/* frees the template used by mxf_avid_create_default_dictionary; must not be called while another thread
+   is creating a dictionary */
+void mxf_avid_free_default_dictionary_template();
 
 
 #ifdef __cplusplus
@@ -74,6 +74,11 @@ void mxf_clear_metadict_read_filter(MXFReadFilter* filter);
 
 
 int mxf_avid_create_default_metadictionary(MXFHeaderMetadata* headerMetadata, MXFMetadataSet** metaDictSet);
+int mxf_avid_create_default_metadictionary_without_template(MXFHeaderMetadata* headerMetadata, MXFMetadataSet** metaDictSet);
+
+/* frees the template used by mxf_avid_create_default_metadictionary; must not be called while another thread
+   is creating a meta-dictionary */
+void mxf_avid_free_default_metadictionary_template();
 
 
 
@@ -105,12 +105,29 @@ typedef struct _MXFSetDef
     struct _MXFSetDef* parentSetDef;
 } MXFSetDef;
 
+/* open addressing hash index of set or item defs, keyed on the def key */
+typedef struct
+{
+    void** entries;
+    size_t size; /* power of 2 */
+    size_t count;
+} MXFDefIndex;
+
 typedef struct
 {
     MXFList itemDefs;
     MXFList setDefs;
     MXFItemType types[128]; /* index 0 is not used */
     unsigned int lastTypeId;
+    
+    MXFDefIndex setDefIndex;
+    MXFDefIndex itemDefIndex;
+    
+    /* baseline defs are allocated in a single block with names pointing to static strings */
+    MXFSetDef* baselineSetDefs;
+    size_t numBaselineSetDefs;
+    MXFItemDef* baselineItemDefs;
+    size_t numBaselineItemDefs;
 } MXFDataModel;
 
 
@@ -229,6 +246,9 @@ int mxf_check_data_model(MXFDataModel* dataModel);
 int mxf_find_set_def(MXFDataModel* dataModel, const mxfKey* key, MXFSetDef** setDef);
 int mxf_find_item_def(MXFDataModel* dataModel, const mxfKey* key, MXFItemDef** itemDef);
 int mxf_find_item_def_in_set_def(const mxfKey* key, const MXFSetDef* setDef, MXFItemDef** itemDef);
+/* same as mxf_find_item_def_in_set_def, but uses the data model's item def index */
+int mxf_find_item_def_in_set_def_indexed(MXFDataModel* dataModel, const mxfKey* key, const MXFSetDef* setDef,
+    MXFItemDef** itemDef);
 
 MXFItemType* mxf_get_item_def_type(MXFDataModel* dataModel, unsigned int typeId);
 
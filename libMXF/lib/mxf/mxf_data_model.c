@@ -21,6 +21,7 @@
  */
  
 #include <assert.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -74,52 +75,126 @@ static void free_set_def(MXFSetDef** setDef)
     SAFE_FREE(setDef);
 }
 
-static void free_item_def_in_list(void* data)
+static int item_def_eq(void* data, void* info)
 {
-    MXFItemDef* itemDef;
+    assert(data != NULL && info != NULL);
+    
+    return mxf_equals_key((mxfKey*)info, &((MXFItemDef*)data)->key);
+}
+
+static size_t hash_key(const mxfKey* key)
+{
+    const uint8_t* bytes = (const uint8_t*)key;
+    uint32_t hash = 2166136261U;
+    size_t i;
     
-    if (data == NULL)
+    /* FNV-1a. All 16 bytes are used because set and item keys share long prefixes */
+    for (i = 0; i < sizeof(mxfKey); i++)
     {
-        return;
+        hash ^= bytes[i];
+        hash *= 16777619U;
     }
     
-    itemDef = (MXFItemDef*)data;
-    free_item_def(&itemDef);
+    return hash;
 }
 
-static void free_set_def_in_list(void* data)
+static const mxfKey* get_def_key(void* def, size_t keyOffset)
 {
-    MXFSetDef* setDef;
+    return (const mxfKey*)((const uint8_t*)def + keyOffset);
+}
+
+static void* find_def_in_index(const MXFDefIndex* index, const mxfKey* key, size_t keyOffset)
+{
+    size_t pos;
     
-    if (data == NULL)
+    if (index->size == 0)
     {
-        return;
+        return NULL;
     }
     
-    setDef = (MXFSetDef*)data;
-    mxf_clear_list(&setDef->itemDefs);
-    free_set_def(&setDef);
+    pos = hash_key(key) & (index->size - 1);
+    while (index->entries[pos] != NULL)
+    {
+        if (mxf_equals_key(key, get_def_key(index->entries[pos], keyOffset)))
+        {
+            return index->entries[pos];
+        }
+        pos = (pos + 1) & (index->size - 1);
+    }
+    
+    return NULL;
 }
 
-static int set_def_eq(void* data, void* info)
+static void insert_def_in_index(MXFDefIndex* index, void* def, size_t keyOffset)
 {
-    assert(data != NULL && info != NULL);
+    const mxfKey* key = get_def_key(def, keyOffset);
+    size_t pos;
     
-    return mxf_equals_key((mxfKey*)info, &((MXFSetDef*)data)->key);
+    assert(index->count < index->size / 2);
+    
+    pos = hash_key(key) & (index->size - 1);
+    while (index->entries[pos] != NULL)
+    {
+        /* a duplicate key keeps the first registered def, as with the previous list search */
+        if (mxf_equals_key(key, get_def_key(index->entries[pos], keyOffset)))
+        {
+            return;
+        }
+        pos = (pos + 1) & (index->size - 1);
+    }
+    
+    index->entries[pos] = def;
+    index->count++;
 }
 
-static int item_def_eq(void* data, void* info)
+/* grow the index so that it can hold minCount defs with a load factor <= 0.5 */
+static int reserve_def_index(MXFDefIndex* index, size_t minCount, size_t keyOffset)
 {
-    assert(data != NULL && info != NULL);
+    MXFDefIndex newIndex;
+    size_t i;
     
-    return mxf_equals_key((mxfKey*)info, &((MXFItemDef*)data)->key);
+    if (minCount < index->size / 2)
+    {
+        return 1;
+    }
+    
+    newIndex.size = (index->size == 0 ? 64 : index->size);
+    while (minCount >= newIndex.size / 2)
+    {
+        newIndex.size *= 2;
+    }
+    newIndex.count = 0;
+    CHK_ORET((newIndex.entries = (void**)calloc(newIndex.size, sizeof(void*))) != NULL);
+    
+    for (i = 0; i < index->size; i++)
+    {
+        if (index->entries[i] != NULL)
+        {
+            insert_def_in_index(&newIndex, index->entries[i], keyOffset);
+        }
+    }
+    
+    SAFE_FREE(&index->entries);
+    *index = newIndex;
+    return 1;
+}
+
+static void clear_def_index(MXFDefIndex* index)
+{
+    SAFE_FREE(&index->entries);
+    index->size = 0;
+    index->count = 0;
 }
 
 static int add_set_def(MXFDataModel* dataModel, MXFSetDef* setDef)
 {
     assert(setDef != NULL);
     
+    /* reserve first so that the def is not left in the list if the index can't grow */
+    CHK_ORET(reserve_def_index(&dataModel->setDefIndex, dataModel->setDefIndex.count + 1, 
+        offsetof(MXFSetDef, key)));
     CHK_ORET(mxf_append_list_element(&dataModel->setDefs, (void*)setDef));
+    insert_def_in_index(&dataModel->setDefIndex, setDef, offsetof(MXFSetDef, key));
     
     return 1;
 }
@@ -128,11 +203,28 @@ static int add_item_def(MXFDataModel* dataModel, MXFItemDef* itemDef)
 {
     assert(itemDef != NULL);
     
+    CHK_ORET(reserve_def_index(&dataModel->itemDefIndex, dataModel->itemDefIndex.count + 1, 
+        offsetof(MXFItemDef, key)));
     CHK_ORET(mxf_append_list_element(&dataModel->itemDefs, (void*)itemDef));
+    insert_def_in_index(&dataModel->itemDefIndex, itemDef, offsetof(MXFItemDef, key));
     
     return 1;
 }
 
+static int is_baseline_set_def(MXFDataModel* dataModel, MXFSetDef* setDef)
+{
+    return dataModel->baselineSetDefs != NULL &&
+        setDef >= dataModel->baselineSetDefs && 
+        setDef < dataModel->baselineSetDefs + dataModel->numBaselineSetDefs;
+}
+
+static int is_baseline_item_def(MXFDataModel* dataModel, MXFItemDef* itemDef)
+{
+    return dataModel->baselineItemDefs != NULL &&
+        itemDef >= dataModel->baselineItemDefs && 
+        itemDef < dataModel->baselineItemDefs + dataModel->numBaselineItemDefs;
+}
+
 static unsigned int get_type_id(MXFDataModel* dataModel)
 {
     size_t i;
@@ -250,6 +342,83 @@ static int clone_item_def(MXFDataModel* fromDataModel, MXFItemDef* fromItemDef,
 
 
 
+static void init_baseline_set_def(MXFSetDef* setDef, const char* name, const mxfKey* parentKey, 
+    const mxfKey* key)
+{
+    setDef->name = (char*)name;
+    setDef->parentSetDefKey = *parentKey;
+    setDef->key = *key;
+    mxf_initialise_list(&setDef->itemDefs, NULL);
+}
+
+static void init_baseline_item_def(MXFItemDef* itemDef, const char* name, const mxfKey* setKey, 
+    const mxfKey* key, mxfLocalTag tag, unsigned int typeId, int isRequired)
+{
+    itemDef->name = (char*)name;
+    itemDef->setDefKey = *setKey;
+    itemDef->key = *key;
+    itemDef->localTag = tag;
+    itemDef->typeId = typeId;
+    itemDef->isRequired = isRequired;
+}
+
+static int add_baseline_defs(MXFDataModel* dataModel)
+{
+    size_t i;
+    
+    CHK_ORET(reserve_def_index(&dataModel->setDefIndex, dataModel->numBaselineSetDefs, 
+        offsetof(MXFSetDef, key)));
+    CHK_ORET(reserve_def_index(&dataModel->itemDefIndex, dataModel->numBaselineItemDefs, 
+        offsetof(MXFItemDef, key)));
+    
+    for (i = 0; i < dataModel->numBaselineSetDefs; i++)
+    {
+        CHK_ORET(add_set_def(dataModel, &dataModel->baselineSetDefs[i]));
+    }
+    for (i = 0; i < dataModel->numBaselineItemDefs; i++)
+    {
+        CHK_ORET(add_item_def(dataModel, &dataModel->baselineItemDefs[i]));
+    }
+    
+    return 1;
+}
+
+
+/* the counts are constant and are folded by the compiler */
+
+#define MXF_SET_DEFINITION(parentName, name, label) \
+    count++;
+
+static size_t get_num_baseline_set_defs(void)
+{
+    size_t count = 0;
+    
+#define KEEP_DATA_MODEL_DEFS 1
+#include <mxf/mxf_baseline_data_model.h>
+
+#undef KEEP_DATA_MODEL_DEFS
+#include <mxf/mxf_extensions_data_model.h>
+
+    return count;
+}
+
+#define MXF_ITEM_DEFINITION(setName, name, label, tag, typeId, isRequired) \
+    count++;
+
+static size_t get_num_baseline_item_defs(void)
+{
+    size_t count = 0;
+    
+#define KEEP_DATA_MODEL_DEFS 1
+#include <mxf/mxf_baseline_data_model.h>
+
+#undef KEEP_DATA_MODEL_DEFS
+#include <mxf/mxf_extensions_data_model.h>
+
+    return count;
+}
+
+
 #if defined(_MSC_VER)
 #pragma warning(push)
 #pragma warning(disable:4706)
@@ -271,23 +440,36 @@ static int clone_item_def(MXFDataModel* fromDataModel, MXFItemDef* fromItemDef,
 #define MXF_INTERPRETED_TYPE_DEF(id, name, typeId, fixedSize) \
     CHK_OFAIL(mxf_register_interpret_type(newDataModel, name, id, typeId, fixedSize));    
 
-    
+/* the baseline set and item defs are allocated in a single block, with names pointing to the 
+   static strings, and are added to the lists and indexes afterwards */
 #define MXF_SET_DEFINITION(parentName, name, label) \
-    CHK_OFAIL(mxf_register_set_def(newDataModel, #name, &MXF_SET_K(parentName), &MXF_SET_K(name)));
+    init_baseline_set_def(&newDataModel->baselineSetDefs[setDefCount++], #name, &MXF_SET_K(parentName), \
+        &MXF_SET_K(name));
     
 #define MXF_ITEM_DEFINITION(setName, name, label, tag, typeId, isRequired) \
-    CHK_OFAIL(mxf_register_item_def(newDataModel, #name, &MXF_SET_K(setName), &MXF_ITEM_K(setName, name), tag, typeId, isRequired));
+    init_baseline_item_def(&newDataModel->baselineItemDefs[itemDefCount++], #name, &MXF_SET_K(setName), \
+        &MXF_ITEM_K(setName, name), tag, typeId, isRequired);
 
 
 int mxf_load_data_model(MXFDataModel** dataModel)
 {
     MXFDataModel* newDataModel;
     MXFItemType* itemType = NULL;
+    size_t setDefCount = 0;
+    size_t itemDefCount = 0;
     
     CHK_MALLOC_ORET(newDataModel, MXFDataModel);
     memset(newDataModel, 0, sizeof(MXFDataModel));
-    mxf_initialise_list(&newDataModel->itemDefs, free_item_def_in_list); 
-    mxf_initialise_list(&newDataModel->setDefs, free_set_def_in_list); 
+    /* the defs are freed in mxf_free_data_model because the baseline defs are not allocated individually */
+    mxf_initialise_list(&newDataModel->itemDefs, NULL); 
+    mxf_initialise_list(&newDataModel->setDefs, NULL); 
+    
+    CHK_OFAIL((newDataModel->baselineSetDefs = (MXFSetDef*)calloc(get_num_baseline_set_defs(), 
+        sizeof(MXFSetDef))) != NULL);
+    newDataModel->numBaselineSetDefs = get_num_baseline_set_defs();
+    CHK_OFAIL((newDataModel->baselineItemDefs = (MXFItemDef*)calloc(get_num_baseline_item_defs(), 
+        sizeof(MXFItemDef))) != NULL);
+    newDataModel->numBaselineItemDefs = get_num_baseline_item_defs();
     
 #define KEEP_DATA_MODEL_DEFS 1
 #include <mxf/mxf_baseline_data_model.h>
@@ -295,6 +477,10 @@ int mxf_load_data_model(MXFDataModel** dataModel)
 #undef KEEP_DATA_MODEL_DEFS
 #include <mxf/mxf_extensions_data_model.h>
 
+    assert(setDefCount == newDataModel->numBaselineSetDefs && 
+        itemDefCount == newDataModel->numBaselineItemDefs);
+    CHK_OFAIL(add_baseline_defs(newDataModel));
+
     *dataModel = newDataModel;
     return 1;
     
@@ -305,6 +491,9 @@ fail:
 
 void mxf_free_data_model(MXFDataModel** dataModel)
 {
+    MXFListIterator iter;
+    MXFSetDef* setDef;
+    MXFItemDef* itemDef;
     size_t i;
 
     if (*dataModel == NULL)
@@ -312,9 +501,34 @@ void mxf_free_data_model(MXFDataModel** dataModel)
         return;
     }
     
+    mxf_initialise_list_iter(&iter, &(*dataModel)->setDefs);
+    while (mxf_next_list_iter_element(&iter))
+    {
+        setDef = (MXFSetDef*)mxf_get_iter_element(&iter);
+        mxf_clear_list(&setDef->itemDefs);
+        if (!is_baseline_set_def(*dataModel, setDef))
+        {
+            free_set_def(&setDef);
+        }
+    }
     mxf_clear_list(&(*dataModel)->setDefs);
+    
+    mxf_initialise_list_iter(&iter, &(*dataModel)->itemDefs);
+    while (mxf_next_list_iter_element(&iter))
+    {
+        itemDef = (MXFItemDef*)mxf_get_iter_element(&iter);
+        if (!is_baseline_item_def(*dataModel, itemDef))
+        {
+            free_item_def(&itemDef);
+        }
+    }
     mxf_clear_list(&(*dataModel)->itemDefs);
     
+    SAFE_FREE(&(*dataModel)->baselineSetDefs);
+    SAFE_FREE(&(*dataModel)->baselineItemDefs);
+    clear_def_index(&(*dataModel)->setDefIndex);
+    clear_def_index(&(*dataModel)->itemDefIndex);
+    
     for (i = 0; i < sizeof((*dataModel)->types) / sizeof(MXFItemType); i++)
     {
         clear_type(&(*dataModel)->types[i]);
@@ -668,7 +882,7 @@ int mxf_find_set_def(MXFDataModel* dataModel, const mxfKey* key, MXFSetDef** set
 {
     void* result;
     
-    if ((result = mxf_find_list_element(&dataModel->setDefs, (void*)key, set_def_eq)) != NULL)
+    if ((result = find_def_in_index(&dataModel->setDefIndex, key, offsetof(MXFSetDef, key))) != NULL)
     {
         *setDef = (MXFSetDef*)result;
         return 1;
@@ -681,7 +895,7 @@ int mxf_find_item_def(MXFDataModel* dataModel, const mxfKey* key, MXFItemDef** i
 {
     void* result;
     
-    if ((result = mxf_find_list_element(&dataModel->itemDefs, (void*)key, item_def_eq)) != NULL)
+    if ((result = find_def_in_index(&dataModel->itemDefIndex, key, offsetof(MXFItemDef, key))) != NULL)
     {
         *itemDef = (MXFItemDef*)result;
         return 1;
@@ -708,6 +922,37 @@ int mxf_find_item_def_in_set_def(const mxfKey* key, const MXFSetDef* setDef, MXF
     return 0;
 }
 
+int mxf_find_item_def_in_set_def_indexed(MXFDataModel* dataModel, const mxfKey* key, const MXFSetDef* setDef, 
+    MXFItemDef** itemDef)
+{
+    MXFItemDef* result;
+    const MXFSetDef* ownerSetDef;
+    
+    if (!mxf_find_item_def(dataModel, key, &result))
+    {
+        return 0;
+    }
+    
+    /* check the item def belongs to the set def or one of its parents */
+    ownerSetDef = setDef;
+    while (ownerSetDef != NULL)
+    {
+        if (mxf_equals_key(&ownerSetDef->key, &result->setDefKey))
+        {
+            *itemDef = result;
+            return 1;
+        }
+        if (ownerSetDef->parentSetDef == ownerSetDef)
+        {
+            break;
+        }
+        ownerSetDef = ownerSetDef->parentSetDef;
+    }
+    
+    /* the item def key could be registered more than once, in which case the index only holds the first */
+    return mxf_find_item_def_in_set_def(key, setDef, itemDef);
+}
+
 
 MXFItemType* mxf_get_item_def_type(MXFDataModel* dataModel, unsigned int typeId)
 {
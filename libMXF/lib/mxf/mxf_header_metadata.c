@@ -442,7 +442,8 @@ int mxf_clone_set(MXFMetadataSet* fromSet, MXFHeaderMetadata* toHeaderMetadata,
     {
         MXFMetadataItem* fromItem = (MXFMetadataItem*)mxf_get_iter_element(&fromItemIter);
         
-        CHK_OFAIL(mxf_find_item_def_in_set_def(&fromItem->key, toSetDef, &toItemDef));
+        CHK_OFAIL(mxf_find_item_def_in_set_def_indexed(toHeaderMetadata->dataModel, &fromItem->key, toSetDef,
+            &toItemDef));
         
         if (toItemDef->typeId == MXF_WEAKREFARRAY_TYPE ||
             toItemDef->typeId == MXF_WEAKREFBATCH_TYPE ||
@@ -624,7 +625,7 @@ int mxf_read_and_return_set(MXFFile* mxfFile, const mxfKey* key, uint64_t len,
             if (mxf_get_item_key(headerMetadata->primerPack, itemTag, &itemKey))
             {
                 /* only read items with known definition */
-                if (mxf_find_item_def_in_set_def(&itemKey, setDef, &itemDef))
+                if (mxf_find_item_def_in_set_def_indexed(headerMetadata->dataModel, &itemKey, setDef, &itemDef))
                 {
                     CHK_OFAIL(mxf_create_item(newSet, &itemKey, itemTag, &newItem));
                     newItem->isPersistent = 1;
@@ -1253,3 +1253,466 @@ void mxf_avid_set_auid(const mxfUL* ul, mxfAUID* auid)
     memcpy(&auid->octet8, &ul->octet0, 8);
 }
 
+
+
+
+typedef struct
+{
+    mxfUID uid;
+    mxfLocalTag requestedTag; /* g_Null_LocalTag if a dynamic tag was assigned */
+} TemplatePrimerEntry;
+
+typedef struct
+{
+    mxfKey key;
+    uint32_t primerIndex;
+    uint32_t valueOffset;
+    uint16_t length;
+} TemplateItem;
+
+typedef struct
+{
+    mxfKey key;
+    uint32_t numItems;
+} TemplateSet;
+
+typedef struct
+{
+    uint32_t itemIndex;
+    uint32_t valueOffset;
+    uint32_t setIndex;
+} TemplateReference;
+
+struct _MXFAvidSetTemplate
+{
+    TemplatePrimerEntry* primerEntries;
+    uint32_t numPrimerEntries;
+    TemplateSet* sets;
+    uint32_t numSets;
+    TemplateItem* items;
+    uint32_t numItems;
+    TemplateReference* references; /* in item order */
+    uint32_t numReferences;
+    uint8_t* values;
+};
+
+typedef struct
+{
+    mxfUUID instanceUID;
+    uint32_t setIndex;
+} TemplateSetUID;
+
+
+static int compare_template_set_uid(const void* left, const void* right)
+{
+    return memcmp(&((const TemplateSetUID*)left)->instanceUID, &((const TemplateSetUID*)right)->instanceUID,
+                  sizeof(mxfUUID));
+}
+
+static MXFAvidSetTemplate* swap_set_template(MXFAvidSetTemplate** setTemplate, MXFAvidSetTemplate* oldValue,
+    MXFAvidSetTemplate* newValue)
+{
+    /* atomic compare and swap, returning the previous value */
+#if defined(_WIN32)
+    return (MXFAvidSetTemplate*)InterlockedCompareExchangePointer((PVOID volatile*)setTemplate, newValue, oldValue);
+#else
+    return __sync_val_compare_and_swap(setTemplate, oldValue, newValue);
+#endif
+}
+
+static int add_template_reference(MXFAvidSetTemplate* setTemplate, uint32_t* allocReferences,
+    const TemplateSetUID* setUIDs, const uint8_t* value, uint32_t itemIndex, uint32_t offset)
+{
+    TemplateSetUID key;
+    const TemplateSetUID* target;
+    TemplateReference* newReferences;
+    
+    /* references to sets outside the template keep their value */
+    mxf_get_uuid(&value[offset], &key.instanceUID);
+    target = (const TemplateSetUID*)bsearch(&key, setUIDs, setTemplate->numSets, sizeof(TemplateSetUID),
+                                            compare_template_set_uid);
+    if (target == NULL)
+    {
+        return 1;
+    }
+    
+    if (setTemplate->numReferences == *allocReferences)
+    {
+        *allocReferences = (*allocReferences == 0 ? 1024 : *allocReferences * 2);
+        CHK_ORET((newReferences = (TemplateReference*)realloc(setTemplate->references,
+            *allocReferences * sizeof(TemplateReference))) != NULL);
+        setTemplate->references = newReferences;
+    }
+    
+    setTemplate->references[setTemplate->numReferences].itemIndex = itemIndex;
+    setTemplate->references[setTemplate->numReferences].valueOffset = offset;
+    setTemplate->references[setTemplate->numReferences].setIndex = target->setIndex;
+    setTemplate->numReferences++;
+    
+    return 1;
+}
+
+static int add_template_item_references(MXFAvidSetTemplate* setTemplate, uint32_t* allocReferences,
+    const TemplateSetUID* setUIDs, MXFDataModel* dataModel, const MXFMetadataItem* item, uint32_t itemIndex)
+{
+    MXFItemDef* itemDef;
+    uint32_t arrayLen;
+    uint32_t arrayItemLen;
+    uint32_t i;
+    
+    if (!mxf_find_item_def(dataModel, &item->key, &itemDef))
+    {
+        return 1;
+    }
+    
+    switch (itemDef->typeId)
+    {
+        case MXF_STRONGREF_TYPE:
+        case MXF_WEAKREF_TYPE:
+            if (item->length == mxfUUID_extlen)
+            {
+                CHK_ORET(add_template_reference(setTemplate, allocReferences, setUIDs, item->value, itemIndex, 0));
+            }
+            break;
+        case MXF_STRONGREFARRAY_TYPE:
+        case MXF_STRONGREFBATCH_TYPE:
+        case MXF_WEAKREFARRAY_TYPE:
+        case MXF_WEAKREFBATCH_TYPE:
+            if (item->length >= 8)
+            {
+                mxf_get_array_header(item->value, &arrayLen, &arrayItemLen);
+                if (arrayItemLen == mxfUUID_extlen && 8 + arrayLen * arrayItemLen <= item->length)
+                {
+                    for (i = 0; i < arrayLen; i++)
+                    {
+                        CHK_ORET(add_template_reference(setTemplate, allocReferences, setUIDs, item->value,
+                                                        itemIndex, 8 + i * arrayItemLen));
+                    }
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    
+    return 1;
+}
+
+/* creates a template from the sets starting at firstSetIndex, with local tags assigned by primerPack */
+static int create_set_template(MXFHeaderMetadata* headerMetadata, MXFPrimerPack* primerPack, long firstSetIndex,
+    MXFAvidSetTemplate** setTemplate)
+{
+    MXFAvidSetTemplate* newTemplate = NULL;
+    TemplateSetUID* setUIDs = NULL;
+    uint32_t* primerIndexes = NULL;
+    uint32_t allocReferences = 0;
+    uint32_t valuesSize = 0;
+    uint32_t setIndex;
+    uint32_t itemIndex;
+    MXFListIterator setIter;
+    MXFListIterator itemIter;
+    MXFMetadataSet* set;
+    MXFMetadataItem* item;
+    MXFPrimerPackEntry* entry;
+    uint32_t i;
+    
+    CHK_MALLOC_ORET(newTemplate, MXFAvidSetTemplate);
+    memset(newTemplate, 0, sizeof(*newTemplate));
+    
+    
+    /* primer entries in registration order. The primer pack was empty before the sets were created and
+       static local tags are < 0x8000 */
+    
+    newTemplate->numPrimerEntries = (uint32_t)mxf_get_list_length(&primerPack->entries);
+    CHK_MALLOC_ARRAY_OFAIL(newTemplate->primerEntries, TemplatePrimerEntry, newTemplate->numPrimerEntries + 1);
+    CHK_OFAIL((primerIndexes = (uint32_t*)calloc(0x10000, sizeof(uint32_t))) != NULL);
+    i = 0;
+    mxf_initialise_list_iter(&itemIter, &primerPack->entries);
+    while (mxf_next_list_iter_element(&itemIter))
+    {
+        entry = (MXFPrimerPackEntry*)mxf_get_iter_element(&itemIter);
+        newTemplate->primerEntries[i].uid = entry->uid;
+        newTemplate->primerEntries[i].requestedTag = (entry->localTag < 0x8000 ? entry->localTag : g_Null_LocalTag);
+        primerIndexes[entry->localTag] = i;
+        i++;
+    }
+    
+    
+    /* sets and items, excluding the InstanceUID items which are created with the set */
+    
+    mxf_initialise_list_iter_at(&setIter, &headerMetadata->sets, firstSetIndex);
+    while (mxf_next_list_iter_element(&setIter))
+    {
+        set = (MXFMetadataSet*)mxf_get_iter_element(&setIter);
+        newTemplate->numSets++;
+        
+        mxf_initialise_list_iter(&itemIter, &set->items);
+        while (mxf_next_list_iter_element(&itemIter))
+        {
+            item = (MXFMetadataItem*)mxf_get_iter_element(&itemIter);
+            if (!mxf_equals_key(&item->key, &MXF_ITEM_K(InterchangeObject, InstanceUID)))
+            {
+                newTemplate->numItems++;
+                valuesSize += item->length;
+            }
+        }
+    }
+    CHK_OFAIL(newTemplate->numSets > 0);
+    
+    CHK_MALLOC_ARRAY_OFAIL(newTemplate->sets, TemplateSet, newTemplate->numSets);
+    CHK_MALLOC_ARRAY_OFAIL(newTemplate->items, TemplateItem, newTemplate->numItems + 1);
+    CHK_MALLOC_ARRAY_OFAIL(newTemplate->values, uint8_t, valuesSize + 1);
+    CHK_MALLOC_ARRAY_OFAIL(setUIDs, TemplateSetUID, newTemplate->numSets);
+    
+    setIndex = 0;
+    itemIndex = 0;
+    valuesSize = 0;
+    mxf_initialise_list_iter_at(&setIter, &headerMetadata->sets, firstSetIndex);
+    while (mxf_next_list_iter_element(&setIter))
+    {
+        set = (MXFMetadataSet*)mxf_get_iter_element(&setIter);
+        newTemplate->sets[setIndex].key = set->key;
+        newTemplate->sets[setIndex].numItems = 0;
+        setUIDs[setIndex].instanceUID = set->instanceUID;
+        setUIDs[setIndex].setIndex = setIndex;
+        
+        mxf_initialise_list_iter(&itemIter, &set->items);
+        while (mxf_next_list_iter_element(&itemIter))
+        {
+            item = (MXFMetadataItem*)mxf_get_iter_element(&itemIter);
+            if (mxf_equals_key(&item->key, &MXF_ITEM_K(InterchangeObject, InstanceUID)))
+            {
+                continue;
+            }
+            
+            newTemplate->items[itemIndex].key = item->key;
+            newTemplate->items[itemIndex].primerIndex = primerIndexes[item->tag];
+            newTemplate->items[itemIndex].valueOffset = valuesSize;
+            newTemplate->items[itemIndex].length = item->length;
+            memcpy(&newTemplate->values[valuesSize], item->value, item->length);
+            valuesSize += item->length;
+            
+            newTemplate->sets[setIndex].numItems++;
+            itemIndex++;
+        }
+        setIndex++;
+    }
+    
+    
+    /* instance UID references to sets in the template */
+    
+    qsort(setUIDs, newTemplate->numSets, sizeof(TemplateSetUID), compare_template_set_uid);
+    
+    itemIndex = 0;
+    mxf_initialise_list_iter_at(&setIter, &headerMetadata->sets, firstSetIndex);
+    while (mxf_next_list_iter_element(&setIter))
+    {
+        set = (MXFMetadataSet*)mxf_get_iter_element(&setIter);
+        
+        mxf_initialise_list_iter(&itemIter, &set->items);
+        while (mxf_next_list_iter_element(&itemIter))
+        {
+            item = (MXFMetadataItem*)mxf_get_iter_element(&itemIter);
+            if (mxf_equals_key(&item->key, &MXF_ITEM_K(InterchangeObject, InstanceUID)))
+            {
+                continue;
+            }
+            
+            CHK_OFAIL(add_template_item_references(newTemplate, &allocReferences, setUIDs, 
+                                                   headerMetadata->dataModel, item, itemIndex));
+            itemIndex++;
+        }
+    }
+    
+    
+    SAFE_FREE(&setUIDs);
+    SAFE_FREE(&primerIndexes);
+    *setTemplate = newTemplate;
+    return 1;
+    
+fail:
+    SAFE_FREE(&setUIDs);
+    SAFE_FREE(&primerIndexes);
+    mxf_avid_free_set_template(&newTemplate);
+    return 0;
+}
+
+/* calls createFunc with an empty primer pack so that the template has all local tag registrations in order,
+   and then registers the local tags in the header metadata primer pack in the same order */
+static int create_sets_and_template(mxf_avid_create_sets_func createFunc, MXFHeaderMetadata* headerMetadata,
+    MXFMetadataSet** firstSet, MXFAvidSetTemplate** setTemplate)
+{
+    MXFPrimerPack* primerPack = headerMetadata->primerPack;
+    MXFPrimerPack* emptyPrimerPack = NULL;
+    MXFListIterator setIter;
+    MXFListIterator itemIter;
+    MXFPrimerPackEntry* entry;
+    MXFMetadataSet* set;
+    MXFMetadataItem* item;
+    mxfLocalTag* tags = NULL;
+    long firstSetIndex;
+    int result;
+    
+    *setTemplate = NULL;
+    
+    CHK_ORET(mxf_create_primer_pack(&emptyPrimerPack));
+    CHK_OFAIL((tags = (mxfLocalTag*)calloc(0x10000, sizeof(mxfLocalTag))) != NULL);
+    
+    firstSetIndex = mxf_get_list_length(&headerMetadata->sets);
+    
+    headerMetadata->primerPack = emptyPrimerPack;
+    result = createFunc(headerMetadata, firstSet);
+    headerMetadata->primerPack = primerPack;
+    
+    /* failing to create the template is not an error; the sets are then created again next time */
+    if (result && !create_set_template(headerMetadata, emptyPrimerPack, firstSetIndex, setTemplate))
+    {
+        mxf_log_warn("Failed to create set template" LOG_LOC_FORMAT, LOG_LOC_PARAMS);
+    }
+    
+    /* register the local tags and replace the tags in the new items, also if createFunc failed */
+    mxf_initialise_list_iter(&itemIter, &emptyPrimerPack->entries);
+    while (mxf_next_list_iter_element(&itemIter))
+    {
+        entry = (MXFPrimerPackEntry*)mxf_get_iter_element(&itemIter);
+        CHK_OFAIL(mxf_register_primer_entry(primerPack, &entry->uid, 
+            (entry->localTag < 0x8000 ? entry->localTag : g_Null_LocalTag), &tags[entry->localTag]));
+    }
+    mxf_initialise_list_iter_at(&setIter, &headerMetadata->sets, firstSetIndex);
+    while (mxf_next_list_iter_element(&setIter))
+    {
+        set = (MXFMetadataSet*)mxf_get_iter_element(&setIter);
+        
+        mxf_initialise_list_iter(&itemIter, &set->items);
+        while (mxf_next_list_iter_element(&itemIter))
+        {
+            item = (MXFMetadataItem*)mxf_get_iter_element(&itemIter);
+            item->tag = tags[item->tag];
+        }
+    }
+    
+    SAFE_FREE(&tags);
+    mxf_free_primer_pack(&emptyPrimerPack);
+    if (!result)
+    {
+        mxf_avid_free_set_template(setTemplate);
+    }
+    return result;
+    
+fail:
+    SAFE_FREE(&tags);
+    mxf_free_primer_pack(&emptyPrimerPack);
+    mxf_avid_free_set_template(setTemplate);
+    return 0;
+}
+
+static int create_sets_from_template(const MXFAvidSetTemplate* setTemplate, MXFHeaderMetadata* headerMetadata,
+    MXFMetadataSet** firstSet)
+{
+    mxfLocalTag* tags = NULL;
+    MXFMetadataSet** sets = NULL;
+    const TemplateItem* templateItem;
+    const TemplateReference* reference;
+    MXFMetadataItem* item;
+    uint32_t numSets = 0;
+    uint32_t itemIndex;
+    uint32_t referenceIndex;
+    uint32_t i;
+    uint32_t j;
+    
+    CHK_MALLOC_ARRAY_ORET(tags, mxfLocalTag, setTemplate->numPrimerEntries + 1);
+    CHK_MALLOC_ARRAY_OFAIL(sets, MXFMetadataSet*, setTemplate->numSets);
+    
+    /* register the local tags in the same order as the original registrations */
+    for (i = 0; i < setTemplate->numPrimerEntries; i++)
+    {
+        CHK_OFAIL(mxf_register_primer_entry(headerMetadata->primerPack, &setTemplate->primerEntries[i].uid,
+                                            setTemplate->primerEntries[i].requestedTag, &tags[i]));
+    }
+    
+    /* create the sets in the original order, which generates new instance UIDs in the same order */
+    for (i = 0; i < setTemplate->numSets; i++)
+    {
+        CHK_OFAIL(mxf_create_set(headerMetadata, &setTemplate->sets[i].key, &sets[i]));
+        numSets++;
+    }
+    
+    /* create the items and replace the references with the new instance UIDs */
+    itemIndex = 0;
+    referenceIndex = 0;
+    for (i = 0; i < setTemplate->numSets; i++)
+    {
+        for (j = 0; j < setTemplate->sets[i].numItems; j++)
+        {
+            templateItem = &setTemplate->items[itemIndex];
+            
+            CHK_OFAIL(mxf_create_item(sets[i], &templateItem->key, tags[templateItem->primerIndex], &item));
+            CHK_OFAIL(mxf_set_item_value(item, &setTemplate->values[templateItem->valueOffset],
+                                         templateItem->length));
+            
+            while (referenceIndex < setTemplate->numReferences &&
+                setTemplate->references[referenceIndex].itemIndex == itemIndex)
+            {
+                reference = &setTemplate->references[referenceIndex];
+                mxf_set_uuid(&sets[reference->setIndex]->instanceUID, &item->value[reference->valueOffset]);
+                referenceIndex++;
+            }
+            
+            itemIndex++;
+        }
+    }
+    
+    *firstSet = sets[0];
+    SAFE_FREE(&sets);
+    SAFE_FREE(&tags);
+    return 1;
+    
+fail:
+    for (i = 0; i < numSets; i++)
+    {
+        mxf_remove_set(headerMetadata, sets[i]);
+        mxf_free_set(&sets[i]);
+    }
+    SAFE_FREE(&sets);
+    SAFE_FREE(&tags);
+    return 0;
+}
+
+int mxf_avid_create_sets_from_template(MXFAvidSetTemplate** setTemplate, mxf_avid_create_sets_func createFunc,
+    MXFHeaderMetadata* headerMetadata, MXFMetadataSet** firstSet)
+{
+    MXFAvidSetTemplate* currentTemplate;
+    MXFAvidSetTemplate* newTemplate = NULL;
+    
+    currentTemplate = swap_set_template(setTemplate, NULL, NULL);
+    if (currentTemplate != NULL)
+    {
+        return create_sets_from_template(currentTemplate, headerMetadata, firstSet);
+    }
+    
+    CHK_ORET(create_sets_and_template(createFunc, headerMetadata, firstSet, &newTemplate));
+    
+    /* another thread could have published a template in the mean time */
+    if (newTemplate != NULL && swap_set_template(setTemplate, NULL, newTemplate) != NULL)
+    {
+        mxf_avid_free_set_template(&newTemplate);
+    }
+    
+    return 1;
+}
+
+void mxf_avid_free_set_template(MXFAvidSetTemplate** setTemplate)
+{
+    if (*setTemplate == NULL)
+    {
+        return;
+    }
+    
+    SAFE_FREE(&(*setTemplate)->primerEntries);
+    SAFE_FREE(&(*setTemplate)->sets);
+    SAFE_FREE(&(*setTemplate)->items);
+    SAFE_FREE(&(*setTemplate)->references);
+    SAFE_FREE(&(*setTemplate)->values);
+    SAFE_FREE(setTemplate);
+}
+
@@ -34,6 +34,9 @@ typedef struct
 } MXFDictReadFilterData;
 
 
+static MXFAvidSetTemplate* g_defaultDictTemplate = NULL;
+
+
 
 
 static int dict_before_set_read(void* privateData, MXFHeaderMetadata* headerMetadata, 
@@ -205,7 +208,7 @@ void mxf_clear_dict_read_filter(MXFReadFilter* filter)
     CHK_OFAIL(mxf_avid_create_containerdef(newSet, id, name, description, &defSet));
 
 
-int mxf_avid_create_default_dictionary(MXFHeaderMetadata* headerMetadata, MXFMetadataSet** metaDictSet)
+int mxf_avid_create_default_dictionary_without_template(MXFHeaderMetadata* headerMetadata, MXFMetadataSet** metaDictSet)
 {
     MXFMetadataSet* newSet = NULL;
     mxfUL label1;
@@ -228,4 +231,16 @@ fail:
     return 0;
 }
 
+int mxf_avid_create_default_dictionary(MXFHeaderMetadata* headerMetadata, MXFMetadataSet** dictSet)
+{
+    /* the default dictionary is the same for every file and is created from a template after the first time */
+    return mxf_avid_create_sets_from_template(&g_defaultDictTemplate,
+                                              mxf_avid_create_default_dictionary_without_template,
+                                              headerMetadata, dictSet);
+}
+
+void mxf_avid_free_default_dictionary_template()
+{
+    mxf_avid_free_set_template(&g_defaultDictTemplate);
+}
 
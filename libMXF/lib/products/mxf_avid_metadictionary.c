@@ -41,6 +41,9 @@ typedef struct
     mxfUL targetIdentification;
 } WeakRefData;
 
+static MXFAvidSetTemplate* g_defaultMetaDictTemplate = NULL;
+
+
 struct _AvidMetaDictionary
 {
     MXFHeaderMetadata* headerMetadata;
@@ -720,7 +723,7 @@ void mxf_clear_metadict_read_filter(MXFReadFilter* filter)
 }
 
 
-int mxf_avid_create_default_metadictionary(MXFHeaderMetadata* headerMetadata, MXFMetadataSet** metaDictSet)
+int mxf_avid_create_default_metadictionary_without_template(MXFHeaderMetadata* headerMetadata, MXFMetadataSet** metaDictSet)
 {
     AvidMetaDictionary* metaDict = NULL;
     
@@ -738,3 +741,16 @@ fail:
     return 0;
 }
 
+int mxf_avid_create_default_metadictionary(MXFHeaderMetadata* headerMetadata, MXFMetadataSet** metaDictSet)
+{
+    /* the default meta-dictionary is the same for every file and is created from a template after the first time */
+    return mxf_avid_create_sets_from_template(&g_defaultMetaDictTemplate,
+                                              mxf_avid_create_default_metadictionary_without_template,
+                                              headerMetadata, metaDictSet);
+}
+
+void mxf_avid_free_default_metadictionary_template()
+{
+    mxf_avid_free_set_template(&g_defaultMetaDictTemplate);
+}
+
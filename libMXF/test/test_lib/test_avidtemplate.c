@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <mxf/mxf.h>
+#include <mxf/mxf_avid.h>
+
+
+#define NUM_TIMED_CREATES   100
+
+
+/* instance UIDs that restart for each header metadata so that the output can be compared */
+static uint32_t g_uuidCount = 1;
+
+static void test_generate_uuid(mxfUUID* uuid)
+{
+    memset(uuid, 0, sizeof(*uuid));
+    uuid->octet12 = (uint8_t)((g_uuidCount >> 24) & 0xff);
+    uuid->octet13 = (uint8_t)((g_uuidCount >> 16) & 0xff);
+    uuid->octet14 = (uint8_t)((g_uuidCount >> 8) & 0xff);
+    uuid->octet15 = (uint8_t)(g_uuidCount & 0xff);
+
+    g_uuidCount++;
+}
+
+
+/* creates the sets in the same order as the Avid writer */
+static int create_dictionaries(MXFHeaderMetadata* headerMetadata, int useTemplate)
+{
+    MXFMetadataSet* metaDictSet;
+    MXFMetadataSet* prefaceSet;
+    MXFMetadataSet* dictSet;
+
+    if (useTemplate)
+    {
+        CHK_ORET(mxf_avid_create_default_metadictionary(headerMetadata, &metaDictSet));
+    }
+    else
+    {
+        CHK_ORET(mxf_avid_create_default_metadictionary_without_template(headerMetadata, &metaDictSet));
+    }
+
+    CHK_ORET(mxf_create_set(headerMetadata, &MXF_SET_K(Preface), &prefaceSet));
+
+    if (useTemplate)
+    {
+        CHK_ORET(mxf_avid_create_default_dictionary(headerMetadata, &dictSet));
+    }
+    else
+    {
+        CHK_ORET(mxf_avid_create_default_dictionary_without_template(headerMetadata, &dictSet));
+    }
+    CHK_ORET(mxf_set_strongref_item(prefaceSet, &MXF_ITEM_K(Preface, Dictionary), dictSet));
+
+    return 1;
+}
+
+/* writes the primer pack and sets to filename and reads the bytes back into *data */
+static int write_and_read(const char* filename, MXFDataModel* dataModel, int useTemplate,
+    uint8_t** data, long* size)
+{
+    MXFFile* mxfFile = NULL;
+    MXFHeaderMetadata* headerMetadata = NULL;
+    FILE* file = NULL;
+
+    *data = NULL;
+
+    if (!mxf_disk_file_open_new(filename, &mxfFile))
+    {
+        mxf_log_error("Failed to create '%s'" LOG_LOC_FORMAT, filename, LOG_LOC_PARAMS);
+        return 0;
+    }
+
+    g_uuidCount = 1;
+    CHK_OFAIL(mxf_create_header_metadata(&headerMetadata, dataModel));
+    CHK_OFAIL(create_dictionaries(headerMetadata, useTemplate));
+    CHK_OFAIL(mxf_write_header_metadata(mxfFile, headerMetadata));
+    mxf_file_close(&mxfFile);
+    mxf_free_header_metadata(&headerMetadata);
+
+    CHK_OFAIL((file = fopen(filename, "rb")) != NULL);
+    CHK_OFAIL(fseek(file, 0, SEEK_END) == 0);
+    CHK_OFAIL((*size = ftell(file)) > 0);
+    CHK_OFAIL(fseek(file, 0, SEEK_SET) == 0);
+    CHK_MALLOC_ARRAY_OFAIL(*data, uint8_t, *size);
+    CHK_OFAIL(fread(*data, 1, *size, file) == (size_t)(*size));
+    fclose(file);
+
+    return 1;
+
+fail:
+    mxf_file_close(&mxfFile);
+    mxf_free_header_metadata(&headerMetadata);
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    SAFE_FREE(data);
+    return 0;
+}
+
+/* checks that the sets created from the templates are identical to the sets created without them */
+static int test_identical(const char* filename, MXFDataModel* dataModel)
+{
+    uint8_t* expected = NULL;
+    long expectedSize;
+    uint8_t* data = NULL;
+    long size;
+    int i;
+
+    CHK_ORET(write_and_read(filename, dataModel, 0, &expected, &expectedSize));
+
+    /* the first create makes the templates, the next creates use them */
+    for (i = 0; i < 3; i++)
+    {
+        CHK_OFAIL(write_and_read(filename, dataModel, 1, &data, &size));
+        if (size != expectedSize || memcmp(data, expected, size) != 0)
+        {
+            mxf_log_error("Header metadata created from the templates differs (create %d)" LOG_LOC_FORMAT,
+                          i, LOG_LOC_PARAMS);
+            goto fail;
+        }
+        SAFE_FREE(&data);
+    }
+
+    /* the templates are created again after they are freed */
+    mxf_avid_free_default_metadictionary_template();
+    mxf_avid_free_default_dictionary_template();
+    for (i = 0; i < 2; i++)
+    {
+        CHK_OFAIL(write_and_read(filename, dataModel, 1, &data, &size));
+        if (size != expectedSize || memcmp(data, expected, size) != 0)
+        {
+            mxf_log_error("Header metadata created from re-created templates differs (create %d)" LOG_LOC_FORMAT,
+                          i, LOG_LOC_PARAMS);
+            goto fail;
+        }
+        SAFE_FREE(&data);
+    }
+
+    SAFE_FREE(&expected);
+    return 1;
+
+fail:
+    SAFE_FREE(&expected);
+    SAFE_FREE(&data);
+    return 0;
+}
+
+static int time_creates(MXFDataModel* dataModel, int useTemplate, double* usecPerCreate)
+{
+    MXFHeaderMetadata* headerMetadata = NULL;
+    clock_t start;
+    int i;
+
+    start = clock();
+    for (i = 0; i < NUM_TIMED_CREATES; i++)
+    {
+        CHK_OFAIL(mxf_create_header_metadata(&headerMetadata, dataModel));
+        CHK_OFAIL(create_dictionaries(headerMetadata, useTemplate));
+        mxf_free_header_metadata(&headerMetadata);
+    }
+    *usecPerCreate = (clock() - start) * 1000000.0 / CLOCKS_PER_SEC / NUM_TIMED_CREATES;
+
+    return 1;
+
+fail:
+    mxf_free_header_metadata(&headerMetadata);
+    return 0;
+}
+
+/* compares the time to create the meta-dictionary and dictionary with and without the templates */
+static int test_timing(MXFDataModel* dataModel)
+{
+    double withoutTemplate;
+    double withTemplate;
+
+    CHK_ORET(time_creates(dataModel, 0, &withoutTemplate));
+    CHK_ORET(time_creates(dataModel, 1, &withTemplate));
+
+    printf("meta-dictionary and dictionary creation (average of %d):\n", NUM_TIMED_CREATES);
+    printf("  without template: %8.1f us\n", withoutTemplate);
+    printf("  with template:    %8.1f us\n", withTemplate);
+
+    return 1;
+}
+
+
+void usage(const char* cmd)
+{
+    fprintf(stderr, "Usage: %s filename\n", cmd);
+}
+
+int main(int argc, const char* argv[])
+{
+    MXFDataModel* dataModel = NULL;
+    int result = 0;
+
+    if (argc != 2)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    mxf_generate_uuid = test_generate_uuid;
+
+    if (!mxf_load_data_model(&dataModel) ||
+        !mxf_avid_load_extensions(dataModel) ||
+        !mxf_finalise_data_model(dataModel))
+    {
+        fprintf(stderr, "Failed to load the data model\n");
+        mxf_free_data_model(&dataModel);
+        return 1;
+    }
+
+    if (!test_identical(argv[1], dataModel) ||
+        !test_timing(dataModel))
+    {
+        result = 1;
+    }
+
+    mxf_avid_free_default_metadictionary_template();
+    mxf_avid_free_default_dictionary_template();
+    mxf_free_data_model(&dataModel);
+
+    return result;
+}
+
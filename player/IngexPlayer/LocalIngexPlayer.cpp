@@ -427,883 +427,1012 @@ static void init_sound_streaminfo(StreamInfo* streamInfo)
     streamInfo->bitsPerSample = 16;
 }
 
-static void* player_thread(void* arg)
-{
-    PlayerThreadArgs* threadArg = (PlayerThreadArgs*)arg;
-
-    if (!ply_start_player(threadArg->playState->mediaPlayer, threadArg->startPaused))
-    {
-        ml_log_error("Media player failed to play\n");
-    }
-
-    pthread_exit((void*)0);
-}
-
-static void frame_displayed_event(void* data, const FrameInfo* frameInfo)
-{
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
-
-    size_t i;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
-    {
-        listener_registry->_listeners[i].first->frameDisplayedEvent(frameInfo);
-    }
-}
-
-static void frame_dropped_event(void* data, const FrameInfo* lastFrameInfo)
+static bool is_dvs_output(PlayerOutputType outputType)
 {
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
-
-    size_t i;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
-    {
-        listener_registry->_listeners[i].first->frameDroppedEvent(lastFrameInfo);
-    }
+    return outputType == DVS_OUTPUT ||
+        outputType == DUAL_DVS_AUTO_OUTPUT ||
+        outputType == DUAL_DVS_X11_OUTPUT ||
+        outputType == DUAL_DVS_X11_XV_OUTPUT;
 }
 
-static void state_change_event(void* data, const MediaPlayerStateEvent* event)
+static bool create_fallback_blank_source(MediaSource** mediaSource)
 {
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
+    StreamInfo streamInfo;
+    memset(&streamInfo, 0, sizeof(streamInfo));
+    streamInfo.type = PICTURE_STREAM_TYPE;
 
-    size_t i;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    if (!bks_create(&streamInfo, 2160000, mediaSource))
     {
-        listener_registry->_listeners[i].first->stateChangeEvent(event);
+        ml_log_error("Failed to create fallback blank source\n");
+        return false;
     }
-}
-
-static void end_of_source_event(void* data, const FrameInfo* lastReadFrameInfo)
-{
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
 
-    size_t i;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
-    {
-        listener_registry->_listeners[i].first->endOfSourceEvent(lastReadFrameInfo);
-    }
+    ml_log_info("Opened fallback blank video source\n");
+    return true;
 }
 
-static void start_of_source_event(void* data, const FrameInfo* firstReadFrameInfo)
-{
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
+static void* open_inputs_thread(void* arg);
 
-    size_t i;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
-    {
-        listener_registry->_listeners[i].first->startOfSourceEvent(firstReadFrameInfo);
-    }
-}
 
-static void close_request(void* data)
+// the opened sources for a set of inputs. The sources are either opened by prepare() just before playing or opened
+// in a separate thread by prepareNext() whilst the current inputs are still playing
+class prodauto::LocalIngexPlayerInputs
 {
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
-
-    size_t i;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
+public:
+    LocalIngexPlayerInputs(const vector<PlayerInput>& inputs_, const Rational* sourceAspectRatio, bool forceUYVYFormat)
+    : inputs(inputs_), multipleSource(0), mainMediaSource(0), videoStreamIndex(-1), largePictureScale(1),
+      shmDefaultTCType(UNKNOWN_TIMECODE_TYPE), shmDefaultTCSubType(NO_TIMECODE_SUBTYPE), atLeastOneInputOpened(false),
+      openThreadId(0), _sourceAspectRatio(*sourceAspectRatio), _forceUYVYFormat(forceUYVYFormat)
     {
-        listener_registry->_listeners[i].first->playerCloseRequested();
+        memset(&videoStreamInfo, 0, sizeof(videoStreamInfo));
     }
-}
-
-static void player_closed(void* data)
-{
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
 
-    size_t i;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    ~LocalIngexPlayerInputs()
     {
-        listener_registry->_listeners[i].first->playerClosed();
-    }
-}
-
-static void x11_key_pressed(void* data, int key, int modifier)
-{
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
+        waitUntilOpened();
 
-    size_t i;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
-    {
-        listener_registry->_listeners[i].first->keyPressed(key, modifier);
+        msc_close(mainMediaSource);
     }
-}
-
-static void x11_key_released(void* data, int key, int modifier)
-{
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
 
-    size_t i;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    bool openInBackground()
     {
-        listener_registry->_listeners[i].first->keyReleased(key, modifier);
+        return create_joinable_thread(&openThreadId, open_inputs_thread, this) != 0;
     }
-}
-
-static void x11_progress_bar_position_set(void* data, float position)
-{
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
 
-    size_t i;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    void waitUntilOpened()
     {
-        listener_registry->_listeners[i].first->progressBarPositionSet(position);
+        if (openThreadId != 0)
+        {
+            join_thread(&openThreadId, NULL, NULL);
+            openThreadId = 0;
+        }
     }
-}
-
-static void x11_mouse_clicked(void* data, int imageWidth, int imageHeight, int xPos, int yPos)
-{
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
 
-    size_t i;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    void open()
     {
-        listener_registry->_listeners[i].first->mouseClicked(imageWidth, imageHeight, xPos, yPos);
-    }
-}
-
-static void source_name_change_event(void* data, int sourceId, const char* name)
-{
-    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
-    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
-
-    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
+        // create a multiple source source
 
-    size_t i;
-    LocalIngexPlayerListenerData* listener_data;
-    int updatedSourceIndex;
-    for (i = 0; i < listener_registry->_listeners.size(); i++)
-    {
-        listener_data = dynamic_cast<LocalIngexPlayerListenerData*>(listener_registry->_listeners[i].second);
-        if (!listener_data)
+        if (!mls_create(&_sourceAspectRatio, -1, &g_palFrameRate, &multipleSource))
         {
-            listener_data = new LocalIngexPlayerListenerData();
-            listener_registry->_listeners[i].second = listener_data;
+            ml_log_error("Failed to create multiple source\n");
+            return;
         }
-        player->updateListenerData(listener_data);
+        mainMediaSource = mls_get_media_source(multipleSource);
 
-        updatedSourceIndex = listener_data->updateSourceName(sourceId, name);
-        if (updatedSourceIndex >= 0)
-        {
-            listener_registry->_listeners[i].first->sourceNameChangeEvent(updatedSourceIndex, name);
-        }
-    }
-}
 
+        // open the media sources
 
-LocalIngexPlayer::LocalIngexPlayer(IngexPlayerListenerRegistry* listenerRegistry)
-{
-    _config.outputType = X11_AUTO_OUTPUT;
-    _config.dvsCard = -1;
-    _config.dvsChannel = -1;
-    _config.videoSplit = QUAD_SPLIT_VIDEO_SWITCH;
-    _config.numFFMPEGThreads = 4;
-    _config.initiallyLocked = false;
-    _config.useWorkerThreads = true;
-    _config.applyScaleFilter = true;
-    _config.srcBufferSize = 0;
-    _config.disableSDIOSD = false;
-    _config.disableX11OSD = false;
-    _config.sourceAspectRatio = (Rational){0, 1};
-    _config.pixelAspectRatio = (Rational){1, 1};
-    _config.monitorAspectRatio = (Rational){4, 3};
-    _config.scale = 1.0;
-    _config.disablePCAudio = false;
-    _config.audioDevice = 0;
-    _config.numAudioLevelMonitors = 2;
-    _config.audioLineupLevel = -18.0;
-    _config.enableAudioSwitch = true;
-    _config.useDisplayDimensions = false;
-    memset(&_config.externalWindowInfo, 0, sizeof(_config.externalWindowInfo));
+        size_t inputIndex;
+        for (inputIndex = 0; inputIndex < inputs.size(); inputIndex++)
+        {
+            const PlayerInput& input = inputs[inputIndex];
+            MediaSource* mediaSource = 0;
+            StreamInfo streamInfo;
+            StreamInfo soundStreamInfo;
+            int numBalls = 5;
+            int numFFMPEGThreads = 0;
+            int sourceId;
+            bool fallbackBlank = parse_bool_option(input.options, "fallback_blank", false);
+            bool haveOpened = false;
+            bool inputPresent = false;
 
-    _nextConfig = _config;
+            memset(&streamInfo, 0, sizeof(streamInfo));
+            memset(&soundStreamInfo, 0, sizeof(soundStreamInfo));
 
-    _actualOutputType = X11_OUTPUT;
+            switch (input.type)
+            {
+                case MXF_INPUT:
+                {
+                    MXFFileSource* mxfSource = 0;
+                    if (!mxfs_open(input.name.c_str(), 0, 0, 0, 0, 0, 0, 0, 0, &mxfSource))
+                    {
+                        ml_log_warn("Failed to open MXF file source '%s'\n", input.name.c_str());
+                        if (fallbackBlank && create_fallback_blank_source(&mediaSource))
+                        {
+                            inputPresent = true;
+                        }
+                    }
+                    else
+                    {
+                        haveOpened = true;
+                        inputPresent = true;
+                        mediaSource = mxfs_get_media_source(mxfSource);
+                    }
+                }
+                break;
 
-    memset(&_windowInfo, 0, sizeof(_windowInfo));
+                case RAW_INPUT:
+                {
+                    parse_streaminfo_options(input.options, &streamInfo);
+                    if (!rfs_open(input.name.c_str(), &streamInfo, &mediaSource))
+                    {
+                        ml_log_warn("Failed to open raw file source '%s'\n", input.name.c_str());
+                        if (fallbackBlank && create_fallback_blank_source(&mediaSource))
+                        {
+                            inputPresent = true;
+                        }
+                    }
+                    else
+                    {
+                        haveOpened = true;
+                        inputPresent = true;
+                    }
+                }
+                break;
 
-    _x11WindowName = "Ingex Player";
+                case DV_INPUT:
+                {
+                    if (!rds_open(input.name.c_str(), &mediaSource))
+                    {
+                        ml_log_warn("Failed to open DV file source '%s'\n", input.name.c_str());
+                        if (fallbackBlank && create_fallback_blank_source(&mediaSource))
+                        {
+                            inputPresent = true;
+                        }
+                    }
+                    else
+                    {
+                        haveOpened = true;
+                        inputPresent = true;
+                    }
+                }
+                break;
 
-    _osdPlayStatePosition = OSD_PS_POSITION_BOTTOM;
+                case FFMPEG_INPUT:
+                {
+                    numFFMPEGThreads = parse_int_option(input.options, "num_ffmpeg_threads", 0);
+                    if (!fms_open(input.name.c_str(), numFFMPEGThreads, _forceUYVYFormat, &mediaSource))
+                    {
+                        ml_log_warn("Failed to open FFmpeg file source '%s'\n", input.name.c_str());
+                        if (fallbackBlank && create_fallback_blank_source(&mediaSource))
+                        {
+                            inputPresent = true;
+                        }
+                    }
+                    else
+                    {
+                        haveOpened = true;
+                        inputPresent = true;
+                    }
+                }
+                break;
 
-    _playState = 0;
+#ifndef DISABLE_SHARED_MEM_SOURCE
+                case SHM_INPUT:
+                {
+                    SharedMemSource* shmSource = 0;
+                    if (!shms_open(input.name.c_str(), 0, &shmSource))
+                    {
+                        ml_log_warn("Failed to open shared memory source '%s'\n", input.name.c_str());
+                        if (fallbackBlank && create_fallback_blank_source(&mediaSource))
+                        {
+                            inputPresent = true;
+                        }
+                    }
+                    else
+                    {
+                        mediaSource = shms_get_media_source(shmSource);
+    
+                        // check whether all streams are disabled - if true, then source is closed
+                        int numStreams = msc_get_num_streams(mediaSource);
+                        int i;
+                        bool allDisabled = true;
+                        for (i = 0; i < numStreams; i++)
+                        {
+                            if (!msc_stream_is_disabled(mediaSource, i))
+                            {
+                                allDisabled = false;
+                                break;
+                            }
+                        }
+                        if (allDisabled)
+                        {
+                            msc_close(mediaSource);
+                            ml_log_warn("Closed shared memory source '%s'\n", input.name.c_str());
+                            if (fallbackBlank && create_fallback_blank_source(&mediaSource))
+                            {
+                                inputPresent = true;
+                            }
+                        }
+                        else
+                        {
+                            haveOpened = true;
+                            inputPresent = true;
+                            shms_get_default_timecode(shmSource, &shmDefaultTCType, &shmDefaultTCSubType);
+                        }
+                    }
+                }
+                break;
+#endif
 
-    memset(&_mediaPlayerListener, 0, sizeof(MediaPlayerListener));
+                case UDP_INPUT:
+                {
+                    if (!udp_open(input.name.c_str(), &mediaSource))
+                    {
+                        ml_log_warn("Failed to open UDP source '%s'\n", input.name.c_str());
+                        if (fallbackBlank && create_fallback_blank_source(&mediaSource))
+                        {
+                            inputPresent = true;
+                        }
+                    }
+                    else
+                    {
+                        haveOpened = true;
+                        inputPresent = true;
+                    }
+                }
+                break;
 
-    _mediaPlayerListener.data = this;
-    _mediaPlayerListener.frame_displayed_event = frame_displayed_event;
-    _mediaPlayerListener.frame_dropped_event = frame_dropped_event;
-    _mediaPlayerListener.state_change_event = state_change_event;
-    _mediaPlayerListener.end_of_source_event = end_of_source_event;
-    _mediaPlayerListener.start_of_source_event = start_of_source_event;
-    _mediaPlayerListener.player_closed = player_closed;
-    _mediaPlayerListener.source_name_change_event = source_name_change_event;
+                case BALLS_INPUT:
+                {
+                    streamInfo.type = PICTURE_STREAM_TYPE;
+                    parse_streaminfo_options(input.options, &streamInfo);
+                    numBalls = parse_int_option(input.options, "num_balls", 5);
+                    if (!bbs_create(&streamInfo, 2160000, numBalls, &mediaSource))
+                    {
+                        ml_log_error("Failed to create bouncing balls source\n");
+                        if (fallbackBlank && create_fallback_blank_source(&mediaSource))
+                        {
+                            inputPresent = true;
+                        }
+                    }
+                    else
+                    {
+                        haveOpened = true;
+                        inputPresent = true;
+                    }
+                }
+                break;
 
+                case BLANK_INPUT:
+                {
+                    streamInfo.type = PICTURE_STREAM_TYPE;
+                    parse_streaminfo_options(input.options, &streamInfo);
+                    if (!bks_create(&streamInfo, 2160000, &mediaSource))
+                    {
+                        ml_log_error("Failed to create blank source\n");
+                        if (fallbackBlank && create_fallback_blank_source(&mediaSource))
+                        {
+                            inputPresent = true;
+                        }
+                    }
+                    else
+                    {
+                        haveOpened = true;
+                        inputPresent = true;
+                    }
+                }
+                break;
 
-    memset(&_x11WindowListener, 0, sizeof(X11WindowListener));
-    _x11WindowListener.data = this;
-    _x11WindowListener.close_request = close_request;
+                case CLAPPER_INPUT:
+                {
+                    streamInfo.type = PICTURE_STREAM_TYPE;
+                    parse_streaminfo_options(input.options, &streamInfo);
+                    init_sound_streaminfo(&soundStreamInfo);
+                    if (!clp_create(&streamInfo, &soundStreamInfo, 2160000, &mediaSource))
+                    {
+                        ml_log_error("Failed to create clapper source\n");
+                        if (fallbackBlank && create_fallback_blank_source(&mediaSource))
+                        {
+                            inputPresent = true;
+                        }
+                    }
+                    else
+                    {
+                        haveOpened = true;
+                        inputPresent = true;
+                    }
+                }
+                break;
+            }
 
-    memset(&_x11KeyListener, 0, sizeof(KeyboardInputListener));
-    _x11KeyListener.data = this;
-    _x11KeyListener.key_pressed = x11_key_pressed;
-    _x11KeyListener.key_released = x11_key_released;
+            opened.push_back(haveOpened);
+            inputsPresent.push_back(inputPresent);
+            if (!inputPresent)
+            {
+                continue;
+            }
 
-    memset(&_x11ProgressBarListener, 0, sizeof(ProgressBarInputListener));
-    _x11ProgressBarListener.data = this;
-    _x11ProgressBarListener.position_set = x11_progress_bar_position_set;
 
-    memset(&_x11MouseListener, 0, sizeof(MouseInputListener));
-    _x11MouseListener.data = this;
-    _x11MouseListener.click = x11_mouse_clicked;
+            // set software scaling to 2 if the material dimensions exceeds 1024
+            // also, get the index and info of the first video stream
+            if (largePictureScale == 1)
+            {
+                const StreamInfo* streamInfo;
+                int i;
+                int numStreams = msc_get_num_streams(mediaSource);
+                for (i = 0; i < numStreams; i++)
+                {
+                    if (msc_get_stream_info(mediaSource, i, &streamInfo))
+                    {
+                        if (videoStreamIndex == -1 && streamInfo->type == PICTURE_STREAM_TYPE)
+                        {
+                            videoStreamIndex = i;
+                            videoStreamInfo = *streamInfo;
+                        }
 
-    memset(&_videoStreamInfo, 0, sizeof(_videoStreamInfo));
+                        if (largePictureScale == 1 &&
+                            streamInfo->type == PICTURE_STREAM_TYPE &&
+                            (streamInfo->width > 1024 || streamInfo->height > 1024))
+                        {
+                            largePictureScale = 2;
+                        }
+                    }
+                }
+            }
 
+            // record sourceId to input index map
+            if (msc_get_id(mediaSource, &sourceId))
+            {
+                sourceIdToIndex[sourceId] = inputIndex;
+            }
 
-    _listenerRegistry = listenerRegistry;
-    _sourceIdToIndexVersion = 0;
+            if (!mls_assign_source(multipleSource, &mediaSource))
+            {
+                ml_log_error("Failed to assign source to multiple source\n");
+                msc_close(mediaSource);
+                atLeastOneInputOpened = false;
+                return;
+            }
+            atLeastOneInputOpened = true;
+        }
+    }
 
+    vector<PlayerInput> inputs;
 
-    pthread_mutex_init(&_configMutex, NULL);
-    pthread_rwlock_init(&_playStateRWLock, NULL);
+    MultipleMediaSources* multipleSource;
+    MediaSource* mainMediaSource;
 
-    init_dv_decoder_resources();
-    init_mjpeg_decoder_resources();
-}
+    vector<bool> opened;
+    vector<bool> inputsPresent;
+    map<int, int> sourceIdToIndex;
 
-LocalIngexPlayer::~LocalIngexPlayer()
-{
-    LocalIngexPlayerState* currentPlayState = 0;
-    {
-        ReadWriteLockGuard guard(&_playStateRWLock, true);
-        currentPlayState = _playState;
-        _playState = 0;
-    }
-    SAFE_DELETE(&currentPlayState);
+    int videoStreamIndex;
+    StreamInfo videoStreamInfo;
+    int largePictureScale;
 
-    pthread_mutex_destroy(&_configMutex);
-    pthread_rwlock_destroy(&_playStateRWLock);
+    TimecodeType shmDefaultTCType;
+    TimecodeSubType shmDefaultTCSubType;
 
-    free_dv_decoder_resources();
-    free_mjpeg_decoder_resources();
-}
+    bool atLeastOneInputOpened;
 
-string LocalIngexPlayer::getVersion()
-{
-    return g_playerVersion;
-}
+    pthread_t openThreadId;
 
-string LocalIngexPlayer::getBuildTimestamp()
-{
-    return g_playerBuildTimestamp;
-}
+private:
+    Rational _sourceAspectRatio;
+    bool _forceUYVYFormat;
+};
 
-bool LocalIngexPlayer::dvsCardIsAvailable()
+static void* open_inputs_thread(void* arg)
 {
-    return dvsCardIsAvailable(-1, -1);
-}
+    LocalIngexPlayerInputs* inputs = (LocalIngexPlayerInputs*)arg;
 
-bool LocalIngexPlayer::dvsCardIsAvailable(int card, int channel)
-{
-    return dvs_card_is_available(card, channel) == 1;
-}
+    inputs->open();
 
-bool LocalIngexPlayer::x11XVIsAvailable()
-{
-    return xvsk_check_is_available() == 1;
+    pthread_exit((void*)0);
 }
 
-void LocalIngexPlayer::setWindowInfo(const X11WindowInfo* windowInfo)
+static void* player_thread(void* arg)
 {
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.externalWindowInfo = *windowInfo;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
-}
+    PlayerThreadArgs* threadArg = (PlayerThreadArgs*)arg;
 
-void LocalIngexPlayer::setInitiallyLocked(bool locked)
-{
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.initiallyLocked = locked;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
-}
+    if (!ply_start_player(threadArg->playState->mediaPlayer, threadArg->startPaused))
+    {
+        ml_log_error("Media player failed to play\n");
+    }
 
-void LocalIngexPlayer::setNumFFMPEGThreads(int num)
-{
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.numFFMPEGThreads = num;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+    pthread_exit((void*)0);
 }
 
-void LocalIngexPlayer::setUseWorkerThreads(bool enable)
+static void frame_displayed_event(void* data, const FrameInfo* frameInfo)
 {
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.useWorkerThreads = enable;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
-}
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
 
-void LocalIngexPlayer::setApplyScaleFilter(bool enable)
-{
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.applyScaleFilter = enable;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
-}
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
 
-void LocalIngexPlayer::setSourceBufferSize(int size)
-{
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.srcBufferSize = size;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+    size_t i;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    {
+        listener_registry->_listeners[i].first->frameDisplayedEvent(frameInfo);
+    }
 }
 
-void LocalIngexPlayer::setEnableX11OSD(bool enable)
+static void frame_dropped_event(void* data, const FrameInfo* lastFrameInfo)
 {
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.disableX11OSD = !enable;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
-}
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
 
-void LocalIngexPlayer::setSourceAspectRatio(Rational *aspect)
-{
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.sourceAspectRatio = *aspect;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
-}
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
 
-void LocalIngexPlayer::setPixelAspectRatio(Rational *aspect)
-{
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.pixelAspectRatio = *aspect;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+    size_t i;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    {
+        listener_registry->_listeners[i].first->frameDroppedEvent(lastFrameInfo);
+    }
 }
 
-void LocalIngexPlayer::setMonitorAspectRatio(Rational *aspect)
+static void state_change_event(void* data, const MediaPlayerStateEvent* event)
 {
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.monitorAspectRatio = *aspect;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
-}
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
 
-void LocalIngexPlayer::setEnablePCAudio(bool enable)
-{
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.disablePCAudio = !enable;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
-}
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
 
-void LocalIngexPlayer::setAudioDevice(int device)
-{
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.audioDevice = device;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+    size_t i;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    {
+        listener_registry->_listeners[i].first->stateChangeEvent(event);
+    }
 }
 
-void LocalIngexPlayer::setNumAudioLevelMonitors(int num)
+static void end_of_source_event(void* data, const FrameInfo* lastReadFrameInfo)
 {
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.numAudioLevelMonitors = num;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
-}
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
 
-void LocalIngexPlayer::setAudioLineupLevel(float level)
-{
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.audioLineupLevel = level;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
-}
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
 
-void LocalIngexPlayer::setEnableAudioSwitch(bool enable)
-{
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.enableAudioSwitch = enable;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+    size_t i;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    {
+        listener_registry->_listeners[i].first->endOfSourceEvent(lastReadFrameInfo);
+    }
 }
 
-void LocalIngexPlayer::setOutputType(PlayerOutputType outputType)
+static void start_of_source_event(void* data, const FrameInfo* firstReadFrameInfo)
 {
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.outputType = outputType;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
-}
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
 
-void LocalIngexPlayer::setScale(float scale)
-{
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.scale = scale;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
+
+    size_t i;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    {
+        listener_registry->_listeners[i].first->startOfSourceEvent(firstReadFrameInfo);
+    }
 }
 
-void LocalIngexPlayer::setDVSTarget(int card, int channel)
+static void close_request(void* data)
 {
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.dvsCard = card;
-    _nextConfig.dvsChannel = channel;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
+
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
+
+    size_t i;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    {
+        listener_registry->_listeners[i].first->playerCloseRequested();
+    }
 }
 
-void LocalIngexPlayer::setVideoSplit(VideoSwitchSplit videoSplit)
+static void player_closed(void* data)
 {
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.videoSplit = videoSplit;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
+
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
+
+    size_t i;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    {
+        listener_registry->_listeners[i].first->playerClosed();
+    }
 }
 
-void LocalIngexPlayer::setSDIOSDEnable(bool enable)
+static void x11_key_pressed(void* data, int key, int modifier)
 {
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.disableSDIOSD = !enable;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
+
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
+
+    size_t i;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    {
+        listener_registry->_listeners[i].first->keyPressed(key, modifier);
+    }
 }
 
-void LocalIngexPlayer::setUseDisplayDimensions(bool enable)
+static void x11_key_released(void* data, int key, int modifier)
 {
-    PTHREAD_MUTEX_LOCK(&_configMutex);
-    _nextConfig.useDisplayDimensions = enable;
-    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
+
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
+
+    size_t i;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
+    {
+        listener_registry->_listeners[i].first->keyReleased(key, modifier);
+    }
 }
 
-bool LocalIngexPlayer::reset()
+static void x11_progress_bar_position_set(void* data, float position)
 {
-    try
-    {
-        ReadWriteLockGuard guard(&_playStateRWLock, false);
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
 
-        if (!_playState)
-        {
-            // no player - pretend the reset failed and the player was closed
-            return false;
-        }
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
 
-        _playState->stopPlaying();
-        return _playState->reset();
-    }
-    catch (...)
+    size_t i;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
     {
-        return false;
+        listener_registry->_listeners[i].first->progressBarPositionSet(position);
     }
 }
 
-bool LocalIngexPlayer::close()
+static void x11_mouse_clicked(void* data, int imageWidth, int imageHeight, int xPos, int yPos)
 {
-    try
-    {
-        LocalIngexPlayerState* currentPlayState = 0;
-        {
-            ReadWriteLockGuard guard(&_playStateRWLock, true);
-            currentPlayState = _playState;
-            _playState = 0;
-        }
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
 
-        SAFE_DELETE(&currentPlayState);
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
 
-        closeLocalX11Window();
-    }
-    catch (...)
+    size_t i;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
     {
-        return false;
+        listener_registry->_listeners[i].first->mouseClicked(imageWidth, imageHeight, xPos, yPos);
     }
-    return true;
 }
 
-bool LocalIngexPlayer::prepare(vector<PlayerInput> inputs, vector<bool>& opened)
+static void source_name_change_event(void* data, int sourceId, const char* name)
 {
-    auto_ptr<LocalIngexPlayerState> newPlayState;
-    MultipleMediaSources* multipleSource = 0;
-    BufferedMediaSource* bufferedSource = 0;
-    DVSSink* dvsSink = 0;
-    X11DisplaySink* x11Sink = 0;
-    X11XVDisplaySink* x11XVSink = 0;
-    BufferedMediaSink* bufSink = 0;
-    DualSink* dualSink = 0;
-    bool haveReset = false;
-    LocalIngexPlayerState* currentPlayState = 0;
-    int largePictureScale = 1;
-    int swScale;
-    int scale;
-    vector<bool> inputsPresent;
-    MediaSource* mainMediaSource = 0;
-    bool forceUYVYFormat;
-    Configuration nextConfig;
+    LocalIngexPlayer* player = (LocalIngexPlayer*)data;
+    IngexPlayerListenerRegistry* listener_registry = player->_listenerRegistry;
 
-    try
+    ReadWriteLockGuard guard(&listener_registry->_listenersRWLock, false);
+
+    size_t i;
+    LocalIngexPlayerListenerData* listener_data;
+    int updatedSourceIndex;
+    for (i = 0; i < listener_registry->_listeners.size(); i++)
     {
-        if (inputs.size() == 0)
+        listener_data = dynamic_cast<LocalIngexPlayerListenerData*>(listener_registry->_listeners[i].second);
+        if (!listener_data)
         {
-            THROW_EXCEPTION(("No files to play\n"));
+            listener_data = new LocalIngexPlayerListenerData();
+            listener_registry->_listeners[i].second = listener_data;
         }
+        player->updateListenerData(listener_data);
 
-        // effectively disable client access to the player
+        updatedSourceIndex = listener_data->updateSourceName(sourceId, name);
+        if (updatedSourceIndex >= 0)
         {
-            ReadWriteLockGuard guard(&_playStateRWLock, true);
-            currentPlayState = _playState;
-            _playState = 0;
+            listener_registry->_listeners[i].first->sourceNameChangeEvent(updatedSourceIndex, name);
         }
+    }
+}
 
-        // reset listener data
-        {
-            ReadWriteLockGuard guard(&_listenerRegistry->_listenersRWLock, true);
-            _sourceIdToIndexVersion++;
-            _sourceIdToIndex.clear();
-        }
 
-        // stop playing
-        if (currentPlayState)
-        {
-            currentPlayState->stopPlaying();
-        }
+LocalIngexPlayer::LocalIngexPlayer(IngexPlayerListenerRegistry* listenerRegistry)
+{
+    _config.outputType = X11_AUTO_OUTPUT;
+    _config.dvsCard = -1;
+    _config.dvsChannel = -1;
+    _config.videoSplit = QUAD_SPLIT_VIDEO_SWITCH;
+    _config.numFFMPEGThreads = 4;
+    _config.initiallyLocked = false;
+    _config.useWorkerThreads = true;
+    _config.applyScaleFilter = true;
+    _config.srcBufferSize = 0;
+    _config.disableSDIOSD = false;
+    _config.disableX11OSD = false;
+    _config.sourceAspectRatio = (Rational){0, 1};
+    _config.pixelAspectRatio = (Rational){1, 1};
+    _config.monitorAspectRatio = (Rational){4, 3};
+    _config.scale = 1.0;
+    _config.disablePCAudio = false;
+    _config.audioDevice = 0;
+    _config.numAudioLevelMonitors = 2;
+    _config.audioLineupLevel = -18.0;
+    _config.enableAudioSwitch = true;
+    _config.useDisplayDimensions = false;
+    memset(&_config.externalWindowInfo, 0, sizeof(_config.externalWindowInfo));
 
-        // get the next config
-        PTHREAD_MUTEX_LOCK(&_configMutex);
-        nextConfig = _nextConfig;
-        PTHREAD_MUTEX_UNLOCK(&_configMutex);
+    _nextConfig = _config;
 
+    _actualOutputType = X11_OUTPUT;
 
-        // create a multiple source source
+    memset(&_windowInfo, 0, sizeof(_windowInfo));
 
-        CHK_OTHROW(mls_create(&nextConfig.sourceAspectRatio, -1, &g_palFrameRate, &multipleSource));
-        mainMediaSource = mls_get_media_source(multipleSource);
+    _x11WindowName = "Ingex Player";
 
+    _osdPlayStatePosition = OSD_PS_POSITION_BOTTOM;
 
-        // open the media sources
+    _playState = 0;
 
-        _shmDefaultTCType = UNKNOWN_TIMECODE_TYPE;
-        _shmDefaultTCSubType = NO_TIMECODE_SUBTYPE;
+    _nextInputs = 0;
 
-        int videoStreamIndex = -1;
-        bool videoChanged = false;
-        bool atLeastOneInputOpened = false;
-        size_t inputIndex;
-        map<int, int> newSourceIdToIndex;
-        for (inputIndex = 0; inputIndex < inputs.size(); inputIndex++)
-        {
-            const PlayerInput& input = inputs[inputIndex];
-            MediaSource* mediaSource = 0;
-            StreamInfo streamInfo;
-            StreamInfo soundStreamInfo;
-            int numBalls = 5;
-            int numFFMPEGThreads = 0;
-            int sourceId;
-            bool fallbackBlank = parse_bool_option(input.options, "fallback_blank", false);
-            bool haveOpened = false;
-            bool inputPresent = false;
+    memset(&_mediaPlayerListener, 0, sizeof(MediaPlayerListener));
 
-            memset(&streamInfo, 0, sizeof(streamInfo));
-            memset(&soundStreamInfo, 0, sizeof(soundStreamInfo));
+    _mediaPlayerListener.data = this;
+    _mediaPlayerListener.frame_displayed_event = frame_displayed_event;
+    _mediaPlayerListener.frame_dropped_event = frame_dropped_event;
+    _mediaPlayerListener.state_change_event = state_change_event;
+    _mediaPlayerListener.end_of_source_event = end_of_source_event;
+    _mediaPlayerListener.start_of_source_event = start_of_source_event;
+    _mediaPlayerListener.player_closed = player_closed;
+    _mediaPlayerListener.source_name_change_event = source_name_change_event;
 
-            switch (input.type)
-            {
-                case MXF_INPUT:
-                {
-                    MXFFileSource* mxfSource = 0;
-                    if (!mxfs_open(input.name.c_str(), 0, 0, 0, 0, 0, 0, 0, 0, &mxfSource))
-                    {
-                        ml_log_warn("Failed to open MXF file source '%s'\n", input.name.c_str());
-                        if (fallbackBlank && createFallbackBlankSource(&mediaSource))
-                        {
-                            inputPresent = true;
-                        }
-                    }
-                    else
-                    {
-                        haveOpened = true;
-                        inputPresent = true;
-                        mediaSource = mxfs_get_media_source(mxfSource);
-                    }
-                }
-                break;
 
-                case RAW_INPUT:
-                {
-                    parse_streaminfo_options(input.options, &streamInfo);
-                    if (!rfs_open(input.name.c_str(), &streamInfo, &mediaSource))
-                    {
-                        ml_log_warn("Failed to open raw file source '%s'\n", input.name.c_str());
-                        if (fallbackBlank && createFallbackBlankSource(&mediaSource))
-                        {
-                            inputPresent = true;
-                        }
-                    }
-                    else
-                    {
-                        haveOpened = true;
-                        inputPresent = true;
-                    }
-                }
-                break;
+    memset(&_x11WindowListener, 0, sizeof(X11WindowListener));
+    _x11WindowListener.data = this;
+    _x11WindowListener.close_request = close_request;
 
-                case DV_INPUT:
-                {
-                    if (!rds_open(input.name.c_str(), &mediaSource))
-                    {
-                        ml_log_warn("Failed to open DV file source '%s'\n", input.name.c_str());
-                        if (fallbackBlank && createFallbackBlankSource(&mediaSource))
-                        {
-                            inputPresent = true;
-                        }
-                    }
-                    else
-                    {
-                        haveOpened = true;
-                        inputPresent = true;
-                    }
-                }
-                break;
+    memset(&_x11KeyListener, 0, sizeof(KeyboardInputListener));
+    _x11KeyListener.data = this;
+    _x11KeyListener.key_pressed = x11_key_pressed;
+    _x11KeyListener.key_released = x11_key_released;
 
-                case FFMPEG_INPUT:
-                {
-                    forceUYVYFormat = (nextConfig.outputType == DVS_OUTPUT ||
-                        nextConfig.outputType == DUAL_DVS_AUTO_OUTPUT ||
-                        nextConfig.outputType == DUAL_DVS_X11_OUTPUT ||
-                        nextConfig.outputType == DUAL_DVS_X11_XV_OUTPUT);
-                    numFFMPEGThreads = parse_int_option(input.options, "num_ffmpeg_threads", 0);
-                    if (!fms_open(input.name.c_str(), numFFMPEGThreads, forceUYVYFormat, &mediaSource))
-                    {
-                        ml_log_warn("Failed to open FFmpeg file source '%s'\n", input.name.c_str());
-                        if (fallbackBlank && createFallbackBlankSource(&mediaSource))
-                        {
-                            inputPresent = true;
-                        }
-                    }
-                    else
-                    {
-                        haveOpened = true;
-                        inputPresent = true;
-                    }
-                }
-                break;
+    memset(&_x11ProgressBarListener, 0, sizeof(ProgressBarInputListener));
+    _x11ProgressBarListener.data = this;
+    _x11ProgressBarListener.position_set = x11_progress_bar_position_set;
 
-#ifndef DISABLE_SHARED_MEM_SOURCE
-                case SHM_INPUT:
-                {
-                    SharedMemSource* shmSource = 0;
-                    if (!shms_open(input.name.c_str(), 0, &shmSource))
-                    {
-                        ml_log_warn("Failed to open shared memory source '%s'\n", input.name.c_str());
-                        if (fallbackBlank && createFallbackBlankSource(&mediaSource))
-                        {
-                            inputPresent = true;
-                        }
-                    }
-                    else
-                    {
-                        mediaSource = shms_get_media_source(shmSource);
-    
-                        // check whether all streams are disabled - if true, then source is closed
-                        int numStreams = msc_get_num_streams(mediaSource);
-                        int i;
-                        bool allDisabled = true;
-                        for (i = 0; i < numStreams; i++)
-                        {
-                            if (!msc_stream_is_disabled(mediaSource, i))
-                            {
-                                allDisabled = false;
-                                break;
-                            }
-                        }
-                        if (allDisabled)
-                        {
-                            msc_close(mediaSource);
-                            ml_log_warn("Closed shared memory source '%s'\n", input.name.c_str());
-                            if (fallbackBlank && createFallbackBlankSource(&mediaSource))
-                            {
-                                inputPresent = true;
-                            }
-                        }
-                        else
-                        {
-                            haveOpened = true;
-                            inputPresent = true;
-                            shms_get_default_timecode(shmSource, &_shmDefaultTCType, &_shmDefaultTCSubType);
-                        }
-                    }
-                }
-                break;
-#endif
+    memset(&_x11MouseListener, 0, sizeof(MouseInputListener));
+    _x11MouseListener.data = this;
+    _x11MouseListener.click = x11_mouse_clicked;
 
-                case UDP_INPUT:
-                {
-                    if (!udp_open(input.name.c_str(), &mediaSource))
-                    {
-                        ml_log_warn("Failed to open UDP source '%s'\n", input.name.c_str());
-                        if (fallbackBlank && createFallbackBlankSource(&mediaSource))
-                        {
-                            inputPresent = true;
-                        }
-                    }
-                    else
-                    {
-                        haveOpened = true;
-                        inputPresent = true;
-                    }
-                }
-                break;
+    memset(&_videoStreamInfo, 0, sizeof(_videoStreamInfo));
 
-                case BALLS_INPUT:
-                {
-                    streamInfo.type = PICTURE_STREAM_TYPE;
-                    parse_streaminfo_options(input.options, &streamInfo);
-                    numBalls = parse_int_option(input.options, "num_balls", 5);
-                    if (!bbs_create(&streamInfo, 2160000, numBalls, &mediaSource))
-                    {
-                        ml_log_error("Failed to create bouncing balls source\n");
-                        if (fallbackBlank && createFallbackBlankSource(&mediaSource))
-                        {
-                            inputPresent = true;
-                        }
-                    }
-                    else
-                    {
-                        haveOpened = true;
-                        inputPresent = true;
-                    }
-                }
-                break;
 
-                case BLANK_INPUT:
-                {
-                    streamInfo.type = PICTURE_STREAM_TYPE;
-                    parse_streaminfo_options(input.options, &streamInfo);
-                    if (!bks_create(&streamInfo, 2160000, &mediaSource))
-                    {
-                        ml_log_error("Failed to create blank source\n");
-                        if (fallbackBlank && createFallbackBlankSource(&mediaSource))
-                        {
-                            inputPresent = true;
-                        }
-                    }
-                    else
-                    {
-                        haveOpened = true;
-                        inputPresent = true;
-                    }
-                }
-                break;
+    _listenerRegistry = listenerRegistry;
+    _sourceIdToIndexVersion = 0;
+
+
+    pthread_mutex_init(&_configMutex, NULL);
+    pthread_rwlock_init(&_playStateRWLock, NULL);
+    pthread_mutex_init(&_nextInputsMutex, NULL);
+
+    init_dv_decoder_resources();
+    init_mjpeg_decoder_resources();
+}
+
+LocalIngexPlayer::~LocalIngexPlayer()
+{
+    cancelNext();
+
+    LocalIngexPlayerState* currentPlayState = 0;
+    {
+        ReadWriteLockGuard guard(&_playStateRWLock, true);
+        currentPlayState = _playState;
+        _playState = 0;
+    }
+    SAFE_DELETE(&currentPlayState);
+
+    pthread_mutex_destroy(&_configMutex);
+    pthread_rwlock_destroy(&_playStateRWLock);
+    pthread_mutex_destroy(&_nextInputsMutex);
+
+    free_dv_decoder_resources();
+    free_mjpeg_decoder_resources();
+}
+
+string LocalIngexPlayer::getVersion()
+{
+    return g_playerVersion;
+}
+
+string LocalIngexPlayer::getBuildTimestamp()
+{
+    return g_playerBuildTimestamp;
+}
+
+bool LocalIngexPlayer::dvsCardIsAvailable()
+{
+    return dvsCardIsAvailable(-1, -1);
+}
+
+bool LocalIngexPlayer::dvsCardIsAvailable(int card, int channel)
+{
+    return dvs_card_is_available(card, channel) == 1;
+}
+
+bool LocalIngexPlayer::x11XVIsAvailable()
+{
+    return xvsk_check_is_available() == 1;
+}
+
+void LocalIngexPlayer::setWindowInfo(const X11WindowInfo* windowInfo)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.externalWindowInfo = *windowInfo;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setInitiallyLocked(bool locked)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.initiallyLocked = locked;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setNumFFMPEGThreads(int num)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.numFFMPEGThreads = num;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setUseWorkerThreads(bool enable)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.useWorkerThreads = enable;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setApplyScaleFilter(bool enable)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.applyScaleFilter = enable;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setSourceBufferSize(int size)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.srcBufferSize = size;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setEnableX11OSD(bool enable)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.disableX11OSD = !enable;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setSourceAspectRatio(Rational *aspect)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.sourceAspectRatio = *aspect;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setPixelAspectRatio(Rational *aspect)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.pixelAspectRatio = *aspect;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setMonitorAspectRatio(Rational *aspect)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.monitorAspectRatio = *aspect;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setEnablePCAudio(bool enable)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.disablePCAudio = !enable;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setAudioDevice(int device)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.audioDevice = device;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setNumAudioLevelMonitors(int num)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.numAudioLevelMonitors = num;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setAudioLineupLevel(float level)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.audioLineupLevel = level;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setEnableAudioSwitch(bool enable)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.enableAudioSwitch = enable;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setOutputType(PlayerOutputType outputType)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.outputType = outputType;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setScale(float scale)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.scale = scale;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setDVSTarget(int card, int channel)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.dvsCard = card;
+    _nextConfig.dvsChannel = channel;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setVideoSplit(VideoSwitchSplit videoSplit)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.videoSplit = videoSplit;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setSDIOSDEnable(bool enable)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.disableSDIOSD = !enable;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+void LocalIngexPlayer::setUseDisplayDimensions(bool enable)
+{
+    PTHREAD_MUTEX_LOCK(&_configMutex);
+    _nextConfig.useDisplayDimensions = enable;
+    PTHREAD_MUTEX_UNLOCK(&_configMutex);
+}
+
+bool LocalIngexPlayer::reset()
+{
+    try
+    {
+        ReadWriteLockGuard guard(&_playStateRWLock, false);
+
+        if (!_playState)
+        {
+            // no player - pretend the reset failed and the player was closed
+            return false;
+        }
 
-                case CLAPPER_INPUT:
-                {
-                    streamInfo.type = PICTURE_STREAM_TYPE;
-                    parse_streaminfo_options(input.options, &streamInfo);
-                    init_sound_streaminfo(&soundStreamInfo);
-                    if (!clp_create(&streamInfo, &soundStreamInfo, 2160000, &mediaSource))
-                    {
-                        ml_log_error("Failed to create clapper source\n");
-                        if (fallbackBlank && createFallbackBlankSource(&mediaSource))
-                        {
-                            inputPresent = true;
-                        }
-                    }
-                    else
-                    {
-                        haveOpened = true;
-                        inputPresent = true;
-                    }
-                }
-                break;
-            }
+        _playState->stopPlaying();
+        return _playState->reset();
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
 
-            opened.push_back(haveOpened);
-            inputsPresent.push_back(inputPresent);
-            if (!inputPresent)
-            {
-                continue;
-            }
-            atLeastOneInputOpened = true;
+bool LocalIngexPlayer::close()
+{
+    try
+    {
+        cancelNext();
 
+        LocalIngexPlayerState* currentPlayState = 0;
+        {
+            ReadWriteLockGuard guard(&_playStateRWLock, true);
+            currentPlayState = _playState;
+            _playState = 0;
+        }
 
-            // set software scaling to 2 if the material dimensions exceeds 1024
-            // also, get the index of the first video stream
-            // also, check if the video format has changed
-            if (largePictureScale == 1)
-            {
-                const StreamInfo* streamInfo;
-                int i;
-                int numStreams = msc_get_num_streams(mediaSource);
-                for (i = 0; i < numStreams; i++)
-                {
-                    if (msc_get_stream_info(mediaSource, i, &streamInfo))
-                    {
-                        if (videoStreamIndex == -1 && streamInfo->type == PICTURE_STREAM_TYPE)
-                        {
-                            videoStreamIndex = i;
+        SAFE_DELETE(&currentPlayState);
 
-                            if (_videoStreamInfo.type == PICTURE_STREAM_TYPE)
-                            {
-                                if (streamInfo->format != _videoStreamInfo.format ||
-                                    streamInfo->width != _videoStreamInfo.width ||
-                                    streamInfo->height != _videoStreamInfo.height ||
-                                    memcmp(&streamInfo->aspectRatio, &_videoStreamInfo.aspectRatio, sizeof(_videoStreamInfo.aspectRatio)))
-                                {
-                                    videoChanged = true;
-                                }
-                            }
+        closeLocalX11Window();
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
 
-                            _videoStreamInfo = *streamInfo;
-                        }
+bool LocalIngexPlayer::prepare(vector<PlayerInput> inputs, vector<bool>& opened)
+{
+    auto_ptr<LocalIngexPlayerInputs> openedInputs;
+    LocalIngexPlayerState* currentPlayState = 0;
+    Configuration nextConfig;
 
-                        if (largePictureScale == 1 &&
-                            streamInfo->type == PICTURE_STREAM_TYPE &&
-                            (streamInfo->width > 1024 || streamInfo->height > 1024))
-                        {
-                            largePictureScale = 2;
-                        }
-                    }
-                }
-            }
+    try
+    {
+        if (inputs.size() == 0)
+        {
+            THROW_EXCEPTION(("No files to play\n"));
+        }
 
-            // record sourceId to input index map
-            if (msc_get_id(mediaSource, &sourceId))
-            {
-                newSourceIdToIndex[sourceId] = inputIndex;
-            }
+        // inputs prepared for startNext() are no longer wanted
+        cancelNext();
+
+        // effectively disable client access to the player
+        {
+            ReadWriteLockGuard guard(&_playStateRWLock, true);
+            currentPlayState = _playState;
+            _playState = 0;
+        }
+
+        // reset listener data
+        {
+            ReadWriteLockGuard guard(&_listenerRegistry->_listenersRWLock, true);
+            _sourceIdToIndexVersion++;
+            _sourceIdToIndex.clear();
+        }
 
-            CHK_OTHROW(mls_assign_source(multipleSource, &mediaSource));
+        // stop playing
+        if (currentPlayState)
+        {
+            currentPlayState->stopPlaying();
         }
 
+        // get the next config
+        PTHREAD_MUTEX_LOCK(&_configMutex);
+        nextConfig = _nextConfig;
+        PTHREAD_MUTEX_UNLOCK(&_configMutex);
+
+
+        // open the media sources
+
+        openedInputs = auto_ptr<LocalIngexPlayerInputs>(new LocalIngexPlayerInputs(inputs,
+            &nextConfig.sourceAspectRatio, is_dvs_output(nextConfig.outputType)));
+        openedInputs->open();
+        opened.insert(opened.end(), openedInputs->opened.begin(), openedInputs->opened.end());
+
         // check at least one input could be opened
-        if (!atLeastOneInputOpened)
+        if (!openedInputs->atLeastOneInputOpened)
+        {
+            ReadWriteLockGuard guard(&_playStateRWLock, true);
+            _playState = currentPlayState;
+            return false;
+        }
+
+        if (!preparePlayState(openedInputs.get(), currentPlayState, nextConfig))
         {
-            msc_close(mainMediaSource);
-            {
-                ReadWriteLockGuard guard(&_playStateRWLock, true);
-                _playState = currentPlayState;
-            }
             return false;
         }
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
+
+bool LocalIngexPlayer::preparePlayState(LocalIngexPlayerInputs* openedInputs, LocalIngexPlayerState* currentPlayState,
+                                        const Configuration& nextConfig)
+{
+    auto_ptr<LocalIngexPlayerState> newPlayState;
+    BufferedMediaSource* bufferedSource = 0;
+    DVSSink* dvsSink = 0;
+    X11DisplaySink* x11Sink = 0;
+    X11XVDisplaySink* x11XVSink = 0;
+    BufferedMediaSink* bufSink = 0;
+    DualSink* dualSink = 0;
+    bool haveReset = false;
+    bool videoChanged = false;
+    int swScale;
+    int scale;
 
+    try
+    {
+        // check if the video format has changed, or add a blank video source if no video source is present
 
-        // add a blank video source if no video source is present
+        if (openedInputs->videoStreamIndex != -1)
+        {
+            if (_videoStreamInfo.type == PICTURE_STREAM_TYPE)
+            {
+                const StreamInfo* streamInfo = &openedInputs->videoStreamInfo;
+                if (streamInfo->format != _videoStreamInfo.format ||
+                    streamInfo->width != _videoStreamInfo.width ||
+                    streamInfo->height != _videoStreamInfo.height ||
+                    memcmp(&streamInfo->aspectRatio, &_videoStreamInfo.aspectRatio, sizeof(_videoStreamInfo.aspectRatio)))
+                {
+                    videoChanged = true;
+                }
+            }
 
-        if (videoStreamIndex == -1)
+            _videoStreamInfo = openedInputs->videoStreamInfo;
+        }
+        else
         {
             if (_videoStreamInfo.type == PICTURE_STREAM_TYPE)
             {
@@ -1339,16 +1468,15 @@ bool LocalIngexPlayer::prepare(vector<PlayerInput> inputs, vector<bool>& opened)
 
             MediaSource* mediaSource;
             CHK_OTHROW(bks_create(&_videoStreamInfo, 120 * 60 * 60 * 25, &mediaSource));
-            CHK_OTHROW(mls_assign_source(multipleSource, &mediaSource));
-
+            CHK_OTHROW(mls_assign_source(openedInputs->multipleSource, &mediaSource));
         }
 
         // open the buffered media source
 
         if (nextConfig.srcBufferSize > 0)
         {
-            CHK_OTHROW(bmsrc_create(mainMediaSource, nextConfig.srcBufferSize, 1, -1.0, &bufferedSource));
-            mainMediaSource = bmsrc_get_source(bufferedSource);
+            CHK_OTHROW(bmsrc_create(openedInputs->mainMediaSource, nextConfig.srcBufferSize, 1, -1.0, &bufferedSource));
+            openedInputs->mainMediaSource = bmsrc_get_source(bufferedSource);
         }
 
 
@@ -1465,10 +1593,9 @@ bool LocalIngexPlayer::prepare(vector<PlayerInput> inputs, vector<bool>& opened)
             newPlayState = auto_ptr<LocalIngexPlayerState>(new LocalIngexPlayerState());
         }
 
-        newPlayState->mediaSource = mainMediaSource;
-        mainMediaSource = 0;
-        newPlayState->inputsPresent = inputsPresent;
-        inputsPresent.clear();
+        newPlayState->mediaSource = openedInputs->mainMediaSource;
+        openedInputs->mainMediaSource = 0;
+        newPlayState->inputsPresent = openedInputs->inputsPresent;
 
 
 
@@ -1511,7 +1638,7 @@ bool LocalIngexPlayer::prepare(vector<PlayerInput> inputs, vector<bool>& opened)
 
 
             scale = nextConfig.scale;
-            swScale = largePictureScale;
+            swScale = openedInputs->largePictureScale;
 #if defined(ENABLE_GC_LARGE_PICT)
             // get the graphics card to scale the large picture and avoid expensive software scaling
             if (swScale != 1 && (_actualOutputType == X11_XV_OUTPUT || _actualOutputType == DUAL_DVS_X11_XV_OUTPUT))
@@ -1703,7 +1830,7 @@ bool LocalIngexPlayer::prepare(vector<PlayerInput> inputs, vector<bool>& opened)
                 newPlayState->mediaSink = asw_get_media_sink(audioSwitch);
 
                 // if blank video source then default to not snap audio to video
-                if (videoStreamIndex == -1)
+                if (openedInputs->videoStreamIndex == -1)
                 {
                     asw_snap_audio_to_video(audioSwitch, 0);
                 }
@@ -1732,6 +1859,8 @@ bool LocalIngexPlayer::prepare(vector<PlayerInput> inputs, vector<bool>& opened)
 
 
         // set timecode type to display if shared memory present
+        _shmDefaultTCType = openedInputs->shmDefaultTCType;
+        _shmDefaultTCSubType = openedInputs->shmDefaultTCSubType;
         if (_shmDefaultTCType != UNKNOWN_TIMECODE_TYPE)
         {
             mc_set_osd_timecode(ply_get_media_control(newPlayState->mediaPlayer), 0, _shmDefaultTCType,
@@ -1742,7 +1871,7 @@ bool LocalIngexPlayer::prepare(vector<PlayerInput> inputs, vector<bool>& opened)
         {
             ReadWriteLockGuard guard(&_listenerRegistry->_listenersRWLock, true);
             _sourceIdToIndexVersion++;
-            _sourceIdToIndex = newSourceIdToIndex;
+            _sourceIdToIndex = openedInputs->sourceIdToIndex;
         }
 
         _config = nextConfig;
@@ -1758,15 +1887,134 @@ bool LocalIngexPlayer::prepare(vector<PlayerInput> inputs, vector<bool>& opened)
     }
     catch (...)
     {
-        if (mainMediaSource != 0)
+        return false;
+    }
+    return true;
+}
+
+bool LocalIngexPlayer::prepareNext(vector<PlayerInput> inputs)
+{
+    try
+    {
+        if (inputs.size() == 0)
+        {
+            THROW_EXCEPTION(("No files to play\n"));
+        }
+
+        cancelNext();
+
+        Configuration nextConfig;
+        PTHREAD_MUTEX_LOCK(&_configMutex);
+        nextConfig = _nextConfig;
+        PTHREAD_MUTEX_UNLOCK(&_configMutex);
+
+        auto_ptr<LocalIngexPlayerInputs> nextInputs(new LocalIngexPlayerInputs(inputs,
+            &nextConfig.sourceAspectRatio, is_dvs_output(nextConfig.outputType)));
+        CHK_OTHROW_MSG(nextInputs->openInBackground(), ("Failed to start thread to open the next inputs\n"));
+
+        MutexGuard guard(&_nextInputsMutex);
+        _nextInputs = nextInputs.release();
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
+
+void LocalIngexPlayer::cancelNext()
+{
+    LocalIngexPlayerInputs* nextInputs = 0;
+    {
+        MutexGuard guard(&_nextInputsMutex);
+        nextInputs = _nextInputs;
+        _nextInputs = 0;
+    }
+
+    // waits for the open thread to complete before closing the sources
+    SAFE_DELETE(&nextInputs);
+}
+
+bool LocalIngexPlayer::startNext(vector<bool>& opened, bool startPaused, int64_t startPosition)
+{
+    auto_ptr<LocalIngexPlayerInputs> nextInputs;
+    LocalIngexPlayerState* currentPlayState = 0;
+    MediaSource* prevMediaSource = 0;
+    Configuration nextConfig;
+
+    try
+    {
+        {
+            MutexGuard guard(&_nextInputsMutex);
+            nextInputs = auto_ptr<LocalIngexPlayerInputs>(_nextInputs);
+            _nextInputs = 0;
+        }
+        if (!nextInputs.get())
+        {
+            THROW_EXCEPTION(("No inputs were prepared using prepareNext()\n"));
+        }
+
+        // the current inputs continue to play until the next inputs are open
+        nextInputs->waitUntilOpened();
+        opened.insert(opened.end(), nextInputs->opened.begin(), nextInputs->opened.end());
+        if (!nextInputs->atLeastOneInputOpened)
+        {
+            return false;
+        }
+
+        // effectively disable client access to the player
+        {
+            ReadWriteLockGuard guard(&_playStateRWLock, true);
+            currentPlayState = _playState;
+            _playState = 0;
+        }
+
+        // reset listener data
+        {
+            ReadWriteLockGuard guard(&_listenerRegistry->_listenersRWLock, true);
+            _sourceIdToIndexVersion++;
+            _sourceIdToIndex.clear();
+        }
+
+        // stop playing and detach the current source so that closing it (which could take a while) is
+        // delayed until the next inputs are playing
+        if (currentPlayState)
+        {
+            currentPlayState->stopPlaying();
+            prevMediaSource = currentPlayState->mediaSource;
+            currentPlayState->mediaSource = 0;
+        }
+
+        // get the next config
+        PTHREAD_MUTEX_LOCK(&_configMutex);
+        nextConfig = _nextConfig;
+        PTHREAD_MUTEX_UNLOCK(&_configMutex);
+
+        CHK_OTHROW(preparePlayState(nextInputs.get(), currentPlayState, nextConfig));
+
+        // seek to the start position
+        if (startPosition > 0)
+        {
+            mc_seek(ply_get_media_control(_playState->mediaPlayer), startPosition, SEEK_SET, FRAME_PLAY_UNIT);
+        }
+        else if (startPosition < 0)
         {
-            msc_close(mainMediaSource);
+            mc_seek(ply_get_media_control(_playState->mediaPlayer), startPosition + 1, SEEK_END, FRAME_PLAY_UNIT);
         }
+
+        start(startPaused);
+    }
+    catch (...)
+    {
+        msc_close(prevMediaSource);
         return false;
     }
+
+    msc_close(prevMediaSource);
     return true;
 }
 
+
 void LocalIngexPlayer::start(bool startPaused)
 {
     ReadWriteLockGuard guard(&_playStateRWLock, true);
@@ -2734,19 +2982,3 @@ void LocalIngexPlayer::updateListenerData(LocalIngexPlayerListenerData* listener
     listenerData->setVersion(_sourceIdToIndexVersion);
 }
 
-bool LocalIngexPlayer::createFallbackBlankSource(MediaSource** mediaSource)
-{
-    StreamInfo streamInfo;
-    memset(&streamInfo, 0, sizeof(streamInfo));
-    streamInfo.type = PICTURE_STREAM_TYPE;
-
-    if (!bks_create(&streamInfo, 2160000, mediaSource))
-    {
-        ml_log_error("Failed to create fallback blank source\n");
-        return false;
-    }
-
-    ml_log_info("Opened fallback blank video source\n");
-    return true;
-}
-
@@ -38,6 +38,8 @@ namespace prodauto
 
 class LocalIngexPlayerState;
 
+class LocalIngexPlayerInputs;
+
 class LocalIngexPlayerListenerData;
 
 /* options for each PlayerInputType are as follows:
@@ -150,6 +152,17 @@ public:
     bool prepare(std::vector<PlayerInput> inputs, std::vector<bool>& opened);
     void start(bool startPaused);
 
+    /* opens the inputs in a separate thread whilst the current inputs continue playing. Any inputs
+       previously prepared and not yet started are closed */
+    bool prepareNext(std::vector<PlayerInput> inputs);
+    /* waits for the inputs passed to prepareNext() to be opened and then switches to them. The sinks and
+       display window are kept if the video format and configuration have not changed, in which case only the
+       player is re-created. The current inputs continue playing if none of the next inputs could be opened.
+       The parameters are the same as for start() above */
+    bool startNext(std::vector<bool>& opened, bool startPaused, int64_t startPosition);
+    /* closes the inputs passed to prepareNext() */
+    void cancelNext();
+
 
     /* returns the output type used */
     PlayerOutputType getOutputType();
@@ -226,7 +239,8 @@ private:
     bool setOrCreateX11Window(const X11WindowInfo* externalWindowInfo);
     void closeLocalX11Window();
 
-    bool createFallbackBlankSource(MediaSource** mediaSource);
+    bool preparePlayState(LocalIngexPlayerInputs* openedInputs, LocalIngexPlayerState* currentPlayState,
+                          const Configuration& nextConfig);
 
 private:
     pthread_mutex_t _configMutex;
@@ -245,6 +259,9 @@ private:
     pthread_rwlock_t _playStateRWLock;
     LocalIngexPlayerState* _playState;
 
+    pthread_mutex_t _nextInputsMutex;
+    LocalIngexPlayerInputs* _nextInputs;
+
     MediaPlayerListener _mediaPlayerListener;
     X11WindowListener _x11WindowListener;
     KeyboardInputListener _x11KeyListener;
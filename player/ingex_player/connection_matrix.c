@@ -32,15 +32,24 @@
 #include "mjpeg_stream_connect.h"
 #include "dnxhd_stream_connect.h"
 #include "avci_stream_connect.h"
+#include "frame_cache.h"
 #include "logging.h"
 #include "macros.h"
 
 
 typedef struct
 {
+    struct ConnectionMatrix* matrix;
     int sourceStreamId;
     int sinkStreamId;
     StreamConnect* connect;
+
+    /* decoded frames are cached by passing them through the cache sink on their way to the sink */
+    int isDecoder;
+    MediaSink* sink;
+    MediaSink cacheSink;
+    int64_t cachePosition; /* position of the frame being decoded, -1 if it should not be cached */
+    unsigned int decodedFrameSize; /* 0 if no frame was decoded yet */
 } ConnectionMatrixEntry;
 
 struct ConnectionMatrix
@@ -48,18 +57,148 @@ struct ConnectionMatrix
     ConnectionMatrixEntry* entries;
     int numStreams;
     MediaSourceListener sourceListener;
+
+    FrameCache* frameCache;
 };
 
 
+static int cache_sink_accept_stream(void* data, const StreamInfo* streamInfo)
+{
+    ConnectionMatrixEntry* entry = (ConnectionMatrixEntry*)data;
+
+    return msk_accept_stream(entry->sink, streamInfo);
+}
+
+static int cache_sink_register_stream(void* data, int streamId, const StreamInfo* streamInfo)
+{
+    ConnectionMatrixEntry* entry = (ConnectionMatrixEntry*)data;
+
+    return msk_register_stream(entry->sink, streamId, streamInfo);
+}
+
+static int cache_sink_accept_stream_frame(void* data, int streamId, const FrameInfo* frameInfo)
+{
+    ConnectionMatrixEntry* entry = (ConnectionMatrixEntry*)data;
+
+    return msk_accept_stream_frame(entry->sink, streamId, frameInfo);
+}
+
+static int cache_sink_get_stream_buffer(void* data, int streamId, unsigned int bufferSize, unsigned char** buffer)
+{
+    ConnectionMatrixEntry* entry = (ConnectionMatrixEntry*)data;
+
+    return msk_get_stream_buffer(entry->sink, streamId, bufferSize, buffer);
+}
+
+static int cache_sink_receive_stream_frame(void* data, int streamId, unsigned char* buffer, unsigned int bufferSize)
+{
+    ConnectionMatrixEntry* entry = (ConnectionMatrixEntry*)data;
+
+    /* copy the decoded frame before the sink adds an OSD for example */
+    if (entry->matrix->frameCache != NULL && entry->cachePosition >= 0)
+    {
+        if (frc_put(entry->matrix->frameCache, entry->sourceStreamId, entry->cachePosition, buffer, bufferSize))
+        {
+            entry->decodedFrameSize = bufferSize;
+        }
+    }
+
+    return msk_receive_stream_frame(entry->sink, streamId, buffer, bufferSize);
+}
+
+static int cache_sink_receive_stream_frame_const(void* data, int streamId, const unsigned char* buffer,
+    unsigned int bufferSize)
+{
+    ConnectionMatrixEntry* entry = (ConnectionMatrixEntry*)data;
+
+    if (entry->matrix->frameCache != NULL && entry->cachePosition >= 0)
+    {
+        if (frc_put(entry->matrix->frameCache, entry->sourceStreamId, entry->cachePosition, buffer, bufferSize))
+        {
+            entry->decodedFrameSize = bufferSize;
+        }
+    }
+
+    return msk_receive_stream_frame_const(entry->sink, streamId, buffer, bufferSize);
+}
+
+static MediaSink* init_cache_sink(ConnectionMatrix* matrix, ConnectionMatrixEntry* entry, MediaSink* sink)
+{
+    entry->matrix = matrix;
+    entry->isDecoder = 1;
+    entry->sink = sink;
+    entry->cachePosition = -1;
+
+    entry->cacheSink = *sink; /* copy function pointers */
+    entry->cacheSink.data = entry;
+    entry->cacheSink.accept_stream = cache_sink_accept_stream;
+    entry->cacheSink.register_stream = cache_sink_register_stream;
+    entry->cacheSink.accept_stream_frame = cache_sink_accept_stream_frame;
+    entry->cacheSink.get_stream_buffer = cache_sink_get_stream_buffer;
+    entry->cacheSink.receive_stream_frame = cache_sink_receive_stream_frame;
+    entry->cacheSink.receive_stream_frame_const = cache_sink_receive_stream_frame_const;
+
+    return &entry->cacheSink;
+}
+
+/* returns 1 if the cached decoded frame was sent to the sink or the sink doesn't want the frame */
+static int send_cached_frame(ConnectionMatrix* matrix, ConnectionMatrixEntry* entry, const FrameInfo* frameInfo)
+{
+    unsigned char* buffer;
+
+    if (!frc_contains(matrix->frameCache, entry->sourceStreamId, frameInfo->position))
+    {
+        return 0;
+    }
+
+    if (!msk_accept_stream_frame(entry->sink, entry->sinkStreamId, frameInfo))
+    {
+        return 1;
+    }
+
+    if (!msk_get_stream_buffer(entry->sink, entry->sinkStreamId, entry->decodedFrameSize, &buffer))
+    {
+        ml_log_error("Sink failed to allocate buffer for stream %d for cached frame\n", entry->sinkStreamId);
+        return 0;
+    }
+
+    /* the frame could have been evicted by another stream's decoder since checking above */
+    if (!frc_get(matrix->frameCache, entry->sourceStreamId, frameInfo->position, buffer, entry->decodedFrameSize))
+    {
+        return 0;
+    }
+
+    if (!msk_receive_stream_frame(entry->sink, entry->sinkStreamId, buffer, entry->decodedFrameSize))
+    {
+        ml_log_error("failed to write cached frame to media sink\n");
+    }
+
+    return 1;
+}
+
+
 static int stm_accept_frame(void* data, int streamId, const FrameInfo* frameInfo)
 {
     ConnectionMatrix* matrix = (ConnectionMatrix*)data;
+    ConnectionMatrixEntry* entry;
     int i;
 
     for (i = 0; i < matrix->numStreams; i++)
     {
         if (matrix->entries[i].connect != NULL && matrix->entries[i].sourceStreamId == streamId)
         {
+            entry = &matrix->entries[i];
+            if (matrix->frameCache != NULL && entry->isDecoder)
+            {
+                /* the source doesn't read or decode the frame if it was sent from the cache */
+                entry->cachePosition = -1;
+                if (entry->decodedFrameSize > 0 && send_cached_frame(matrix, entry, frameInfo))
+                {
+                    return 0;
+                }
+                entry->cachePosition = frameInfo->position;
+            }
+
             return sdl_accept_frame(stc_get_source_listener(matrix->entries[i].connect), streamId, frameInfo);
         }
     }
@@ -138,6 +277,7 @@ int stm_create_connection_matrix(MediaSource* source, MediaSink* sink, int numFF
     const StreamInfo* streamInfo;
     StreamInfo decodedStreamInfo;
     int streamIndex;
+    MediaSink* cacheSink;
 
     CALLOC_ORET(newMatrix, ConnectionMatrix, 1);
 
@@ -263,7 +403,8 @@ int stm_create_connection_matrix(MediaSource* source, MediaSink* sink, int numFF
             }
             else if (dv_connect_accept(sink, streamInfo, &decodedStreamInfo))
             {
-                if (create_dv_connect(sink, i, i, streamInfo, numFFMPEGThreads, useWorkerThreads,
+                cacheSink = init_cache_sink(newMatrix, &newMatrix->entries[streamIndex], sink);
+                if (create_dv_connect(cacheSink, i, i, streamInfo, numFFMPEGThreads, useWorkerThreads,
                         &newMatrix->entries[streamIndex].connect))
                 {
                     newMatrix->entries[streamIndex].sourceStreamId = i;
@@ -281,7 +422,8 @@ int stm_create_connection_matrix(MediaSource* source, MediaSink* sink, int numFF
             }
             else if (mpegi_connect_accept(sink, streamInfo, &decodedStreamInfo))
             {
-                if (create_mpegi_connect(sink, i, i, streamInfo, numFFMPEGThreads, useWorkerThreads,
+                cacheSink = init_cache_sink(newMatrix, &newMatrix->entries[streamIndex], sink);
+                if (create_mpegi_connect(cacheSink, i, i, streamInfo, numFFMPEGThreads, useWorkerThreads,
                         &newMatrix->entries[streamIndex].connect))
                 {
                     newMatrix->entries[streamIndex].sourceStreamId = i;
@@ -299,7 +441,8 @@ int stm_create_connection_matrix(MediaSource* source, MediaSink* sink, int numFF
             }
             else if (mjpeg_connect_accept(sink, streamInfo, &decodedStreamInfo))
             {
-                if (create_mjpeg_connect(sink, i, i, streamInfo, numFFMPEGThreads, useWorkerThreads,
+                cacheSink = init_cache_sink(newMatrix, &newMatrix->entries[streamIndex], sink);
+                if (create_mjpeg_connect(cacheSink, i, i, streamInfo, numFFMPEGThreads, useWorkerThreads,
                         &newMatrix->entries[streamIndex].connect))
                 {
                     newMatrix->entries[streamIndex].sourceStreamId = i;
@@ -317,7 +460,8 @@ int stm_create_connection_matrix(MediaSource* source, MediaSink* sink, int numFF
             }
             else if (dnxhd_connect_accept(sink, streamInfo, &decodedStreamInfo))
             {
-                if (create_dnxhd_connect(sink, i, i, streamInfo, numFFMPEGThreads, useWorkerThreads,
+                cacheSink = init_cache_sink(newMatrix, &newMatrix->entries[streamIndex], sink);
+                if (create_dnxhd_connect(cacheSink, i, i, streamInfo, numFFMPEGThreads, useWorkerThreads,
                         &newMatrix->entries[streamIndex].connect))
                 {
                     newMatrix->entries[streamIndex].sourceStreamId = i;
@@ -335,7 +479,8 @@ int stm_create_connection_matrix(MediaSource* source, MediaSink* sink, int numFF
             }
             else if (avci_connect_accept(sink, streamInfo, &decodedStreamInfo))
             {
-                if (create_avci_connect(sink, i, i, streamInfo, numFFMPEGThreads, useWorkerThreads,
+                cacheSink = init_cache_sink(newMatrix, &newMatrix->entries[streamIndex], sink);
+                if (create_avci_connect(cacheSink, i, i, streamInfo, numFFMPEGThreads, useWorkerThreads,
                         &newMatrix->entries[streamIndex].connect))
                 {
                     newMatrix->entries[streamIndex].sourceStreamId = i;
@@ -400,8 +545,22 @@ void stm_close(ConnectionMatrix** matrix)
 
     SAFE_FREE(&(*matrix)->entries);
 
+    frc_close_cache(&(*matrix)->frameCache);
+
     SAFE_FREE(matrix);
 }
 
+int stm_set_frame_cache_size(ConnectionMatrix* matrix, int64_t maxSize)
+{
+    CHK_ORET(matrix->frameCache == NULL);
+
+    if (maxSize <= 0)
+    {
+        return 1;
+    }
+
+    return frc_create_cache(maxSize, &matrix->frameCache);
+}
+
 
 
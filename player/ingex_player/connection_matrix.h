@@ -39,6 +39,11 @@ MediaSourceListener* stm_get_stream_listener(ConnectionMatrix* matrix);
 int stm_sync(ConnectionMatrix* matrix);
 void stm_close(ConnectionMatrix** matrix);
 
+/* cache up to maxSize bytes of decoded frames so that decoded streams are not read and decoded again when
+   a position is revisited. Must be called before the first frame is read and only for seekable sources,
+   where the frame at a position doesn't change */
+int stm_set_frame_cache_size(ConnectionMatrix* matrix, int64_t maxSize);
+
 
 
 #endif
@@ -0,0 +1,302 @@
+/*
+ * $Id$
+ *
+ * Memory bounded least recently used cache of decoded frames
+ *
+ * Copyright (C) 2012 British Broadcasting Corporation, All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "frame_cache.h"
+#include "utils.h"
+#include "logging.h"
+#include "macros.h"
+
+
+#define HASH_TABLE_SIZE     1024
+
+
+typedef struct CachedFrame
+{
+    struct CachedFrame* prev; /* more recently used */
+    struct CachedFrame* next; /* less recently used */
+    struct CachedFrame* hashNext;
+
+    int streamId;
+    int64_t position;
+
+    unsigned char* data;
+    unsigned int dataSize;
+} CachedFrame;
+
+struct FrameCache
+{
+    int64_t maxSize;
+    int64_t usedSize;
+
+    CachedFrame* hashTable[HASH_TABLE_SIZE];
+    CachedFrame* mostRecent;
+    CachedFrame* leastRecent;
+
+    pthread_mutex_t cacheMutex;
+};
+
+
+static unsigned int get_hash(int streamId, int64_t position)
+{
+    return (unsigned int)(position * 31 + streamId) % HASH_TABLE_SIZE;
+}
+
+static CachedFrame* find_frame(FrameCache* cache, int streamId, int64_t position)
+{
+    CachedFrame* frame = cache->hashTable[get_hash(streamId, position)];
+
+    while (frame != NULL && (frame->streamId != streamId || frame->position != position))
+    {
+        frame = frame->hashNext;
+    }
+
+    return frame;
+}
+
+static void unlink_frame(FrameCache* cache, CachedFrame* frame)
+{
+    if (frame->prev != NULL)
+    {
+        frame->prev->next = frame->next;
+    }
+    else
+    {
+        cache->mostRecent = frame->next;
+    }
+    if (frame->next != NULL)
+    {
+        frame->next->prev = frame->prev;
+    }
+    else
+    {
+        cache->leastRecent = frame->prev;
+    }
+    frame->prev = NULL;
+    frame->next = NULL;
+}
+
+static void link_most_recent(FrameCache* cache, CachedFrame* frame)
+{
+    frame->prev = NULL;
+    frame->next = cache->mostRecent;
+    if (cache->mostRecent != NULL)
+    {
+        cache->mostRecent->prev = frame;
+    }
+    else
+    {
+        cache->leastRecent = frame;
+    }
+    cache->mostRecent = frame;
+}
+
+/* remove the frame from the hash table and recently used list, the frame is not freed */
+static void remove_frame(FrameCache* cache, CachedFrame* frame)
+{
+    CachedFrame** hashPtr = &cache->hashTable[get_hash(frame->streamId, frame->position)];
+
+    while (*hashPtr != frame)
+    {
+        hashPtr = &(*hashPtr)->hashNext;
+    }
+    *hashPtr = frame->hashNext;
+    frame->hashNext = NULL;
+
+    unlink_frame(cache, frame);
+
+    cache->usedSize -= frame->dataSize;
+}
+
+static void free_frame(CachedFrame** frame)
+{
+    if (*frame == NULL)
+    {
+        return;
+    }
+
+    SAFE_FREE(&(*frame)->data);
+    SAFE_FREE(frame);
+}
+
+static void clear_frames(FrameCache* cache)
+{
+    CachedFrame* frame;
+    CachedFrame* nextFrame;
+
+    frame = cache->mostRecent;
+    while (frame != NULL)
+    {
+        nextFrame = frame->next;
+        free_frame(&frame);
+        frame = nextFrame;
+    }
+
+    memset(cache->hashTable, 0, sizeof(cache->hashTable));
+    cache->mostRecent = NULL;
+    cache->leastRecent = NULL;
+    cache->usedSize = 0;
+}
+
+
+
+int frc_create_cache(int64_t maxSize, FrameCache** cache)
+{
+    FrameCache* newCache;
+
+    CALLOC_ORET(newCache, FrameCache, 1);
+    newCache->maxSize = maxSize;
+
+    CHK_OFAIL(init_mutex(&newCache->cacheMutex));
+
+    *cache = newCache;
+    return 1;
+
+fail:
+    SAFE_FREE(&newCache);
+    return 0;
+}
+
+void frc_close_cache(FrameCache** cache)
+{
+    if (*cache == NULL)
+    {
+        return;
+    }
+
+    clear_frames(*cache);
+
+    destroy_mutex(&(*cache)->cacheMutex);
+
+    SAFE_FREE(cache);
+}
+
+int frc_put(FrameCache* cache, int streamId, int64_t position, const unsigned char* data, unsigned int dataSize)
+{
+    CachedFrame* frame;
+    CachedFrame* evictedFrame;
+
+    if ((int64_t)dataSize > cache->maxSize)
+    {
+        return 0;
+    }
+
+    PTHREAD_MUTEX_LOCK(&cache->cacheMutex);
+
+    /* take the existing frame out of the cache so that it is not evicted below */
+    frame = find_frame(cache, streamId, position);
+    if (frame != NULL)
+    {
+        remove_frame(cache, frame);
+    }
+
+    /* evict least recently used frames until the new frame fits. An evicted frame's buffer is re-used if it has
+       the required size, which is the common case because the frame sizes in a stream are constant */
+    while (cache->usedSize + dataSize > cache->maxSize)
+    {
+        evictedFrame = cache->leastRecent;
+        remove_frame(cache, evictedFrame);
+
+        if (frame == NULL && evictedFrame->dataSize == dataSize)
+        {
+            frame = evictedFrame;
+        }
+        else
+        {
+            free_frame(&evictedFrame);
+        }
+    }
+
+    if (frame != NULL && frame->dataSize != dataSize)
+    {
+        free_frame(&frame);
+    }
+    if (frame == NULL)
+    {
+        CALLOC_OFAIL(frame, CachedFrame, 1);
+        MALLOC_OFAIL(frame->data, unsigned char, dataSize);
+        frame->dataSize = dataSize;
+    }
+
+    frame->streamId = streamId;
+    frame->position = position;
+    memcpy(frame->data, data, dataSize);
+
+    frame->hashNext = cache->hashTable[get_hash(streamId, position)];
+    cache->hashTable[get_hash(streamId, position)] = frame;
+    link_most_recent(cache, frame);
+    cache->usedSize += dataSize;
+
+    PTHREAD_MUTEX_UNLOCK(&cache->cacheMutex);
+
+    return 1;
+
+fail:
+    free_frame(&frame);
+    PTHREAD_MUTEX_UNLOCK(&cache->cacheMutex);
+    return 0;
+}
+
+int frc_get(FrameCache* cache, int streamId, int64_t position, unsigned char* buffer, unsigned int bufferSize)
+{
+    CachedFrame* frame;
+    int result = 0;
+
+    PTHREAD_MUTEX_LOCK(&cache->cacheMutex);
+
+    frame = find_frame(cache, streamId, position);
+    if (frame != NULL && frame->dataSize == bufferSize)
+    {
+        memcpy(buffer, frame->data, bufferSize);
+
+        unlink_frame(cache, frame);
+        link_most_recent(cache, frame);
+        result = 1;
+    }
+
+    PTHREAD_MUTEX_UNLOCK(&cache->cacheMutex);
+
+    return result;
+}
+
+int frc_contains(FrameCache* cache, int streamId, int64_t position)
+{
+    int result;
+
+    PTHREAD_MUTEX_LOCK(&cache->cacheMutex);
+    result = (find_frame(cache, streamId, position) != NULL);
+    PTHREAD_MUTEX_UNLOCK(&cache->cacheMutex);
+
+    return result;
+}
+
+void frc_clear(FrameCache* cache)
+{
+    PTHREAD_MUTEX_LOCK(&cache->cacheMutex);
+    clear_frames(cache);
+    PTHREAD_MUTEX_UNLOCK(&cache->cacheMutex);
+}
+
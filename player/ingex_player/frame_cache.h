@@ -0,0 +1,52 @@
+/*
+ * $Id$
+ *
+ * Memory bounded least recently used cache of decoded frames
+ *
+ * Copyright (C) 2012 British Broadcasting Corporation, All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __FRAME_CACHE_H__
+#define __FRAME_CACHE_H__
+
+
+#include <inttypes.h>
+
+
+typedef struct FrameCache FrameCache;
+
+
+/* frames are keyed by (stream id, position) and the least recently used frames are evicted once the total
+   size of the frame data would exceed maxSize bytes. All functions are thread safe */
+int frc_create_cache(int64_t maxSize, FrameCache** cache);
+void frc_close_cache(FrameCache** cache);
+
+/* copy the frame into the cache, replacing any existing frame with the same key */
+int frc_put(FrameCache* cache, int streamId, int64_t position, const unsigned char* data, unsigned int dataSize);
+
+/* returns 1 and copies the frame into buffer if the frame is cached and has size bufferSize */
+int frc_get(FrameCache* cache, int streamId, int64_t position, unsigned char* buffer, unsigned int bufferSize);
+
+/* returns 1 if the frame is cached, without changing the frame's least recently used order */
+int frc_contains(FrameCache* cache, int streamId, int64_t position);
+
+void frc_clear(FrameCache* cache);
+
+
+
+#endif
+
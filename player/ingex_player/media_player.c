@@ -2932,6 +2932,18 @@ void ply_set_start_offset(MediaPlayer* player, int64_t offset)
     player->startOffset = offset;
 }
 
+int ply_set_frame_cache_size(MediaPlayer* player, int64_t maxSize)
+{
+    if (!msc_is_seekable(player->mediaSource))
+    {
+        /* frames at a position in a live source change over time */
+        ml_log_info("Decoded frame cache is not used for a source that is not seekable\n");
+        return 1;
+    }
+
+    return stm_set_frame_cache_size(player->connectionMatrix, maxSize);
+}
+
 void ply_print_source_info(MediaPlayer* player)
 {
     int i;
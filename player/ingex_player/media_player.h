@@ -135,6 +135,8 @@ MediaSink* ply_get_media_sink(MediaPlayer* player);
 void ply_set_menu_handler(MediaPlayer* player, MenuHandler* handler);
 void ply_enable_clip_marks(MediaPlayer* player, int markType);
 void ply_set_start_offset(MediaPlayer* player, int64_t offset);
+/* cache decoded frames for revisited positions. Must be called before ply_start_player */
+int ply_set_frame_cache_size(MediaPlayer* player, int64_t maxSize);
 void ply_print_source_info(MediaPlayer* player);
 void ply_get_frame_rate(MediaPlayer* player, Rational* frameRate);
 
@@ -303,7 +303,8 @@ int msc_create_id()
 {
     static int id = 0;
 
-    return id++;
+    /* sources are opened from the background open and sequence prefetch threads */
+    return __sync_fetch_and_add(&id, 1);
 }
 
 
@@ -154,6 +154,8 @@ struct DefaultOnScreenDisplay
     p_info_rec p_info;
 
     /* play state screen data */
+    float charSetFontScale; /* font scale and pixel aspect ratio the glyphs below were rendered with */
+    float charSetPixelAspectRatio;
     timecode_data timecodeTextData;
     char_set_data timecodeTypeData;
     char_set_data numberData;
@@ -177,6 +179,10 @@ struct DefaultOnScreenDisplay
     int hideAudioLevels;
     overlay audioLevelOverlay;
     int haveAudioOverlay;
+    int audioLevelOverlayFilled;
+    int audioLevelBarTop[MAX_AUDIO_LEVELS]; /* first line of each bar in audioLevelOverlay */
+    double filledMinimumAudioLevel;
+    float filledAudioLineupLevel;
     overlay audioLevelM0Overlay;
     overlay audioLevelLineupOverlay;
     overlay audioLevelM40Overlay;
@@ -191,6 +197,7 @@ struct DefaultOnScreenDisplay
     overlay progressBarOverlay;
     overlay progressBarMarkOverlay;
     int64_t lastAvailableSourceLength;
+    int availableSourceWidth; /* width drawn in progressBarOverlay */
     OSDMarksModel* marksModel; /* not owned by the OSD */
     OSDMarksModel* secondMarksModel; /* not owned by the OSD */
     overlay userMarksOverlay;
@@ -510,12 +517,49 @@ fail:
     return 0;
 }
 
+static double get_audio_level_at_line(DefaultOnScreenDisplay* osdd, int line)
+{
+    return osdd->state->minimumAudioLevel *
+        (line - AUDIO_LEVEL_MARGIN) /
+            (double)(osdd->audioLevelOverlay.h - 2 * AUDIO_LEVEL_MARGIN - 1);
+}
+
+static int is_audio_level_marker_line(DefaultOnScreenDisplay* osdd, int line)
+{
+    return line == AUDIO_LEVEL_MARGIN ||
+        line == (int)(AUDIO_LEVEL_MARGIN + (osdd->audioLevelOverlay.h - 2 * AUDIO_LEVEL_MARGIN) * (osdd->state->audioLineupLevel) / osdd->state->minimumAudioLevel) ||
+        line == (int)(AUDIO_LEVEL_MARGIN + (osdd->audioLevelOverlay.h - 2 * AUDIO_LEVEL_MARGIN) * (-40) / osdd->state->minimumAudioLevel) ||
+        line == (int)(AUDIO_LEVEL_MARGIN + (osdd->audioLevelOverlay.h - 2 * AUDIO_LEVEL_MARGIN) * (-60) / osdd->state->minimumAudioLevel) ||
+        line == (int)(AUDIO_LEVEL_MARGIN + (osdd->audioLevelOverlay.h - 2 * AUDIO_LEVEL_MARGIN) * (-96) / osdd->state->minimumAudioLevel);
+}
+
+/* returns the first line of the bar for the stream, starting the search from the line drawn previously */
+static int get_audio_level_bar_top(DefaultOnScreenDisplay* osdd, int stream, int line)
+{
+    double streamLevel = osdd->state->audioStreamLevels[stream].level;
+
+    /* the level decreases going down the overlay */
+    while (line > AUDIO_LEVEL_MARGIN && streamLevel >= get_audio_level_at_line(osdd, line - 1))
+    {
+        line--;
+    }
+    while (line < osdd->audioLevelOverlay.h - AUDIO_LEVEL_MARGIN && streamLevel < get_audio_level_at_line(osdd, line))
+    {
+        line++;
+    }
+
+    return line;
+}
+
 static void fill_audio_level_overlay(DefaultOnScreenDisplay* osdd)
 {
     int stream;
     int line;
     unsigned char* barStart;
-    double level;
+    int barTop;
+    int changeStart;
+    int changeEnd;
+    int updated;
 
     osdd->haveAudioOverlay = 0;
 
@@ -523,6 +567,7 @@ static void fill_audio_level_overlay(DefaultOnScreenDisplay* osdd)
     if (osdd->maxAudioLevels != osdd->state->numAudioLevels)
     {
         osdd->maxAudioLevels = osdd->state->numAudioLevels;
+        osdd->audioLevelOverlayFilled = 0;
         free_overlay(&osdd->audioLevelOverlay);
         if (!initialise_audio_level_overlay(osdd, osdd->imageWidth, osdd->imageHeight))
         {
@@ -531,49 +576,91 @@ static void fill_audio_level_overlay(DefaultOnScreenDisplay* osdd)
         }
     }
 
+    /* the marker lines move if the minimum or lineup level changes */
+    if (osdd->audioLevelOverlayFilled &&
+        (osdd->filledMinimumAudioLevel != osdd->state->minimumAudioLevel ||
+            osdd->filledAudioLineupLevel != osdd->state->audioLineupLevel))
+    {
+        osdd->audioLevelOverlayFilled = 0;
+    }
 
-    for (line = AUDIO_LEVEL_MARGIN; line < osdd->audioLevelOverlay.h - AUDIO_LEVEL_MARGIN; line++)
+
+    if (!osdd->audioLevelOverlayFilled)
     {
-        barStart = osdd->audioLevelOverlay.buff + line * osdd->audioLevelOverlay.w + AUDIO_LEVEL_MARGIN;
-        level = osdd->state->minimumAudioLevel *
-            (line - AUDIO_LEVEL_MARGIN) /
-                (double)(osdd->audioLevelOverlay.h - 2 * AUDIO_LEVEL_MARGIN - 1);
+        /* draw the complete overlay */
 
         for (stream = 0; stream < osdd->state->numAudioLevels; stream++)
         {
-            if (osdd->state->audioStreamLevels[stream].level >= level)
+            osdd->audioLevelBarTop[stream] = get_audio_level_bar_top(osdd, stream,
+                osdd->audioLevelOverlay.h - AUDIO_LEVEL_MARGIN);
+        }
+
+        for (line = AUDIO_LEVEL_MARGIN; line < osdd->audioLevelOverlay.h - AUDIO_LEVEL_MARGIN; line++)
+        {
+            if (is_audio_level_marker_line(osdd, line))
             {
-                /* bar */
-                memset(barStart, 255, AUDIO_LEVEL_BAR_WIDTH);
+                memset(osdd->audioLevelOverlay.buff + line * osdd->audioLevelOverlay.w, 255, osdd->audioLevelOverlay.w);
+                continue;
             }
-            else
+
+            barStart = osdd->audioLevelOverlay.buff + line * osdd->audioLevelOverlay.w + AUDIO_LEVEL_MARGIN;
+            for (stream = 0; stream < osdd->state->numAudioLevels; stream++)
             {
-                /* no bar */
-                memset(barStart, 0, AUDIO_LEVEL_BAR_WIDTH);
-            }
+                /* bar or no bar */
+                memset(barStart, (line >= osdd->audioLevelBarTop[stream]) ? 255 : 0, AUDIO_LEVEL_BAR_WIDTH);
 
-            barStart += AUDIO_LEVEL_BAR_WIDTH + AUDIO_LEVEL_BAR_SEP;
+                barStart += AUDIO_LEVEL_BAR_WIDTH + AUDIO_LEVEL_BAR_SEP;
+            }
         }
 
-        if (line == AUDIO_LEVEL_MARGIN)
-        {
-            memset(osdd->audioLevelOverlay.buff + line * osdd->audioLevelOverlay.w, 255, osdd->audioLevelOverlay.w);
-        }
-        else if (line == (int)(AUDIO_LEVEL_MARGIN + (osdd->audioLevelOverlay.h - 2 * AUDIO_LEVEL_MARGIN) * (osdd->state->audioLineupLevel) / osdd->state->minimumAudioLevel))
-        {
-            memset(osdd->audioLevelOverlay.buff + line * osdd->audioLevelOverlay.w, 255, osdd->audioLevelOverlay.w);
-        }
-        else if (line == (int)(AUDIO_LEVEL_MARGIN + (osdd->audioLevelOverlay.h - 2 * AUDIO_LEVEL_MARGIN) * (-40) / osdd->state->minimumAudioLevel))
-        {
-            memset(osdd->audioLevelOverlay.buff + line * osdd->audioLevelOverlay.w, 255, osdd->audioLevelOverlay.w);
-        }
-        else if (line == (int)(AUDIO_LEVEL_MARGIN + (osdd->audioLevelOverlay.h - 2 * AUDIO_LEVEL_MARGIN) * (-60) / osdd->state->minimumAudioLevel))
+        osdd->filledMinimumAudioLevel = osdd->state->minimumAudioLevel;
+        osdd->filledAudioLineupLevel = osdd->state->audioLineupLevel;
+        osdd->audioLevelOverlayFilled = 1;
+        osdd->audioLevelOverlay.Cbuff = NULL;
+    }
+    else
+    {
+        /* only redraw the part of each bar between the previous and the new level */
+
+        updated = 0;
+        for (stream = 0; stream < osdd->state->numAudioLevels; stream++)
         {
-            memset(osdd->audioLevelOverlay.buff + line * osdd->audioLevelOverlay.w, 255, osdd->audioLevelOverlay.w);
+            barTop = get_audio_level_bar_top(osdd, stream, osdd->audioLevelBarTop[stream]);
+            if (barTop == osdd->audioLevelBarTop[stream])
+            {
+                continue;
+            }
+
+            if (barTop < osdd->audioLevelBarTop[stream])
+            {
+                changeStart = barTop;
+                changeEnd = osdd->audioLevelBarTop[stream];
+            }
+            else
+            {
+                changeStart = osdd->audioLevelBarTop[stream];
+                changeEnd = barTop;
+            }
+
+            barStart = osdd->audioLevelOverlay.buff + changeStart * osdd->audioLevelOverlay.w +
+                AUDIO_LEVEL_MARGIN + stream * (AUDIO_LEVEL_BAR_WIDTH + AUDIO_LEVEL_BAR_SEP);
+            for (line = changeStart; line < changeEnd; line++)
+            {
+                if (!is_audio_level_marker_line(osdd, line))
+                {
+                    memset(barStart, (line >= barTop) ? 255 : 0, AUDIO_LEVEL_BAR_WIDTH);
+                }
+                barStart += osdd->audioLevelOverlay.w;
+            }
+
+            osdd->audioLevelBarTop[stream] = barTop;
+            updated = 1;
         }
-        else if (line == (int)(AUDIO_LEVEL_MARGIN + (osdd->audioLevelOverlay.h - 2 * AUDIO_LEVEL_MARGIN) * (-96) / osdd->state->minimumAudioLevel))
+
+        if (updated)
         {
-            memset(osdd->audioLevelOverlay.buff + line * osdd->audioLevelOverlay.w, 255, osdd->audioLevelOverlay.w);
+            /* the chroma key is re-calculated from the changed overlay */
+            osdd->audioLevelOverlay.Cbuff = NULL;
         }
     }
 
@@ -599,6 +686,7 @@ static int add_play_state_screen(DefaultOnScreenDisplay* osdd, const FrameInfo*
     unsigned char* bufPtr;
     unsigned char* bufPtr2;
     int availableSourceWidth;
+    int changeStart;
     int haveMarksModel;
     int haveSecondMarksModel;
     int markOverlayUpdated;
@@ -974,16 +1062,24 @@ static int add_play_state_screen(DefaultOnScreenDisplay* osdd, const FrameInfo*
     {
         availableSourceWidth = (osdd->progressBarOverlay.w - 2 * PROGRESS_BAR_ENDS_WIDTH) *
             frameInfo->availableSourceLength / frameInfo->sourceLength;
-        bufPtr = osdd->progressBarOverlay.buff +
-            (PROGRESS_BAR_TB_HEIGHT + PROGRESS_BAR_CENTER_MARGIN) * osdd->progressBarOverlay.w +
-            PROGRESS_BAR_ENDS_WIDTH;
-        for (i = 0; i < PROGRESS_BAR_CENTER_HEIGHT - 2 * PROGRESS_BAR_CENTER_MARGIN; i++)
-        {
-            memset(bufPtr, 255, availableSourceWidth);
-            memset(bufPtr + availableSourceWidth, 0, (osdd->progressBarOverlay.w - 2 * PROGRESS_BAR_ENDS_WIDTH) - availableSourceWidth);
-            bufPtr += osdd->progressBarOverlay.w;
-        }
+        if (availableSourceWidth != osdd->availableSourceWidth)
+        {
+            /* only redraw the part that changed */
+            changeStart = (availableSourceWidth < osdd->availableSourceWidth) ? availableSourceWidth : osdd->availableSourceWidth;
+            bufPtr = osdd->progressBarOverlay.buff +
+                (PROGRESS_BAR_TB_HEIGHT + PROGRESS_BAR_CENTER_MARGIN) * osdd->progressBarOverlay.w +
+                PROGRESS_BAR_ENDS_WIDTH + changeStart;
+            for (i = 0; i < PROGRESS_BAR_CENTER_HEIGHT - 2 * PROGRESS_BAR_CENTER_MARGIN; i++)
+            {
+                memset(bufPtr, (availableSourceWidth > osdd->availableSourceWidth) ? 255 : 0,
+                    abs(availableSourceWidth - osdd->availableSourceWidth));
+                bufPtr += osdd->progressBarOverlay.w;
+            }
+            osdd->availableSourceWidth = availableSourceWidth;
 
+            /* the chroma key is re-calculated from the changed overlay */
+            osdd->progressBarOverlay.Cbuff = NULL;
+        }
     }
     osdd->lastAvailableSourceLength = frameInfo->availableSourceLength;
 
@@ -1873,28 +1969,40 @@ static int osdd_initialise(void* data, const StreamInfo* streamInfo, const Ratio
 
     /* initialise the play state screen overlay */
 
-    if (wasInitialised)
+    /* the glyphs only depend on the font size and pixel aspect ratio and are kept if these are unchanged */
+    if (!wasInitialised || fontScale != osdd->charSetFontScale ||
+        osdd->pixelAspectRatio != osdd->charSetPixelAspectRatio)
     {
-        free_timecode(&osdd->timecodeTextData);
-        free_char_set(&osdd->timecodeTypeData);
-        free_char_set(&osdd->numberData);
-        free_char_set(&osdd->vtrErrorCodeData);
-        free_overlay(&osdd->markOverlay);
-        free_overlay(&osdd->droppedFrameOverlay);
-    }
+        if (wasInitialised)
+        {
+            free_timecode(&osdd->timecodeTextData);
+            free_char_set(&osdd->timecodeTypeData);
+            free_char_set(&osdd->numberData);
+            free_char_set(&osdd->vtrErrorCodeData);
+        }
 
-    /* note: the order must match UNKNOWN_TC_OVLY_IDX, ... */
-    CHK_ORET(char_set_to_overlay(&osdd->p_info, &osdd->timecodeTypeData, "?CSVLvlX",
-        "Ariel", 48 * fontScale, osdd->pixelAspectRatio) >= 0);
+        /* note: the order must match UNKNOWN_TC_OVLY_IDX, ... */
+        CHK_ORET(char_set_to_overlay(&osdd->p_info, &osdd->timecodeTypeData, "?CSVLvlX",
+            "Ariel", 48 * fontScale, osdd->pixelAspectRatio) >= 0);
 
-    CHK_ORET(init_timecode(&osdd->p_info, &osdd->timecodeTextData, "Ariel",
-        48 * fontScale, osdd->pixelAspectRatio) == YUV_OK);
+        CHK_ORET(init_timecode(&osdd->p_info, &osdd->timecodeTextData, "Ariel",
+            48 * fontScale, osdd->pixelAspectRatio) == YUV_OK);
 
-    CHK_ORET(char_set_to_overlay(&osdd->p_info, &osdd->numberData, "0123456789",
-        "Ariel", 34 * fontScale, osdd->pixelAspectRatio) >= 0);
+        CHK_ORET(char_set_to_overlay(&osdd->p_info, &osdd->numberData, "0123456789",
+            "Ariel", 34 * fontScale, osdd->pixelAspectRatio) >= 0);
 
-    CHK_ORET(char_set_to_overlay(&osdd->p_info, &osdd->vtrErrorCodeData, "0123456789+",
-        "Ariel", 34 * fontScale, osdd->pixelAspectRatio) >= 0);
+        CHK_ORET(char_set_to_overlay(&osdd->p_info, &osdd->vtrErrorCodeData, "0123456789+",
+            "Ariel", 34 * fontScale, osdd->pixelAspectRatio) >= 0);
+
+        osdd->charSetFontScale = fontScale;
+        osdd->charSetPixelAspectRatio = osdd->pixelAspectRatio;
+    }
+
+    if (wasInitialised)
+    {
+        free_overlay(&osdd->markOverlay);
+        free_overlay(&osdd->droppedFrameOverlay);
+    }
 
     /* the message if "FRAME REPEAT" instead of "FRAME DROPPED" because the DVS card repeats the last frame
     if the next frame misses the time slot for output */
@@ -2037,6 +2145,8 @@ static int osdd_initialise(void* data, const StreamInfo* streamInfo, const Ratio
     CALLOC_ORET(osdd->secondUserMarksOverlay.buff, unsigned char,
         osdd->secondUserMarksOverlay.w * osdd->secondUserMarksOverlay.h * 2);
     osdd->secondUserMarksOverlay.Cbuff = NULL;
+    osdd->availableSourceWidth = 0;
+    osdd->lastAvailableSourceLength = 0;
 
     bufPtr = osdd->progressBarOverlay.buff;
     for (i = 0; i < PROGRESS_BAR_HEIGHT; i++)
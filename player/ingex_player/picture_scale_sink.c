@@ -24,11 +24,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <assert.h>
 
 #include <yuvlib/YUV_frame.h>
 #include <yuvlib/YUV_scale_pic.h>
 #include <yuvlib/YUV_small_pic.h>
+#include <yuvlib/YUV_threads.h>
 
 #include "picture_scale_sink.h"
 #include "logging.h"
@@ -38,6 +40,9 @@
 
 #define FIRST_OUTPUT_STREAM_ID      5000
 
+/* scale_pic is run in up to this number of horizontal bands */
+#define MAX_SCALE_BANDS             4
+
 #define INPUT_STREAM                group->scaled_streams
 
 
@@ -65,6 +70,7 @@ typedef struct ScaledStream
 
     unsigned char *workspace;
     size_t workspace_size;
+    void *band_workspaces[MAX_SCALE_BANDS];
 } ScaledStream;
 
 typedef struct ScaledStreamGroup
@@ -93,6 +99,9 @@ struct PictureScaleSink
 
     ScaledStreamGroup *scaled_stream_groups;
     int next_output_stream_id;
+
+    YUV_thread_pool *scale_pool;
+    int num_scale_bands;
 };
 
 typedef struct
@@ -475,9 +484,11 @@ static int init_scale_stream_group(PictureScaleSink *sink, ScaledStreamGroup *gr
     return 1;
 }
 
-static int init_scale_stream(ScaledStream *scaled_stream, SplitType split_type, int output_stream_id,
-                             const StreamInfo *output_stream_info)
+static int init_scale_stream(PictureScaleSink *sink, ScaledStream *scaled_stream, SplitType split_type,
+                             int output_stream_id, const StreamInfo *output_stream_info)
 {
+    int i;
+
     scaled_stream->split_type = split_type;
     scaled_stream->output_stream_id = output_stream_id;
     scaled_stream->output_stream_info = *output_stream_info;
@@ -495,8 +506,11 @@ static int init_scale_stream(ScaledStream *scaled_stream, SplitType split_type,
             assert(0);
     }
 
+    /* workspace_size is the size of each band's workspace; small_pic uses the first one */
     scaled_stream->workspace_size = 2 * output_stream_info->width * 4;
-    MALLOC_ORET(scaled_stream->workspace, unsigned char, scaled_stream->workspace_size);
+    MALLOC_ORET(scaled_stream->workspace, unsigned char, scaled_stream->workspace_size * sink->num_scale_bands);
+    for (i = 0; i < sink->num_scale_bands; i++)
+        scaled_stream->band_workspaces[i] = scaled_stream->workspace + i * scaled_stream->workspace_size;
 
     return 1;
 }
@@ -641,7 +655,7 @@ static ScaledStream* add_split_stream(PictureScaleSink *sink, ScaledStreamGroup
 
     StreamInfo mod_stream_info;
     init_split_stream_info(group, y_display_offset, split_type, &mod_stream_info);
-    CHK_OFAIL(init_scale_stream(new_scaled_stream, split_type, sink->next_output_stream_id++, &mod_stream_info));
+    CHK_OFAIL(init_scale_stream(sink, new_scaled_stream, split_type, sink->next_output_stream_id++, &mod_stream_info));
 
     return new_scaled_stream;
 
@@ -669,7 +683,7 @@ static ScaledStream* add_raster_stream(PictureScaleSink *sink, ScaledStreamGroup
 
     StreamInfo mod_stream_info;
     init_raster_stream_info(group, raster_scale_index, &mod_stream_info);
-    CHK_OFAIL(init_scale_stream(new_scaled_stream, NO_SPLIT, sink->next_output_stream_id++, &mod_stream_info));
+    CHK_OFAIL(init_scale_stream(sink, new_scaled_stream, NO_SPLIT, sink->next_output_stream_id++, &mod_stream_info));
 
     return new_scaled_stream;
 
@@ -699,7 +713,7 @@ static ScaledStream* add_raster_split_stream(PictureScaleSink *sink, ScaledStrea
 
     StreamInfo mod_stream_info;
     init_raster_split_stream_info(group, raster_stream, raster_scale_index, split_type, &mod_stream_info);
-    CHK_OFAIL(init_scale_stream(new_scaled_stream, split_type, sink->next_output_stream_id++, &mod_stream_info));
+    CHK_OFAIL(init_scale_stream(sink, new_scaled_stream, split_type, sink->next_output_stream_id++, &mod_stream_info));
 
     return new_scaled_stream;
 
@@ -814,12 +828,13 @@ static int scale_picture(PictureScaleSink *sink, ScaledStreamGroup *group, Scale
     }
     else
     {
-        CHK_ORET(scale_pic(&in_frame, &out_frame,
-                           0, 0,                /* x, y */
-                           scaled_stream->output_stream_info.width, scaled_stream->output_stream_info.height,
-                           1,                   /* assume interlaced */
-                           sink->apply_scale_filter, sink->apply_scale_filter,  /* horizontal, vertical filter */
-                           scaled_stream->workspace, scaled_stream->workspace_size) == 0);
+        CHK_ORET(scale_pic_bands(&in_frame, &out_frame,
+                                 0, 0,                /* x, y */
+                                 scaled_stream->output_stream_info.width, scaled_stream->output_stream_info.height,
+                                 1,                   /* assume interlaced */
+                                 sink->apply_scale_filter, sink->apply_scale_filter,  /* horizontal, vertical filter */
+                                 sink->scale_pool, sink->num_scale_bands,
+                                 scaled_stream->band_workspaces, scaled_stream->workspace_size) == 0);
     }
 
     scaled_stream->output_data_size = scaled_stream->output_buffer_size;
@@ -1269,6 +1284,8 @@ static void pss_sink_close(void *data)
     }
     sink->scaled_stream_groups = 0;
 
+    YUV_thread_pool_free(sink->scale_pool);
+
     SAFE_FREE(&sink);
 }
 
@@ -1309,6 +1326,7 @@ int pss_create_picture_scale(MediaSink *target_sink, int apply_scale_filter, int
                              PictureScaleSink **sink)
 {
     PictureScaleSink *new_sink;
+    int num_threads;
 
     CALLOC_ORET(new_sink, PictureScaleSink, 1);
     new_sink->apply_scale_filter = apply_scale_filter;
@@ -1317,6 +1335,17 @@ int pss_create_picture_scale(MediaSink *target_sink, int apply_scale_filter, int
     new_sink->target_sink = target_sink;
     new_sink->next_output_stream_id = FIRST_OUTPUT_STREAM_ID;
 
+    /* scale in a band per core, the calling thread doing one of the bands */
+    num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    if (num_threads > MAX_SCALE_BANDS - 1)
+        num_threads = MAX_SCALE_BANDS - 1;
+    if (num_threads > 0) {
+        new_sink->scale_pool = YUV_thread_pool_create(num_threads);
+        if (!new_sink->scale_pool)
+            ml_log_warn("Failed to create picture scale thread pool - scaling in a single thread\n");
+    }
+    new_sink->num_scale_bands = YUV_thread_pool_size(new_sink->scale_pool) + 1;
+
     new_sink->sink.data = new_sink;
     new_sink->sink.register_listener = pss_register_listener;
     new_sink->sink.unregister_listener = pss_unregister_listener;
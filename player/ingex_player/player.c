@@ -67,6 +67,7 @@
 #include "blank_source.h"
 #include "clapper_source.h"
 #include "clip_source.h"
+#include "sequence_source.h"
 #include "raw_dv_source.h"
 #include "ffmpeg_source.h"
 #include "vitc_reader_sink_source.h"
@@ -83,6 +84,9 @@
 
 #define MAX_VITC_LINE_READ          16
 
+#define MAX_EDL_ENTRIES             1024
+#define MAX_EDL_ENTRY_FILES         32
+
 
 typedef enum
 {
@@ -108,7 +112,8 @@ typedef enum
     BLANK_INPUT,
     CLAPPER_INPUT,
     DV_INPUT,
-    FFMPEG_INPUT
+    FFMPEG_INPUT,
+    EDL_INPUT
 } InputType;
 
 typedef struct
@@ -138,6 +143,25 @@ typedef struct
     const char* clipId;
 } InputInfo;
 
+typedef struct
+{
+    SequenceEntry entries[MAX_EDL_ENTRIES];
+    char* filenames[MAX_EDL_ENTRIES][MAX_EDL_ENTRY_FILES];
+    int numFilenames[MAX_EDL_ENTRIES];
+    int numEntries;
+    Rational frameRate;
+
+    /* MXF file source options */
+    int forceD3MXFInput;
+    int markPSEFails;
+    int markVTRErrors;
+    int markDigiBetaDropouts;
+    int markTimecodeBreaks;
+    int mxfLinuxDiskAccess;
+    int mxfLinux8bitPreload;
+    int mxfLinux10bitPreload;
+} EDLSequence;
+
 typedef struct
 {
     MediaSink* mediaSink;
@@ -172,6 +196,9 @@ typedef struct
     pthread_t termKeyboardThreadId;
 
     int writeAllMarks;
+
+    EDLSequence* edlSequences[MAX_INPUTS];
+    int numEDLSequences;
 } Player;
 
 
@@ -282,10 +309,31 @@ static void terminate_control_threads(Player* player)
 Player g_player;
 
 
+static void free_edl_sequence(EDLSequence** edl)
+{
+    int i, j;
+
+    if (*edl == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < MAX_EDL_ENTRIES; i++)
+    {
+        for (j = 0; j < (*edl)->numFilenames[i]; j++)
+        {
+            SAFE_FREE(&(*edl)->filenames[i][j]);
+        }
+    }
+
+    SAFE_FREE(edl);
+}
+
 static void cleanup_exit(int res)
 {
     Mark* marks = NULL;
     int numMarks = 0;
+    int i;
 
     /* reset signal handlers */
     if (signal(SIGINT, SIG_IGN) == SIG_ERR)
@@ -377,6 +425,12 @@ static void cleanup_exit(int res)
 
     vsd_close(&g_player.videoSwitchDatabase);
 
+    for (i = 0; i < g_player.numEDLSequences; i++)
+    {
+        free_edl_sequence(&g_player.edlSequences[i]);
+    }
+    g_player.numEDLSequences = 0;
+
     ml_log_file_close();
 
     exit(res);
@@ -624,6 +678,122 @@ static int parse_length(const char* text, int allowDecimal, int64_t* value, Rati
     return 0;
 }
 
+/* each line in the edit list file has the format '<in> <out> <mxf filename>+' */
+static int read_edl_file(const char* filename, EDLSequence* edl)
+{
+    FILE* edlFile;
+    char line[4096];
+    char* token;
+    int64_t in, out;
+    Rational frameRate;
+    int lineNumber = 0;
+
+    if ((edlFile = fopen(filename, "rb")) == NULL)
+    {
+        ml_log_error("Failed to open edit list file '%s'\n", filename);
+        return 0;
+    }
+
+    while (fgets(line, sizeof(line), edlFile) != NULL)
+    {
+        lineNumber++;
+
+        if ((token = strtok(line, " \t\r\n")) == NULL || token[0] == '#')
+        {
+            continue;
+        }
+        if (edl->numEntries >= MAX_EDL_ENTRIES)
+        {
+            ml_log_error("Maximum number of edit list entries, %d, exceeded\n", MAX_EDL_ENTRIES);
+            goto fail;
+        }
+
+        if (!parse_length(token, 1, &in, &frameRate))
+        {
+            ml_log_error("Invalid in point in edit list line %d\n", lineNumber);
+            goto fail;
+        }
+        if (frameRate.num >= 1 && frameRate.den >= 1)
+        {
+            edl->frameRate = frameRate;
+        }
+        if ((token = strtok(NULL, " \t\r\n")) == NULL ||
+            !parse_length(token, 1, &out, &frameRate) || out <= in)
+        {
+            ml_log_error("Invalid out point in edit list line %d\n", lineNumber);
+            goto fail;
+        }
+
+        edl->entries[edl->numEntries].start = in;
+        edl->entries[edl->numEntries].duration = out - in;
+        while ((token = strtok(NULL, " \t\r\n")) != NULL)
+        {
+            if (edl->numFilenames[edl->numEntries] >= MAX_EDL_ENTRY_FILES)
+            {
+                ml_log_error("Maximum number of files, %d, exceeded in edit list line %d\n",
+                             MAX_EDL_ENTRY_FILES, lineNumber);
+                goto fail;
+            }
+            edl->filenames[edl->numEntries][edl->numFilenames[edl->numEntries]] = strdup(token);
+            edl->numFilenames[edl->numEntries]++;
+        }
+        if (edl->numFilenames[edl->numEntries] == 0)
+        {
+            ml_log_error("Missing files in edit list line %d\n", lineNumber);
+            goto fail;
+        }
+
+        edl->numEntries++;
+    }
+
+    fclose(edlFile);
+    return 1;
+
+fail:
+    fclose(edlFile);
+    return 0;
+}
+
+static int open_edl_entry(void* data, int entryIndex, MediaSource** source)
+{
+    EDLSequence* edl = (EDLSequence*)data;
+    MultipleMediaSources* multipleSource;
+    MXFFileSource* mxfSource;
+    MediaSource* mediaSource;
+    MediaSource* entrySource;
+    Rational maxLengthFrameRate = {0, 0};
+    int i;
+
+    CHK_ORET(mls_create(NULL, -1, &maxLengthFrameRate, &multipleSource));
+    entrySource = mls_get_media_source(multipleSource);
+
+    for (i = 0; i < edl->numFilenames[entryIndex]; i++)
+    {
+        if (!mxfs_open(edl->filenames[entryIndex][i], edl->forceD3MXFInput, edl->markPSEFails, edl->markVTRErrors,
+                       edl->markDigiBetaDropouts, edl->markTimecodeBreaks, edl->mxfLinuxDiskAccess,
+                       edl->mxfLinux8bitPreload, edl->mxfLinux10bitPreload, &mxfSource))
+        {
+            ml_log_error("Failed to open MXF file source '%s'\n", edl->filenames[entryIndex][i]);
+            goto fail;
+        }
+        mediaSource = mxfs_get_media_source(mxfSource);
+
+        if (!mls_assign_source(multipleSource, &mediaSource))
+        {
+            ml_log_error("Failed to assign media source to multiple source\n");
+            msc_close(mediaSource);
+            goto fail;
+        }
+    }
+
+    *source = entrySource;
+    return 1;
+
+fail:
+    msc_close(entrySource);
+    return 0;
+}
+
 static int parse_vitc_lines(const char *text, unsigned int *vitcLines, int *numVITCLines)
 {
     (*numVITCLines) = 0;
@@ -861,6 +1031,7 @@ static void usage(const char* cmd)
     fprintf(stderr, "  --lock                   Start with lock on\n");
     fprintf(stderr, "  --fthreads <num>         Number if FFMPEG threads to use when decoding (default = 4)\n");
     fprintf(stderr, "  --wthreads               Use worker threads for decoding essence\n");
+    fprintf(stderr, "  --frame-cache <MB>       Cache up to <MB> megabytes of decoded video frames for seekable sources (default 0, disabled)\n");
     fprintf(stderr, "  --qc-control             Use the QC media control mappings and start with the player paused\n");
     fprintf(stderr, "  --qc-session <prefix>        Log quality control session to file with filename <prefix>_qclog_yyyymmdd_hhmmss.txt\n");
     fprintf(stderr, "  --exit-at-end            Close the player when the end of stream is reached\n");
@@ -949,6 +1120,7 @@ static void usage(const char* cmd)
     fprintf(stderr, "  --src-fps <num>          Video frame rate for the source. Valid values are 25 (PAL) or 30 (NTSC)\n");
     fprintf(stderr, "  --src-aspect <num:den>   Video aspect ratio for raw input or generated sources\n");
     fprintf(stderr, "  --raw-in  <file>         Raw file input\n");
+    fprintf(stderr, "  --edl <file>             Edit list of MXF file sets played back to back. Each line is '<in> <out> <mxf file>+'\n");
 #if defined(HAVE_FFMPEG)
     fprintf(stderr, "  --dv <file>              Raw DV-DIF input (currently video only)\n");
 #endif
@@ -1011,6 +1183,7 @@ int main(int argc, const char **argv)
 #endif
     int dvsBufferSize = 12;
     int useWorkerThreads = 0;
+    int frameCacheMB = 0;
     int closeAtEnd = 0;
     struct timeval startTime;
     struct timeval endTime;
@@ -1082,6 +1255,8 @@ int main(int argc, const char **argv)
     int64_t clipDuration = -1;
     Rational clipFrameRate = {0, 0};
     ClipSource* clipSource = NULL;
+    EDLSequence* edlSequence = NULL;
+    SequenceSource* sequenceSource = NULL;
     int prescaledSplit = 0;
     int64_t startFrame = -1;
     Rational startFrameFrameRate = {0, 0};
@@ -1577,6 +1752,23 @@ int main(int argc, const char **argv)
             useWorkerThreads = 1;
             cmdlnIndex += 1;
         }
+        else if (strcmp(argv[cmdlnIndex], "--frame-cache") == 0)
+        {
+            if (cmdlnIndex + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for %s\n", argv[cmdlnIndex]);
+                return 1;
+            }
+            if (sscanf(argv[cmdlnIndex + 1], "%d", &frameCacheMB) != 1 ||
+                frameCacheMB < 0)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid argument for %s\n", argv[cmdlnIndex]);
+                return 1;
+            }
+            cmdlnIndex += 2;
+        }
         else if (strcmp(argv[cmdlnIndex], "--qc-control") == 0)
         {
             qcControl = 1;
@@ -2450,6 +2642,19 @@ int main(int argc, const char **argv)
             cmdlnIndex += 2;
         }
 #endif
+        else if (strcmp(argv[cmdlnIndex], "--edl") == 0)
+        {
+            if (cmdlnIndex + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for %s\n", argv[cmdlnIndex]);
+                return 1;
+            }
+            inputs[numInputs].type = EDL_INPUT;
+            inputs[numInputs].filename = argv[cmdlnIndex + 1];
+            numInputs++;
+            cmdlnIndex += 2;
+        }
 #if defined(HAVE_FFMPEG) && defined(HAVE_FFMPEG_SWSCALE)
         else if (strcmp(argv[cmdlnIndex], "--ffmpeg") == 0)
         {
@@ -2764,6 +2969,45 @@ int main(int argc, const char **argv)
                 }
                 break;
 
+            case EDL_INPUT:
+                CALLOC_OFAIL(edlSequence, EDLSequence, 1);
+                edlSequence->forceD3MXFInput = forceD3MXFInput;
+                edlSequence->markPSEFails = markPSEFails;
+                edlSequence->markVTRErrors = markVTRErrors;
+                edlSequence->markDigiBetaDropouts = markDigiBetaDropouts;
+                edlSequence->markTimecodeBreaks = markTimecodeBreaks;
+                edlSequence->mxfLinuxDiskAccess = mxfLinuxDiskAccess;
+                edlSequence->mxfLinux8bitPreload = mxfLinux8bitPreload;
+                edlSequence->mxfLinux10bitPreload = mxfLinux10bitPreload;
+                if (!read_edl_file(inputs[i].filename, edlSequence))
+                {
+                    ml_log_error("Failed to read edit list file\n");
+                    free_edl_sequence(&edlSequence);
+                    openInputFailed = 1;
+                }
+                else
+                {
+                    SequenceEntryOpener opener;
+                    opener.data = edlSequence;
+                    opener.open_entry = open_edl_entry;
+                    if (!sqs_create(edlSequence->entries, edlSequence->numEntries, &edlSequence->frameRate, &opener,
+                                    &sequenceSource))
+                    {
+                        ml_log_error("Failed to create edit list sequence source\n");
+                        free_edl_sequence(&edlSequence);
+                        openInputFailed = 1;
+                    }
+                    else
+                    {
+                        mediaSource = sqs_get_media_source(sequenceSource);
+
+                        /* the sequence source opens the entries until it is closed in cleanup_exit */
+                        g_player.edlSequences[g_player.numEDLSequences++] = edlSequence;
+                        edlSequence = NULL;
+                    }
+                }
+                break;
+
             default:
                 ml_log_error("Unknown input type (%d) for input %d\n", inputs[i].type, i);
                 assert(0);
@@ -2811,6 +3055,7 @@ int main(int argc, const char **argv)
                 case MXF_INPUT:
                 case RAW_INPUT:
                 case UDP_INPUT:
+                case EDL_INPUT:
                     printf("%s = %s\n", inputs[i].sourceName, inputs[i].filename);
                     break;
 
@@ -3304,6 +3549,14 @@ int main(int argc, const char **argv)
         bmsrc_set_media_player(bufferedSource, g_player.mediaPlayer);
     }
 
+    if (frameCacheMB > 0)
+    {
+        if (!ply_set_frame_cache_size(g_player.mediaPlayer, (int64_t)frameCacheMB * 1024 * 1024))
+        {
+            ml_log_warn("Failed to enable the decoded frame cache\n");
+        }
+    }
+
 
     /* set the start offset for position values returned by the player */
 
@@ -21,6 +21,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* O_DIRECT */
+#endif
+
 #if ! defined(_LARGEFILE_SOURCE) && ! defined(_FILE_OFFSET_BITS)
 #define _LARGEFILE_SOURCE
 #define _FILE_OFFSET_BITS 64
@@ -59,6 +63,11 @@
 
 #define TAPEBLOCK                           (512*512)
 
+/* the tape buffer sits between the tape reader and the cache disk writer so that a disk
+stall doesn't stop the tape, which would then have to reposition */
+#define TAPE_BUFFER_NUM_BLOCKS              1024    /* 256 MB */
+#define MAX_DISK_WRITE_BLOCKS               32      /* 8 MB */
+
 #define INDEX_ENTRY_ALLOC_STEP              20
 
 #define FREE_DISK_SPACE_MARGIN              10e6
@@ -81,11 +90,39 @@ typedef struct
     int allocEntries;
 } IndexFile;
 
+typedef struct
+{
+    unsigned char* data;
+    pthread_mutex_t mutex;
+    pthread_cond_t blockReadCond;
+    pthread_cond_t blockWrittenCond;
+    int64_t numBlocksRead;
+    int64_t numBlocksWritten;
+    int abortWrite;
+    int writeEnded;
+    int writeFailed;
+
+    /* the cache file being written */
+    int fd;
+    int isDirectIO;
+    int64_t fileSize;
+    int64_t dataOffset;
+    int64_t numBlocks;
+} TapeBuffer;
+
 struct QCLTOExtract
 {
     char* cacheDirectory;
     char* tapeDevice;
 
+    /* a regular (tar) file standing in for the tape device */
+    int isTapeFile;
+    int tapeFileNum;
+    int tapeFileBlockNo;
+    int64_t tapeFileOffset;
+
+    TapeBuffer tapeBuffer;
+
     char startLTOSpoolNumber[32];
     char startFilename[32];
     int startExtract;
@@ -368,8 +405,152 @@ static int parse_tar_header(const unsigned char* tarBytes, int64_t* fileSize, in
     return 1;
 }
 
-static int get_tape_pos(const char* device, int* fileNo, int* blockNo)
+static int is_zero_tar_block(const unsigned char* tarBytes)
+{
+    int i;
+
+    for (i = 0; i < 512; i++)
+    {
+        if (tarBytes[i] != 0)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int open_tape(QCLTOExtract* extract)
+{
+    int fd;
+    if ((fd = open(extract->tapeDevice, O_RDONLY|O_NONBLOCK|O_LARGEFILE)) == -1) {
+        ml_log_error("Failed to open device %s: %s\n", extract->tapeDevice, strerror(errno));
+        return -1;
+    }
+
+    if (extract->isTapeFile && lseek(fd, extract->tapeFileOffset, SEEK_SET) == (off_t)-1) {
+        ml_log_error("Failed to seek in tape file %s: %s\n", extract->tapeDevice, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/* A read from the tape returns a whole TAPEBLOCK. A read from a tape file is short at the end of
+the file and the remainder of the block is zeroed */
+static ssize_t read_tape_block(QCLTOExtract* extract, int fd, unsigned char* block)
+{
+    ssize_t nread;
+    ssize_t total = 0;
+
+    if (!extract->isTapeFile)
+    {
+        return read(fd, block, TAPEBLOCK);
+    }
+
+    while (total < TAPEBLOCK)
+    {
+        nread = read(fd, block + total, TAPEBLOCK - total);
+        if (nread < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        else if (nread == 0)
+        {
+            break;
+        }
+        total += nread;
+    }
+    memset(block + total, 0, TAPEBLOCK - total);
+
+    extract->tapeFileOffset += total;
+    extract->tapeFileBlockNo++;
+
+    return total;
+}
+
+/* Tape file 'num' is the num'th member of the tar file standing in for the tape, where the index
+file is member 0. The tar file can also be a concatenation of tar files, one for each tape file */
+static int seek_tape_file(QCLTOExtract* extract, int num)
 {
+    unsigned char* tarBytes = NULL;
+    int64_t pos = 0;
+    int64_t fileSize;
+    int64_t offset;
+    int fileNum = 0;
+    int fd;
+
+    set_extract_state(extract, LTO_BUSY_SEEKING_STATUS, NULL, NULL, -1);
+
+    if ((fd = open(extract->tapeDevice, O_RDONLY|O_LARGEFILE)) == -1) {
+        ml_log_error("Failed to open tape file %s: %s\n", extract->tapeDevice, strerror(errno));
+        return 0;
+    }
+    MALLOC_OFAIL(tarBytes, unsigned char, TAPEBLOCK);
+
+    while (1)
+    {
+        /* skip the end of archive and padding blocks */
+        while (1)
+        {
+            if (pread(fd, tarBytes, 512, pos) != 512)
+            {
+                ml_log_error("Tape file %d is beyond the end of tape file %s\n", num, extract->tapeDevice);
+                goto fail;
+            }
+            if (!is_zero_tar_block(tarBytes))
+            {
+                break;
+            }
+            pos += 512;
+        }
+
+        if (fileNum == num)
+        {
+            break;
+        }
+
+        memset(tarBytes, 0, TAPEBLOCK);
+        if (pread(fd, tarBytes, TAPEBLOCK, pos) < 512 ||
+            !parse_tar_header(tarBytes, &fileSize, &offset))
+        {
+            ml_log_error("Failed to parse the tar header at offset %"PRId64" in tape file %s\n", pos, extract->tapeDevice);
+            goto fail;
+        }
+        pos += offset + ((fileSize + 511) / 512) * 512;
+        fileNum++;
+    }
+
+    extract->tapeFileNum = num;
+    extract->tapeFileBlockNo = 0;
+    extract->tapeFileOffset = pos;
+
+    SAFE_FREE(&tarBytes);
+    close(fd);
+    return 1;
+
+fail:
+    SAFE_FREE(&tarBytes);
+    close(fd);
+    return 0;
+}
+
+static int get_tape_pos(QCLTOExtract* extract, int* fileNo, int* blockNo)
+{
+    const char* device = extract->tapeDevice;
+
+    if (extract->isTapeFile)
+    {
+        *fileNo = extract->tapeFileNum;
+        *blockNo = extract->tapeFileBlockNo;
+        return 1;
+    }
+
     int fd;
     if ((fd = open(device, O_RDONLY|O_NONBLOCK|O_LARGEFILE)) == -1) {
         ml_log_error("Failed to open device %s: %s\n", device, strerror(errno));
@@ -388,8 +569,18 @@ static int get_tape_pos(const char* device, int* fileNo, int* blockNo)
     close(fd); return 1;
 }
 
-static int rewind_tape(const char *device)
+static int rewind_tape(QCLTOExtract* extract)
 {
+    const char* device = extract->tapeDevice;
+
+    if (extract->isTapeFile)
+    {
+        extract->tapeFileNum = 0;
+        extract->tapeFileBlockNo = 0;
+        extract->tapeFileOffset = 0;
+        return 1;
+    }
+
     int fd;
     if ((fd = open(device, O_RDONLY|O_NONBLOCK|O_LARGEFILE)) == -1) {
         ml_log_error("Failed to open device %s: %s\n", device, strerror(errno));
@@ -412,8 +603,15 @@ static int rewind_tape(const char *device)
 
 // Set block size and compression parameters
 // Should be called after tape load since settings are reset after tape load
-static int set_tape_params(const char *device)
+static int set_tape_params(QCLTOExtract* extract)
 {
+    const char* device = extract->tapeDevice;
+
+    if (extract->isTapeFile)
+    {
+        return 1;
+    }
+
     int fd;
     if ((fd = open(device, O_RDONLY|O_NONBLOCK|O_LARGEFILE)) == -1) {
         ml_log_error("Failed to open device %s: %s\n", device, strerror(errno));
@@ -444,8 +642,19 @@ static int set_tape_params(const char *device)
 }
 
 // returns whether tape drive state is understood, including drive failure
-static QCLTOExtractStatus probe_tape_status(const char *device)
+static QCLTOExtractStatus probe_tape_status(QCLTOExtract* extract)
 {
+    const char* device = extract->tapeDevice;
+
+    if (extract->isTapeFile)
+    {
+        if (access(device, R_OK) != 0)
+        {
+            return LTO_NO_TAPE_DEVICE_ACCESS_STATUS;
+        }
+        return LTO_ONLINE_STATUS;
+    }
+
     int fd;
     if ((fd = open(device, O_RDONLY|O_NONBLOCK|O_LARGEFILE)) == -1) {
         switch (errno) {
@@ -512,7 +721,7 @@ static int seek_to_file(QCLTOExtract* extract, int num)
     int fileNo = -1;
     int blockNo = -1;
 
-    if (get_tape_pos(extract->tapeDevice, &fileNo, &blockNo))
+    if (get_tape_pos(extract, &fileNo, &blockNo))
     {
         ml_log_warn("Failed to get tape pos - rewinding tape\n");
     }
@@ -521,14 +730,14 @@ static int seek_to_file(QCLTOExtract* extract, int num)
     {
         set_extract_state(extract, LTO_BUSY_REWINDING_STATUS, NULL, NULL, -1);
 
-        if (!rewind_tape(extract->tapeDevice))
+        if (!rewind_tape(extract))
         {
             ml_log_error("Failed to rewind tape to allow seek to file\n");
             return 0;
         }
         haveRewoundTape = 1;
 
-        if (!get_tape_pos(extract->tapeDevice, &fileNo, &blockNo) || fileNo < 0 || blockNo < 0)
+        if (!get_tape_pos(extract, &fileNo, &blockNo) || fileNo < 0 || blockNo < 0)
         {
             ml_log_error("Failed to get tape pos\n");
             return 0;
@@ -547,13 +756,20 @@ static int seek_to_file(QCLTOExtract* extract, int num)
             set_extract_state(extract, LTO_BUSY_REWINDING_STATUS, NULL, NULL, -1);
 
             /* the start of the tape doesn't have a file mark so we do a rewind */
-            if (!rewind_tape(extract->tapeDevice))
+            if (!rewind_tape(extract))
             {
                 ml_log_error("Failed to rewind tape to allow seek to file\n");
                 return 0;
             }
         }
     }
+    else if (extract->isTapeFile)
+    {
+        if (!seek_tape_file(extract, num))
+        {
+            return 0;
+        }
+    }
     else
     {
         int fd;
@@ -761,14 +977,13 @@ static int extract_index_file(QCLTOExtract* extract, unsigned char* buffer)
     set_extract_state(extract, LTO_BUSY_EXTRACTING_INDEX_STATUS, NULL, NULL, -1);
 
     int fd;
-    if ((fd = open(extract->tapeDevice, O_RDONLY|O_NONBLOCK|O_LARGEFILE)) == -1) {
-        ml_log_error("Failed to open device %s: %s\n", extract->tapeDevice, strerror(errno));
+    if ((fd = open_tape(extract)) == -1) {
         return -1;
     }
 
     // POSIX tar header is 512 bytes
-    ssize_t nread = read(fd, buffer, TAPEBLOCK);
-    if (nread != TAPEBLOCK)
+    ssize_t nread = read_tape_block(extract, fd, buffer);
+    if (nread != TAPEBLOCK && (!extract->isTapeFile || nread < 512))
     {
         if (nread < 0)
         {
@@ -821,6 +1036,11 @@ static int extract_index_file(QCLTOExtract* extract, unsigned char* buffer)
         ml_log_error("Index file size %"PRId64" is larger than buffer size %"PRId64"\n", fileSize, TAPEBLOCK - offset);
         close(fd); return -1;
     }
+    if (offset + fileSize > nread)
+    {
+        ml_log_error("Tape file is truncated: read %d bytes of index file\n", nread);
+        close(fd); return -1;
+    }
 
     /* parse the index file */
     PTHREAD_MUTEX_LOCK(&extract->indexFileMutex);
@@ -914,13 +1134,187 @@ fail:
     close(fd); return -1;
 }
 
+static int extract_stopped(QCLTOExtract* extract)
+{
+    return extract->stopping ||
+        extract->stopExtract ||
+        (extract->startExtract && !extract->extractAll);
+}
+
+static void update_tape_read_state(QCLTOExtract* extract, int64_t bytesRead, struct timeval* start,
+    int stallCount, long stallTime, int64_t numBlocksBuffered)
+{
+    struct timeval now;
+    long diff;
+
+    gettimeofday(&now, NULL);
+    diff = (now.tv_sec - start->tv_sec) * 1000000 + now.tv_usec - start->tv_usec;
+
+    PTHREAD_MUTEX_LOCK(&extract->stateMutex);
+
+    extract->state.tapeBytesRead = bytesRead;
+    extract->state.tapeReadRate = (diff > 0) ? bytesRead / (float)diff : 0.0;
+    extract->state.tapeBufferFill = (int)(numBlocksBuffered * 100 / TAPE_BUFFER_NUM_BLOCKS);
+    extract->state.tapeStallCount = stallCount;
+    extract->state.tapeStallTime = stallTime / 1000000.0;
+
+    PTHREAD_MUTEX_UNLOCK(&extract->stateMutex);
+}
+
+static int open_cache_file(const char* filename, int* isDirectIO)
+{
+    int fd;
+
+    /* direct I/O keeps the extracted files out of the page cache */
+    *isDirectIO = 1;
+    fd = open(filename, O_WRONLY|O_CREAT|O_TRUNC|O_LARGEFILE|O_DIRECT, 0666);
+    if (fd == -1 && errno == EINVAL)
+    {
+        /* file system doesn't support direct I/O */
+        *isDirectIO = 0;
+        fd = open(filename, O_WRONLY|O_CREAT|O_TRUNC|O_LARGEFILE, 0666);
+    }
+
+    return fd;
+}
+
+static int write_cache_file(TapeBuffer* buffer, const unsigned char* data, int64_t filePos, int64_t size)
+{
+    int64_t writeSize;
+    ssize_t numWrite;
+
+    while (size > 0)
+    {
+        /* the data and file position are aligned to the 512 byte tar blocks. Direct I/O writes
+        are padded to the tar block size and the file is truncated to its size once complete */
+        writeSize = buffer->isDirectIO ? ((size + 511) / 512) * 512 : size;
+
+        numWrite = pwrite(buffer->fd, data, writeSize, filePos);
+        if (numWrite < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EINVAL && buffer->isDirectIO)
+            {
+                /* the disk requires a larger direct I/O alignment */
+                ml_log_warn("Direct I/O write failed - reverting to buffered writes\n");
+                buffer->isDirectIO = 0;
+                if (fcntl(buffer->fd, F_SETFL, fcntl(buffer->fd, F_GETFL) & ~O_DIRECT) == -1)
+                {
+                    ml_log_error("Failed to disable direct I/O: %s\n", strerror(errno));
+                    return 0;
+                }
+                continue;
+            }
+            ml_log_error("Failed to write the tape file: %s\n", strerror(errno));
+            return 0;
+        }
+        if (numWrite >= size)
+        {
+            break;
+        }
+
+        data += numWrite;
+        filePos += numWrite;
+        size -= numWrite;
+    }
+
+    return 1;
+}
+
+/* writes the blocks read from the tape to the cache file */
+static void* disk_write_thread(void* arg)
+{
+    QCLTOExtract* extract = (QCLTOExtract*)arg;
+    TapeBuffer* buffer = &extract->tapeBuffer;
+    int64_t numAvailable;
+    int64_t numWriteBlocks;
+    int64_t blockIndex;
+    int64_t dataOffset;
+    int64_t filePos;
+    int64_t size;
+    int abortWrite;
+    int writeFailed = 0;
+
+    while (buffer->numBlocksWritten < buffer->numBlocks)
+    {
+        PTHREAD_MUTEX_LOCK(&buffer->mutex);
+        while (!buffer->abortWrite && buffer->numBlocksRead == buffer->numBlocksWritten)
+        {
+            pthread_cond_wait(&buffer->blockReadCond, &buffer->mutex);
+        }
+        numAvailable = buffer->numBlocksRead - buffer->numBlocksWritten;
+        abortWrite = buffer->abortWrite;
+        PTHREAD_MUTEX_UNLOCK(&buffer->mutex);
+
+        if (abortWrite || extract_stopped(extract))
+        {
+            break;
+        }
+
+        /* write contiguous blocks in the buffer */
+        blockIndex = buffer->numBlocksWritten % TAPE_BUFFER_NUM_BLOCKS;
+        numWriteBlocks = numAvailable;
+        if (numWriteBlocks > TAPE_BUFFER_NUM_BLOCKS - blockIndex)
+        {
+            numWriteBlocks = TAPE_BUFFER_NUM_BLOCKS - blockIndex;
+        }
+        if (numWriteBlocks > MAX_DISK_WRITE_BLOCKS)
+        {
+            numWriteBlocks = MAX_DISK_WRITE_BLOCKS;
+        }
+
+        /* the file data starts after the tar header in the first block */
+        dataOffset = (buffer->numBlocksWritten == 0) ? buffer->dataOffset : 0;
+        filePos = buffer->numBlocksWritten * TAPEBLOCK - buffer->dataOffset + dataOffset;
+        size = numWriteBlocks * TAPEBLOCK - dataOffset;
+        if (filePos + size > buffer->fileSize)
+        {
+            size = buffer->fileSize - filePos;
+        }
+
+        if (!write_cache_file(buffer, &buffer->data[blockIndex * TAPEBLOCK + dataOffset], filePos, size))
+        {
+            writeFailed = 1;
+            break;
+        }
+        extract->bytesWritten = filePos + size;
+
+        PTHREAD_MUTEX_LOCK(&buffer->mutex);
+        buffer->numBlocksWritten += numWriteBlocks;
+        PTHREAD_COND_SIGNAL(&buffer->blockWrittenCond);
+        PTHREAD_MUTEX_UNLOCK(&buffer->mutex);
+    }
+
+    PTHREAD_MUTEX_LOCK(&buffer->mutex);
+    buffer->writeEnded = 1;
+    buffer->writeFailed = writeFailed;
+    PTHREAD_COND_SIGNAL(&buffer->blockWrittenCond);
+    PTHREAD_MUTEX_UNLOCK(&buffer->mutex);
+
+    pthread_exit((void*) 0);
+}
+
 /* note: extract->bytesWritten must be set to 0 before calling this function */
-static int extract_file(QCLTOExtract* extract, unsigned char* buffer, int fileNum,
-    int64_t fileSizeInIndex, int64_t freeDiskSpace)
+static int extract_file(QCLTOExtract* extract, int fileNum, int64_t fileSizeInIndex, int64_t freeDiskSpace)
 {
     char filename[FILENAME_MAX];
     char sysCmd[FILENAME_MAX];
     struct stat statBuf;
+    TapeBuffer* buffer = &extract->tapeBuffer;
+
+    /* allocate the tape buffer on first use, aligned for direct I/O */
+    if (buffer->data == NULL)
+    {
+        if (posix_memalign((void**)&buffer->data, 4096, (size_t)TAPE_BUFFER_NUM_BLOCKS * TAPEBLOCK) != 0)
+        {
+            ml_log_error("Failed to allocate %d MB tape buffer\n", TAPE_BUFFER_NUM_BLOCKS * (TAPEBLOCK / 1024) / 1024);
+            buffer->data = NULL;
+            return 0;
+        }
+    }
 
     /* seek to position to position tape at start of the index file */
     if (!seek_to_file(extract, fileNum))
@@ -949,20 +1343,24 @@ static int extract_file(QCLTOExtract* extract, unsigned char* buffer, int fileNu
 
     /* read and write to the cache sub-directory */
     int fd;
-    if ((fd = open(extract->tapeDevice, O_RDONLY|O_NONBLOCK|O_LARGEFILE)) == -1) {
-        ml_log_error("Failed to open device %s: %s\n", extract->tapeDevice, strerror(errno));
+    if ((fd = open_tape(extract)) == -1) {
         return 0;
     }
 
+    struct timeval readStart;
+    gettimeofday(&readStart, NULL);
+    update_tape_read_state(extract, 0, &readStart, 0, 0, 0);
+
     // POSIX tar header is 512 bytes
-    ssize_t nread = read(fd, buffer, TAPEBLOCK);
-    if (nread != TAPEBLOCK) {
+    ssize_t nread = read_tape_block(extract, fd, buffer->data);
+    if (nread != TAPEBLOCK && (!extract->isTapeFile || nread < 512)) {
         ml_log_error("read %d instead of TAPEBLOCK\n", nread);
         close(fd); return 0;
     }
+    int64_t bytesRead = nread;
 
     // tar magic at offset 257 should be "ustar" followed by space or NUL
-    unsigned char *pmagic = buffer + 257;
+    unsigned char *pmagic = buffer->data + 257;
     unsigned char magic1[6] = {'u','s','t','a','r','\0'};
     unsigned char magic2[6] = {'u','s','t','a','r',' '};
     if (memcmp(pmagic, magic1, 6) != 0 && memcmp(pmagic, magic2, 6) != 0) {
@@ -975,11 +1373,11 @@ static int extract_file(QCLTOExtract* extract, unsigned char* buffer, int fileNu
        tar run with option '--format=posix' will by default write the name as '%d/PaxHeaders.%p/%f'
        where %d is the directory, %p is the process id and %f is the filename
        we strip out the bit before the last slash to get the name (%f) */
-    char* name = strrchr((char*)buffer, '/');
+    char* name = strrchr((char*)buffer->data, '/');
     if (name == NULL)
     {
         /* not posix tar with default name format */
-        name = (char*)buffer;
+        name = (char*)buffer->data;
     }
     else
     {
@@ -993,11 +1391,16 @@ static int extract_file(QCLTOExtract* extract, unsigned char* buffer, int fileNu
 
     int64_t fileSize;
     int64_t offset;
-    if (!parse_tar_header(buffer, &fileSize, &offset))
+    if (!parse_tar_header(buffer->data, &fileSize, &offset))
     {
         ml_log_error("Failed to parse the tar header\n");
         close(fd); return 0;
     }
+    if (offset >= TAPEBLOCK || (nread < TAPEBLOCK && nread < offset + fileSize))
+    {
+        ml_log_error("Tar header size %"PRId64" or read size %d is invalid\n", offset, nread);
+        close(fd); return 0;
+    }
 
     if (fileSize != fileSizeInIndex)
     {
@@ -1015,49 +1418,87 @@ static int extract_file(QCLTOExtract* extract, unsigned char* buffer, int fileNu
     /* check just before we open (and truncate) the file that the extract hasn't being stopped.
     This will prevent the file being truncated to zero when the user selected to stop the extract
     whilst the tape drive was still seeking and before the extract actually started */
-    if (extract->stopping ||
-        extract->stopExtract ||
-        (extract->startExtract && !extract->extractAll))
+    if (extract_stopped(extract))
     {
         close(fd); return 1;
     }
 
-    FILE* file;
-    if ((file = fopen(filename, "wb")) == NULL)
+    if ((buffer->fd = open_cache_file(filename, &buffer->isDirectIO)) == -1)
     {
         ml_log_error("Failed to create the tape file: %s\n", strerror(errno));
         close(fd); return 0;
     }
 
+
+    /* start the disk writer, which writes the blocks as they are read from the tape */
+    pthread_t writeThreadId;
+    buffer->fileSize = fileSize;
+    buffer->dataOffset = offset;
+    buffer->numBlocks = (offset + fileSize + TAPEBLOCK - 1) / TAPEBLOCK;
+    buffer->numBlocksRead = 1;
+    buffer->numBlocksWritten = 0;
+    buffer->abortWrite = 0;
+    buffer->writeEnded = 0;
+    buffer->writeFailed = 0;
+    if (!create_joinable_thread(&writeThreadId, disk_write_thread, extract))
+    {
+        close(buffer->fd); close(fd); return 0;
+    }
+
     struct timeval start;
     gettimeofday(&start, NULL);
     struct timeval end = start;
+    struct timeval stallStart;
     long diff;
-    int64_t count = 0;
-    int64_t numWrite;
-    while (!extract->stopping &&
-        !extract->stopExtract &&
-        (!extract->startExtract || extract->extractAll) &&
-        count < fileSize)
-    {
-        numWrite = (count + (TAPEBLOCK - offset) < fileSize) ? (TAPEBLOCK - offset) : fileSize - count;
-        if (fwrite(buffer + offset, numWrite, 1, file) != 1)
+    int stallCount = 0;
+    long stallTime = 0;
+    int64_t blockIndex;
+    int64_t numBlocksBuffered;
+    int64_t blockSize;
+    int writeEnded;
+    int readFailed = 0;
+    while (buffer->numBlocksRead < buffer->numBlocks)
+    {
+        /* wait for space in the tape buffer */
+        PTHREAD_MUTEX_LOCK(&buffer->mutex);
+        if (!buffer->writeEnded &&
+            buffer->numBlocksRead - buffer->numBlocksWritten >= TAPE_BUFFER_NUM_BLOCKS)
         {
-            ml_log_error("Failed to write the tape file: %s\n", strerror(errno));
-            fclose(file); close(fd); return 0;
+            stallCount++;
+            gettimeofday(&stallStart, NULL);
+            while (!buffer->writeEnded &&
+                buffer->numBlocksRead - buffer->numBlocksWritten >= TAPE_BUFFER_NUM_BLOCKS)
+            {
+                pthread_cond_wait(&buffer->blockWrittenCond, &buffer->mutex);
+            }
+            gettimeofday(&end, NULL);
+            stallTime += (end.tv_sec - stallStart.tv_sec) * 1000000 + end.tv_usec - stallStart.tv_usec;
         }
-        count += numWrite;
-        extract->bytesWritten += numWrite;
-        offset = 0;
+        writeEnded = buffer->writeEnded;
+        PTHREAD_MUTEX_UNLOCK(&buffer->mutex);
 
-        if (count < fileSize)
+        if (writeEnded || extract_stopped(extract))
         {
-            nread = read(fd, buffer, TAPEBLOCK);
-            if (nread != TAPEBLOCK) {
-                ml_log_error("read %d instead of TAPEBLOCK\n", nread);
-                fclose(file); close(fd); return 0;
-            }
+            break;
+        }
+
+        blockIndex = buffer->numBlocksRead % TAPE_BUFFER_NUM_BLOCKS;
+        blockSize = offset + fileSize - buffer->numBlocksRead * TAPEBLOCK;
+        nread = read_tape_block(extract, fd, &buffer->data[blockIndex * TAPEBLOCK]);
+        if (nread != TAPEBLOCK && (!extract->isTapeFile || nread < blockSize)) {
+            ml_log_error("read %d instead of TAPEBLOCK\n", nread);
+            readFailed = 1;
+            break;
         }
+        bytesRead += nread;
+
+        PTHREAD_MUTEX_LOCK(&buffer->mutex);
+        buffer->numBlocksRead++;
+        numBlocksBuffered = buffer->numBlocksRead - buffer->numBlocksWritten;
+        PTHREAD_COND_SIGNAL(&buffer->blockReadCond);
+        PTHREAD_MUTEX_UNLOCK(&buffer->mutex);
+
+        update_tape_read_state(extract, bytesRead, &readStart, stallCount, stallTime, numBlocksBuffered);
 
         /* limit the throughput ~ 50 MB/s when a file is playing.
         The limit is set to 65 MB/s, which is practice limits the throughput to ~ 50 MB/s. The assumption
@@ -1072,10 +1513,44 @@ static int extract_file(QCLTOExtract* extract, unsigned char* buffer, int fileNu
         }
         start = end;
     }
-    fclose(file);
+    close(fd);
+
+    /* stop the writer if the read did not complete, else wait for it to write the remaining blocks */
+    PTHREAD_MUTEX_LOCK(&buffer->mutex);
+    if (buffer->numBlocksRead < buffer->numBlocks)
+    {
+        buffer->abortWrite = 1;
+        PTHREAD_COND_SIGNAL(&buffer->blockReadCond);
+    }
+    PTHREAD_MUTEX_UNLOCK(&buffer->mutex);
+    join_thread(&writeThreadId, NULL, NULL);
+
+    PTHREAD_MUTEX_LOCK(&extract->stateMutex);
+    extract->state.tapeBufferFill = 0;
+    PTHREAD_MUTEX_UNLOCK(&extract->stateMutex);
+
+    if (buffer->numBlocksWritten == buffer->numBlocks && buffer->isDirectIO &&
+        ftruncate(buffer->fd, fileSize) != 0)
+    {
+        ml_log_error("Failed to truncate the tape file: %s\n", strerror(errno));
+        buffer->writeFailed = 1;
+    }
+    if (close(buffer->fd) != 0)
+    {
+        ml_log_error("Failed to close the tape file: %s\n", strerror(errno));
+        buffer->writeFailed = 1;
+    }
+
+    ml_log_info("Read %"PRId64" MB from tape at %.1f MB/s; waited %.1f s for the cache disk %d times\n",
+        bytesRead / 1000000, extract->state.tapeReadRate, stallTime / 1000000.0, stallCount);
+
+    if (readFailed || buffer->writeFailed)
+    {
+        return 0;
+    }
 
     /* return 1 if completed extract, 2 if not */
-    close(fd); return 1;
+    return 1;
 }
 
 static void* extract_thread(void* arg)
@@ -1127,7 +1602,7 @@ static void* extract_thread(void* arg)
             case 0: /* poll tape device status */
                 if (diffTime > 1000000) /* poll status every second - note below with lastBusyLoadPosCount that we assume 1 second poll interval */
                 {
-                    status = probe_tape_status(extract->tapeDevice);
+                    status = probe_tape_status(extract);
 
                     if (status == LTO_ONLINE_STATUS)
                     {
@@ -1175,7 +1650,7 @@ static void* extract_thread(void* arg)
             case 1: /* tape device is online */
 
                 /* set tape params */
-                set_tape_params(extract->tapeDevice);
+                set_tape_params(extract);
 
 
                 /* extract index file */
@@ -1233,7 +1708,7 @@ static void* extract_thread(void* arg)
                     if (extractAll)
                     {
                         /* start with the next file */
-                        if (get_tape_pos(extract->tapeDevice, &fileNo, &blockNo))
+                        if (get_tape_pos(extract, &fileNo, &blockNo))
                         {
                             if (blockNo == 0)
                             {
@@ -1356,7 +1831,7 @@ static void* extract_thread(void* arg)
                                 extractAll ? "extract all" : "single extract");
 
                             /* start extracting */
-                            if (!extract_file(extract, blockBuffer, fileForExtract.num, fileForExtract.fileSize, freeDiskSpace))
+                            if (!extract_file(extract, fileForExtract.num, fileForExtract.fileSize, freeDiskSpace))
                             {
                                 ml_log_error("Failed to extract file from tape\n");
                                 printf("Failed to extract file from tape\n");
@@ -1396,7 +1871,7 @@ static void* extract_thread(void* arg)
                 {
                     if (diffTime > 1000000) /* poll status every second */
                     {
-                        status = probe_tape_status(extract->tapeDevice);
+                        status = probe_tape_status(extract);
 
                         if (status != LTO_ONLINE_STATUS)
                         {
@@ -1437,6 +1912,7 @@ breakout:
 int qce_create_lto_extract(const char* cacheDirectory, const char* tapeDevice, QCLTOExtract** extract)
 {
     QCLTOExtract* newExtract = NULL;
+    struct stat statBuf;
 
     CALLOC_ORET(newExtract, QCLTOExtract, 1);
 
@@ -1446,8 +1922,17 @@ int qce_create_lto_extract(const char* cacheDirectory, const char* tapeDevice, Q
     CALLOC_OFAIL(newExtract->tapeDevice, char, strlen(tapeDevice) + 1);
     strcpy(newExtract->tapeDevice, tapeDevice);
 
+    if (stat(tapeDevice, &statBuf) == 0 && S_ISREG(statBuf.st_mode))
+    {
+        ml_log_info("Using tar file '%s' in place of a tape device\n", tapeDevice);
+        newExtract->isTapeFile = 1;
+    }
+
     CHK_OFAIL(init_mutex(&newExtract->stateMutex));
     CHK_OFAIL(init_mutex(&newExtract->indexFileMutex));
+    CHK_OFAIL(init_mutex(&newExtract->tapeBuffer.mutex));
+    CHK_OFAIL(init_cond_var(&newExtract->tapeBuffer.blockReadCond));
+    CHK_OFAIL(init_cond_var(&newExtract->tapeBuffer.blockWrittenCond));
 
     CHK_OFAIL(create_joinable_thread(&newExtract->extractThreadId, extract_thread, newExtract));
 
@@ -1479,8 +1964,13 @@ void qce_free_lto_extract(QCLTOExtract** extract)
     SAFE_FREE(&(*extract)->currentPlayLTONumber);
     SAFE_FREE(&(*extract)->currentPlayName);
 
+    SAFE_FREE(&(*extract)->tapeBuffer.data);
+
     destroy_mutex(&(*extract)->stateMutex);
     destroy_mutex(&(*extract)->indexFileMutex);
+    destroy_mutex(&(*extract)->tapeBuffer.mutex);
+    destroy_cond_var(&(*extract)->tapeBuffer.blockReadCond);
+    destroy_cond_var(&(*extract)->tapeBuffer.blockWrittenCond);
 
     SAFE_FREE(extract);
 }
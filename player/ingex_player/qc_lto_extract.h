@@ -24,6 +24,7 @@
 #ifndef __QC_LTO_EXTRACT_H__
 #define __QC_LTO_EXTRACT_H__
 
+#include <inttypes.h>
 
 typedef enum
 {
@@ -57,6 +58,13 @@ typedef struct
     char currentExtractingFile[32];
     int extractAll;
     int updated;
+
+    /* tape read for the file being extracted */
+    int64_t tapeBytesRead;
+    float tapeReadRate;     /* MB/s */
+    int tapeBufferFill;     /* percentage of the tape buffer waiting to be written to disk */
+    int tapeStallCount;     /* number of times the tape read waited for the disk */
+    float tapeStallTime;    /* seconds */
 } QCLTOExtractState;
 
 typedef struct QCLTOExtract QCLTOExtract;
@@ -0,0 +1,1008 @@
+/*
+ * $Id$
+ *
+ * Plays a sequence of clips back to back
+ *
+ * Copyright (C) 2012 British Broadcasting Corporation, All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+    The sequence source reads the entries of an edit list one after the other. The source for the next
+    entry is opened and positioned at the in point by a background thread whilst the current entry is
+    being played, so that the switch at the frame boundary is just a pointer swap. Sources that are no
+    longer needed are also closed by the background thread.
+
+    The source of the previous entry is kept open so that stepping back and forth across an edit point
+    does not require the files to be re-opened.
+*/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sequence_source.h"
+#include "utils.h"
+#include "logging.h"
+#include "macros.h"
+
+
+#define MAX_CLOSE_SOURCES       4
+
+
+typedef struct
+{
+    int64_t start;
+    int64_t duration;
+    int64_t seqStart;   /* start position in the sequence */
+    int postCompleted;
+} SeqEntry;
+
+typedef struct
+{
+    int index;
+    MediaSource* source;
+} OpenEntry;
+
+struct SequenceSource
+{
+    SeqEntry* entries;
+    int numEntries;
+    int64_t length;
+    Rational frameRate;
+    int haveSetFrameRate;
+
+    SequenceEntryOpener opener;
+
+    MediaSource mediaSource;
+
+    /* stream info from the first entry */
+    StreamInfo* streamInfo;
+    int numStreams;
+
+    /* settings applied to every entry source */
+    int* disabledStreams;
+    int disableAudio;
+    int disableVideo;
+    char* sourceName;
+    char* clipId;
+
+    /* post complete arguments */
+    MediaSource* rootSource;
+    MediaControl* mediaControl;
+
+    /* read state */
+    int64_t position;
+    OpenEntry current;
+    OpenEntry previous;
+
+    /* prefetch thread state */
+    pthread_t prefetchThreadId;
+    pthread_mutex_t prefetchMutex;
+    pthread_cond_t prefetchCond;
+    int stopped;
+    int requestIndex;
+    int openingIndex;
+    OpenEntry ready;
+    MediaSource* closeSources[MAX_CLOSE_SOURCES];
+    int numCloseSources;
+};
+
+
+
+static int find_entry(SequenceSource* seq, int64_t position)
+{
+    int first = 0;
+    int last = seq->numEntries - 1;
+    int middle;
+
+    if (seq->current.index >= 0 &&
+        position >= seq->entries[seq->current.index].seqStart &&
+        position < seq->entries[seq->current.index].seqStart + seq->entries[seq->current.index].duration)
+    {
+        return seq->current.index;
+    }
+
+    while (first < last)
+    {
+        middle = (first + last + 1) / 2;
+        if (seq->entries[middle].seqStart <= position)
+        {
+            first = middle;
+        }
+        else
+        {
+            last = middle - 1;
+        }
+    }
+
+    return first;
+}
+
+static void update_seq_starts(SequenceSource* seq)
+{
+    int i;
+
+    seq->length = 0;
+    for (i = 0; i < seq->numEntries; i++)
+    {
+        seq->entries[i].seqStart = seq->length;
+        seq->length += seq->entries[i].duration;
+    }
+}
+
+static int is_compatible_stream(const StreamInfo* streamInfo, const StreamInfo* entryStreamInfo)
+{
+    if (streamInfo->type != entryStreamInfo->type ||
+        streamInfo->format != entryStreamInfo->format)
+    {
+        return 0;
+    }
+
+    if (streamInfo->type == PICTURE_STREAM_TYPE)
+    {
+        return streamInfo->width == entryStreamInfo->width &&
+               streamInfo->height == entryStreamInfo->height;
+    }
+    else if (streamInfo->type == SOUND_STREAM_TYPE)
+    {
+        return memcmp(&streamInfo->samplingRate, &entryStreamInfo->samplingRate, sizeof(Rational)) == 0 &&
+               streamInfo->numChannels == entryStreamInfo->numChannels &&
+               streamInfo->bitsPerSample == entryStreamInfo->bitsPerSample;
+    }
+
+    return 1;
+}
+
+/* refresh the stream info copies after the settings have changed the first entry's stream info */
+static int refresh_stream_info(SequenceSource* seq)
+{
+    const StreamInfo* entryStreamInfo;
+    int sourceId;
+    int i;
+
+    for (i = 0; i < seq->numStreams; i++)
+    {
+        CHK_ORET(msc_get_stream_info(seq->current.source, i, &entryStreamInfo));
+
+        sourceId = seq->streamInfo[i].sourceId;
+        clear_stream_info(&seq->streamInfo[i]);
+        CHK_ORET(duplicate_stream_info(entryStreamInfo, &seq->streamInfo[i]));
+        seq->streamInfo[i].sourceId = sourceId;
+    }
+
+    return 1;
+}
+
+/* called in the reader and the prefetch thread */
+static int open_entry_source(SequenceSource* seq, int index, MediaSource** source)
+{
+    MediaSource* entrySource = NULL;
+    const StreamInfo* entryStreamInfo;
+    int seekResult;
+    int i;
+
+    if (!seq->opener.open_entry(seq->opener.data, index, &entrySource))
+    {
+        ml_log_error("Failed to open sequence entry %d\n", index);
+        return 0;
+    }
+
+    if (msc_get_num_streams(entrySource) != seq->numStreams)
+    {
+        ml_log_error("Sequence entry %d has %d streams instead of %d\n", index,
+                     msc_get_num_streams(entrySource), seq->numStreams);
+        goto fail;
+    }
+    for (i = 0; i < seq->numStreams; i++)
+    {
+        if (!msc_get_stream_info(entrySource, i, &entryStreamInfo) ||
+            !is_compatible_stream(&seq->streamInfo[i], entryStreamInfo))
+        {
+            ml_log_error("Sequence entry %d stream %d is incompatible with the first entry\n", index, i);
+            goto fail;
+        }
+    }
+
+
+    /* apply the settings */
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+
+    if (seq->haveSetFrameRate)
+    {
+        msc_set_frame_rate_or_disable(entrySource, &seq->frameRate);
+    }
+    if (seq->disableAudio)
+    {
+        msc_disable_audio(entrySource);
+    }
+    if (seq->disableVideo)
+    {
+        msc_disable_video(entrySource);
+    }
+    for (i = 0; i < seq->numStreams; i++)
+    {
+        if (seq->disabledStreams[i])
+        {
+            msc_disable_stream(entrySource, i);
+        }
+    }
+    if (seq->sourceName != NULL)
+    {
+        msc_set_source_name(entrySource, seq->sourceName);
+    }
+    if (seq->clipId != NULL)
+    {
+        msc_set_clip_id(entrySource, seq->clipId);
+    }
+
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+
+
+    seekResult = msc_seek(entrySource, seq->entries[index].start);
+    if (seekResult != 0)
+    {
+        ml_log_error("Failed to seek to the start of sequence entry %d\n", index);
+        goto fail;
+    }
+
+    *source = entrySource;
+    return 1;
+
+fail:
+    msc_close(entrySource);
+    return 0;
+}
+
+/* the prefetchMutex must be locked */
+static void queue_close_source(SequenceSource* seq, MediaSource* source)
+{
+    if (source == NULL)
+    {
+        return;
+    }
+
+    if (seq->numCloseSources < MAX_CLOSE_SOURCES)
+    {
+        seq->closeSources[seq->numCloseSources] = source;
+        seq->numCloseSources++;
+        pthread_cond_broadcast(&seq->prefetchCond);
+    }
+    else
+    {
+        msc_close(source);
+    }
+}
+
+static void* prefetch_thread(void* arg)
+{
+    SequenceSource* seq = (SequenceSource*)arg;
+    MediaSource* source;
+    int index;
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+
+    while (!seq->stopped)
+    {
+        if (seq->numCloseSources > 0)
+        {
+            seq->numCloseSources--;
+            source = seq->closeSources[seq->numCloseSources];
+
+            PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+            msc_close(source);
+            PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+        }
+        else if (seq->requestIndex >= 0)
+        {
+            index = seq->requestIndex;
+            seq->requestIndex = -1;
+            seq->openingIndex = index;
+
+            PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+            source = NULL;
+            if (!open_entry_source(seq, index, &source))
+            {
+                ml_log_warn("Failed to prefetch sequence entry %d\n", index);
+            }
+            PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+
+            seq->openingIndex = -1;
+            if (source != NULL)
+            {
+                queue_close_source(seq, seq->ready.source);
+                seq->ready.index = index;
+                seq->ready.source = source;
+            }
+            pthread_cond_broadcast(&seq->prefetchCond);
+        }
+        else
+        {
+            if (pthread_cond_wait(&seq->prefetchCond, &seq->prefetchMutex) != 0)
+            {
+                ml_log_error("Sequence prefetch thread failed to wait for condition\n");
+            }
+        }
+    }
+
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+
+    pthread_exit((void*) 0);
+}
+
+/* the prefetchMutex must be locked */
+static void wait_prefetch_idle(SequenceSource* seq)
+{
+    seq->requestIndex = -1;
+    while (seq->openingIndex >= 0)
+    {
+        if (pthread_cond_wait(&seq->prefetchCond, &seq->prefetchMutex) != 0)
+        {
+            ml_log_error("Sequence source failed to wait for condition\n");
+            break;
+        }
+    }
+}
+
+/* sources opened with the previous settings are closed and will be re-opened when needed */
+static void discard_prefetched(SequenceSource* seq)
+{
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+
+    wait_prefetch_idle(seq);
+
+    queue_close_source(seq, seq->ready.source);
+    seq->ready.source = NULL;
+    seq->ready.index = -1;
+    queue_close_source(seq, seq->previous.source);
+    seq->previous.source = NULL;
+    seq->previous.index = -1;
+
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+}
+
+static void request_prefetch(SequenceSource* seq, int index)
+{
+    if (index >= seq->numEntries ||
+        index == seq->current.index ||
+        index == seq->previous.index)
+    {
+        return;
+    }
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+
+    if (seq->ready.index != index && seq->openingIndex != index)
+    {
+        queue_close_source(seq, seq->ready.source);
+        seq->ready.source = NULL;
+        seq->ready.index = -1;
+
+        seq->requestIndex = index;
+        pthread_cond_broadcast(&seq->prefetchCond);
+    }
+
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+}
+
+static int post_complete_current(SequenceSource* seq)
+{
+    SeqEntry* entry = &seq->entries[seq->current.index];
+
+    if (entry->postCompleted || seq->rootSource == NULL)
+    {
+        return entry->postCompleted;
+    }
+
+    if (msc_is_complete(seq->current.source))
+    {
+        entry->postCompleted = msc_post_complete(seq->current.source, seq->rootSource, seq->mediaControl);
+    }
+
+    return entry->postCompleted;
+}
+
+/* make the entry current, positioned at offset from the entry start */
+static int switch_entry(SequenceSource* seq, int index, int64_t offset)
+{
+    MediaSource* source = NULL;
+    int atStart = 0;
+    int result;
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+
+    if (seq->requestIndex == index)
+    {
+        seq->requestIndex = -1;
+    }
+    while (seq->openingIndex == index)
+    {
+        if (pthread_cond_wait(&seq->prefetchCond, &seq->prefetchMutex) != 0)
+        {
+            ml_log_error("Sequence source failed to wait for condition\n");
+            break;
+        }
+    }
+    if (seq->ready.index == index && seq->ready.source != NULL)
+    {
+        source = seq->ready.source;
+        seq->ready.source = NULL;
+        seq->ready.index = -1;
+        atStart = 1;
+    }
+
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+
+    if (source == NULL && seq->previous.index == index)
+    {
+        source = seq->previous.source;
+        seq->previous.source = NULL;
+        seq->previous.index = -1;
+    }
+    if (source == NULL)
+    {
+        ml_log_info("Sequence entry %d was not prefetched\n", index);
+        CHK_ORET(open_entry_source(seq, index, &source));
+        atStart = 1;
+    }
+
+    if (!atStart || offset != 0)
+    {
+        result = msc_seek(source, seq->entries[index].start + offset);
+        if (result != 0)
+        {
+            PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+            queue_close_source(seq, source);
+            PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+            return 0;
+        }
+    }
+
+
+    /* the current source becomes the previous one and the old previous source is closed */
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+    queue_close_source(seq, seq->previous.source);
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+    seq->previous = seq->current;
+
+    seq->current.index = index;
+    seq->current.source = source;
+
+    post_complete_current(seq);
+
+    request_prefetch(seq, index + 1);
+
+    return 1;
+}
+
+static void stop_prefetch_thread(void* data)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+    seq->stopped = 1;
+    pthread_cond_broadcast(&seq->prefetchCond);
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+}
+
+
+
+static int sqs_is_complete(void* data)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    return msc_is_complete(seq->current.source);
+}
+
+static int sqs_post_complete(void* data, MediaSource* rootSource, MediaControl* mediaControl)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    /* the entries are post completed when they become current */
+    seq->rootSource = rootSource;
+    seq->mediaControl = mediaControl;
+
+    return post_complete_current(seq);
+}
+
+static int sqs_finalise_blank_source(void* data, const StreamInfo* streamInfo)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    return msc_finalise_blank_source(seq->current.source, streamInfo);
+}
+
+static int sqs_get_num_streams(void* data)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    return seq->numStreams;
+}
+
+static int sqs_get_stream_info(void* data, int streamIndex, const StreamInfo** streamInfo)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    if (streamIndex < 0 || streamIndex >= seq->numStreams)
+    {
+        return 0;
+    }
+
+    *streamInfo = &seq->streamInfo[streamIndex];
+    return 1;
+}
+
+static void sqs_set_frame_rate_or_disable(void* data, const Rational* frameRate)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+    int i;
+
+    discard_prefetched(seq);
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+
+    msc_set_frame_rate_or_disable(seq->current.source, frameRate);
+
+    for (i = 0; i < seq->numEntries; i++)
+    {
+        seq->entries[i].start = convert_length(seq->entries[i].start, &seq->frameRate, frameRate);
+        seq->entries[i].duration = convert_length(seq->entries[i].duration, &seq->frameRate, frameRate);
+    }
+    seq->position = convert_length(seq->position, &seq->frameRate, frameRate);
+    seq->frameRate = *frameRate;
+    seq->haveSetFrameRate = 1;
+    update_seq_starts(seq);
+
+    refresh_stream_info(seq);
+
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+
+    request_prefetch(seq, seq->current.index + 1);
+}
+
+static int sqs_disable_stream(void* data, int streamIndex)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+    int result;
+
+    if (streamIndex < 0 || streamIndex >= seq->numStreams)
+    {
+        return 0;
+    }
+
+    discard_prefetched(seq);
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+    result = msc_disable_stream(seq->current.source, streamIndex);
+    if (result)
+    {
+        seq->disabledStreams[streamIndex] = 1;
+    }
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+
+    request_prefetch(seq, seq->current.index + 1);
+
+    return result;
+}
+
+static void sqs_disable_audio(void* data)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    discard_prefetched(seq);
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+    msc_disable_audio(seq->current.source);
+    seq->disableAudio = 1;
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+
+    request_prefetch(seq, seq->current.index + 1);
+}
+
+static void sqs_disable_video(void* data)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    discard_prefetched(seq);
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+    msc_disable_video(seq->current.source);
+    seq->disableVideo = 1;
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+
+    request_prefetch(seq, seq->current.index + 1);
+}
+
+static int sqs_stream_is_disabled(void* data, int streamIndex)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    return msc_stream_is_disabled(seq->current.source, streamIndex);
+}
+
+static int sqs_read_frame(void* data, const FrameInfo* frameInfo, MediaSourceListener* listener)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+    int index;
+    int result;
+
+    if (seq->position >= seq->length)
+    {
+        return -1;
+    }
+
+    /* switch to the next entry at the frame boundary */
+    index = find_entry(seq, seq->position);
+    if (index != seq->current.index)
+    {
+        if (!switch_entry(seq, index, seq->position - seq->entries[index].seqStart))
+        {
+            ml_log_error("Failed to switch to sequence entry %d\n", index);
+            return -1;
+        }
+    }
+    else if (!seq->entries[index].postCompleted)
+    {
+        post_complete_current(seq);
+    }
+
+    result = msc_read_frame(seq->current.source, frameInfo, listener);
+    if (result == 0)
+    {
+        seq->position++;
+    }
+
+    return result;
+}
+
+static int sqs_is_seekable(void* data)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    return msc_is_seekable(seq->current.source);
+}
+
+static int sqs_seek(void* data, int64_t position)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+    int index;
+    int result;
+
+    if (position < 0 || position > seq->length)
+    {
+        return -1;
+    }
+    if (position == seq->length)
+    {
+        /* end of the sequence */
+        seq->position = position;
+        return 0;
+    }
+
+    index = find_entry(seq, position);
+    if (index == seq->current.index)
+    {
+        result = msc_seek(seq->current.source, seq->entries[index].start + position - seq->entries[index].seqStart);
+        if (result != 0)
+        {
+            return result;
+        }
+    }
+    else
+    {
+        if (!switch_entry(seq, index, position - seq->entries[index].seqStart))
+        {
+            return -1;
+        }
+    }
+
+    seq->position = position;
+    return 0;
+}
+
+static int sqs_seek_timecode(void* data, const Timecode* timecode, TimecodeType type, TimecodeSubType subType)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+    SeqEntry* entry = &seq->entries[seq->current.index];
+    int64_t originalPosition;
+    int64_t position;
+    int result;
+
+    /* only timecodes within the current entry are found */
+
+    if (!msc_get_position(seq->current.source, &originalPosition))
+    {
+        originalPosition = -1; /* unknown */
+    }
+
+    result = msc_seek_timecode(seq->current.source, timecode, type, subType);
+    if (result != 0)
+    {
+        return result;
+    }
+
+    /* check the seek is within the entry boundaries */
+
+    if (!msc_get_position(seq->current.source, &position) ||
+        position < entry->start || position >= entry->start + entry->duration)
+    {
+        /* outside - go back to original position */
+        if (originalPosition >= 0)
+        {
+            msc_seek(seq->current.source, originalPosition);
+        }
+
+        return -1;
+    }
+
+    seq->position = entry->seqStart + position - entry->start;
+    return 0;
+}
+
+static int sqs_get_length(void* data, int64_t* length)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    *length = seq->length;
+    return 1;
+}
+
+static int sqs_get_position(void* data, int64_t* position)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    *position = seq->position;
+    return 1;
+}
+
+static int sqs_get_available_length(void* data, int64_t* length)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    *length = seq->length;
+    return 1;
+}
+
+static int sqs_eof(void* data)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    return seq->position >= seq->length;
+}
+
+static void sqs_set_source_name(void* data, const char* name)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    discard_prefetched(seq);
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+    msc_set_source_name(seq->current.source, name);
+    SAFE_FREE(&seq->sourceName);
+    seq->sourceName = strdup(name);
+    refresh_stream_info(seq);
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+
+    request_prefetch(seq, seq->current.index + 1);
+}
+
+static void sqs_set_clip_id(void* data, const char* id)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    discard_prefetched(seq);
+
+    PTHREAD_MUTEX_LOCK(&seq->prefetchMutex)
+    msc_set_clip_id(seq->current.source, id);
+    SAFE_FREE(&seq->clipId);
+    if (id != NULL)
+    {
+        seq->clipId = strdup(id);
+    }
+    refresh_stream_info(seq);
+    PTHREAD_MUTEX_UNLOCK(&seq->prefetchMutex)
+
+    request_prefetch(seq, seq->current.index + 1);
+}
+
+static void sqs_close(void* data)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+    int i;
+
+    if (data == NULL)
+    {
+        return;
+    }
+
+    join_thread(&seq->prefetchThreadId, seq, stop_prefetch_thread);
+
+    for (i = 0; i < seq->numCloseSources; i++)
+    {
+        msc_close(seq->closeSources[i]);
+    }
+    msc_close(seq->ready.source);
+    msc_close(seq->previous.source);
+    msc_close(seq->current.source);
+
+    for (i = 0; i < seq->numStreams; i++)
+    {
+        clear_stream_info(&seq->streamInfo[i]);
+    }
+    SAFE_FREE(&seq->streamInfo);
+    SAFE_FREE(&seq->disabledStreams);
+    SAFE_FREE(&seq->sourceName);
+    SAFE_FREE(&seq->clipId);
+    SAFE_FREE(&seq->entries);
+
+    destroy_cond_var(&seq->prefetchCond);
+    destroy_mutex(&seq->prefetchMutex);
+
+    SAFE_FREE(&seq);
+}
+
+static int sqs_get_buffer_state(void* data, int* numBuffers, int* numBuffersFilled)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+
+    return msc_get_buffer_state(seq->current.source, numBuffers, numBuffersFilled);
+}
+
+static int64_t sqs_convert_position(void* data, int64_t position, MediaSource* childSource)
+{
+    SequenceSource* seq = (SequenceSource*)data;
+    SeqEntry* entry = &seq->entries[seq->current.index];
+    int64_t childPosition;
+
+    if (childSource == &seq->mediaSource)
+    {
+        return position;
+    }
+
+    /* the child is a source of the current entry, which is also the case when the entry is post completed */
+    childPosition = msc_convert_position(seq->current.source, position, childSource);
+
+    return entry->seqStart + childPosition - entry->start;
+}
+
+
+int sqs_create(const SequenceEntry* entries, int numEntries, const Rational* frameRate,
+               const SequenceEntryOpener* opener, SequenceSource** seqSource)
+{
+    SequenceSource* newSeq;
+    const StreamInfo* entryStreamInfo;
+    int i;
+
+    if (numEntries < 1)
+    {
+        ml_log_error("Sequence has no entries\n");
+        return 0;
+    }
+    for (i = 0; i < numEntries; i++)
+    {
+        if (entries[i].start < 0 || entries[i].duration < 1)
+        {
+            ml_log_error("Invalid sequence entry %d in/out points\n", i);
+            return 0;
+        }
+    }
+
+    CALLOC_ORET(newSeq, SequenceSource, 1);
+
+    newSeq->opener = *opener;
+    newSeq->current.index = -1;
+    newSeq->previous.index = -1;
+    newSeq->ready.index = -1;
+    newSeq->requestIndex = -1;
+    newSeq->openingIndex = -1;
+
+    CHK_OFAIL(init_mutex(&newSeq->prefetchMutex));
+    CHK_OFAIL(init_cond_var(&newSeq->prefetchCond));
+
+    CALLOC_OFAIL(newSeq->entries, SeqEntry, numEntries);
+    newSeq->numEntries = numEntries;
+    for (i = 0; i < numEntries; i++)
+    {
+        newSeq->entries[i].start = entries[i].start;
+        newSeq->entries[i].duration = entries[i].duration;
+    }
+    update_seq_starts(newSeq);
+
+
+    /* the first entry is opened here to provide the stream info */
+
+    if (!opener->open_entry(opener->data, 0, &newSeq->current.source))
+    {
+        ml_log_error("Failed to open first sequence entry\n");
+        goto fail;
+    }
+    newSeq->current.index = 0;
+
+    newSeq->numStreams = msc_get_num_streams(newSeq->current.source);
+    if (newSeq->numStreams > 0)
+    {
+        CALLOC_OFAIL(newSeq->streamInfo, StreamInfo, newSeq->numStreams);
+        CALLOC_OFAIL(newSeq->disabledStreams, int, newSeq->numStreams);
+    }
+    for (i = 0; i < newSeq->numStreams; i++)
+    {
+        CHK_OFAIL(msc_get_stream_info(newSeq->current.source, i, &entryStreamInfo));
+        CHK_OFAIL(duplicate_stream_info(entryStreamInfo, &newSeq->streamInfo[i]));
+    }
+
+    if (frameRate != NULL && frameRate->num > 0 && frameRate->den > 0)
+    {
+        newSeq->frameRate = *frameRate;
+    }
+    else if (newSeq->numStreams > 0)
+    {
+        newSeq->frameRate = newSeq->streamInfo[0].frameRate;
+    }
+
+    if (msc_seek(newSeq->current.source, newSeq->entries[0].start) != 0)
+    {
+        ml_log_error("Failed to seek to the start of the first sequence entry\n");
+        goto fail;
+    }
+
+
+    newSeq->mediaSource.data = newSeq;
+    newSeq->mediaSource.is_complete = sqs_is_complete;
+    newSeq->mediaSource.post_complete = sqs_post_complete;
+    newSeq->mediaSource.finalise_blank_source = sqs_finalise_blank_source;
+    newSeq->mediaSource.get_num_streams = sqs_get_num_streams;
+    newSeq->mediaSource.get_stream_info = sqs_get_stream_info;
+    newSeq->mediaSource.set_frame_rate_or_disable = sqs_set_frame_rate_or_disable;
+    newSeq->mediaSource.disable_stream = sqs_disable_stream;
+    newSeq->mediaSource.disable_audio = sqs_disable_audio;
+    newSeq->mediaSource.disable_video = sqs_disable_video;
+    newSeq->mediaSource.stream_is_disabled = sqs_stream_is_disabled;
+    newSeq->mediaSource.read_frame = sqs_read_frame;
+    newSeq->mediaSource.is_seekable = sqs_is_seekable;
+    newSeq->mediaSource.seek = sqs_seek;
+    newSeq->mediaSource.seek_timecode = sqs_seek_timecode;
+    newSeq->mediaSource.get_length = sqs_get_length;
+    newSeq->mediaSource.get_position = sqs_get_position;
+    newSeq->mediaSource.get_available_length = sqs_get_available_length;
+    newSeq->mediaSource.eof = sqs_eof;
+    newSeq->mediaSource.set_source_name = sqs_set_source_name;
+    newSeq->mediaSource.set_clip_id = sqs_set_clip_id;
+    newSeq->mediaSource.close = sqs_close;
+    newSeq->mediaSource.get_buffer_state = sqs_get_buffer_state;
+    newSeq->mediaSource.convert_position = sqs_convert_position;
+
+
+    CHK_OFAIL(create_joinable_thread(&newSeq->prefetchThreadId, prefetch_thread, newSeq));
+
+    request_prefetch(newSeq, 1);
+
+
+    *seqSource = newSeq;
+    return 1;
+
+fail:
+    sqs_close(newSeq);
+    return 0;
+}
+
+MediaSource* sqs_get_media_source(SequenceSource* seqSource)
+{
+    return &seqSource->mediaSource;
+}
+
@@ -0,0 +1,61 @@
+/*
+ * $Id$
+ *
+ * Plays a sequence of clips back to back
+ *
+ * Copyright (C) 2012 British Broadcasting Corporation, All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __SEQUENCE_SOURCE_H__
+#define __SEQUENCE_SOURCE_H__
+
+
+
+#include "media_source.h"
+
+
+/* sequence source */
+
+typedef struct SequenceSource SequenceSource;
+
+typedef struct
+{
+    int64_t start;      /* in point in the entry's source */
+    int64_t duration;   /* out - in point */
+} SequenceEntry;
+
+typedef struct
+{
+    void* data; /* passed to functions */
+
+    /* open the source for the entry, e.g. a multiple sources source containing the entry's files.
+       Entries are opened in a background thread ahead of the switch and the returned sources must have
+       the same streams as the first entry */
+    int (*open_entry)(void* data, int entryIndex, MediaSource** source);
+} SequenceEntryOpener;
+
+
+/* the entry positions are in frameRate units. A NULL or 0/0 frameRate means use the first entry's frame rate.
+   The opener data must remain valid until the sequence source is closed */
+int sqs_create(const SequenceEntry* entries, int numEntries, const Rational* frameRate,
+               const SequenceEntryOpener* opener, SequenceSource** seqSource);
+MediaSource* sqs_get_media_source(SequenceSource* seqSource);
+
+
+
+#endif
+
@@ -44,6 +44,26 @@ int udp_open(const char *address, MediaSource** source)
 
 #include "multicast_video.h"
 
+#if defined(HAVE_FFMPEG)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef FFMPEG_OLD_INCLUDE_PATHS
+#include <ffmpeg/avcodec.h>
+#include <ffmpeg/avformat.h>
+#else
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
 #define MAX_TRACKS      23
 
 
@@ -73,9 +93,114 @@ typedef struct
     int prevLastFrame;
 
     char sourceName[MULTICAST_SOURCE_NAME_SIZE];
+
+#if defined(HAVE_FFMPEG)
+    /* MJPEG slice decoder for compressed streams, used by the reader thread */
+    AVCodecContext* dec;
+    int openedDecoder;
+    AVFrame* decFrame;
+#endif
 } UDPSource;
 
 
+#if defined(HAVE_FFMPEG)
+
+static int open_slice_decoder(UDPSource* source)
+{
+    AVCodec* avDecoder;
+
+    av_register_all();
+
+    avDecoder = avcodec_find_decoder(CODEC_ID_MJPEG);
+    if (!avDecoder)
+    {
+        ml_log_error("Could not find the MJPEG decoder\n");
+        return 0;
+    }
+
+    source->dec = avcodec_alloc_context();
+    if (!source->dec)
+    {
+        ml_log_error("Could not allocate MJPEG decoder context\n");
+        return 0;
+    }
+
+    if (avcodec_open(source->dec, avDecoder) < 0)
+    {
+        ml_log_error("Could not open decoder\n");
+        return 0;
+    }
+    source->openedDecoder = 1;
+
+    source->decFrame = avcodec_alloc_frame();
+    if (!source->decFrame)
+    {
+        ml_log_error("Could not allocate decoded frame\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+static void close_slice_decoder(UDPSource* source)
+{
+    if (source->openedDecoder)
+    {
+        avcodec_close(source->dec);
+    }
+    SAFE_FREE(&source->dec);
+    SAFE_FREE(&source->decFrame);
+}
+
+/* called by the reader thread as soon as all the packets of a slice have arrived */
+static int udp_decode_slice(void* data, int width, int height, int firstLine, int numLines,
+    const uint8_t* slice, int sliceSize, uint8_t* video)
+{
+    UDPSource* source = (UDPSource*)data;
+    int got_picture;
+    int result;
+    int i;
+
+#if LIBAVCODEC_VERSION_MAJOR < 53
+    result = avcodec_decode_video(source->dec, source->decFrame, &got_picture, (uint8_t*)slice, sliceSize);
+#else
+    AVPacket packet;
+    av_init_packet(&packet);
+    packet.data = (uint8_t*)slice;
+    packet.size = sliceSize;
+    result = avcodec_decode_video2(source->dec, source->decFrame, &got_picture, &packet);
+#endif
+    if (result < 0 || !got_picture)
+    {
+        return 0;
+    }
+    if (source->dec->width != width || source->dec->height < numLines ||
+        (source->dec->pix_fmt != PIX_FMT_YUVJ420P && source->dec->pix_fmt != PIX_FMT_YUV420P))
+    {
+        ml_log_error("Unexpected MJPEG slice format %dx%d\n", source->dec->width, source->dec->height);
+        return 0;
+    }
+
+    /* copy the slice lines into the 4:2:0 frame */
+    for (i = 0; i < numLines; i++)
+    {
+        memcpy(video + (firstLine + i) * width,
+               source->decFrame->data[0] + i * source->decFrame->linesize[0], width);
+    }
+    for (i = 0; i < numLines / 2; i++)
+    {
+        memcpy(video + width * height + (firstLine / 2 + i) * (width / 2),
+               source->decFrame->data[1] + i * source->decFrame->linesize[1], width / 2);
+        memcpy(video + width * height * 5 / 4 + (firstLine / 2 + i) * (width / 2),
+               source->decFrame->data[2] + i * source->decFrame->linesize[2], width / 2);
+    }
+
+    return 1;
+}
+
+#endif
+
+
 static int udp_get_num_streams(void* data)
 {
     UDPSource* source = (UDPSource*)data;
@@ -380,6 +505,10 @@ static void udp_close(void* data)
     udp_shutdown_reader(&source->udp_reader);
 #endif
 
+#if defined(HAVE_FFMPEG)
+    close_slice_decoder(source);
+#endif
+
     for (i = 0; i < source->numTracks; i++)
     {
         clear_stream_info(&source->tracks[i].streamInfo);
@@ -402,6 +531,7 @@ int udp_open(const char *address, MediaSource** source)
 {
     UDPSource* newSource = NULL;
     int sourceId;
+    int compressed;
 
     // Extract address and port number from string e.g. "239.255.1.1:2000"
     char remote[FILENAME_MAX];
@@ -453,12 +583,20 @@ int udp_open(const char *address, MediaSource** source)
 
     // Read video parameters from multicast stream
     IngexNetworkHeader header;
-    if (udp_read_frame_header(fd, &header) == -1)
+    if (udp_read_stream_header(fd, &header, &compressed) == -1)
     {
         ml_log_error("Failed to read from UDP address %s:%d\n", remote, port);
         return 0;
     }
 
+#if !defined(HAVE_FFMPEG) || defined(MULTICAST_SINGLE_THREAD)
+    if (compressed)
+    {
+        ml_log_error("Compressed UDP stream from %s:%d not supported by this build\n", remote, port);
+        return 0;
+    }
+#endif
+
     /* TODO: handle varying NTSC audio frame sizes */
     if (header.framerate_numer != 25 && header.framerate_denom != 1)
     {
@@ -475,7 +613,23 @@ int udp_open(const char *address, MediaSource** source)
 
 #ifndef MULTICAST_SINGLE_THREAD
     newSource->udp_reader.fd = fd;
-    udp_init_reader(header.width, header.height, &newSource->udp_reader);
+#if defined(HAVE_FFMPEG)
+    if (compressed)
+    {
+        if (!open_slice_decoder(newSource))
+        {
+            /* reader thread not started yet so cannot use udp_close() */
+            close_slice_decoder(newSource);
+            SAFE_FREE(&newSource);
+            return 0;
+        }
+        udp_init_compressed_reader(header.width, header.height, udp_decode_slice, newSource, &newSource->udp_reader);
+    }
+    else
+#endif
+    {
+        udp_init_reader(header.width, header.height, &newSource->udp_reader);
+    }
 #endif
 
     newSource->prevLastFrame = -1;
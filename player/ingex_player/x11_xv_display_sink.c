@@ -73,6 +73,9 @@
 
 #define MAX_TIMECODES               64
 
+/* number of displayed frames over which the stage timings are averaged */
+#define TIMING_REPORT_FRAMES        250
+
 
 typedef struct
 {
@@ -99,6 +102,16 @@ typedef struct
     FrameInfo frameInfo;
 } X11DisplayFrame;
 
+/* time spent in each stage of display_frame, summed over numFrames frames */
+typedef struct
+{
+    long convertUsec;
+    long scaleUsec;
+    long osdUsec;
+    long putUsec;
+    int numFrames;
+} StageTimings;
+
 struct X11XVDisplaySink
 {
     /* common X11 structure */
@@ -124,6 +137,7 @@ struct X11XVDisplaySink
 
     /* image characteristics */
     int32_t frameFormat;
+    int planarOutput;
     StreamFormat inputVideoFormat;
     StreamFormat outputVideoFormat;
     formats outputYUVFormat;
@@ -150,6 +164,8 @@ struct X11XVDisplaySink
 
     /* set if sink was reset */
     int haveReset;
+
+    StageTimings timings;
 };
 
 
@@ -332,6 +348,108 @@ static void XVideoReleasePort( Display *p_display, int i_port )
     XSync(p_display, False); //required when X is tunnelling through SSH, or immediately calling XvGrabPort() will return XvAlreadyGrabbed
 }
 
+/* returns 1 if an XVideo image adaptor lists the format, without logging an error if none does */
+static int xv_format_is_listed(Display* display, int32_t format)
+{
+    XvAdaptorInfo* adaptors;
+    XvImageFormatValues* formats;
+    unsigned int numAdaptors;
+    unsigned int i;
+    int numFormats;
+    int j;
+    int found = 0;
+
+    if (XvQueryExtension(display, &i, &i, &i, &i, &i) != Success ||
+        XvQueryAdaptors(display, DefaultRootWindow(display), &numAdaptors, &adaptors) != Success)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < numAdaptors && !found; i++)
+    {
+        if (!(adaptors[i].type & XvInputMask) || !(adaptors[i].type & XvImageMask))
+        {
+            continue;
+        }
+
+        formats = XvListImageFormats(display, adaptors[i].base_id, &numFormats);
+        for (j = 0; j < numFormats; j++)
+        {
+            if (formats[j].id == format && formats[j].format == XvPlanar)
+            {
+                found = 1;
+                break;
+            }
+        }
+        if (formats != NULL)
+        {
+            XFree(formats);
+        }
+    }
+
+    if (numAdaptors > 0)
+    {
+        XvFreeAdaptorInfo(adaptors);
+    }
+
+    return found;
+}
+
+/* returns 1 if images created on the port have the contiguous Y, U, V plane layout used by YUV422_FORMAT */
+static int xv_planar_422_layout_matches(Display* display, int port, int width, int height)
+{
+    XvImage* image;
+    int matches;
+
+    image = XvCreateImage(display, port, X11_FOURCC('Y','4','2','B'), NULL, width, height);
+    if (image == NULL)
+    {
+        return 0;
+    }
+
+    matches = (image->num_planes == 3 &&
+               image->data_size == width * height * 2 &&
+               image->pitches[0] == width && image->pitches[1] == width / 2 && image->pitches[2] == width / 2 &&
+               image->offsets[0] == 0 && image->offsets[1] == width * height &&
+               image->offsets[2] == width * height * 3 / 2);
+
+    XFree(image);
+
+    return matches;
+}
+
+static long stage_usec(struct timeval* stageStart)
+{
+    struct timeval now;
+    long usec;
+
+    gettimeofday(&now, NULL);
+    usec = (now.tv_sec - stageStart->tv_sec) * 1000000 + now.tv_usec - stageStart->tv_usec;
+    *stageStart = now;
+
+    return usec;
+}
+
+static void report_timings(X11XVDisplaySink* sink)
+{
+    StageTimings* timings = &sink->timings;
+
+    timings->numFrames++;
+    if (timings->numFrames < TIMING_REPORT_FRAMES)
+    {
+        return;
+    }
+
+    ml_log_debug("XV display mean stage times over %d frames (ms): convert %.2f, scale %.2f, osd %.2f, put %.2f\n",
+                 timings->numFrames,
+                 timings->convertUsec / (1000.0 * timings->numFrames),
+                 timings->scaleUsec / (1000.0 * timings->numFrames),
+                 timings->osdUsec / (1000.0 * timings->numFrames),
+                 timings->putUsec / (1000.0 * timings->numFrames));
+
+    memset(timings, 0, sizeof(*timings));
+}
+
 static void reset_streams(X11DisplayFrame* frame)
 {
     frame->videoIsPresent = 0;
@@ -363,7 +481,7 @@ static int init_display(X11XVDisplaySink* sink, const StreamInfo* streamInfo)
     }
     else /* streamInfo->format == UYVY_10BIT_FORMAT or YUV422_FORMAT or YUV422_10BIT_FORMAT or YUV444_FORMAT */
     {
-        /* format is converted to UYVY */
+        /* format is converted to UYVY, unless it is planar 4:2:2 and XV accepts that (see below) */
         sink->outputYUVFormat = UYVY;
     }
 
@@ -435,6 +553,7 @@ static int init_display(X11XVDisplaySink* sink, const StreamInfo* streamInfo)
     }
 
     sink->inputVideoFormat = streamInfo->format;
+    sink->planarOutput = 0;
 
     if (streamInfo->format == UYVY_FORMAT ||
         streamInfo->format == UYVY_10BIT_FORMAT ||
@@ -454,10 +573,38 @@ static int init_display(X11XVDisplaySink* sink, const StreamInfo* streamInfo)
     }
 
 
+    XLockDisplay(sink->x11Common.windowInfo.display);
+
+    /* planar 4:2:2 is passed to XV without conversion to UYVY if a port accepts it in the same layout */
+    sink->xvport = -1;
+    if ((streamInfo->format == YUV422_FORMAT || streamInfo->format == YUV422_10BIT_FORMAT) &&
+        xv_format_is_listed(sink->x11Common.windowInfo.display, X11_FOURCC('Y','4','2','B')))
+    {
+        sink->xvport = XVideoGetPort(sink->x11Common.windowInfo.display, X11_FOURCC('Y','4','2','B'), -1);
+        if (sink->xvport >= 0)
+        {
+            if (xv_planar_422_layout_matches(sink->x11Common.windowInfo.display, sink->xvport,
+                                             sink->width, sink->height))
+            {
+                sink->frameFormat = X11_FOURCC('Y','4','2','B');
+                sink->outputVideoFormat = YUV422_FORMAT;
+                sink->outputYUVFormat = Y42B;
+                sink->planarOutput = 1;
+            }
+            else
+            {
+                XVideoReleasePort(sink->x11Common.windowInfo.display, sink->xvport);
+                sink->xvport = -1;
+            }
+        }
+    }
+
     /* Check that we have access to an XVideo port providing this chroma    */
     /* Commonly supported chromas: YV12, I420, YUY2, YUY2                   */
-    XLockDisplay(sink->x11Common.windowInfo.display);
-    sink->xvport = XVideoGetPort(sink->x11Common.windowInfo.display, sink->frameFormat, -1);
+    if (sink->xvport < 0)
+    {
+        sink->xvport = XVideoGetPort(sink->x11Common.windowInfo.display, sink->frameFormat, -1);
+    }
     XUnlockDisplay(sink->x11Common.windowInfo.display);
     if (sink->xvport < 0)
     {
@@ -493,6 +640,8 @@ static int display_frame(X11XVDisplaySink* sink, X11DisplayFrame* frame, const F
     YUV_frame inputFrame;
     YUV_frame outputFrame;
     unsigned char* activeBuffer;
+    formats scaleInputFormat;
+    struct timeval stageStart;
     int frameDurationMsec;
     int frameSlippage;
 
@@ -502,7 +651,12 @@ static int display_frame(X11XVDisplaySink* sink, X11DisplayFrame* frame, const F
 
     if (frame->videoIsPresent)
     {
-        /* convert if required */
+        gettimeofday(&stageStart, NULL);
+
+        /* convert if required. Planar 4:2:2 input that is scaled is read directly by small_pic, which
+           does the conversion to UYVY as part of the same pass */
+        activeBuffer = frame->inputBuffer;
+        scaleInputFormat = sink->outputYUVFormat;
         if (sink->inputVideoFormat == UYVY_10BIT_FORMAT)
         {
             if (sink->swScale != 1)
@@ -538,33 +692,40 @@ static int display_frame(X11XVDisplaySink* sink, X11DisplayFrame* frame, const F
         {
             if (sink->swScale != 1)
             {
-                /* scale required afterwards */
-                activeBuffer = frame->scaleInputBuffer;
+                /* scaled straight from the input */
+                activeBuffer = frame->inputBuffer;
+                scaleInputFormat = Y42B;
             }
-            else
+            else if (!sink->planarOutput)
             {
-                /* no scale afterwards */
-                activeBuffer = (unsigned char*)frame->yuv_image->data;
+                yuv422_to_uyvy_2(sink->inputWidth, sink->inputHeight, 0, frame->inputBuffer,
+                                 (unsigned char*)frame->yuv_image->data);
             }
-
-            yuv422_to_uyvy_2(sink->inputWidth, sink->inputHeight, 0, frame->inputBuffer, activeBuffer);
+            /* else frame->inputBuffer is frame->yuv_image->data */
         }
         else if (sink->inputVideoFormat == YUV422_10BIT_FORMAT)
         {
             if (sink->swScale != 1)
             {
-                /* scale required afterwards */
-                activeBuffer = frame->scaleInputBuffer;
+                /* dither and then scale from the 8-bit planar picture */
+                ConvertFrameYUV10to8_2(frame->ditherOutputBuffer, (const uint16_t*)frame->inputBuffer, sink->inputWidth,
+                                       sink->inputHeight, 2, 1);
+                activeBuffer = frame->ditherOutputBuffer;
+                scaleInputFormat = Y42B;
+            }
+            else if (sink->planarOutput)
+            {
+                /* dither straight into the output */
+                ConvertFrameYUV10to8_2((unsigned char*)frame->yuv_image->data, (const uint16_t*)frame->inputBuffer,
+                                       sink->inputWidth, sink->inputHeight, 2, 1);
             }
             else
             {
-                /* no scale afterwards */
-                activeBuffer = (unsigned char*)frame->yuv_image->data;
+                ConvertFrameYUV10to8_2(frame->ditherOutputBuffer, (const uint16_t*)frame->inputBuffer, sink->inputWidth,
+                                       sink->inputHeight, 2, 1);
+                yuv422_to_uyvy_2(sink->inputWidth, sink->inputHeight, 0, frame->ditherOutputBuffer,
+                                 (unsigned char*)frame->yuv_image->data);
             }
-
-            ConvertFrameYUV10to8_2(frame->ditherOutputBuffer, (const uint16_t*)frame->inputBuffer, sink->inputWidth,
-                                   sink->inputHeight, 2, 1);
-            yuv422_to_uyvy_2(sink->inputWidth, sink->inputHeight, 0, frame->ditherOutputBuffer, activeBuffer);
         }
         else if (sink->inputVideoFormat == YUV420_10BIT_FORMAT)
         {
@@ -587,12 +748,13 @@ static int display_frame(X11XVDisplaySink* sink, X11DisplayFrame* frame, const F
             /* no conversion - scale input frame->input buffer != frame->yuv_image->data */
             activeBuffer = frame->inputBuffer;
         }
+        sink->timings.convertUsec += stage_usec(&stageStart);
 
         /* scale image and output to frame->yuv_image */
         if (sink->swScale != 1)
         {
             YUV_frame_from_buffer(&inputFrame, (void*)activeBuffer,
-                sink->inputWidth, sink->inputHeight, sink->outputYUVFormat);
+                sink->inputWidth, sink->inputHeight, scaleInputFormat);
 
             YUV_frame_from_buffer(&outputFrame, (void*)(unsigned char*)frame->yuv_image->data,
                 sink->width, sink->height, sink->outputYUVFormat);
@@ -608,6 +770,7 @@ static int display_frame(X11XVDisplaySink* sink, X11DisplayFrame* frame, const F
                 sink->applyScaleFilter,
                 frame->scaleWorkspace);
         }
+        sink->timings.scaleUsec += stage_usec(&stageStart);
 
         /* add OSD to frame */
         if (sink->osd != NULL && sink->osdInitialised)
@@ -619,6 +782,7 @@ static int display_frame(X11XVDisplaySink* sink, X11DisplayFrame* frame, const F
                 /* continue anyway */
             }
         }
+        sink->timings.osdUsec += stage_usec(&stageStart);
 
         /* wait until it is time to display this frame */
         gettimeofday(&timeNow, NULL);
@@ -642,6 +806,7 @@ static int display_frame(X11XVDisplaySink* sink, X11DisplayFrame* frame, const F
 
         XLockDisplay(sink->x11Common.windowInfo.display);
 
+        gettimeofday(&stageStart, NULL);
         if (sink->useSharedMemory)
         {
             XvShmPutImage(sink->x11Common.windowInfo.display, sink->xvport, sink->x11Common.windowInfo.window,
@@ -659,9 +824,12 @@ static int display_frame(X11XVDisplaySink* sink, X11DisplayFrame* frame, const F
         }
 
         XSync(sink->x11Common.windowInfo.display, False);
+        sink->timings.putUsec += stage_usec(&stageStart);
 
         XUnlockDisplay(sink->x11Common.windowInfo.display);
 
+        report_timings(sink);
+
 
         x11c_process_events(&sink->x11Common);
 
@@ -738,28 +906,32 @@ static int init_frame(X11DisplayFrame* frame)
     }
     else if (sink->inputVideoFormat == YUV422_FORMAT)
     {
-        /* Conversion required for YUV422 input */
-        frame->inputBufferSize = sink->inputWidth * sink->inputHeight * 2;
-        MALLOC_ORET(frame->inputBuffer, unsigned char, frame->inputBufferSize);
+        /* Conversion (or scaling) required for YUV422 input, unless XV takes planar 4:2:2 */
+        if (!sink->planarOutput || sink->swScale != 1)
+        {
+            frame->inputBufferSize = sink->inputWidth * sink->inputHeight * 2;
+            MALLOC_ORET(frame->inputBuffer, unsigned char, frame->inputBufferSize);
+        }
 
-        /* buffer for software scaling */
+        /* workspace for software scaling, which reads the input buffer directly */
         if (sink->swScale != 1)
         {
-            MALLOC_ORET(frame->scaleInputBuffer, unsigned char, sink->inputWidth * sink->inputHeight * 2);
             MALLOC_ORET(frame->scaleWorkspace, unsigned char, sink->inputWidth * 3);
         }
     }
     else if (sink->inputVideoFormat == YUV422_10BIT_FORMAT)
     {
-        /* Conversion required to YUV422 and then UYVY */
+        /* Conversion required to YUV422 and then UYVY, or just YUV422 if XV takes planar 4:2:2 */
         frame->inputBufferSize = sink->inputWidth * sink->inputHeight * 2 * 2;
         MALLOC_ORET(frame->inputBuffer, unsigned char, frame->inputBufferSize);
-        MALLOC_ORET(frame->ditherOutputBuffer, unsigned char, sink->inputWidth * sink->inputHeight * 2);
+        if (!sink->planarOutput || sink->swScale != 1)
+        {
+            MALLOC_ORET(frame->ditherOutputBuffer, unsigned char, sink->inputWidth * sink->inputHeight * 2);
+        }
 
-        /* buffer for software scaling */
+        /* workspace for software scaling, which reads the dither output directly */
         if (sink->swScale != 1)
         {
-            MALLOC_ORET(frame->scaleInputBuffer, unsigned char, sink->inputWidth * sink->inputHeight * 2);
             MALLOC_ORET(frame->scaleWorkspace, unsigned char, sink->inputWidth * 3);
         }
     }
@@ -845,11 +1017,12 @@ static int init_frame(X11DisplayFrame* frame)
     XUnlockDisplay(sink->x11Common.windowInfo.display);
 
     /* input buffer == output if no scaling and no conversion */
-    if (sink->inputVideoFormat != UYVY_10BIT_FORMAT &&
-        sink->inputVideoFormat != YUV444_FORMAT &&
-        sink->inputVideoFormat != YUV422_FORMAT &&
-        sink->inputVideoFormat != YUV422_10BIT_FORMAT &&
-        sink->inputVideoFormat != YUV420_10BIT_FORMAT &&
+    if (((sink->inputVideoFormat != UYVY_10BIT_FORMAT &&
+            sink->inputVideoFormat != YUV444_FORMAT &&
+            sink->inputVideoFormat != YUV422_FORMAT &&
+            sink->inputVideoFormat != YUV422_10BIT_FORMAT &&
+            sink->inputVideoFormat != YUV420_10BIT_FORMAT) ||
+         (sink->inputVideoFormat == YUV422_FORMAT && sink->planarOutput)) &&
         sink->swScale == 1)
     {
         frame->inputBufferSize = frame->yuv_image->data_size;
@@ -903,8 +1076,12 @@ static int xvskf_register_stream(void* data, int streamId, const StreamInfo* str
         {
             outputStreamInfo = *streamInfo;
 
-            /* converted to UYVY or YUV420 */
-            if (streamInfo->format == UYVY_10BIT_FORMAT ||
+            /* converted to UYVY, YUV422 or YUV420 */
+            if (sink->planarOutput)
+            {
+                outputStreamInfo.format = YUV422_FORMAT;
+            }
+            else if (streamInfo->format == UYVY_10BIT_FORMAT ||
                 streamInfo->format == YUV422_FORMAT ||
                 streamInfo->format == YUV422_10BIT_FORMAT ||
                 streamInfo->format == YUV444_FORMAT)
@@ -74,8 +74,33 @@
 /// Mutex to ensure only one thread at a time can call avcodec open/close
 static ACE_Thread_Mutex avcodec_mutex;
 
+/// MJPEG compression thread pool shared by all record threads.
+/// Created on first use and kept for the lifetime of the process.
+static mjpeg_compress_pool_t * mjpeg_pool = 0;
+static ACE_Thread_Mutex mjpeg_pool_mutex;
+
+static mjpeg_compress_pool_t * get_mjpeg_pool()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(mjpeg_pool_mutex);
+    if (0 == mjpeg_pool)
+    {
+        // one thread per CPU
+        if (mjpeg_compress_pool_init(0, &mjpeg_pool))
+        {
+            ACE_DEBUG((LM_INFO, ACE_TEXT("MJPEG compression pool started with %d threads\n"), mjpeg_pool->num_threads));
+        }
+        else
+        {
+            ACE_DEBUG((LM_ERROR, ACE_TEXT("Failed to start MJPEG compression pool\n")));
+            mjpeg_pool = 0;
+        }
+    }
+    return mjpeg_pool;
+}
+
 const bool CHECK_BACKLOG_EVERY_FRAME = false;
 const bool THREADED_MJPEG = false;
+const bool POOLED_MJPEG = true;
 const bool MT_ENABLE = true;
 const bool DEBUG_NOWRITE = false;
 const bool DEBUG_SLEEP = false;
@@ -787,6 +812,13 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
     }
 
     
+    // Buffer pools for frames passed to the multi-threaded encoder.
+    // Coded frames are copied out of the encoder into the coded pool and
+    // locally processed (quad-split or timecode overlay) input frames need
+    // a buffer each because they are encoded after the next frame is processed.
+    EncodeBufferPool coded_buffer_pool;
+    EncodeBufferPool unc_buffer_pool;
+
     // Initialise ffmpeg encoder
     ffmpeg_encoder_t * ffmpeg_encoder = 0;
     MtEncoder * mt_encoder = 0;
@@ -794,8 +826,16 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
     {
         if (MT_ENABLE && mt_possible)
         {
+            int mt_threads = (ffmpeg_threads > 0 ? ffmpeg_threads : 3);
+            coded_buffer_pool.Init(EncodeBufferPool::CodedFrameSize(resolution, raster, pixel_format, VIDEO_SIZE),
+                (ring_length - 3) / 2 + mt_threads);
+            if (bitc || quad_video)
+            {
+                unc_buffer_pool.Init(VIDEO_SIZE, 2 * mt_threads + 2);
+            }
+
             mt_encoder = new MtEncoder(&avcodec_mutex);
-            mt_encoder->Init(resolution, raster, ffmpeg_threads);
+            mt_encoder->Init(resolution, raster, ffmpeg_threads, &coded_buffer_pool);
         }
         else
         {
@@ -813,10 +853,21 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
     
     // Initialise MJPEG encoder
     mjpeg_compress_threaded_t * mj_encoder_threaded = 0;
+    mjpeg_compress_pooled_t * mj_encoder_pooled = 0;
     mjpeg_compress_t * mj_encoder = 0;
     if (ENCODER_MJPEG == encoder)
     {
-        if (THREADED_MJPEG)
+        mjpeg_compress_pool_t * pool = 0;
+        if (POOLED_MJPEG && (pool = get_mjpeg_pool()) != 0)
+        {
+            if (!mjpeg_compress_init_pooled(pool, mjpeg_res, WIDTH, HEIGHT, &mj_encoder_pooled))
+            {
+                ACE_DEBUG((LM_ERROR, ACE_TEXT("%C: mjpeg_compress_init_pooled() failed, using unpooled MJPEG encoder\n"), src_name.c_str()));
+                mj_encoder_pooled = 0;
+                mjpeg_compress_init(mjpeg_res, WIDTH, HEIGHT, &mj_encoder);
+            }
+        }
+        else if (THREADED_MJPEG)
         {
             mjpeg_compress_init_threaded(mjpeg_res, WIDTH, HEIGHT, &mj_encoder_threaded);
         }
@@ -1172,9 +1223,8 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
 
             // Create an EncodeFrame to hold pointers to input data
             int frame_index = frame[channel_i];
-            //EncodeFrame & ef = encode_frame_buffer.Frame(frame_index);
-            EncodeFrame * ef = new EncodeFrame();
-            encode_frame_buffer.Frame(frame_index) = ef;
+            EncodeFrame * ef = encode_frame_buffer.NewFrame(frame_index);
+            IngexShm::Instance()->Trace(channel_i, p_opt->index, quad_video, frame_index, NexusTracePickup);
 
             // Add this frame index to the queue for writing out.
             // NB. Maybe this functionality could be included in EncodeFrameBuffer
@@ -1230,7 +1280,11 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
                 /*
                 ACE_DEBUG((LM_DEBUG, ACE_TEXT("%C index %d Track %d data %@\n"), src_name.c_str(), p_opt->index, i, p));
                 */
-                ef->Track(i) = new EncodeFrameTrack();
+                // Tracks are kept when an EncodeFrame is re-used
+                if (!ef->Track(i))
+                {
+                    ef->Track(i) = new EncodeFrameTrack();
+                }
                 ef->Track(i)->Init(p, size, samples, copy, false, false, *p_frame_number, p_frame_number);
             }
 
@@ -1351,7 +1405,26 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
 
                 // Source for encoding is now the quad buffer
                 p_inp_video = quad_frame.Y.buff;
-                ef->Track(0)->Init(p_inp_video, VIDEO_SIZE, 1, false, false, false, ef->Track(0)->FrameIndex(), 0);
+                if (mt_encoder)
+                {
+                    // quad buffer will have changed before the frame is encoded
+                    void * p_unc = unc_buffer_pool.Acquire(VIDEO_SIZE);
+                    if (p_unc)
+                    {
+                        memcpy(p_unc, p_inp_video, VIDEO_SIZE);
+                        p_inp_video = p_unc;
+                        ef->Track(0)->Init(&unc_buffer_pool, p_inp_video, VIDEO_SIZE, 1, false, ef->Track(0)->FrameIndex());
+                    }
+                    else
+                    {
+                        ACE_DEBUG((LM_ERROR, ACE_TEXT("Failed to acquire pooled buffer for quad frame, copying instead\n")));
+                        ef->Track(0)->Init(p_inp_video, VIDEO_SIZE, 1, true, false, false, ef->Track(0)->FrameIndex(), 0);
+                    }
+                }
+                else
+                {
+                    ef->Track(0)->Init(p_inp_video, VIDEO_SIZE, 1, false, false, false, ef->Track(0)->FrameIndex(), 0);
+                }
             }
 
             // Add timecode overlay
@@ -1359,39 +1432,73 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
             {
                 tc_overlay_setup(tco, current_tc.FramesSinceMidnight());
 
-                // Need to copy video as can't overwrite shared memory
-                switch (pixel_format)
+                // Need to copy video as can't overwrite shared memory.
+                // With the multi-threaded encoder each frame needs its own copy.
+                uint8_t * p_overlay_video = tc_overlay_buffer;
+                bool pooled_overlay = false;
+                if (mt_encoder)
                 {
-                case Ingex::PixelFormat::YUV_PLANAR_420_MPEG:
-                case Ingex::PixelFormat::YUV_PLANAR_420_DV:
-                case Ingex::PixelFormat::YUV_PLANAR_411:
+                    uint8_t * p_unc = (uint8_t *) unc_buffer_pool.Acquire(VIDEO_SIZE);
+                    if (p_unc)
                     {
-                        // 420
-                        memcpy(tc_overlay_buffer, p_inp_video, VIDEO_SIZE);
-                        uint8_t * p_y = tc_overlay_buffer;
-                        uint8_t * p_u = p_y + WIDTH * HEIGHT;
-                        uint8_t * p_v = p_u + WIDTH * HEIGHT / 4;
-                        tc_overlay_apply(tco, p_y, p_u, p_v, WIDTH, HEIGHT, tc_xoffset, tc_yoffset, TC420);
+                        p_overlay_video = p_unc;
+                        pooled_overlay = true;
                     }
-                    break;
-                case Ingex::PixelFormat::YUV_PLANAR_422:
-                case Ingex::PixelFormat::UYVY_422:
-                default:
+                    else
                     {
-                        // 422
-                        memcpy(tc_overlay_buffer, p_inp_video, VIDEO_SIZE);
-                        uint8_t * p_y = tc_overlay_buffer;
-                        uint8_t * p_u = p_y + WIDTH * HEIGHT;
-                        uint8_t * p_v = p_u + WIDTH * HEIGHT / 2;
-                        tc_overlay_apply(tco, p_y, p_u, p_v, WIDTH, HEIGHT, tc_xoffset, tc_yoffset, TC422);
+                        ACE_DEBUG((LM_ERROR, ACE_TEXT("Failed to acquire pooled buffer for timecode overlay, copying instead\n")));
+                    }
+                }
+
+                if (p_overlay_video)
+                {
+                    switch (pixel_format)
+                    {
+                    case Ingex::PixelFormat::YUV_PLANAR_420_MPEG:
+                    case Ingex::PixelFormat::YUV_PLANAR_420_DV:
+                    case Ingex::PixelFormat::YUV_PLANAR_411:
+                        {
+                            // 420
+                            memcpy(p_overlay_video, p_inp_video, VIDEO_SIZE);
+                            uint8_t * p_y = p_overlay_video;
+                            uint8_t * p_u = p_y + WIDTH * HEIGHT;
+                            uint8_t * p_v = p_u + WIDTH * HEIGHT / 4;
+                            tc_overlay_apply(tco, p_y, p_u, p_v, WIDTH, HEIGHT, tc_xoffset, tc_yoffset, TC420);
+                        }
+                        break;
+                    case Ingex::PixelFormat::YUV_PLANAR_422:
+                    case Ingex::PixelFormat::UYVY_422:
+                    default:
+                        {
+                            // 422
+                            memcpy(p_overlay_video, p_inp_video, VIDEO_SIZE);
+                            uint8_t * p_y = p_overlay_video;
+                            uint8_t * p_u = p_y + WIDTH * HEIGHT;
+                            uint8_t * p_v = p_u + WIDTH * HEIGHT / 2;
+                            tc_overlay_apply(tco, p_y, p_u, p_v, WIDTH, HEIGHT, tc_xoffset, tc_yoffset, TC422);
+                        }
+                        break;
                     }
-                    break;
                 }
 
                 // Source for encoding is now the timecode overlay buffer
-                p_inp_video = tc_overlay_buffer;
-                ef->Track(0)->Init(p_inp_video, VIDEO_SIZE, 1, false, false, false, ef->Track(0)->FrameIndex(), 0);
+                p_inp_video = p_overlay_video;
+                if (pooled_overlay)
+                {
+                    ef->Track(0)->Init(&unc_buffer_pool, p_inp_video, VIDEO_SIZE, 1, false, ef->Track(0)->FrameIndex());
+                }
+                else if (mt_encoder)
+                {
+                    // overlay buffer is reused for the next frame so the encoder needs its own copy
+                    ef->Track(0)->Init(p_inp_video, VIDEO_SIZE, 1, true, false, false, ef->Track(0)->FrameIndex(), 0);
+                }
+                else
+                {
+                    ef->Track(0)->Init(p_inp_video, VIDEO_SIZE, 1, false, false, false, ef->Track(0)->FrameIndex(), 0);
+                }
             }
+
+            IngexShm::Instance()->Trace(channel_i, p_opt->index, quad_video, frame_index, NexusTraceConvert);
  
             // Mix audio for browse version
             int16_t mixed_audio[audio_samples_per_frame * 2];    // for 16bit stereo pair output
@@ -1471,7 +1578,11 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
                 uint8_t * y = (uint8_t *)p_inp_video;
                 uint8_t * u = y + WIDTH * HEIGHT;
                 uint8_t * v = u + WIDTH * HEIGHT / 2;
-                if (THREADED_MJPEG)
+                if (mj_encoder_pooled)
+                {
+                    size_enc_video = mjpeg_compress_frame_yuv_pooled(mj_encoder_pooled, y, u, v, WIDTH, WIDTH/2, WIDTH/2, &p_enc_video);
+                }
+                else if (mj_encoder_threaded)
                 {
                     size_enc_video = mjpeg_compress_frame_yuv_threaded(mj_encoder_threaded, y, u, v, WIDTH, WIDTH/2, WIDTH/2, &p_enc_video);
                 }
@@ -1497,6 +1608,8 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
                 }
             }
 
+            IngexShm::Instance()->Trace(channel_i, p_opt->index, quad_video, frame_index, NexusTraceEncode);
+
             // Encode and write browse audio
             if (browse_audio)
             {
@@ -1602,6 +1715,7 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
                     }
                     else
                     {
+                        IngexShm::Instance()->Trace(channel_i, p_opt->index, quad_video, frames_to_save.front(), NexusTraceWriteSubmit);
                         for (unsigned int i = 0; i < package_creator->GetMaterialPackage()->tracks.size(); ++i)
                         {
                             prodauto::Track * mp_trk = package_creator->GetMaterialPackage()->tracks[i];
@@ -1659,6 +1773,7 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
                                 }
                             }
                         }
+                        IngexShm::Instance()->Trace(channel_i, p_opt->index, quad_video, frames_to_save.front(), NexusTraceWriteComplete);
                     }
 
                     ++frames_written_this_loop;
@@ -1760,6 +1875,16 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
     {
         mt_encoder->Close();
         delete mt_encoder;
+
+        ACE_DEBUG((LM_INFO, ACE_TEXT("%C index %d coded buffer pool: %u of %u bytes, max in use %u, exhausted %u, oversize %u\n"),
+            src_name.c_str(), p_opt->index, coded_buffer_pool.NumBuffers(), coded_buffer_pool.BufferSize(),
+            coded_buffer_pool.MaxInUse(), coded_buffer_pool.Exhausted(), coded_buffer_pool.Oversize()));
+        if (unc_buffer_pool.NumBuffers())
+        {
+            ACE_DEBUG((LM_INFO, ACE_TEXT("%C index %d input buffer pool: %u of %u bytes, max in use %u, exhausted %u\n"),
+                src_name.c_str(), p_opt->index, unc_buffer_pool.NumBuffers(), unc_buffer_pool.BufferSize(),
+                unc_buffer_pool.MaxInUse(), unc_buffer_pool.Exhausted()));
+        }
     }
 
     // shutdown ffmpeg encoder
@@ -1793,6 +1918,10 @@ ACE_THR_FUNC_RETURN start_record_thread(void * p_arg)
     {
         mjpeg_compress_free_threaded(mj_encoder_threaded);
     }
+    if (mj_encoder_pooled)
+    {
+        mjpeg_compress_free_pooled(mj_encoder_pooled);
+    }
 
     // cleanup timecode overlay
     if (tco)
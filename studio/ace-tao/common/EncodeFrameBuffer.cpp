@@ -22,18 +22,223 @@
  * 02110-1301, USA.
  */
 
+#include <cstdlib>
 #include <cstring>
 #include <ace/Log_Msg.h>
 #include <ace/Guard_T.h>
 
 #include "EncodeFrameBuffer.h"
 
+// EncodeBufferPool class
+
+EncodeBufferPool::EncodeBufferPool()
+: mBuffers(0), mBufferSize(0), mNumBuffers(0), mInUse(0), mMaxInUse(0), mExhausted(0), mOversize(0)
+{ }
+
+EncodeBufferPool::~EncodeBufferPool()
+{
+    if (mInUse)
+    {
+        ACE_DEBUG((LM_WARNING, ACE_TEXT("EncodeBufferPool destroyed with %u buffers in use\n"), mInUse));
+    }
+    free(mBuffers);
+}
+
+/**
+Allocate num_buffers buffers of buffer_size bytes.
+Returns false if the allocation failed, in which case all buffers will come from the heap.
+*/
+bool EncodeBufferPool::Init(size_t buffer_size, unsigned int num_buffers)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(mMutex);
+
+    free(mBuffers);
+    mFreeBuffers.clear();
+    mBufferSize = buffer_size;
+    mNumBuffers = 0;
+    mInUse = 0;
+    mMaxInUse = 0;
+    mExhausted = 0;
+    mOversize = 0;
+
+    mBuffers = (uint8_t *) malloc(buffer_size * num_buffers);
+    if (!mBuffers)
+    {
+        ACE_DEBUG((LM_ERROR, ACE_TEXT("EncodeBufferPool::Init() malloc of %u buffers of %u bytes failed!\n"),
+            num_buffers, (unsigned int) buffer_size));
+        return false;
+    }
+    mNumBuffers = num_buffers;
+
+    // Fill free list so that buffers are handed out in address order
+    mFreeBuffers.reserve(num_buffers);
+    for (unsigned int i = num_buffers; i > 0; --i)
+    {
+        mFreeBuffers.push_back(mBuffers + (i - 1) * buffer_size);
+    }
+
+    return true;
+}
+
+/**
+Get a buffer of at least size bytes.
+Ownership passes to the caller until the buffer is returned with Release().
+Returns 0 only if the heap allocation made when the pool can't supply a buffer fails.
+*/
+void * EncodeBufferPool::Acquire(size_t size)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(mMutex);
+
+    void * buffer = 0;
+    if (size > mBufferSize)
+    {
+        ++mOversize;
+    }
+    else if (mFreeBuffers.empty())
+    {
+        ++mExhausted;
+    }
+    else
+    {
+        buffer = mFreeBuffers.back();
+        mFreeBuffers.pop_back();
+        ++mInUse;
+        if (mInUse > mMaxInUse)
+        {
+            mMaxInUse = mInUse;
+        }
+    }
+
+    if (!buffer)
+    {
+        buffer = malloc(size);
+        if (!buffer)
+        {
+            ACE_DEBUG((LM_ERROR, ACE_TEXT("EncodeBufferPool::Acquire() malloc failed!\n")));
+        }
+    }
+
+    return buffer;
+}
+
+/**
+Return a buffer obtained from Acquire().
+*/
+void EncodeBufferPool::Release(void * buffer)
+{
+    if (!buffer)
+    {
+        return;
+    }
+
+    {
+        ACE_Guard<ACE_Thread_Mutex> guard(mMutex);
+
+        if (IsPoolBuffer(buffer))
+        {
+            mFreeBuffers.push_back(buffer);
+            --mInUse;
+            return;
+        }
+    }
+
+    // heap buffer
+    free(buffer);
+}
+
+unsigned int EncodeBufferPool::InUse()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(mMutex);
+
+    return mInUse;
+}
+
+unsigned int EncodeBufferPool::MaxInUse()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(mMutex);
+
+    return mMaxInUse;
+}
+
+/** Number of times a buffer came from the heap because the pool was empty. */
+unsigned int EncodeBufferPool::Exhausted()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(mMutex);
+
+    return mExhausted;
+}
+
+/** Number of times a buffer came from the heap because it was larger than the pool's buffer size. */
+unsigned int EncodeBufferPool::Oversize()
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(mMutex);
+
+    return mOversize;
+}
+
+/** Must be called with mMutex held because Init() replaces the pool. */
+bool EncodeBufferPool::IsPoolBuffer(void * buffer) const
+{
+    uint8_t * p = (uint8_t *) buffer;
+    return mBuffers && p >= mBuffers && p < mBuffers + mNumBuffers * mBufferSize;
+}
+
+/**
+Buffer size for one coded frame.
+Coded frames are allowed twice the average size given by the resolution's data rate,
+plus a margin for headers, but never more than the uncompressed size.
+The uncompressed size is used if the data rate isn't known.
+*/
+size_t EncodeBufferPool::CodedFrameSize(MaterialResolution::EnumType res, Ingex::VideoRaster::EnumType raster,
+                                        Ingex::PixelFormat::EnumType format, size_t uncompressed_size)
+{
+    uint32_t kbyte_per_minute = 0;
+    int width;
+    int height;
+    int fps_num = 0;
+    int fps_den = 0;
+    Ingex::Interlace::EnumType interlace;
+
+    MaterialResolution::CheckVideoFormat(res, raster, format, kbyte_per_minute);
+    Ingex::VideoRaster::GetInfo(raster, width, height, fps_num, fps_den, interlace);
+
+    size_t size = uncompressed_size;
+    if (kbyte_per_minute > 0 && fps_num > 0 && fps_den > 0)
+    {
+        uint64_t frames_per_minute = (uint64_t) 60 * fps_num / fps_den;
+        size_t average_size = (size_t) ((uint64_t) kbyte_per_minute * 1000 / frames_per_minute);
+        size_t coded_size = 2 * average_size + 50000;
+        if (coded_size < size)
+        {
+            size = coded_size;
+        }
+    }
+    return size;
+}
+
 // EncodeFrameTrack class
 
 EncodeFrameTrack::EncodeFrameTrack()
-: mData(0), mSize(0), mSamples(0), mDel(false), mCoded(false), mFrameIndex(0), mpFrameIndex(0), mError(false)
+: mData(0), mSize(0), mSamples(0), mDel(false), mCoded(false), mFrameIndex(0), mpFrameIndex(0), mError(false),
+  mpPool(0)
 { }
 
+void EncodeFrameTrack::FreeData()
+{
+    if (mData && mDel)
+    {
+        if (mpPool)
+        {
+            mpPool->Release(mData);
+        }
+        else
+        {
+            free(mData);
+        }
+    }
+    mpPool = 0;
+}
+
 /**
 Add or replace a track.
 Data at data, size size.
@@ -52,10 +257,7 @@ void EncodeFrameTrack::Init(void * data, size_t size, unsigned int samples, bool
     mSamples = samples;
     mFrameIndex = frame_index;
 
-    if (mData && mDel)
-    {
-        free(mData);
-    }
+    FreeData();
     if (data)
     {
         if (copy)
@@ -96,6 +298,25 @@ void EncodeFrameTrack::Init(void * data, size_t size, unsigned int samples, bool
     mCoded = coded; // important to do this last - even better use a mutex
 }
 
+/**
+Add or replace a track with a buffer acquired from pool.
+The track takes ownership of the buffer and returns it to the pool when done.
+*/
+void EncodeFrameTrack::Init(EncodeBufferPool * pool, void * data, size_t size, unsigned int samples, bool coded,
+                                int frame_index)
+{
+    FreeData();
+
+    mData = data;
+    mSize = data ? size : 0;
+    mSamples = data ? samples : 0;
+    mFrameIndex = frame_index;
+    mDel = (data != 0);
+    mpPool = pool;
+    mpFrameIndex = 0; // pool buffer can't disappear
+    mCoded = coded; // important to do this last - even better use a mutex
+}
+
 bool EncodeFrameTrack::Valid()
 {
     return mpFrameIndex == 0 || *mpFrameIndex == mFrameIndex;
@@ -105,10 +326,7 @@ EncodeFrameTrack::~EncodeFrameTrack()
 {
     //ACE_DEBUG((LM_INFO, ACE_TEXT("EncodeFrameTrack destructor for track of frame_index %d\n"), mFrameIndex));
 
-    if (mDel)
-    {
-        free (mData);
-    }
+    FreeData();
 }
 
 // EncodeFrame class
@@ -154,6 +372,20 @@ bool EncodeFrame::Error() const
     return result;
 }
 
+/** Release track data and clear error flags so that the frame can be re-used. */
+void EncodeFrame::Reset()
+{
+    for (std::map<unsigned int, EncodeFrameTrack *>::iterator
+        it = mTracks.begin(); it != mTracks.end(); ++it)
+    {
+        if (it->second)
+        {
+            it->second->Init(0, 0, 0, false, false, false, 0, 0);
+            it->second->Error(false);
+        }
+    }
+}
+
 
 
 /*
@@ -196,6 +428,11 @@ EncodeFrameBuffer::~EncodeFrameBuffer()
     {
         delete it->second;
     }
+    for (std::vector<EncodeFrame *>::iterator
+        it = mSpareFrames.begin(); it != mSpareFrames.end(); ++it)
+    {
+        delete *it;
+    }
 }
 
 EncodeFrame * & EncodeFrameBuffer::Frame(unsigned int frame_index)
@@ -205,6 +442,30 @@ EncodeFrame * & EncodeFrameBuffer::Frame(unsigned int frame_index)
     return mFrameBuffer[frame_index];
 }
 
+/**
+Add an EncodeFrame at frame_index.
+A frame released by EraseFrame() is re-used if available, along with its tracks,
+so that no allocation is needed in steady state.
+*/
+EncodeFrame * EncodeFrameBuffer::NewFrame(unsigned int frame_index)
+{
+    ACE_Guard<ACE_Thread_Mutex> guard(mFrameBufferMutex);
+
+    EncodeFrame * ef = 0;
+    if (mSpareFrames.empty())
+    {
+        ef = new EncodeFrame();
+    }
+    else
+    {
+        ef = mSpareFrames.back();
+        mSpareFrames.pop_back();
+    }
+    mFrameBuffer[frame_index] = ef;
+
+    return ef;
+}
+
 void EncodeFrameBuffer::EraseFrame(unsigned int index)
 {
     ACE_Guard<ACE_Thread_Mutex> guard(mFrameBufferMutex);
@@ -213,7 +474,11 @@ void EncodeFrameBuffer::EraseFrame(unsigned int index)
     std::map<unsigned int, EncodeFrame *>::iterator it;
     if (mFrameBuffer.end() != (it = mFrameBuffer.find(index)))
     {
-        delete it->second;
+        if (it->second)
+        {
+            it->second->Reset();
+            mSpareFrames.push_back(it->second);
+        }
         mFrameBuffer.erase(it);
     }
 }
@@ -29,6 +29,47 @@
 #include <map>
 #include <ace/Thread_Mutex.h>
 
+#include "integer_types.h"
+#include "MaterialResolution.h"
+
+/**
+A pool of fixed size frame buffers, allocated as one block before recording starts.
+Buffers are passed between the capture, encode and write stages by ownership
+transfer and returned to the pool with Release().
+If the pool is exhausted, or a buffer larger than the pool's buffer size is
+requested, the buffer comes from the heap instead and the event is counted.
+*/
+class EncodeBufferPool
+{
+public:
+    EncodeBufferPool();
+    ~EncodeBufferPool();
+    bool Init(size_t buffer_size, unsigned int num_buffers);
+    void * Acquire(size_t size);
+    void Release(void * buffer);
+    size_t BufferSize() const { return mBufferSize; }
+    unsigned int NumBuffers() const { return mNumBuffers; }
+    unsigned int InUse();
+    unsigned int MaxInUse();
+    unsigned int Exhausted();
+    unsigned int Oversize();
+
+    static size_t CodedFrameSize(MaterialResolution::EnumType res, Ingex::VideoRaster::EnumType raster,
+                                 Ingex::PixelFormat::EnumType format, size_t uncompressed_size);
+private:
+    bool IsPoolBuffer(void * buffer) const;
+
+    uint8_t * mBuffers;
+    size_t mBufferSize;
+    unsigned int mNumBuffers;
+    std::vector<void *> mFreeBuffers;
+    unsigned int mInUse;
+    unsigned int mMaxInUse;
+    unsigned int mExhausted;
+    unsigned int mOversize;
+    ACE_Thread_Mutex mMutex; // mutex protects the pool, free list and counters
+};
+
 class EncodeFrameTrack
 {
 public:
@@ -36,6 +77,8 @@ public:
     ~EncodeFrameTrack();
     void Init(void * data, size_t size, unsigned int samples, bool copy, bool del, bool coded,
                 int frame_index, int * p_frame_index);
+    void Init(EncodeBufferPool * pool, void * data, size_t size, unsigned int samples, bool coded,
+                int frame_index);
     void * Data() const { return mData; }
     size_t Size() const { return mSize; }
     unsigned int Samples() const { return mSamples; }
@@ -46,6 +89,8 @@ public:
     void Error(bool err) { mError = err; }
     bool Error() const { return mError; }
 private:
+    void FreeData();
+
     void * mData;
     size_t mSize;
     unsigned int mSamples;
@@ -54,6 +99,7 @@ private:
     int mFrameIndex;
     int * mpFrameIndex; // For checking data still valid
     bool mError;
+    EncodeBufferPool * mpPool; // Pool owning mData, if any
 };
 
 class EncodeFrame
@@ -64,6 +110,7 @@ public:
     EncodeFrameTrack * & Track(unsigned int track_index);
     bool IsCoded() const;
     bool Error() const;
+    void Reset();
     //void * TrackData(unsigned int trk);
     //size_t TrackSize(unsigned int trk);
 private:
@@ -79,13 +126,15 @@ public:
     EncodeFrameBuffer();
     ~EncodeFrameBuffer();
     EncodeFrame * & Frame(unsigned int frame_index);
+    EncodeFrame * NewFrame(unsigned int frame_index);
     void EraseFrame(unsigned int index);
     size_t QueueSize();
     size_t CodedSize();
     void List();
 private:
     std::map<unsigned int, EncodeFrame *> mFrameBuffer;
-    ACE_Thread_Mutex mFrameBufferMutex; // mutex protects the map
+    std::vector<EncodeFrame *> mSpareFrames; // erased frames available for re-use
+    ACE_Thread_Mutex mFrameBufferMutex; // mutex protects the map and spare frames
 };
 
 #endif // ifndef CodedFrameBuffer_h
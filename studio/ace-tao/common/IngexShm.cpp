@@ -80,7 +80,7 @@ ACE_THR_FUNC_RETURN monitor_shm(void * p)
 }
 
 IngexShm::IngexShm()
-: mChannels(0), mAudioTracksPerChannel(0), mpControl(0), /*mTcMode(VITC),*/ mActivated(false), mThreadId(0)
+: mChannels(0), mAudioTracksPerChannel(0), mpControl(0), mpTrace(0), /*mTcMode(VITC),*/ mActivated(false), mThreadId(0)
 {
     // Start thread to monitor and (re-)connect to shared memory
     mActivated = true;
@@ -147,6 +147,23 @@ void IngexShm::Attach()
                 ACE_DEBUG((LM_DEBUG, ACE_TEXT("Connected to shared memory channel[%d] at %@\n"), i, mRing[i]));
             }
         }
+
+        // Pipeline trace is optional
+        int trace_id = ACE_OS::shmget(trace_shm_key, sizeof(NexusTrace), 0666);
+        if (trace_id != -1)
+        {
+            void * p = ACE_OS::shmat(trace_id, NULL, 0);
+            if (p != (void *) -1 && ((NexusTrace *)p)->ringlen == NEXUS_TRACE_RINGLEN)
+            {
+                mpTrace = (NexusTrace *)p;
+                ACE_DEBUG((LM_DEBUG, ACE_TEXT("Connected to shared memory trace at %@\n"), mpTrace));
+            }
+            else if (p != (void *) -1)
+            {
+                ACE_OS::shmdt(p);
+            }
+        }
+
         if (ok)
         {
             ACE_DEBUG((LM_INFO, ACE_TEXT("Connected to shared memory.\n")));
@@ -160,6 +177,11 @@ Detach from shared memory.
 */
 void IngexShm::Detach()
 {
+    if (mpTrace)
+    {
+        ACE_OS::shmdt((void *) mpTrace);
+        mpTrace = 0;
+    }
     if (mpControl)
     {
         for (unsigned int i = 0; i < mChannels; ++i)
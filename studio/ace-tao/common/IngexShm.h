@@ -35,6 +35,7 @@
 //#include "integer_types.h"
 
 #include "nexus_control.h"
+#include "nexus_trace.h"
 
 /**
 C++ API for the shared memory used to pass video/audio
@@ -116,6 +117,10 @@ public:
     void InfoSetFramesDropped(unsigned int channel, int index, bool quad_video, int frames_dropped);
     void InfoSetBacklog(unsigned int channel, int index, bool quad_video, int frames_in_backlog);
 
+    // Timestamp a pipeline stage for a frame in the trace shared memory, if present.
+    // Quad encodings are not traced.
+    void Trace(unsigned int channel, int index, bool quad_video, int frame, NexusTraceEncodeStage stage);
+
 
 protected:
     // Protect constructors to force use of Instance()
@@ -133,6 +138,7 @@ private:
     unsigned int mAudioTracksPerChannel;
     uint8_t * mRing[MAX_CHANNELS];
     NexusControl * mpControl;
+    NexusTrace * mpTrace;
     // static instance pointer
     static IngexShm * mInstance;
     // thread management
@@ -170,6 +176,14 @@ inline NexusFrameData * IngexShm::pFrameData(unsigned int channel, unsigned int
     return nexus_frame_data(mpControl, mRing, channel, frame);
 }
 
+inline void IngexShm::Trace(unsigned int channel, int index, bool quad_video, int frame, NexusTraceEncodeStage stage)
+{
+    if (mpTrace && !quad_video)
+    {
+        nexus_trace_encode(mpTrace, InfoGetRecIdx(), channel, index, frame, stage);
+    }
+}
+
 inline int IngexShm::LastFrame(unsigned int channel)
 {
     int frame = 0;
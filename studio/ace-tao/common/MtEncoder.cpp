@@ -22,6 +22,8 @@
  * 02110-1301, USA.
  */
 
+#include <cstring>
+
 #include "ElapsedTimeReporter.h"
 #include "DateTime.h"
 #include "Block.h"
@@ -33,7 +35,7 @@ const int DEFAULT_NUM_THREADS = 3;
 
 MtEncoder::MtEncoder(ACE_Thread_Mutex * mutex)
 : ACE_Task<ACE_MT_SYNCH>(),
-  mpAvcodecMutex(mutex), mShutdown(0)
+  mpAvcodecMutex(mutex), mShutdown(0), mpCodedPool(0)
 {
 }
 
@@ -42,9 +44,11 @@ MtEncoder::~MtEncoder()
     wait();
 }
 
-void MtEncoder::Init(MaterialResolution::EnumType res, Ingex::VideoRaster::EnumType raster, int num_threads)
+void MtEncoder::Init(MaterialResolution::EnumType res, Ingex::VideoRaster::EnumType raster, int num_threads,
+                     EncodeBufferPool * coded_pool)
 {
     mRes = res;
+    mpCodedPool = coded_pool;
     mRaster = raster;
     if (num_threads < 1)
     {
@@ -130,7 +134,18 @@ int MtEncoder::svc()
             }
 
             // Check again the input data is still in memory
-            if (eft->Valid())
+            if (eft->Valid() && mpCodedPool && size_enc_video > 0)
+            {
+                // Replace input data with coded data, copied to a buffer from the pool
+                // because the encoder re-uses its output buffer.
+                void * p_coded = mpCodedPool->Acquire(size_enc_video);
+                if (p_coded)
+                {
+                    memcpy(p_coded, p_enc_video, size_enc_video);
+                }
+                eft->Init(mpCodedPool, p_coded, size_enc_video, 1, true, eft->FrameIndex());
+            }
+            else if (eft->Valid())
             {
                 // Replace input data with coded data
                 eft->Init(p_enc_video, size_enc_video, 1, true, false, true, eft->FrameIndex(), 0);
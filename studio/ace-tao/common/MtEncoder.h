@@ -31,6 +31,7 @@
 #include "ffmpeg_encoder.h"
 
 class EncodeFrameBuffer;
+class EncodeBufferPool;
 
 class MtEncoder : public ACE_Task<ACE_MT_SYNCH>
 {
@@ -38,7 +39,8 @@ public:
     MtEncoder(ACE_Thread_Mutex * ff_mutex);
     virtual ~MtEncoder();
 
-    void Init(MaterialResolution::EnumType res, Ingex::VideoRaster::EnumType raster, int num_threads);
+    void Init(MaterialResolution::EnumType res, Ingex::VideoRaster::EnumType raster, int num_threads,
+              EncodeBufferPool * coded_pool = 0);
     void Encode(EncodeFrameTrack * eft);
     void Close();
     virtual int svc();
@@ -49,6 +51,7 @@ private:
     Ingex::VideoRaster::EnumType mRaster;
     int mNumThreads;
     int mShutdown;
+    EncodeBufferPool * mpCodedPool; // Pool for coded frames; heap used if 0
 };
 
 
@@ -28,6 +28,7 @@
 #include "dvs_fifo.h"
 
 #include "nexus_control.h"
+#include "nexus_trace.h"
 #include "logF.h"
 #include "video_VITC.h"
 #include "video_conversion.h"
@@ -35,6 +36,7 @@
 #include "avsync_analysis.h"
 #include "time_utils.h"
 #include "yuvlib/YUV_scale_pic.h"
+#include "yuvlib/YUV_downconvert.h"
 #include "Rational.h"
 
 #include <stdio.h>
@@ -115,6 +117,7 @@ sv_handle       *a_sv[MAX_CHANNELS] = {0};
 SDIThreadData   td[MAX_CHANNELS];
 int             num_sdi_threads = 0;
 NexusControl    *p_control = NULL;
+NexusTrace      *p_trace = NULL;
 uint8_t         *ring[MAX_CHANNELS] = {0};
 int             control_id, ring_id[MAX_CHANNELS];
 int             width = 0, height = 0;
@@ -157,6 +160,35 @@ uint8_t *hd2sd_interm2[MAX_CHANNELS];
 uint8_t *hd2sd_workspace[MAX_CHANNELS];
 size_t hd2sd_workspace_size;
 
+// HD to SD downconversion of the secondary video in a separate thread per
+// channel. The capture thread only stores the primary video, audio and
+// timecodes in the ring before queuing the frame, so that it is ready for
+// the next DMA as soon as possible. The worker thread makes the frame
+// available to readers once its secondary video is complete.
+const int HD2SD_QUEUE_LEN = 4;
+
+typedef struct {
+    pthread_t           thread;
+    pthread_mutex_t     m_queue;
+    pthread_cond_t      queue_change;
+    int                 frame[HD2SD_QUEUE_LEN];     // frame numbers, in capture order
+    int                 hwdrop[HD2SD_QUEUE_LEN];    // hardware dropped count for each frame
+    int                 start;
+    int                 count;                      // includes the frame being converted
+    bool                stop;                       // exit once the queue is empty
+    downconvert_filter  *filter;
+    uint8_t             *workspace;
+    size_t              workspace_size;
+} HD2SDWorker;
+
+HD2SDWorker *hd2sd_worker[MAX_CHANNELS] = {0};
+void stop_hd2sd_worker(int chan);
+
+// Last frame written into the ring by the capture thread. This runs ahead
+// of the published pc->lastframe while frames are queued for downconversion.
+int capture_lastframe[MAX_CHANNELS];
+int capture_hwdrop[MAX_CHANNELS];
+
 int last_ltc_bits[MAX_CHANNELS];
 int last_vitc_bits[MAX_CHANNELS];
 int last_dltc_bits[MAX_CHANNELS];
@@ -362,6 +394,9 @@ void cleanup_shared_mem(void)
             perror("shmctl(id, IPC_RMID):");
         }
     }
+
+    // pipeline trace
+    nexus_trace_remove();
 }
 
 void cleanup_exit(int res)
@@ -379,6 +414,11 @@ void cleanup_exit(int res)
         }
     }
 
+    // Stop the downconversion threads now that nothing queues frames
+    for (i = 0; i < MAX_CHANNELS; i++) {
+        stop_hd2sd_worker(i);
+    }
+
     // Close all sv handles
     for (i = 0; i < MAX_CHANNELS; i++) {
         if (a_sv[i] != 0) {
@@ -1051,6 +1091,8 @@ int allocate_shared_buffers(int num_channels, long long max_memory)
         }
         p_control->channel[i].lastframe = -1;
         p_control->channel[i].hwdrop = 0;
+        capture_lastframe[i] = -1;
+        capture_hwdrop[i] = 0;
         sprintf(p_control->channel[i].source_name, "ch%d", i);
         p_control->channel[i].source_name[sizeof(p_control->channel[i].source_name) - 1] = '\0';
 
@@ -1062,6 +1104,9 @@ int allocate_shared_buffers(int num_channels, long long max_memory)
         // memset(ring[i], 0x80, element_size * ring_len);
     }
 
+    // Pipeline trace is optional so failure to create it is not fatal
+    p_trace = nexus_trace_create();
+
     return 1;
 }
 
@@ -1302,6 +1347,256 @@ Ingex::Timecode derive_timecode_from_master(int64_t tod_rec, int64_t *p_diff_to_
     return derived_tc;
 }
 
+// Make frame available to readers of the ring buffer
+void publish_frame(int chan, int frame, int hwdrop)
+{
+    NexusBufCtl *pc = &(p_control->channel[chan]);
+
+    PTHREAD_MUTEX_LOCK( &pc->m_lastframe )
+    // stamp publish before lastframe is set so that a reader can't pick the frame up before it
+    nexus_trace_capture(p_trace, chan, frame, NexusTracePublish);
+    pc->hwdrop = hwdrop;
+    pc->lastframe = frame;
+    PTHREAD_MUTEX_UNLOCK( &pc->m_lastframe )
+}
+
+// Reformat SD UYVY into the secondary video buffer of a ring element
+void reformat_secondary(const uint8_t *uyvy, uint8_t *vid_dest)
+{
+    if (Ingex::PixelFormat::YUV_PLANAR_422 == secondary_pixel_format)
+    {
+        // Repack to planar YUV 4:2:2
+        uyvy_to_yuv422( sec_width, sec_height,
+                        secondary_line_shift,
+                        uyvy,                                       // input
+                        vid_dest + secondary_video_offset);         // output
+    }
+    else if (Ingex::PixelFormat::YUV_PLANAR_420_DV == secondary_pixel_format)
+    {
+        // Downsample and repack to planar YUV 4:2:0 for PAL DV
+        uyvy_to_yuv420_DV_sampling( sec_width, sec_height,
+                    secondary_line_shift,                       // should be true
+                    uyvy,                                       // input
+                    vid_dest + secondary_video_offset);         // output
+    }
+    else if (Ingex::PixelFormat::YUV_PLANAR_411 == secondary_pixel_format)
+    {
+        // Downsample and repack to planar YUV 4:1:1 for NTSC DV
+        uyvy_to_yuv411( sec_width, sec_height,
+                    secondary_line_shift,                       // should be false
+                    uyvy,                                       // input
+                    vid_dest + secondary_video_offset);         // output
+    }
+    else if (Ingex::PixelFormat::YUV_PLANAR_420_MPEG == secondary_pixel_format)
+    {
+        // Downsample and repack to planar YUV 4:2:0 for MPEG
+        uyvy_to_yuv420( sec_width, sec_height,
+                    0,                                          // no DV25 line shift
+                    uyvy,                                       // input
+                    vid_dest + secondary_video_offset);         // output
+    }
+}
+
+// Downconvert queued frames from the primary video already in the ring
+void * hd2sd_worker_thread(void *arg)
+{
+    long                chan = (long)arg;
+    HD2SDWorker         *w = hd2sd_worker[chan];
+    int                 ring_len = p_control->ringlen;
+
+    while (1)
+    {
+        PTHREAD_MUTEX_LOCK( &w->m_queue )
+        while (w->count == 0 && !w->stop)
+        {
+            pthread_cond_wait(&w->queue_change, &w->m_queue);
+        }
+        if (w->count == 0)
+        {
+            PTHREAD_MUTEX_UNLOCK( &w->m_queue )
+            break;
+        }
+        int frame = w->frame[w->start];
+        int hwdrop = w->hwdrop[w->start];
+        PTHREAD_MUTEX_UNLOCK( &w->m_queue )
+
+        uint8_t *vid_dest = ring[chan] + element_size * (frame % ring_len);
+
+        // use intermediate buffer if a pixel reformat is required
+        uint8_t *scale_output_buffer;
+        if (Ingex::PixelFormat::UYVY_422 != secondary_pixel_format)
+        {
+            scale_output_buffer = hd2sd_interm[chan];
+        }
+        else
+        {
+            scale_output_buffer = vid_dest + secondary_video_offset;
+        }
+
+        YUV_frame yuv_hd_frame, yuv_sd_frame;
+        YUV_frame_from_buffer(&yuv_hd_frame, vid_dest, width, height,
+            Ingex::PixelFormat::YUV_PLANAR_422 == primary_pixel_format ? Y42B : UYVY);
+        YUV_frame_from_buffer(&yuv_sd_frame, scale_output_buffer, sec_width, sec_height, UYVY);
+
+        int res = downconvert(w->filter, &yuv_hd_frame, &yuv_sd_frame, 0, sec_height,
+                              w->workspace, w->workspace_size);
+        if (res != YUV_OK)
+        {
+            logTF("chan %ld: HD to SD downconversion failed (%d)\n", chan, res);
+        }
+
+        if (Ingex::PixelFormat::UYVY_422 != secondary_pixel_format)
+        {
+            reformat_secondary(scale_output_buffer, vid_dest);
+        }
+
+        // frames are published in capture order
+        publish_frame(chan, frame, hwdrop);
+
+        PTHREAD_MUTEX_LOCK( &w->m_queue )
+        w->start = (w->start + 1) % HD2SD_QUEUE_LEN;
+        w->count--;
+        pthread_cond_broadcast(&w->queue_change);
+        PTHREAD_MUTEX_UNLOCK( &w->m_queue )
+    }
+
+    return NULL;
+}
+
+// Start a downconversion thread for a channel if the secondary video is
+// downconverted from primary video that the worker can read from the ring.
+// Returns false if the capture thread has to do the downconversion itself.
+bool start_hd2sd_worker(int chan)
+{
+    if (Ingex::PixelFormat::NONE == secondary_pixel_format || width <= 720 ||
+        use_ffmpeg_hd_sd_scaling || use_yuvlib_filter ||
+        primary_line_shift != 0 ||
+        (Ingex::PixelFormat::UYVY_422 != primary_pixel_format &&
+            Ingex::PixelFormat::YUV_PLANAR_422 != primary_pixel_format))
+    {
+        return false;
+    }
+    // at least one ring element must be free for the capture thread
+    if (p_control->ringlen <= HD2SD_QUEUE_LEN + 1)
+    {
+        logTF("chan %d: ring too short for HD to SD conversion thread\n", chan);
+        return false;
+    }
+
+    HD2SDWorker *w = (HD2SDWorker *)calloc(1, sizeof(HD2SDWorker));
+    if (!w)
+    {
+        return false;
+    }
+    w->filter = downconvert_create(width, height, sec_width, sec_height,
+                                   Interlace::NONE != interlace);
+    if (!w->filter)
+    {
+        logTF("chan %d: failed to create HD to SD filter\n", chan);
+        free(w);
+        return false;
+    }
+    w->workspace_size = downconvert_work_size(w->filter);
+    w->workspace = (uint8_t *)malloc(w->workspace_size);
+    if (!w->workspace)
+    {
+        downconvert_free(w->filter);
+        free(w);
+        return false;
+    }
+    pthread_mutex_init(&w->m_queue, NULL);
+    pthread_cond_init(&w->queue_change, NULL);
+
+    hd2sd_worker[chan] = w;
+    int err;
+    if ((err = pthread_create(&w->thread, NULL, hd2sd_worker_thread, (void *)(long)chan)) != 0)
+    {
+        logTF("chan %d: failed to create HD to SD conversion thread: %s\n", chan, strerror(err));
+        hd2sd_worker[chan] = NULL;
+        pthread_mutex_destroy(&w->m_queue);
+        pthread_cond_destroy(&w->queue_change);
+        free(w->workspace);
+        downconvert_free(w->filter);
+        free(w);
+        return false;
+    }
+    return true;
+}
+
+// Stop the downconversion thread once it has published the queued frames
+// and free the worker. The capture thread must have stopped queuing frames.
+void stop_hd2sd_worker(int chan)
+{
+    HD2SDWorker *w = hd2sd_worker[chan];
+    if (!w)
+    {
+        return;
+    }
+
+    PTHREAD_MUTEX_LOCK( &w->m_queue )
+    w->stop = true;
+    pthread_cond_broadcast(&w->queue_change);
+    PTHREAD_MUTEX_UNLOCK( &w->m_queue )
+
+    pthread_join(w->thread, NULL);
+    hd2sd_worker[chan] = NULL;
+
+    pthread_mutex_destroy(&w->m_queue);
+    pthread_cond_destroy(&w->queue_change);
+    free(w->workspace);
+    downconvert_free(w->filter);
+    free(w);
+}
+
+// The capture thread can be cancelled while it waits for the worker
+static void unlock_hd2sd_queue(void *arg)
+{
+    HD2SDWorker *w = (HD2SDWorker *)arg;
+    PTHREAD_MUTEX_UNLOCK( &w->m_queue )
+}
+
+// Queue a frame for downconversion, waiting only if the worker has fallen
+// a whole queue behind
+void queue_hd2sd_frame(int chan, int frame, int hwdrop)
+{
+    HD2SDWorker *w = hd2sd_worker[chan];
+
+    PTHREAD_MUTEX_LOCK( &w->m_queue )
+    pthread_cleanup_push(unlock_hd2sd_queue, w);
+    if (w->count == HD2SD_QUEUE_LEN)
+    {
+        logTF("chan %d: waiting for HD to SD conversion\n", chan);
+        while (w->count == HD2SD_QUEUE_LEN)
+        {
+            pthread_cond_wait(&w->queue_change, &w->m_queue);
+        }
+    }
+    int i = (w->start + w->count) % HD2SD_QUEUE_LEN;
+    w->frame[i] = frame;
+    w->hwdrop[i] = hwdrop;
+    w->count++;
+    pthread_cond_broadcast(&w->queue_change);
+    pthread_cleanup_pop(1);
+}
+
+// Wait until all queued frames have been published
+void wait_for_hd2sd_worker(int chan)
+{
+    HD2SDWorker *w = hd2sd_worker[chan];
+    if (!w)
+    {
+        return;
+    }
+
+    PTHREAD_MUTEX_LOCK( &w->m_queue )
+    pthread_cleanup_push(unlock_hd2sd_queue, w);
+    while (w->count > 0)
+    {
+        pthread_cond_wait(&w->queue_change, &w->m_queue);
+    }
+    pthread_cleanup_pop(1);
+}
+
 //
 // write_picture()
 //
@@ -1399,11 +1694,11 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
     // Do this first in order to mark video as changed before we start to change it.
     // We can't actually set the frame number now because the audio DMA will overwrite it.
     int frame_number = 0;
-    NexusFrameData * nfd = (NexusFrameData *)(ring[chan] + element_size * ((pc->lastframe + 1) % ring_len) + frame_data_offset);
+    NexusFrameData * nfd = (NexusFrameData *)(ring[chan] + element_size * ((capture_lastframe[chan] + 1) % ring_len) + frame_data_offset);
     nfd->frame_number = frame_number;
 
     // Destination in ring buffer
-    uint8_t *vid_dest = ring[chan] + element_size * ((pc->lastframe+1) % ring_len);
+    uint8_t *vid_dest = ring[chan] + element_size * ((capture_lastframe[chan]+1) % ring_len);
 
     // We always transfer to dma_buffer[] first, even if we want the
     // native DMA format (UYVY)
@@ -1460,6 +1755,10 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
         SV_CHECK( sv_fifo_reset(sv, poutput) );
         SV_CHECK( sv_fifo_start(sv, poutput) );
     }
+    else
+    {
+        nexus_trace_capture(p_trace, chan, capture_lastframe[chan] + 1, NexusTraceDMAComplete);
+    }
     //logTF("chan %d: sv_fifo_putbuffer() returned ok\n", chan);
 
     if (0)
@@ -1499,7 +1798,7 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
 
     if (test_avsync && !no_audio)
     {
-        log_avsync_analysis(chan, pc->lastframe,
+        log_avsync_analysis(chan, capture_lastframe[chan],
             dma_dest, (unsigned long)pbuffer->audio[0].addr[0], (unsigned long)pbuffer->audio[0].addr[1]);
     }
 
@@ -1579,8 +1878,9 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
         memset(vid_dest + secondary_audio_offset, 0, secondary_audio_size);
     }
 
-    // Convert primary video into secondary video buffer
-    if (Ingex::PixelFormat::NONE != secondary_pixel_format)
+    // Convert primary video into secondary video buffer, unless the
+    // channel's HD to SD thread will do it from the ring
+    if (Ingex::PixelFormat::NONE != secondary_pixel_format && !hd2sd_worker[chan])
     {
         unsigned char *reformat_input_buffer = dma_dest;
 
@@ -1662,38 +1962,7 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
         }
 
         // reformat for SD secondary
-        if (Ingex::PixelFormat::YUV_PLANAR_422 == secondary_pixel_format)
-        {
-            // Repack to planar YUV 4:2:2
-            uyvy_to_yuv422( sec_width, sec_height,
-                            secondary_line_shift,
-                            reformat_input_buffer,                      // input
-                            vid_dest + secondary_video_offset);         // output
-        }
-        else if (Ingex::PixelFormat::YUV_PLANAR_420_DV == secondary_pixel_format)
-        {
-            // Downsample and repack to planar YUV 4:2:0 for PAL DV
-            uyvy_to_yuv420_DV_sampling( sec_width, sec_height,
-                        secondary_line_shift,                       // should be true
-                        reformat_input_buffer,                      // input
-                        vid_dest + secondary_video_offset);         // output
-        }
-        else if (Ingex::PixelFormat::YUV_PLANAR_411 == secondary_pixel_format)
-        {
-            // Downsample and repack to planar YUV 4:1:1 for NTSC DV
-            uyvy_to_yuv411( sec_width, sec_height,
-                        secondary_line_shift,                       // should be false
-                        reformat_input_buffer,                      // input
-                        vid_dest + secondary_video_offset);         // output
-        }
-        else if (Ingex::PixelFormat::YUV_PLANAR_420_MPEG == secondary_pixel_format)
-        {
-            // Downsample and repack to planar YUV 4:2:0 for MPEG
-            uyvy_to_yuv420( sec_width, sec_height,
-                        0,                                          // no DV25 line shift
-                        reformat_input_buffer,                      // input
-                        vid_dest + secondary_video_offset);         // output
-        }
+        reformat_secondary(reformat_input_buffer, vid_dest);
     }
 
     // The various timecodes...
@@ -1710,7 +1979,7 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
     if (0)
     {
         logTF("chan %d: lastframe=%6d vitc1=%08x vitc2=%08x ltc=%08x dvitc1=%08x dvitc2=%08x dltc=%08x\n",
-            chan, pc->lastframe,
+            chan, capture_lastframe[chan],
             vitc1_bits,
             vitc2_bits,
             ltc_bits,
@@ -1878,9 +2147,9 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
     int64_t last_timestamp = 0;
 
     // Only process discontinuity when not the first frame
-    if (pc->lastframe > -1)
+    if (capture_lastframe[chan] > -1)
     {
-        NexusFrameData * last_nfd = (NexusFrameData *)(ring[chan] + element_size * ((pc->lastframe) % ring_len) + frame_data_offset);
+        NexusFrameData * last_nfd = (NexusFrameData *)(ring[chan] + element_size * ((capture_lastframe[chan]) % ring_len) + frame_data_offset);
         last_vitc = last_nfd->vitc;
         last_ltc = last_nfd->ltc;
         last_dvitc = last_nfd->dvitc;
@@ -1943,9 +2212,9 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
         {
             logTF("chan %d: Need to recover %d frames\n", chan, missing);
 
-            // Increment pc->lastframe by amount to avoid discontinuity.
+            // Increment lastframe by amount to avoid discontinuity.
             // Future frames will go in correct place in buffer
-            pc->lastframe += missing;
+            capture_lastframe[chan] += missing;
 
             // Ideally we would copy the dma transferred frame into its correct position
             // but this needs testing.
@@ -1953,15 +2222,15 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
             //memcpy(tmp_frame, vid_dest, width*height*2);
             //free(tmp_frame);
 
-            logTF("chan %d: Recovered.  lastframe=%d ltc=%d\n", chan, pc->lastframe, ltc_as_int);
+            logTF("chan %d: Recovered.  lastframe=%d ltc=%d\n", chan, capture_lastframe[chan], ltc_as_int);
         }
     }
 
     // Copy frame data such as timecodes to the end of the ring element.
     // This is a bit sneaky but saves maintaining a separate ring buffer.
-    // Note that pc->lastframe may have been incremented above so we
+    // Note that lastframe may have been incremented above so we
     // re-calculate the pointer to NexusFrameData
-    nfd = (NexusFrameData *)(ring[chan] + element_size * ((pc->lastframe + 1) % ring_len) + frame_data_offset);
+    nfd = (NexusFrameData *)(ring[chan] + element_size * ((capture_lastframe[chan] + 1) % ring_len) + frame_data_offset);
 
     // LTC, VITC, DLTC, DVITC, SYS as Ingex::Timecode
     nfd->tc_ltc = tc_ltc;
@@ -2039,7 +2308,7 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
         tc_frames = 0;
         tc_diff = 1;
     }
-    int tc_err = (tc_diff != 1 && tc_diff != 2159999 && pc->lastframe != -1); // NB. 2159999 assumes 25 fps
+    int tc_err = (tc_diff != 1 && tc_diff != 2159999 && capture_lastframe[chan] != -1); // NB. 2159999 assumes 25 fps
 
     // log timecode discontinuity if any, or give verbose log of specified chan
     if (tc_err || (verbose && chan == verbose_channel))
@@ -2049,7 +2318,7 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
         {
             // All timecode info
             logTF("chan %d: lastframe=%6d tick/2=%7d hwdrop=%3d vitc1=%08x vitc2=%08x ltc=%08x dvitc1=%08x dvitc2=%08x dltc=%08x vitc_diff=%d%s ltc_diff=%d%s dvitc_diff=%d%s dltc_diff=%d%s\n",
-            chan, pc->lastframe, pbuffer->control.tick / 2,
+            chan, capture_lastframe[chan], pbuffer->control.tick / 2,
             info.dropped,
             vitc1_bits,
             vitc2_bits,
@@ -2070,18 +2339,18 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
         {
             // Selected timecode info
             logTF("chan %d: lastframe=%6d tick/2=%7d hwdrop=%3d tc=%s tc_err=%d\n",
-                chan, pc->lastframe, pbuffer->control.tick / 2, info.dropped,
+                chan, capture_lastframe[chan], pbuffer->control.tick / 2, info.dropped,
                 tc_tc.Text(), tc_diff - 1);
         }
         PTHREAD_MUTEX_UNLOCK( &m_log )
     }
 
-    if (info.dropped != pc->hwdrop)
+    if (info.dropped != capture_hwdrop[chan])
     {
         PTHREAD_MUTEX_LOCK( &m_log )        // guard logging with mutex to avoid intermixing
 
         // dropped count has changed
-        logTF("chan %d: lastframe=%6d tc=%s dropped=%d\n", chan, pc->lastframe+1, tc_tc.Text(), info.dropped);
+        logTF("chan %d: lastframe=%6d tc=%s dropped=%d\n", chan, capture_lastframe[chan]+1, tc_tc.Text(), info.dropped);
 
         PTHREAD_MUTEX_UNLOCK( &m_log )      // end logging guard
     }
@@ -2094,7 +2363,7 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
             pbuffer->control.tick,
             pbuffer->control.clock_high, pbuffer->control.clock_low,
             diff_to_master,
-            pc->lastframe+1, vitc_as_int, ltc_as_int,
+            capture_lastframe[chan]+1, vitc_as_int, ltc_as_int,
             orig_vitc_as_int, orig_ltc_as_int,
             info.dropped);
 
@@ -2102,7 +2371,7 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
     }
 
     // Read card temperature every 25 frames (to reduce excessive sv_query calls)
-    if ((pc->lastframe+1) % 25 == 0)
+    if ((capture_lastframe[chan]+1) % 25 == 0)
     {
         int temp;
         if (sv_query(sv, SV_QUERY_TEMPERATURE, 0, &temp) == SV_OK)
@@ -2116,14 +2385,21 @@ int write_picture(int chan, sv_handle *sv, sv_fifo *poutput, int recover_from_vi
     }
 
     // Set frame number
-    frame_number = pc->lastframe + 1;
+    frame_number = capture_lastframe[chan] + 1;
     nfd->frame_number = frame_number;
 
-    // signal frame is now ready
-    PTHREAD_MUTEX_LOCK( &pc->m_lastframe )
-    pc->hwdrop = info.dropped;
-    pc->lastframe++;
-    PTHREAD_MUTEX_UNLOCK( &pc->m_lastframe )
+    capture_lastframe[chan]++;
+    capture_hwdrop[chan] = info.dropped;
+
+    // signal frame is now ready, or will be once its secondary video is done
+    if (hd2sd_worker[chan])
+    {
+        queue_hd2sd_frame(chan, capture_lastframe[chan], info.dropped);
+    }
+    else
+    {
+        publish_frame(chan, capture_lastframe[chan], info.dropped);
+    }
 
     return SV_OK;
 }
@@ -2177,26 +2453,30 @@ int write_dummy_frames(sv_handle *sv, int chan, int current_frame_tick, int tick
         int last_systc = sys_tc;
         */
 
+        // Dummy frames are published directly so must follow any frames
+        // still being downconverted
+        wait_for_hd2sd_worker(chan);
+
         for (int i = 0; i < num_dummy_frames; i++)
         {
             // Read ring buffer info
             int                 ring_len = p_control->ringlen;
             NexusBufCtl         *pc = &(p_control->channel[chan]);
-            NexusFrameData * nfd = (NexusFrameData *)(ring[chan] + element_size * ((pc->lastframe + 1) % ring_len) + frame_data_offset);
+            NexusFrameData * nfd = (NexusFrameData *)(ring[chan] + element_size * ((capture_lastframe[chan] + 1) % ring_len) + frame_data_offset);
 
             // Set frame number
             // Do this first in order to mark video as changed before we start to change it.
-            int frame_number = pc->lastframe + 1;
+            int frame_number = capture_lastframe[chan] + 1;
             nfd->frame_number = frame_number;
 
             // dummy video frame
-            uint8_t *vid_dest = ring[chan] + element_size * ((pc->lastframe+1) % ring_len);
+            uint8_t *vid_dest = ring[chan] + element_size * ((capture_lastframe[chan]+1) % ring_len);
             memcpy(vid_dest, no_video_frame, width*height*2);
 
             // dummy video frame in secondary buffer
             if (no_video_secondary_frame)
             {
-                uint8_t *vid_dest_sec = ring[chan] + element_size * ((pc->lastframe+1) % ring_len) + secondary_video_offset;
+                uint8_t *vid_dest_sec = ring[chan] + element_size * ((capture_lastframe[chan]+1) % ring_len) + secondary_video_offset;
                 if (Ingex::PixelFormat::YUV_PLANAR_422 == secondary_pixel_format)
                 {
                     // 4:2:2
@@ -2244,12 +2524,12 @@ int write_dummy_frames(sv_handle *sv, int chan, int current_frame_tick, int tick
                 break;
             }
             // primary audio
-            memset(ring[chan] + element_size * ((pc->lastframe+1) % ring_len) + primary_audio_offset, 0, n_audio_samples * 4 * naudioch);
+            memset(ring[chan] + element_size * ((capture_lastframe[chan]+1) % ring_len) + primary_audio_offset, 0, n_audio_samples * 4 * naudioch);
             // secondary audio
-            memset(ring[chan] + element_size * ((pc->lastframe+1) % ring_len) + secondary_audio_offset, 0, n_audio_samples * 2 * naudioch);
+            memset(ring[chan] + element_size * ((capture_lastframe[chan]+1) % ring_len) + secondary_audio_offset, 0, n_audio_samples * 2 * naudioch);
 
             // Write timecodes etc.
-            NexusFrameData * last_nfd = (NexusFrameData *)(ring[chan] + element_size * ((pc->lastframe) % ring_len) + frame_data_offset);
+            NexusFrameData * last_nfd = (NexusFrameData *)(ring[chan] + element_size * ((capture_lastframe[chan]) % ring_len) + frame_data_offset);
             // Increment timecode by 1 for dummy frames after the first
             if (i > 0)
             {
@@ -2257,7 +2537,7 @@ int write_dummy_frames(sv_handle *sv, int chan, int current_frame_tick, int tick
                 system_tc += 1;
             }
             int last_ftk = 0;
-            if (pc->lastframe >= 0)
+            if (capture_lastframe[chan] >= 0)
             {
                 last_ftk = last_nfd->tick;
             }
@@ -2290,7 +2570,7 @@ int write_dummy_frames(sv_handle *sv, int chan, int current_frame_tick, int tick
             }
 
             // Read card temperature every so often
-            if ((pc->lastframe+1) % 25 == 0)
+            if ((capture_lastframe[chan]+1) % 25 == 0)
             {
                 int temp;
                 if (sv_query(sv, SV_QUERY_TEMPERATURE, 0, &temp) == SV_OK)
@@ -2304,9 +2584,8 @@ int write_dummy_frames(sv_handle *sv, int chan, int current_frame_tick, int tick
             }
 
             // signal frame is now ready
-            PTHREAD_MUTEX_LOCK( &pc->m_lastframe )
-            pc->lastframe++;
-            PTHREAD_MUTEX_UNLOCK( &pc->m_lastframe )
+            capture_lastframe[chan]++;
+            publish_frame(chan, capture_lastframe[chan], capture_hwdrop[chan]);
 
             tick_last_dummy_frame = current_frame_tick - num_dummy_frames + 1;
         }
@@ -2559,8 +2838,9 @@ void usage_exit(void)
     fprintf(stderr, "    -v                   increase verbosity\n");
     fprintf(stderr, "    -ld                  logfile directory\n");
     fprintf(stderr, "    -d <channel>         channel number to print verbose debug messages for\n");
-    fprintf(stderr, "    -h2s_ffmpeg          use ffmpeg swscale to convert HD to SD [default use YUVlib]\n");
-    fprintf(stderr, "    -h2s_filter          use filter when converting HD to SD using YUVlib\n");
+    fprintf(stderr, "    -h2s_ffmpeg          use ffmpeg swscale in the capture thread to convert HD to SD\n");
+    fprintf(stderr, "                         [default use YUVlib polyphase filter in a separate thread]\n");
+    fprintf(stderr, "    -h2s_filter          use YUVlib scale_pic with filter in the capture thread to convert HD to SD\n");
     fprintf(stderr, "    -info                show info on installed DVS cards\n");
     fprintf(stderr, "    -h                   usage\n");
     fprintf(stderr, "\n");
@@ -3656,6 +3936,15 @@ int main (int argc, char ** argv)
         return 1;
     }
 
+    // Start HD to SD conversion threads
+    for (chan = 0; chan < num_sdi_threads; chan++)
+    {
+        if (start_hd2sd_worker(chan))
+        {
+            logTF("chan %d: started HD to SD conversion thread\n", chan);
+        }
+    }
+
     for (chan = 0; chan < num_sdi_threads; chan++)
     {
         int err;
@@ -3683,6 +3972,9 @@ int main (int argc, char ** argv)
     // Cleanup
     for (chan = 0; chan < MAX_CHANNELS; chan++)
     {
+        // the worker uses hd2sd_interm
+        stop_hd2sd_worker(chan);
+
         if (dma_buffer[chan])
         {
             free(dma_buffer[chan]);
@@ -15,6 +15,9 @@ extern "C" {
 #include <libavformat/avformat.h>
 #endif
 
+#include <stdio.h>
+#include <jpeglib.h>
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,6 +25,8 @@ extern "C" {
 #define MPA_FRAME_SIZE 1152
 
 #include "multicast_compressed.h"
+#include "multicast_video.h"
+#include "time_utils.h"
 
 typedef struct 
 {
@@ -605,6 +610,281 @@ extern int mpegts_encoder_close (mpegts_encoder_t *in_ts)
 	return 0;
 }
 
+
+/* MJPEG slice encoder */
+
+#define SLICE_MIN_QUALITY		10
+#define SLICE_MAX_QUALITY		90
+#define SLICE_START_QUALITY		75
+#define SLICE_MAX_LINES			256
+
+typedef struct
+{
+	struct jpeg_destination_mgr pub;
+	uint8_t *buffer;
+	int buffer_size;
+	uint8_t discard[4096];		/* output after the buffer overflowed */
+	int overflow;
+} slice_dest_t;
+
+typedef struct
+{
+	int width;
+	int height;
+	int slice_lines;
+	int num_slices;
+	int frame_budget;			/* bytes per frame for the bitrate */
+	int64_t time_budget;		/* microseconds per frame */
+	int quality;
+
+	struct jpeg_error_mgr jerr;
+	struct jpeg_compress_struct cinfo;
+	slice_dest_t dest;
+
+	int padded_width;			/* width rounded up to the MCU width */
+	uint8_t *pad_lines;			/* line copies when width is not a multiple of the MCU width */
+
+	uint8_t *slices;
+	int slice_sizes[UDP_MAX_SLICES];
+} internal_mjpeg_slice_encoder_t;
+
+static void slice_init_destination(j_compress_ptr cinfo)
+{
+	(void) cinfo;
+}
+
+static boolean slice_empty_output_buffer(j_compress_ptr cinfo)
+{
+	/* The frame is larger than the receiver's buffer so discard the rest of it */
+	slice_dest_t *dest = (slice_dest_t *)cinfo->dest;
+	dest->overflow = 1;
+	dest->pub.next_output_byte = dest->discard;
+	dest->pub.free_in_buffer = sizeof(dest->discard);
+	return TRUE;
+}
+
+static void slice_term_destination(j_compress_ptr cinfo)
+{
+	(void) cinfo;
+}
+
+extern mjpeg_slice_encoder_t *mjpeg_slice_encoder_init(int width, int height, int slice_lines, uint32_t kbit_rate, int max_encode_ms)
+{
+	internal_mjpeg_slice_encoder_t *enc;
+
+	/* slices must be whole 4:2:0 MCU rows */
+	if (slice_lines < 16 || slice_lines > SLICE_MAX_LINES || slice_lines % 16 != 0 || width < 16 || height < 16 || width % 2 != 0 || height % 2 != 0 ||
+		(height + slice_lines - 1) / slice_lines > UDP_MAX_SLICES)
+	{
+		fprintf(stderr, "Invalid MJPEG slice encoder dimensions %dx%d with %d line slices\n", width, height, slice_lines);
+		return NULL;
+	}
+
+	enc = (internal_mjpeg_slice_encoder_t *)calloc(1, sizeof(internal_mjpeg_slice_encoder_t));
+	if (!enc) {
+		fprintf(stderr, "Could not allocate encoder object\n");
+		return NULL;
+	}
+
+	enc->width = width;
+	enc->height = height;
+	enc->slice_lines = slice_lines;
+	enc->num_slices = (height + slice_lines - 1) / slice_lines;
+	enc->frame_budget = kbit_rate * 1000 / 8 / 25;
+	enc->time_budget = max_encode_ms * 1000;
+	enc->quality = SLICE_START_QUALITY;
+	enc->padded_width = (width + 15) / 16 * 16;
+
+	/* the receiver reassembles slices in a buffer of the uncompressed frame size */
+	enc->dest.buffer_size = width * height * 3 / 2;
+	enc->slices = (uint8_t *)malloc(enc->dest.buffer_size);
+	if (enc->padded_width != width)
+	{
+		/* slice_lines rows of Y followed by slice_lines/2 rows of each of U and V */
+		enc->pad_lines = (uint8_t *)calloc(enc->padded_width * slice_lines * 2, 1);
+	}
+	if (!enc->slices || (enc->padded_width != width && !enc->pad_lines))
+	{
+		fprintf(stderr, "Could not allocate encoder buffers\n");
+		mjpeg_slice_encoder_close(enc);
+		return NULL;
+	}
+
+	enc->cinfo.err = jpeg_std_error(&enc->jerr);
+	jpeg_create_compress(&enc->cinfo);
+
+	enc->dest.pub.init_destination = slice_init_destination;
+	enc->dest.pub.empty_output_buffer = slice_empty_output_buffer;
+	enc->dest.pub.term_destination = slice_term_destination;
+	enc->cinfo.dest = &enc->dest.pub;
+
+	enc->cinfo.image_width = width;
+	enc->cinfo.image_height = slice_lines;
+	enc->cinfo.input_components = 3;
+	enc->cinfo.in_color_space = JCS_YCbCr;
+	jpeg_set_defaults(&enc->cinfo);
+	jpeg_set_colorspace(&enc->cinfo, JCS_YCbCr);
+
+	/* 4:2:0 planar input passed directly as raw downsampled data */
+	enc->cinfo.raw_data_in = TRUE;
+	enc->cinfo.comp_info[0].h_samp_factor = 2;
+	enc->cinfo.comp_info[0].v_samp_factor = 2;
+	enc->cinfo.comp_info[1].h_samp_factor = 1;
+	enc->cinfo.comp_info[1].v_samp_factor = 1;
+	enc->cinfo.comp_info[2].h_samp_factor = 1;
+	enc->cinfo.comp_info[2].v_samp_factor = 1;
+	enc->cinfo.dct_method = JDCT_IFAST;
+
+	return (mjpeg_slice_encoder_t *)enc;
+}
+
+/* Set the row pointers for a slice, repeating the last picture line to fill the last MCU row */
+static void set_slice_rows(internal_mjpeg_slice_encoder_t *enc, int first_line, int num_lines,
+						   const uint8_t *y, const uint8_t *u, const uint8_t *v, int y_stride, int c_stride,
+						   JSAMPROW *y_rows, JSAMPROW *u_rows, JSAMPROW *v_rows)
+{
+	int mcu_lines = (num_lines + 15) / 16 * 16;
+	int i;
+
+	for (i = 0; i < mcu_lines; i++)
+	{
+		int line = first_line + (i < num_lines ? i : num_lines - 1);
+		y_rows[i] = (JSAMPROW)(y + line * y_stride);
+	}
+	for (i = 0; i < mcu_lines / 2; i++)
+	{
+		int line = first_line / 2 + (i < num_lines / 2 ? i : num_lines / 2 - 1);
+		u_rows[i] = (JSAMPROW)(u + line * c_stride);
+		v_rows[i] = (JSAMPROW)(v + line * c_stride);
+	}
+
+	if (enc->pad_lines)
+	{
+		/* libjpeg reads whole MCUs so copy the lines into a buffer padded with the last pixel */
+		int c_width = enc->width / 2;
+		int c_padded_width = enc->padded_width / 2;
+		uint8_t *pad_y = enc->pad_lines;
+		uint8_t *pad_c = enc->pad_lines + enc->padded_width * enc->slice_lines;
+		for (i = 0; i < mcu_lines; i++)
+		{
+			uint8_t *line = pad_y + i * enc->padded_width;
+			memcpy(line, y_rows[i], enc->width);
+			memset(line + enc->width, line[enc->width - 1], enc->padded_width - enc->width);
+			y_rows[i] = line;
+		}
+		for (i = 0; i < mcu_lines / 2; i++)
+		{
+			uint8_t *u_line = pad_c + (2 * i) * c_padded_width;
+			uint8_t *v_line = pad_c + (2 * i + 1) * c_padded_width;
+			memcpy(u_line, u_rows[i], c_width);
+			memset(u_line + c_width, u_line[c_width - 1], c_padded_width - c_width);
+			memcpy(v_line, v_rows[i], c_width);
+			memset(v_line + c_width, v_line[c_width - 1], c_padded_width - c_width);
+			u_rows[i] = u_line;
+			v_rows[i] = v_line;
+		}
+	}
+}
+
+extern int mjpeg_slice_encoder_encode(mjpeg_slice_encoder_t *in_enc, const uint8_t *y, const uint8_t *u, const uint8_t *v,
+									  int y_stride, int c_stride, const uint8_t **p_slices, const int **p_slice_sizes)
+{
+	internal_mjpeg_slice_encoder_t *enc = (internal_mjpeg_slice_encoder_t *)in_enc;
+	if (!enc)
+		return -1;
+
+	int64_t start_time = gettimeofday64();
+
+	/* quality is fixed for the whole frame and adjusted afterwards */
+	jpeg_set_quality(&enc->cinfo, enc->quality, TRUE /* limit to baseline-JPEG values */);
+
+	enc->dest.overflow = 0;
+	enc->dest.pub.next_output_byte = enc->slices;
+	enc->dest.pub.free_in_buffer = enc->dest.buffer_size;
+
+	int total_size = 0;
+	int slice;
+	for (slice = 0; slice < enc->num_slices; slice++)
+	{
+		JSAMPROW y_rows[SLICE_MAX_LINES], u_rows[SLICE_MAX_LINES / 2], v_rows[SLICE_MAX_LINES / 2];
+		JSAMPARRAY planes[3] = { y_rows, u_rows, v_rows };
+		int first_line = slice * enc->slice_lines;
+		int num_lines = enc->slice_lines;
+		if (first_line + num_lines > enc->height)
+			num_lines = enc->height - first_line;
+
+		/* each slice is a complete JPEG picture */
+		enc->cinfo.image_height = num_lines;
+		set_slice_rows(enc, first_line, num_lines, y, u, v, y_stride, c_stride, y_rows, u_rows, v_rows);
+
+		jpeg_start_compress(&enc->cinfo, TRUE);
+		int row;
+		for (row = 0; row < num_lines; row += 16)
+		{
+			planes[0] = &y_rows[row];
+			planes[1] = &u_rows[row / 2];
+			planes[2] = &v_rows[row / 2];
+			jpeg_write_raw_data(&enc->cinfo, planes, 16);
+		}
+		jpeg_finish_compress(&enc->cinfo);
+
+		int end = enc->dest.buffer_size - (int)enc->dest.pub.free_in_buffer;
+		if (enc->dest.overflow)
+			break;
+		enc->slice_sizes[slice] = end - total_size;
+		total_size = end;
+	}
+
+	/* Adjust quality for the next frame. Fewer coefficients to entropy code also
+	   shortens the encode so the same step is used for both budgets */
+	int64_t encode_time = gettimeofday64() - start_time;
+	if (enc->dest.overflow || total_size > enc->frame_budget || encode_time > enc->time_budget)
+	{
+		enc->quality -= 5;
+		if (enc->quality < SLICE_MIN_QUALITY)
+			enc->quality = SLICE_MIN_QUALITY;
+	}
+	else if (total_size < enc->frame_budget * 8 / 10 && encode_time < enc->time_budget * 8 / 10)
+	{
+		enc->quality++;
+		if (enc->quality > SLICE_MAX_QUALITY)
+			enc->quality = SLICE_MAX_QUALITY;
+	}
+
+	if (enc->dest.overflow)
+	{
+		fprintf(stderr, "MJPEG slice encoder output exceeded %d bytes\n", enc->dest.buffer_size);
+		return -1;
+	}
+
+	*p_slices = enc->slices;
+	*p_slice_sizes = enc->slice_sizes;
+	return enc->num_slices;
+}
+
+extern int mjpeg_slice_encoder_quality(mjpeg_slice_encoder_t *in_enc)
+{
+	internal_mjpeg_slice_encoder_t *enc = (internal_mjpeg_slice_encoder_t *)in_enc;
+	if (!enc)
+		return -1;
+
+	return enc->quality;
+}
+
+extern int mjpeg_slice_encoder_close(mjpeg_slice_encoder_t *in_enc)
+{
+	internal_mjpeg_slice_encoder_t *enc = (internal_mjpeg_slice_encoder_t *)in_enc;
+	if (!enc)
+		return -1;
+
+	if (enc->cinfo.err)
+		jpeg_destroy_compress(&enc->cinfo);
+	free(enc->pad_lines);
+	free(enc->slices);
+	free(enc);
+	return 0;
+}
+
 #ifdef DEBUG_MPEGTS_MAIN
 #include <sys/time.h>		// gettimeofday()
 extern int main (int argc, char **argv)
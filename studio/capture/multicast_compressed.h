@@ -12,6 +12,21 @@ extern mpegts_encoder_t *mpegts_encoder_init(const char *filename, int width, in
 extern int mpegts_encoder_encode(mpegts_encoder_t *in_ts, const uint8_t *p_video, const int16_t *p_audio, int32_t frame_number);
 extern int mpegts_encoder_close(mpegts_encoder_t *in_ts);
 
+/* Intra-only MJPEG encoder producing independently decodable horizontal slices
+ * of planar 4:2:0 video for send_audio_compressed_video().
+ * The JPEG quality is adjusted from frame to frame to keep each frame within
+ * the bitrate budget and the encode time within max_encode_ms.
+ */
+typedef void mjpeg_slice_encoder_t;
+
+extern mjpeg_slice_encoder_t *mjpeg_slice_encoder_init(int width, int height, int slice_lines, uint32_t kbit_rate, int max_encode_ms);
+/* Chroma is 4:2:0 sampled, so a 4:2:2 picture can be encoded by passing twice its chroma line stride.
+ * Returns the number of slices, with the slice data one after the other in *p_slices, or -1 on failure */
+extern int mjpeg_slice_encoder_encode(mjpeg_slice_encoder_t *in_enc, const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                                      int y_stride, int c_stride, const uint8_t **p_slices, const int **p_slice_sizes);
+extern int mjpeg_slice_encoder_quality(mjpeg_slice_encoder_t *in_enc);
+extern int mjpeg_slice_encoder_close(mjpeg_slice_encoder_t *in_enc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -44,6 +44,10 @@
 
 #define TESTING_FLAG        0
 
+#define MJPEG_DEFAULT_KBIT_RATE     80000
+#define MJPEG_SLICE_LINES           64      // 17 slices for 1080 lines
+#define MJPEG_MAX_ENCODE_MS         20      // half a frame period
+
 
 int verbose = 1;
 
@@ -72,7 +76,10 @@ static void usage_exit(void)
     fprintf(stderr, "                  (use 360x288 for 1/4-picture)\n");
     fprintf(stderr, "                  (use 180x144 for 1/16-picture)\n");
     fprintf(stderr, "    -t            send compressed MPEG-TS stream suitable for VLC playback\n");
+    fprintf(stderr, "    -m            send slice compressed MJPEG stream at full picture size for Ingex players\n");
+    fprintf(stderr, "                  (8 HD channels fit on a gigabit link at the default bitrate)\n");
     fprintf(stderr, "    -b kps        MPEG-2 video bitrate to use for compressed MPEG-TS [default 3500 kbps]\n");
+    fprintf(stderr, "                  or maximum MJPEG bitrate [default %d kbps]\n", MJPEG_DEFAULT_KBIT_RATE);
     fprintf(stderr, "    -q            quiet operation (fewer messages)\n");
     exit(1);
 }
@@ -81,8 +88,10 @@ extern int main(int argc, char *argv[])
 {
     int             channelnum = 0;
     int             bitrate = 3500;
+    int             opt_bitrate = 0;
     int             opt_size = 0;
     int             mpegts = 0;
+    int             mjpeg = 0;
     int             out_width = 240, out_height = 192;
     char            *address = NULL;
     int             fd = -1;
@@ -124,12 +133,17 @@ extern int main(int argc, char *argv[])
                 fprintf(stderr, "-b requires bitrate in bps\n");
                 return 1;
             }
+            opt_bitrate = 1;
             n++;
         }
         else if (strcmp(argv[n], "-t") == 0)
         {
             mpegts = 1;
         }
+        else if (strcmp(argv[n], "-m") == 0)
+        {
+            mjpeg = 1;
+        }
         else if (strcmp(argv[n], "-h") == 0 || strcmp(argv[n], "--help") == 0)
         {
             usage_exit();
@@ -139,10 +153,14 @@ extern int main(int argc, char *argv[])
         }
     }
 
-    if (address == NULL) {
+    if (address == NULL || (mpegts && mjpeg)) {
         usage_exit();
     }
 
+    if (mjpeg && opt_bitrate == 0) {
+        bitrate = MJPEG_DEFAULT_KBIT_RATE;
+    }
+
     if (mpegts && opt_size == 0) {
         // default MPEG-TS to fullsize picture
         out_width = 720;
@@ -222,7 +240,20 @@ extern int main(int argc, char *argv[])
     int use_primary_video = 0;
     int video_422yuv = 0;
 
-    if (pctl->sec_video_format == Format420PlanarYUV || pctl->sec_video_format == Format420PlanarYUVShifted)
+    if (mjpeg && opt_size == 0 &&
+        (pctl->pri_video_format == Format420PlanarYUV || pctl->pri_video_format == Format420PlanarYUVShifted))
+    {
+        // MJPEG is sent at full picture size, including HD
+        use_primary_video = 1;
+        video_422yuv = 0;
+    }
+    else if (mjpeg && opt_size == 0 &&
+        (pctl->pri_video_format == Format422PlanarYUV || pctl->pri_video_format == Format422PlanarYUVShifted))
+    {
+        use_primary_video = 1;
+        video_422yuv = 1;
+    }
+    else if (pctl->sec_video_format == Format420PlanarYUV || pctl->sec_video_format == Format420PlanarYUVShifted)
     {
         use_primary_video = 0;
         video_422yuv = 0;
@@ -263,6 +294,12 @@ extern int main(int argc, char *argv[])
         printf("Using secondary video buffer with format %s\n", nexus_capture_format_name(pctl->sec_video_format));
     }
 
+    if (mjpeg && opt_size == 0) {
+        // no scaling
+        out_width = width;
+        out_height = height;
+    }
+
 
     uint8_t *scaled_frame = (uint8_t *)malloc(out_width * out_height * 3/2);
 
@@ -291,16 +328,25 @@ extern int main(int argc, char *argv[])
         }
     }
     else {
-        // open socket for uncompressed multicast
+        // open socket for uncompressed or MJPEG multicast
         if ((fd = open_socket_for_streaming(remote, port)) == -1) {
             exit(1);
         }
     }
 
+    mjpeg_slice_encoder_t *mjpeg_enc = NULL;
+    if (mjpeg) {
+        if ((mjpeg_enc = mjpeg_slice_encoder_init(out_width, out_height, MJPEG_SLICE_LINES, bitrate, MJPEG_MAX_ENCODE_MS)) == NULL) {
+            return 1;
+        }
+        printf("Sending %dx%d MJPEG at up to %d kbps\n", out_width, out_height, bitrate);
+    }
+
     int frames_sent = 0;
     while (1)
     {
         const uint8_t *p_video = blank_video, *p_audio = blank_audio;
+        int video_is_422 = 0;
         int tc = 0, ltc = 0, signal_ok = 0;
         uint8_t audio[1920*2*2];		// holds audio for 2 tracks of 16bit audio
 
@@ -360,6 +406,7 @@ extern int main(int argc, char *argv[])
                 }
                 else {
                     p_video = video_frame;
+                    video_is_422 = video_422yuv;
                 }
 
                 if (ts) {
@@ -386,6 +433,23 @@ extern int main(int argc, char *argv[])
                                     (int16_t*)p_audio,
                                     frames_sent++);
         }
+        else if (mjpeg_enc) {
+            // 4:2:2 is encoded as 4:2:0 by skipping every other chroma line
+            int y_size = out_width * out_height;
+            int c_size = video_is_422 ? y_size / 2 : y_size / 4;
+            int c_stride = video_is_422 ? out_width : out_width / 2;
+            const uint8_t *slices;
+            const int *slice_sizes;
+            int num_slices = mjpeg_slice_encoder_encode(mjpeg_enc,
+                                    p_video, p_video + y_size, p_video + y_size + c_size,
+                                    out_width, c_stride, &slices, &slice_sizes);
+            if (num_slices > 0) {
+                send_audio_compressed_video(fd, out_width, out_height, 2,
+                                    slices, slice_sizes, num_slices, MJPEG_SLICE_LINES,
+                                    p_audio,
+                                    pc->lastframe, tc, ltc, pc->source_name);
+            }
+        }
         else {
 #if TESTING_FLAG
     printf("Inside nexus_multicast: About to call send_audio_video\n");
@@ -402,6 +466,9 @@ extern int main(int argc, char *argv[])
             printf("\rcam%d lastframe=%d %s  tc=%10d  %s   ltc=%11d  %s ",
                     channelnum, pc->lastframe, signal_ok ? "ok" : "--",
                     tc, framesToStr(tc, tcstr), ltc, framesToStr(ltc, ltcstr));
+            if (mjpeg_enc) {
+                printf(" q=%d ", mjpeg_slice_encoder_quality(mjpeg_enc));
+            }
             fflush(stdout);
         }
 
@@ -0,0 +1,381 @@
+/*
+ * $Id$
+ *
+ * Report per-stage latencies of the capture, encode and write pipeline
+ * from the nexus trace shared memory
+ *
+ * Copyright (C) 2012 British Broadcasting Corporation
+ * All rights reserved
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <unistd.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "nexus_trace.h"
+
+
+// Latency spans reported, each between two timestamps of a trace entry
+typedef enum {
+    SpanPublish,            // dma -> publish
+    SpanQueue,              // publish -> pickup
+    SpanConvert,            // pickup -> convert
+    SpanEncode,             // convert -> encode
+    SpanWriteWait,          // encode -> write_submit
+    SpanWrite,              // write_submit -> write_complete
+    SpanTotal,              // dma -> write_complete
+    NumSpans
+} Span;
+
+static const char *span_names[NumSpans] = {
+    "dma->publish",
+    "publish->pickup",
+    "pickup->convert",
+    "convert->encode",
+    "encode->submit",
+    "submit->complete",
+    "total"
+};
+
+#define NUM_HIST_BUCKETS 16     // log2 microsecond buckets, last is open-ended
+
+int verbose = 0;
+
+
+static void usage_exit(void)
+{
+    fprintf(stderr, "Usage: nexus_trace_stats [options]\n");
+    fprintf(stderr, "\n");
+    fprintf(stderr, "    -c <channel>        only report channel (default all channels)\n");
+    fprintf(stderr, "    -i <seconds>        reporting interval [default 5]\n");
+    fprintf(stderr, "    -j <file>           write trace ring as Chrome trace JSON to file and exit\n");
+    fprintf(stderr, "    -v                  print latency histograms\n");
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+// Copy an entry, returning false if the capture daemon reused the slot while copying
+static bool read_entry(const NexusTrace *trace, int channel, int slot, NexusTraceEntry *entry)
+{
+    const volatile NexusTraceEntry *src = &trace->entry[channel][slot];
+
+    int frame = src->frame;
+    __sync_synchronize();
+    memcpy(entry, (const void *)src, sizeof(*entry));
+    __sync_synchronize();
+
+    return frame >= 0 && src->frame == frame && entry->frame == frame;
+}
+
+// Return the span start and end timestamps for an encode of an entry
+static void span_times(const NexusTraceEntry *entry, int rec, int enc, Span span, int64_t *start, int64_t *end)
+{
+    const int64_t *e = entry->encode[rec][enc];
+
+    switch (span)
+    {
+    case SpanPublish:
+        *start = entry->capture[NexusTraceDMAComplete];
+        *end = entry->capture[NexusTracePublish];
+        break;
+    case SpanQueue:
+        *start = entry->capture[NexusTracePublish];
+        *end = e[NexusTracePickup];
+        break;
+    case SpanConvert:
+        *start = e[NexusTracePickup];
+        *end = e[NexusTraceConvert];
+        break;
+    case SpanEncode:
+        *start = e[NexusTraceConvert];
+        *end = e[NexusTraceEncode];
+        break;
+    case SpanWriteWait:
+        *start = e[NexusTraceEncode];
+        *end = e[NexusTraceWriteSubmit];
+        break;
+    case SpanWrite:
+        *start = e[NexusTraceWriteSubmit];
+        *end = e[NexusTraceWriteComplete];
+        break;
+    case SpanTotal:
+    default:
+        *start = entry->capture[NexusTraceDMAComplete];
+        *end = e[NexusTraceWriteComplete];
+        break;
+    }
+}
+
+static int64_t percentile(const std::vector<int64_t> &sorted, int pc)
+{
+    size_t i = (sorted.size() - 1) * pc / 100;
+    return sorted[i];
+}
+
+static void print_stats(int channel, int rec, int enc, std::vector<int64_t> samples[NumSpans])
+{
+    printf("channel %d recorder %d encode %d: %d frames\n", channel, rec, enc, (int)samples[SpanWrite].size());
+    printf("  %-18s %10s %10s %10s %10s %10s\n", "span (us)", "min", "p50", "p90", "p99", "max");
+    for (int s = 0; s < NumSpans; s++)
+    {
+        std::vector<int64_t> &v = samples[s];
+        if (v.empty())
+        {
+            continue;
+        }
+        std::sort(v.begin(), v.end());
+        printf("  %-18s %10.1f %10.1f %10.1f %10.1f %10.1f\n", span_names[s],
+                v.front() / 1000.0, percentile(v, 50) / 1000.0, percentile(v, 90) / 1000.0,
+                percentile(v, 99) / 1000.0, v.back() / 1000.0);
+
+        if (verbose)
+        {
+            int hist[NUM_HIST_BUCKETS] = {0};
+            for (size_t i = 0; i < v.size(); i++)
+            {
+                int b = 0;
+                int64_t us = v[i] / 1000;
+                while (us > 0 && b < NUM_HIST_BUCKETS - 1)
+                {
+                    us >>= 1;
+                    b++;
+                }
+                hist[b]++;
+            }
+            for (int b = 0; b < NUM_HIST_BUCKETS; b++)
+            {
+                if (hist[b])
+                {
+                    printf("      %s%8d us %6d\n", b == NUM_HIST_BUCKETS - 1 ? ">=" : "< ", 1 << b, hist[b]);
+                }
+            }
+        }
+        v.clear();
+    }
+}
+
+static void write_json_event(FILE *fp, bool *first, const char *name, int pid, int tid, int frame,
+                             int64_t start, int64_t end)
+{
+    if (start == 0 || end == 0 || end < start)
+    {
+        return;
+    }
+    fprintf(fp, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%d}}",
+            *first ? "" : ",", name, pid, tid, start / 1000.0, (end - start) / 1000.0, frame);
+    *first = false;
+}
+
+// Write the ring contents in the Chrome trace event format (chrome://tracing, Perfetto).
+// Each channel is a process; capture is thread 0 and each recorder encode a further thread.
+static int write_json(const NexusTrace *trace, int channel, const char *filename)
+{
+    FILE *fp = fopen(filename, "w");
+    if (!fp)
+    {
+        perror(filename);
+        return 0;
+    }
+
+    bool first = true;
+    fprintf(fp, "{\"traceEvents\":[");
+    for (int ch = 0; ch < MAX_CHANNELS; ch++)
+    {
+        if (channel >= 0 && ch != channel)
+        {
+            continue;
+        }
+        for (int slot = 0; slot < NEXUS_TRACE_RINGLEN; slot++)
+        {
+            NexusTraceEntry entry;
+            if (!read_entry(trace, ch, slot, &entry))
+            {
+                continue;
+            }
+            int64_t start, end;
+            span_times(&entry, 0, 0, SpanPublish, &start, &end);
+            write_json_event(fp, &first, span_names[SpanPublish], ch, 0, entry.frame, start, end);
+
+            for (int rec = 0; rec < MAX_RECORDERS; rec++)
+            {
+                for (int enc = 0; enc < MAX_ENCODES_PER_CHANNEL; enc++)
+                {
+                    for (int s = SpanQueue; s < SpanTotal; s++)
+                    {
+                        span_times(&entry, rec, enc, (Span)s, &start, &end);
+                        write_json_event(fp, &first, span_names[s], ch, 1 + rec * MAX_ENCODES_PER_CHANNEL + enc,
+                                         entry.frame, start, end);
+                    }
+                }
+            }
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+
+    return 1;
+}
+
+extern int main(int argc, char *argv[])
+{
+    int             channel = -1;
+    int             interval = 5;
+    const char      *json_filename = NULL;
+
+    int n;
+    for (n = 1; n < argc; n++)
+    {
+        if (strcmp(argv[n], "-h") == 0 || strcmp(argv[n], "--help") == 0)
+        {
+            usage_exit();
+        }
+        else if (strcmp(argv[n], "-v") == 0)
+        {
+            verbose++;
+        }
+        else if (strcmp(argv[n], "-c") == 0)
+        {
+            if (n + 1 >= argc || sscanf(argv[n+1], "%d", &channel) != 1 || channel < 0 || channel >= MAX_CHANNELS)
+                usage_exit();
+            n++;
+        }
+        else if (strcmp(argv[n], "-i") == 0)
+        {
+            if (n + 1 >= argc || sscanf(argv[n+1], "%d", &interval) != 1 || interval < 1)
+                usage_exit();
+            n++;
+        }
+        else if (strcmp(argv[n], "-j") == 0)
+        {
+            if (n + 1 >= argc)
+                usage_exit();
+            json_filename = argv[n+1];
+            n++;
+        }
+        else
+        {
+            usage_exit();
+        }
+    }
+
+    // If shared memory not found, sleep and try again
+    printf("Waiting for trace shared memory... ");
+    fflush(stdout);
+
+    NexusTrace *trace;
+    while ((trace = nexus_trace_attach(1)) == NULL)
+    {
+        usleep(20 * 1000);
+    }
+    printf("connected\n");
+
+    if (json_filename)
+    {
+        int res = write_json(trace, channel, json_filename);
+        nexus_trace_detach(trace);
+        return res ? 0 : 1;
+    }
+
+    // Frame last accumulated for each encode so entries are only counted once
+    static int last_frame[MAX_CHANNELS][MAX_RECORDERS][MAX_ENCODES_PER_CHANNEL];
+    for (int ch = 0; ch < MAX_CHANNELS; ch++)
+        for (int rec = 0; rec < MAX_RECORDERS; rec++)
+            for (int enc = 0; enc < MAX_ENCODES_PER_CHANNEL; enc++)
+                last_frame[ch][rec][enc] = -1;
+
+    static std::vector<int64_t> samples[MAX_CHANNELS][MAX_RECORDERS][MAX_ENCODES_PER_CHANNEL][NumSpans];
+
+    // Poll more often than the ring wraps so no completed frames are missed
+    const int polls_per_interval = interval * 10;
+    while (1)
+    {
+        for (int poll = 0; poll < polls_per_interval; poll++)
+        {
+            usleep(100 * 1000);
+
+            for (int ch = 0; ch < MAX_CHANNELS; ch++)
+            {
+                if (channel >= 0 && ch != channel)
+                {
+                    continue;
+                }
+                // Visit the ring oldest frame first so last_frame only moves forwards
+                int newest = -1;
+                for (int slot = 0; slot < NEXUS_TRACE_RINGLEN; slot++)
+                {
+                    newest = std::max(newest, trace->entry[ch][slot].frame);
+                }
+                for (int frame = std::max(0, newest - NEXUS_TRACE_RINGLEN + 1); frame <= newest; frame++)
+                {
+                    NexusTraceEntry entry;
+                    if (!read_entry(trace, ch, frame % NEXUS_TRACE_RINGLEN, &entry) || entry.frame != frame)
+                    {
+                        continue;
+                    }
+                    for (int rec = 0; rec < MAX_RECORDERS; rec++)
+                    {
+                        for (int enc = 0; enc < MAX_ENCODES_PER_CHANNEL; enc++)
+                        {
+                            // Only count frames which have been completely written
+                            if (entry.encode[rec][enc][NexusTraceWriteComplete] == 0 ||
+                                entry.frame <= last_frame[ch][rec][enc])
+                            {
+                                continue;
+                            }
+                            last_frame[ch][rec][enc] = entry.frame;
+
+                            for (int s = 0; s < NumSpans; s++)
+                            {
+                                int64_t start, end;
+                                span_times(&entry, rec, enc, (Span)s, &start, &end);
+                                if (start != 0 && end != 0 && end >= start)
+                                {
+                                    samples[ch][rec][enc][s].push_back(end - start);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        for (int ch = 0; ch < MAX_CHANNELS; ch++)
+        {
+            for (int rec = 0; rec < MAX_RECORDERS; rec++)
+            {
+                for (int enc = 0; enc < MAX_ENCODES_PER_CHANNEL; enc++)
+                {
+                    if (!samples[ch][rec][enc][SpanWrite].empty())
+                    {
+                        print_stats(ch, rec, enc, samples[ch][rec][enc]);
+                    }
+                }
+            }
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    return 0;
+}
@@ -40,6 +40,7 @@
 #include <string.h>
 #include <limits.h>
 #include <assert.h>
+#include <unistd.h>
 
 #include "mjpeg_compress.h"
 #include "yuvlib/YUV_scale_pic.h"
@@ -672,6 +673,19 @@ static void set_jpeg_last_size(uint8_t *jpegbuf, int last_size)
     storeUInt32_BE(jpegbuf + 31, last_size);     // store last_size
 }
 
+extern int mjpeg_link_frame(unsigned char *frame, unsigned frame_size, int last_size)
+{
+    // first field size is stored in the Avid APP0 marker data at offset 12
+    unsigned first_size = ((unsigned)frame[12] << 24) | ((unsigned)frame[13] << 16) |
+                          ((unsigned)frame[14] << 8) | (unsigned)frame[15];
+
+    set_jpeg_last_size(frame, last_size);
+
+    if (first_size == 0 || first_size >= frame_size)
+        return frame_size;              // single field
+    return frame_size - first_size;
+}
+
 static void *mjpeg_compress_worker_thread(void *p_obj);
 
 extern int mjpeg_compress_init_threaded(MJPEGResolutionID id, int width, int height, mjpeg_compress_threaded_t **pp_handle)
@@ -826,3 +840,217 @@ extern int mjpeg_compress_free_threaded(mjpeg_compress_threaded_t *p)
 	free(p);
     return 1;
 }
+
+
+static void *mjpeg_compress_pool_worker_thread(void *p_obj);
+
+extern int mjpeg_compress_pool_init(int num_threads, mjpeg_compress_pool_t **pp_pool)
+{
+    if (num_threads <= 0) {
+        num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (num_threads <= 0)
+            num_threads = 2;
+    }
+
+    mjpeg_compress_pool_t *pool = (mjpeg_compress_pool_t *)malloc(sizeof(mjpeg_compress_pool_t));
+    if (!pool)
+        return 0;
+    pool->thread_ids = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+    if (!pool->thread_ids) {
+        free(pool);
+        return 0;
+    }
+    pool->num_threads = 0;
+    pool->queue_head = NULL;
+    pool->queue_tail = NULL;
+    pool->stop = 0;
+    pthread_mutex_init(&pool->m_queue, NULL);
+    pthread_cond_init(&pool->queue_change, NULL);
+
+    int i;
+    for (i = 0; i < num_threads; i++) {
+        int res;
+        if ((res = pthread_create(&pool->thread_ids[i], NULL, mjpeg_compress_pool_worker_thread, pool)) != 0) {
+            fprintf(stderr, "Failed to create pool worker thread: %s\n", strerror(res));
+            mjpeg_compress_pool_free(pool);
+            return 0;
+        }
+        pool->num_threads++;
+    }
+
+    *pp_pool = pool;
+    return 1;
+}
+
+extern int mjpeg_compress_pool_free(mjpeg_compress_pool_t *pool)
+{
+    pthread_mutex_lock(&pool->m_queue);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->queue_change);
+    pthread_mutex_unlock(&pool->m_queue);
+
+    int i;
+    for (i = 0; i < pool->num_threads; i++)
+        pthread_join(pool->thread_ids[i], NULL);
+
+    pthread_mutex_destroy(&pool->m_queue);
+    pthread_cond_destroy(&pool->queue_change);
+    free(pool->thread_ids);
+    free(pool);
+    return 1;
+}
+
+static void *mjpeg_compress_pool_worker_thread(void *p_obj)
+{
+    mjpeg_compress_pool_t *pool = (mjpeg_compress_pool_t *)p_obj;
+    mjpeg_field_job_t *job;
+
+    while (1) {
+        /* wait for the next field to compress */
+        pthread_mutex_lock(&pool->m_queue);
+        while (!pool->stop && !pool->queue_head)
+            pthread_cond_wait(&pool->queue_change, &pool->m_queue);
+        job = pool->queue_head;
+        if (!job) {
+            /* stopped and no jobs left */
+            pthread_mutex_unlock(&pool->m_queue);
+            break;
+        }
+        pool->queue_head = job->next;
+        if (!pool->queue_head)
+            pool->queue_tail = NULL;
+        pthread_mutex_unlock(&pool->m_queue);
+
+        job->compressed_size = mjpeg_compress_field_yuv(job->handle, job->y, job->u, job->v,
+                                                        job->y_linesize, job->u_linesize, job->v_linesize,
+                                                        job->field);
+
+        // reset field_number to 0 to treat as single-field compression
+        ((my_dest_ptr)job->handle->cinfo.dest)->field_number = 0;
+
+        /* signal the encoder that the field is done */
+        mjpeg_compress_pooled_t *encoder = job->encoder;
+        pthread_mutex_lock(&encoder->m_done);
+        encoder->jobs_pending--;
+        pthread_cond_signal(&encoder->done);
+        pthread_mutex_unlock(&encoder->m_done);
+    }
+
+    return NULL;
+}
+
+extern int mjpeg_compress_init_pooled(mjpeg_compress_pool_t *pool, MJPEGResolutionID id, int width, int height,
+                                      mjpeg_compress_pooled_t **pp_handle)
+{
+    mjpeg_compress_pooled_t *p = (mjpeg_compress_pooled_t *)malloc(sizeof(mjpeg_compress_pooled_t));
+    if (!p)
+        return 0;
+    memset(p, 0, sizeof(*p));
+
+    p->pool = pool;
+    if (!mjpeg_compress_init(id, width, height, &p->handle[0])) {
+        free(p);
+        return 0;
+    }
+    p->num_fields = p->handle[0]->single_field ? 1 : 2;
+    if (p->num_fields == 2 && !mjpeg_compress_init(id, width, height, &p->handle[1])) {
+        mjpeg_compress_free(p->handle[0]);
+        free(p);
+        return 0;
+    }
+
+    pthread_mutex_init(&p->m_done, NULL);
+    pthread_cond_init(&p->done, NULL);
+    p->jobs_pending = 0;
+    p->last_size = 0;
+
+    *pp_handle = p;
+    return 1;
+}
+
+extern int mjpeg_compress_free_pooled(mjpeg_compress_pooled_t *p)
+{
+    int i;
+    for (i = 0; i < p->num_fields; i++)
+        mjpeg_compress_free(p->handle[i]);
+
+    pthread_mutex_destroy(&p->m_done);
+    pthread_cond_destroy(&p->done);
+    free(p);
+    return 1;
+}
+
+extern unsigned mjpeg_compress_frame_yuv_pooled(
+                                mjpeg_compress_pooled_t *p,
+                                const unsigned char *y,
+                                const unsigned char *u,
+                                const unsigned char *v,
+                                int y_linesize,
+                                int u_linesize,
+                                int v_linesize,
+                                unsigned char **pp_output)
+{
+    mjpeg_compress_pool_t *pool = p->pool;
+
+    // Setup a job for each field
+    int i;
+    for (i = 0; i < p->num_fields; i++) {
+        mjpeg_field_job_t *job = &p->job[i];
+        job->handle = p->handle[i];
+        job->y = y;
+        job->u = u;
+        job->v = v;
+        job->y_linesize = y_linesize;
+        job->u_linesize = u_linesize;
+        job->v_linesize = v_linesize;
+        job->field = i;
+        job->compressed_size = 0;
+        job->encoder = p;
+        job->next = (i + 1 < p->num_fields ? &p->job[i + 1] : NULL);
+    }
+    p->jobs_pending = p->num_fields;
+
+    // Queue the jobs
+    pthread_mutex_lock(&pool->m_queue);
+    if (pool->queue_tail)
+        pool->queue_tail->next = &p->job[0];
+    else
+        pool->queue_head = &p->job[0];
+    pool->queue_tail = &p->job[p->num_fields - 1];
+    pthread_cond_broadcast(&pool->queue_change);
+    pthread_mutex_unlock(&pool->m_queue);
+
+    // Wait for all fields to be compressed
+    pthread_mutex_lock(&p->m_done);
+    while (p->jobs_pending > 0)
+        pthread_cond_wait(&p->done, &p->m_done);
+    pthread_mutex_unlock(&p->m_done);
+
+    uint8_t *top_buffer = ((my_dest_ptr)p->handle[0]->cinfo.dest)->pair_buffer;
+    int top_size = p->job[0].compressed_size;
+    if (top_size == 0)
+        return 0;
+
+    if (p->num_fields == 1) {
+        // handle[0] is only used for this encoder's frames and so it's
+        // last size metadata is already correct
+        *pp_output = top_buffer;
+        return top_size;
+    }
+
+    int bottom_size = p->job[1].compressed_size;
+    if (bottom_size == 0)
+        return 0;
+
+    // Serialise results by copying bottom field after top field
+    uint8_t *bottom_buffer = ((my_dest_ptr)p->handle[1]->cinfo.dest)->pair_buffer;
+    memcpy(top_buffer + top_size, bottom_buffer, bottom_size);
+
+    // update last_size metadata in JPEG headers
+    set_jpeg_last_size(top_buffer, p->last_size);
+    set_jpeg_last_size(top_buffer + top_size, top_size);
+    p->last_size = bottom_size;
+
+    *pp_output = top_buffer;
+    return top_size + bottom_size;
+}
@@ -135,6 +135,83 @@ extern unsigned mjpeg_compress_frame_yuv_threaded(
                                 int v_linesize,
                                 unsigned char **pp_output);
 
+/* Pooled API uses a pool of worker threads shared by any number of encoders,
+ * e.g. one encoder per recorded channel. Each field is queued as a separate
+ * job so the fields of all channels are spread over the pool threads rather
+ * than each channel having its own fixed pair of threads.
+ * Output is identical to mjpeg_compress_frame_yuv().
+ * - mjpeg_compress_pool_init
+ * - mjpeg_compress_pool_free
+ * - mjpeg_compress_init_pooled
+ * - mjpeg_compress_frame_yuv_pooled
+ * - mjpeg_compress_free_pooled
+ */
+
+struct mjpeg_compress_pooled_t;
+
+typedef struct mjpeg_field_job_t {
+    /* field compression inputs */
+    mjpeg_compress_t *handle;
+    const unsigned char *y;
+    const unsigned char *u;
+    const unsigned char *v;
+    int y_linesize;
+    int u_linesize;
+    int v_linesize;
+    int field;
+
+    /* field compression output */
+    int compressed_size;
+
+    struct mjpeg_compress_pooled_t *encoder;    /* encoder waiting for the job */
+    struct mjpeg_field_job_t *next;             /* next job in the pool queue */
+} mjpeg_field_job_t;
+
+typedef struct mjpeg_compress_pool_t {
+    pthread_t *thread_ids;
+    int num_threads;
+    pthread_mutex_t m_queue;
+    pthread_cond_t queue_change;
+    mjpeg_field_job_t *queue_head;
+    mjpeg_field_job_t *queue_tail;
+    int stop;
+} mjpeg_compress_pool_t;
+
+typedef struct mjpeg_compress_pooled_t {
+    mjpeg_compress_pool_t *pool;
+    mjpeg_compress_t *handle[2];        /* one per field; single-field formats use handle[0] only */
+    mjpeg_field_job_t job[2];
+    int num_fields;
+    pthread_mutex_t m_done;
+    pthread_cond_t done;
+    int jobs_pending;
+    int last_size;                      /* size of the previous frame's bottom field */
+} mjpeg_compress_pooled_t;
+
+/* num_threads <= 0 selects one thread per online CPU */
+extern int mjpeg_compress_pool_init(int num_threads, mjpeg_compress_pool_t **);
+
+/* All encoders using the pool must be freed first */
+extern int mjpeg_compress_pool_free(mjpeg_compress_pool_t *);
+
+extern int mjpeg_compress_init_pooled(mjpeg_compress_pool_t *pool, MJPEGResolutionID id, int width, int height,
+                                      mjpeg_compress_pooled_t **);
+
+extern int mjpeg_compress_free_pooled(mjpeg_compress_pooled_t *);
+
+/* Pooled version of mjpeg_compress_frame_yuv() which blocks until the
+ * pool threads have compressed all fields of the frame
+ */
+extern unsigned mjpeg_compress_frame_yuv_pooled(
+                                mjpeg_compress_pooled_t *p,
+                                const unsigned char *y,
+                                const unsigned char *u,
+                                const unsigned char *v,
+                                int y_linesize,
+                                int u_linesize,
+                                int v_linesize,
+                                unsigned char **pp_output);
+
 /* Convert a 'normal' YUV422 JPEG image into an Avid compatible JPEG */
 extern int mjpeg_fix_jpeg(  const unsigned char *in,
                             int size,
@@ -142,6 +219,13 @@ extern int mjpeg_fix_jpeg(  const unsigned char *in,
                             int resolution_id,
                             unsigned char *out);
 
+/* Set the last size metadata in the first field of an Avid compatible frame
+ * to the size of the last field of the previous frame. This allows frames to
+ * be compressed out of order by separate compressors and linked in order
+ * afterwards. Returns the size of the frame's last field.
+ */
+extern int mjpeg_link_frame(unsigned char *frame, unsigned frame_size, int last_size);
+
 #ifdef __cplusplus
 }
 #endif
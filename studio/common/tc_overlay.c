@@ -22,405 +22,27 @@
  * 02110-1301, USA.
  */
 
-#include <string.h>
 #include <stdlib.h>
 #include "tc_overlay.h"
-
-const uint8_t whiteY = 0xEB;
-const uint8_t whiteU = 0x80;
-const uint8_t whiteV = 0x80;
-
-const uint8_t blackY = 0x10;
-const uint8_t blackU = 0x80;
-const uint8_t blackV = 0x80;
-
-static unsigned char tc_colon[] = {
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x05,0xA6,0xFC,0xFC,0xA3,0x00,0x00,
-0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
-0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
-0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x05,0xA6,0xFC,0xFC,0xA3,0x00,0x00,
-0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
-0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
-0x00,0x00,0x06,0xA8,0xFF,0xFF,0xA5,0x00,0x00,
-};
-
-static unsigned char tc_digit[10][18*24] = {
-{
-0x00,0x00,0x00,0x00,0x00,0x2E,0x99,0xDB,0xF9,0xF9,0xDA,0x99,0x2E,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x81,0xFD,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFC,0x7F,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x80,0xFF,0xFF,0xFF,0xBB,0x7E,0x7F,0xBD,0xFF,0xFF,0xFF,0x7C,0x00,0x00,0x00,
-0x00,0x00,0x35,0xFD,0xFF,0xFA,0x50,0x00,0x00,0x00,0x00,0x53,0xFB,0xFF,0xFD,0x31,0x00,0x00,
-0x00,0x00,0xB6,0xFF,0xFF,0x79,0x00,0x00,0x00,0x00,0x00,0x00,0x7E,0xFF,0xFF,0xB2,0x00,0x00,
-0x00,0x1B,0xFD,0xFF,0xEF,0x0A,0x00,0x00,0x00,0x00,0x00,0x00,0x0C,0xF1,0xFF,0xFD,0x19,0x00,
-0x00,0x64,0xFF,0xFF,0xA3,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xA6,0xFF,0xFF,0x62,0x00,
-0x00,0x9E,0xFF,0xFF,0x67,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x69,0xFF,0xFF,0x9B,0x00,
-0x00,0xC7,0xFF,0xFF,0x3D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3F,0xFF,0xFF,0xC5,0x00,
-0x00,0xE4,0xFF,0xFF,0x21,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x23,0xFF,0xFF,0xE2,0x00,
-0x00,0xF5,0xFF,0xFF,0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x12,0xFF,0xFF,0xF4,0x00,
-0x00,0xFD,0xFF,0xFF,0x09,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0B,0xFF,0xFF,0xFC,0x00,
-0x00,0xFD,0xFF,0xFF,0x09,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0A,0xFF,0xFF,0xFC,0x00,
-0x00,0xF5,0xFF,0xFF,0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x11,0xFF,0xFF,0xF4,0x00,
-0x00,0xE4,0xFF,0xFF,0x21,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x22,0xFF,0xFF,0xE2,0x00,
-0x00,0xC8,0xFF,0xFF,0x3D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3E,0xFF,0xFF,0xC5,0x00,
-0x00,0x9E,0xFF,0xFF,0x66,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x68,0xFF,0xFF,0x9C,0x00,
-0x00,0x65,0xFF,0xFF,0xA2,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xA5,0xFF,0xFF,0x63,0x00,
-0x00,0x1C,0xFE,0xFF,0xEE,0x09,0x00,0x00,0x00,0x00,0x00,0x00,0x0B,0xF1,0xFF,0xFD,0x19,0x00,
-0x00,0x00,0xB7,0xFF,0xFF,0x77,0x00,0x00,0x00,0x00,0x00,0x00,0x7C,0xFF,0xFF,0xB3,0x00,0x00,
-0x00,0x00,0x35,0xFE,0xFF,0xF9,0x4E,0x00,0x00,0x00,0x00,0x51,0xFA,0xFF,0xFD,0x32,0x00,0x00,
-0x00,0x00,0x00,0x81,0xFF,0xFF,0xFF,0xB9,0x7D,0x7E,0xBB,0xFF,0xFF,0xFF,0x7C,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x83,0xFD,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFD,0x80,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x2F,0x9C,0xDC,0xF9,0xF9,0xDC,0x9B,0x2F,0x00,0x00,0x00,0x00,0x00,
-},
-{
-0x00,0x00,0x00,0x0E,0x43,0x7B,0xB2,0xE9,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x88,0xFE,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x9C,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x9C,0xEF,0xBB,0x86,0x50,0x1B,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x11,0x01,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x03,0x74,0x74,0x74,0x74,0x74,0xFF,0xFF,0xFF,0x78,0x74,0x74,0x74,0x74,0x2F,0x00,
-0x00,0x00,0x08,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x68,0x00,
-0x00,0x00,0x08,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x68,0x00,
-},
-{
-0x00,0x00,0x01,0x37,0x7D,0xB5,0xE1,0xF7,0xF7,0xE4,0xB5,0x6F,0x0F,0x00,0x00,0x00,
-0x00,0x00,0x00,0x64,0xE2,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xF0,0x5C,
-0x00,0x00,0x00,0x00,0x00,0xA8,0xFF,0xFF,0xFF,0xD5,0x9D,0x7D,0x7B,0x9D,0xE9,0xFF,
-0xFF,0xFF,0x75,0x00,0x00,0x00,0x00,0xA8,0xF0,0x89,0x25,0x00,0x00,0x00,0x00,0x00,
-0x08,0x96,0xFF,0xFF,0xFC,0x30,0x00,0x00,0x00,0x48,0x0F,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0xB0,0xFF,0xFF,0xA0,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x39,0xFF,0xFF,0xE1,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0F,0xFF,0xFF,0xFB,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1C,0xFF,0xFF,0xF4,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x63,0xFF,0xFF,0xCB,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x06,0xD9,0xFF,
-0xFF,0x79,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x8B,
-0xFF,0xFF,0xEE,0x11,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x57,0xFF,0xFF,0xFF,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x3F,0xF7,0xFF,0xFF,0xA5,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x37,0xF2,0xFF,0xFF,0xBC,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x32,0xEF,0xFF,0xFF,0xC7,0x0B,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x30,0xED,0xFF,0xFF,0xD0,0x10,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x2E,0xEC,0xFF,0xFF,0xD7,0x15,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x2C,0xEB,0xFF,0xFF,0xDD,0x1A,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x2B,0xEA,0xFF,0xFF,0xE2,0x20,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x28,0xE8,0xFF,0xFF,0xE7,0x25,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x25,0xE6,0xFF,0xFF,0xEB,0x2A,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC6,0xFF,0xFF,0xFF,0xA3,
-0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x00,0x00,0x00,0xD0,0xFF,0xFF,
-0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,0x00,0x00,0xD0,
-0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,0x00,
-},
-{
-0x00,0x00,0x24,0x63,0x96,0xC2,0xE3,0xF6,0xFB,0xED,0xCC,0x92,0x34,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0xF8,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xA8,
-0x10,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0xEE,0xB9,0x91,0x7D,0x7A,0x93,0xD3,0xFF,
-0xFF,0xFF,0xCC,0x08,0x00,0x00,0x00,0x00,0x7A,0x30,0x01,0x00,0x00,0x00,0x00,0x00,
-0x00,0x54,0xF6,0xFF,0xFF,0x7A,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x6E,0xFF,0xFF,0xD6,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x17,0xFF,0xFF,0xFD,0x02,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0xFF,0xFF,0xFC,0x01,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x31,0xFF,0xFF,0xD1,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x04,0xB6,0xFF,0xFF,0x6B,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x03,0x19,0x54,0xC9,0xFF,0xFF,
-0xAE,0x02,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xA4,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-0xDE,0x6C,0x02,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xA4,0xFF,0xFF,0xFF,0xFF,
-0xFF,0xFE,0xC0,0x67,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x4A,0x74,0x74,
-0x78,0x8B,0xBD,0xFC,0xFF,0xFF,0xD6,0x24,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x1D,0xB7,0xFF,0xFF,0xE1,0x11,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x04,0xC3,0xFF,0xFF,0x85,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x44,0xFF,0xFF,0xD7,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x13,0xFF,0xFF,
-0xF8,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x16,
-0xFF,0xFF,0xF6,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x4E,0xFF,0xFF,0xD2,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x08,0xCC,0xFF,0xFF,0x87,0x00,0x00,0x93,0x76,0x1A,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x2B,0xC3,0xFF,0xFF,0xEF,0x18,0x00,0x00,0xAC,0xFF,0xFE,0xD0,0xA1,
-0x84,0x77,0x7E,0x97,0xCD,0xFF,0xFF,0xFF,0xF7,0x48,0x00,0x00,0x00,0xA8,0xFF,0xFF,
-0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xCC,0x32,0x00,0x00,0x00,0x00,0x04,
-0x3E,0x80,0xB5,0xDA,0xF2,0xFD,0xFA,0xE8,0xC6,0x8F,0x3F,0x00,0x00,0x00,0x00,0x00,
-},
-{
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3A,0xFE,0xFF,0xFF,0xFF,0x08,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x05,0xD4,0xFF,0xFF,0xFF,0xFF,
-0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x7C,0xFF,0xFE,0xFF,
-0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x25,0xF7,0xFF,
-0x9E,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xBE,
-0xFF,0xED,0x14,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x61,0xFF,0xFF,0x65,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x15,0xED,0xFF,0xC7,0x01,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0xA4,0xFF,0xFC,0x30,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x46,0xFF,0xFF,0x90,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,
-0x00,0x00,0x00,0x00,0x00,0x09,0xDD,0xFF,0xE5,0x0D,0x00,0x00,0x00,0xFF,0xFF,0xFF,
-0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x89,0xFF,0xFF,0x57,0x00,0x00,0x00,0x00,0xFF,
-0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x2E,0xFB,0xFF,0xBA,0x00,0x00,0x00,0x00,
-0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x02,0xC9,0xFF,0xF8,0x25,0x00,0x00,
-0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x6E,0xFF,0xFF,0x82,0x00,
-0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x1C,0xF2,0xFF,0xDD,
-0x08,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x83,0xFF,
-0xFF,0x5D,0x14,0x14,0x14,0x14,0x14,0x14,0x14,0xFF,0xFF,0xFF,0x1B,0x14,0x14,0x07,
-0x88,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-0xFF,0x5C,0x88,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-0xFF,0xFF,0xFF,0x5C,0x33,0x60,0x60,0x60,0x60,0x60,0x60,0x60,0x60,0x60,0x60,0xFF,
-0xFF,0xFF,0x65,0x60,0x60,0x22,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,
-},
-{
-0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x88,0x00,
-0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-0x88,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x78,0x74,0x74,0x74,0x74,0x74,0x74,
-0x74,0x74,0x3D,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x08,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,
-0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0xFF,0xFF,0xFF,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0xFF,0xFF,0xFF,0x1E,0x4A,0x60,0x5B,0x40,0x10,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFC,0xBB,0x3F,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-0xFF,0x8C,0x01,0x00,0x00,0x00,0x00,0x00,0xF4,0xA6,0x60,0x31,0x19,0x17,0x30,0x6E,
-0xD9,0xFF,0xFF,0xFF,0x84,0x00,0x00,0x00,0x00,0x00,0x0D,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x06,0x9C,0xFF,0xFF,0xFC,0x2C,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x02,0xC3,0xFF,0xFF,0x97,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x4C,0xFF,0xFF,0xDA,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x13,0xFF,0xFF,0xFC,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x06,0xFF,0xFF,0xFF,
-0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x22,0xFF,
-0xFF,0xF3,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x71,0xFF,0xFF,0xC5,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x1E,0xEA,0xFF,0xFF,0x73,0x00,0x00,0x00,0xB7,0x4A,0x05,0x00,0x00,0x00,0x00,
-0x00,0x00,0x3F,0xDF,0xFF,0xFF,0xE4,0x0D,0x00,0x00,0x00,0xFC,0xFF,0xF0,0xB9,0x8F,
-0x7C,0x7A,0x92,0xD0,0xFF,0xFF,0xFF,0xF3,0x39,0x00,0x00,0x00,0x00,0xFC,0xFF,0xFF,
-0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xCD,0x2D,0x00,0x00,0x00,0x00,0x00,0x30,
-0x71,0xA5,0xCE,0xEB,0xFA,0xFD,0xEF,0xCF,0x99,0x46,0x01,0x00,0x00,0x00,0x00,0x00,
-},
-{
-0x00,0x00,0x00,0x00,0x00,0x00,0x1C,0x7E,0xC4,0xEC,0xFC,0xF4,0xD7,0xA8,0x67,0x16,
-0x00,0x00,0x00,0x00,0x00,0x00,0x02,0x7C,0xF7,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-0xFF,0x8C,0x00,0x00,0x00,0x00,0x00,0x03,0xA9,0xFF,0xFF,0xFF,0xC8,0x8C,0x77,0x82,
-0xA9,0xE6,0xFF,0x8C,0x00,0x00,0x00,0x00,0x00,0x8D,0xFF,0xFF,0xDA,0x37,0x00,0x00,
-0x00,0x00,0x00,0x01,0x3F,0x51,0x00,0x00,0x00,0x00,0x3A,0xFE,0xFF,0xE2,0x17,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xBE,0xFF,0xFF,0x4C,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x25,0xFF,0xFF,
-0xD4,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x74,
-0xFF,0xFF,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0xAF,0xFF,0xFF,0x42,0x00,0x01,0x33,0x63,0x70,0x61,0x37,0x03,0x00,0x00,0x00,
-0x00,0x00,0x00,0xD7,0xFF,0xFF,0x17,0x46,0xD5,0xFF,0xFF,0xFF,0xFF,0xFF,0xE8,0x74,
-0x03,0x00,0x00,0x00,0x00,0xF1,0xFF,0xFA,0x69,0xFE,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-0xFF,0xFF,0xBD,0x0A,0x00,0x00,0x00,0xFC,0xFF,0xFB,0xFC,0xFF,0xCA,0x4D,0x11,0x07,
-0x2A,0x87,0xFA,0xFF,0xFF,0xA5,0x00,0x00,0x00,0xFD,0xFF,0xFF,0xFF,0xB8,0x06,0x00,
-0x00,0x00,0x00,0x00,0x4C,0xFE,0xFF,0xFF,0x3A,0x00,0x00,0xF5,0xFF,0xFF,0xF9,0x1A,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x9F,0xFF,0xFF,0x9C,0x00,0x00,0xE2,0xFF,0xFF,
-0xB8,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x42,0xFF,0xFF,0xD8,0x00,0x00,0xC5,
-0xFF,0xFF,0x8D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x16,0xFF,0xFF,0xF6,0x00,
-0x00,0x9A,0xFF,0xFF,0x84,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0D,0xFF,0xFF,
-0xFC,0x00,0x00,0x5F,0xFF,0xFF,0x9B,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x25,
-0xFF,0xFF,0xEB,0x00,0x00,0x16,0xFB,0xFF,0xD9,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x64,0xFF,0xFF,0xBD,0x00,0x00,0x00,0xAA,0xFF,0xFF,0x52,0x00,0x00,0x00,0x00,
-0x00,0x00,0x07,0xD6,0xFF,0xFF,0x6D,0x00,0x00,0x00,0x28,0xF9,0xFF,0xEF,0x42,0x00,
-0x00,0x00,0x00,0x0E,0xAF,0xFF,0xFF,0xE5,0x0C,0x00,0x00,0x00,0x00,0x6A,0xFF,0xFF,
-0xFF,0xBF,0x84,0x7A,0x9C,0xEC,0xFF,0xFF,0xF9,0x40,0x00,0x00,0x00,0x00,0x00,0x00,
-0x69,0xF8,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xE6,0x41,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x20,0x8C,0xD2,0xF5,0xFD,0xEC,0xBF,0x6F,0x0C,0x00,0x00,0x00,0x00,
-},
-{
-0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-0xFF,0x00,0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
-0xFF,0xFF,0xEE,0x00,0x00,0x00,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,0x74,
-0x74,0xF1,0xFF,0xFF,0x95,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x2F,0xFF,0xFF,0xFF,0x35,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x8E,0xFF,0xFF,0xD4,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x04,0xE8,0xFF,0xFF,0x75,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x4B,0xFF,0xFF,0xFC,0x19,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xAA,0xFF,0xFF,0xB6,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x10,0xF8,0xFF,0xFF,0x56,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x67,0xFF,0xFF,0xEE,
-0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC6,0xFF,
-0xFF,0x96,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x25,
-0xFF,0xFF,0xFF,0x36,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x83,0xFF,0xFF,0xD5,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x01,0xE0,0xFF,0xFF,0x76,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x41,0xFF,0xFF,0xFC,0x19,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x9F,0xFF,0xFF,0xB7,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0B,0xF3,0xFF,0xFF,0x57,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x5D,0xFF,0xFF,0xEF,0x07,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xBB,0xFF,0xFF,0x97,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1C,0xFD,0xFF,0xFF,
-0x37,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x79,0xFF,
-0xFF,0xD6,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0xD7,0xFF,0xFF,0x77,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x36,0xFF,0xFF,0xFC,0x1A,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0x95,0xFF,0xFF,0xB7,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-},
-{
-0x00,0x00,0x00,0x00,0x05,0x5A,0xB0,0xE2,0xF7,0xF7,0xE2,0xB0,0x5B,0x05,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x24,0xD0,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xD0,
-0x23,0x00,0x00,0x00,0x00,0x00,0x10,0xE0,0xFF,0xFF,0xFB,0xAF,0x7E,0x7E,0xB1,0xFC,
-0xFF,0xFF,0xE0,0x10,0x00,0x00,0x00,0x00,0x86,0xFF,0xFF,0xEF,0x33,0x00,0x00,0x00,
-0x00,0x36,0xF0,0xFF,0xFF,0x85,0x00,0x00,0x00,0x00,0xD9,0xFF,0xFF,0x69,0x00,0x00,
-0x00,0x00,0x00,0x00,0x6B,0xFF,0xFF,0xD8,0x00,0x00,0x00,0x01,0xFB,0xFF,0xFF,0x19,
-0x00,0x00,0x00,0x00,0x00,0x00,0x1B,0xFF,0xFF,0xFB,0x01,0x00,0x00,0x01,0xFD,0xFF,
-0xFF,0x04,0x00,0x00,0x00,0x00,0x00,0x00,0x05,0xFF,0xFF,0xFC,0x01,0x00,0x00,0x00,
-0xD6,0xFF,0xFF,0x19,0x00,0x00,0x00,0x00,0x00,0x00,0x1A,0xFF,0xFF,0xD4,0x00,0x00,
-0x00,0x00,0x78,0xFF,0xFF,0x67,0x00,0x00,0x00,0x00,0x00,0x00,0x69,0xFF,0xFF,0x74,
-0x00,0x00,0x00,0x00,0x07,0xC6,0xFF,0xED,0x30,0x00,0x00,0x00,0x00,0x33,0xEF,0xFF,
-0xC4,0x05,0x00,0x00,0x00,0x00,0x00,0x0B,0x95,0xFA,0xFB,0xAE,0x7D,0x7D,0xAF,0xFC,
-0xFA,0x94,0x0A,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x39,0xA8,0xFF,0xFF,0xFF,0xFF,
-0xFF,0xFF,0xA8,0x39,0x00,0x00,0x00,0x00,0x00,0x00,0x0D,0xAC,0xFF,0xFF,0xFF,0xFF,
-0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xAD,0x0D,0x00,0x00,0x00,0x04,0xC2,0xFF,0xFF,0xEF,
-0x78,0x29,0x08,0x09,0x2A,0x78,0xEF,0xFF,0xFF,0xC2,0x04,0x00,0x00,0x6C,0xFF,0xFF,
-0xE7,0x22,0x00,0x00,0x00,0x00,0x00,0x00,0x22,0xE8,0xFF,0xFF,0x6B,0x00,0x00,0xCA,
-0xFF,0xFF,0x64,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x65,0xFF,0xFF,0xC9,0x00,
-0x00,0xF6,0xFF,0xFF,0x1C,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1D,0xFF,0xFF,
-0xF4,0x00,0x00,0xFB,0xFF,0xFF,0x0E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0F,
-0xFF,0xFF,0xFA,0x00,0x00,0xE1,0xFF,0xFF,0x32,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x35,0xFF,0xFF,0xE0,0x00,0x00,0xA7,0xFF,0xFF,0x9D,0x00,0x00,0x00,0x00,0x00,
-0x00,0x00,0x00,0xA2,0xFF,0xFF,0xA5,0x00,0x00,0x3F,0xFF,0xFF,0xFF,0x81,0x04,0x00,
-0x00,0x00,0x00,0x06,0x88,0xFF,0xFF,0xFF,0x3D,0x00,0x00,0x00,0x98,0xFF,0xFF,0xFF,
-0xE5,0x9C,0x7B,0x7C,0x9D,0xE7,0xFF,0xFF,0xFF,0x94,0x00,0x00,0x00,0x00,0x02,0x80,
-0xFB,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFB,0x7E,0x02,0x00,0x00,0x00,0x00,
-0x00,0x00,0x1F,0x80,0xBF,0xE8,0xF8,0xF8,0xE8,0xBF,0x7F,0x1E,0x00,0x00,0x00,0x00,
-},
-{
-0x00,0x00,0x00,0x00,0x08,0x67,0xBA,0xEA,0xFC,0xF4,0xD0,0x8A,0x20,0x00,0x00,0x00,
-0x00,0x00,0x00,0x00,0x00,0x34,0xDD,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xF7,0x68,
-0x00,0x00,0x00,0x00,0x00,0x00,0x30,0xF2,0xFF,0xFF,0xF0,0xA0,0x7C,0x86,0xC3,0xFF,
-0xFF,0xFF,0x69,0x00,0x00,0x00,0x00,0x05,0xD7,0xFF,0xFF,0xBE,0x14,0x00,0x00,0x00,
-0x00,0x4D,0xF5,0xFF,0xF9,0x27,0x00,0x00,0x00,0x5C,0xFF,0xFF,0xE3,0x0E,0x00,0x00,
-0x00,0x00,0x00,0x00,0x62,0xFF,0xFF,0xA9,0x00,0x00,0x00,0xB0,0xFF,0xFF,0x73,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x02,0xE1,0xFF,0xFA,0x14,0x00,0x00,0xE3,0xFF,0xFF,
-0x2E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x9F,0xFF,0xFF,0x5E,0x00,0x00,0xFB,
-0xFF,0xFF,0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x81,0xFF,0xFF,0x98,0x00,
-0x00,0xFB,0xFF,0xFF,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x80,0xFF,0xFF,
-0xC3,0x00,0x00,0xE7,0xFF,0xFF,0x2B,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x9C,
-0xFF,0xFF,0xE1,0x00,0x00,0xBA,0xFF,0xFF,0x6D,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x01,0xDD,0xFF,0xFF,0xF3,0x00,0x00,0x6C,0xFF,0xFF,0xDC,0x0A,0x00,0x00,0x00,0x00,
-0x00,0x00,0x58,0xFF,0xFF,0xFF,0xFC,0x00,0x00,0x0D,0xE9,0xFF,0xFF,0xB2,0x0D,0x00,
-0x00,0x00,0x00,0x40,0xF0,0xFF,0xFF,0xFF,0xFB,0x00,0x00,0x00,0x4A,0xFC,0xFF,0xFF,
-0xE9,0x93,0x6F,0x78,0xB6,0xFE,0xFF,0xDB,0xF5,0xFF,0xEF,0x00,0x00,0x00,0x00,0x50,
-0xF0,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xD6,0x27,0xFE,0xFF,0xD6,0x00,0x00,0x00,
-0x00,0x00,0x16,0x80,0xCF,0xF8,0xFF,0xFA,0xCC,0x70,0x07,0x2B,0xFF,0xFF,0xAD,0x00,
-0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x09,0x02,0x00,0x00,0x00,0x64,0xFF,0xFF,
-0x73,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xB7,
-0xFF,0xFF,0x25,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x2E,0xFE,0xFF,0xBD,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
-0x00,0x0B,0xCE,0xFF,0xFE,0x39,0x00,0x00,0x00,0x00,0x40,0x25,0x00,0x00,0x00,0x00,
-0x00,0x00,0x2A,0xCA,0xFF,0xFF,0x8D,0x00,0x00,0x00,0x00,0x00,0x90,0xFF,0xD7,0xA0,
-0x80,0x76,0x89,0xC0,0xFD,0xFF,0xFF,0xAA,0x03,0x00,0x00,0x00,0x00,0x00,0x90,0xFF,
-0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xF8,0x7E,0x02,0x00,0x00,0x00,0x00,0x00,0x00,
-0x1E,0x70,0xAE,0xDB,0xF5,0xFD,0xEE,0xC6,0x80,0x1C,0x00,0x00,0x00,0x00,0x00,0x00,
-}
-};
-
-// Timecode is always HH:MM:SS:FF giving a mask 20+20+13+20+20+13+20+20+13+20+20 = 199
-// by 24 pixels high.
-const unsigned int tc_width = 199;
-const unsigned int tc_height = 24;
+#include "video_burn_in_atlas.h"
 
 typedef struct 
 {
-    uint8_t * tc_mask;
-} internal_tc_overlay_t;
-
-typedef struct {
-    uint8_t Hours;
-    uint8_t Minutes;
-    uint8_t Seconds;
-    uint8_t Frames;
-} TimeCode;
-
-
-static TimeCode framesToTC(int frames)
-{
-    TimeCode result;
-
-    frames = frames % (24*60*60*25); // avoid overflow
-
-    result.Frames = frames % 25;
-    result.Hours = (int) (frames / (60 * 60 * 25));
-    result.Minutes = (int) ((frames - (result.Hours * 60 * 60 * 25)) / (60 * 25));
-    result.Seconds = (int) ((frames - (result.Hours * 60 * 60 * 25) - (result.Minutes * 60 * 25)) / 25);
-
-    return result;
-}
-
-static void setup_tc_digit(int x_pos, int digit, unsigned char *p)
-{
-    int i,j;
-    unsigned char *pd = tc_digit[ digit ];
-
-    // each digit is 18x24 pixels
-    for (j = 0; j < 24; j++)
-    {
-        for (i = 0; i < 18; i++)
-        {
-            p[j * 199 + x_pos + i] = *pd++;
-        }
-    }
-}
-
-static void setup_colon(int x_pos, unsigned char *p)
-{
-    int i,j;
-    unsigned char *pd = tc_colon;
-
-    // the colon is 9x24 pixels
-    for (j = 0; j < 24; j++)
-    {
-        for (i = 0; i < 9; i++)
-        {
-            p[j * 199 + x_pos + i] = *pd++;
-        }
-    }
-}
+    BurnInTimecode * bitc;
+    unsigned int width;
+    unsigned int height;
+    tc_pix_fmt_t pix_fmt;
 
+    int hours;
+    int minutes;
+    int seconds;
+    int frames;
+} internal_tc_overlay_t;
 
 
 extern tc_overlay_t * tc_overlay_init()
 {
-    internal_tc_overlay_t * tco = (internal_tc_overlay_t *)malloc(sizeof(internal_tc_overlay_t));
-
-    tco->tc_mask = (uint8_t *)malloc(tc_width * tc_height);
-    if (tco->tc_mask)
-    {
-        memset(tco->tc_mask, 0, tc_width * tc_height);
-    }
+    internal_tc_overlay_t * tco = (internal_tc_overlay_t *)calloc(1, sizeof(internal_tc_overlay_t));
 
     return (tc_overlay_t *)tco;
 }
@@ -430,32 +52,25 @@ extern void tc_overlay_close(tc_overlay_t * in_tco)
     internal_tc_overlay_t * tco = (internal_tc_overlay_t *)in_tco;
     if (tco)
     {
-        free(tco->tc_mask);
+        burn_in_free(tco->bitc);
         free(tco);
     }
 }
 
 extern void tc_overlay_setup(tc_overlay_t * in_tco, int frame_number)
 {
-    TimeCode timecode = framesToTC(frame_number);
-
     internal_tc_overlay_t * tco = (internal_tc_overlay_t *)in_tco;
-    if (!tco || !tco->tc_mask)
+    if (!tco)
     {
         return;
     }
 
-    setup_tc_digit(0, timecode.Hours / 10, tco->tc_mask);
-    setup_tc_digit(20, timecode.Hours % 10, tco->tc_mask);
-    setup_colon(20+20+2, tco->tc_mask);
-    setup_tc_digit(53, timecode.Minutes / 10, tco->tc_mask);
-    setup_tc_digit(73, timecode.Minutes % 10, tco->tc_mask);
-    setup_colon(20+20+13+20+20+2, tco->tc_mask);
-    setup_tc_digit(106, timecode.Seconds / 10, tco->tc_mask);
-    setup_tc_digit(126, timecode.Seconds % 10, tco->tc_mask);
-    setup_colon(20+20+13+20+20+13+20+20+2, tco->tc_mask);
-    setup_tc_digit(159, timecode.Frames / 10, tco->tc_mask);
-    setup_tc_digit(179, timecode.Frames % 10, tco->tc_mask);
+    frame_number = frame_number % (24*60*60*25); // avoid overflow
+
+    tco->frames = frame_number % 25;
+    tco->hours = frame_number / (60 * 60 * 25);
+    tco->minutes = (frame_number / (60 * 25)) % 60;
+    tco->seconds = (frame_number / 25) % 60;
 }
 
 // example offsets: tc_xoffset = 460, tc_yoffset = 30
@@ -465,153 +80,31 @@ extern void tc_overlay_apply(tc_overlay_t * in_tco, uint8_t * y_comp, uint8_t *
                                 unsigned int width, unsigned int height, int tc_xoffset, unsigned int tc_yoffset,
                                 tc_pix_fmt_t pix_fmt)
 {
-    // Suppress unused parameter warning
-    (void) height;
-
     internal_tc_overlay_t * tco = (internal_tc_overlay_t *)in_tco;
 
-    unsigned int i, j;
-    unsigned int hor_chrom_factor, vert_chrom_factor;
-
-    if (!tco || !tco->tc_mask)
+    if (!tco)
     {
         return;
     }
 
-    switch (pix_fmt)
+    // the digit strips are rendered once for the raster and format
+    if (!tco->bitc || width != tco->width || height != tco->height || pix_fmt != tco->pix_fmt)
     {
-    case TC420:
-        hor_chrom_factor = 2;
-        vert_chrom_factor = 2;
-        break;
-    case TC422:
-    default:
-        hor_chrom_factor = 2;
-        vert_chrom_factor = 1;
-        break;
-    }
-
-    y_comp += tc_yoffset * width;
-    u_comp += (tc_yoffset / vert_chrom_factor) * (width / hor_chrom_factor);
-    v_comp += (tc_yoffset / vert_chrom_factor) * (width / hor_chrom_factor);
-
-    // Two lines of black above
-    for (j = 0; j < 2; j++)
-    {
-        for (i = 0; i < tc_width + 2; i++)
-        {
-            int y_idx = i + tc_xoffset-2;
-            y_comp[y_idx] = blackY;
-            if (i % hor_chrom_factor == 0)
-            {
-                int u_idx = y_idx / hor_chrom_factor;
-                int v_idx = y_idx / hor_chrom_factor;
-                u_comp[u_idx] = blackU;
-                v_comp[v_idx] = blackV;
-            }
-        }
-        y_comp += width;
-        if (j % vert_chrom_factor == 0)
+        burn_in_free(tco->bitc);
+        tco->bitc = burn_in_create(width, height, (pix_fmt == TC420 ? BURN_IN_YUV420 : BURN_IN_YUV422),
+                                   BURN_IN_WHITE_ON_BLACK);
+        tco->width = width;
+        tco->height = height;
+        tco->pix_fmt = pix_fmt;
+        if (!tco->bitc)
         {
-            u_comp += (width / hor_chrom_factor);
-            v_comp += (width / hor_chrom_factor);
+            return;
         }
     }
 
-    // The timecode
-    for (j = 0; j < tc_height; j++)
-    {
-        // LH border
-        for (i = 0; i < 2; i++)
-        {
-            int y_idx = i + tc_xoffset - 2;
-            y_comp[y_idx] = blackY;
-            if (i % hor_chrom_factor == 0)
-            {
-                int u_idx = y_idx / hor_chrom_factor;
-                int v_idx = y_idx / hor_chrom_factor;
-                u_comp[u_idx] = blackU;
-                v_comp[v_idx] = blackV;
-            }
-        }
-        // Timecode
-        for (i = 0; i < tc_width; i++)
-        {
-            unsigned char m1 = tco->tc_mask[j*tc_width + i];
-            double      r1 = m1 / 255.0;
-            int y_idx = i + tc_xoffset;
-            int u_idx = y_idx / hor_chrom_factor;
-            int v_idx = y_idx / hor_chrom_factor;
-
-            // make mask 'background' dark
-            // if mask value is low (0x00 - 0x20) reduce Y value
-            if (m1 <= 0x20)
-            {
-                y_comp[y_idx] = y_comp[y_idx] / 8;
-
-                if (i % hor_chrom_factor == 0)
-                {
-                    // Set chroma values to neutral (i.e. no colour)
-                    u_comp[u_idx] = blackU;
-                    v_comp[v_idx] = blackU;
-                }
-            }
-            else
-            {
-                // apply mask by scaling the pixel according to the mask value
-                // Y
-                y_comp[y_idx] = r1 * (whiteY - y_comp[y_idx]) + y_comp[y_idx];
-
-                if (i % hor_chrom_factor == 0)
-                {
-                    // U V
-                    u_comp[u_idx] = r1 * (whiteU - u_comp[u_idx]) + u_comp[u_idx];
-                    v_comp[v_idx] = r1 * (whiteV - v_comp[v_idx]) + v_comp[v_idx];
-                }
-            }
-        }
-        // RH border
-        for (i = tc_width; i < tc_width + 2; i++)
-        {
-            int y_idx = i + tc_xoffset - 2;
-            y_comp[y_idx] = blackY;
-            if (i % hor_chrom_factor == 0)
-            {
-                int u_idx = y_idx / hor_chrom_factor;
-                int v_idx = y_idx / hor_chrom_factor;
-                u_comp[u_idx] = blackU;
-                v_comp[v_idx] = blackV;
-            }
-        }
-        y_comp += width;
-        if (j % vert_chrom_factor == 0)
-        {
-            u_comp += (width / hor_chrom_factor);
-            v_comp += (width / hor_chrom_factor);
-        }
-    }
+    burn_in_set_timecode(tco->bitc, tco->hours, tco->minutes, tco->seconds, tco->frames, 0);
 
-    // Two lines of black below
-    for (j = 0; j < 2; j++)
-    {
-        for (i = 0; i < tc_width + 2; i++)
-        {
-            int y_idx = i + tc_xoffset - 2;
-            y_comp[y_idx] = blackY;
-            if (i % hor_chrom_factor == 0)
-            {
-                int u_idx = y_idx / hor_chrom_factor;
-                int v_idx = y_idx / hor_chrom_factor;
-                u_comp[u_idx] = blackU;
-                v_comp[v_idx] = blackV;
-            }
-        }
-        y_comp += width;
-        if (j % vert_chrom_factor == 0)
-        {
-            u_comp += (width / hor_chrom_factor);
-            v_comp += (width / hor_chrom_factor);
-        }
-    }
+    // the timecode is at the offsets and the box has a 2 pixel border
+    burn_in_apply(tco->bitc, tc_xoffset - 2, tc_yoffset, y_comp, u_comp, v_comp);
 }
 
@@ -9,6 +9,8 @@
 #include <inttypes.h>
 #include <string.h>
 #include <sys/times.h>
+#include <sys/time.h>
+#include <pthread.h>
 #include "mjpeg_compress.h"
 #include "../../../common/video_conversion.h"
 
@@ -19,6 +21,38 @@
 #define mjpeg_compress_free(a) mjpeg_compress_free_threaded(a)
 #endif
 
+typedef struct {
+	mjpeg_compress_pooled_t	*mc;
+	const uint8_t			*y, *u, *v;
+	int						width;
+	int						count;
+	int						result;
+} channel_t;
+
+// Compress the same frame repeatedly to simulate one recorder channel
+static void *channel_thread(void *p_obj)
+{
+	channel_t *ch = (channel_t *)p_obj;
+	uint8_t *outputframe = NULL;
+	int i;
+
+	ch->result = 1;
+	for (i = 0; i < ch->count; i++) {
+		if (mjpeg_compress_frame_yuv_pooled(ch->mc, ch->y, ch->u, ch->v, ch->width, ch->width / 2, ch->width / 2, &outputframe) == 0) {
+			ch->result = 0;
+			break;
+		}
+	}
+	return NULL;
+}
+
+static double time_now(void)
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
 static void usage_exit(void)
 {
     fprintf(stderr, "Usage: yuv422_to_mjpeg [options] input.yuv output.mjpeg\n");
@@ -32,6 +66,9 @@ static void usage_exit(void)
     fprintf(stderr, "                           (default)\n");
     fprintf(stderr, "    -b benchmark-num     read first frame and compress it num times\n");
     fprintf(stderr, "    -u                   input video is UYVY (not YUV planar)\n");
+    fprintf(stderr, "    -p threads           use pooled API with a pool of threads (0 = one per CPU)\n");
+    fprintf(stderr, "    -c channels          with -p and -b, compress first frame num times on each of\n");
+    fprintf(stderr, "                         channels concurrent encoders and report frames per second\n");
 	exit(1);
 }
 
@@ -45,6 +82,8 @@ extern int main(int argc, char *argv[])
 	int					benchmark = 0;		// off by default
 	int					frame_limit = 0;	// off by default
 	int					input_is_uyvy = 0;	// flag to treat input as UYVY
+	int					pool_threads = -1;	// pooled API off by default
+	int					channels = 0;		// multi-channel benchmark off by default
 
 
 	// process command-line args
@@ -77,6 +116,18 @@ extern int main(int argc, char *argv[])
 		{
 			input_is_uyvy = 1;
 		}
+		else if (strcmp(argv[n], "-p") == 0)
+		{
+			if (n + 1 >= argc || sscanf(argv[n+1], "%d", &pool_threads) != 1)
+				usage_exit();
+			n++;
+		}
+		else if (strcmp(argv[n], "-c") == 0)
+		{
+			if (n + 1 >= argc || sscanf(argv[n+1], "%d", &channels) != 1 || channels < 1)
+				usage_exit();
+			n++;
+		}
 		else
 		{
 			if (!input_name)
@@ -94,6 +145,10 @@ extern int main(int argc, char *argv[])
 	if (!input_name || !output_name) {
 		usage_exit();
 	}
+	if (channels > 0 && (pool_threads < 0 || benchmark <= 0)) {
+		fprintf(stderr, "-c requires -p and -b\n");
+		usage_exit();
+	}
 
 	unsigned frame_size = width*height*2;
 
@@ -115,7 +170,20 @@ extern int main(int argc, char *argv[])
 	}
 
 	mjpeg_compress_t *mc = NULL;
-	mjpeg_compress_init((MJPEGResolutionID)resId, width, height, &mc);
+	mjpeg_compress_pool_t *pool = NULL;
+	mjpeg_compress_pooled_t *mc_pooled = NULL;
+	if (pool_threads >= 0) {
+		if (!mjpeg_compress_pool_init(pool_threads, &pool) ||
+			!mjpeg_compress_init_pooled(pool, (MJPEGResolutionID)resId, width, height, &mc_pooled))
+		{
+			fprintf(stderr, "Failed to initialise pooled compressor\n");
+			return 1;
+		}
+		printf("Using pool of %d threads\n", pool->num_threads);
+	}
+	else {
+		mjpeg_compress_init((MJPEGResolutionID)resId, width, height, &mc);
+	}
 
 	int total_bytes = 0;
 	int frame_num = 0;
@@ -145,21 +213,61 @@ extern int main(int argc, char *argv[])
 		uint8_t *outputframe = NULL;
 		unsigned outsize;
 
+		// Run concurrent channels sharing the pool
+		if (channels > 0) {
+			channel_t *ch = (channel_t *)malloc(channels * sizeof(channel_t));
+			pthread_t *ch_ids = (pthread_t *)malloc(channels * sizeof(pthread_t));
+			int c;
+			for (c = 0; c < channels; c++) {
+				ch[c].y = y;
+				ch[c].u = u;
+				ch[c].v = v;
+				ch[c].width = width;
+				ch[c].count = benchmark;
+				if (!mjpeg_compress_init_pooled(pool, (MJPEGResolutionID)resId, width, height, &ch[c].mc)) {
+					fprintf(stderr, "Failed to initialise pooled compressor\n");
+					return 1;
+				}
+			}
+			double start = time_now();
+			for (c = 0; c < channels; c++)
+				pthread_create(&ch_ids[c], NULL, channel_thread, &ch[c]);
+			for (c = 0; c < channels; c++)
+				pthread_join(ch_ids[c], NULL);
+			double elapsed = time_now() - start;
+			for (c = 0; c < channels; c++) {
+				if (!ch[c].result) {
+					fprintf(stderr, "mjpeg_compress_frame_yuv_pooled failed\n");
+					return 1;
+				}
+				mjpeg_compress_free_pooled(ch[c].mc);
+			}
+			printf("resId %d: %d channels x %d frames in %.3fs = %.1f frames/s (%.1f frames/s per channel)\n",
+				resId, channels, benchmark, elapsed,
+				channels * benchmark / elapsed, benchmark / elapsed);
+			free(ch);
+			free(ch_ids);
+		}
+
 		// Compress full frame (or one field depending upon resId)
 		int i = 0;
 		do {
 			//struct tms buf1, buf2;
 			//times(&buf1);
-			if ((outsize = mjpeg_compress_frame_yuv(mc, y, u, v, width, width / 2, width / 2, &outputframe)) == 0) {
+			if (mc_pooled)
+				outsize = mjpeg_compress_frame_yuv_pooled(mc_pooled, y, u, v, width, width / 2, width / 2, &outputframe);
+			else
+				outsize = mjpeg_compress_frame_yuv(mc, y, u, v, width, width / 2, width / 2, &outputframe);
+			if (outsize == 0) {
 				fprintf(stderr, "mjpeg_compress_frame_yuv failed\n");
 				return 1;
 			}
 			//times(&buf2);
-			if (benchmark > 0)
+			if (benchmark > 0 && channels == 0)
 				printf("%d of %d\n", i+1, benchmark);
 				//printf("%d of %d (%ld)\n", i, benchmark, buf2.tms_utime - buf1.tms_utime);
 			i++;
-		} while (i < benchmark);
+		} while (channels == 0 && i < benchmark);
 
 		// Save compressed field to disk
 		if (fwrite(outputframe, 1, outsize, output_fp) < outsize) {
@@ -180,7 +288,13 @@ extern int main(int argc, char *argv[])
 	fclose(input_fp);
 	fclose(output_fp);
 
-	mjpeg_compress_free(mc);
+	if (mc_pooled) {
+		mjpeg_compress_free_pooled(mc_pooled);
+		mjpeg_compress_pool_free(pool);
+	}
+	else {
+		mjpeg_compress_free(mc);
+	}
 
 	free(orig_frame);
 	if (input_is_uyvy)
@@ -37,6 +37,10 @@
 #include <cassert>
 #include <memory>
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
 #include <libMXF++/MXF.h>
 #include <libMXF++/extensions/TaggedValue.h>
 
@@ -91,6 +95,11 @@ static const char *ERROR_STRINGS[] =
 #define ERROR_STRINGS_SIZE  (sizeof(ERROR_STRINGS) / sizeof(char*))
 
 
+// size of the initial read by readBuffered, which is large enough for the header partition of Ingex OP-Atom files
+#define HEADER_READ_SIZE        (256 * 1024)
+#define MAX_HEADER_READ_SIZE    (64 * 1024 * 1024)
+
+
 typedef struct
 {
     const mxfUL container_label;
@@ -261,12 +270,109 @@ void convert_color(const RGBColor *color, int *db_color)
 }
 
 
+static int64_t read_data(int fd, uint8_t *data, int64_t offset, int64_t size)
+{
+    int64_t total = 0;
+    ssize_t num_read;
+
+    while (total < size) {
+        num_read = pread(fd, data + total, size - total, offset + total);
+        if (num_read < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        } else if (num_read == 0) {
+            break;
+        }
+        total += num_read;
+    }
+
+    return total;
+}
+
+
 
 
 IngexMXFInfo::ReadResult IngexMXFInfo::read(string filename, IngexMXFInfo **info)
 {
-    ReadResult result = SUCCESS;
     File *mxf_file = 0;
+
+    // open the file
+    try
+    {
+        mxf_file = File::openRead(filename);
+    }
+    catch (...)
+    {
+        return FILE_OPEN_ERROR;
+    }
+
+    ReadResult result = readHeader(filename, mxf_file, -1, 0, info);
+
+    delete mxf_file;
+
+    return result;
+}
+
+IngexMXFInfo::ReadResult IngexMXFInfo::readBuffered(string filename, IngexMXFInfo **info)
+{
+    ReadResult result = FAILED;
+    vector<uint8_t> buffer(HEADER_READ_SIZE);
+    int64_t data_size;
+    int64_t header_end = -1;
+    int fd;
+
+    if ((fd = open(filename.c_str(), O_RDONLY)) < 0)
+        return FILE_OPEN_ERROR;
+
+    data_size = read_data(fd, &buffer[0], 0, buffer.size());
+    if (data_size >= 0) {
+        result = readMemoryHeader(filename, &buffer[0], data_size, &header_end, info);
+
+        // read the remainder if the header metadata extends beyond the initial read
+        if (result != SUCCESS && data_size == (int64_t)buffer.size() &&
+            header_end > data_size && header_end <= MAX_HEADER_READ_SIZE)
+        {
+            buffer.resize(header_end);
+            int64_t remainder_size = read_data(fd, &buffer[data_size], data_size, header_end - data_size);
+            if (remainder_size >= 0) {
+                data_size += remainder_size;
+                result = readMemoryHeader(filename, &buffer[0], data_size, &header_end, info);
+            }
+        }
+    }
+
+    close(fd);
+
+    // fall back to reading from the file if the header partition could extend beyond the data read above,
+    // e.g. the partition pack is preceded by a large run-in
+    if (result != SUCCESS && data_size == (int64_t)buffer.size() &&
+        (result == FAILED || result == NO_HEADER_PARTITION || result == HEADER_ERROR))
+    {
+        result = read(filename, info);
+    }
+
+    return result;
+}
+
+IngexMXFInfo::ReadResult IngexMXFInfo::readMemoryHeader(string filename, const uint8_t *data, int64_t data_size,
+                                                        int64_t *header_end, IngexMXFInfo **info)
+{
+    MXFFile *c_mxf_file;
+    if (!mxf_byte_array_wrap_read(data, data_size, &c_mxf_file))
+        return FAILED;
+
+    File *mxf_file = new File(c_mxf_file);
+    ReadResult result = readHeader(filename, mxf_file, data_size, header_end, info);
+    delete mxf_file;
+
+    return result;
+}
+
+IngexMXFInfo::ReadResult IngexMXFInfo::readHeader(string filename, File *mxf_file, int64_t data_size,
+                                                  int64_t *header_end, IngexMXFInfo **info)
+{
+    ReadResult result = SUCCESS;
     Partition *header_partition = 0;
     AvidHeaderMetadata *header_metadata = 0;
     DataModel *data_model = 0;
@@ -277,16 +383,6 @@ IngexMXFInfo::ReadResult IngexMXFInfo::read(string filename, IngexMXFInfo **info
 
     try
     {
-        // open the file
-        try
-        {
-            mxf_file = File::openRead(filename);
-        }
-        catch (...)
-        {
-            throw FILE_OPEN_ERROR;
-        }
-        
         // read the header partition pack and check the operational pattern
         header_partition = Partition::findAndReadHeaderPartition(mxf_file);
         if (!header_partition)
@@ -308,6 +404,14 @@ IngexMXFInfo::ReadResult IngexMXFInfo::read(string filename, IngexMXFInfo **info
         mxf_file->readNextNonFillerKL(&key, &llen, &len);
         if (!mxf_is_header_metadata(&key))
             throw HEADER_ERROR;
+
+        // check the header metadata is available if only part of the file was read
+        if (header_end) {
+            *header_end = mxf_file->tell() - mxfKey_extlen - llen + header_partition->getHeaderByteCount();
+            if (data_size >= 0 && *header_end > data_size)
+                throw FAILED;
+        }
+
         header_metadata->read(mxf_file, header_partition, &key, llen, len);
         
         
@@ -325,7 +429,6 @@ IngexMXFInfo::ReadResult IngexMXFInfo::read(string filename, IngexMXFInfo **info
     delete header_partition;
     delete header_metadata;
     delete data_model;
-    delete mxf_file;
     
     return result;
 }
@@ -784,3 +887,111 @@ prodauto::SourcePackage* IngexMXFInfo::getCurrentFileSourcePackage()
     return _package_group->GetFileSourcePackages().back();
 }
 
+
+
+
+
+IngexMXFInfoBatch::IngexMXFInfoBatch(const vector<string> &filenames, int num_threads, size_t max_pending)
+{
+    _filenames = filenames;
+    _maxPending = (max_pending > 0 ? max_pending : 1);
+    _nextFile = 0;
+    _numReturned = 0;
+    _stop = false;
+
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_resultCond, NULL);
+    pthread_cond_init(&_spaceCond, NULL);
+
+    int i;
+    for (i = 0; i < num_threads && (size_t)i < _filenames.size(); i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, readThread, this) != 0) {
+            // next() reads the files itself if no threads were started
+            prodauto::Logging::error("Failed to create MXF info read thread\n");
+            break;
+        }
+        _threads.push_back(thread);
+    }
+}
+
+IngexMXFInfoBatch::~IngexMXFInfoBatch()
+{
+    pthread_mutex_lock(&_mutex);
+    _stop = true;
+    pthread_cond_broadcast(&_spaceCond);
+    pthread_mutex_unlock(&_mutex);
+
+    size_t i;
+    for (i = 0; i < _threads.size(); i++)
+        pthread_join(_threads[i], NULL);
+
+    for (i = 0; i < _pending.size(); i++)
+        delete _pending[i].info;
+
+    pthread_cond_destroy(&_spaceCond);
+    pthread_cond_destroy(&_resultCond);
+    pthread_mutex_destroy(&_mutex);
+}
+
+bool IngexMXFInfoBatch::next(string *filename, IngexMXFInfo::ReadResult *result, IngexMXFInfo **info)
+{
+    Result next_result;
+
+    if (_numReturned >= _filenames.size())
+        return false;
+
+    if (_threads.empty()) {
+        next_result.file_index = _nextFile++;
+        next_result.info = 0;
+        next_result.result = IngexMXFInfo::readBuffered(_filenames[next_result.file_index], &next_result.info);
+    } else {
+        pthread_mutex_lock(&_mutex);
+        while (_pending.empty())
+            pthread_cond_wait(&_resultCond, &_mutex);
+        next_result = _pending.front();
+        _pending.pop_front();
+        pthread_cond_signal(&_spaceCond);
+        pthread_mutex_unlock(&_mutex);
+    }
+
+    _numReturned++;
+
+    *filename = _filenames[next_result.file_index];
+    *result = next_result.result;
+    *info = (next_result.result == IngexMXFInfo::SUCCESS ? next_result.info : 0);
+    return true;
+}
+
+void* IngexMXFInfoBatch::readThread(void *arg)
+{
+    static_cast<IngexMXFInfoBatch*>(arg)->readFiles();
+    return NULL;
+}
+
+void IngexMXFInfoBatch::readFiles()
+{
+    Result result;
+
+    while (true) {
+        // take the next file once there is space for its result
+        pthread_mutex_lock(&_mutex);
+        while (!_stop && _pending.size() >= _maxPending)
+            pthread_cond_wait(&_spaceCond, &_mutex);
+        if (_stop || _nextFile >= _filenames.size()) {
+            pthread_mutex_unlock(&_mutex);
+            break;
+        }
+        result.file_index = _nextFile++;
+        pthread_mutex_unlock(&_mutex);
+
+        result.info = 0;
+        result.result = IngexMXFInfo::readBuffered(_filenames[result.file_index], &result.info);
+
+        pthread_mutex_lock(&_mutex);
+        _pending.push_back(result);
+        pthread_cond_signal(&_resultCond);
+        pthread_mutex_unlock(&_mutex);
+    }
+}
+
@@ -29,12 +29,17 @@
 
 
 #include <string>
+#include <vector>
+#include <deque>
+
+#include <pthread.h>
 
 #include <PackageGroup.h>
 
 #include <mxf/mxf_types.h>
 
 namespace mxfpp {
+    class File;
     class HeaderMetadata;
     class DataModel;
     class GenericPackage;
@@ -61,6 +66,9 @@ public:
     
 public:
     static ReadResult read(std::string filename, IngexMXFInfo **info);
+    // reads the header partition into memory with a single large read before parsing it, which avoids
+    // the many small reads made by the file based read() when the files are on network storage
+    static ReadResult readBuffered(std::string filename, IngexMXFInfo **info);
     static ReadResult read(std::string filename, mxfUL *essence_container_label,
                            mxfpp::HeaderMetadata *header_metadata, mxfpp::DataModel *data_model,
                            IngexMXFInfo **info);
@@ -74,6 +82,12 @@ public:
     prodauto::PackageGroup* getPackageGroup() const { return _package_group; }
 
 private:
+    // header_end is set to the end of the header metadata and FAILED is returned if it is beyond data_size
+    static ReadResult readHeader(std::string filename, mxfpp::File *mxf_file, int64_t data_size,
+                                 int64_t *header_end, IngexMXFInfo **info);
+    static ReadResult readMemoryHeader(std::string filename, const uint8_t *data, int64_t data_size,
+                                       int64_t *header_end, IngexMXFInfo **info);
+
     IngexMXFInfo(std::string filename, mxfUL *essence_container_label, mxfpp::HeaderMetadata *header_metadata,
                  mxfpp::DataModel *data_model);
     
@@ -101,5 +115,43 @@ private:
 };
 
 
+// Reads the info for a list of files concurrently using up to num_threads threads. The results are
+// returned in the order the reads complete and reading stops while max_pending results are waiting
+class IngexMXFInfoBatch
+{
+public:
+    IngexMXFInfoBatch(const std::vector<std::string> &filenames, int num_threads, size_t max_pending = 64);
+    ~IngexMXFInfoBatch();
+
+    // waits for the next result and returns false when all results have been returned.
+    // The caller takes ownership of info, which is 0 if result is not SUCCESS
+    bool next(std::string *filename, IngexMXFInfo::ReadResult *result, IngexMXFInfo **info);
+
+private:
+    typedef struct
+    {
+        size_t file_index;
+        IngexMXFInfo::ReadResult result;
+        IngexMXFInfo *info;
+    } Result;
+
+    static void* readThread(void *arg);
+    void readFiles();
+
+private:
+    std::vector<std::string> _filenames;
+    size_t _maxPending;
+    size_t _nextFile;
+    size_t _numReturned;
+    std::deque<Result> _pending;
+    bool _stop;
+
+    std::vector<pthread_t> _threads;
+    pthread_mutex_t _mutex;
+    pthread_cond_t _resultCond;
+    pthread_cond_t _spaceCond;
+};
+
+
 
 #endif
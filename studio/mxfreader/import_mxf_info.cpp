@@ -27,6 +27,7 @@
 #include <cstring>
 #include <string>
 #include <vector>
+#include <memory>
 
 #include <Database.h>
 #include <ProdAutoException.h>
@@ -41,23 +42,30 @@ const char * const DEFAULT_DBNAME = "prodautodb";
 const char * const DEFAULT_DBUSER = "bamzooki";
 const char * const DEFAULT_DBPW = "bamzooki";
 
+const int DEFAULT_NUM_THREADS = 8;
+const size_t DEFAULT_BATCH_SIZE = 100;
 
 
-static bool save_package(prodauto::Database *db, prodauto::Package *package)
+
+static bool save_package(prodauto::Database *db, prodauto::Package *package, prodauto::Transaction *transaction = 0)
 {
     if (!package)
         return false;
  
-    prodauto::Package *exist_package = db->loadPackage(package->uid, false);
+    prodauto::Package *exist_package = db->loadPackage(package->uid, false, transaction);
     if (!exist_package) {
         // ensure the project name has been registered before saving the package
         if (!package->projectName.name.empty())
-            package->projectName = db->loadOrCreateProjectName(package->projectName.name);
+            package->projectName = db->loadOrCreateProjectName(package->projectName.name, transaction);
 
         // save the package
         try {
-            db->savePackage(package);
+            db->savePackage(package, transaction);
         } catch (...) {
+            // the failure has aborted the batch transaction and save_batch will save each file separately
+            if (transaction)
+                throw;
+
             // it might have been created by another process just after loadPackage above
             // check that it can now be loaded
             exist_package = db->loadPackage(package->uid, false);
@@ -76,9 +84,75 @@ static bool save_package(prodauto::Database *db, prodauto::Package *package)
 }
 
 
+static bool save_info(prodauto::Database *db, IngexMXFInfo *info, prodauto::Transaction *transaction = 0)
+{
+    bool have_saved;
+
+    have_saved = save_package(db, info->getPackageGroup()->GetMaterialPackage(), transaction);
+    have_saved = save_package(db, info->getPackageGroup()->GetFileSourcePackages().back(), transaction) || have_saved;
+    have_saved = save_package(db, info->getPackageGroup()->GetTapeSourcePackage(), transaction) || have_saved;
+
+    return have_saved;
+}
+
+static void save_batch(prodauto::Database *db, vector<IngexMXFInfo*> *batch, int *saved_file_count,
+                       int *existing_file_count, int *error_count)
+{
+    if (batch->empty())
+        return;
+
+    // save the batch in a single transaction
+    try {
+        auto_ptr<prodauto::Transaction> transaction(db->getTransaction("ImportMXFInfo"));
+
+        int batch_saved_count = 0;
+        size_t i;
+        for (i = 0; i < batch->size(); i++) {
+            if (save_info(db, (*batch)[i], transaction.get()))
+                batch_saved_count++;
+        }
+
+        transaction->commit();
+
+        *saved_file_count += batch_saved_count;
+        *existing_file_count += (int)batch->size() - batch_saved_count;
+    } catch (...) {
+        // the transaction was aborted, e.g. because another process saved one of the packages. Save each file
+        // in a separate transaction so that the error is limited to the file
+        size_t i;
+        for (i = 0; i < batch->size(); i++) {
+            try {
+                if (save_info(db, (*batch)[i]))
+                    (*saved_file_count)++;
+                else
+                    (*existing_file_count)++;
+            } catch (const prodauto::ProdAutoException &ex) {
+                fprintf(stderr, "Error: failed to register metadata for '%s' with database: %s\n",
+                        (*batch)[i]->getFilename().c_str(), ex.getMessage().c_str());
+                (*error_count)++;
+            } catch (...) {
+                fprintf(stderr, "Error: failed to register metadata for '%s' with database\n",
+                        (*batch)[i]->getFilename().c_str());
+                (*error_count)++;
+            }
+        }
+    }
+
+    size_t i;
+    for (i = 0; i < batch->size(); i++)
+        delete (*batch)[i];
+    batch->clear();
+}
+
+
 static void print_usage(const char *cmd)
 {
-    fprintf(stderr, "Usage: %s --dbhost <host> --dbname <name> --dbuser <user> --dbpw <password> [files]\n", cmd);
+    fprintf(stderr, "Usage: %s --dbhost <host> --dbname <name> --dbuser <user> --dbpw <password>\n"
+                    "         [--threads <num>] [--batch <num>] [files]\n", cmd);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  --threads <num>   Number of threads reading the files (default %d)\n", DEFAULT_NUM_THREADS);
+    fprintf(stderr, "  --batch <num>     Number of files registered per database transaction (default %zu)\n",
+            DEFAULT_BATCH_SIZE);
     fprintf(stderr, "\n");
 }
 
@@ -89,6 +163,8 @@ int main(int argc, const char **argv)
     string dbuser = DEFAULT_DBUSER;
     string dbpw = DEFAULT_DBPW;
     vector<string> file_list;
+    int num_threads = DEFAULT_NUM_THREADS;
+    size_t batch_size = DEFAULT_BATCH_SIZE;
     int cmdln_index;
 
     // parse the command line arguments
@@ -136,6 +212,26 @@ int main(int argc, const char **argv)
             }
             dbpw = argv[cmdln_index];
         }
+        else if (strcmp(argv[cmdln_index], "--threads") == 0)
+        {
+            cmdln_index++;
+            if (cmdln_index >= argc ||
+                sscanf(argv[cmdln_index], "%d", &num_threads) != 1 || num_threads < 1)
+            {
+                print_usage(argv[0]);
+                return -1;
+            }
+        }
+        else if (strcmp(argv[cmdln_index], "--batch") == 0)
+        {
+            cmdln_index++;
+            if (cmdln_index >= argc ||
+                sscanf(argv[cmdln_index], "%zu", &batch_size) != 1 || batch_size < 1)
+            {
+                print_usage(argv[0]);
+                return -1;
+            }
+        }
         else
         {
             file_list.push_back(argv[cmdln_index]);
@@ -150,44 +246,29 @@ int main(int argc, const char **argv)
     int error_count = 0;
     int saved_file_count = 0;
     int existing_file_count = 0;
-    bool have_saved;
 
-    vector<string>::const_iterator iter;
-    for (iter = file_list.begin(); iter != file_list.end(); iter++)
+    // the files are read concurrently and registered with the database in batches as the reads complete
+    IngexMXFInfoBatch reader(file_list, num_threads, 2 * batch_size);
+    vector<IngexMXFInfo*> batch;
+    string filename;
+    IngexMXFInfo::ReadResult result;
+    IngexMXFInfo *info;
+
+    while (reader.next(&filename, &result, &info))
     {
         file_count++;
         
-        IngexMXFInfo *info;
-        IngexMXFInfo::ReadResult result = IngexMXFInfo::read(*iter, &info);
         if (result != IngexMXFInfo::SUCCESS) {
-            fprintf(stderr, "Error '%s': %s\n", (*iter).c_str(), IngexMXFInfo::errorToString(result).c_str());
+            fprintf(stderr, "Error '%s': %s\n", filename.c_str(), IngexMXFInfo::errorToString(result).c_str());
             error_count++;
             continue;
         }
         
-
-        try {
-
-            have_saved = save_package(db, info->getPackageGroup()->GetMaterialPackage());
-            have_saved = save_package(db, info->getPackageGroup()->GetFileSourcePackages().back()) || have_saved;
-            have_saved = save_package(db, info->getPackageGroup()->GetTapeSourcePackage()) || have_saved;
-            
-            if (have_saved)
-                saved_file_count++;
-            else
-                existing_file_count++;
-            
-        } catch (const prodauto::ProdAutoException &ex) {
-            fprintf(stderr, "Error: failed to register metadata with database: %s\n", ex.getMessage().c_str());
-            error_count++;
-        } catch (...) {
-            fprintf(stderr, "Error: failed to register metadata with database\n");
-            error_count++;
-        }
-
-        
-        delete info;
+        batch.push_back(info);
+        if (batch.size() >= batch_size)
+            save_batch(db, &batch, &saved_file_count, &existing_file_count, &error_count);
     }
+    save_batch(db, &batch, &saved_file_count, &existing_file_count, &error_count);
     
     printf("%d files processed\n", file_count);
     printf("%d files saved\n", saved_file_count);
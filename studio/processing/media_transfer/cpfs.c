@@ -21,37 +21,92 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
-/* cpfs.c - "Copy Fast and Slow".  Copies one file to another at "high" (or unlimited) or "low" (or zero) approximate speeds, switchable with signals.  See the usage_exit function. */
+/* cpfs.c - "Copy Fast and Slow".  Copies one or more files to others at "high" (or unlimited) or "low" (or zero) approximate speeds, switchable with signals.  See the usage_exit function.
+ * Each file is copied by a reader thread and a writer thread sharing a ring of large (optionally O_DIRECT) blocks, so reading and writing overlap.  Files are copied concurrently, and the total write rate is limited by a token bucket shared by all the writers. */
 
+#define _GNU_SOURCE /* for O_DIRECT */
 #define _LARGEFILE_SOURCE
 #define _FILE_OFFSET_BITS 64
 #define _LARGEFILE64_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
 #include <sys/time.h>
 #include <sys/stat.h>
 #include <signal.h>
 #include <utime.h>
 #include <string.h>
+#include <pthread.h>
 
-#define BUFSIZE 1024 * 1024 /* if this is too big then the buffer will have to be created on the heap or the program will segfault immediately */
+#include <archive_crc32.h>
+
+#define DEFAULT_BLOCK_SIZE 8192 /* kbytes */
+#define DEFAULT_NUM_BLOCKS 2 /* per file: double-buffered */
+#define ALIGNMENT 4096 /* O_DIRECT buffer address, file offset and transfer size alignment */
 #define ONE_SEC	1000000LL /* # of microseconds in a second */
 
+typedef struct {
+	unsigned char * data;
+	size_t size; /* valid bytes: less than the block size at end of file */
+	int full; /* written by the reader and waiting for the writer */
+} block_t;
+
+typedef struct {
+	const char * src_name;
+	const char * dest_name;
+	int src;
+	int dest;
+	int direct; /* O_DIRECT in use for this file */
+	struct stat src_st;
+	block_t * blocks;
+	uint32_t crc; /* CRC-32 of the source data */
+	int done; /* writer has finished */
+	pthread_mutex_t mutex; /* protects the blocks */
+	pthread_cond_t cond;
+	pthread_t reader_thread;
+	pthread_t writer_thread;
+} copy_t;
+
+void * reader(void *);
+void * writer(void *);
+void verify(copy_t *);
+ssize_t read_fully(const int, unsigned char *, const size_t);
+void bucket_set(const unsigned long long, const int);
+void bucket_take(const size_t);
 void update(const int);
 void handler(const int);
 unsigned long long timediff(struct timeval*, struct timeval*);
 void usage_exit(const char *);
 
 int slow;
-unsigned long slow_rate;
+unsigned long long fast_rate;
+unsigned long long slow_rate;
 int new_mode;
 int signalled = 0; /* used to flag when a signal has been received */
 int alreadyPrinted = 0; /* prevents it leaving an "Opening destination file..." message behind if signalled soon after starting */
-unsigned long long total_written, written_since_sleep, written_this_mode, written_since_display = 0;
-struct stat src_st;
-struct timeval start_time, sleep_time, mode_change_time, display_time;
+unsigned long long total_size, total_written, written_this_mode, written_since_display = 0;
+struct timeval start_time, mode_change_time, display_time;
+
+size_t block_size = DEFAULT_BLOCK_SIZE * 1024;
+int num_blocks = DEFAULT_NUM_BLOCKS;
+int use_direct = 0;
+int print_crc = 0;
+int verify_crc = 0;
+
+/* written counters and file completion */
+pthread_mutex_t progress_mutex = PTHREAD_MUTEX_INITIALIZER;
+int files_done = 0;
+
+/* token bucket limiting the total write rate */
+pthread_mutex_t bucket_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t bucket_cond = PTHREAD_COND_INITIALIZER;
+unsigned long long bucket_rate = 0; /* bytes/sec; zero for unlimited */
+int bucket_stopped = 0;
+double bucket_tokens = 0.;
+struct timeval bucket_time;
 
 int main(int argc, char ** argv) {
 	struct sigaction action = {{0}};
@@ -61,104 +116,348 @@ int main(int argc, char ** argv) {
 		printf("sigaction call failed\n");
 		exit(1);
 	}
-	if (6 != argc) {
+	/* options */
+	int arg = 1;
+	while (arg < argc && '-' == argv[arg][0] && argv[arg][1]) {
+		if (!strcmp(argv[arg], "-b") && arg + 1 < argc && atol(argv[arg + 1]) > 0) {
+			block_size = (size_t) atol(argv[++arg]) * 1024;
+			block_size = (block_size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+		}
+		else if (!strcmp(argv[arg], "-n") && arg + 1 < argc && atoi(argv[arg + 1]) >= 2) {
+			num_blocks = atoi(argv[++arg]);
+		}
+		else if (!strcmp(argv[arg], "-d")) {
+			use_direct = 1;
+		}
+		else if (!strcmp(argv[arg], "-c")) {
+			print_crc = 1;
+		}
+		else if (!strcmp(argv[arg], "-v")) {
+			verify_crc = 1;
+		}
+		else {
+			usage_exit(argv[0]);
+		}
+		arg++;
+	}
+	if (argc - arg < 5 || (argc - arg - 3) % 2) {
 		usage_exit(argv[0]);
 	}
-	slow = atoi(argv[1]);
-	unsigned long fast_rate = atol(argv[2]);
+	slow = atoi(argv[arg]);
+	fast_rate = atol(argv[arg + 1]);
 	fast_rate *= 1024;
-	slow_rate = atol(argv[3]);
+	slow_rate = atol(argv[arg + 2]);
 	slow_rate *= 1024;
-	int src;
-	if (-1 == (src = open(argv[4], O_RDONLY, 0))) {
-		printf("Couldn't open source file '%s' for reading.\n", argv[4]);
-		exit(1);
-	}
-	if (-1 == fstat(src, &src_st)) {
-		printf("Couldn't stat source file '%s'.\n", argv[4]);
-		exit(1);
-	}
-	int dest;
-	printf("Opening destination file... "); /* may take a while if it's overwriting an old one */
-	fflush(stdout);
-	if (-1 == (dest = open(argv[5], O_WRONLY | O_CREAT | O_TRUNC))) { /* setting the mode doesn't seem to work */
-		printf("Couldn't open destination file '%s' for writing.\n", argv[5]);
+	int num_files = (argc - arg - 3) / 2;
+	copy_t * copies = calloc(num_files, sizeof(copy_t));
+	if (!copies) {
+		printf("Couldn't allocate memory.\n");
 		exit(1);
 	}
-	if (-1 == fchmod(dest, src_st.st_mode)) {
-		printf("Couldn't change mode of destination file '%s'.\n", argv[5]);
-		exit(1);
+	int i, j;
+	for (i = 0; i < num_files; i++) {
+		copy_t * c = &copies[i];
+		c->src_name = argv[arg + 3 + i * 2];
+		c->dest_name = argv[arg + 4 + i * 2];
+		c->direct = use_direct;
+		if (-1 == (c->src = open(c->src_name, O_RDONLY | (c->direct ? O_DIRECT : 0), 0))) {
+			if (c->direct && EINVAL == errno && -1 != (c->src = open(c->src_name, O_RDONLY, 0))) {
+				/* file system doesn't support direct I/O */
+				c->direct = 0;
+			}
+			else {
+				printf("Couldn't open source file '%s' for reading.\n", c->src_name);
+				exit(1);
+			}
+		}
+		if (-1 == fstat(c->src, &c->src_st)) {
+			printf("Couldn't stat source file '%s'.\n", c->src_name);
+			exit(1);
+		}
+		if (!c->direct) {
+			posix_fadvise(c->src, 0, 0, POSIX_FADV_SEQUENTIAL);
+		}
+		total_size += c->src_st.st_size;
+		printf("Opening destination file... "); /* may take a while if it's overwriting an old one */
+		fflush(stdout);
+		if (-1 == (c->dest = open(c->dest_name, O_WRONLY | O_CREAT | O_TRUNC | (c->direct ? O_DIRECT : 0)))) { /* setting the mode doesn't seem to work */
+			if (c->direct && EINVAL == errno && -1 != (c->dest = open(c->dest_name, O_WRONLY | O_CREAT | O_TRUNC))) {
+				/* file system doesn't support direct I/O: read can still be direct */
+				fcntl(c->src, F_SETFL, fcntl(c->src, F_GETFL) & ~O_DIRECT);
+				c->direct = 0;
+			}
+			else {
+				printf("Couldn't open destination file '%s' for writing.\n", c->dest_name);
+				exit(1);
+			}
+		}
+		if (-1 == fchmod(c->dest, c->src_st.st_mode)) {
+			printf("Couldn't change mode of destination file '%s'.\n", c->dest_name);
+			exit(1);
+		}
+		/* aligned blocks for direct I/O */
+		if (!(c->blocks = calloc(num_blocks, sizeof(block_t)))) {
+			printf("Couldn't allocate memory.\n");
+			exit(1);
+		}
+		for (j = 0; j < num_blocks; j++) {
+			if (posix_memalign((void **) &c->blocks[j].data, ALIGNMENT, block_size)) {
+				printf("Couldn't allocate %lu bytes of memory.\n", (unsigned long) block_size);
+				exit(1);
+			}
+		}
+		pthread_mutex_init(&c->mutex, NULL);
+		pthread_cond_init(&c->cond, NULL);
 	}
-	char buffer[BUFSIZE];
-	unsigned long long bytes_read = 0;
-	unsigned long long elapsed;
 	gettimeofday(&start_time, NULL);
 	mode_change_time = start_time;
 	display_time = start_time;
-	sleep_time = start_time;
+	bucket_time = start_time;
+	bucket_set(slow ? slow_rate : fast_rate, slow && !slow_rate);
 	update(0);
-	struct timeval now;
-	do {
-		while (slow && !slow_rate && src_st.st_size) { /* copying is stopped */
-			/* wait for a signal */
-			sleep(1);
-			update(0);
-		}
-		/* write the buffer */
-		if (write(dest, buffer, bytes_read) != bytes_read) {
-			printf("Couldn't write to destination file '%s'.\n", argv[5]);
+	/* the copying threads block the signals so that they are handled by this thread */
+	sigset_t signals, old_signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGUSR1);
+	sigaddset(&signals, SIGUSR2);
+	pthread_sigmask(SIG_BLOCK, &signals, &old_signals);
+	for (i = 0; i < num_files; i++) {
+		if (pthread_create(&copies[i].reader_thread, NULL, reader, &copies[i])
+		 || pthread_create(&copies[i].writer_thread, NULL, writer, &copies[i])) {
+			printf("Couldn't start copying threads.\n");
 			exit(1);
 		}
-		/* update counters */
-		written_this_mode += bytes_read;
-		written_since_display += bytes_read;
-		total_written += bytes_read;
+	}
+	pthread_sigmask(SIG_SETMASK, &old_signals, NULL);
+	/* display progress and check for signals until all files have been written */
+	struct timeval now;
+	int done = 0;
+	while (!done) {
+		usleep(ONE_SEC / 10);
+		pthread_mutex_lock(&progress_mutex);
+		done = files_done == num_files;
+		pthread_mutex_unlock(&progress_mutex);
 		gettimeofday(&now, NULL);
-		elapsed = timediff(&now, &display_time);
-		/* display progress and check for signals */
-		if (elapsed > ONE_SEC || total_written == src_st.st_size) {
-			/* time to update: end or at regular intervals */
+		if (signalled || done || timediff(&now, &display_time) > ONE_SEC) {
 			update(0);
 		}
-		/* bandwidth limit */
-		if ((slow && slow_rate) || fast_rate) { /* copying at a limited speed */
-			written_since_sleep += bytes_read;
-			elapsed = timediff(&now, &sleep_time);
-			unsigned long long min_time = (unsigned long long) written_since_sleep * ONE_SEC / (slow ? slow_rate : fast_rate); /* how long (in microseconds) it should take to write what has been written, at the given rate */
-			if (min_time > 100000 + elapsed) { /* more than 0.1s ahead (to avoid inaccurate small waits) */
-				/* sleep and reset measurements */
-				sleep_time = now;
-				written_since_sleep = 0;
-				while (min_time > ONE_SEC + 100000 + elapsed) { /* keep updating during long waits */
-					usleep(ONE_SEC);
-					update(0);
-					min_time -= ONE_SEC;
-				}
-				usleep(min_time - elapsed);
-			}
-			else if (elapsed > min_time) { /* copying more slowly than the bandwidth limit */
-				/* reset measurements to prevent a bandwidth spike being allowed through after a long period of slow transfer */
-				sleep_time = now;
-				written_since_sleep = 0;
-			}
-		}
-	} while ((bytes_read = read(src, &buffer, BUFSIZE)));
+	}
 	printf(".  Flushing buffers...");
 	fflush(stdout);
-	close(src);
-	close(dest);
+	for (i = 0; i < num_files; i++) {
+		pthread_join(copies[i].reader_thread, NULL);
+		pthread_join(copies[i].writer_thread, NULL);
+		close(copies[i].src);
+		close(copies[i].dest);
+	}
 	update(1);
 	printf("                                              \n");
-	/* conserve modification time */
-	struct utimbuf dest_times;
-	dest_times.modtime = src_st.st_mtime;
-	dest_times.actime = src_st.st_mtime;
-	if (-1 == utime(argv[5] , &dest_times)) {
-		printf("\nCouldn't set destination file times.\n");
+	for (i = 0; i < num_files; i++) {
+		if (print_crc || verify_crc) {
+			printf("%08x  %s\n", copies[i].crc, copies[i].dest_name);
+		}
+		/* conserve modification time */
+		struct utimbuf dest_times;
+		dest_times.modtime = copies[i].src_st.st_mtime;
+		dest_times.actime = copies[i].src_st.st_mtime;
+		if (-1 == utime(copies[i].dest_name, &dest_times)) {
+			printf("\nCouldn't set destination file times.\n");
+		}
 	}
 	return 0;
 }
 
+/* fills the blocks from the source file in turn, calculating the checksum */
+void * reader(void * arg) {
+	copy_t * c = (copy_t *) arg;
+	int i = 0;
+	off_t offset = 0;
+	ssize_t bytes_read;
+	do {
+		block_t * b = &c->blocks[i];
+		/* wait for the writer to empty the block */
+		pthread_mutex_lock(&c->mutex);
+		while (b->full) {
+			pthread_cond_wait(&c->cond, &c->mutex);
+		}
+		pthread_mutex_unlock(&c->mutex);
+		if (-1 == (bytes_read = read_fully(c->src, b->data, block_size))) {
+			printf("Couldn't read from source file '%s'.\n", c->src_name);
+			exit(1);
+		}
+		if (print_crc || verify_crc) {
+			c->crc = archive_crc32(c->crc, b->data, bytes_read);
+		}
+		if (!c->direct) {
+			/* don't fill the page cache with data that won't be read again */
+			posix_fadvise(c->src, offset, bytes_read, POSIX_FADV_DONTNEED);
+		}
+		offset += bytes_read;
+		pthread_mutex_lock(&c->mutex);
+		b->size = bytes_read;
+		b->full = 1;
+		pthread_cond_broadcast(&c->cond);
+		pthread_mutex_unlock(&c->mutex);
+		i = (i + 1) % num_blocks;
+	} while (bytes_read == block_size); /* a short block marks the end of the file */
+	return NULL;
+}
+
+/* writes the blocks to the destination file in turn, at the current rate limit */
+void * writer(void * arg) {
+	copy_t * c = (copy_t *) arg;
+	int i = 0;
+	size_t size;
+	do {
+		block_t * b = &c->blocks[i];
+		/* wait for the reader to fill the block */
+		pthread_mutex_lock(&c->mutex);
+		while (!b->full) {
+			pthread_cond_wait(&c->cond, &c->mutex);
+		}
+		pthread_mutex_unlock(&c->mutex);
+		size = b->size;
+		if (size) {
+			bucket_take(size);
+			if (c->direct && size % ALIGNMENT) {
+				/* the final part of the file can't be written directly */
+				fcntl(c->dest, F_SETFL, fcntl(c->dest, F_GETFL) & ~O_DIRECT);
+			}
+			if (write(c->dest, b->data, size) != (ssize_t) size) {
+				printf("Couldn't write to destination file '%s'.\n", c->dest_name);
+				exit(1);
+			}
+		}
+		/* update counters */
+		pthread_mutex_lock(&progress_mutex);
+		written_this_mode += size;
+		written_since_display += size;
+		total_written += size;
+		pthread_mutex_unlock(&progress_mutex);
+		pthread_mutex_lock(&c->mutex);
+		b->full = 0;
+		pthread_cond_broadcast(&c->cond);
+		pthread_mutex_unlock(&c->mutex);
+		i = (i + 1) % num_blocks;
+	} while (size == block_size);
+	if (verify_crc) {
+		verify(c);
+	}
+	pthread_mutex_lock(&progress_mutex);
+	files_done++;
+	pthread_mutex_unlock(&progress_mutex);
+	return NULL;
+}
+
+/* reads the destination file back from the disk and compares its checksum with the source's */
+void verify(copy_t * c) {
+	if (-1 == fdatasync(c->dest)) {
+		printf("Couldn't flush destination file '%s'.\n", c->dest_name);
+		exit(1);
+	}
+	int dest;
+	if (-1 == (dest = open(c->dest_name, O_RDONLY | (c->direct ? O_DIRECT : 0), 0))) {
+		printf("Couldn't open destination file '%s' for verifying.\n", c->dest_name);
+		exit(1);
+	}
+	if (!c->direct) {
+		/* make sure the data comes from the disk */
+		posix_fadvise(dest, 0, 0, POSIX_FADV_DONTNEED);
+	}
+	uint32_t crc = 0;
+	ssize_t bytes_read;
+	do { /* the reader has finished with the blocks */
+		if (-1 == (bytes_read = read_fully(dest, c->blocks[0].data, block_size))) {
+			printf("Couldn't read destination file '%s' for verifying.\n", c->dest_name);
+			exit(1);
+		}
+		crc = archive_crc32(crc, c->blocks[0].data, bytes_read);
+	} while (bytes_read == block_size);
+	close(dest);
+	if (crc != c->crc) {
+		printf("\nChecksum mismatch: '%s' %08x, '%s' %08x.\n", c->src_name, c->crc, c->dest_name, crc);
+		exit(1);
+	}
+}
+
+/* reads until the buffer is full or the end of the file is reached; returns -1 on error */
+ssize_t read_fully(const int fd, unsigned char * buffer, const size_t size) {
+	size_t total = 0;
+	ssize_t bytes_read;
+	while (total < size) {
+		if (-1 == (bytes_read = read(fd, buffer + total, size - total))) {
+			if (EINTR == errno) {
+				continue;
+			}
+			return -1;
+		}
+		if (!bytes_read) {
+			break;
+		}
+		total += bytes_read;
+		if (total % ALIGNMENT && (fcntl(fd, F_GETFL) & O_DIRECT)) {
+			/* a direct read at the now unaligned offset would fail, so read the rest of the file through the page cache */
+			fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+		}
+	}
+	return total;
+}
+
+/* refills the token bucket at the old rate and then changes the rate */
+void bucket_set(const unsigned long long rate, const int stopped) {
+	struct timeval now;
+	pthread_mutex_lock(&bucket_mutex);
+	gettimeofday(&now, NULL);
+	if (bucket_rate && !bucket_stopped) {
+		bucket_tokens += (double) timediff(&now, &bucket_time) * bucket_rate / ONE_SEC;
+	}
+	bucket_time = now;
+	bucket_rate = rate;
+	bucket_stopped = stopped;
+	/* prevent a bandwidth spike after a change of rate */
+	if (bucket_tokens > (double) block_size) {
+		bucket_tokens = block_size;
+	}
+	pthread_cond_broadcast(&bucket_cond);
+	pthread_mutex_unlock(&bucket_mutex);
+}
+
+/* waits until size bytes can be written at the current rate */
+void bucket_take(const size_t size) {
+	struct timeval now;
+	pthread_mutex_lock(&bucket_mutex);
+	for (;;) {
+		if (bucket_stopped) { /* copying is stopped */
+			/* wait for a signal */
+			pthread_cond_wait(&bucket_cond, &bucket_mutex);
+			continue;
+		}
+		if (!bucket_rate) { /* unlimited */
+			break;
+		}
+		/* refill: the capacity allows a burst of a block or 0.1s, whichever is bigger */
+		gettimeofday(&now, NULL);
+		double capacity = bucket_rate / 10 > block_size ? bucket_rate / 10 : block_size;
+		bucket_tokens += (double) timediff(&now, &bucket_time) * bucket_rate / ONE_SEC;
+		if (bucket_tokens > capacity) {
+			bucket_tokens = capacity;
+		}
+		bucket_time = now;
+		if (bucket_tokens >= size) {
+			bucket_tokens -= size;
+			break;
+		}
+		/* wait for the deficit to be refilled, or for a change of rate */
+		unsigned long long wait = (unsigned long long) ((size - bucket_tokens) * ONE_SEC / bucket_rate) + 1;
+		unsigned long long wake = (unsigned long long) now.tv_sec * ONE_SEC + now.tv_usec + wait;
+		struct timespec wake_time;
+		wake_time.tv_sec = wake / ONE_SEC;
+		wake_time.tv_nsec = (wake % ONE_SEC) * 1000;
+		pthread_cond_timedwait(&bucket_cond, &bucket_mutex, &wake_time);
+	}
+	pthread_mutex_unlock(&bucket_mutex);
+}
+
 void update(const int nospeed) {
 	/* check for signals */
 	if (signalled) {
@@ -169,41 +468,47 @@ void update(const int nospeed) {
 				printf("\n"); /* to preserve the previous mode's report */
 			}
 			gettimeofday(&mode_change_time, NULL);
+			pthread_mutex_lock(&progress_mutex);
 			written_this_mode = 0;
-			/* start measuring for bandwidth limit */
-			sleep_time = mode_change_time;
-			written_since_sleep = 0;
+			pthread_mutex_unlock(&progress_mutex);
+			/* change the bandwidth limit */
+			bucket_set(slow ? slow_rate : fast_rate, slow && !slow_rate);
 		}
 	}
 	/* update display */
 	struct timeval now;
 	gettimeofday(&now, NULL);
+	pthread_mutex_lock(&progress_mutex);
+	unsigned long long written = total_written;
+	unsigned long long written_display = written_since_display;
+	unsigned long long written_mode = written_this_mode;
+	written_since_display = 0;
+	pthread_mutex_unlock(&progress_mutex);
 	char speed[10] = "------ ";
 	unsigned long long elapsed = timediff(&now, &display_time);
 	if (nospeed) {
 		strcpy(speed, "");
 	}
 	else if (elapsed) {
-		sprintf(speed, "%7.2f", (float) written_since_display / (1024. * 1024.) / elapsed * ONE_SEC);
+		sprintf(speed, "%7.2f", (float) written_display / (1024. * 1024.) / elapsed * ONE_SEC);
 	}
 	char ave_speed[9] = "----- ";
 	elapsed = timediff(&now, &mode_change_time);
 	if (elapsed) {
-		sprintf(ave_speed, "%6.2f", (float) written_this_mode / (1024. * 1024.) / elapsed * ONE_SEC);
+		sprintf(ave_speed, "%6.2f", (float) written_mode / (1024. * 1024.) / elapsed * ONE_SEC);
 	}
 	printf("\r%s %5dsec %10.2fMB %s%3d%% %s%s%sMB/sec",
 		slow ? (slow_rate ? "SLOW" : "STOP") : "FAST", /* mode */
 		(int) (now.tv_sec - start_time.tv_sec), /* elapsed time */
-		(float) total_written / (1024 * 1024), /* total written in MB */
-		src_st.st_size ? "" : "(empty file) ", /* empty file or not */
-		src_st.st_size ? (int) (total_written * 100 / src_st.st_size) : 100, /* % written */
+		(float) written / (1024 * 1024), /* total written in MB */
+		total_size ? "" : "(empty file) ", /* empty file or not */
+		total_size ? (int) (written * 100 / total_size) : 100, /* % written */
 		speed,
 		nospeed ? "" : "MB/sec; average: ",
 		ave_speed
 	);
 	fflush(stdout);
 	display_time = now;
-	written_since_display = 0;
 	alreadyPrinted = 1;
 }
 
@@ -220,10 +525,17 @@ unsigned long long timediff(struct timeval *time2, struct timeval *time1) {
 }
 
 void usage_exit(const char * name) {
-	printf("Usage: %s <mode> <fast rate> <slow rate> <source file> <dest file>\n", name);
+	printf("Usage: %s [options] <mode> <fast rate> <slow rate> <source file> <dest file> [<source file> <dest file> ...]\n", name);
 	printf("<mode> is numerical and non-zero to start copying no faster than <slow rate> (kbytes/sec) rather than <fast rate> (kbytes/sec).\n");
 	printf("Set <fast rate> to zero to place no restriction on copying speed.\n");
 	printf("<slow rate> can be zero.\n");
 	printf("Send SIGUSR1 to copy at <slow rate> and SIGUSR2 to copy at <fast rate>.\n");
+	printf("Multiple files are copied concurrently and the rates apply to their total.\n");
+	printf("Options:\n");
+	printf("  -b <kbytes>  block size (default %d)\n", DEFAULT_BLOCK_SIZE);
+	printf("  -n <number>  number of blocks in flight per file, at least 2 (default %d)\n", DEFAULT_NUM_BLOCKS);
+	printf("  -d           use direct I/O (O_DIRECT), bypassing the page cache, if the file systems support it\n");
+	printf("  -c           print the CRC-32 of each file\n");
+	printf("  -v           read each destination file back after copying and check its CRC-32 against the source's\n");
 	exit(1);
 }
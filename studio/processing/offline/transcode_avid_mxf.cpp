@@ -32,6 +32,7 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <pthread.h>
 
 extern "C"
 {
@@ -62,8 +63,10 @@ extern "C"
 }
 
 #include <vector>
+#include <deque>
 #include <map>
 #include <string>
+#include <memory>
 
 #include <Database.h>
 #include <MXFOPAtomWriter.h>
@@ -104,8 +107,8 @@ static const prodauto::Interval completedDeleteTime = {0, 0, 15, 0, 0, 0, 0};
 // elapsed time before failed transcode entries are deleted
 static const prodauto::Interval failedDeleteTime = {0, 0, 30, 0, 0, 0, 0};
 
-// Handle to MJPEG compress object
-static mjpeg_compress_t *p_mjpeg_compressor = NULL;
+// avcodec_open and avcodec_close are not thread safe and transcodes run concurrently
+static pthread_mutex_t g_avcodecMutex = PTHREAD_MUTEX_INITIALIZER;
 
 
 
@@ -114,12 +117,12 @@ static mjpeg_compress_t *p_mjpeg_compressor = NULL;
 class MJPEGCompressHolder
 {
 public:
-    MJPEGCompressHolder() : _initialised(false) {}
+    MJPEGCompressHolder() : _compressor(NULL), _initialised(false) {}
     ~MJPEGCompressHolder()
     {
         if (_initialised)
         {
-            mjpeg_compress_free(p_mjpeg_compressor);
+            mjpeg_compress_free(_compressor);
         }
     }
     
@@ -128,12 +131,12 @@ public:
         // free existing compressor if the width or height has changed
         if (_initialised && (width != _width || height != _height))
         {
-            mjpeg_compress_free(p_mjpeg_compressor);
-            p_mjpeg_compressor = NULL;
+            mjpeg_compress_free(_compressor);
+            _compressor = NULL;
             _initialised = false;
         }
         
-        if (!mjpeg_compress_init(MJPEG_20_1, width, height, &p_mjpeg_compressor))
+        if (!mjpeg_compress_init(MJPEG_20_1, width, height, &_compressor))
         {
             return false;
         }
@@ -144,7 +147,13 @@ public:
         return true;
     }
     
+    mjpeg_compress_t* getCompressor()
+    {
+        return _compressor;
+    }
+    
 private:
+    mjpeg_compress_t* _compressor;
     bool _initialised;
     int _width;
     int _height;
@@ -253,7 +262,9 @@ public:
             }
             if (_openedDecoder)
             {
+                pthread_mutex_lock(&g_avcodecMutex);
                 avcodec_close(_dec);
+                pthread_mutex_unlock(&g_avcodecMutex);
             }
             free(_dec);
             free(_decFrame);
@@ -310,7 +321,10 @@ public:
         avcodec_set_dimensions(_dec, width, height);
         _dec->pix_fmt = PIX_FMT_YUV422P;
     
-        if (avcodec_open(_dec, decoder) < 0)
+        pthread_mutex_lock(&g_avcodecMutex);
+        int result = avcodec_open(_dec, decoder);
+        pthread_mutex_unlock(&g_avcodecMutex);
+        if (result < 0)
         {
             return false;
         }
@@ -347,6 +361,9 @@ private:
 
 typedef struct TranscodeAvidMXF TranscodeAvidMXF;
 
+class PipelineFrame;
+class TranscodePipeline;
+
 
 // the names clash with structs in the mxf_metadata (eg MXFTrack) so we put it
 // in another namespace
@@ -374,8 +391,7 @@ typedef struct
     int inputVideoResolutionID;
     int outputVideoResolutionID;
 
-    uint8_t* inputBuffer;
-    uint32_t inputBufferSize;
+    PipelineFrame* pendingFrame;    // frame allocated by the reader and not yet received
 
     
     mxfr::MXFReader* reader;
@@ -388,12 +404,15 @@ struct TranscodeAvidMXF
 {
     bool isPALProject;
     
-    MJPEGCompressHolder mjpeg;
-    
     TranscodeStream streams[MAX_MXF_TRANSCODE_INPUTS];
     int numStreams;
     
-    Decoder* decoder;
+    bool haveTranscodeStream;
+    Decoder::DecoderType decoderType;
+    int width;
+    int height;
+    
+    TranscodePipeline* pipeline;
     
     prodauto::MXFWriter* mxfWriter;
 };
@@ -429,7 +448,7 @@ static inline bool user_quit()
     return false;
 }
 
-static int initialise_transcode(TranscodeAvidMXF* transcode, TranscodeStream* stream, int numFFMPEGThreads)
+static int initialise_transcode(TranscodeAvidMXF* transcode, TranscodeStream* stream)
 {
     // check transcode is supported 
     if (!stream->isVideo || 
@@ -461,7 +480,18 @@ static int initialise_transcode(TranscodeAvidMXF* transcode, TranscodeStream* st
     stream->width = 720;
     stream->height = (transcode->isPALProject ? 576 : 480);
 
-    CHK_ORET(transcode->decoder->initialise(decoderType, numFFMPEGThreads, stream->width, stream->height));
+    // the pipeline workers each have a decoder initialised for the first transcode stream
+    if (transcode->haveTranscodeStream)
+    {
+        CHK_ORET(stream->width == transcode->width && stream->height == transcode->height);
+    }
+    else
+    {
+        transcode->haveTranscodeStream = true;
+        transcode->decoderType = decoderType;
+        transcode->width = stream->width;
+        transcode->height = stream->height;
+    }
     
     return 1;
 }
@@ -469,9 +499,112 @@ static int initialise_transcode(TranscodeAvidMXF* transcode, TranscodeStream* st
 static void free_transcode(TranscodeStream* stream)
 {}
 
-static int transcode_stream(TranscodeStream* stream, uint8_t** buffer, uint32_t* bufferSize)
+
+// A frame read from one of the input streams. Frames are written in read order
+// by the writer thread once a worker has transcoded them (if required)
+class PipelineFrame
+{
+public:
+    enum State
+    {
+        READ,           // waiting for a worker
+        TRANSCODING,    // claimed by a worker
+        DONE            // ready to be written
+    };
+    
+public:
+    PipelineFrame()
+    : streamIndex(0), state(READ), failed(false), inputBuffer(NULL), inputBufferSize(0), inputSize(0),
+    outputBuffer(NULL), outputBufferSize(0), outputSize(0)
+    {}
+    
+    ~PipelineFrame()
+    {
+        SAFE_FREE(&inputBuffer);
+        SAFE_FREE(&outputBuffer);
+    }
+    
+    int streamIndex;
+    State state;
+    bool failed;
+    
+    uint8_t* inputBuffer;
+    uint32_t inputBufferSize;
+    uint32_t inputSize;
+    
+    uint8_t* outputBuffer;
+    uint32_t outputBufferSize;
+    uint32_t outputSize;
+};
+
+// A decode and encode worker thread with its own decoder and MJPEG compressor
+class PipelineWorker
+{
+public:
+    PipelineWorker(TranscodePipeline* pipeline_)
+    : pipeline(pipeline_), started(false)
+    {}
+    
+    TranscodePipeline* pipeline;
+    Decoder decoder;
+    MJPEGCompressHolder mjpeg;
+    pthread_t threadId;
+    bool started;
+};
+
+// Transcode pipeline for a single clip. The reader (the caller) submits frames
+// in read order, a pool of workers decodes and encodes frames in parallel and a
+// writer thread writes the frames in read order
+class TranscodePipeline
+{
+public:
+    TranscodePipeline(TranscodeAvidMXF* transcode);
+    ~TranscodePipeline();
+    
+    bool start(int numWorkers, int numFFMPEGThreads);
+    
+    // blocks until a frame is available; returns NULL if the pipeline has failed
+    PipelineFrame* getFreeFrame(int streamIndex, uint32_t size);
+    void releaseFrame(PipelineFrame* frame);
+    void submit(PipelineFrame* frame, uint32_t size);
+    
+    // waits for all submitted frames to be written
+    bool complete();
+    
+private:
+    void abort();
+    void stop();
+    
+    bool claimFrame(PipelineFrame** frame);
+    void runWorker(PipelineWorker* worker);
+    void runWriter();
+    bool writeFrame(PipelineFrame* frame);
+    
+    static void* workerThread(void* arg);
+    static void* writerThread(void* arg);
+    
+private:
+    TranscodeAvidMXF* _transcode;
+    
+    vector<PipelineWorker*> _workers;
+    pthread_t _writerThreadId;
+    bool _writerStarted;
+    
+    pthread_mutex_t _mutex;
+    pthread_cond_t _frameChange;
+    deque<PipelineFrame*> _queue;       // frames in read order waiting to be written
+    vector<PipelineFrame*> _freeFrames;
+    vector<PipelineFrame*> _allFrames;
+    size_t _maxFrames;
+    bool _stop;
+    bool _failed;
+    
+    int _lastFieldSize[MAX_MXF_TRANSCODE_INPUTS];
+};
+
+
+static int transcode_frame(TranscodeStream* stream, PipelineWorker* worker, PipelineFrame* frame)
 {
-    TranscodeAvidMXF* transcode = stream->listenerData.transcode;
     unsigned char* mjpegBuffer = NULL;
     unsigned int mjpegBufferSize;
     int finished;
@@ -481,27 +614,13 @@ static int transcode_stream(TranscodeStream* stream, uint8_t** buffer, uint32_t*
     unsigned char* v;
     int result;
 
-    // check transcode is supported
-    if (!stream->isVideo ||
-        (stream->inputVideoResolutionID != MaterialResolution::DV50_MXF_ATOM &&
-            stream->inputVideoResolutionID != MaterialResolution::MJPEG21_MXF_ATOM))
-    {
-        fprintf(stderr, "Input essence type not supported for transcode\n");
-        return 0;
-    }
-    if (stream->outputVideoResolutionID != MaterialResolution::MJPEG201_MXF_ATOM)
-    {
-        fprintf(stderr, "Output essence type not supported for transcode\n");
-        return 0;
-    }
-    
     // decode 
 
-    AVCodecContext* dec = transcode->decoder->getDecoder();
-    AVFrame* decFrame = transcode->decoder->getFrame();
+    AVCodecContext* dec = worker->decoder.getDecoder();
+    AVFrame* decFrame = worker->decoder.getFrame();
     
     
-    result = avcodec_decode_video(dec, decFrame, &finished, stream->inputBuffer, stream->inputBufferSize);
+    result = avcodec_decode_video(dec, decFrame, &finished, frame->inputBuffer, frame->inputSize);
     if (result < 0 || !finished) 
     {
         fprintf(stderr, "Error decoding DV video\n");
@@ -550,7 +669,7 @@ static int transcode_stream(TranscodeStream* stream, uint8_t** buffer, uint32_t*
     // encode MJPEG 20:1
 
     mjpegBufferSize = mjpeg_compress_frame_yuv(
-        p_mjpeg_compressor,
+        worker->mjpeg.getCompressor(),
         decFrame->data[0], 
         decFrame->data[1], 
         decFrame->data[2],
@@ -560,88 +679,398 @@ static int transcode_stream(TranscodeStream* stream, uint8_t** buffer, uint32_t*
         &mjpegBuffer);
     CHK_ORET(mjpegBufferSize != 0);
 
-    *buffer = mjpegBuffer;
-    *bufferSize = mjpegBufferSize;
+    // copy out of the compressor's buffer which is reused for the worker's next frame
+    if (frame->outputBufferSize < mjpegBufferSize)
+    {
+        SAFE_FREE(&frame->outputBuffer);
+        frame->outputBufferSize = 0;
+        CHK_MALLOC_ARRAY_ORET(frame->outputBuffer, uint8_t, mjpegBufferSize);
+        frame->outputBufferSize = mjpegBufferSize;
+    }
+    memcpy(frame->outputBuffer, mjpegBuffer, mjpegBufferSize);
+    frame->outputSize = mjpegBufferSize;
+    
     return 1;
 }
 
-static int accept_frame(mxfr::MXFReaderListener* listener, int trackIndex)
+
+TranscodePipeline::TranscodePipeline(TranscodeAvidMXF* transcode)
+: _transcode(transcode), _writerStarted(false), _maxFrames(0), _stop(false), _failed(false)
 {
-    // only single track expected 
-    return trackIndex == 0;
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_frameChange, NULL);
+    memset(_lastFieldSize, 0, sizeof(_lastFieldSize));
 }
 
-static int allocate_buffer(mxfr::MXFReaderListener* listener, int trackIndex, uint8_t** buffer, uint32_t bufferSize)
+TranscodePipeline::~TranscodePipeline()
 {
-    TranscodeAvidMXF* transcode = listener->data->transcode;
-    TranscodeStream* stream = &transcode->streams[listener->data->streamIndex];
+    abort();
     
-    // only single track expected 
-    if (trackIndex != 0)
+    size_t i;
+    for (i = 0; i < _workers.size(); i++)
     {
-        return 0;
+        delete _workers[i];
     }
-    
-    if (stream->inputBufferSize < bufferSize)
+    for (i = 0; i < _allFrames.size(); i++)
     {
-        SAFE_FREE(&stream->inputBuffer);
-        stream->inputBufferSize = bufferSize + FF_INPUT_BUFFER_PADDING_SIZE;
-        CHK_MALLOC_ARRAY_ORET(stream->inputBuffer, uint8_t, stream->inputBufferSize);
+        delete _allFrames[i];
     }
     
-    *buffer = stream->inputBuffer;
-    return 1;
+    pthread_cond_destroy(&_frameChange);
+    pthread_mutex_destroy(&_mutex);
 }
 
-static void deallocate_buffer(mxfr::MXFReaderListener* listener, int trackIndex, uint8_t** buffer)
+bool TranscodePipeline::start(int numWorkers, int numFFMPEGThreads)
 {
-    // ignore request because buffer is reused 
+    int i;
+    
+    // workers are only needed if there is something to transcode
+    if (!_transcode->haveTranscodeStream)
+    {
+        numWorkers = 0;
+    }
+    
+    // allow each worker to have 2 frames in progress per stream
+    _maxFrames = (numWorkers * 2 + 2) * _transcode->numStreams;
+    
+    for (i = 0; i < numWorkers; i++)
+    {
+        PipelineWorker* worker = new PipelineWorker(this);
+        _workers.push_back(worker);
+        
+        CHK_ORET(worker->decoder.initialise(_transcode->decoderType, numFFMPEGThreads,
+                                            _transcode->width, _transcode->height));
+        CHK_ORET(worker->mjpeg.initialise(_transcode->width, _transcode->height));
+        
+        CHK_ORET(pthread_create(&worker->threadId, NULL, workerThread, worker) == 0);
+        worker->started = true;
+    }
+    
+    CHK_ORET(pthread_create(&_writerThreadId, NULL, writerThread, this) == 0);
+    _writerStarted = true;
+    
+    return true;
 }
 
-static int receive_frame(mxfr::MXFReaderListener* listener, int trackIndex, uint8_t* buffer, uint32_t bufferSize)
+PipelineFrame* TranscodePipeline::getFreeFrame(int streamIndex, uint32_t size)
 {
-    TranscodeAvidMXF* transcode = listener->data->transcode;
-    TranscodeStream* stream = &listener->data->transcode->streams[listener->data->streamIndex];
-    uint8_t* outputBuffer = NULL;
-    uint32_t outputBufferSize = 0;
+    PipelineFrame* frame = NULL;
     
-    // only single track expected 
-    if (trackIndex != 0)
+    pthread_mutex_lock(&_mutex);
+    while (!_failed && _freeFrames.empty() && _allFrames.size() >= _maxFrames)
     {
-        return 0;
+        pthread_cond_wait(&_frameChange, &_mutex);
+    }
+    if (!_failed)
+    {
+        if (!_freeFrames.empty())
+        {
+            frame = _freeFrames.back();
+            _freeFrames.pop_back();
+        }
+        else
+        {
+            frame = new PipelineFrame();
+            _allFrames.push_back(frame);
+        }
     }
+    pthread_mutex_unlock(&_mutex);
     
-    CHK_ORET(stream->inputBufferSize >= bufferSize);
+    if (!frame)
+    {
+        return NULL;
+    }
     
-    if (!stream->requireTranscode)
+    if (frame->inputBufferSize < size + FF_INPUT_BUFFER_PADDING_SIZE)
     {
-        // no transcode required     
-        outputBuffer = stream->inputBuffer;
-        outputBufferSize = bufferSize;
+        SAFE_FREE(&frame->inputBuffer);
+        frame->inputBufferSize = 0;
+        if ((frame->inputBuffer = (uint8_t*)malloc(size + FF_INPUT_BUFFER_PADDING_SIZE)) == NULL)
+        {
+            mxf_log_error("Failed to allocate transcode input buffer\n");
+            releaseFrame(frame);
+            return NULL;
+        }
+        frame->inputBufferSize = size + FF_INPUT_BUFFER_PADDING_SIZE;
+    }
+    
+    frame->streamIndex = streamIndex;
+    frame->state = PipelineFrame::READ;
+    frame->failed = false;
+    frame->inputSize = 0;
+    frame->outputSize = 0;
+    
+    return frame;
+}
+
+void TranscodePipeline::releaseFrame(PipelineFrame* frame)
+{
+    pthread_mutex_lock(&_mutex);
+    _freeFrames.push_back(frame);
+    pthread_cond_broadcast(&_frameChange);
+    pthread_mutex_unlock(&_mutex);
+}
+
+void TranscodePipeline::submit(PipelineFrame* frame, uint32_t size)
+{
+    frame->inputSize = size;
+    
+    // frames that don't require a transcode are copied directly to the output
+    if (_transcode->streams[frame->streamIndex].requireTranscode)
+    {
+        frame->state = PipelineFrame::READ;
     }
     else
     {
-        CHK_ORET(transcode_stream(stream, &outputBuffer, &outputBufferSize));
+        frame->state = PipelineFrame::DONE;
     }
     
+    pthread_mutex_lock(&_mutex);
+    _queue.push_back(frame);
+    pthread_cond_broadcast(&_frameChange);
+    pthread_mutex_unlock(&_mutex);
+}
+
+bool TranscodePipeline::complete()
+{
+    stop();
+    
+    return !_failed;
+}
+
+void TranscodePipeline::abort()
+{
+    pthread_mutex_lock(&_mutex);
+    _failed = true;
+    pthread_cond_broadcast(&_frameChange);
+    pthread_mutex_unlock(&_mutex);
+    
+    stop();
+}
 
-    if (stream->isVideo)
+void TranscodePipeline::stop()
+{
+    pthread_mutex_lock(&_mutex);
+    _stop = true;
+    pthread_cond_broadcast(&_frameChange);
+    pthread_mutex_unlock(&_mutex);
+    
+    size_t i;
+    for (i = 0; i < _workers.size(); i++)
+    {
+        if (_workers[i]->started)
+        {
+            pthread_join(_workers[i]->threadId, NULL);
+            _workers[i]->started = false;
+        }
+    }
+    if (_writerStarted)
     {
-        transcode->mxfWriter->WriteSamples(stream->materialTrackID, 1, outputBuffer, outputBufferSize);    
+        pthread_join(_writerThreadId, NULL);
+        _writerStarted = false;
+    }
+}
+
+bool TranscodePipeline::claimFrame(PipelineFrame** frame)
+{
+    pthread_mutex_lock(&_mutex);
+    while (!_failed)
+    {
+        // claim the oldest frame waiting for a worker
+        deque<PipelineFrame*>::iterator iter;
+        for (iter = _queue.begin(); iter != _queue.end(); iter++)
+        {
+            if ((*iter)->state == PipelineFrame::READ)
+            {
+                (*iter)->state = PipelineFrame::TRANSCODING;
+                *frame = *iter;
+                pthread_mutex_unlock(&_mutex);
+                return true;
+            }
+        }
+        
+        if (_stop)
+        {
+            break;
+        }
+        pthread_cond_wait(&_frameChange, &_mutex);
+    }
+    pthread_mutex_unlock(&_mutex);
+    
+    return false;
+}
+
+void TranscodePipeline::runWorker(PipelineWorker* worker)
+{
+    PipelineFrame* frame;
+    
+    while (claimFrame(&frame))
+    {
+        int result = transcode_frame(&_transcode->streams[frame->streamIndex], worker, frame);
+        
+        pthread_mutex_lock(&_mutex);
+        frame->failed = !result;
+        frame->state = PipelineFrame::DONE;
+        pthread_cond_broadcast(&_frameChange);
+        pthread_mutex_unlock(&_mutex);
+    }
+}
+
+void TranscodePipeline::runWriter()
+{
+    pthread_mutex_lock(&_mutex);
+    while (!_failed)
+    {
+        if (!_queue.empty() && _queue.front()->state == PipelineFrame::DONE)
+        {
+            PipelineFrame* frame = _queue.front();
+            _queue.pop_front();
+            pthread_mutex_unlock(&_mutex);
+            
+            bool result = !frame->failed && writeFrame(frame);
+            
+            pthread_mutex_lock(&_mutex);
+            if (!result)
+            {
+                _failed = true;
+            }
+            _freeFrames.push_back(frame);
+            pthread_cond_broadcast(&_frameChange);
+        }
+        else if (_queue.empty() && _stop)
+        {
+            break;
+        }
+        else
+        {
+            pthread_cond_wait(&_frameChange, &_mutex);
+        }
+    }
+    pthread_mutex_unlock(&_mutex);
+}
+
+bool TranscodePipeline::writeFrame(PipelineFrame* frame)
+{
+    TranscodeStream* stream = &_transcode->streams[frame->streamIndex];
+    uint8_t* buffer;
+    uint32_t bufferSize;
+    
+    if (stream->requireTranscode)
+    {
+        buffer = frame->outputBuffer;
+        bufferSize = frame->outputSize;
+        
+        // each worker has its own compressor and so the Avid last field size
+        // metadata is linked here in write order
+        _lastFieldSize[frame->streamIndex] = mjpeg_link_frame(buffer, bufferSize, _lastFieldSize[frame->streamIndex]);
     }
     else
     {
-        // TODO: hardcoded num samples
-        if (transcode->isPALProject)
+        buffer = frame->inputBuffer;
+        bufferSize = frame->inputSize;
+    }
+    
+    try
+    {
+        if (stream->isVideo)
         {
-            transcode->mxfWriter->WriteSamples(stream->materialTrackID, 48000/25, outputBuffer, outputBufferSize);
+            _transcode->mxfWriter->WriteSamples(stream->materialTrackID, 1, buffer, bufferSize);    
         }
         else
         {
-            assert(false); // NTSC audio reading not yet supported in MXFReader
-            transcode->mxfWriter->WriteSamples(stream->materialTrackID, 48000/30, outputBuffer, outputBufferSize);
+            // TODO: hardcoded num samples
+            if (_transcode->isPALProject)
+            {
+                _transcode->mxfWriter->WriteSamples(stream->materialTrackID, 48000/25, buffer, bufferSize);
+            }
+            else
+            {
+                assert(false); // NTSC audio reading not yet supported in MXFReader
+                _transcode->mxfWriter->WriteSamples(stream->materialTrackID, 48000/30, buffer, bufferSize);
+            }
         }
     }
+    catch (...)
+    {
+        prodauto::Logging::error("Failed to write transcoded samples\n");
+        return false;
+    }
+    
+    return true;
+}
+
+void* TranscodePipeline::workerThread(void* arg)
+{
+    PipelineWorker* worker = (PipelineWorker*)arg;
+    
+    worker->pipeline->runWorker(worker);
+    return NULL;
+}
+
+void* TranscodePipeline::writerThread(void* arg)
+{
+    TranscodePipeline* pipeline = (TranscodePipeline*)arg;
+    
+    pipeline->runWriter();
+    return NULL;
+}
+
+
+static int accept_frame(mxfr::MXFReaderListener* listener, int trackIndex)
+{
+    // only single track expected 
+    return trackIndex == 0;
+}
+
+static int allocate_buffer(mxfr::MXFReaderListener* listener, int trackIndex, uint8_t** buffer, uint32_t bufferSize)
+{
+    TranscodeAvidMXF* transcode = listener->data->transcode;
+    TranscodeStream* stream = &transcode->streams[listener->data->streamIndex];
+    
+    // only single track expected 
+    if (trackIndex != 0)
+    {
+        return 0;
+    }
+    
+    // blocks until the pipeline has a free frame
+    CHK_ORET((stream->pendingFrame = transcode->pipeline->getFreeFrame(listener->data->streamIndex, bufferSize)) != NULL);
+    
+    *buffer = stream->pendingFrame->inputBuffer;
+    return 1;
+}
+
+static void deallocate_buffer(mxfr::MXFReaderListener* listener, int trackIndex, uint8_t** buffer)
+{
+    TranscodeAvidMXF* transcode = listener->data->transcode;
+    TranscodeStream* stream = &transcode->streams[listener->data->streamIndex];
+    
+    // the frame was not received
+    if (stream->pendingFrame != NULL)
+    {
+        transcode->pipeline->releaseFrame(stream->pendingFrame);
+        stream->pendingFrame = NULL;
+    }
+    *buffer = NULL;
+}
+
+static int receive_frame(mxfr::MXFReaderListener* listener, int trackIndex, uint8_t* buffer, uint32_t bufferSize)
+{
+    TranscodeAvidMXF* transcode = listener->data->transcode;
+    TranscodeStream* stream = &listener->data->transcode->streams[listener->data->streamIndex];
+    
+    // only single track expected 
+    if (trackIndex != 0)
+    {
+        return 0;
+    }
+    
+    CHK_ORET(stream->pendingFrame != NULL && stream->pendingFrame->inputBuffer == buffer);
+    CHK_ORET(stream->pendingFrame->inputBufferSize >= bufferSize);
+    
+    // the frame is transcoded (if required) and written by the pipeline threads
+    transcode->pipeline->submit(stream->pendingFrame, bufferSize);
+    stream->pendingFrame = NULL;
     
     return 1;
 }
@@ -667,14 +1096,14 @@ int get_stream(MaterialHolder& sourceMaterial, prodauto::UMID uid, vector<string
 }
 
 
-int transcode_avid_mxf(Decoder* decoder,
-                       vector<string>& inputFiles, 
+int transcode_avid_mxf(vector<string>& inputFiles, 
                        uint32_t umidGenOffset,
                        MaterialHolder& sourceMaterial,
                        string outputPrefix,
                        string creatingDirectory, 
                        string destinationDirectory, 
                        string failureDirectory, 
+                       int numWorkers, 
                        int numFFMPEGThreads, 
                        int inputVideoResolutionID,
                        int outputVideoResolutionID)
@@ -691,7 +1120,6 @@ int transcode_avid_mxf(Decoder* decoder,
     vector<prodauto::SourcePackage*>::const_iterator iter2;
 
     memset(&transcode, 0, sizeof(TranscodeAvidMXF));
-    transcode.decoder = decoder;
     transcode.isPALProject = true;
     
 
@@ -839,13 +1267,13 @@ int transcode_avid_mxf(Decoder* decoder,
             
             if (stream->requireTranscode)
             {
-                CHK_OFAIL(initialise_transcode(&transcode, stream, numFFMPEGThreads));
+                CHK_OFAIL(initialise_transcode(&transcode, stream));
             }
         }
 
-        // initialise mjpeg library
-        // TODO: hardcoded WxH and assuming DV50 height
-        CHK_OFAIL(transcode.mjpeg.initialise(720, (transcode.isPALProject ? 576 : 480)));
+        // start the decode/encode workers and writer
+        transcode.pipeline = new TranscodePipeline(&transcode);
+        CHK_OFAIL(transcode.pipeline->start(numWorkers, numFFMPEGThreads));
         
         
         
@@ -871,6 +1299,7 @@ int transcode_avid_mxf(Decoder* decoder,
 
         
         // transcode
+        // frames are read here and passed to the pipeline threads
     
         eof = 0;
         while (!eof)
@@ -888,6 +1317,11 @@ int transcode_avid_mxf(Decoder* decoder,
         }
     
         
+        // wait for the pipeline to write the remaining frames
+        
+        CHK_OFAIL(transcode.pipeline->complete());
+        
+        
         // complete writing
         
         transcode.mxfWriter->CompleteWriting(true);
@@ -899,11 +1333,11 @@ int transcode_avid_mxf(Decoder* decoder,
     
     // close
     
+    delete transcode.pipeline;
     delete transcode.mxfWriter;
     for (i = 0; i < transcode.numStreams; i++)
     {
         mxfr::close_mxf_reader(&transcode.streams[i].reader);
-        SAFE_FREE(&transcode.streams[i].inputBuffer);
         free_transcode(&transcode.streams[i]);
     }
     
@@ -911,11 +1345,12 @@ int transcode_avid_mxf(Decoder* decoder,
 
     
 fail:
+    // stop the pipeline threads before deleting the writer they use
+    delete transcode.pipeline;
     delete transcode.mxfWriter;
     for (i = 0; i < transcode.numStreams; i++)
     {
         mxfr::close_mxf_reader(&transcode.streams[i].reader);
-        SAFE_FREE(&transcode.streams[i].inputBuffer);
         free_transcode(&transcode.streams[i]);
     }
     return 0;
@@ -1024,6 +1459,178 @@ static string parse_date_from_filename(string filename)
 
 
 
+// A transcode running in its own thread. The database is only accessed from
+// the main thread
+class TranscodeJob
+{
+public:
+    TranscodeJob()
+    : transcode(0), umidGenOffset(0), numWorkers(1), numFFMPEGThreads(1),
+    inputVideoResolutionID(0), outputVideoResolutionID(0), result(false), done(false)
+    {}
+    
+    prodauto::Transcode* transcode;
+    MaterialHolder sourceMaterial;
+    vector<string> inputFiles;
+    uint32_t umidGenOffset;
+    string outputPrefix;
+    string creatingDirectory;
+    string destinationDirectory;
+    string failureDirectory;
+    int numWorkers;
+    int numFFMPEGThreads;
+    int inputVideoResolutionID;
+    int outputVideoResolutionID;
+    
+    pthread_t threadId;
+    bool result;
+    bool done;      // protected by g_jobMutex
+};
+
+static pthread_mutex_t g_jobMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_jobDone = PTHREAD_COND_INITIALIZER;
+
+
+static void* transcode_job_thread(void* arg)
+{
+    TranscodeJob* job = (TranscodeJob*)arg;
+    bool result = false;
+    
+    try
+    {
+        result = transcode_avid_mxf(job->inputFiles, job->umidGenOffset, job->sourceMaterial,
+                                    job->outputPrefix, job->creatingDirectory, job->destinationDirectory,
+                                    job->failureDirectory, job->numWorkers, job->numFFMPEGThreads,
+                                    job->inputVideoResolutionID, job->outputVideoResolutionID) != 0;
+    }
+    catch (...)
+    {
+        prodauto::Logging::error("Failed to transcode\n");
+    }
+    
+    pthread_mutex_lock(&g_jobMutex);
+    job->result = result;
+    job->done = true;
+    pthread_cond_broadcast(&g_jobDone);
+    pthread_mutex_unlock(&g_jobMutex);
+    
+    return NULL;
+}
+
+// update the transcode status in the database after the job has finished
+static void complete_transcode_job(DatabaseHolder& database, TranscodeJob* job)
+{
+    prodauto::Transcode* transcode = job->transcode;
+    
+    try
+    {
+        if (job->result)
+        {
+            // update with success status      
+            transcode->status = TRANSCODE_STATUS_COMPLETED;
+            transcode->destMaterialPackageDbId = job->sourceMaterial.sourceMaterialPackage->getDatabaseID();
+            database.instance()->saveTranscode(transcode);
+            prodauto::Logging::info("  Updated transcode status to COMPLETED\n");
+        }
+        else
+        {
+            // update with failed status                
+            prodauto::Logging::warning("Failed to transcode package '%s'\n", 
+                getUMIDString(job->sourceMaterial.sourceMaterialPackage->uid).c_str());
+            transcode->status = TRANSCODE_STATUS_FAILED;
+            database.instance()->saveTranscode(transcode);
+            prodauto::Logging::info("  Updated transcode status to FAILED\n");
+        }
+    }
+    catch (const prodauto::DBException& ex)
+    {
+        prodauto::Logging::error("Failed to update transcode status:\n  %s\n", ex.getMessage().c_str());
+        throw "Database problem";
+    }
+    catch (...)
+    {
+        prodauto::Logging::error("Failed to update transcode status\n");
+        throw "Database problem";
+    }
+}
+
+// wait until no more than maxRunning jobs are running. The status of finished
+// jobs is updated if the database is not NULL
+static void wait_for_transcode_jobs(DatabaseHolder* database, vector<TranscodeJob*>& jobs, size_t maxRunning)
+{
+    while (true)
+    {
+        // collect the finished jobs
+        vector<TranscodeJob*> finishedJobs;
+        vector<TranscodeJob*>::iterator iter;
+        pthread_mutex_lock(&g_jobMutex);
+        for (iter = jobs.begin(); iter != jobs.end(); )
+        {
+            if ((*iter)->done)
+            {
+                finishedJobs.push_back(*iter);
+                iter = jobs.erase(iter);
+            }
+            else
+            {
+                iter++;
+            }
+        }
+        pthread_mutex_unlock(&g_jobMutex);
+        
+        size_t i;
+        for (i = 0; i < finishedJobs.size(); i++)
+        {
+            pthread_join(finishedJobs[i]->threadId, NULL);
+        }
+        for (i = 0; i < finishedJobs.size(); i++)
+        {
+            try
+            {
+                if (database)
+                {
+                    complete_transcode_job(*database, finishedJobs[i]);
+                }
+            }
+            catch (...)
+            {
+                for (; i < finishedJobs.size(); i++)
+                {
+                    delete finishedJobs[i];
+                }
+                throw;
+            }
+            delete finishedJobs[i];
+        }
+        
+        if (jobs.size() <= maxRunning)
+        {
+            break;
+        }
+        
+        // wait for a job to finish
+        pthread_mutex_lock(&g_jobMutex);
+        bool haveDone = false;
+        while (!haveDone)
+        {
+            for (iter = jobs.begin(); iter != jobs.end(); iter++)
+            {
+                if ((*iter)->done)
+                {
+                    haveDone = true;
+                    break;
+                }
+            }
+            if (!haveDone)
+            {
+                pthread_cond_wait(&g_jobDone, &g_jobMutex);
+            }
+        }
+        pthread_mutex_unlock(&g_jobMutex);
+    }
+}
+
+
 static void usage(const char* cmd)
 {
     fprintf(stderr, "Usage: %s <<options>>\n", cmd);
@@ -1040,7 +1647,10 @@ static void usage(const char* cmd)
     fprintf(stderr, "  --input-mjpeg-21         transcode from Avid MJPEG 2:1 (default)\n");
     fprintf(stderr, "  --input-dv-50            transcode from DV 50\n");
     fprintf(stderr, "  --output-mjpeg-201       transcode to Avid MJPEG 20:1 (default)\n");
-    fprintf(stderr, "  --fthreads               number of FFMPEG threads (default = 4)\n");
+    fprintf(stderr, "  --fthreads               number of FFMPEG threads per decoder if a transcode has a single worker (default = 4)\n");
+    fprintf(stderr, "  --jobs <n>               maximum number of transcodes to run concurrently (default = 1)\n");
+    fprintf(stderr, "  --cpus <n>               number of CPUs shared by the concurrent transcodes' decode/encode workers\n");
+    fprintf(stderr, "                           (default = number of online CPUs)\n");
     fprintf(stderr, "  --db-host <string>       database host name (default '%s')\n", g_databaseHostName);
     fprintf(stderr, "  --db-name <string>       database name (default '%s')\n", g_databaseName);
     fprintf(stderr, "  --db-user <string>       database user name (default '%s')\n", g_databaseUserName);
@@ -1070,9 +1680,11 @@ int main(int argc, const char* argv[])
     bool multipleTranscoder = false;
     DatabaseHolder database;
     bool quit = false;
-    MJPEGCompressHolder mjpeg;
-    Decoder decoder;
     bool haveTranscoded;
+    int maxJobs = 1;
+    int cpuBudget = 0;
+    int numWorkers;
+    vector<TranscodeJob*> runningJobs;
 
     
     // read options 
@@ -1181,6 +1793,40 @@ int main(int argc, const char* argv[])
             }
             cmdlnIndex += 2;
         }
+        else if (strcmp(argv[cmdlnIndex], "--jobs") == 0)
+        {
+            if (cmdlnIndex + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for %s\n", argv[cmdlnIndex]);
+                return 1;
+            }
+            if (sscanf(argv[cmdlnIndex + 1], "%d\n", &maxJobs) != 1 ||
+                maxJobs < 1)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid argument for %s\n", argv[cmdlnIndex]);
+                return 1;
+            }
+            cmdlnIndex += 2;
+        }
+        else if (strcmp(argv[cmdlnIndex], "--cpus") == 0)
+        {
+            if (cmdlnIndex + 1 >= argc)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Missing argument for %s\n", argv[cmdlnIndex]);
+                return 1;
+            }
+            if (sscanf(argv[cmdlnIndex + 1], "%d\n", &cpuBudget) != 1 ||
+                cpuBudget < 1)
+            {
+                usage(argv[0]);
+                fprintf(stderr, "Invalid argument for %s\n", argv[cmdlnIndex]);
+                return 1;
+            }
+            cmdlnIndex += 2;
+        }
         else if (strcmp(argv[cmdlnIndex], "--db-host") == 0)
         {
             if (cmdlnIndex + 1 >= argc)
@@ -1253,6 +1899,27 @@ int main(int argc, const char* argv[])
     
     
 
+    // share the CPUs between the concurrent transcodes. The FFMPEG decoder threads are
+    // only used if a transcode has a single worker
+    if (cpuBudget <= 0)
+    {
+        cpuBudget = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (cpuBudget <= 0)
+        {
+            cpuBudget = 1;
+        }
+    }
+    numWorkers = cpuBudget / maxJobs;
+    if (numWorkers < 1)
+    {
+        numWorkers = 1;
+    }
+    if (numWorkers > 1)
+    {
+        numFFMPEGThreads = 1;
+    }
+    
+    
     printf("Press 'q' followed by <ENTER> to quit\n");
     
 
@@ -1263,6 +1930,9 @@ int main(int argc, const char* argv[])
     // set logging
     prodauto::Logging::initialise(prodauto::LOG_LEVEL_DEBUG);
     
+    prodauto::Logging::info("Running up to %d concurrent transcodes with %d decode/encode workers each\n",
+        maxJobs, numWorkers);
+    
     // connect the MXF logging facility
     prodauto::connectLibMXFLogging();
 
@@ -1350,7 +2020,8 @@ int main(int argc, const char* argv[])
                 prodauto::Logging::info("Processing transcode %d...\n", index);
                 
                 // load the source material
-                MaterialHolder sourceMaterial;
+                auto_ptr<TranscodeJob> job(new TranscodeJob());
+                MaterialHolder& sourceMaterial = job->sourceMaterial;
                 try
                 {
                     database.instance()->loadPackageChain(transcode->sourceMaterialPackageDbId, 
@@ -1453,7 +2124,7 @@ int main(int argc, const char* argv[])
                 outputPrefix = "";
                 string actualDestinationDirectory;
                 bool haveAllInputFiles = true;
-                vector<string> inputFiles;
+                vector<string>& inputFiles = job->inputFiles;
                 for (iter2 = sourceMaterial.packages.begin(); quit == false && iter2 != sourceMaterial.packages.end(); iter2++)
                 {
                     prodauto::Package* package = *iter2;
@@ -1548,6 +2219,10 @@ int main(int argc, const char* argv[])
                 // perform transcode
                 
                 haveTranscoded = true;
+                
+                // wait for a free job slot
+                wait_for_transcode_jobs(&database, runningJobs, maxJobs - 1);
+                
                 try
                 {
                     // update with started status                
@@ -1555,71 +2230,42 @@ int main(int argc, const char* argv[])
                     database.instance()->saveTranscode(transcode);
                     prodauto::Logging::info("  Updated transcode status to STARTED\n");
                     
-                    prodauto::Logging::info("  Performing transcode\n");
-                    if (transcode_avid_mxf(&decoder, inputFiles, database.instance()->getUMIDGenOffset(),
-                        sourceMaterial, outputPrefix.c_str(), creatingDirectory.c_str(),
-                        actualDestinationDirectory.c_str(), failureDirectory.c_str(),
-                        numFFMPEGThreads, inputVideoResolutionID, outputVideoResolutionID))
-                    {
-                        // update with success status      
-                        transcode->status = TRANSCODE_STATUS_COMPLETED;
-                        transcode->destMaterialPackageDbId = sourceMaterial.sourceMaterialPackage->getDatabaseID();
-                        database.instance()->saveTranscode(transcode);
-                        prodauto::Logging::info("  Updated transcode status to COMPLETED\n");
-                    }
-                    else
-                    {
-                        // update with failed status                
-                        prodauto::Logging::warning("Failed to transcode package '%s'\n", 
-                            getUMIDString(sourceMaterial.sourceMaterialPackage->uid).c_str());
-                        transcode->status = TRANSCODE_STATUS_FAILED;
-                        database.instance()->saveTranscode(transcode);
-                        prodauto::Logging::info("  Updated transcode status to FAILED\n");
-                    }
+                    job->umidGenOffset = database.instance()->getUMIDGenOffset();
                 }
                 catch (const prodauto::DBException& ex)
                 {
-                    prodauto::Logging::error("Failed to transcode:\n  %s\n", ex.getMessage().c_str());
-                    try
-                    {
-                        transcode->status = TRANSCODE_STATUS_FAILED;
-                        database.instance()->saveTranscode(transcode);
-                        prodauto::Logging::info("  Updated transcode status to FAILED\n");
-                    }
-                    catch (const prodauto::DBException& ex)
-                    {
-                        prodauto::Logging::error("Failed to update transcode status to failed:\n  %s\n", ex.getMessage().c_str());
-                    }
-                    catch (...)
-                    {
-                        prodauto::Logging::error("Failed to update transcode status to failed\n");
-                    }
-                    throw "Database problem";
-                }
-                catch (...)
-                {
-                    prodauto::Logging::error("Failed to transcode\n");
-                    try
-                    {
-                        transcode->status = TRANSCODE_STATUS_FAILED;
-                        database.instance()->saveTranscode(transcode);
-                        prodauto::Logging::info("  Updated transcode status to FAILED\n");
-                    }
-                    catch (const prodauto::DBException& ex)
-                    {
-                        prodauto::Logging::error("Failed to update transcode status to failed:\n  %s\n", ex.getMessage().c_str());
-                    }
-                    catch (...)
-                    {
-                        prodauto::Logging::error("Failed to update transcode status to failed\n");
-                    }
+                    prodauto::Logging::error("Failed to update transcode status to started:\n  %s\n", ex.getMessage().c_str());
                     throw "Database problem";
                 }
                 
+                job->transcode = transcode;
+                job->outputPrefix = outputPrefix;
+                job->creatingDirectory = creatingDirectory;
+                job->destinationDirectory = actualDestinationDirectory;
+                job->failureDirectory = failureDirectory;
+                job->numWorkers = numWorkers;
+                job->numFFMPEGThreads = numFFMPEGThreads;
+                job->inputVideoResolutionID = inputVideoResolutionID;
+                job->outputVideoResolutionID = outputVideoResolutionID;
                 
+                prodauto::Logging::info("  Performing transcode\n");
+                if (pthread_create(&job->threadId, NULL, transcode_job_thread, job.get()) != 0)
+                {
+                    prodauto::Logging::error("Failed to start transcode thread\n");
+                    job->result = false;
+                    complete_transcode_job(database, job.get());
+                }
+                else
+                {
+                    runningJobs.push_back(job.release());
+                }
             }
     
             
+            // wait for the running transcodes to complete
+            wait_for_transcode_jobs(&database, runningJobs, 0);
+            
+            
             // cleanups
             try
             {
@@ -1676,6 +2322,14 @@ int main(int argc, const char* argv[])
         }
         catch (...)
         {
+            // the transcode entries of running jobs are left in the started state
+            try
+            {
+                wait_for_transcode_jobs(NULL, runningJobs, 0);
+            }
+            catch (...)
+            {}
+            
             try
             {
                 prodauto::Logging::info("Exception thrown - closing the database connection and restarting\n");